@@ -2,40 +2,39 @@
 //
 // SPDX-License-Identifier: MIT-0
 
-#include <CadR/BoundingBox.h>
 #include <CadR/BoundingSphere.h>
-#include <CadR/Geometry.h>
 #include <CadR/Exceptions.h>
-#include <CadR/ImageAllocation.h>
-#include <CadR/MatrixList.h>
 #include <CadR/Pipeline.h>
-#include <CadR/Sampler.h>
-#include <CadR/StagingBuffer.h>
 #include <CadR/StagingData.h>
 #include <CadR/StateSet.h>
-#include <CadR/Texture.h>
 #include <CadR/VulkanDevice.h>
 #include <CadR/VulkanInstance.h>
 #include <CadR/VulkanLibrary.h>
 #include <CadPL/PipelineSceneGraph.h>
+#include <CadGltf/Loader.h>
 #include "VulkanWindow.h"
 #include <vulkan/vulkan.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <nlohmann/json.hpp>
-#include "../../3rdParty/stb/stb_image.h"
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <memory>
+#include <nlohmann/json.hpp>
+#include <optional>
 #include <string>
+#include <tuple>
 #ifdef _WIN32
 # define WIN32_LEAN_AND_MEAN  // reduce amount of included files by windows.h
 # include <windows.h>  // needed for SetConsoleOutputCP()
@@ -57,17 +56,16 @@ static const uint32_t engineVersion = VK_MAKE_VERSION(0, 0, 0);
 static const uint32_t vulkanApiVersion = VK_API_VERSION_1_4;
 
 
-// enums
-enum class MaterialModel { Unknown, BlinPhong = 0x1, MetallicRoughness = 0x2 };
+// types
+using CadGltf::MaterialModel;
 
 
 // constants
 static constexpr const MaterialModel defaultMaterialModel = MaterialModel::MetallicRoughness;
+static constexpr const size_t numMeshesBuiltPerFrame = 64;
 static constexpr const vk::SampleCountFlagBits defaultNumSamples = vk::SampleCountFlagBits::e4;
 
 
-// types
-using json = nlohmann::json;
 typedef CadR::LogicError GltfError;
 
 
@@ -134,7 +132,8 @@ struct SceneGpuData {
 	float p11,p22,p33,p43;   // projectionMatrix - members that depend on zNear and zFar clipping planes
 	glm::vec3 ambientLight;  // we use vec4 instead of vec3 for the purpose of memory alignment; alpha component for light intensities is unused
 	uint32_t numLights;
-	array<uint32_t,8> padding;
+	uint64_t textureAtlasDataPtr;  // pointer to texture atlas data or zero if no atlases are used
+	array<uint32_t,6> padding;
 	LightGpuData lights[maxLights];
 };
 static_assert(sizeof(SceneGpuData) == 192+(lightGpuDataSize*maxLights), "Wrong SceneGpuData data size");
@@ -155,6 +154,8 @@ public:
 	void mouseButton(VulkanWindow&, size_t button, VulkanWindow::ButtonState buttonState, const VulkanWindow::MouseState& mouseState);
 	void mouseWheel(VulkanWindow& window, float wheelX, float wheelY, const VulkanWindow::MouseState& mouseState);
 	void key(VulkanWindow& window, VulkanWindow::KeyState keyState, VulkanWindow::ScanCode scanCode);
+	void runBenchmark();
+	void writeBenchmarkResults();
 
 	// Vulkan core objects
 	// (The order of members is not arbitrary but defines construction and destruction order.)
@@ -180,6 +181,17 @@ public:
 	array<vk::Format, 5> colorAttachmentFormatList;
 	bool dynamicRendering;
 	uint32_t requestedNumSamples = 0;
+	bool useTextureAtlas = true;
+	bool useTextureCompression = false;
+	filesystem::path textureCacheDirectory;
+	bool useAsyncPipelines = false;
+	bool useAutoPipelines = false;
+	bool useFragmentShaderBarycentric = true;
+	bool useShaderObjects = false;
+	bool useVertexCompression = true;
+	bool mergeStaticPrimitives = false;
+	bool asyncPipelineStatsPrinted = true;
+	filesystem::path pipelineCacheFile;
 	vk::SampleCountFlagBits numSamples;
 	float maxSamplerAnisotropy;
 
@@ -198,9 +210,13 @@ public:
 	vk::ImageView finalMultisampledColorImageView;
 	vk::ImageView transparencyColorImageView;
 	vk::ImageView transparencyCountImageView;
+	vk::Image offscreenImage;  //< Color image used instead of swapchain images in headless mode.
+	vk::DeviceMemory offscreenImageMemory;
 	vector<vk::Image> swapchainImages;
 	vector<vk::ImageView> swapchainImageViews;
 	vk::SwapchainKHR swapchain;
+	vk::Extent2D imageExtent;  //< Extent of swapchain images or of offscreen image.
+	vk::ImageLayout finalColorImageLayout;  //< Layout of swapchain image or offscreen image after the rendering.
 	vk::RenderPass renderPass;
 	vector<vk::Framebuffer> framebuffers;
 	array<vk::RenderingAttachmentInfo, 5> colorRenderingAttachmentInfoList;
@@ -220,10 +236,33 @@ public:
 	float fovy = 80.f / 180.f * glm::pi<float>();  //< Initial field-of-view in y-axis (in vertical direction) is 80 degrees.
 	float cameraHeading = 0.f;
 	float cameraElevation = 0.f;
-	float cameraDistance;
+	float cameraDistance = 1.f;
 	float startMouseX, startMouseY;
 	float startCameraHeading, startCameraElevation;
-	CadR::BoundingSphere sceneBoundingSphere;
+	CadR::BoundingSphere sceneBoundingSphere{ glm::vec3(0.f, 0.f, 0.f), 0.f };
+
+	// startup timing
+	chrono::steady_clock::time_point startupBeginTime;
+	chrono::steady_clock::time_point sceneLoadBeginTime;
+	double sceneLoadTime = 0.;  //< Scene load time without the time spent by pipeline creation.
+	double pipelineCreationTime = 0.;  //< Time spent by creating pipelines during scene load and the first resize.
+	bool startupTimesPrinted = false;
+
+	// headless benchmark
+	bool headless = false;
+	vk::Extent2D headlessExtent{1024, 768};
+	uint32_t numBenchmarkFrames = 100;
+	filesystem::path benchmarkOutputFile;
+	ostream* logStream = &cout;  //< Stream of progress and log messages. It is cerr in headless mode, so the benchmark results are the only output on stdout.
+	struct LoadTimes {
+		double parse = 0.;  //< Time of Loader::parse().
+		double buffers = 0.;  //< Time of Loader::resolveBuffers().
+		double images = 0.;  //< Time of Loader::decodeImages().
+		double meshes = 0.;  //< Time of Loader::buildGeometry() including pipeline creation.
+		double upload = 0.;  //< Time of Loader::upload() up to the completion of all transfers.
+	} loadTimes;
+	vector<CadR::FrameInfo> frameInfoList;
+	double benchmarkTime = 0.;  //< Wall-clock time of rendering all benchmark frames.
 
 	// command-line options
 	string deviceNameFilter;
@@ -247,15 +286,9 @@ public:
 	vk::DescriptorSetLayout composeDescriptorSetLayout;
 	vk::DescriptorPool composeDescriptorPool;
 	vk::DescriptorSet composeDescriptorSet;
-	vector<CadR::Geometry> geometryList;
-	vector<CadR::Drawable> drawableList;
-	vector<CadR::MatrixList> matrixLists;
-	vector<CadR::DataAllocation> materialList;
-	vector<CadR::ImageAllocation> imageList;
-	vector<CadR::Sampler> samplerList;
-	vector<CadR::Texture> textureList;
-	CadR::Sampler defaultSampler;
-	CadR::DataAllocation defaultMaterial;
+	optional<CadGltf::Loader> loader;
+	future<void> loaderFuture;  //< Worker thread performing parse, resolveBuffers and decodeImages stages.
+	bool sceneLoaded = false;
 
 };
 
@@ -344,65 +377,12 @@ static string utf16ToUtf8(const wchar_t* ws)
 #endif
 
 
-// decode URI
-// replacing percent-encoded octets (f.ex. %20)
-// by their corresponding character (f.ex. ' ')
-static string decodeURI(const string& s)
-{
-	// count number of '%'
-	size_t n = 0;
-	size_t i = 0;
-	string::value_type c = s[0];
-	while(c != 0) {
-		if(c == '%')
-			n += 2;
-		i++;
-		c = s[i];
-	}
-
-	// no decoding needed
-	if(n == 0)
-		return s;
-
-	// reserve memory
-	string r(s.length() - n, 0);
-
-	// decode string from s to r
-	i = 0;
-	size_t j = 0;
-	c = s[0];
-	while(c != 0) {
-		if(c == '%') {
-			c = s[++i];
-			if(c == 0)
-				throw GltfError("URI error. Wrong % encoding.");
-			string::value_type a = (c <= '9') ? c - '0' : (c <= 'Z') ? c - 'A' + 10 : c - 'a' + 10;
-			c = s[++i];
-			if(c == 0)
-				throw GltfError("URI error. Wrong % encoding.");
-			string::value_type b = (c <= '9') ? c - '0' : (c <= 'Z') ? c - 'A' + 10 : c - 'a' + 10;
-			if(uint8_t(a) > 15 || uint8_t(b) > 15)
-				throw GltfError("URI error. Wrong % encoding.");
-			r[j] = (a<<4) | b;
-		}
-		else
-			r[j] = c;
-		i++;
-		j++;
-		c = s[i];
-	}
-	return r;
-}
-
-
 /// Construct application object
 App::App(int argc, char** argv)
 	: sceneDataAllocation(renderer.dataStorage())
 	, stateSetRoot(renderer)
 	, sceneStateSet(renderer)
 	, composeStateSet(renderer)
-	, defaultSampler(renderer)
-	, defaultMaterial(renderer.dataStorage(), CadR::DataAllocation::noHandle)
 {
 #ifdef _WIN32
 	// get wchar_t command line
@@ -432,6 +412,32 @@ App::App(int argc, char** argv)
 						"                                contains <deviceNameFilter> string\n"
 						"   --dynamic-rendering      forces Vulkan dynamic rendering (modern approach)\n"
 						"   --render-pass-rendering  forces Vulkan render pass rendering (legacy approach)\n"
+						"   --no-texture-atlas       disables packing of small textures into texture atlases\n"
+						"   --compress-textures      compresses uncompressed textures into BCn formats\n"
+						"   --texture-cache <directory>  stores compressed textures in the directory,\n"
+						"                                so each texture is compressed only once\n"
+						"   --async-pipelines        renders by uber-shader until optimized pipelines\n"
+						"                            are compiled in background threads\n"
+						"   --auto-pipelines         renders by uber-shader and compiles optimized\n"
+						"                            pipelines only for the most used materials\n"
+						"   --pipeline-cache <file>  stores compiled pipelines in the file,\n"
+						"                            so following runs start faster\n"
+						"   --no-fragment-barycentric  uses geometry shader even if the device\n"
+						"                              supports fragment shader barycentrics\n"
+						"   --shader-objects         uses shader objects and dynamic state instead\n"
+						"                            of pipelines (requires dynamic rendering)\n"
+						"   --no-vertex-compression  stores all vertex attributes as 16 bytes floats\n"
+						"                            instead of compact and quantized formats\n"
+						"   --merge-primitives       merges small primitives of non-instanced meshes\n"
+						"                            into shared geometries to reduce draw count\n"
+						"   --headless               renders into offscreen image without window\n"
+						"                            and runs benchmark of camera orbiting the scene\n"
+						"                            (progress and log messages go to standard error)\n"
+						"   --frames <N>             number of frames rendered in headless mode\n"
+						"                            (default: 100)\n"
+						"   --size <W>x<H>           image size in headless mode (default: 1024x768)\n"
+						"   --benchmark-output <file>  writes headless benchmark results as JSON\n"
+						"                              into the file instead of standard output\n"
 						"   --          end of options; following parameter can be only <fileName>\n"
 						"   <fileName>  model to load");
 			}
@@ -455,6 +461,81 @@ App::App(int argc, char** argv)
 				forceRenderPassRendering = true;
 				forceDynamicRendering = false;
 			}
+			else if(strcmp(argv[i], "--no-texture-atlas") == 0)
+				useTextureAtlas = false;
+			else if(strcmp(argv[i], "--compress-textures") == 0)
+				useTextureCompression = true;
+			else if(strcmp(argv[i], "--texture-cache") == 0)
+			{
+				if(argv[i+1] != nullptr) {
+					textureCacheDirectory = argv[i+1];
+					useTextureCompression = true;
+					i++;
+					continue;
+				}
+				else
+					throw ExitWithMessage(99, "No directory specified after --texture-cache parameter.");
+			}
+			else if(strcmp(argv[i], "--async-pipelines") == 0)
+				useAsyncPipelines = true;
+			else if(strcmp(argv[i], "--auto-pipelines") == 0)
+				useAutoPipelines = true;
+			else if(strcmp(argv[i], "--no-fragment-barycentric") == 0)
+				useFragmentShaderBarycentric = false;
+			else if(strcmp(argv[i], "--shader-objects") == 0)
+				useShaderObjects = true;
+			else if(strcmp(argv[i], "--no-vertex-compression") == 0)
+				useVertexCompression = false;
+			else if(strcmp(argv[i], "--merge-primitives") == 0)
+				mergeStaticPrimitives = true;
+			else if(strcmp(argv[i], "--pipeline-cache") == 0)
+			{
+				if(argv[i+1] != nullptr) {
+					pipelineCacheFile = argv[i+1];
+					i++;
+					continue;
+				}
+				else
+					throw ExitWithMessage(99, "No file specified after --pipeline-cache parameter.");
+			}
+			else if(strcmp(argv[i], "--headless") == 0) {
+				headless = true;
+				logStream = &cerr;
+			}
+			else if(strcmp(argv[i], "--frames") == 0) {
+				i++;
+				if(i >= argc)
+					throw ExitWithMessage(99, "Parameter --frames must be followed by a number.");
+				char* endp;
+				numBenchmarkFrames = strtoul(argv[i], &endp, 10);
+				if(*endp != 0 || numBenchmarkFrames == 0)
+					throw ExitWithMessage(99, "Parameter --frames must be followed by a positive non-zero number.");
+			}
+			else if(strcmp(argv[i], "--size") == 0) {
+				i++;
+				if(i >= argc)
+					throw ExitWithMessage(99, "Parameter --size must be followed by <width>x<height>.");
+				char* endp;
+				headlessExtent.width = strtoul(argv[i], &endp, 10);
+				bool valid = *endp == 'x';
+				if(valid) {
+					headlessExtent.height = strtoul(endp+1, &endp, 10);
+					valid = *endp == 0 && headlessExtent.width != 0 && headlessExtent.height != 0;
+				}
+				if(!valid)
+					throw ExitWithMessage(99, "Parameter --size must be followed by <width>x<height>, "
+					                          "for example 1920x1080.");
+			}
+			else if(strcmp(argv[i], "--benchmark-output") == 0)
+			{
+				if(argv[i+1] != nullptr) {
+					benchmarkOutputFile = argv[i+1];
+					i++;
+					continue;
+				}
+				else
+					throw ExitWithMessage(99, "No file specified after --benchmark-output parameter.");
+			}
 			else if(strcmp(argv[i], "--pbr") == 0 || strcmp(argv[i], "--metallic-roughness") == 0)
 				materialModel = MaterialModel::MetallicRoughness;
 			else if(strcmp(argv[i], "--phong") == 0 || strcmp(argv[i], "--blin-phong") == 0)
@@ -500,6 +581,11 @@ App::App(int argc, char** argv)
 
 App::~App()
 {
+	// wait for the loader worker thread
+	// (exceptions are ignored here)
+	if(loaderFuture.valid())
+		loaderFuture.wait();
+
 	if(device) {
 
 		// wait for device idle state
@@ -520,15 +606,7 @@ App::~App()
 		device.destroy(composeDescriptorPool);
 		sceneStateSet.destroy();
 		stateSetRoot.destroy();
-		textureList.clear();
-		imageList.clear();
-		samplerList.clear();
-		materialList.clear();
-		matrixLists.clear();
-		defaultSampler.destroy();
-		defaultMaterial.free();
-		drawableList.clear();
-		geometryList.clear();
+		loader.reset();
 		sceneDataAllocation.free();
 		device.destroy(commandPool);
 		renderer.finalize();
@@ -542,11 +620,13 @@ App::~App()
 		device.destroy(finalMultisampledColorImage);
 		device.destroy(transparencyColorImage);
 		device.destroy(transparencyCountImage);
+		device.destroy(offscreenImage);
 		device.free(depthImageMemory);
 		device.free(hdrColorImageMemory);
 		device.free(finalMultisampledColorImageMemory);
 		device.free(transparencyColorImageMemory);
 		device.free(transparencyCountImageMemory);
+		device.free(offscreenImageMemory);
 		device.destroy(depthImageView);
 		device.destroy(hdrColorImageView);
 		device.destroy(finalMultisampledColorImageView);
@@ -576,18 +656,21 @@ App::~App()
 
 void App::init()
 {
-	// open file
-	ifstream f(filePath);
-	if(!f.is_open()) {
+	startupBeginTime = chrono::steady_clock::now();
+
+	// check file
+	// (the file is parsed later by the loader)
+	if(!ifstream(filePath).is_open()) {
 		string msg("Cannot open file ");
 		msg.append(utf8FilePath);
 		msg.append(".");
 		throw ExitWithMessage(1, msg);
 	}
-	f.exceptions(ifstream::badbit | ifstream::failbit);
 
 	// init Vulkan and window
-	VulkanWindow::init();
+	// (no window and no surface is created in headless mode)
+	if(!headless)
+		VulkanWindow::init();
 	vulkanLib.load(CadR::VulkanLibrary::defaultName());
 	vulkanInstance.create(
 		vulkanLib,
@@ -597,10 +680,12 @@ void App::init()
 		engineVersion,  // engineVersion
 		vulkanApiVersion,  // apiVersion - maximum version that gltfReader might use
 		nullptr,  // enabledLayers
-		VulkanWindow::requiredExtensions()  // enabledExtensions
+		headless ? vector<const char*>{}  // enabledExtensions
+		         : VulkanWindow::requiredExtensions()
 	);
-	window.create(vulkanInstance.handle(), {1024,768}, string(fancyAppName) + " - " + utf8FileName,
-	              vulkanLib.vkGetInstanceProcAddr);
+	if(!headless)
+		window.create(vulkanInstance.handle(), {1024,768}, string(fancyAppName) + " - " + utf8FileName,
+		              vulkanLib.vkGetInstanceProcAddr);
 
 	// choose device
 	tie(physicalDevice, graphicsQueueFamily, presentationQueueFamily, dynamicRendering) =
@@ -631,11 +716,14 @@ void App::init()
 					continue;
 
 				// skip devices without VK_KHR_swapchain
-				vector<vk::ExtensionProperties> extensionList = vulkanInstance.enumerateDeviceExtensionProperties(pd);
-				for(vk::ExtensionProperties& e : extensionList)
-					if(strcmp(e.extensionName, "VK_KHR_swapchain") == 0)
-						goto swapchainSupported;
-				continue;
+				// (swapchain is not used in headless mode)
+				if(!headless) {
+					vector<vk::ExtensionProperties> extensionList = vulkanInstance.enumerateDeviceExtensionProperties(pd);
+					for(vk::ExtensionProperties& e : extensionList)
+						if(strcmp(e.extensionName, "VK_KHR_swapchain") == 0)
+							goto swapchainSupported;
+					continue;
+				}
 			swapchainSupported:;
 
 				// select queues for submitting operations and for presentation
@@ -646,7 +734,8 @@ void App::init()
 				for(uint32_t i=0, c=uint32_t(queueFamilyList.size()); i<c; i++) {
 
 					// test for presentation support
-					if(vulkanInstance.getPhysicalDeviceSurfaceSupportKHR(pd, i, presentationSurface)) {
+					// (in headless mode, operations queue is used as presentation queue)
+					if(headless || vulkanInstance.getPhysicalDeviceSurfaceSupportKHR(pd, i, presentationSurface)) {
 
 						// test for queue operations support (graphics, compute, etc.)
 						if((queueFamilyList[i].queueFlags & queueOperations) == queueOperations) {
@@ -798,24 +887,73 @@ void App::init()
 	} else
 		numSamples = vk::SampleCountFlagBits::e1;
 
+	// texture compression support
+	if(useTextureCompression && !vulkanInstance.getPhysicalDeviceFeatures(physicalDevice).textureCompressionBC) {
+		*logStream << "BC texture compression is not supported by the device. Textures will not be compressed." << endl;
+		useTextureCompression = false;
+	}
+
+	// fragment shader barycentric support
+	// (triangles and lines are rendered without geometry shader when supported)
+	if(useFragmentShaderBarycentric) {
+		useFragmentShaderBarycentric = false;
+		for(vk::ExtensionProperties& e : vulkanInstance.enumerateDeviceExtensionProperties(physicalDevice))
+			if(strcmp(e.extensionName, VK_KHR_FRAGMENT_SHADER_BARYCENTRIC_EXTENSION_NAME) == 0) {
+				auto features =
+					vulkanInstance.getPhysicalDeviceFeatures2<
+						vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceFragmentShaderBarycentricFeaturesKHR>(physicalDevice);
+				useFragmentShaderBarycentric =
+					features.get<vk::PhysicalDeviceFragmentShaderBarycentricFeaturesKHR>().fragmentShaderBarycentric;
+				break;
+			}
+	}
+
+	// shader object support
+	// (shader objects support dynamic rendering only)
+	if(useShaderObjects) {
+		useShaderObjects = false;
+		if(!dynamicRendering)
+			*logStream << "Shader objects require dynamic rendering. Pipelines will be used instead." << endl;
+		else
+			for(vk::ExtensionProperties& e : vulkanInstance.enumerateDeviceExtensionProperties(physicalDevice))
+				if(strcmp(e.extensionName, VK_EXT_SHADER_OBJECT_EXTENSION_NAME) == 0) {
+					auto features =
+						vulkanInstance.getPhysicalDeviceFeatures2<
+							vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceShaderObjectFeaturesEXT>(physicalDevice);
+					useShaderObjects =
+						features.get<vk::PhysicalDeviceShaderObjectFeaturesEXT>().shaderObject;
+					break;
+				}
+		if(dynamicRendering && !useShaderObjects)
+			*logStream << "Shader objects are not supported by the device. Pipelines will be used instead." << endl;
+	}
+
 	// print used device
-	cout << "Using device: " << deviceProperties.deviceName;
+	*logStream << "Using device: " << deviceProperties.deviceName;
 	if(dynamicRendering)
-		cout << ", dynamic (modern) rendering, antialiasing samples: " << unsigned(numSamples) << ".\n" << endl;
+		*logStream << ", dynamic (modern) rendering, antialiasing samples: " << unsigned(numSamples) << ".\n" << endl;
 	else
-		cout << ", render pass (legacy) rendering, no antialiasing.\n" << endl;
+		*logStream << ", render pass (legacy) rendering, no antialiasing.\n" << endl;
+	if(useFragmentShaderBarycentric)
+		*logStream << "Using fragment shader barycentrics (no geometry shader for triangles and lines).\n" << endl;
+	if(useShaderObjects)
+		*logStream << "Using shader objects (all pipeline state is set through dynamic state).\n" << endl;
 
 	// init device and renderer
-	device.create(
-		vulkanInstance, physicalDevice, graphicsQueueFamily, presentationQueueFamily,
-#if 0 // enable validation extensions and features
-		{"VK_KHR_swapchain", "VK_KHR_shader_non_semantic_info"},
+	vector<const char*> enabledExtensions;
+	vk::PhysicalDeviceFragmentShaderBarycentricFeaturesKHR barycentricFeatures;
+	vk::PhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures;
+	CadR::Renderer::RequiredFeaturesStructChain enabledFeatures =
 		[&]() {
+#if 0 // enable validation extensions and features
+			enabledExtensions = {"VK_KHR_shader_non_semantic_info"};
+			if(!headless)
+				enabledExtensions.push_back("VK_KHR_swapchain");
 			CadR::Renderer::RequiredFeaturesStructChain features;
 			features.get<vk::PhysicalDeviceVulkan12Features>().uniformAndStorageBuffer8BitAccess = true;
 #else
-		"VK_KHR_swapchain",
-		[&]() {
+			if(!headless)
+				enabledExtensions = {"VK_KHR_swapchain"};
 			CadR::Renderer::RequiredFeaturesStructChain features;
 #endif
 			CadR::Renderer::setRequiredFeatures(features);
@@ -826,18 +964,49 @@ void App::init()
 			features.get<vk::PhysicalDeviceVulkan12Features>().descriptorBindingUpdateUnusedWhilePending = true;  // required by CadPL
 			features.get<vk::PhysicalDeviceVulkan12Features>().descriptorBindingPartiallyBound = true;  // required by CadPL
 			features.get<vk::PhysicalDeviceVulkan12Features>().descriptorBindingVariableDescriptorCount = true;  // required by CadPL
+			if(useTextureCompression)
+				features.get<vk::PhysicalDeviceFeatures2>().features.textureCompressionBC = true;  // required by compressed textures
 			if(dynamicRendering) {
 				features.get<vk::PhysicalDeviceFeatures2>().features.sampleRateShading = true;  // required by gltfReader
 				features.get<vk::PhysicalDeviceVulkan13Features>().dynamicRendering = true;
 				features.get<vk::PhysicalDeviceVulkan14Features>().dynamicRenderingLocalRead = true;
 			}
 			return features;
-		}().get<vk::PhysicalDeviceFeatures2>()
+		}();
+	auto appendFeatures =
+		[&enabledFeatures](void* featureStruct) {
+			// append features at the end of pNext chain
+			// (it is done after the chain is stored in enabledFeatures because copying of vk::StructureChain relinks its pNext pointers)
+			vk::BaseOutStructure* s = reinterpret_cast<vk::BaseOutStructure*>(&enabledFeatures.get<vk::PhysicalDeviceFeatures2>());
+			while(s->pNext)
+				s = s->pNext;
+			s->pNext = reinterpret_cast<vk::BaseOutStructure*>(featureStruct);
+		};
+	if(useFragmentShaderBarycentric) {
+		enabledExtensions.push_back(VK_KHR_FRAGMENT_SHADER_BARYCENTRIC_EXTENSION_NAME);
+		barycentricFeatures.fragmentShaderBarycentric = true;
+		appendFeatures(&barycentricFeatures);
+	}
+	if(useShaderObjects) {
+		enabledExtensions.push_back(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+		shaderObjectFeatures.shaderObject = true;
+		appendFeatures(&shaderObjectFeatures);
+	}
+	device.create(
+		vulkanInstance, physicalDevice, graphicsQueueFamily, presentationQueueFamily,
+		enabledExtensions,
+		enabledFeatures.get<vk::PhysicalDeviceFeatures2>()
 	);
-	window.setDevice(device.handle(), physicalDevice);
+	if(!headless)
+		window.setDevice(device.handle(), physicalDevice);
+	renderer.setPipelineCacheFile(pipelineCacheFile);
 	renderer.init(device, vulkanInstance, physicalDevice, graphicsQueueFamily);
+	if(headless)
+		renderer.setCollectFrameInfo(true);
 	stateSetRoot.childList.append(sceneStateSet);
-	pipelineSceneGraph.init(sceneStateSet);
+	pipelineSceneGraph.init(sceneStateSet, CadPL::PipelineSceneGraph::defaultOptimizationLevels, renderer.pipelineCache());
+	pipelineSceneGraph.pipelineLibrary().setUseShaderObjects(useShaderObjects);
+	sceneLoadBeginTime = chrono::steady_clock::now();
 	if(dynamicRendering) {
 		stateSetRoot.childList.append(composeStateSet);
 		composeStateSet.setForceRecording(true);
@@ -880,32 +1049,40 @@ void App::init()
 	presentationQueue = device.getQueue(presentationQueueFamily, 0);
 
 	// choose surface format
-	surfaceFormat =
-		[](vk::PhysicalDevice physicalDevice, CadR::VulkanInstance& vulkanInstance, vk::SurfaceKHR surface)
-		{
-			constexpr const array candidateFormats{
-				vk::SurfaceFormatKHR{ vk::Format::eB8G8R8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear },
-				vk::SurfaceFormatKHR{ vk::Format::eR8G8B8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear },
-				vk::SurfaceFormatKHR{ vk::Format::eA8B8G8R8SrgbPack32, vk::ColorSpaceKHR::eSrgbNonlinear },
-			};
-			vector<vk::SurfaceFormatKHR> availableFormats =
-				physicalDevice.getSurfaceFormatsKHR(surface, vulkanInstance);
-			if(availableFormats.size()==1 && availableFormats[0].format==vk::Format::eUndefined)
-				// Vulkan spec allowed single eUndefined value until 1.1.111 (2019-06-10)
-				// with the meaning you can use any valid vk::Format value.
-				// Now, it is forbidden, but let's handle any old driver.
-				return candidateFormats[0];
-			else {
-				for(vk::SurfaceFormatKHR sf : availableFormats) {
-					auto it = std::find(candidateFormats.begin(), candidateFormats.end(), sf);
-					if(it != candidateFormats.end())
-						return *it;
+	// (headless mode uses sRGB format that is mandatory for color attachments)
+	if(headless)
+		surfaceFormat = vk::SurfaceFormatKHR{ vk::Format::eR8G8B8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear };
+	else
+		surfaceFormat =
+			[](vk::PhysicalDevice physicalDevice, CadR::VulkanInstance& vulkanInstance, vk::SurfaceKHR surface)
+			{
+				constexpr const array candidateFormats{
+					vk::SurfaceFormatKHR{ vk::Format::eB8G8R8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear },
+					vk::SurfaceFormatKHR{ vk::Format::eR8G8B8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear },
+					vk::SurfaceFormatKHR{ vk::Format::eA8B8G8R8SrgbPack32, vk::ColorSpaceKHR::eSrgbNonlinear },
+				};
+				vector<vk::SurfaceFormatKHR> availableFormats =
+					physicalDevice.getSurfaceFormatsKHR(surface, vulkanInstance);
+				if(availableFormats.size()==1 && availableFormats[0].format==vk::Format::eUndefined)
+					// Vulkan spec allowed single eUndefined value until 1.1.111 (2019-06-10)
+					// with the meaning you can use any valid vk::Format value.
+					// Now, it is forbidden, but let's handle any old driver.
+					return candidateFormats[0];
+				else {
+					for(vk::SurfaceFormatKHR sf : availableFormats) {
+						auto it = std::find(candidateFormats.begin(), candidateFormats.end(), sf);
+						if(it != candidateFormats.end())
+							return *it;
+					}
+					if(availableFormats.size() == 0)  // Vulkan must return at least one format (this is mandated since Vulkan 1.0.37 (2016-10-10), but was missing in the spec before probably because of omission)
+						throw CadR::LogicError("Vulkan error: getSurfaceFormatsKHR() returned empty list.");
+					return availableFormats[0];
 				}
-				if(availableFormats.size() == 0)  // Vulkan must return at least one format (this is mandated since Vulkan 1.0.37 (2016-10-10), but was missing in the spec before probably because of omission)
-					throw CadR::LogicError("Vulkan error: getSurfaceFormatsKHR() returned empty list.");
-				return availableFormats[0];
-			}
-		}(physicalDevice, vulkanInstance, window.surface());
+			}(physicalDevice, vulkanInstance, window.surface());
+
+	// layout of color image after the rendering
+	// (offscreen image is left ready for the copy to the host memory)
+	finalColorImageLayout = headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
 
 	// choose depth format
 	depthFormat =
@@ -1045,7 +1222,7 @@ void App::init()
 							vk::AttachmentLoadOp::eDontCare,   // stencilLoadOp
 							vk::AttachmentStoreOp::eDontCare,  // stencilStoreOp
 							vk::ImageLayout::eUndefined,       // initialLayout
-							vk::ImageLayout::ePresentSrcKHR    // finalLayout
+							finalColorImageLayout              // finalLayout
 						},
 						vk::AttachmentDescription{  // depth attachment
 							vk::AttachmentDescriptionFlags(),  // flags
@@ -1096,2831 +1273,224 @@ void App::init()
 							vk::AccessFlags(  // dstAccessMask
 								vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eIndexRead |
 								vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eColorAttachmentWrite |
-								vk::AccessFlagBits::eDepthStencilAttachmentWrite),
-							vk::DependencyFlags()  // dependencyFlags
-						),
-						vk::SubpassDependency(
-							0,                    // srcSubpass
-							VK_SUBPASS_EXTERNAL,  // dstSubpass
-							vk::PipelineStageFlags(vk::PipelineStageFlagBits::eColorAttachmentOutput),
-							vk::PipelineStageFlags(vk::PipelineStageFlagBits::eBottomOfPipe),  // dstStageMask
-							vk::AccessFlags(vk::AccessFlagBits::eColorAttachmentWrite),
-							vk::AccessFlags(),     // dstAccessMask
-							vk::DependencyFlags()  // dependencyFlags
-						),
-					}.data()
-
-				)
-			);
-
-	}
-
-	// rendering semaphore and fence
-	imageAvailableSemaphore =
-		device.createSemaphore(
-			vk::SemaphoreCreateInfo(
-				vk::SemaphoreCreateFlags()  // flags
-			)
-		);
-	renderingFinishedFence =
-		device.createFence(
-			vk::FenceCreateInfo(
-				vk::FenceCreateFlagBits::eSignaled  // flags
-			)
-		);
-
-	// shaders and pipeline for final composition step during rendering
-	if(dynamicRendering)
-	{
-		fullScreenTriangleVertexShader =
-			device.createShaderModule(
-				vk::ShaderModuleCreateInfo(
-					vk::ShaderModuleCreateFlags(),  // flags
-					sizeof(fullScreenTriangleVertexShaderSpirv),  // codeSize
-					fullScreenTriangleVertexShaderSpirv  // pCode
-				)
-			);
-		composeFragmentShader =
-			device.createShaderModule(
-				vk::ShaderModuleCreateInfo(
-					vk::ShaderModuleCreateFlags(),  // flags
-					(numSamples == vk::SampleCountFlagBits::e1)  // codeSize
-						? sizeof(composeFragmentShaderSpirv) : sizeof(composeMultisampledFragmentShaderSpirv),
-					(numSamples == vk::SampleCountFlagBits::e1)  // pCode
-						? composeFragmentShaderSpirv : composeMultisampledFragmentShaderSpirv
-				)
-			);
-		composeDescriptorSetLayout =
-			device.createDescriptorSetLayout(
-				vk::DescriptorSetLayoutCreateInfo{
-					vk::DescriptorSetLayoutCreateFlags(),  // flags
-					3,  // bindingCount
-					array<vk::DescriptorSetLayoutBinding,3>{
-						vk::DescriptorSetLayoutBinding{
-							0,  // binding
-							vk::DescriptorType::eInputAttachment,  // descritorType
-							1,  // descritorCount
-							vk::ShaderStageFlagBits::eFragment,  // stageFlags
-							nullptr,  // pImmutableSamplers
-						},
-						vk::DescriptorSetLayoutBinding{
-							1,  // binding
-							vk::DescriptorType::eInputAttachment,  // descritorType
-							1,  // descritorCount
-							vk::ShaderStageFlagBits::eFragment,  // stageFlags
-							nullptr,  // pImmutableSamplers
-						},
-						vk::DescriptorSetLayoutBinding{
-							2,  // binding
-							vk::DescriptorType::eInputAttachment,  // descritorType
-							1,  // descritorCount
-							vk::ShaderStageFlagBits::eFragment,  // stageFlags
-							nullptr,  // pImmutableSamplers
-						},
-					}.data(),
-				}
-			);
-		composePipelineLayout =
-			device.createPipelineLayout(
-				vk::PipelineLayoutCreateInfo{
-					vk::PipelineLayoutCreateFlags(),  // flags
-					1,        // setLayoutCount
-					&composeDescriptorSetLayout,  // pSetLayouts
-					0,  // pushConstantRangeCount
-					nullptr,  // pPushConstantRanges
-				}
-			);
-		composeDescriptorPool =
-			device.createDescriptorPool(
-				vk::DescriptorPoolCreateInfo(
-					vk::DescriptorPoolCreateFlags(),  // flags
-					1,  // maxSets
-					1,  // poolSizeCount
-					array{  // pPoolSizes
-						vk::DescriptorPoolSize(
-							vk::DescriptorType::eInputAttachment,  // type
-							3  // descriptorCount
-						),
-					}.data()
-				)
-			);
-		composeDescriptorSet =
-			device.allocateDescriptorSets(
-				vk::DescriptorSetAllocateInfo(
-					composeDescriptorPool,  // descriptorPool
-					1,  // descriptorSetCount
-					&composeDescriptorSetLayout  // descriptorSetLayout
-				)
-			)[0];
-	}
-
-	// command buffer
-	commandPool =
-		device.createCommandPool(
-			vk::CommandPoolCreateInfo(
-				vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer,  // flags
-				graphicsQueueFamily  // queueFamilyIndex
-			)
-		);
-	commandBuffer =
-		device.allocateCommandBuffers(
-			vk::CommandBufferAllocateInfo(
-				commandPool,                       // commandPool
-				vk::CommandBufferLevel::ePrimary,  // level
-				1                                  // commandBufferCount
-			)
-		)[0];
-
-	// parse json
-	cout << "Processing file " << utf8FilePath << "..." << endl;
-	json glTF, newGltfItems;
-	f >> glTF;
-	f.close();
-
-	// read root objects
-	// (asset item is mandatory, the rest is optional)
-	auto getRootItem =
-		[](json& glTF, json& newGltfItems, const string& key) -> json::array_t&
-		{
-			auto it = glTF.find(key);
-			if(it != glTF.end())
-				return it->get_ref<json::array_t&>();
-			auto& ref = newGltfItems[key];
-			if(ref.is_null())
-				ref = json::array();
-			return ref.get_ref<json::array_t&>();
-		};
-	auto& asset = glTF.at("asset");
-	auto& extensionsRequired = getRootItem(glTF, newGltfItems, "extensionsRequired");
-	auto& extensionsUsed = getRootItem(glTF, newGltfItems, "extensionsUsed");
-	auto& scenes = getRootItem(glTF, newGltfItems, "scenes");
-	auto& nodes = getRootItem(glTF, newGltfItems, "nodes");
-	auto& meshes = getRootItem(glTF, newGltfItems, "meshes");
-	auto& accessors = getRootItem(glTF, newGltfItems, "accessors");
-	auto& buffers = getRootItem(glTF, newGltfItems, "buffers");
-	auto& bufferViews = getRootItem(glTF, newGltfItems, "bufferViews");
-	auto& materials = getRootItem(glTF, newGltfItems, "materials");
-	auto& textures = getRootItem(glTF, newGltfItems, "textures");
-	auto& images = getRootItem(glTF, newGltfItems, "images");
-	auto& samplers = getRootItem(glTF, newGltfItems, "samplers");
-
-	// print glTF info
-	// (version item is mandatory, the rest is optional)
-	auto getStringWithDefault =
-		[](json& node, const string& key, const string& defaultVal)
-		{
-			auto it = node.find(key);
-			return (it != node.end())
-				? it->get_ref<json::string_t&>()
-				: defaultVal;
-		};
-	cout << endl;
-	cout << "glTF info:" << endl;
-	cout << "   Generator:   " << getStringWithDefault(asset, "generator", "< none >") << endl;
-	cout << "   Copyright:   " << getStringWithDefault(asset, "copyright", "< none >") << endl;
-	cout << "   Version:     " << asset.at("version").get_ref<json::string_t&>() << endl;
-	cout << "   MinVersion:  " << getStringWithDefault(asset, "minVersion", "< none >") << endl;
-	cout << "   Required extensions:  ";
-	if(extensionsRequired.empty())
-		cout << "< none >" << endl;
-	else {
-		cout << extensionsRequired.front().get_ref<json::string_t&>();
-		for(auto it=extensionsRequired.begin()+1,e=extensionsRequired.end(); it!=e; it++)
-			cout << ", " << it->get_ref<json::string_t&>();
-		cout << endl;
-	}
-	cout << "   Optional extensions:  ";
-	{
-		auto isInList =
-			[&](const string& s){
-				for(auto it=extensionsRequired.begin(),e=extensionsRequired.end(); it!=e; it++)
-					if(s == it->get_ref<json::string_t&>())
-						return true;
-				return false;
-			};
-		auto it = extensionsUsed.begin();
-		auto e = extensionsUsed.end();
-		if(it == e)
-			cout << "< none >";
-		else
-			do {
-				string* extension = &it->get_ref<json::string_t&>();
-				it++;
-				if(!isInList(*extension)) {
-					cout << *extension;
-					while(it != e) {
-						extension = &it->get_ref<json::string_t&>();
-						it++;
-						if(!isInList(*extension))
-							cout << ", " << *extension;
-					}
-					break;
-				}
-				cout << "< none >";
-			} while(it != e);
-		cout << endl;
-	}
-	cout << endl;
-
-	// check model version and support of required extensions
-	{
-		auto parseVersion =
-			[](const string& s) -> tuple<int, int> {
-				const char* start = s.c_str();
-				const char* end = start + s.size();
-				char* pos;
-				long major = strtol(start, &pos, 10);
-				if(pos >= end || *pos != '.')
-					throw GltfError("Version string must be in the format <major>.<minor>.");
-				pos++;
-				if(pos >= end)
-					throw GltfError("Version string must be in the format <major>.<minor>.");
-				long minor = strtol(pos, &pos, 10);
-				if(pos != end)
-					throw GltfError("Version string must be in the format <major>.<minor>.");
-				return { int(major), int(minor) };
-			};
-		if(auto it=asset.find("minVersion"); it != asset.end()) {
-			// check minVersion
-			auto v = parseVersion(*it);
-			if(get<0>(v) > 2 || (get<0>(v) == 2 && get<1>(v) > 0))
-				throw GltfError(string("Unsupported glTF format. "
-					"Minimal version required is ") + it->get_ref<json::string_t&>() +
-					" while currently supported version is 2.0.");
-		}
-		else {
-			// check version
-			const string& s = asset.at("version").get_ref<json::string_t&>();
-			auto v = parseVersion(s);
-			if(get<0>(v) != 2)
-				throw GltfError(string("Unsupported glTF format ") + s +
-					" while currently supported version is 2.0.");
-		}
-
-		// check required extensions
-		if(!extensionsRequired.empty()) {
-			constexpr const array supportedExtensions{
-				"KHR_materials_unlit",
-				"KHR_texture_transform",
-				"KHR_materials_emissive_strength",
-			};
-			vector<string*> unsupportedExtensions;
-			for(auto it=extensionsRequired.begin(),e=extensionsRequired.end(); it!=e; it++)
-				if(find(supportedExtensions.begin(), supportedExtensions.end(), *it) == supportedExtensions.end())
-					unsupportedExtensions.push_back(it->get_ptr<json::string_t*>());
-			if(!unsupportedExtensions.empty()) {
-				string s;
-				if(unsupportedExtensions.size() == 1)
-					s = "Unsupported glTF extension: ";
-				else
-					s = "Unsupported glTF extensions: ";
-				s += *unsupportedExtensions[0];
-				for(size_t i=1,c=unsupportedExtensions.size(); i<c; i++)
-					s += ", " + *unsupportedExtensions[i];
-				throw GltfError(s);
-			}
-		}
-	}
-
-	// print stats
-	cout << "Stats:" << endl;
-	cout << "   Scenes:    " << scenes.size() << endl;
-	cout << "   Nodes:     " << nodes.size() << endl;
-	cout << "   Meshes:    " << meshes.size() << endl;
-	cout << "   Textures:  " << textures.size() << endl;
-	cout << endl;
-
-	// read buffers
-	vector<vector<uint8_t>> bufferDataList;
-	bufferDataList.reserve(buffers.size());
-	for(auto& b : buffers) {
-
-		// get path
-		auto uriIt = b.find("uri");
-		if(uriIt == b.end())
-			throw GltfError("Unsupported functionality: Undefined buffer.uri.");
-		const string& bufferURI = uriIt->get_ref<json::string_t&>();
-		string s = decodeURI(bufferURI);
-		filesystem::path p = u8string_view(reinterpret_cast<const char8_t*>(s.data()), s.size());
-		if(p.is_relative())
-			p = filePath.parent_path() / p;
-
-		// open file
-		cout << "Opening buffer " << s << "..." << endl;
-		ifstream f(p, ios::in|ios::binary);
-		if(!f.is_open())
-			throw GltfError("Error opening file " + p.string() + ".");
-		f.exceptions(ifstream::badbit | ifstream::failbit);
-
-		// read content
-		size_t size = filesystem::file_size(p);
-		auto& bufferData = bufferDataList.emplace_back(size);
-		f.read(reinterpret_cast<char*>(bufferData.data()), size);
-		f.close();
-	}
-
-	// read nodes
-	struct Node {
-		vector<size_t> children;
-		glm::mat4 matrix;
-		size_t meshIndex;
-	};
-	vector<Node> nodeList(nodes.size());
-	for(size_t i=0,c=nodes.size(); i<c; i++) {
-
-		// get references
-		json::object_t& jobj = nodes[i].get_ref<json::object_t&>();
-		Node& node = nodeList[i];
-
-		// matrix
-		if(auto it = jobj.find("matrix"); it != jobj.end()) {
-
-			// translation, rotation and scale must not be present
-			if(jobj.find("translation") != jobj.end() || jobj.find("rotation") != jobj.end() ||
-			   jobj.find("scale") != jobj.end())
-				throw GltfError("If matrix is provided for the node, translation, rotation and scale must not be present.");
-
-			// read matrix
-			json::array_t& a = it->second.get_ref<json::array_t&>();
-			if(a.size() != 16)
-				throw GltfError("Node.matrix is not vector of 16 components.");
-			float* f = glm::value_ptr(node.matrix);
-			for(unsigned j=0; j<16; j++)
-				f[j] = float(a[j].get<json::number_float_t>());
-		}
-		else {
-
-			// read scale
-			glm::vec3 scale;
-			if(auto it = jobj.find("scale"); it != jobj.end()) {
-				json::array_t& a = it->second.get_ref<json::array_t&>();
-				if(a.size() != 3)
-					throw GltfError("Node.scale is not vector of three components.");
-				scale.x = float(a[0].get<json::number_float_t>());
-				scale.y = float(a[1].get<json::number_float_t>());
-				scale.z = float(a[2].get<json::number_float_t>());
-			}
-			else
-				scale = { 1.f, 1.f, 1.f };
-
-			// read rotation
-			if(auto it = jobj.find("rotation"); it != jobj.end()) {
-				json::array_t& a = it->second.get_ref<json::array_t&>();
-				if(a.size() != 4)
-					throw GltfError("Node.rotation is not vector of four components.");
-				glm::quat q;
-				q.x = float(a[0].get<json::number_float_t>());
-				q.y = float(a[1].get<json::number_float_t>());
-				q.z = float(a[2].get<json::number_float_t>());
-				q.w = float(a[3].get<json::number_float_t>());
-				glm::mat3 m = glm::mat3(q);
-				node.matrix[0] = glm::vec4(m[0] * scale.x, 0.f);
-				node.matrix[1] = glm::vec4(m[1] * scale.y, 0.f);;
-				node.matrix[2] = glm::vec4(m[2] * scale.z, 0.f);;
-				node.matrix[3] = glm::vec4(0.f, 0.f, 0.f, 1.f);
-			}
-			else {
-				// initialize matrix by scale only
-				memset(&node.matrix, 0, sizeof(node.matrix));
-				node.matrix[0][0] = scale.x;
-				node.matrix[1][1] = scale.y;
-				node.matrix[2][2] = scale.z;
-				node.matrix[3][3] = 1.f;
-			}
-
-			// read translation
-			if(auto it = jobj.find("translation"); it != jobj.end()) {
-				json::array_t& a = it->second.get_ref<json::array_t&>();
-				if(a.size() != 3)
-					throw GltfError("Node.translation is not vector of three components.");
-				node.matrix[3][0] = float(a[0].get<json::number_float_t>());
-				node.matrix[3][1] = float(a[1].get<json::number_float_t>());
-				node.matrix[3][2] = float(a[2].get<json::number_float_t>());
-			}
-
-		}
-
-		// read children
-		if(auto it = jobj.find("children"); it != jobj.end()) {
-			json::array_t& a = it->second.get_ref<json::array_t&>();
-			size_t size = a.size();
-			node.children.resize(size);
-			for(unsigned j=0; j<size; j++)
-				node.children[j] = size_t(a[j].get_ref<json::number_unsigned_t&>());
-		}
-
-		// read mesh index
-		if(auto it = jobj.find("mesh"); it != jobj.end())
-			node.meshIndex = size_t(it->second.get_ref<json::number_unsigned_t&>());
-		else
-			node.meshIndex = ~size_t(0);
-	}
-
-	// get default scene
-	size_t numScenes = scenes.size();
-	if(numScenes == 0)
-		return;
-	size_t defaultSceneIndex = glTF.value<json::number_unsigned_t>("scene", ~size_t(0));
-	if(defaultSceneIndex == ~size_t(0)) {
-		cout << "There is no default scene in the file. Using the first scene." << endl;
-		defaultSceneIndex = 0;
-	}
-	json& scene = scenes.at(defaultSceneIndex);
-
-	// iterate through root nodes
-	// and fill meshMatrixList
-	vector<vector<glm::mat4>> meshMatrixList(meshes.size());
-	if(auto rootNodesIt=scene.find("nodes"); rootNodesIt!=scene.end()) {
-		json& rootNodes = *rootNodesIt;
-		for(auto it=rootNodes.begin(); it!= rootNodes.end(); it++) {
-
-			// process node function
-			auto processNode =
-				[](size_t nodeIndex, const glm::mat4& parentMatrix, vector<Node>& nodeList,
-				   vector<vector<glm::mat4>>& meshMatrixList, const auto& processNode) -> void
-				{
-					// get node
-					Node& node = nodeList.at(nodeIndex);
-
-					// compute local matrix
-					glm::mat4 m = parentMatrix * node.matrix;
-
-					// assign one more instancing matrix to the mesh
-					if(node.meshIndex != ~size_t(0))
-						meshMatrixList.at(node.meshIndex).emplace_back(m);
-
-					// process children
-					for(size_t i=0,c=node.children.size(); i<c; i++)
-						processNode(node.children[i], m, nodeList, meshMatrixList, processNode);
-				};
-
-			// get node
-			size_t rootNodeIndex = size_t(it->get_ref<json::number_unsigned_t&>());
-			Node& node = nodeList.at(rootNodeIndex);
-
-			// compute root matrix
-			// (we need to flip y and z axes to get from glTF coordinate system to Vulkan coordinate system)
-			glm::mat4 m = node.matrix;
-			for(unsigned i=0; i<4; i++) {
-				m[i][1] = -m[i][1];
-				m[i][2] = -m[i][2];
-			}
-
-			// append instancing matrix to the mesh
-			if(node.meshIndex != ~size_t(0))
-				meshMatrixList.at(node.meshIndex).emplace_back(m);
-
-			// process children
-			for(size_t i=0,c=node.children.size(); i<c; i++)
-				processNode(node.children[i], m, nodeList, meshMatrixList, processNode);
-
-		}
-	}
-
-	// matrixLists
-	matrixLists.reserve(meshes.size());
-	for(size_t i=0, c=meshes.size(); i<c; i++) {
-		CadR::MatrixList& ml = matrixLists.emplace_back(renderer);
-		ml.setMatrices(meshMatrixList[i]);
-	}
-
-
-	// construct texture-glTF-index to image-glTF-index map
-	uint32_t numGltfTextures = uint32_t(textures.size());
-	uint32_t numGltfImages = uint32_t(images.size());
-	vector<size_t> gltfTextureToGltfImageMap(numGltfTextures, ~size_t(0));
-	for(uint32_t i=0; i<numGltfTextures; i++) {
-		auto& texture = textures[i];
-		auto sourceIt = texture.find("source");
-		if(sourceIt == texture.end())
-			throw GltfError("Unsupported functionality: Texture.source is not defined for the texture.");
-		size_t imageIndex = sourceIt->get_ref<json::number_unsigned_t&>();
-		if(imageIndex >= numGltfImages)
-			throw GltfError("Texture.source contains invalid value.");
-		gltfTextureToGltfImageMap[i] = imageIndex;
-	}
-
-
-	// create default material
-	struct UnlitMaterialData {
-		glm::vec4 colorAndAlpha;
-	#if 1  // optional members
-		float alphaCutoff;  // offset 16
-	#endif
-	};
-	constexpr unsigned unlitMaterialDataSize = 16;  // size without optional members
-	struct PhongMaterialData {
-		glm::vec3 ambient;  // offset 0
-		uint32_t padding1;
-		glm::vec4 diffuseAndAlpha;  // offset 16
-		glm::vec3 specular;  // offset 32
-		float shininess;  // offset 44
-		glm::vec3 emission;  // offset 48
-		float alphaCutoff;  // offset 60
-	#if 0  // optional members
-		glm::vec3 reflection;  // offset 64
-	#endif
-	};
-	static_assert(sizeof(PhongMaterialData) == 64 && "Wrong size of PhongMaterialData structure.");
-	constexpr unsigned phongMaterialDataSize = 64;  // size without optional members
-	struct MetallicRoughnessMaterialData {
-		glm::vec4 baseColorFactor;
-		float alphaCutoff;
-		float metallicFactor;
-		float roughnessFactor;
-		uint32_t padding1;
-		glm::vec3 emissiveFactor;
-		uint32_t padding2;
-	};
-	static_assert(sizeof(MetallicRoughnessMaterialData) == 48 && "Wrong size of MetallicRoughnessMaterialData structure.");
-	constexpr unsigned metallicRoughnessMaterialDataSize = 48;
-	struct StateSetMaterialData {
-		bool unlit;
-		bool doubleSided;
-		bool transparencyEnabled;
-		bool alphaTest;
-		unsigned materialTexturingParamsOffset;
-		array<uint32_t,10> shaderTextureSetup;
-	};
-	if(materialModel == MaterialModel::BlinPhong) {
-		// Phong material
-		CadR::StagingData sd = defaultMaterial.alloc(sizeof(PhongMaterialData));
-		PhongMaterialData* m = sd.data<PhongMaterialData>();
-		m->ambient = glm::vec3(1.f, 1.f, 1.f);
-		m->padding1 = 0;
-		m->diffuseAndAlpha = glm::vec4(1.f, 1.f, 1.f, 1.f);
-		m->specular = glm::vec3(0.f, 0.f, 0.f);
-		m->shininess = 0.f;
-		m->emission = glm::vec3(0.f, 0.f, 0.f);
-		m->alphaCutoff = 0.5f;
-	} else {
-		// Metallic-roughness material
-		CadR::StagingData sd = defaultMaterial.alloc(sizeof(MetallicRoughnessMaterialData));
-		MetallicRoughnessMaterialData* m = sd.data<MetallicRoughnessMaterialData>();
-		m->baseColorFactor = glm::vec4(1.f, 1.f, 1.f, 1.f);
-		m->alphaCutoff = 0.5f;
-		m->metallicFactor = 1.f;
-		m->roughnessFactor = 1.f;
-		m->emissiveFactor = glm::vec3(0.f, 0.f, 0.f);
-	}
-	StateSetMaterialData defaultStateSetMaterialData {
-		.unlit = false,
-		.doubleSided = false,
-		.transparencyEnabled = false,
-		.alphaTest = false,
-		.materialTexturingParamsOffset = 0,
-		.shaderTextureSetup = { 0 },  // no textures
-	};
-
-
-	// process materials
-	//
-	// (During the process, we mark textures whether we use them with sRGB opto-electronic
-	// transfer function, or if we use them with linear transfer function.
-	// We also construct mapping between texture and image indices inside glTF file
-	// and the indices into textureList and imageList used by the application.)
-	size_t numMaterials = materials.size();
-	materialList.reserve(numMaterials);
-	vector<StateSetMaterialData> stateSetMaterialDataList(numMaterials);
-	struct LinearAndSrgbIndices { unsigned linear; unsigned srgb; };
-	vector<LinearAndSrgbIndices> gltfImageToAppImageMap(numGltfImages, { ~unsigned(0), ~unsigned(0) });
-	vector<LinearAndSrgbIndices> gltfTextureToAppTextureMap(numGltfTextures, { ~unsigned(0), ~unsigned(0) });
-	unsigned numAppImages = 0;
-	unsigned numAppTextures = 0;
-	struct AppTextureInfo { unsigned gltfTextureIndex; bool srgb; };
-	vector<AppTextureInfo> appTextureInfoList;
-	appTextureInfoList.reserve(numGltfTextures);  // this will just fit the size if each texture is either linear or sRGB but not both
-	for(size_t materialIndex=0; materialIndex<numMaterials; materialIndex++) {
-
-		auto& material = materials.at(materialIndex);
-
-		struct TextureData {
-			unsigned textureID;
-			unsigned coordIndex;
-			float strength;
-			bool transformEnabled;
-			glm::vec2 offset;
-			float rotation;
-			glm::vec2 scale;
-		};
-
-		// values to be read from glTF
-		bool unlit;
-		bool doubleSided;
-		glm::vec4 baseColorFactor;
-		TextureData baseColorTexture;
-		TextureData metallicRoughnessOcclusionTexture;
-		TextureData metallicRoughnessTexture;
-		TextureData occlusionTexture;
-		TextureData normalTexture;
-		TextureData emissiveTexture;
-
-		float metallicFactor;
-		float roughnessFactor;
-		glm::vec3 emissiveFactor;
-		float emissiveStrength = 1.f;
-		bool transparencyEnabled;
-		bool alphaTest;
-		float alphaCutoff;
-
-		auto readTextureData =
-			[](TextureData& t, const char* jsonPropertyName, json& jsonParent, const unsigned numTextures,
-			   const char* strengthPropertyName = nullptr)
-			{
-				if(auto textureIt = jsonParent.find(jsonPropertyName); textureIt != jsonParent.end()) {
-
-					t.textureID = unsigned(textureIt->at("index").get_ref<json::number_unsigned_t&>());
-					if(t.textureID >= numTextures)
-						throw GltfError("baseColorTexture.index is out of range. It is not index to a valid texture.");
-					t.coordIndex = textureIt->value("texCoord", 0);
-					if(strengthPropertyName)
-						if(auto it = textureIt->find(strengthPropertyName); it != textureIt->end())
-							t.strength = float(it->get<json::number_float_t>());
-						else
-							t.strength = 1.f;
-					else
-						t.strength = 1.f;
-					if(auto extIt = textureIt->find("extensions"); extIt != textureIt->end()) {
-
-						// KHR_texture_transform
-						auto transformIt = extIt->find("KHR_texture_transform");
-						if(transformIt != extIt->end())
-						{
-							t.transformEnabled = true;
-
-							// KHR_texture_transform.offset
-							if(auto offsetIt = transformIt->find("offset"); offsetIt != transformIt->end()) {
-								json::array_t& a = offsetIt->get_ref<json::array_t&>();
-								if(a.size() != 2)
-									throw GltfError("Material.baseColorTexture.extensions.offset is not vector of two components.");
-								t.offset[0] = float(a[0].get<json::number_float_t>());
-								t.offset[1] = float(a[1].get<json::number_float_t>());
-							}
-							else {
-								t.offset[0] = 0.f;
-								t.offset[1] = 0.f;
-							}
-
-							// KHR_texture_transform.rotation
-							t.rotation = float(transformIt->value<json::number_float_t>("rotation", 0.f));
-
-							// KHR_texture_transform.scale
-							if(auto scaleIt = transformIt->find("scale"); scaleIt != transformIt->end()) {
-								json::array_t& a = scaleIt->get_ref<json::array_t&>();
-								if(a.size() != 2)
-									throw GltfError("Material.baseColorTexture.extensions.scale is not vector of two components.");
-								t.scale[0] = float(a[0].get<json::number_float_t>());
-								t.scale[1] = float(a[1].get<json::number_float_t>());
-							}
-							else {
-								t.scale[0] = 1.f;
-								t.scale[1] = 1.f;
-							}
-
-							// KHR_texture_transform.texCoord
-							if(auto texCoordIt = transformIt->find("texCoord"); texCoordIt != transformIt->end())
-								t.coordIndex = unsigned(texCoordIt->get_ref<json::number_unsigned_t&>());
-						}
-						else
-							t.transformEnabled = false;
-					}
-					else
-						t.transformEnabled = false;
-				}
-				else {
-					t.textureID = ~unsigned(0);
-					t.coordIndex = ~unsigned(0);
-				}
-			};
-
-		// unlit material extension
-		if(auto extIt = material.find("extensions"); extIt == material.end()) {
-			unlit = false;
-		}
-		else {
-			auto it = extIt->find("KHR_materials_unlit");
-			unlit = (it != extIt->end());
-			it = extIt->find("KHR_materials_emissive_strength");
-			if(it != extIt->end())
-				emissiveStrength = float(it->value<json::number_float_t>("emissiveStrength", 1.0));
-		}
-
-		// material.doubleSided is optional with the default value of false
-		doubleSided = material.value<json::boolean_t>("doubleSided", false);
-
-		// read pbr material properties
-		if(auto pbrIt = material.find("pbrMetallicRoughness"); pbrIt != material.end()) {
-
-			// read baseColorFactor
-			if(auto baseColorFactorIt = pbrIt->find("baseColorFactor"); baseColorFactorIt != pbrIt->end()) {
-				json::array_t& a = baseColorFactorIt->get_ref<json::array_t&>();
-				if(a.size() != 4)
-					throw GltfError("Material.pbrMetallicRoughness.baseColorFactor is not vector of four components.");
-				baseColorFactor[0] = float(a[0].get<json::number_float_t>());
-				baseColorFactor[1] = float(a[1].get<json::number_float_t>());
-				baseColorFactor[2] = float(a[2].get<json::number_float_t>());
-				baseColorFactor[3] = float(a[3].get<json::number_float_t>());
-			}
-			else
-				baseColorFactor = glm::vec4(1.f, 1.f, 1.f, 1.f);
-
-			// read properties
-			metallicFactor = float(pbrIt->value<json::number_float_t>("metallicFactor", 1.0));
-			roughnessFactor = float(pbrIt->value<json::number_float_t>("roughnessFactor", 1.0));
-
-			// base color texture
-			readTextureData(baseColorTexture, "baseColorTexture", *pbrIt, numGltfTextures);
-
-			// metallic-roughness texture
-			if(materialModel == MaterialModel::BlinPhong) {
-
-				// for Phong model, ignore metallic-roughness texture because it is not supported in the shader
-				metallicRoughnessTexture.textureID = ~unsigned(0);
-				metallicRoughnessTexture.coordIndex = ~unsigned(0);
-
-				// expect average value of metallic-roughness texture to be 0.5 =>
-				// multiply metallicFactor and roughnessFactor by 0.5
-				metallicFactor *= 0.5f;
-				roughnessFactor *= 0.5f;
-
-			}
-			else
-				readTextureData(metallicRoughnessTexture, "metallicRoughnessTexture", *pbrIt, numGltfTextures);
-
-		}
-		else
-		{
-			// default values when pbrMetallicRoughness is not present
-			baseColorFactor = glm::vec4(1.f, 1.f, 1.f, 1.f);
-			baseColorTexture.textureID = ~unsigned(0);
-			baseColorTexture.coordIndex = ~unsigned(0);
-			metallicRoughnessTexture.textureID = ~unsigned(0);
-			metallicRoughnessTexture.coordIndex = ~unsigned(0);
-			metallicFactor = 1.f;
-			roughnessFactor = 1.f;
-		}
-
-		// read emissiveFactor
-		if(auto emissiveFactorIt = material.find("emissiveFactor"); emissiveFactorIt != material.end()) {
-			json::array_t& a = emissiveFactorIt->get_ref<json::array_t&>();
-			if(a.size() != 3)
-				throw GltfError("Material.emissiveFactor is not vector of three components.");
-			emissiveFactor[0] = float(a[0].get<json::number_float_t>());
-			emissiveFactor[1] = float(a[1].get<json::number_float_t>());
-			emissiveFactor[2] = float(a[2].get<json::number_float_t>());
-		}
-		else
-			emissiveFactor = glm::vec3(0.f, 0.f, 0.f);
-
-		// normal texture
-		readTextureData(normalTexture, "normalTexture", material, numGltfTextures, "scale");
-
-		// occlusion texture
-		readTextureData(occlusionTexture, "occlusionTexture", material, numGltfTextures, "strength");
-
-		// emissive texture
-		readTextureData(emissiveTexture, "emissiveTexture", material, numGltfTextures);
-
-		// alphaMode
-		if(auto it=material.find("alphaMode"); it != material.end()) {
-			string alphaMode = it->get_ref<json::string_t&>();
-			if(alphaMode == "OPAQUE") {
-				transparencyEnabled = false;
-				alphaTest = false;
-			}
-			else if(alphaMode == "BLEND") {
-				transparencyEnabled = true;
-				alphaTest = false;
-				if(!dynamicRendering || numSamples != vk::SampleCountFlagBits::e1)
-					throw GltfError("BLEND alpha mode is not yet supported for render pass rendering or when multisampling.");
-			}
-			else if(alphaMode == "MASK") {
-				transparencyEnabled = false;
-				alphaTest = true;
-			}
-			else
-				throw GltfError("Unknown alpha mode.");
-		}
-		else {
-			transparencyEnabled = false;
-			alphaTest = false;
-		}
-
-		// alphaCutoff
-		alphaCutoff = float(material.value<json::number_float_t>("alphaCutoff", 0.5));
-
-		// combine metallicRoughnessTexture and occlusionTexture
-		// into metallicRoughnessOcclusionTexture
-		if(metallicRoughnessTexture.textureID != ~unsigned(0) &&
-		   metallicRoughnessTexture.textureID == occlusionTexture.textureID &&
-		   metallicRoughnessTexture.coordIndex == occlusionTexture.coordIndex &&
-		   metallicRoughnessTexture.transformEnabled == occlusionTexture.transformEnabled &&
-		   (!metallicRoughnessTexture.transformEnabled ||
-		      (metallicRoughnessTexture.offset == occlusionTexture.offset &&
-		       metallicRoughnessTexture.rotation == occlusionTexture.rotation &&
-		       metallicRoughnessTexture.scale == occlusionTexture.scale)
-		   ))
-		{
-			metallicRoughnessOcclusionTexture.textureID = metallicRoughnessTexture.textureID;
-			metallicRoughnessOcclusionTexture.coordIndex = metallicRoughnessTexture.coordIndex;
-			metallicRoughnessOcclusionTexture.strength = occlusionTexture.strength;
-			metallicRoughnessOcclusionTexture.transformEnabled = metallicRoughnessTexture.transformEnabled;
-			metallicRoughnessOcclusionTexture.offset = metallicRoughnessTexture.offset;
-			metallicRoughnessOcclusionTexture.rotation = metallicRoughnessTexture.rotation;
-			metallicRoughnessOcclusionTexture.scale = metallicRoughnessTexture.scale;
-			metallicRoughnessTexture.textureID = ~unsigned(0);
-			metallicRoughnessTexture.coordIndex = ~unsigned(0);
-			occlusionTexture.textureID = ~unsigned(0);
-			occlusionTexture.coordIndex = ~unsigned(0);
-		}
-		else {
-			// do not use metallicRoughnessOcclusionTexture
-			metallicRoughnessOcclusionTexture.textureID = ~unsigned(0);
-			metallicRoughnessOcclusionTexture.coordIndex = ~unsigned(0);
-		}
-
-		// core material size
-		unsigned materialSize = unlit ? unlitMaterialDataSize :
-			(materialModel==MaterialModel::BlinPhong) ? phongMaterialDataSize : metallicRoughnessMaterialDataSize;
-		if(unlit && alphaTest)
-			materialSize += 4;
-		unsigned coreMaterialSize = materialSize;
-
-		// texturing params size that are stored inside material
-		//
-		// each texture occupies at least 4 bytes inside material;
-		// if strength is used, it needs additional 4 bytes,
-		// if texture coordinate transform is enabled, addition 6 floats are needed,
-		// if blend color is used, extra 3 float are stored;
-		// so texturing data size varies between 4 and 4+4+24+12=44 bytes per one texture
-		auto getMaterialTexturingParamsSize =
-			[](const TextureData& t) -> unsigned
-			{
-				// texture not used
-				if(t.textureID == ~unsigned(0))
-					return 0;
-
-				unsigned r = 4;
-				if(t.transformEnabled)
-					r += 6*4;
-				if(t.strength != 1.f)
-					r += 4;
-				return r;
-			};
-
-		// append texturing params to material size
-		materialSize += getMaterialTexturingParamsSize(baseColorTexture);
-		materialSize += getMaterialTexturingParamsSize(metallicRoughnessOcclusionTexture);
-		materialSize += getMaterialTexturingParamsSize(metallicRoughnessTexture);
-		materialSize += getMaterialTexturingParamsSize(occlusionTexture);
-		materialSize += getMaterialTexturingParamsSize(normalTexture);
-		materialSize += getMaterialTexturingParamsSize(emissiveTexture);
-
-		// material
-		CadR::DataAllocation& a = materialList.emplace_back(renderer.dataStorage());
-		CadR::StagingData sd = a.alloc(materialSize);
-		uint8_t* p = sd.data<uint8_t>();
-		if(unlit) {
-			UnlitMaterialData* m = reinterpret_cast<UnlitMaterialData*>(p);
-			m->colorAndAlpha = baseColorFactor;
-			if(alphaTest)
-				m->alphaCutoff = alphaCutoff;
-		}
-		else if(materialModel == MaterialModel::BlinPhong) {
-			PhongMaterialData* m = reinterpret_cast<PhongMaterialData*>(p);
-			m->ambient = glm::vec3(baseColorFactor);
-			m->padding1 = 0;
-			m->diffuseAndAlpha = glm::vec4(glm::vec3(baseColorFactor) * (1.f - metallicFactor), baseColorFactor.a);  // very vague and imprecise conversion
-			m->specular = baseColorFactor * metallicFactor;  // very vague and imprecise conversion
-			m->shininess = (1.f - (roughnessFactor * roughnessFactor)) * 128.f;  // very vague and imprecise conversion
-			m->emission = emissiveFactor * emissiveStrength;
-			m->alphaCutoff = alphaCutoff;
-		}
-		else {
-			MetallicRoughnessMaterialData* m = reinterpret_cast<MetallicRoughnessMaterialData*>(p);
-			m->baseColorFactor = baseColorFactor;
-			m->alphaCutoff = alphaCutoff;
-			m->metallicFactor = metallicFactor;
-			m->roughnessFactor = roughnessFactor;
-			m->padding1 = 0;
-			m->emissiveFactor =emissiveFactor * emissiveStrength;
-			m->padding2 = 0;
-		}
-		p += coreMaterialSize;
-
-		// StateSetMaterialData
-		auto& ssm = stateSetMaterialDataList[materialIndex];
-		ssm.unlit = unlit;
-		ssm.doubleSided = doubleSided;
-		ssm.transparencyEnabled = transparencyEnabled;
-		ssm.alphaTest = alphaTest;
-		ssm.materialTexturingParamsOffset =
-			(materialSize == coreMaterialSize)
-				? 0  // no texture info
-				: coreMaterialSize;  // texture info just material data
-
-		// write texture record into material
-		auto writeTexture =
-			[](const TextureData& t, uint8_t type, uint8_t*& p,
-			   decltype(StateSetMaterialData::shaderTextureSetup)& shaderTextureSetup,
-			   unsigned& textureIndex)
-			{
-				// write texture transform
-				uint16_t settings;
-				if(t.transformEnabled)
-				{
-					settings = 0x1;
-					float* f = reinterpret_cast<float*>(p);
-					if(t.rotation == 0) {
-						f[0] = t.scale.x;
-						f[1] = 0.f;
-						f[2] = 0.f;
-						f[3] = t.scale.y;
-					} else {
-						float c = cos(t.rotation);
-						float s = sin(t.rotation);
-						f[0] = c * t.scale.x;
-						f[1] = -s * t.scale.x;
-						f[2] = s * t.scale.y;
-						f[3] = c * t.scale.y;
-					}
-					f[4] = t.offset.x;
-					f[5] = t.offset.y;
-					p += 24;
-				}
-				else {
-					settings = 0;
-				}
-
-				// write textureID
-				*reinterpret_cast<uint32_t*>(p) = t.textureID;
-				p += 4;
-
-				// write strength
-				if(t.strength != 1.f)
-				{
-					settings |= 0x2;
-					*reinterpret_cast<float*>(p) = t.strength;
-					p += 4;
-				}
-
-				// write textureSetup
-				shaderTextureSetup[textureIndex] =
-					(4 + t.coordIndex) |  // texture coordinates are placed on attribute 4 and following
-					(type << 8) |  // texture type (base, normal, emission,...)
-					(settings << 16);
-				textureIndex++;
-
-			};
-
-		// replace image index used by the glTF file
-		// by the index into imageList used by the application;
-		// allocate the space in textureList and imageList and
-		// create related mapping in appTextureIndices and appImageIndices
-		auto remapByTransferFunction =
-			[&](TextureData& t, bool srgb) -> void
-			{
-				size_t gltfImageIndex = gltfTextureToGltfImageMap[t.textureID];
-				LinearAndSrgbIndices& appTextureIndices = gltfTextureToAppTextureMap[t.textureID];
-				LinearAndSrgbIndices& appImageIndices = gltfImageToAppImageMap[gltfImageIndex];
-				if(srgb) {
-					if(appTextureIndices.srgb == ~unsigned(0)) {
-						appTextureIndices.srgb = numAppTextures;
-						appTextureInfoList.emplace_back(t.textureID, true);
-						numAppTextures++;
-					}
-					if(appImageIndices.srgb == ~unsigned(0)) {
-						appImageIndices.srgb = numAppImages;
-						t.textureID = numAppImages;
-						numAppImages++;
-					}
-					else
-						t.textureID = appImageIndices.srgb;
-				}
-				else {
-					if(appTextureIndices.linear == ~unsigned(0)) {
-						appTextureIndices.linear = numAppTextures;
-						appTextureInfoList.emplace_back(t.textureID, false);
-						numAppTextures++;
-					}
-					if(appImageIndices.linear == ~unsigned(0)) {
-						appImageIndices.linear = numAppImages;
-						t.textureID = numAppImages;
-						numAppImages++;
-					}
-					else
-						t.textureID = appImageIndices.linear;
-				}
-			};
-
-		// write textures
-		unsigned textureIndex = 0;
-		if(baseColorTexture.textureID != ~unsigned(0)) {
-			remapByTransferFunction(baseColorTexture, true);  // base texture uses sRGB transfer function
-			writeTexture(baseColorTexture, 1, p, ssm.shaderTextureSetup, textureIndex);
-		}
-		if(metallicRoughnessOcclusionTexture.textureID != ~unsigned(0)) {
-			remapByTransferFunction(metallicRoughnessOcclusionTexture, false);  // metallic-roughness-occlusion texture uses linear transfer function
-			writeTexture(metallicRoughnessOcclusionTexture, 2, p, ssm.shaderTextureSetup, textureIndex);
-		}
-		if(metallicRoughnessTexture.textureID != ~unsigned(0)) {
-			remapByTransferFunction(metallicRoughnessTexture, false);  // metallic-roughness texture uses linear transfer function
-			writeTexture(metallicRoughnessTexture, 3, p, ssm.shaderTextureSetup, textureIndex);
-		}
-		if(occlusionTexture.textureID != ~unsigned(0)) {
-			remapByTransferFunction(occlusionTexture, false);  // occlusion texture uses linear transfer function
-			writeTexture(occlusionTexture, 4, p, ssm.shaderTextureSetup, textureIndex);
-		}
-		if(normalTexture.textureID != ~unsigned(0)) {
-			remapByTransferFunction(normalTexture, false);  // normal texture uses linear transfer function
-			writeTexture(normalTexture, 5, p, ssm.shaderTextureSetup, textureIndex);
-		}
-		if(emissiveTexture.textureID != ~unsigned(0)) {
-			remapByTransferFunction(emissiveTexture, true);  // emissive texture uses sRGB transfer function
-			writeTexture(emissiveTexture, 6, p, ssm.shaderTextureSetup, textureIndex);
-		}
-
-		// fill remaining textureSetup items with zero
-		for(; textureIndex<ssm.shaderTextureSetup.size(); textureIndex++)
-			ssm.shaderTextureSetup[textureIndex] = 0;
-
-	}
-	gltfTextureToGltfImageMap.clear();  // no needed any more
-	gltfTextureToAppTextureMap.clear();  // no needed any more
-	assert(materialList.size() == numMaterials && "Not all materials were created.");
-
-
-	// process images
-	vector<vk::Format> imageFormatList(numAppImages, vk::Format::eUndefined);
-	if(!images.empty()) {
-
-		// get format support
-		// sRGB formats:
-		//    R8G8B8Srgb+R8G8Srgb+R8Srgb format support is optional in Vulkan 1.0
-		//    R8G8B8A8Srgb is mandatory in Vulkan 1.0
-		// UNorm formats:
-		//    R8G8B8Unorm format is optional in Vulkan 1.0
-		//    R8G8B8A8Unorm+R8G8Unorm+R8Unorm support is mandatory in Vulkan 1.0
-		vk::FormatProperties fp = vulkanInstance.getPhysicalDeviceFormatProperties(
-			physicalDevice, vk::Format::eR8G8B8Srgb);
-		bool rgb8srgbSupported =
-			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) &&
-			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eTransferDst);
-		fp = vulkanInstance.getPhysicalDeviceFormatProperties(physicalDevice, vk::Format::eR8G8Srgb);
-		bool rg8srgbSupported =
-			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) &&
-			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eTransferDst);
-		fp = vulkanInstance.getPhysicalDeviceFormatProperties(physicalDevice, vk::Format::eR8Srgb);
-		bool r8srgbSupported =
-			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) &&
-			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eTransferDst);
-		fp = vulkanInstance.getPhysicalDeviceFormatProperties(physicalDevice, vk::Format::eR8G8B8Unorm);
-		bool rgb8unormSupported =
-			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) &&
-			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eTransferDst);
-
-		// load images
-		size_t numGltfImages = images.size();
-		cout << "Processing images (" << numGltfImages << " in total)..." << endl;
-		imageList.reserve(numAppImages);
-		for(unsigned i=0; i<numAppImages; i++)
-			imageList.emplace_back(renderer.imageStorage());
-		for(size_t i=0; i<numGltfImages; i++) {
-
-			// skip not used images
-			auto [ linearImageIndex, srgbImageIndex ] = gltfImageToAppImageMap[i];
-			if(linearImageIndex == ~unsigned(0) && srgbImageIndex == ~unsigned(0))
-				continue;
-
-			auto& image = images[i];
-			auto uriIt = image.find("uri");
-			if(uriIt != image.end()) {
-
-				// image file name
-				const string& imageURI = uriIt->get_ref<json::string_t&>();
-				cout << "   " << imageURI;
-				string s = decodeURI(imageURI);
-				filesystem::path p = u8string_view(reinterpret_cast<const char8_t*>(s.data()), s.size());
-				if(p.is_relative())
-					p = filePath.parent_path() / p;
-
-				// open stream
-				ifstream fs(p, ios_base::in | ios_base::binary);
-				if(!fs)
-					goto failed;
-				else {
-
-					// file size
-					fs.seekg(0, ios_base::end);
-					size_t fileSize = fs.tellg();
-					fs.seekg(0, ios_base::beg);
-
-					// read file content
-					unique_ptr<unsigned char[]> imgBuffer = make_unique<unsigned char[]>(fileSize);
-					fs.read(reinterpret_cast<ifstream::char_type*>(imgBuffer.get()), fileSize);
-					if(!fs)
-						goto failed;
-					fs.close();
-
-					// image info
-					int width, height, imgNumComponents;
-					if(!stbi_info_from_memory(imgBuffer.get(), int(fileSize), &width, &height, &imgNumComponents))
-						goto failed;
-					int srgbNumComponents = imgNumComponents;
-
-					unique_ptr<stbi_uc[], void(*)(stbi_uc*)> data(
-						nullptr,
-						[](stbi_uc* ptr) { stbi_image_free(ptr); }
-					);
-					if(srgbImageIndex != ~unsigned(0))
-					{
-						vk::Format format;
-						size_t alignment;
-						switch(srgbNumComponents) {
-						case 4: // red, green, blue, alpha
-							format = vk::Format::eR8G8B8A8Srgb;
-							alignment = 4;
-							break;
-						case 3: // red, green, blue
-							if(rgb8srgbSupported) {
-								format = vk::Format::eR8G8B8Srgb;
-								alignment = 3;
-							}
-							else {
-								// fallback to alpha always one
-								format = vk::Format::eR8G8B8A8Srgb;
-								alignment = 4;
-								srgbNumComponents = 4;
-							}
-							break;
-						case 2: // grey, alpha
-							if(rg8srgbSupported) {
-								format = vk::Format::eR8G8Srgb;
-								alignment = 2;
-							}
-							else {
-								// fallback to expand grey into red+green+blue+alpha
-								format = vk::Format::eR8G8B8A8Srgb;
-								alignment = 4;
-								srgbNumComponents = 4;
-							}
-							break;
-						case 1: // grey
-							if(r8srgbSupported) {
-								format = vk::Format::eR8Srgb;
-								alignment = 1;
-							}
-							else if(rg8srgbSupported) {
-								// fallback to expand grey into grey+alpha
-								format = vk::Format::eR8G8Srgb;
-								alignment = 2;
-								srgbNumComponents = 2;
-							}
-							else if(rgb8srgbSupported) {
-								// fallback to expand grey into red+green+blue
-								format = vk::Format::eR8G8B8Srgb;
-								alignment = 3;
-								srgbNumComponents = 3;
-							}
-							else {
-								// fallback to expand grey into red+green+blue+alpha
-								format = vk::Format::eR8G8B8A8Srgb;
-								alignment = 4;
-								srgbNumComponents = 4;
-							}
-							break;
-						default: goto failed;
-						}
-
-						// load image
-						data.reset(
-							stbi_load_from_memory(imgBuffer.get(), int(fileSize),
-								&width, &height, nullptr, srgbNumComponents)
-						);
-						if(data == nullptr)
-							goto failed;
-
-						// copy data to staging buffer
-						size_t bufferSize = size_t(width) * height * srgbNumComponents;
-						CadR::StagingBuffer sb(renderer.imageStorage(), bufferSize, alignment);
-						memcpy(sb.data(), data.get(), bufferSize);
-						data.reset();
-
-						// create ImageAllocation
-						imageFormatList[srgbImageIndex] = format;
-						CadR::ImageAllocation& a = imageList[srgbImageIndex];
-						a.alloc(
-							vk::MemoryPropertyFlagBits::eDeviceLocal,  // requiredFlags
-							vk::ImageCreateInfo(  // imageCreateInfo
-								vk::ImageCreateFlags{},  // flags
-								vk::ImageType::e2D,  // imageType
-								format,  // format
-								vk::Extent3D(width, height, 1),  // extent
-								1,  // mipLevels
-								1,  // arrayLayers
-								vk::SampleCountFlagBits::e1,  // samples
-								vk::ImageTiling::eOptimal,  // tiling
-								vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,  // usage
-								vk::SharingMode::eExclusive,  // sharingMode
-								0,  // queueFamilyIndexCount
-								nullptr,  // pQueueFamilyIndices
-								vk::ImageLayout::eUndefined  // initialLayout
-							),
-							device  // vulkanDevice
-						);
-						sb.submit(
-							a,  // ImageAllocation
-							vk::ImageLayout::eUndefined,  // currentLayout,
-							vk::ImageLayout::eTransferDstOptimal,  // copyLayout,
-							vk::ImageLayout::eShaderReadOnlyOptimal,  // newLayout,
-							vk::PipelineStageFlagBits::eFragmentShader,  // newLayoutBarrierDstStages,
-							vk::AccessFlagBits::eShaderRead,  // newLayoutBarrierDstAccessFlags,
-							vk::Extent2D(width, height),  // imageExtent
-							bufferSize  // dataSize
-						);
-					}
-
-					if(linearImageIndex != ~unsigned(0))
-					{
-						vk::Format format;
-						size_t alignment;
-						int linearNumComponents = imgNumComponents;
-						switch(linearNumComponents) {
-						case 4: // red, green, blue, alpha
-							format = vk::Format::eR8G8B8A8Unorm;
-							alignment = 4;
-							break;
-						case 3: // red, green, blue
-							if(rgb8unormSupported) {
-								format = vk::Format::eR8G8B8Unorm;
-								alignment = 3;
-							}
-							else {
-								// fallback to alpha always one
-								format = vk::Format::eR8G8B8A8Unorm;
-								alignment = 4;
-								linearNumComponents = 4;
-							}
-							break;
-						case 2: // grey, alpha
-							format = vk::Format::eR8G8Unorm;
-							alignment = 2;
-							break;
-						case 1: // grey
-							format = vk::Format::eR8Unorm;
-							alignment = 1;
-							break;
-						default: goto failed;
-						}
-
-						// reload image only if necessary
-						if(!data || srgbNumComponents != linearNumComponents)
-						{
-							// load image
-							data.reset(
-								stbi_load_from_memory(imgBuffer.get(), int(fileSize),
-									&width, &height, nullptr, linearNumComponents)
-							);
-							if(data == nullptr)
-								goto failed;
-						}
-
-						// copy data to staging buffer
-						size_t bufferSize = size_t(width) * height * linearNumComponents;
-						CadR::StagingBuffer sb(renderer.imageStorage(), bufferSize, alignment);
-						memcpy(sb.data(), data.get(), bufferSize);
-						data.reset();
-
-						// create ImageAllocation
-						imageFormatList[linearImageIndex] = format;
-						CadR::ImageAllocation& a = imageList[linearImageIndex];
-						a.alloc(
-							vk::MemoryPropertyFlagBits::eDeviceLocal,  // requiredFlags
-							vk::ImageCreateInfo(  // imageCreateInfo
-								vk::ImageCreateFlags{},  // flags
-								vk::ImageType::e2D,  // imageType
-								format,  // format
-								vk::Extent3D(width, height, 1),  // extent
-								1,  // mipLevels
-								1,  // arrayLayers
-								vk::SampleCountFlagBits::e1,  // samples
-								vk::ImageTiling::eOptimal,  // tiling
-								vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,  // usage
-								vk::SharingMode::eExclusive,  // sharingMode
-								0,  // queueFamilyIndexCount
-								nullptr,  // pQueueFamilyIndices
-								vk::ImageLayout::eUndefined  // initialLayout
-							),
-							device  // vulkanDevice
-						);
-						sb.submit(
-							a,  // ImageAllocation
-							vk::ImageLayout::eUndefined,  // currentLayout,
-							vk::ImageLayout::eTransferDstOptimal,  // copyLayout,
-							vk::ImageLayout::eShaderReadOnlyOptimal,  // newLayout,
-							vk::PipelineStageFlagBits::eFragmentShader,  // newLayoutBarrierDstStages,
-							vk::AccessFlagBits::eShaderRead,  // newLayoutBarrierDstAccessFlags,
-							vk::Extent2D(width, height),  // imageExtent
-							bufferSize  // dataSize
-						);
-					}
-
-				}
-				goto succeed;
-			failed:
-				cout << " - failed" << endl;
-				throw GltfError("Failed to load texture " + imageURI + ".");
-			succeed:
-				cout << endl;
-			}
-		}
-	}
-
-	// process image samplers
-	if(!samplers.empty()) {
-
-		// default settings for samplers
-		vk::SamplerCreateInfo samplerCreateInfo(
-			vk::SamplerCreateFlags(),  // flags
-			vk::Filter::eNearest,  // magFilter - will be set later
-			vk::Filter::eNearest,  // minFilter - will be set later
-			vk::SamplerMipmapMode::eNearest,  // mipmapMode - will be set later
-			vk::SamplerAddressMode::eRepeat,  // addressModeU - will be set later
-			vk::SamplerAddressMode::eRepeat,  // addressModeV - will be set later
-			vk::SamplerAddressMode::eRepeat,  // addressModeW
-			0.f,  // mipLodBias
-			VK_TRUE,  // anisotropyEnable
-			maxSamplerAnisotropy,  // maxAnisotropy
-			VK_FALSE,  // compareEnable
-			vk::CompareOp::eNever,  // compareOp
-			0.f,  // minLod
-			0.f,  // maxLod
-			vk::BorderColor::eFloatTransparentBlack,  // borderColor
-			VK_FALSE  // unnormalizedCoordinates
-		);
-
-		// read image samplers
-		size_t c = samplers.size();
-		samplerList.reserve(c);
-		for(size_t i=0; i<c; i++) {
-			auto& sampler = samplers[i];
-
-			// magFilter
-			auto magFilterIt = sampler.find("magFilter");
-			if(magFilterIt != sampler.end()) {
-				switch(magFilterIt->get_ref<json::number_unsigned_t&>()) {
-				case 9728:  // GL_NEAREST
-					samplerCreateInfo.magFilter = vk::Filter::eNearest;
-					break;
-				case 9729:  // GL_LINEAR
-					samplerCreateInfo.magFilter = vk::Filter::eLinear;
-					break;
-				default:
-					throw GltfError("Sampler.magFilter contains invalid value.");
-				}
-			}
-			else {
-				// no defaults specified in glTF 2.0 spec
-				samplerCreateInfo.magFilter = vk::Filter::eNearest;
-			}
-
-			// minFilter
-			auto minFilterIt = sampler.find("minFilter");
-			if(minFilterIt != sampler.end()) {
-				switch(minFilterIt->get_ref<json::number_unsigned_t&>()) {
-				case 9728:  // GL_NEAREST
-					samplerCreateInfo.minFilter = vk::Filter::eNearest;
-					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;  // probably highest texture detail should be chosen here
-					break;
-				case 9729:  // GL_LINEAR
-					samplerCreateInfo.minFilter = vk::Filter::eLinear;
-					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;  // probably highest texture detail should be chosen here
-					break;
-				case 9984:  // GL_NEAREST_MIPMAP_NEAREST
-					samplerCreateInfo.minFilter = vk::Filter::eNearest;
-					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
-					break;
-				case 9985:  // GL_LINEAR_MIPMAP_NEAREST
-					samplerCreateInfo.minFilter = vk::Filter::eLinear;
-					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
-					break;
-				case 9986:  // GL_NEAREST_MIPMAP_LINEAR
-					samplerCreateInfo.minFilter = vk::Filter::eNearest;
-					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
-					break;
-				case 9987: // GL_LINEAR_MIPMAP_LINEAR
-					samplerCreateInfo.minFilter = vk::Filter::eLinear;
-					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
-					break;
-				default:
-					throw GltfError("Sampler.minFilter contains invalid value.");
-				}
-			}
-			else {
-				// no defaults specified in glTF 2.0 spec
-				samplerCreateInfo.minFilter = vk::Filter::eNearest;
-				samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
-			}
-
-			// wrapS
-			auto wrapSIt = sampler.find("wrapS");
-			if(wrapSIt != sampler.end()) {
-				switch(wrapSIt->get_ref<json::number_unsigned_t&>()) {
-				case 33071:  // GL_CLAMP_TO_EDGE
-					samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
-					break;
-				case 33648:  // GL_MIRRORED_REPEAT
-					samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eMirroredRepeat;
-					break;
-				case 10497:  // GL_REPEAT
-					samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
-					break;
-				default:
-					throw GltfError("Sampler.wrapS contains invalid value.");
-				}
-			}
-			else  // default is GL_REPEAT
-				samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
-
-			// wrapT
-			auto wrapTIt = sampler.find("wrapT");
-			if(wrapTIt != sampler.end()) {
-				switch(wrapTIt->get_ref<json::number_unsigned_t&>()) {
-				case 33071:  // GL_CLAMP_TO_EDGE
-					samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
-					break;
-				case 33648:  // GL_MIRRORED_REPEAT
-					samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eMirroredRepeat;
-					break;
-				case 10497:  // GL_REPEAT
-					samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
-					break;
-				default:
-					throw GltfError("Sampler.wrapT contains invalid value.");
-				}
-			}
-			else  // default is GL_REPEAT
-				samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
-
-			// create sampler
-			samplerList.emplace_back(renderer, samplerCreateInfo);
-
-		}
-	}
-
-	// texture descriptors
-	uint32_t numTextureDescriptors = numAppTextures>0 ? numAppTextures : 1;
-	layoutOnlyPipeline.init(nullptr, pipelineSceneGraph.pipelineLayout(), nullptr);
-	stateSetRoot.pipeline = &layoutOnlyPipeline;
-	stateSetRoot.allocDescriptorSets(
-		vk::DescriptorPoolCreateInfo(
-			vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind,  // flags
-			1,  // maxSets
-			1,  // poolSizeCount
-			array{  // pPoolSizes
-				vk::DescriptorPoolSize(
-					vk::DescriptorType::eCombinedImageSampler,  // type
-					numTextureDescriptors  // descriptorCount
-				),
-			}.data()
-		),
-		pipelineSceneGraph.descriptorSetLayoutList(),
-		&(const vk::DescriptorSetVariableDescriptorCountAllocateInfo&)vk::DescriptorSetVariableDescriptorCountAllocateInfo(
-			1,  // descriptorSetCount
-			&numTextureDescriptors  // pDescriptorCounts
-		)
-	);
-
-	// process textures
-	if(numAppTextures > 0) {
-		textureList.reserve(numAppTextures);
-		for(uint32_t i=0; i<numAppTextures; i++) {
-
-			// glTF texture
-			auto [ gltfTextureIndex, srgb ] = appTextureInfoList[i];
-			auto& texture = textures[gltfTextureIndex];
-
-			// source / glTF image index
-			auto sourceIt = texture.find("source");
-			if(sourceIt == texture.end())
-				throw GltfError("Unsupported functionality: Texture.source is not defined for the texture.");
-			size_t gltfImageIndex = sourceIt->get_ref<json::number_unsigned_t&>();
-			LinearAndSrgbIndices appImageIndices = gltfImageToAppImageMap[gltfImageIndex];
-			size_t appImageIndex = srgb ? appImageIndices.srgb : appImageIndices.linear;
-
-			// sampler
-			auto samplerIt = texture.find("sampler");
-			vk::Sampler vkSampler;
-			if(samplerIt != texture.end()) {
-				size_t samplerIndex = samplerIt->get_ref<json::number_unsigned_t&>();
-				vkSampler = samplerList.at(samplerIndex).handle();
-			}
-			else {
-				// create default sampler only if needed
-				if(!defaultSampler.handle()) {
-					defaultSampler.create(
-						vk::SamplerCreateInfo(
-							vk::SamplerCreateFlags(),  // flags
-							vk::Filter::eNearest,  // magFilter - glTF specifies to use "auto filtering", but what is that?
-							vk::Filter::eNearest,  // minFilter - glTF specifies to use "auto filtering", but what is that?
-							vk::SamplerMipmapMode::eNearest,  // mipmapMode
-							vk::SamplerAddressMode::eRepeat,  // addressModeU
-							vk::SamplerAddressMode::eRepeat,  // addressModeV
-							vk::SamplerAddressMode::eRepeat,  // addressModeW
-							0.f,  // mipLodBias
-							VK_TRUE,  // anisotropyEnable
-							maxSamplerAnisotropy,  // maxAnisotropy
-							VK_FALSE,  // compareEnable
-							vk::CompareOp::eNever,  // compareOp
-							0.f,  // minLod
-							0.f,  // maxLod
-							vk::BorderColor::eFloatTransparentBlack,  // borderColor
-							VK_FALSE  // unnormalizedCoordinates
-						)
-					);
-				}
-				vkSampler = defaultSampler.handle();
-			}
-
-			// create texture
-			textureList.emplace_back(
-				imageList[appImageIndex], // imageAllocation
-				vk::ImageViewCreateInfo(  // imageViewCreateInfo
-					vk::ImageViewCreateFlags(),  // flags
-					nullptr,  // image - will be filled in later
-					vk::ImageViewType::e2D,  // viewType
-					imageFormatList[appImageIndex],  // format
-					vk::ComponentMapping{  // components
-						vk::ComponentSwizzle::eR,
-						vk::ComponentSwizzle::eG,
-						vk::ComponentSwizzle::eB,
-						vk::ComponentSwizzle::eA,
-					},
-					vk::ImageSubresourceRange{  // subresourceRange
-						vk::ImageAspectFlagBits::eColor,  // aspectMask
-						0,  // baseMipLevel
-						1,  // levelCount
-						0,  // baseArrayLayer
-						1,  // layerCount
-					}
-				),
-				vkSampler,  // sampler
-				device  // device
-			);
-		}
-
-		// update descriptor sets
-		vector<vk::DescriptorImageInfo> imageInfoList(numAppTextures);
-		for(uint32_t i=0; i<numAppTextures; i++) {
-			const CadR::Texture& t = textureList[i];
-			imageInfoList[i] = {
-				t.sampler(),  // sampler
-				t.imageView(), // imageView
-				vk::ImageLayout::eShaderReadOnlyOptimal  // imageLayout
-			};
-		}
-		vk::WriteDescriptorSet writeInfo(
-			stateSetRoot.descriptorSet(0),  // dstSet
-			0,  // dstBinding
-			0,  // dstArrayElement
-			numAppTextures,  // descriptorCount
-			vk::DescriptorType::eCombinedImageSampler,  // descriptorType
-			imageInfoList.data(),  // pImageInfo
-			nullptr,  // pBufferInfo
-			nullptr  // pTexelBufferView
-		);
-		stateSetRoot.updateDescriptorSet(1, &writeInfo);
-	}
-	gltfImageToAppImageMap.clear();  // no needed any more
-	appTextureInfoList.clear();  // no needed any more
-	imageFormatList.clear();  // no needed any more
-
-
-	// process meshes
-	cout << "Processing meshes..." << endl;
-	size_t numMeshes = meshes.size();
-	if(numMeshes == 0)
-		throw GltfError("No meshes in the model.");
-	vector<CadR::BoundingSphere> meshBoundingSphereList(numMeshes, CadR::BoundingSphere::empty());
-	vector<CadR::BoundingSphere> primitiveSetBSList;
-	for(size_t meshIndex=0; meshIndex<numMeshes; meshIndex++) {
-
-		// ignore non-instanced meshes
-		if(meshMatrixList[meshIndex].empty())
-			continue;
-
-		// get mesh
-		auto& mesh = meshes[meshIndex];
-		CadR::BoundingBox meshBB = CadR::BoundingBox::empty();
-
-		// process primitives
-		// (mesh.primitives are mandatory)
-		auto& primitives = mesh.at("primitives");
-		if(primitives.empty())
-			throw GltfError("No primitives in the mesh.");
-		primitiveSetBSList.clear();
-		primitiveSetBSList.reserve(primitives.size());
-		for(auto& primitive : primitives) {
-
-			// mesh.primitive helper functions
-			auto getColorFromVec4f =
-				[](uint8_t* srcPtr) -> glm::vec4 {
-					glm::vec4 r = *reinterpret_cast<glm::vec4*>(srcPtr);
-					return glm::clamp(r, 0.f, 1.f);
-				};
-			auto getColorFromVec3f =
-				[](uint8_t* srcPtr) -> glm::vec4 {
-					return
-						glm::vec4(
-							glm::clamp(*reinterpret_cast<glm::vec3*>(srcPtr), 0.f, 1.f),
-							1.f
-						);
-				};
-			auto getColorFromVec4us =
-				[](uint8_t* srcPtr) -> glm::vec4 {
-					return
-						glm::vec4(
-							float(reinterpret_cast<uint16_t*>(srcPtr)[0]) / 65535.f,
-							float(reinterpret_cast<uint16_t*>(srcPtr)[1]) / 65535.f,
-							float(reinterpret_cast<uint16_t*>(srcPtr)[2]) / 65535.f,
-							float(reinterpret_cast<uint16_t*>(srcPtr)[3]) / 65535.f
-						);
-				};
-			auto getColorFromVec3us =
-				[](uint8_t* srcPtr) -> glm::vec4 {
-					return
-						glm::vec4(
-							float(reinterpret_cast<uint16_t*>(srcPtr)[0]) / 65535.f,
-							float(reinterpret_cast<uint16_t*>(srcPtr)[1]) / 65535.f,
-							float(reinterpret_cast<uint16_t*>(srcPtr)[2]) / 65535.f,
-							1.f
-						);
-				};
-			auto getColorFromVec4ub =
-				[](uint8_t* srcPtr) -> glm::vec4 {
-					return
-						glm::vec4(
-							float(reinterpret_cast<uint8_t*>(srcPtr)[0]) / 255.f,
-							float(reinterpret_cast<uint8_t*>(srcPtr)[1]) / 255.f,
-							float(reinterpret_cast<uint8_t*>(srcPtr)[2]) / 255.f,
-							float(reinterpret_cast<uint8_t*>(srcPtr)[3]) / 255.f
-						);
-				};
-			auto getColorFromVec3ub =
-				[](uint8_t* srcPtr) -> glm::vec4 {
-					return
-						glm::vec4(
-							float(reinterpret_cast<uint8_t*>(srcPtr)[0]) / 255.f,
-							float(reinterpret_cast<uint8_t*>(srcPtr)[1]) / 255.f,
-							float(reinterpret_cast<uint8_t*>(srcPtr)[2]) / 255.f,
-							1.f
-						);
-				};
-			auto getTexCoordFromVec2f =
-				[](uint8_t* srcPtr) -> glm::vec4 {
-					return
-						glm::vec4(
-							*reinterpret_cast<glm::vec2*>(srcPtr),
-							0.f,
-							0.f
-						);
-				};
-			auto getTexCoordFromVec2us =
-				[](uint8_t* srcPtr) -> glm::vec4 {
-					return
-						glm::vec4(
-							float(reinterpret_cast<uint16_t*>(srcPtr)[0]) / 65535.f,
-							float(reinterpret_cast<uint16_t*>(srcPtr)[1]) / 65535.f,
-							0.f,
-							0.f
-						);
-				};
-			auto getTexCoordFromVec2ub =
-				[](uint8_t* srcPtr) -> glm::vec4 {
-					return
-						glm::vec4(
-							float(reinterpret_cast<uint8_t*>(srcPtr)[0]) / 255.f,
-							float(reinterpret_cast<uint8_t*>(srcPtr)[1]) / 255.f,
-							0.f,
-							0.f
-						);
-				};
-			auto updateNumVertices =
-				[](json& accessor, size_t& numVertices) -> void
-				{
-					// get position count (accessor.count is mandatory and >=1)
-					json::number_unsigned_t count = accessor.at("count").get_ref<json::number_unsigned_t&>();
-
-					// update numVertices if still set to 0
-					if(numVertices != count) {
-						if(numVertices == 0) {
-							if(count != 0)
-								numVertices = count;
-							else
-								throw GltfError("Accessor's count member must be greater than zero.");
-						}
-						else
-							throw GltfError("Number of elements is not the same for all primitive attributes.");
-					}
-				};
-			auto getDataPointerAndStride =
-				[](json& accessor, json::array_t& bufferViews, json::array_t& buffers, vector<vector<uint8_t>>& bufferDataList,
-				   size_t numElements, size_t elementSize) -> tuple<void*, unsigned>
-				{
-					// accessor.sparse is not supported yet
-					if(accessor.find("sparse") != accessor.end())
-						throw GltfError("Unsupported functionality: Property sparse.");
-
-					// get accessor.bufferView (it is optional)
-					auto bufferViewIt = accessor.find("bufferView");
-					if(bufferViewIt == accessor.end())
-						throw GltfError("Unsupported functionality: Omitted bufferView.");
-					auto& bufferView = bufferViews.at(bufferViewIt->get_ref<json::number_unsigned_t&>());
-
-					// bufferView.byteStride (it is optional (but mandatory in some cases), if not provided, data are tightly packed)
-					unsigned stride = unsigned(bufferView.value<json::number_unsigned_t>("byteStride", elementSize));
-					size_t dataSize = (numElements-1) * stride + elementSize;
-
-					// get accessor.byteOffset (it is optional with default value 0)
-					json::number_unsigned_t offset = accessor.value<json::number_unsigned_t>("byteOffset", 0);
-
-					// make sure we not run over bufferView.byteLength (byteLength is mandatory and >=1)
-					if(offset + dataSize > bufferView.at("byteLength").get_ref<json::number_unsigned_t&>())
-						throw GltfError("Accessor range is not completely inside its BufferView.");
-
-					// append bufferView.byteOffset (byteOffset is optional with default value 0)
-					offset += bufferView.value<json::number_unsigned_t>("byteOffset", 0);
-
-					// get bufferView.buffer (buffer is mandatory)
-					size_t bufferIndex = bufferView.at("buffer").get_ref<json::number_unsigned_t&>();
-
-					// get buffer
-					auto& buffer = buffers.at(bufferIndex);
-
-					// make sure we do not run over buffer.byteLength (byteLength is mandatory)
-					if(offset + dataSize > buffer.at("byteLength").get_ref<json::number_unsigned_t&>())
-						throw GltfError("BufferView range is not completely inside its Buffer.");
-
-					// return pointer to buffer data and data stride
-					auto& bufferData = bufferDataList[bufferIndex];
-					if(offset + dataSize > bufferData.size())
-						throw GltfError("BufferView range is not completely inside data range.");
-					return { bufferData.data() + offset, stride };
-				};
-
-			// attributes (mesh.primitive.attributes is mandatory)
-			auto& attributes = primitive.at("attributes");
-			uint32_t vertexSize = 0;
-			size_t numVertices = 0;
-			glm::vec3* positionData = nullptr;
-			glm::vec3* normalData = nullptr;
-			unsigned positionDataStride;
-			unsigned normalDataStride;
-			uint8_t* colorData = nullptr;
-			glm::vec4 (*getColorFunc)(uint8_t* srcPtr);
-			unsigned colorDataStride;
-			vector<tuple<uint8_t*, glm::vec4 (*)(uint8_t* srcPtr), unsigned>> texCoordAttribInfoList;
-			glm::vec4* tangentData = nullptr;
-			unsigned tangentDataStride;
-			CadR::BoundingBox primitiveSetBB;
-			for(auto it = attributes.begin(); it != attributes.end(); it++) {
-				if(it.key() == "POSITION") {
-
-					// vertex size
-					vertexSize += 16;
-
-					// accessor
-					json& accessor = accessors.at(it.value().get_ref<json::number_unsigned_t&>());
-
-					// accessor.type is mandatory and it must be VEC3 for position accessor
-					if(accessor.at("type").get_ref<json::string_t&>() != "VEC3")
-						throw GltfError("Position attribute is not of VEC3 type.");
-
-					// accessor.componentType is mandatory and it must be FLOAT (5126) for position accessor
-					if(accessor.at("componentType").get_ref<json::number_unsigned_t&>() != 5126)
-						throw GltfError("Position attribute componentType is not float.");
-
-					// accessor.normalized is optional with default value false; it must be false for float componentType
-					if(auto it=accessor.find("normalized"); it!=accessor.end())
-						if(it->get_ref<json::boolean_t&>() == true)
-							throw GltfError("Position attribute normalized flag is true.");
-
-					// update numVertices
-					updateNumVertices(accessor, numVertices);
-
-					// position data and stride
-					tie(reinterpret_cast<void*&>(positionData), positionDataStride) =
-						getDataPointerAndStride(accessor, bufferViews, buffers, bufferDataList,
-						                        numVertices, sizeof(glm::vec3));
-
-					// get min and max
-					// (they are always specified for POSITION attribute and,
-					// since count is always >=1, they always contain valid value)
-					if(auto it=accessor.find("min"); it!=accessor.end()) {
-						json::array_t& a = it->get_ref<json::array_t&>();
-						if(a.size() != 3)
-							throw GltfError("POSITION's Accessor.min is not vector of three components.");
-						primitiveSetBB.min.x = float(a[0].get<json::number_float_t>());
-						primitiveSetBB.min.y = float(a[1].get<json::number_float_t>());
-						primitiveSetBB.min.z = float(a[2].get<json::number_float_t>());
-					}
-					else
-						throw GltfError("Accessor.min must be defined for POSITION accessor.");
-					if(auto it=accessor.find("max"); it!=accessor.end()) {
-						json::array_t& a = it->get_ref<json::array_t&>();
-						if(a.size() != 3)
-							throw GltfError("POSITION's Accessor.max is not vector of three components.");
-						primitiveSetBB.max.x = float(a[0].get<json::number_float_t>());
-						primitiveSetBB.max.y = float(a[1].get<json::number_float_t>());
-						primitiveSetBB.max.z = float(a[2].get<json::number_float_t>());
-					}
-					else
-						throw GltfError("Accessor.max must be defined for POSITION accessor.");
-
-				}
-				else if(it.key() == "NORMAL") {
-
-					// vertex size
-					vertexSize += 16;
-
-					// accessor
-					json& accessor = accessors.at(it.value().get_ref<json::number_unsigned_t&>());
-
-					// accessor.type is mandatory and it must be VEC3 for normal accessor
-					if(accessor.at("type").get_ref<json::string_t&>() != "VEC3")
-						throw GltfError("Normal attribute is not of VEC3 type.");
-
-					// accessor.componentType is mandatory and it must be FLOAT (5126) for normal accessor
-					if(accessor.at("componentType").get_ref<json::number_unsigned_t&>() != 5126)
-						throw GltfError("Normal attribute componentType is not float.");
-
-					// accessor.normalized is optional with default value false; it must be false for float componentType
-					if(auto it=accessor.find("normalized"); it!=accessor.end())
-						if(it->get_ref<json::boolean_t&>() == true)
-							throw GltfError("Normal attribute normalized flag is true.");
-
-					// update numVertices
-					updateNumVertices(accessor, numVertices);
-
-					// normal data and stride
-					tie(reinterpret_cast<void*&>(normalData), normalDataStride) =
-						getDataPointerAndStride(accessor, bufferViews, buffers, bufferDataList,
-						                        numVertices, sizeof(glm::vec3));
-
-				}
-				else if(it.key() == "COLOR_0") {
-
-					// vertex size
-					vertexSize += 16;
-
-					// accessor
-					json& accessor = accessors.at(it.value().get_ref<json::number_unsigned_t&>());
-
-					// accessor.type is mandatory and it must be VEC3 or VEC4 for color accessors
-					const json::string_t& t = accessor.at("type").get_ref<json::string_t&>();
-					if(t != "VEC3" && t != "VEC4")
-						throw GltfError("Color attribute is not of VEC3 or VEC4 type.");
-
-					// accessor.componentType is mandatory and it must be FLOAT (5126),
-					// UNSIGNED_BYTE (5121) or UNSIGNED_SHORT (5123) for color accessors
-					const json::number_unsigned_t ct = accessor.at("componentType").get_ref<json::number_unsigned_t&>();
-					if(ct != 5126 && ct != 5121 && ct != 5123)
-						throw GltfError("Color attribute componentType is not float, unsigned byte, or unsigned short.");
-
-					// accessor.normalized is optional with default value false; it must be false for float componentType
-					if(auto it=accessor.find("normalized"); it!=accessor.end()) {
-						if(it->get_ref<json::boolean_t&>() == false) {
-							if(ct == 5121 || ct == 5123)
-								throw GltfError("Color attribute component type is set to unsigned byte or unsigned short while normalized flag is not true.");
-						}
-						else
-							if(ct == 5126)
-								throw GltfError("Color attribute component type is set to float while normalized flag is true.");
-					} else
-						if(ct == 5121 || ct == 5123)
-							throw GltfError("Color attribute component type is set to unsigned byte or unsigned short while normalized flag is not true.");
-
-					// update numVertices
-					updateNumVertices(accessor, numVertices);
-
-					// getColorFunc and elementSize
-					size_t elementSize;
-					if(t == "VEC4")
-						switch(ct) {
-						case 5126: getColorFunc = getColorFromVec4f;  elementSize = 16; break;
-						case 5121: getColorFunc = getColorFromVec4ub; elementSize = 4;  break;
-						case 5123: getColorFunc = getColorFromVec4us; elementSize = 8;  break;
-						}
-					else // "VEC3"
-						switch(ct) {
-						case 5126: getColorFunc = getColorFromVec3f;  elementSize = 12; break;
-						case 5121: getColorFunc = getColorFromVec3ub; elementSize = 3;  break;
-						case 5123: getColorFunc = getColorFromVec3us; elementSize = 6;  break;
-						}
-
-					// color data and stride
-					tie(reinterpret_cast<void*&>(colorData), colorDataStride) =
-						getDataPointerAndStride(accessor, bufferViews, buffers, bufferDataList,
-						                        numVertices, elementSize);
-
-				}
-				else if(it.key().starts_with("TEXCOORD_")) {
-
-					// get texCoordIndex from TEXCOORD_[texCoordIndex] string
-					char* endp;
-					const char* startp = it.key().c_str();
-					unsigned texCoordIndex = strtoul(startp+9, &endp, 10);
-					if(endp-startp != std::ptrdiff_t(it.key().size()))
-						throw GltfError("TexCoord attribute name is invalid.");
-
-					// vertex size
-					vertexSize += 16;
-
-					// accessor
-					json& accessor = accessors.at(it.value().get_ref<json::number_unsigned_t&>());
-
-					// accessor.type is mandatory and it must be VEC2 for texCoord accessors
-					const json::string_t& t = accessor.at("type").get_ref<json::string_t&>();
-					if(t != "VEC2")
-						throw GltfError("TexCoord attribute is not of VEC2 type.");
-
-					// accessor.componentType is mandatory and it must be FLOAT (5126),
-					// UNSIGNED_BYTE (5121) or UNSIGNED_SHORT (5123) for texCoord accessors
-					const json::number_unsigned_t ct = accessor.at("componentType").get_ref<json::number_unsigned_t&>();
-					if(ct != 5126 && ct != 5121 && ct != 5123)
-						throw GltfError("TexCoord attribute componentType is not float, unsigned byte, or unsigned short.");
-
-					// accessor.normalized is optional with default value false; it must be false for float componentType
-					if(auto it=accessor.find("normalized"); it!=accessor.end()) {
-						if(it->get_ref<json::boolean_t&>() == false) {
-							if(ct == 5121 || ct == 5123)
-								throw GltfError("TexCoord attribute component type is set to unsigned byte or unsigned short while normalized flag is not true.");
-						}
-						else
-							if(ct == 5126)
-								throw GltfError("TexCoord attribute component type is set to float while normalized flag is true.");
-					} else
-						if(ct == 5121 || ct == 5123)
-							throw GltfError("TexCoord attribute component type is set to unsigned byte or unsigned short while normalized flag is not true.");
-
-					// update numVertices
-					updateNumVertices(accessor, numVertices);
-
-					// getTexCoordFunc and elementSize
-					glm::vec4 (*getTexCoordFunc)(uint8_t* srcPtr);
-					size_t elementSize;
-					switch(ct) {
-					case 5126: getTexCoordFunc = getTexCoordFromVec2f;  elementSize = 8; break;
-					case 5121: getTexCoordFunc = getTexCoordFromVec2ub; elementSize = 2; break;
-					case 5123: getTexCoordFunc = getTexCoordFromVec2us; elementSize = 4; break;
-					}
-
-					// texCoord data and stride
-					uint8_t* texCoordData;
-					unsigned texCoordDataStride;
-					tie(reinterpret_cast<void*&>(texCoordData), texCoordDataStride) =
-						getDataPointerAndStride(accessor, bufferViews, buffers, bufferDataList,
-						                        numVertices, elementSize);
-
-					// insert data into texCoordAttribInfoList
-					if(texCoordAttribInfoList.size() == texCoordIndex)
-						texCoordAttribInfoList.emplace_back(texCoordData, getTexCoordFunc, texCoordDataStride);
-					else if(texCoordAttribInfoList.size() > texCoordIndex)
-						texCoordAttribInfoList[texCoordIndex] = make_tuple(texCoordData, getTexCoordFunc, texCoordDataStride);
-					else {
-						if(texCoordAttribInfoList.capacity() <= texCoordIndex)
-							texCoordAttribInfoList.reserve(max(size_t(texCoordIndex)+1, texCoordAttribInfoList.capacity()*2));
-						while(texCoordAttribInfoList.size() != texCoordIndex)
-							texCoordAttribInfoList.emplace_back(nullptr, nullptr, 0);
-						texCoordAttribInfoList.emplace_back(texCoordData, getTexCoordFunc, texCoordDataStride);
-					}
-
-				}
-				else if(it.key() == "TANGENT") {
-
-					// vertex size
-					vertexSize += 16;
-
-					// accessor
-					json& accessor = accessors.at(it.value().get_ref<json::number_unsigned_t&>());
-
-					// accessor.type is mandatory and it must be VEC4 for tangent accessor
-					if(accessor.at("type").get_ref<json::string_t&>() != "VEC4")
-						throw GltfError("Tangent attribute is not of VEC4 type.");
-
-					// accessor.componentType is mandatory and it must be FLOAT (5126) for tangent accessor
-					if(accessor.at("componentType").get_ref<json::number_unsigned_t&>() != 5126)
-						throw GltfError("Tangent attribute componentType is not float.");
-
-					// accessor.normalized is optional with default value false; it must be false for float componentType
-					if(auto it=accessor.find("normalized"); it!=accessor.end())
-						if(it->get_ref<json::boolean_t&>() == true)
-							throw GltfError("Tangent attribute normalized flag is true.");
-
-					// update numVertices
-					updateNumVertices(accessor, numVertices);
-
-					// tangent data and stride
-					tie(reinterpret_cast<void*&>(tangentData), tangentDataStride) =
-						getDataPointerAndStride(accessor, bufferViews, buffers, bufferDataList,
-						                        numVertices, sizeof(glm::vec4));
-
-				}
-				else
-					throw GltfError("Unsupported functionality: " + it.key() + " attribute.");
-			}
-
-			// indices
-			// (they are optional)
-			size_t numIndices;
-			void* indexData;
-			unsigned indexComponentType;
-			if(auto indicesIt=primitive.find("indices"); indicesIt!=primitive.end()) {
-
-				// accessor
-				json& accessor = accessors.at(indicesIt.value().get_ref<json::number_unsigned_t&>());
-
-				// accessor.type is mandatory and it must be SCALAR for index accessors
-				const json::string_t& t = accessor.at("type").get_ref<json::string_t&>();
-				if(t != "SCALAR")
-					throw GltfError("Indices are not of SCALAR type.");
-
-				// accessor.componentType is mandatory and it must be UNSIGNED_INT (5125) for index accessors;
-				// unsigned short and unsigned byte component types seems not allowed by the spec
-				// but they are used in Khronos sample models, for example Box.gltf
-				// (https://github.com/KhronosGroup/glTF-Sample-Models/blob/main/2.0/Box/glTF/Box.gltf)
-				indexComponentType = unsigned(accessor.at("componentType").get_ref<json::number_unsigned_t&>());
-				if(indexComponentType != 5125 && indexComponentType != 5123 && indexComponentType != 5121)
-					throw GltfError("Index componentType is not unsigned int, unsigned short or unsigned byte.");
-
-				// accessor.normalized is optional and must be false for index accessor
-				if(auto it=accessor.find("normalized"); it!=accessor.end())
-					if(it->get_ref<json::boolean_t&>() == true)
-						throw GltfError("Indices cannot have normalized flag set to true.");
-
-				// get index count (accessor.count is mandatory and >=1)
-				numIndices = accessor.at("count").get_ref<json::number_unsigned_t&>();
-				if(numIndices == 0)
-					throw GltfError("Accessor's count member must be greater than zero.");
-
-				// index data
-				size_t elementSize;
-				switch(indexComponentType) {
-				case 5125: elementSize = sizeof(uint32_t); break;
-				case 5123: elementSize = sizeof(uint16_t); break;
-				case 5121: elementSize = sizeof(uint8_t); break;
-				}
-				size_t tmp;
-				tie(indexData, tmp) =
-					getDataPointerAndStride(accessor, bufferViews, buffers, bufferDataList,
-					                        numIndices, elementSize);
-			}
-			else {
-				numIndices = numVertices;
-				indexData = nullptr;
-			}
-
-			// ignore empty primitives
-			if(indexData == nullptr && numVertices == 0)
-				continue;
-
-			// create Geometry
-			cout << "Creating geometry" << endl;
-			CadR::Geometry& g = geometryList.emplace_back(renderer);
-
-			// update mesh bounds
-			// (meshBB contains always valid value;
-			// this is guaranteed by primitiveSetBB being always valid unless POSITION attribute is not specified,
-			// which was tested above by numVertices being non-zero)
-			meshBB.extendBy(primitiveSetBB);
-
-			// prepare for computing primitiveSet bounding sphere
-			CadR::BoundingSphere primitiveSetBS{
-				.center = positionData ? primitiveSetBB.getCenter() : glm::vec3(0.f, 0.f, 0.f),
-				.radius = 0.f,  // actually, radius^2 is stored here in the following loop as an performance optimization
-			};
-
-			// verify correct texture data
-			for(auto& t : texCoordAttribInfoList) {
-				uint8_t* texCoordData = get<0>(t);
-				auto getTexCoordFunc = get<1>(t);
-				if(texCoordData == nullptr || getTexCoordFunc == nullptr)
-					throw GltfError("Invalid texture coordinate attributes.");
-			}
-			if(texCoordAttribInfoList.size()+4 >= CadPL::ShaderState::maxNumAttribs)
-				throw GltfError("Too many texture coordinate attributes.");
-
-			// set vertex data
-			CadR::StagingData sd = g.createVertexStagingData(numVertices * vertexSize);
-			uint8_t* p = sd.data<uint8_t>();
-			for(size_t i=0; i<numVertices; i++) {
-				if(positionData) {
-
-					// copy position
-					glm::vec3 pos(*positionData);
-					*reinterpret_cast<glm::vec4*>(p)= glm::vec4(pos.x, pos.y, pos.z, 1.f);
-					p += 16;
-					positionData = reinterpret_cast<glm::vec3*>(reinterpret_cast<uint8_t*>(positionData) + positionDataStride);
-
-					// update bounding sphere
-					// (square of radius is stored in primitiveBS.radius)
-					primitiveSetBS.extendRadiusByPointUsingRadius2(pos);
-
-				}
-				if(normalData) {
-					glm::vec3 normal = glm::vec3(*normalData);
-					*reinterpret_cast<glm::vec4*>(p) = glm::vec4(normal.x, normal.y, normal.z, 0.f);
-					p += 16;
-					normalData = reinterpret_cast<glm::vec3*>(reinterpret_cast<uint8_t*>(normalData) + normalDataStride);
-				}
-				if(tangentData) {
-					*reinterpret_cast<glm::vec4*>(p) = *tangentData;
-					p += 16;
-					tangentData = reinterpret_cast<glm::vec4*>(reinterpret_cast<uint8_t*>(tangentData) + tangentDataStride);
-				}
-				if(colorData) {
-					glm::vec4* v = reinterpret_cast<glm::vec4*>(p);
-					*v = getColorFunc(colorData);
-					p += 16;
-					colorData += colorDataStride;
-				}
-				for(auto& t : texCoordAttribInfoList) {
-					uint8_t* texCoordData = get<0>(t);
-					auto getTexCoordFunc = get<1>(t);
-					unsigned texCoordDataStride = get<2>(t);
-					glm::vec4* v = reinterpret_cast<glm::vec4*>(p);
-					*v = getTexCoordFunc(texCoordData);
-					p += 16;
-					texCoordData += texCoordDataStride;
-					get<0>(t) = texCoordData;
-				}
-			}
-
-			// mesh.primitive.mode is optional with default value 4 (TRIANGLES)
-			unsigned mode = unsigned(primitive.value<json::number_unsigned_t>("mode", 4));
-
-			// set index data
-			if(mode == 4) {  // TRIANGLES
-				if(numIndices < 3)
-					throw GltfError("Invalid number of indices for TRIANGLES.");
-				goto copyIndices;
-			}
-			else if(mode == 1) {  // LINES
-				if(numIndices < 2)
-					throw GltfError("Invalid number of indices for LINES.");
-				goto copyIndices;
-			}
-			else if(mode == 0) {  // POINTS
-				if(numIndices < 1)
-					throw GltfError("Invalid number of indices for POINTS.");
-
-				// POINTS, LINES, TRIANGLES - copy indices directly,
-				// while converting uint8_t and uint16_t indices to uint32_t
-			copyIndices:
-				size_t indexDataSize = numIndices * sizeof(uint32_t);
-				sd = g.createIndexStagingData(indexDataSize);
-				uint32_t* pi = sd.data<uint32_t>();
-				if(indexData)
-					switch(indexComponentType) {
-					case 5125: memcpy(pi, indexData, indexDataSize); break;
-					case 5123: {
-						for(size_t i=0; i<numIndices; i++)
-							pi[i] = reinterpret_cast<uint16_t*>(indexData)[i];
-						break;
-					}
-					case 5121: {
-						for(size_t i=0; i<numIndices; i++)
-							pi[i] = reinterpret_cast<uint8_t*>(indexData)[i];
-						break;
-					}
-					}
-				else {
-					if(numIndices >= size_t((~uint32_t(0))-1)) // value 0xffffffff is forbidden, thus (~0)-1
-						throw GltfError("Too large primitive. Index out of 32-bit integer range.");
-					for(uint32_t i=0; i<uint32_t(numIndices); i++)
-						pi[i] = i;
-				}
-			}
-			else if(mode == 5) {
-
-				// TRIANGLE_STRIP - convert strip indices to indices of separate triangles
-				// while considering even and odd triangle ordering
-				if(numIndices < 3)
-					throw GltfError("Invalid number of indices for TRIANGLE_STRIP.");
-				numIndices = (numIndices-2) * 3;
-				sd = g.createIndexStagingData(numIndices * sizeof(uint32_t));
-				uint32_t* stgIndices = sd.data<uint32_t>();
-				if(indexData) {
-
-					// create new indices
-					auto createTriangleStripIndices =
-						[]<typename T>(uint32_t* dst, void* srcPtr, size_t numIndices) {
-
-							T* src = reinterpret_cast<T*>(srcPtr);
-							uint32_t* dstEnd = dst + numIndices;
-							uint32_t v1 = *src;
-							src++;
-							uint32_t v2 = *src;
-							src++;
-							uint32_t v3 = *src;
-							src++;
-							while(true) {
-
-								// odd triangle
-								*dst = v1;
-								dst++;
-								*dst = v2;
-								dst++;
-								*dst = v3;
-								dst++;
-								if(dst == dstEnd)
-									break;
-								v1 = v2;
-								v2 = v3;
-								v3 = *src;
-								src++;
-
-								// even triangle
-								*dst = v2;
-								dst++;
-								*dst = v1;
-								dst++;
-								*dst = v3;
-								dst++;
-								if(dst == dstEnd)
-									break;
-								v1 = v2;
-								v2 = v3;
-								v3 = *src;
-								src++;
-							}
-						};
-					switch(indexComponentType) {
-					case 5125: createTriangleStripIndices.operator()<uint32_t>(stgIndices, indexData, numIndices); break;
-					case 5123: createTriangleStripIndices.operator()<uint16_t>(stgIndices, indexData, numIndices); break;
-					case 5121: createTriangleStripIndices.operator()<uint8_t >(stgIndices, indexData, numIndices); break;
-					}
-				}
-				else {
-
-					// generate indices
-					if(numIndices >= size_t((~uint32_t(0))-1)) // value 0xffffffff is forbidden, thus (~0)-1
-						throw GltfError("Too large primitive. Index out of 32-bit integer range.");
-
-					uint32_t i = 0;
-					uint32_t v1 = i;
-					i++;
-					uint32_t v2 = i;
-					i++;
-					uint32_t v3 = i;
-					i++;
-					uint32_t* e = stgIndices + numIndices;
-					while(true) {
-
-						// odd triangle
-						*stgIndices = v1;
-						stgIndices++;
-						*stgIndices = v2;
-						stgIndices++;
-						*stgIndices = v3;
-						stgIndices++;
-						if(stgIndices == e)
-							break;
-						v1 = v2;
-						v2 = v3;
-						v3 = i;
-						i++;
-
-						// even triangle
-						*stgIndices = v2;
-						stgIndices++;
-						*stgIndices = v1;
-						stgIndices++;
-						*stgIndices = v3;
-						stgIndices++;
-						if(stgIndices == e)
-							break;
-						v1 = v2;
-						v2 = v3;
-						v3 = i;
-						i++;
-					}
-				}
-			}
-			else if(mode == 6) {
-
-				// TRIANGLE_FAN
-				if(numIndices < 3)
-					throw GltfError("Invalid number of indices for TRIANGLE_FAN.");
-				numIndices = (numIndices-2) * 3;
-				sd = g.createIndexStagingData(numIndices * sizeof(uint32_t));
-				uint32_t* stgIndices = sd.data<uint32_t>();
-				if(indexData) {
-
-					// create new indices
-					auto createTriangleStripIndices =
-						[]<typename T>(uint32_t* dst, void* srcPtr, size_t numIndices) {
-
-							T* src = reinterpret_cast<T*>(srcPtr);
-							uint32_t* dstEnd = dst + numIndices;
-							uint32_t v1 = *src;
-							src++;
-							uint32_t v2 = *src;
-							src++;
-							uint32_t v3 = *src;
-							src++;
-							while(true) {
-								*dst = v1;
-								dst++;
-								*dst = v2;
-								dst++;
-								*dst = v3;
-								dst++;
-								if(dst == dstEnd)
-									break;
-								v2 = v3;
-								v3 = *src;
-								src++;
-							}
-						};
-					switch(indexComponentType) {
-					case 5125: createTriangleStripIndices.operator()<uint32_t>(stgIndices, indexData, numIndices); break;
-					case 5123: createTriangleStripIndices.operator()<uint16_t>(stgIndices, indexData, numIndices); break;
-					case 5121: createTriangleStripIndices.operator()<uint8_t >(stgIndices, indexData, numIndices); break;
-					}
-				}
-				else {
-
-					// generate indices
-					if(numIndices >= size_t((~uint32_t(0))-1)) // value 0xffffffff is forbidden, thus (~0)-1
-						throw GltfError("Too large primitive. Index out of 32-bit integer range.");
-
-					uint32_t i = 0;
-					uint32_t v1 = i;
-					i++;
-					uint32_t v2 = i;
-					i++;
-					uint32_t v3 = i;
-					i++;
-					uint32_t* e = stgIndices + numIndices;
-					while(true) {
-						*stgIndices = v1;
-						stgIndices++;
-						*stgIndices = v2;
-						stgIndices++;
-						*stgIndices = v3;
-						stgIndices++;
-						if(stgIndices == e)
-							break;
-						v2 = v3;
-						v3 = i;
-						i++;
-					}
-				}
-			}
-			else if(mode == 3) {
-
-				// LINE_STRIP
-				if(numIndices < 2)
-					throw GltfError("Invalid number of indices for LINE_STRIP.");
-				numIndices = (numIndices-1) * 2;
-				sd = g.createIndexStagingData(numIndices * sizeof(uint32_t));
-				uint32_t* stgIndices = sd.data<uint32_t>();
-				if(indexData) {
-
-					// create new indices
-					auto createLineStripIndices =
-						[]<typename T>(uint32_t* dst, void* srcPtr, size_t numIndices) {
-							T* src = reinterpret_cast<T*>(srcPtr);
-							*dst = *src;
-							uint32_t* dstEnd = dst + (numIndices-1);
-							dst++; src++;
-							while(dst < dstEnd) {
-								*dst = *src;
-								dst++;
-								*dst = *src;
-								dst++; src++;
-							}
-							*dst = *src;
-						};
-					switch(indexComponentType) {
-					case 5125: createLineStripIndices.operator()<uint32_t>(stgIndices, indexData, numIndices); break;
-					case 5123: createLineStripIndices.operator()<uint16_t>(stgIndices, indexData, numIndices); break;
-					case 5121: createLineStripIndices.operator()<uint8_t >(stgIndices, indexData, numIndices); break;
-					}
-				}
-				else {
-
-					// generate indices
-					if(numIndices >= size_t((~uint32_t(0))-1)) // value 0xffffffff is forbidden, thus (~0)-1
-						throw GltfError("Too large primitive. Index out of 32-bit integer range.");
-					uint32_t i = 0;
-					*stgIndices = i;
-					uint32_t* e = stgIndices + (numIndices-1);
-					stgIndices++;
-					i++;
-					while(stgIndices < e) {
-						*stgIndices = i;
-						stgIndices++;
-						*stgIndices = i;
-						stgIndices++;
-						i++;
-					}
-					*stgIndices = i;
-				}
-			}
-			else if(mode == 2) {
-
-				// LINE_LOOP
-				if(numIndices < 2)
-					throw GltfError("Invalid number of indices for LINE_LOOP.");
-				numIndices = numIndices * 2;
-				sd = g.createIndexStagingData(numIndices * sizeof(uint32_t));
-				uint32_t* stgIndices = sd.data<uint32_t>();
-				if(indexData) {
-
-					// create new indices
-					auto createLineLoopIndices =
-						[]<typename T>(uint32_t* dst, void* srcPtr, size_t numIndices) {
-							T* src = reinterpret_cast<T*>(srcPtr);
-							uint32_t firstValue = *src;
-							*dst = *src;
-							uint32_t* dstEnd = dst + (numIndices-1);
-							dst++; src++;
-							while(dst < dstEnd) {
-								*dst = *src;
-								dst++;
-								*dst = *src;
-								dst++; src++;
-							}
-							*dst = firstValue;
-						};
-					switch(indexComponentType) {
-					case 5125: createLineLoopIndices.operator()<uint32_t>(stgIndices, indexData, numIndices); break;
-					case 5123: createLineLoopIndices.operator()<uint16_t>(stgIndices, indexData, numIndices); break;
-					case 5121: createLineLoopIndices.operator()<uint8_t >(stgIndices, indexData, numIndices); break;
-					}
-				}
-				else {
-
-					// generate indices
-					if(numIndices >= size_t((~uint32_t(0))-1)) // value 0xffffffff is forbidden, thus (~0)-1
-						throw GltfError("Too large primitive. Index out of 32-bit integer range.");
-					uint32_t i = 0;
-					*stgIndices = i;
-					uint32_t* e = stgIndices + (numIndices-1);
-					stgIndices++;
-					i++;
-					while(stgIndices < e) {
-						*stgIndices = i;
-						stgIndices++;
-						*stgIndices = i;
-						stgIndices++;
-						i++;
-					}
-					*stgIndices = 0;
-				}
-			}
-			else
-				throw GltfError("Invalid value for mesh.primitive.mode.");
-
-			// set primitiveSet data
-			struct PrimitiveSetGpuData {
-				uint32_t count;
-				uint32_t first;
-			};
-			sd = g.createPrimitiveSetStagingData(sizeof(PrimitiveSetGpuData));
-			PrimitiveSetGpuData* ps = sd.data<PrimitiveSetGpuData>();
-			ps->count = uint32_t(numIndices);
-			ps->first = 0;
-
-			// primitiveSet bounding sphere list
-			// (convert square of radius stored in primitiveBS.radius back to radius)
-			primitiveSetBS.radius = sqrt(primitiveSetBS.radius);
-			primitiveSetBSList.emplace_back(primitiveSetBS);
-
-			// material
-			auto materialIt = primitive.find("material");
-			size_t materialIndex =
-				(materialIt != primitive.end())
-					? materialIt->get_ref<json::number_unsigned_t&>()
-					: ~size_t(0);
-			StateSetMaterialData& ssMaterialData =
-				(materialIt != primitive.end())
-				? stateSetMaterialDataList.at(materialIndex)
-				: defaultStateSetMaterialData;
-
-			// pipeline
-			CadPL::ShaderState shaderState{
-				.idBuffer = false,
-				.transparency = ssMaterialData.transparencyEnabled,
-				.primitiveTopology =
-					[](unsigned mode) -> vk::PrimitiveTopology
-					{
-						switch(mode) {
-						case 0:  // POINTS
-							return vk::PrimitiveTopology::ePointList;
-						case 1:  // LINES
-						case 2:  // LINE_LOOP
-						case 3:  // LINE_STRIP
-							return vk::PrimitiveTopology::eLineList;
-						case 4:  // TRIANGLES
-						case 5:  // TRIANGLE_STRIP
-						case 6:  // TRIANGLE_FAN
-							return vk::PrimitiveTopology::eTriangleList;
-						default:
-							throw GltfError("Invalid value for mesh.primitive.mode.");
-						}
-					}(mode),
-				.projectionHandling =
-					CadPL::ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants,
-				.attribAccessInfo =
-					[&]() {
-						decltype(CadPL::ShaderState::attribAccessInfo) r;
-						uint16_t offset = 0x10;
-
-						// vertices: float3, alignment 16, offset 0
-						r[0] = 0x2000;
-
-						// normals: float3, alignment 16
-						if(normalData) {
-							r[1] = 0x2010;
-							offset += 0x10;
-						} else
-							r[1] = 0;
-
-						// tangents: float4, alignment 16
-						if(tangentData) {
-							r[2] = 0x0100 | offset;
-							offset += 0x10;
-						} else
-							r[2] = 0;
-
-						// colors: float4, alignment 16
-						if(colorData) {
-							r[3] = 0x0100 | offset;
-							offset += 0x10;
-						} else
-							r[3] = 0;
-
-						// texCoords: float2, alignment 8
-						for(size_t i=0,c=texCoordAttribInfoList.size(); i<c; i++) {
-							r[4+i] = 0x5000 | offset;
-							offset += 0x10;
-						}
+								vk::AccessFlagBits::eDepthStencilAttachmentWrite),
+							vk::DependencyFlags()  // dependencyFlags
+						),
+						vk::SubpassDependency(
+							0,                    // srcSubpass
+							VK_SUBPASS_EXTERNAL,  // dstSubpass
+							vk::PipelineStageFlags(vk::PipelineStageFlagBits::eColorAttachmentOutput),
+							vk::PipelineStageFlags(vk::PipelineStageFlagBits::eBottomOfPipe),  // dstStageMask
+							vk::AccessFlags(vk::AccessFlagBits::eColorAttachmentWrite),
+							vk::AccessFlags(),     // dstAccessMask
+							vk::DependencyFlags()  // dependencyFlags
+						),
+					}.data()
 
-						// fill the rest with zeros
-						for(size_t i=4+texCoordAttribInfoList.size(),c=r.size(); i<c; i++)
-							r[i] = 0;
-
-						return r;
-					}(),
-				.attribSetup =
-					(normalData || ssMaterialData.unlit || (mode <= 3) ? 0 : 1) |  // generateFlatNormals if normals are missing, just skip unlit materials and points and lines
-					(16u + (normalData ? 16 : 0) + (tangentData ? 16 : 0) +  // vertexDataSize
-						(colorData ? 16 : 0) + (uint32_t(texCoordAttribInfoList.size()) * 16)),
-				.materialSetup =
-					(ssMaterialData.unlit ? 0x0 : uint32_t(materialModel)) |  // Unlit vs Blin-Phong or Metallic-roughness
-					ssMaterialData.materialTexturingParamsOffset |  // texture params offset inside material
-					(ssMaterialData.doubleSided ? 0x0100 : 0) |  // two sided lighting
-					((mode <= 3) && (normalData == nullptr) ? 0x0200 : 0) |  // disable lighting for points and lines without normals
-					(ssMaterialData.alphaTest ? 0x0400 : 0) |  // alphaTest
-					0x0 |  // do not ignore alpha anywhere (on color attribute, on material and on base texture)
-					0x8000 |  // color attribute (if present) multiplies material ambient and diffuse color instead of ignoring them when computing ambient and diffuse color contributions
-					0x10000,  // separate emission on Phong material
-				.pointSize = 1.f,
-				.textureSetup = ssMaterialData.shaderTextureSetup,
-				.lightSetup = { 2 },  // one light; we use point light at the position of camera and call it headlight
-				.optimizeFlags = CadPL::ShaderState::OptimizeNone,
-			};
-			auto transparencyBlendAttachmentState =
-				[]() {
-					return CadPL::PipelineState::BlendAttachmentState{
-						.blendEnable = true,
-						.srcColorBlendFactor = vk::BlendFactor::eOne,
-						.dstColorBlendFactor = vk::BlendFactor::eOne,
-						.colorBlendOp = vk::BlendOp::eAdd,
-						.srcAlphaBlendFactor = vk::BlendFactor::eOne,
-						.dstAlphaBlendFactor = vk::BlendFactor::eOne,
-						.alphaBlendOp = vk::BlendOp::eAdd,
-						.colorWriteMask =
-							vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
-							vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA,
-					};
-				};
-			CadPL::PipelineState pipelineState{
-				.viewportAndScissorHandling = CadPL::PipelineState::ViewportAndScissorHandling::SetFunction,
-				.projectionIndex = 0,
-				.viewportIndex = 0,
-				.scissorIndex = 0,
-				.viewport = {},
-				.scissor = {},
-				.cullMode =
-					(ssMaterialData.doubleSided)
-						? vk::CullModeFlagBits::eNone   // eNone - nothing is discarded
-						: vk::CullModeFlagBits::eBack,  // eBack - back-facing triangles are discarded, eFront - front-facing triangles are discarded
-				.frontFace = vk::FrontFace::eCounterClockwise,
-				.depthBiasDynamicState = false,
-				.depthBiasEnable = false,
-				.depthBiasConstantFactor = 0.f,
-				.depthBiasClamp = 0.f,
-				.depthBiasSlopeFactor = 0.f,
-				.lineWidthDynamicState = false,
-				.lineWidth = 1.f,
-				.rasterizationSamples = numSamples,
-				.sampleShadingEnable = false,
-				.minSampleShading = 0.f,
-				.depthTestEnable = true,
-				.depthWriteEnable = !ssMaterialData.transparencyEnabled,  // disable depth writes for transparent geometry
-				.numColorAttachments = (dynamicRendering) ? 5u : 1u,
-				.blendState = {
-					ssMaterialData.transparencyEnabled ? transparencyBlendAttachmentState() : CadPL::PipelineState::BlendAttachmentState{ .blendEnable = false },
-					ssMaterialData.transparencyEnabled ? transparencyBlendAttachmentState() : CadPL::PipelineState::BlendAttachmentState{ .blendEnable = false },
-					ssMaterialData.transparencyEnabled ? transparencyBlendAttachmentState() : CadPL::PipelineState::BlendAttachmentState{ .blendEnable = false },
-					ssMaterialData.transparencyEnabled ? transparencyBlendAttachmentState() : CadPL::PipelineState::BlendAttachmentState{ .blendEnable = false },
-					ssMaterialData.transparencyEnabled ? transparencyBlendAttachmentState() : CadPL::PipelineState::BlendAttachmentState{ .blendEnable = false },
-				},
-				.renderPass = (dynamicRendering) ? nullptr : renderPass,
-				.subpass = 0,
-				.colorAttachmentFormats = colorAttachmentFormatList,
-				.depthAttachmentFormat = depthFormat,
-				.stencilAttachmentFormat = vk::Format::eUndefined,
-			};
-			CadR::StateSet& ss = pipelineSceneGraph.getOrCreateStateSet(shaderState, pipelineState);
-
-			// drawable
-			drawableList.emplace_back(
-				g,  // geometry
-				0,  // primitiveSetOffset
-				matrixLists[meshIndex],  // matrixList
-				(materialIndex==~size_t(0))  // drawableData
-					? defaultMaterial
-					: materialList[materialIndex],
-				ss  // stateSet
+				)
 			);
 
-			// mesh bounding sphere
-			// (meshBS is always valid)
-			CadR::BoundingSphere meshBS{
-				.center = meshBB.getCenter(),
-				.radius = 0.f,
-			};
-			for(size_t i=0,c=primitiveSetBSList.size(); i<c; i++)
-				meshBS.extendRadiusBy(primitiveSetBSList[i]);
+	}
 
-			// bounding box of all instances of particular mesh
-			const vector<glm::mat4>& matrices = meshMatrixList[meshIndex];
-			if(matrices.empty())
-				meshBoundingSphereList[meshIndex] = CadR::BoundingSphere::empty();
-			else {
+	// rendering semaphore and fence
+	imageAvailableSemaphore =
+		device.createSemaphore(
+			vk::SemaphoreCreateInfo(
+				vk::SemaphoreCreateFlags()  // flags
+			)
+		);
+	renderingFinishedFence =
+		device.createFence(
+			vk::FenceCreateInfo(
+				vk::FenceCreateFlagBits::eSignaled  // flags
+			)
+		);
 
-				// first instance's bounding box
-				// (instancesBB is always valid except when matrices is empty)
-				CadR::BoundingBox instancesBB =
-					CadR::BoundingBox::createByCenterAndHalfExtents(
-						glm::mat3(matrices[0]) * meshBS.center + glm::vec3(matrices[0][3]),  // center
-						glm::abs(glm::mat3(matrices[0]) * glm::vec3(meshBS.radius))  // halfExtents
-					);
-
-				// remaining instance's bounding boxes
-				for(size_t instanceIndex=1, instanceCount=matrices.size();
-					instanceIndex<instanceCount; instanceIndex++)
-				{
-					const glm::mat4& m = matrices[instanceIndex];
-					instancesBB.extendBy(
-						CadR::BoundingBox::createByCenterAndHalfExtents(
-							glm::mat3(m) * meshBS.center + glm::vec3(m[3]),  // center
-							glm::abs(glm::mat3(m) * glm::vec3(meshBS.radius))  // radius
-						)
-					);
+	// shaders and pipeline for final composition step during rendering
+	if(dynamicRendering)
+	{
+		fullScreenTriangleVertexShader =
+			device.createShaderModule(
+				vk::ShaderModuleCreateInfo(
+					vk::ShaderModuleCreateFlags(),  // flags
+					sizeof(fullScreenTriangleVertexShaderSpirv),  // codeSize
+					fullScreenTriangleVertexShaderSpirv  // pCode
+				)
+			);
+		composeFragmentShader =
+			device.createShaderModule(
+				vk::ShaderModuleCreateInfo(
+					vk::ShaderModuleCreateFlags(),  // flags
+					(numSamples == vk::SampleCountFlagBits::e1)  // codeSize
+						? sizeof(composeFragmentShaderSpirv) : sizeof(composeMultisampledFragmentShaderSpirv),
+					(numSamples == vk::SampleCountFlagBits::e1)  // pCode
+						? composeFragmentShaderSpirv : composeMultisampledFragmentShaderSpirv
+				)
+			);
+		composeDescriptorSetLayout =
+			device.createDescriptorSetLayout(
+				vk::DescriptorSetLayoutCreateInfo{
+					vk::DescriptorSetLayoutCreateFlags(),  // flags
+					3,  // bindingCount
+					array<vk::DescriptorSetLayoutBinding,3>{
+						vk::DescriptorSetLayoutBinding{
+							0,  // binding
+							vk::DescriptorType::eInputAttachment,  // descritorType
+							1,  // descritorCount
+							vk::ShaderStageFlagBits::eFragment,  // stageFlags
+							nullptr,  // pImmutableSamplers
+						},
+						vk::DescriptorSetLayoutBinding{
+							1,  // binding
+							vk::DescriptorType::eInputAttachment,  // descritorType
+							1,  // descritorCount
+							vk::ShaderStageFlagBits::eFragment,  // stageFlags
+							nullptr,  // pImmutableSamplers
+						},
+						vk::DescriptorSetLayoutBinding{
+							2,  // binding
+							vk::DescriptorType::eInputAttachment,  // descritorType
+							1,  // descritorCount
+							vk::ShaderStageFlagBits::eFragment,  // stageFlags
+							nullptr,  // pImmutableSamplers
+						},
+					}.data(),
 				}
-
-				// bounding sphere of all instances of particular mesh
-				// (instancesDB is always valid except when matrices is empty)
-				CadR::BoundingSphere instancesBS{
-					.center = instancesBB.getCenter(),
-					.radius = 0.f,
-				};
-				for(size_t instanceIndex=0, instanceCount=matrices.size();
-					instanceIndex<instanceCount; instanceIndex++)
-				{
-					instancesBS.extendRadiusBy(matrices[instanceIndex] * meshBS);
+			);
+		composePipelineLayout =
+			device.createPipelineLayout(
+				vk::PipelineLayoutCreateInfo{
+					vk::PipelineLayoutCreateFlags(),  // flags
+					1,        // setLayoutCount
+					&composeDescriptorSetLayout,  // pSetLayouts
+					0,  // pushConstantRangeCount
+					nullptr,  // pPushConstantRanges
 				}
-				meshBoundingSphereList[meshIndex] = instancesBS;
-
-			}
-		}
-	}
-
-	// scene bounding box
-	// (sceneBB might be valid or even completely empty)
-	CadR::BoundingBox sceneBB = meshBoundingSphereList[0].getBoundingBox();
-	for(size_t i=1, c=meshBoundingSphereList.size(); i<c; i++)
-		sceneBB.extendBy(meshBoundingSphereList[i].getBoundingBox());
-
-	// scene bounding sphere
-	// (generate valid sceneBoundingSphere although sceneBB might be empty,
-	// and meshBoundingSphereList might contain empty spheres)
-	if(sceneBB.isEmpty())
-		sceneBoundingSphere = { .center = glm::vec3(0.f, 0.f, 0.f), .radius = 0.f };
-	else {
-		sceneBoundingSphere.center = sceneBB.getCenter();
-		sceneBoundingSphere.radius = 0.f;
-		for(size_t i=0, c=meshBoundingSphereList.size(); i<c; i++)
-			sceneBoundingSphere.extendRadiusBy(meshBoundingSphereList[i]);
-		sceneBoundingSphere.radius *= 1.001f;  // increase radius to accommodate for all floating computations imprecisions
+			);
+		composeDescriptorPool =
+			device.createDescriptorPool(
+				vk::DescriptorPoolCreateInfo(
+					vk::DescriptorPoolCreateFlags(),  // flags
+					1,  // maxSets
+					1,  // poolSizeCount
+					array{  // pPoolSizes
+						vk::DescriptorPoolSize(
+							vk::DescriptorType::eInputAttachment,  // type
+							3  // descriptorCount
+						),
+					}.data()
+				)
+			);
+		composeDescriptorSet =
+			device.allocateDescriptorSets(
+				vk::DescriptorSetAllocateInfo(
+					composeDescriptorPool,  // descriptorPool
+					1,  // descriptorSetCount
+					&composeDescriptorSetLayout  // descriptorSetLayout
+				)
+			)[0];
 	}
 
-	// initial camera distance
-	float fovy2Clamped = glm::clamp(fovy / 2.f, 1.f / 180.f * glm::pi<float>(), 90.f / 180.f * glm::pi<float>());
-	cameraDistance = sceneBoundingSphere.radius / sin(fovy2Clamped);
-
-#if 0  // show scene bounding sphere
-	auto createBoundingSphereVisualization =
-		[](const CadR::BoundingSphere bs, App& app) {
-
-			// vertex data
-			// (bounding sphere in the form of axis cross)
-			CadR::Geometry& g = app.geometryDB.emplace_back(app.renderer);
-			CadR::StagingData sd = g.createVertexStagingData(6 * sizeof(glm::vec4));
-			glm::vec4* pos = sd.data<glm::vec4>();
-			pos[0] = glm::vec4(bs.center.x-bs.radius, bs.center.y, bs.center.z, 1.f);
-			pos[1] = glm::vec4(bs.center.x+bs.radius, bs.center.y, bs.center.z, 1.f);
-			pos[2] = glm::vec4(bs.center.x, bs.center.y-bs.radius, bs.center.z, 1.f);
-			pos[3] = glm::vec4(bs.center.x, bs.center.y+bs.radius, bs.center.z, 1.f);
-			pos[4] = glm::vec4(bs.center.x, bs.center.y, bs.center.z-bs.radius, 1.f);
-			pos[5] = glm::vec4(bs.center.x, bs.center.y, bs.center.z+bs.radius, 1.f);
-
-			// index data
-			sd = g.createIndexStagingData(6 * sizeof(uint32_t));
-			uint32_t* indices = sd.data<uint32_t>();
-			for(uint32_t i=0; i<6; i++)
-				indices[i] = i;
-
-			// primitive set
-			struct PrimitiveSetGpuData {
-				uint32_t count;
-				uint32_t first;
-			};
-			sd = g.createPrimitiveSetStagingData(sizeof(PrimitiveSetGpuData));
-			PrimitiveSetGpuData* ps = sd.data<PrimitiveSetGpuData>();
-			ps->count = 6;
-			ps->first = 0;
-
-			// state set
-			unsigned pipelineIndex =
-				PipelineLibrary::getLinePipelineIndex(
-					false,  // phong
-					false,  // texturing
-					false   // perVertexColor
-				);
-			CadR::StateSet& ss = app.stateSetDB[pipelineIndex];
-
-			// drawable
-			app.drawableDB.emplace_back(
-				g,  // geometry
-				0,  // primitiveSetOffset
-				sd,  // shaderStagingData
-				64+64,  // shaderDataSize
-				1,  // numInstances
-				ss);  // stateSet
-
-			// material
-			struct MaterialData {
-				glm::vec3 ambient;  // offset 0
-				uint32_t padding1;  // offset 12
-				glm::vec4 diffuseAndAlpha;  // offset 16
-				glm::vec3 specular;  // offset 32
-				float shininess;  // offset 44
-				glm::vec3 emission;  // offset 48
-				uint32_t padding2;
-			};
-			MaterialData* m = sd.data<MaterialData>();
-			m->ambient = glm::vec3(1.f, 1.f, 1.f);
-			m->padding1 = 0;
-			m->diffuseAndAlpha = glm::vec4(1.f, 1.f, 1.f, 1.f);
-			m->specular = glm::vec3(0.f, 0.f, 0.f);
-			m->shininess = 0.f;
-			m->emission = glm::vec3(0.f, 0.f, 0.f);
-			m->padding2 = 0;
-
-			// transformation matrices
-			glm::mat4* matrices = sd.data<glm::mat4>() + 1;
-			matrices[0] = glm::mat4(1.f);
-		};
+	// command buffer
+	commandPool =
+		device.createCommandPool(
+			vk::CommandPoolCreateInfo(
+				vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer,  // flags
+				graphicsQueueFamily  // queueFamilyIndex
+			)
+		);
+	commandBuffer =
+		device.allocateCommandBuffers(
+			vk::CommandBufferAllocateInfo(
+				commandPool,                       // commandPool
+				vk::CommandBufferLevel::ePrimary,  // level
+				1                                  // commandBufferCount
+			)
+		)[0];
 
-#if 0  // show scene bounding sphere
-	createBoundingSphereVisualization(sceneBoundingSphere, *this);
-#endif
+	// texture StateSet
+	// (textures are bound through the descriptor set of stateSetRoot;
+	// its pipeline provides the pipeline layout for the binding)
+	layoutOnlyPipeline.init(nullptr, pipelineSceneGraph.pipelineLayout(), nullptr);
+	stateSetRoot.pipeline = &layoutOnlyPipeline;
 
-#if 0  // show bounding sphere of each mesh
-	for(size_t i=0, c=meshBoundingSphereList.size(); i<c; i++)
-		createBoundingSphereVisualization(meshBoundingSphereList[i], *this);
-#endif
-#endif
+	// loader settings
+	CadGltf::LoaderSettings settings{
+		.materialModel = materialModel,
+		.useVertexCompression = useVertexCompression,
+		.useTextureAtlas = useTextureAtlas,
+		.useTextureCompression = useTextureCompression,
+		.textureCacheDirectory = textureCacheDirectory,
+		.maxSamplerAnisotropy = maxSamplerAnisotropy,
+		.transparencySupported = dynamicRendering && numSamples == vk::SampleCountFlagBits::e1,
+		.optimizeFlags = (useAsyncPipelines || useAutoPipelines) ? CadPL::ShaderState::OptimizeAll : CadPL::ShaderState::OptimizeNone,
+		.pipelineState = {
+			.viewportAndScissorHandling = CadPL::PipelineState::ViewportAndScissorHandling::SetFunction,
+			.projectionIndex = 0,
+			.viewportIndex = 0,
+			.scissorIndex = 0,
+			.viewport = {},
+			.scissor = {},
+			.cullMode = vk::CullModeFlagBits::eBack,  // set by the loader according to the material
+			.frontFace = vk::FrontFace::eCounterClockwise,
+			.depthBiasDynamicState = false,
+			.depthBiasEnable = false,
+			.depthBiasConstantFactor = 0.f,
+			.depthBiasClamp = 0.f,
+			.depthBiasSlopeFactor = 0.f,
+			.lineWidthDynamicState = false,
+			.lineWidth = 1.f,
+			.rasterizationSamples = numSamples,
+			.sampleShadingEnable = false,
+			.minSampleShading = 0.f,
+			.depthTestEnable = true,
+			.depthWriteEnable = true,  // set by the loader according to the material
+			.numColorAttachments = (dynamicRendering) ? 5u : 1u,
+			.blendState = {},  // set by the loader according to the material
+			.renderPass = (dynamicRendering) ? nullptr : renderPass,
+			.subpass = 0,
+			.colorAttachmentFormats = colorAttachmentFormatList,
+			.depthAttachmentFormat = depthFormat,
+			.stencilAttachmentFormat = vk::Format::eUndefined,
+		},
+		.getOrCreateStateSetFunc =
+			[this](const CadPL::ShaderState& shaderState, const CadPL::PipelineState& pipelineState) -> CadR::StateSet&
+			{
+				auto t1 = chrono::steady_clock::now();
+				CadR::StateSet& ss =
+					(useAutoPipelines)
+						? pipelineSceneGraph.getOrCreateStateSetAuto(shaderState, pipelineState)
+						: (useAsyncPipelines)
+							? pipelineSceneGraph.getOrCreateStateSetAsync(shaderState, pipelineState)
+							: pipelineSceneGraph.getOrCreateStateSet(shaderState, pipelineState);
+				pipelineCreationTime += chrono::duration<double>(chrono::steady_clock::now() - t1).count();
+				return ss;
+			},
+		.mergeStaticPrimitives = mergeStaticPrimitives,
+	};
 
-	// upload all staging buffers
-	renderer.executeCopyOperations();
+	// start loading
+	// (parsing, buffer reading and image decoding run on the worker thread;
+	// geometry is built by frame() in slices of a few meshes per frame
+	// because DataStorage and ImageStorage are not thread-safe;
+	// in headless mode, all the loading stages are performed and timed by runBenchmark())
+	loader.emplace(renderer, vulkanInstance, physicalDevice, pipelineSceneGraph, stateSetRoot, settings);
+	loader->setLogCallback(
+		[this](const string& message) {
+			*logStream << message << endl;
+		}
+	);
+	if(headless)
+		return;
+	*logStream << "Processing file " << utf8FilePath << "..." << endl;
+	loaderFuture =
+		async(launch::async,
+			[this]() {
+				loader->parse(filePath);
+				loader->resolveBuffers();
+				loader->decodeImages();
+			}
+		);
 }
 
 
@@ -3935,11 +1505,13 @@ void App::resize(VulkanWindow& window,
 	device.destroy(finalMultisampledColorImage);  finalMultisampledColorImage = nullptr;
 	device.destroy(transparencyColorImage);  transparencyColorImage = nullptr;
 	device.destroy(transparencyCountImage);  transparencyCountImage = nullptr;
+	device.destroy(offscreenImage);  offscreenImage = nullptr;
 	device.free(depthImageMemory);  depthImageMemory = nullptr;
 	device.free(hdrColorImageMemory);  hdrColorImageMemory = nullptr;
 	device.free(finalMultisampledColorImageMemory);  finalMultisampledColorImageMemory = nullptr;
 	device.free(transparencyColorImageMemory);  transparencyColorImageMemory = nullptr;
 	device.free(transparencyCountImageMemory);  transparencyCountImageMemory = nullptr;
+	device.free(offscreenImageMemory);  offscreenImageMemory = nullptr;
 	device.destroy(depthImageView);  depthImageView = nullptr;
 	device.destroy(hdrColorImageView);  hdrColorImageView = nullptr;
 	device.destroy(finalMultisampledColorImageView);  finalMultisampledColorImageView = nullptr;
@@ -3948,43 +1520,87 @@ void App::resize(VulkanWindow& window,
 	for(auto f : framebuffers)  device.destroy(f);
 	framebuffers.clear();
 	device.destroy(composePipeline);  composePipeline = nullptr;
+	imageExtent = newSurfaceExtent;
+
+	// swapchain images
+	// (offscreen image in headless mode)
+	if(!headless) {
+
+		// print info
+		*logStream << "Recreating swapchain (extent: " << newSurfaceExtent.width << "x" << newSurfaceExtent.height
+		     << ", extent by surfaceCapabilities: " << surfaceCapabilities.currentExtent.width << "x"
+		     << surfaceCapabilities.currentExtent.height << ", minImageCount: " << surfaceCapabilities.minImageCount
+		     << ", maxImageCount: " << surfaceCapabilities.maxImageCount << ")" << endl;
+
+		// create new swapchain
+		constexpr const uint32_t requestedImageCount = 2;
+		vk::UniqueHandle<vk::SwapchainKHR, CadR::VulkanDevice> newSwapchain =
+			device.createSwapchainKHRUnique(
+				vk::SwapchainCreateInfoKHR(
+					vk::SwapchainCreateFlagsKHR(),  // flags
+					window.surface(),               // surface
+					surfaceCapabilities.maxImageCount==0  // minImageCount
+						? max(requestedImageCount, surfaceCapabilities.minImageCount)
+						: clamp(requestedImageCount, surfaceCapabilities.minImageCount, surfaceCapabilities.maxImageCount),
+					surfaceFormat.format,           // imageFormat
+					surfaceFormat.colorSpace,       // imageColorSpace
+					newSurfaceExtent,               // imageExtent
+					1,                              // imageArrayLayers
+					vk::ImageUsageFlagBits::eColorAttachment,  // imageUsage
+					(graphicsQueueFamily==presentationQueueFamily) ? vk::SharingMode::eExclusive : vk::SharingMode::eConcurrent, // imageSharingMode
+					uint32_t(2),  // queueFamilyIndexCount
+					array<uint32_t, 2>{graphicsQueueFamily, presentationQueueFamily}.data(),  // pQueueFamilyIndices
+					surfaceCapabilities.currentTransform,    // preTransform
+					vk::CompositeAlphaFlagBitsKHR::eOpaque,  // compositeAlpha
+					vk::PresentModeKHR::eFifo,  // presentMode
+					VK_TRUE,  // clipped
+					swapchain  // oldSwapchain
+				)
+			);
+		device.destroy(swapchain);
+		swapchain = newSwapchain.release();
 
-	// print info
-	cout << "Recreating swapchain (extent: " << newSurfaceExtent.width << "x" << newSurfaceExtent.height
-	     << ", extent by surfaceCapabilities: " << surfaceCapabilities.currentExtent.width << "x"
-	     << surfaceCapabilities.currentExtent.height << ", minImageCount: " << surfaceCapabilities.minImageCount
-	     << ", maxImageCount: " << surfaceCapabilities.maxImageCount << ")" << endl;
-
-	// create new swapchain
-	constexpr const uint32_t requestedImageCount = 2;
-	vk::UniqueHandle<vk::SwapchainKHR, CadR::VulkanDevice> newSwapchain =
-		device.createSwapchainKHRUnique(
-			vk::SwapchainCreateInfoKHR(
-				vk::SwapchainCreateFlagsKHR(),  // flags
-				window.surface(),               // surface
-				surfaceCapabilities.maxImageCount==0  // minImageCount
-					? max(requestedImageCount, surfaceCapabilities.minImageCount)
-					: clamp(requestedImageCount, surfaceCapabilities.minImageCount, surfaceCapabilities.maxImageCount),
-				surfaceFormat.format,           // imageFormat
-				surfaceFormat.colorSpace,       // imageColorSpace
-				newSurfaceExtent,               // imageExtent
-				1,                              // imageArrayLayers
-				vk::ImageUsageFlagBits::eColorAttachment,  // imageUsage
-				(graphicsQueueFamily==presentationQueueFamily) ? vk::SharingMode::eExclusive : vk::SharingMode::eConcurrent, // imageSharingMode
-				uint32_t(2),  // queueFamilyIndexCount
-				array<uint32_t, 2>{graphicsQueueFamily, presentationQueueFamily}.data(),  // pQueueFamilyIndices
-				surfaceCapabilities.currentTransform,    // preTransform
-				vk::CompositeAlphaFlagBitsKHR::eOpaque,  // compositeAlpha
-				vk::PresentModeKHR::eFifo,  // presentMode
-				VK_TRUE,  // clipped
-				swapchain  // oldSwapchain
-			)
+		swapchainImages = device.getSwapchainImagesKHR(swapchain);
+
+	}
+	else {
+
+		// print info
+		*logStream << "Creating offscreen image (extent: " << newSurfaceExtent.width << "x"
+		     << newSurfaceExtent.height << ")" << endl;
+
+		// offscreen image
+		// (it replaces swapchain images, so the rest of the code uses it as the only swapchain image)
+		offscreenImage =
+			device.createImage(
+				vk::ImageCreateInfo(
+					vk::ImageCreateFlags(),  // flags
+					vk::ImageType::e2D,      // imageType
+					surfaceFormat.format,    // format
+					vk::Extent3D(newSurfaceExtent.width, newSurfaceExtent.height, 1),  // extent
+					1,                       // mipLevels
+					1,                       // arrayLayers
+					vk::SampleCountFlagBits::e1,  // samples
+					vk::ImageTiling::eOptimal,    // tiling
+					vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,  // usage
+					vk::SharingMode::eExclusive,  // sharingMode
+					0,                            // queueFamilyIndexCount
+					nullptr,                      // pQueueFamilyIndices
+					vk::ImageLayout::eUndefined   // initialLayout
+				)
+			);
+		tie(offscreenImageMemory, ignore) =
+			renderer.allocateMemory(offscreenImage, vk::MemoryPropertyFlagBits::eDeviceLocal);
+		device.bindImageMemory(
+			offscreenImage,  // image
+			offscreenImageMemory,  // memory
+			0  // memoryOffset
 		);
-	device.destroy(swapchain);
-	swapchain = newSwapchain.release();
+		swapchainImages.assign(1, offscreenImage);
+
+	}
 
-	// swapchain images and image views
-	swapchainImages = device.getSwapchainImagesKHR(swapchain);
+	// swapchain image views
 	swapchainImageViews.reserve(swapchainImages.size());
 	for(vk::Image image : swapchainImages)
 		swapchainImageViews.emplace_back(
@@ -4620,6 +2236,7 @@ void App::resize(VulkanWindow& window,
 	glm::mat4 projectionMatrix = glm::perspectiveLH_ZO(fovy, float(newSurfaceExtent.width)/newSurfaceExtent.height, zNear, zFar);
 
 	// resize pipelines
+	auto t1 = chrono::steady_clock::now();
 	pipelineSceneGraph.setProjectionViewportAndScissor(
 		projectionMatrix,
 		vk::Viewport(0.f, 0.f,
@@ -4627,6 +2244,8 @@ void App::resize(VulkanWindow& window,
 		             0.f, 1.f),
 		vk::Rect2D(vk::Offset2D(0, 0), newSurfaceExtent)
 	);
+	if(!startupTimesPrinted)
+		pipelineCreationTime += chrono::duration<double>(chrono::steady_clock::now() - t1).count();
 }
 
 
@@ -4649,6 +2268,34 @@ void App::frame(VulkanWindow&)
 	}
 	device.resetFences(renderingFinishedFence);
 
+	// collect info of the previous frame
+	if(headless) {
+		const CadR::FrameInfo& frameInfo = renderer.getFrameInfo();
+		if(frameInfo.frameNumber != ~size_t(0))
+			frameInfoList.push_back(frameInfo);
+	}
+
+	// continue scene loading
+	// (parse, resolveBuffers and decodeImages stages run on the worker thread;
+	// when they are finished, geometry is built in slices of a few meshes per frame)
+	if(!sceneLoaded) {
+		if(loaderFuture.valid() && loaderFuture.wait_for(chrono::seconds(0)) == future_status::ready)
+			loaderFuture.get();  // rethrows exceptions of the worker thread
+		if(!loaderFuture.valid() && loader->buildGeometry(numMeshesBuiltPerFrame)) {
+
+			// upload all staging buffers
+			loader->upload();
+			sceneLoaded = true;
+			sceneLoadTime = chrono::duration<double>(chrono::steady_clock::now() - sceneLoadBeginTime).count() - pipelineCreationTime;
+
+			// initial camera distance
+			sceneBoundingSphere = loader->sceneBoundingSphere();
+			float fovy2Clamped = glm::clamp(fovy / 2.f, 1.f / 180.f * glm::pi<float>(), 90.f / 180.f * glm::pi<float>());
+			cameraDistance = sceneBoundingSphere.radius / sin(fovy2Clamped);
+		}
+		window.scheduleFrame();
+	}
+
 	// _sceneDataAllocation
 	uint32_t sceneDataSize = 192 + 2*lightGpuDataSize;  // 192 is for basic scene data plus light data while one additional light is used as terminating element
 	CadR::StagingData sceneStagingData = sceneDataAllocation.alloc(sceneDataSize);
@@ -4699,7 +2346,7 @@ void App::frame(VulkanWindow&)
 	float minZNear = zFar / maxZNearZFarRatio;
 	if(zNear < minZNear)
 		zNear = minZNear;
-	glm::mat4 projectionMatrix = glm::perspectiveLH_ZO(fovy, float(window.surfaceExtent().width)/window.surfaceExtent().height, zNear, zFar);
+	glm::mat4 projectionMatrix = glm::perspectiveLH_ZO(fovy, float(imageExtent.width)/imageExtent.height, zNear, zFar);
 	sceneData->projectionMatrix = projectionMatrix;
 	sceneData->p11 = projectionMatrix[0][0];
 	sceneData->p22 = projectionMatrix[1][1];
@@ -4707,6 +2354,8 @@ void App::frame(VulkanWindow&)
 	sceneData->p43 = projectionMatrix[3][2];
 	sceneData->ambientLight = glm::vec3(0.5f, 0.5f, 0.5f);
 	sceneData->numLights = 1;
+	CadR::HandlelessAllocation& textureAtlasDataAllocation = loader->textureAtlasDataAllocation();
+	sceneData->textureAtlasDataPtr = (textureAtlasDataAllocation.size() != 0) ? textureAtlasDataAllocation.deviceAddress() : 0;
 	sceneData->padding = {};
 	sceneData->lights[0].eyePositionOrDirection = glm::vec3(0.f, 0.f, 0.f);
 	sceneData->lights[0].settings = 2;  // bits 0..1: 1 - directional light, 2 - point light, 3 - spotlight
@@ -4733,29 +2382,53 @@ void App::frame(VulkanWindow&)
 	// begin the frame
 	renderer.beginFrame();
 
+	// promote the most used StateSets to optimized pipelines
+	if(useAutoPipelines)
+		pipelineSceneGraph.updateAutoOptimization();
+
+	// switch to the optimized pipelines that were compiled in background
+	if(useAsyncPipelines || useAutoPipelines) {
+		pipelineSceneGraph.updateAsyncPipelines();
+		const CadPL::AsyncPipelineStats& stats = pipelineSceneGraph.asyncPipelineStats();
+		if(stats.numPending != 0)
+			asyncPipelineStatsPrinted = false;
+		else if(!asyncPipelineStatsPrinted) {
+			*logStream << "Optimized pipelines: " << stats.numCompleted << " completed, " << stats.numFailed << " failed, "
+			     << "time-to-optimized average " << stats.averageTimeToOptimized() * 1000 << "ms, "
+			     << "max " << stats.maxTimeToOptimized * 1000 << "ms" << endl;
+			if(useAutoPipelines)
+				*logStream << "Automatic optimization: " << pipelineSceneGraph.autoOptimizationStats().numPromoted << " of "
+				     << pipelineSceneGraph.autoOptimizationStats().numStateSets << " StateSets optimized" << endl;
+			asyncPipelineStatsPrinted = true;
+		}
+	}
+
 	// submit all copy operations that were not submitted yet
 	renderer.executeCopyOperations();
 
 	// acquire image
-	uint32_t imageIndex;
-	r =
-		device.acquireNextImageKHR(
-			swapchain,                // swapchain
-			uint64_t(3e9),            // timeout (3s)
-			imageAvailableSemaphore,  // semaphore to signal
-			vk::Fence(nullptr),       // fence to signal
-			&imageIndex               // pImageIndex
-		);
-	if(r != vk::Result::eSuccess) {
-		renderer.endFrame();
-		if(r == vk::Result::eSuboptimalKHR) {
-			window.scheduleResize();
-			return;
-		} else if(r == vk::Result::eErrorOutOfDateKHR) {
-			window.scheduleResize();
-			return;
-		} else
-			throw runtime_error("Vulkan error: vkAcquireNextImageKHR failed with error " + to_string(r) + ".");
+	// (offscreen image is always available in headless mode)
+	uint32_t imageIndex = 0;
+	if(!headless) {
+		r =
+			device.acquireNextImageKHR(
+				swapchain,                // swapchain
+				uint64_t(3e9),            // timeout (3s)
+				imageAvailableSemaphore,  // semaphore to signal
+				vk::Fence(nullptr),       // fence to signal
+				&imageIndex               // pImageIndex
+			);
+		if(r != vk::Result::eSuccess) {
+			renderer.endFrame();
+			if(r == vk::Result::eSuboptimalKHR) {
+				window.scheduleResize();
+				return;
+			} else if(r == vk::Result::eErrorOutOfDateKHR) {
+				window.scheduleResize();
+				return;
+			} else
+				throw runtime_error("Vulkan error: vkAcquireNextImageKHR failed with error " + to_string(r) + ".");
+		}
 	}
 
 	// begin command buffer recording
@@ -4849,7 +2522,7 @@ void App::frame(VulkanWindow&)
 			stateSetRoot,  // stateSetRoot
 			vk::RenderingInfo{
 				vk::RenderingFlags{},  // flags
-				vk::Rect2D(vk::Offset2D(0, 0), window.surfaceExtent()),  // renderArea
+				vk::Rect2D(vk::Offset2D(0, 0), imageExtent),  // renderArea
 				1,  // layerCount
 				0,  // viewMask
 				uint32_t(colorRenderingAttachmentInfoList.size()),  // colorAttachmentCount
@@ -4872,7 +2545,7 @@ void App::frame(VulkanWindow&)
 				vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,  // srcAccessMask
 				vk::AccessFlags(),  // dstAccessMask
 				vk::ImageLayout::eColorAttachmentOptimal,  // oldLayout
-				vk::ImageLayout::ePresentSrcKHR,  // newLayout
+				finalColorImageLayout,  // newLayout
 				VK_QUEUE_FAMILY_IGNORED,  // srcQueueFamilyIndex
 				VK_QUEUE_FAMILY_IGNORED,  // dstQueueFamilyIndex
 				swapchainImages[imageIndex],  // image
@@ -4893,7 +2566,7 @@ void App::frame(VulkanWindow&)
 			vk::RenderPassBeginInfo{
 				renderPass,  // renderPass
 				framebuffers[imageIndex],  // framebuffer
-				vk::Rect2D(vk::Offset2D(0, 0), window.surfaceExtent()),  // renderArea
+				vk::Rect2D(vk::Offset2D(0, 0), imageExtent),  // renderArea
 				2,  // clearValueCount
 				array<vk::ClearValue,2>{  // pClearValues
 					vk::ClearColorValue(array<float,4>{0.f, 0.f, 0.f, 1.f}),
@@ -4909,45 +2582,218 @@ void App::frame(VulkanWindow&)
 	// submit all copy operations that were not submitted yet
 	renderer.executeCopyOperations();
 
-	// submit frame
-	vk::Semaphore renderingFinishedSemaphore = renderingFinishedSemaphores[imageIndex];
-	device.queueSubmit(
-		graphicsQueue,  // queue
-		vk::SubmitInfo(
-			1, &imageAvailableSemaphore,  // waitSemaphoreCount + pWaitSemaphores +
-			&(const vk::PipelineStageFlags&)vk::PipelineStageFlags(  // pWaitDstStageMask
-				vk::PipelineStageFlagBits::eColorAttachmentOutput),
-			1, &commandBuffer,  // commandBufferCount + pCommandBuffers
-			1, &renderingFinishedSemaphore  // signalSemaphoreCount + pSignalSemaphores
-		),
-		renderingFinishedFence  // fence
-	);
+	// submit frame and present
+	// (nothing is presented in headless mode)
+	if(headless)
+		device.queueSubmit(
+			graphicsQueue,  // queue
+			vk::SubmitInfo(
+				0, nullptr, nullptr,  // waitSemaphoreCount + pWaitSemaphores + pWaitDstStageMask
+				1, &commandBuffer,  // commandBufferCount + pCommandBuffers
+				0, nullptr  // signalSemaphoreCount + pSignalSemaphores
+			),
+			renderingFinishedFence  // fence
+		);
+	else {
 
-	// present
-	r =
-		device.presentKHR(
-			presentationQueue,  // queue
-			&(const vk::PresentInfoKHR&)vk::PresentInfoKHR(  // presentInfo
-				1, &renderingFinishedSemaphore,  // waitSemaphoreCount + pWaitSemaphores
-				1, &swapchain, &imageIndex,  // swapchainCount + pSwapchains + pImageIndices
-				nullptr  // pResults
-			)
+		vk::Semaphore renderingFinishedSemaphore = renderingFinishedSemaphores[imageIndex];
+		device.queueSubmit(
+			graphicsQueue,  // queue
+			vk::SubmitInfo(
+				1, &imageAvailableSemaphore,  // waitSemaphoreCount + pWaitSemaphores +
+				&(const vk::PipelineStageFlags&)vk::PipelineStageFlags(  // pWaitDstStageMask
+					vk::PipelineStageFlagBits::eColorAttachmentOutput),
+				1, &commandBuffer,  // commandBufferCount + pCommandBuffers
+				1, &renderingFinishedSemaphore  // signalSemaphoreCount + pSignalSemaphores
+			),
+			renderingFinishedFence  // fence
 		);
-	if(r != vk::Result::eSuccess) {
-		if(r == vk::Result::eSuboptimalKHR) {
-			window.scheduleResize();
-			cout << "present result: Suboptimal" << endl;
-		} else if(r == vk::Result::eErrorOutOfDateKHR) {
-			window.scheduleResize();
-			cout << "present error: OutOfDate" << endl;
-		} else
-			throw runtime_error("Vulkan error: vkQueuePresentKHR() failed with error " + to_string(r) + ".");
+
+		// present
+		r =
+			device.presentKHR(
+				presentationQueue,  // queue
+				&(const vk::PresentInfoKHR&)vk::PresentInfoKHR(  // presentInfo
+					1, &renderingFinishedSemaphore,  // waitSemaphoreCount + pWaitSemaphores
+					1, &swapchain, &imageIndex,  // swapchainCount + pSwapchains + pImageIndices
+					nullptr  // pResults
+				)
+			);
+		if(r != vk::Result::eSuccess) {
+			if(r == vk::Result::eSuboptimalKHR) {
+				window.scheduleResize();
+				*logStream << "present result: Suboptimal" << endl;
+			} else if(r == vk::Result::eErrorOutOfDateKHR) {
+				window.scheduleResize();
+				*logStream << "present error: OutOfDate" << endl;
+			} else
+				throw runtime_error("Vulkan error: vkQueuePresentKHR() failed with error " + to_string(r) + ".");
+		}
+
 	}
 
 	// end of the frame
 	// (gpu computations might be running asynchronously now
 	// and presentation might be waiting for the rendering to finish)
 	renderer.endFrame();
+
+	// print startup times after the first frame of the loaded scene
+	if(!startupTimesPrinted && sceneLoaded) {
+		const CadR::Renderer::StartupInfo& info = renderer.startupInfo();
+		double totalTime = chrono::duration<double>(chrono::steady_clock::now() - startupBeginTime).count();
+		*logStream << "Startup times:\n"
+		        "   Renderer init:      " << info.initTime * 1000 << "ms (pipeline cache load "
+		     << info.pipelineCacheLoadTime * 1000 << "ms, processDrawables pipelines "
+		     << info.processDrawablesPipelinesTime * 1000 << "ms)\n"
+		        "   Scene load:         " << sceneLoadTime * 1000 << "ms\n"
+		        "   Pipeline creation:  " << pipelineCreationTime * 1000 << "ms\n"
+		        "   Total:              " << totalTime * 1000 << "ms (up to the end of the first frame of the loaded scene)\n"
+		        "   Pipeline cache:     " << info.pipelineCacheStatus;
+		if(info.pipelineCacheLoadedSize != 0)
+			*logStream << " (" << info.pipelineCacheLoadedSize << " bytes)";
+		*logStream << endl;
+		startupTimesPrinted = true;
+	}
+}
+
+
+void App::runBenchmark()
+{
+	// offscreen image and related resources
+	resize(window, vk::SurfaceCapabilitiesKHR(), headlessExtent);
+
+	// load scene
+	// (all the stages are performed on this thread and timed separately)
+	*logStream << "Processing file " << utf8FilePath << "..." << endl;
+	auto measure =
+		[](auto&& func) -> double {
+			auto t1 = chrono::steady_clock::now();
+			func();
+			return chrono::duration<double>(chrono::steady_clock::now() - t1).count();
+		};
+	loadTimes.parse = measure([&]() { loader->parse(filePath); });
+	loadTimes.buffers = measure([&]() { loader->resolveBuffers(); });
+	loadTimes.images = measure([&]() { loader->decodeImages(); });
+	loadTimes.meshes = measure([&]() { loader->buildGeometry(); });
+	loadTimes.upload =
+		measure([&]() {
+			loader->upload();
+			device.waitIdle();
+		});
+	sceneLoaded = true;
+	sceneLoadTime = chrono::duration<double>(chrono::steady_clock::now() - sceneLoadBeginTime).count() - pipelineCreationTime;
+
+	// initial camera distance
+	sceneBoundingSphere = loader->sceneBoundingSphere();
+	float fovy2Clamped = glm::clamp(fovy / 2.f, 1.f / 180.f * glm::pi<float>(), 90.f / 180.f * glm::pi<float>());
+	cameraDistance = sceneBoundingSphere.radius / sin(fovy2Clamped);
+
+	// render frames
+	// (camera orbits once around the scene, so the results are comparable between runs)
+	*logStream << "Rendering " << numBenchmarkFrames << " frames..." << endl;
+	frameInfoList.reserve(numBenchmarkFrames);
+	auto startTime = chrono::steady_clock::now();
+	for(uint32_t i=0; i<numBenchmarkFrames; i++) {
+		cameraHeading = 2.f * glm::pi<float>() * float(i) / float(numBenchmarkFrames);
+		frame(window);
+	}
+	device.waitIdle();
+	benchmarkTime = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	const CadR::FrameInfo& frameInfo = renderer.getFrameInfo();
+	if(frameInfo.frameNumber != ~size_t(0))
+		frameInfoList.push_back(frameInfo);
+
+	writeBenchmarkResults();
+}
+
+
+void App::writeBenchmarkResults()
+{
+	// device and setup
+	vk::PhysicalDeviceProperties deviceProperties = vulkanInstance.getPhysicalDeviceProperties(physicalDevice);
+	nlohmann::json j;
+	j["file"] = utf8FilePath;
+	j["device"] = {
+		{ "name", string(deviceProperties.deviceName.data()) },
+		{ "type", vk::to_string(deviceProperties.deviceType) },
+		{ "apiVersion", to_string(VK_API_VERSION_MAJOR(deviceProperties.apiVersion)) + "." +
+		                to_string(VK_API_VERSION_MINOR(deviceProperties.apiVersion)) + "." +
+		                to_string(VK_API_VERSION_PATCH(deviceProperties.apiVersion)) },
+		{ "driverVersion", deviceProperties.driverVersion },
+	};
+	j["settings"] = {
+		{ "width", imageExtent.width },
+		{ "height", imageExtent.height },
+		{ "dynamicRendering", dynamicRendering },
+		{ "samples", unsigned(numSamples) },
+		{ "frames", numBenchmarkFrames },
+	};
+
+	// load times
+	// (all times are in milliseconds)
+	const CadR::Renderer::StartupInfo& info = renderer.startupInfo();
+	j["loadTimes"] = {
+		{ "rendererInit", info.initTime * 1000 },
+		{ "parse", loadTimes.parse * 1000 },
+		{ "buffers", loadTimes.buffers * 1000 },
+		{ "images", loadTimes.images * 1000 },
+		{ "meshes", loadTimes.meshes * 1000 },
+		{ "upload", loadTimes.upload * 1000 },
+		{ "pipelineCreation", pipelineCreationTime * 1000 },
+		{ "sceneLoad", sceneLoadTime * 1000 },
+	};
+
+	// frame times
+	double cpuPeriod = renderer.cpuTimestampPeriod() * 1000;
+	double gpuPeriod = double(renderer.gpuTimestampPeriod()) * 1000;
+	nlohmann::json& frames = j["frames"] = nlohmann::json::array();
+	vector<double> cpuTimes;
+	vector<double> gpuTimes;
+	cpuTimes.reserve(frameInfoList.size());
+	gpuTimes.reserve(frameInfoList.size());
+	for(const CadR::FrameInfo& fi : frameInfoList) {
+		double cpuTime = double(fi.cpuEndFrame - fi.cpuBeginFrame) * cpuPeriod;
+		double gpuTime = double(fi.gpuEndExecution - fi.gpuBeginExecution) * gpuPeriod;
+		frames.push_back({
+			{ "frameNumber", fi.frameNumber },
+			{ "cpuTime", cpuTime },
+			{ "cpuPrepareRecording", double(fi.cpuPrepareRecordingEnd - fi.cpuPrepareRecordingBegin) * cpuPeriod },
+			{ "cpuRecordStateSets", double(fi.cpuRecordStateSetsEnd - fi.cpuRecordStateSetsBegin) * cpuPeriod },
+			{ "gpuTime", gpuTime },
+			{ "gpuTransfers", double(fi.gpuAfterTransfersAndBeforeDrawableProcessing - fi.gpuBeginExecution) * gpuPeriod },
+			{ "gpuDrawableProcessing", double(fi.gpuAfterDrawableProcessingAndBeforeRendering - fi.gpuAfterTransfersAndBeforeDrawableProcessing) * gpuPeriod },
+			{ "gpuRendering", double(fi.gpuEndExecution - fi.gpuAfterDrawableProcessingAndBeforeRendering) * gpuPeriod },
+		});
+		cpuTimes.push_back(cpuTime);
+		gpuTimes.push_back(gpuTime);
+	}
+
+	// summary
+	auto median =
+		[](vector<double>& v) -> double {
+			if(v.empty())
+				return 0.;
+			nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+			return v[v.size() / 2];
+		};
+	j["summary"] = {
+		{ "numFrames", frameInfoList.size() },
+		{ "totalTime", benchmarkTime * 1000 },
+		{ "fps", (benchmarkTime > 0.) ? numBenchmarkFrames / benchmarkTime : 0. },
+		{ "medianCpuTime", median(cpuTimes) },
+		{ "medianGpuTime", median(gpuTimes) },
+	};
+
+	// write results
+	if(benchmarkOutputFile.empty())
+		cout << j.dump(3) << endl;
+	else {
+		ofstream f(benchmarkOutputFile);
+		if(!f.is_open())
+			throw ExitWithMessage(1, "Cannot open file " + benchmarkOutputFile.string() + " for writing.");
+		f << j.dump(3) << endl;
+		*logStream << "Benchmark results written to " << benchmarkOutputFile.string() << "." << endl;
+	}
 }
 
 
@@ -5095,6 +2941,15 @@ try {
 	// init application
 	App app(argc, argv);
 	app.init();
+
+	// headless benchmark
+	// (no window and no main loop)
+	if(app.headless) {
+		app.runBenchmark();
+		app.device.waitIdle();
+		return 0;
+	}
+
 	app.window.setResizeCallback(
 		bind(
 			&App::resize,
@@ -0,0 +1,935 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include <CadGltf/GltfJson.h>
+#include <CadR/Exceptions.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <cstring>
+#include <string>
+
+using namespace std;
+using namespace CadGltf;
+
+using json = nlohmann::json;
+typedef CadR::LogicError GltfError;
+
+
+namespace {
+
+// item properties that are read into typed lists
+// (Unknown properties, such as name, extras and extensions, are skipped)
+enum class Property { Unknown, Matrix, Scale, Rotation, Translation, Children, Mesh,
+                      BufferView, ByteOffset, ComponentType, Normalized, Count, Type, Sparse, Min, Max,
+                      Buffer, ByteLength, ByteStride, Extensions, Mode, Filter, Attributes };
+
+// node properties as they come from json
+// (they are composed into the node matrix when the whole node was read)
+struct NodeProperties {
+	static constexpr unsigned notPresent = ~0u;
+	unsigned matrixSize;
+	unsigned scaleSize;
+	unsigned rotationSize;
+	unsigned translationSize;
+	float matrix[16];
+	float scale[3];
+	float rotation[4];
+	float translation[3];
+	uint32_t meshIndex;
+	uint32_t firstChild;
+	uint32_t instancing;
+	void reset(uint32_t firstChildIndex)
+	{
+		matrixSize = notPresent;
+		scaleSize = notPresent;
+		rotationSize = notPresent;
+		translationSize = notPresent;
+		meshIndex = ~uint32_t(0);
+		firstChild = firstChildIndex;
+		instancing = ~uint32_t(0);
+	}
+};
+
+}
+
+
+static Property nodeProperty(const string& key)
+{
+	if(key == "matrix")       return Property::Matrix;
+	if(key == "scale")        return Property::Scale;
+	if(key == "rotation")     return Property::Rotation;
+	if(key == "translation")  return Property::Translation;
+	if(key == "children")     return Property::Children;
+	if(key == "mesh")         return Property::Mesh;
+	if(key == "extensions")   return Property::Extensions;
+	return Property::Unknown;
+}
+
+
+static Property accessorProperty(const string& key)
+{
+	if(key == "bufferView")     return Property::BufferView;
+	if(key == "byteOffset")     return Property::ByteOffset;
+	if(key == "componentType")  return Property::ComponentType;
+	if(key == "normalized")     return Property::Normalized;
+	if(key == "count")          return Property::Count;
+	if(key == "type")           return Property::Type;
+	if(key == "sparse")         return Property::Sparse;
+	if(key == "min")            return Property::Min;
+	if(key == "max")            return Property::Max;
+	return Property::Unknown;
+}
+
+
+static Property bufferViewProperty(const string& key)
+{
+	if(key == "buffer")      return Property::Buffer;
+	if(key == "byteOffset")  return Property::ByteOffset;
+	if(key == "byteLength")  return Property::ByteLength;
+	if(key == "byteStride")  return Property::ByteStride;
+	if(key == "extensions")  return Property::Extensions;
+	return Property::Unknown;
+}
+
+
+static Property instancingAttribute(const string& key)
+{
+	if(key == "TRANSLATION")  return Property::Translation;
+	if(key == "ROTATION")     return Property::Rotation;
+	if(key == "SCALE")        return Property::Scale;
+	return Property::Unknown;
+}
+
+
+static Property meshoptProperty(const string& key)
+{
+	if(key == "buffer")      return Property::Buffer;
+	if(key == "byteOffset")  return Property::ByteOffset;
+	if(key == "byteLength")  return Property::ByteLength;
+	if(key == "byteStride")  return Property::ByteStride;
+	if(key == "count")       return Property::Count;
+	if(key == "mode")        return Property::Mode;
+	if(key == "filter")      return Property::Filter;
+	return Property::Unknown;
+}
+
+
+static MeshoptDecoder::Mode meshoptMode(const string& s)
+{
+	using Mode = MeshoptDecoder::Mode;
+	if(s == "ATTRIBUTES")  return Mode::Attributes;
+	if(s == "TRIANGLES")   return Mode::Triangles;
+	if(s == "INDICES")     return Mode::Indices;
+	return Mode::Unknown;
+}
+
+
+static MeshoptDecoder::Filter meshoptFilter(const string& s)
+{
+	using Filter = MeshoptDecoder::Filter;
+	if(s == "NONE")         return Filter::None;
+	if(s == "OCTAHEDRAL")   return Filter::Octahedral;
+	if(s == "QUATERNION")   return Filter::Quaternion;
+	if(s == "EXPONENTIAL")  return Filter::Exponential;
+	return Filter::Unknown;
+}
+
+
+static GltfJson::AccessorType accessorType(const string& s)
+{
+	using AccessorType = GltfJson::AccessorType;
+	if(s == "SCALAR")  return AccessorType::Scalar;
+	if(s == "VEC2")    return AccessorType::Vec2;
+	if(s == "VEC3")    return AccessorType::Vec3;
+	if(s == "VEC4")    return AccessorType::Vec4;
+	if(s == "MAT2")    return AccessorType::Mat2;
+	if(s == "MAT3")    return AccessorType::Mat3;
+	if(s == "MAT4")    return AccessorType::Mat4;
+	return AccessorType::Unknown;
+}
+
+
+static uint32_t toIndex(uint64_t value)
+{
+	if(value > 0xfffffffe)
+		throw GltfError("Index value out of supported range.");
+	return uint32_t(value);
+}
+
+
+// composes node matrix from node properties
+static GltfJson::Node composeNode(const NodeProperties& p, uint32_t numChildren)
+{
+	constexpr unsigned notPresent = NodeProperties::notPresent;
+	GltfJson::Node node;
+	node.meshIndex = p.meshIndex;
+	node.firstChild = p.firstChild;
+	node.numChildren = numChildren;
+	node.instancing = p.instancing;
+
+	// matrix
+	if(p.matrixSize != notPresent) {
+
+		// translation, rotation and scale must not be present
+		if(p.translationSize != notPresent || p.rotationSize != notPresent || p.scaleSize != notPresent)
+			throw GltfError("If matrix is provided for the node, translation, rotation and scale must not be present.");
+
+		// read matrix
+		if(p.matrixSize != 16)
+			throw GltfError("Node.matrix is not vector of 16 components.");
+		memcpy(glm::value_ptr(node.matrix), p.matrix, sizeof(p.matrix));
+	}
+	else {
+
+		// scale
+		glm::vec3 scale;
+		if(p.scaleSize != notPresent) {
+			if(p.scaleSize != 3)
+				throw GltfError("Node.scale is not vector of three components.");
+			scale = { p.scale[0], p.scale[1], p.scale[2] };
+		}
+		else
+			scale = { 1.f, 1.f, 1.f };
+
+		// rotation
+		if(p.rotationSize != notPresent) {
+			if(p.rotationSize != 4)
+				throw GltfError("Node.rotation is not vector of four components.");
+			glm::quat q;
+			q.x = p.rotation[0];
+			q.y = p.rotation[1];
+			q.z = p.rotation[2];
+			q.w = p.rotation[3];
+			glm::mat3 m = glm::mat3(q);
+			node.matrix[0] = glm::vec4(m[0] * scale.x, 0.f);
+			node.matrix[1] = glm::vec4(m[1] * scale.y, 0.f);
+			node.matrix[2] = glm::vec4(m[2] * scale.z, 0.f);
+			node.matrix[3] = glm::vec4(0.f, 0.f, 0.f, 1.f);
+		}
+		else {
+			// initialize matrix by scale only
+			memset(&node.matrix, 0, sizeof(node.matrix));
+			node.matrix[0][0] = scale.x;
+			node.matrix[1][1] = scale.y;
+			node.matrix[2][2] = scale.z;
+			node.matrix[3][3] = 1.f;
+		}
+
+		// translation
+		if(p.translationSize != notPresent) {
+			if(p.translationSize != 3)
+				throw GltfError("Node.translation is not vector of three components.");
+			node.matrix[3][0] = p.translation[0];
+			node.matrix[3][1] = p.translation[1];
+			node.matrix[3][2] = p.translation[2];
+		}
+
+	}
+
+	return node;
+}
+
+
+void GltfJson::parseDom(const uint8_t* data, size_t size)
+{
+	clear();
+	root = json::parse(data, data + size);
+	if(!root.is_object())
+		throw GltfError("glTF json root is not an object.");
+	json::object_t& rootObject = root.get_ref<json::object_t&>();
+
+	// read float array of up to maxSize components
+	auto readFloats =
+		[](const json& j, float* dst, unsigned maxSize) -> unsigned
+		{
+			const json::array_t& a = j.get_ref<const json::array_t&>();
+			for(size_t i=0, c=min(a.size(), size_t(maxSize)); i<c; i++)
+				dst[i] = float(a[i].get<json::number_float_t>());
+			return unsigned(min(a.size(), size_t(0xff)));
+		};
+
+	// nodes
+	if(auto it=rootObject.find("nodes"); it!=rootObject.end()) {
+		json::array_t& nodes = it->second.get_ref<json::array_t&>();
+		nodeList.reserve(nodes.size());
+		NodeProperties p;
+		for(json& node : nodes) {
+			p.reset(uint32_t(nodeChildList.size()));
+			for(auto& [key, value] : node.get_ref<json::object_t&>())
+				switch(nodeProperty(key)) {
+				case Property::Matrix:      p.matrixSize = readFloats(value, p.matrix, 16); break;
+				case Property::Scale:       p.scaleSize = readFloats(value, p.scale, 3); break;
+				case Property::Rotation:    p.rotationSize = readFloats(value, p.rotation, 4); break;
+				case Property::Translation: p.translationSize = readFloats(value, p.translation, 3); break;
+				case Property::Mesh:        p.meshIndex = toIndex(value.get_ref<json::number_unsigned_t&>()); break;
+				case Property::Children:
+					for(json& child : value.get_ref<json::array_t&>())
+						nodeChildList.emplace_back(toIndex(child.get_ref<json::number_unsigned_t&>()));
+					break;
+				case Property::Extensions: {
+					json::object_t& extensions = value.get_ref<json::object_t&>();
+					auto extIt = extensions.find("EXT_mesh_gpu_instancing");
+					if(extIt == extensions.end())
+						break;
+					Instancing& instancing = instancingList.emplace_back();
+					p.instancing = uint32_t(instancingList.size() - 1);
+					json::object_t& ext = extIt->second.get_ref<json::object_t&>();
+					if(auto attrIt=ext.find("attributes"); attrIt!=ext.end())
+						for(auto& [aKey, aValue] : attrIt->second.get_ref<json::object_t&>())
+							switch(instancingAttribute(aKey)) {
+							case Property::Translation: instancing.translation = toIndex(aValue.get_ref<json::number_unsigned_t&>()); break;
+							case Property::Rotation:    instancing.rotation = toIndex(aValue.get_ref<json::number_unsigned_t&>()); break;
+							case Property::Scale:       instancing.scale = toIndex(aValue.get_ref<json::number_unsigned_t&>()); break;
+							default: break;
+							}
+					break;
+				}
+				default: break;
+				}
+			nodeList.emplace_back(composeNode(p, uint32_t(nodeChildList.size()) - p.firstChild));
+		}
+		rootObject.erase(it);
+	}
+
+	// accessors
+	if(auto it=rootObject.find("accessors"); it!=rootObject.end()) {
+		json::array_t& accessors = it->second.get_ref<json::array_t&>();
+		accessorList.reserve(accessors.size());
+		for(json& accessor : accessors) {
+			Accessor& a = accessorList.emplace_back();
+			for(auto& [key, value] : accessor.get_ref<json::object_t&>())
+				switch(accessorProperty(key)) {
+				case Property::BufferView:    a.bufferView = toIndex(value.get_ref<json::number_unsigned_t&>()); break;
+				case Property::ByteOffset:    a.byteOffset = value.get_ref<json::number_unsigned_t&>(); break;
+				case Property::ComponentType: a.componentType = toIndex(value.get_ref<json::number_unsigned_t&>()); break;
+				case Property::Normalized:    a.normalized = value.get_ref<json::boolean_t&>(); break;
+				case Property::Count:         a.count = value.get_ref<json::number_unsigned_t&>(); break;
+				case Property::Type:          a.type = accessorType(value.get_ref<json::string_t&>()); break;
+				case Property::Sparse:        a.sparse = true; break;
+				case Property::Min:           a.minSize = uint8_t(readFloats(value, a.min, 3)); break;
+				case Property::Max:           a.maxSize = uint8_t(readFloats(value, a.max, 3)); break;
+				default: break;
+				}
+		}
+		rootObject.erase(it);
+	}
+
+	// bufferViews
+	if(auto it=rootObject.find("bufferViews"); it!=rootObject.end()) {
+		json::array_t& bufferViews = it->second.get_ref<json::array_t&>();
+		bufferViewList.reserve(bufferViews.size());
+		for(json& bufferView : bufferViews) {
+			BufferView& b = bufferViewList.emplace_back();
+			for(auto& [key, value] : bufferView.get_ref<json::object_t&>())
+				switch(bufferViewProperty(key)) {
+				case Property::Buffer:     b.buffer = toIndex(value.get_ref<json::number_unsigned_t&>()); break;
+				case Property::ByteOffset: b.byteOffset = value.get_ref<json::number_unsigned_t&>(); break;
+				case Property::ByteLength: b.byteLength = value.get_ref<json::number_unsigned_t&>(); break;
+				case Property::ByteStride: b.byteStride = toIndex(value.get_ref<json::number_unsigned_t&>()); break;
+				case Property::Extensions: {
+					json::object_t& extensions = value.get_ref<json::object_t&>();
+					auto extIt = extensions.find("EXT_meshopt_compression");
+					if(extIt == extensions.end())
+						break;
+					MeshoptCompression& m = meshoptCompressionList.emplace_back();
+					b.meshoptCompression = uint32_t(meshoptCompressionList.size() - 1);
+					for(auto& [mKey, mValue] : extIt->second.get_ref<json::object_t&>())
+						switch(meshoptProperty(mKey)) {
+						case Property::Buffer:     m.buffer = toIndex(mValue.get_ref<json::number_unsigned_t&>()); break;
+						case Property::ByteOffset: m.byteOffset = mValue.get_ref<json::number_unsigned_t&>(); break;
+						case Property::ByteLength: m.byteLength = mValue.get_ref<json::number_unsigned_t&>(); break;
+						case Property::ByteStride: m.byteStride = toIndex(mValue.get_ref<json::number_unsigned_t&>()); break;
+						case Property::Count:      m.count = mValue.get_ref<json::number_unsigned_t&>(); break;
+						case Property::Mode:       m.mode = meshoptMode(mValue.get_ref<json::string_t&>()); break;
+						case Property::Filter:     m.filter = meshoptFilter(mValue.get_ref<json::string_t&>()); break;
+						default: break;
+						}
+					break;
+				}
+				default: break;
+				}
+		}
+		rootObject.erase(it);
+	}
+}
+
+
+namespace {
+
+/** SAX handler of nlohmann::json::sax_parse().
+ *  Items of nodes, accessors and bufferViews root arrays are written directly into typed lists,
+ *  while DOM is built for the rest of the document.
+ */
+class StreamingParser {
+protected:
+
+	enum class Section { Dom, Nodes, Accessors, BufferViews };
+
+	GltfJson& _r;
+
+	// DOM building
+	vector<json*> _domStack;  //< Objects and arrays being built. Empty before the root object was started.
+	std::string _domKey;  //< Key of the next value when the top of the stack is object.
+
+	// typed sections
+	Section _section = Section::Dom;
+	Section _nextSection = Section::Dom;  //< Section of the root item whose key was just read.
+	unsigned _depth = 0;  //< 1 - inside section array, 2 - inside item, 3 - inside item property, 4+ - nested deeper.
+	Property _property = Property::Unknown;
+	std::string _propertyName;
+	unsigned _propertySize = 0;  //< Number of values of array property read so far.
+	NodeProperties _node;
+	GltfJson::Accessor _accessor;
+	GltfJson::BufferView _bufferView;
+
+	// item extensions
+	// (EXT_mesh_gpu_instancing of nodes and EXT_meshopt_compression of bufferViews are read
+	// from depth 4, instancing attributes from depth 5; other extensions are skipped)
+	bool _extension = false;  //< The last key inside item extensions is the extension that is read.
+	bool _hasExtension = false;  //< The item contains the extension that is read.
+	Property _extensionProperty = Property::Unknown;
+	Property _instancingAttribute = Property::Unknown;
+	GltfJson::MeshoptCompression _meshopt;
+	GltfJson::Instancing _instancing;
+
+	// returns true if nested content of the property is skipped
+	bool skipped() const  { return _property == Property::Unknown || _property == Property::Sparse ||
+	                               (_property == Property::Extensions && !_extension); }
+
+	// returns true if the value at depth 4 belongs to the extension object
+	bool inExtension() const  { return _depth == 4 && _property == Property::Extensions && _extension; }
+
+	// returns true if the value at depth 5 belongs to EXT_mesh_gpu_instancing.attributes object
+	bool inInstancingAttributes() const
+	{
+		return _depth == 5 && _section == Section::Nodes && _property == Property::Extensions &&
+		       _extension && _extensionProperty == Property::Attributes;
+	}
+
+	// returns true if the value is a known property of the extension object
+	bool extensionValue() const
+	{
+		return (inExtension() && _extensionProperty != Property::Unknown) ||
+		       (inInstancingAttributes() && _instancingAttribute != Property::Unknown);
+	}
+
+	[[noreturn]] void invalidValue() const
+	{
+		const char* sectionName =
+			(_section == Section::Nodes) ? "Node" :
+			(_section == Section::Accessors) ? "Accessor" : "BufferView";
+		throw GltfError(std::string("Invalid value of ") + sectionName + "." + _propertyName + ".");
+	}
+
+	[[noreturn]] void invalidExtensionValue() const
+	{
+		if(_section == Section::Nodes)
+			throw GltfError("Invalid value of EXT_mesh_gpu_instancing property of Node.");
+		throw GltfError("Invalid value of EXT_meshopt_compression property of BufferView.");
+	}
+
+	[[noreturn]] void notArray() const
+	{
+		throw GltfError("Root item nodes, accessors or bufferViews is not an array.");
+	}
+
+	template<typename T>
+	bool domValue(T&& value)
+	{
+		if(_domStack.empty())
+			throw GltfError("glTF json root is not an object.");
+		if(_nextSection != Section::Dom)
+			notArray();
+		json& top = *_domStack.back();
+		if(top.is_array())
+			top.get_ref<json::array_t&>().emplace_back(std::forward<T>(value));
+		else
+			top.get_ref<json::object_t&>()[_domKey] = std::forward<T>(value);
+		return true;
+	}
+
+	bool domStart(json::value_t type)
+	{
+		if(_domStack.empty()) {
+			if(type != json::value_t::object)
+				throw GltfError("glTF json root is not an object.");
+			_r.root = json(type);
+			_domStack.push_back(&_r.root);
+			return true;
+		}
+		if(_nextSection != Section::Dom)
+			notArray();
+		json& top = *_domStack.back();
+		json* child;
+		if(top.is_array())
+			child = &top.get_ref<json::array_t&>().emplace_back(type);
+		else {
+			json& j = top.get_ref<json::object_t&>()[_domKey];
+			j = json(type);
+			child = &j;
+		}
+		_domStack.push_back(child);
+		return true;
+	}
+
+	// processes float value of array property
+	void floatArrayValue(double value)
+	{
+		unsigned i = _propertySize;
+		if(_propertySize < 0xff)
+			_propertySize++;
+		switch(_property) {
+		case Property::Matrix:      if(i < 16) _node.matrix[i] = float(value); break;
+		case Property::Scale:       if(i < 3) _node.scale[i] = float(value); break;
+		case Property::Rotation:    if(i < 4) _node.rotation[i] = float(value); break;
+		case Property::Translation: if(i < 3) _node.translation[i] = float(value); break;
+		case Property::Min:         if(i < 3) _accessor.min[i] = float(value); break;
+		case Property::Max:         if(i < 3) _accessor.max[i] = float(value); break;
+		default: break;
+		}
+	}
+
+	// processes number value of typed item
+	bool numberValue(double f, uint64_t u, bool isUnsigned)
+	{
+		if(inInstancingAttributes()) {
+			if(_instancingAttribute == Property::Unknown)
+				return true;
+			if(!isUnsigned)
+				invalidExtensionValue();
+			switch(_instancingAttribute) {
+			case Property::Translation: _instancing.translation = toIndex(u); break;
+			case Property::Rotation:    _instancing.rotation = toIndex(u); break;
+			default:                    _instancing.scale = toIndex(u); break;
+			}
+			return true;
+		}
+		if(inExtension()) {
+			if(_extensionProperty == Property::Unknown)
+				return true;
+			if(!isUnsigned || _section == Section::Nodes ||
+			   _extensionProperty == Property::Mode || _extensionProperty == Property::Filter)
+				invalidExtensionValue();
+			switch(_extensionProperty) {
+			case Property::Buffer:     _meshopt.buffer = toIndex(u); break;
+			case Property::ByteOffset: _meshopt.byteOffset = u; break;
+			case Property::ByteLength: _meshopt.byteLength = u; break;
+			case Property::ByteStride: _meshopt.byteStride = toIndex(u); break;
+			default:                   _meshopt.count = u; break;
+			}
+			return true;
+		}
+		if(_depth == 3) {
+			if(_property == Property::Extensions) {
+				if(_extension)
+					invalidValue();
+			}
+			else if(_property == Property::Children) {
+				if(!isUnsigned)
+					invalidValue();
+				_r.nodeChildList.emplace_back(toIndex(u));
+			}
+			else
+				floatArrayValue(f);
+			return true;
+		}
+		if(_depth != 2) {
+			if(_depth == 1)
+				invalidItem();
+			return true;
+		}
+		switch(_property) {
+		case Property::Unknown: return true;
+		case Property::Mesh:
+		case Property::BufferView:
+		case Property::ByteOffset:
+		case Property::ComponentType:
+		case Property::Count:
+		case Property::Buffer:
+		case Property::ByteLength:
+		case Property::ByteStride:
+			if(!isUnsigned)
+				invalidValue();
+			break;
+		default:
+			invalidValue();
+		}
+		switch(_property) {
+		case Property::Mesh:          _node.meshIndex = toIndex(u); break;
+		case Property::BufferView:    _accessor.bufferView = toIndex(u); break;
+		case Property::ComponentType: _accessor.componentType = toIndex(u); break;
+		case Property::Count:         _accessor.count = u; break;
+		case Property::Buffer:        _bufferView.buffer = toIndex(u); break;
+		case Property::ByteLength:    _bufferView.byteLength = u; break;
+		case Property::ByteStride:    _bufferView.byteStride = toIndex(u); break;
+		case Property::ByteOffset:
+			if(_section == Section::Accessors)
+				_accessor.byteOffset = u;
+			else
+				_bufferView.byteOffset = u;
+			break;
+		default: break;
+		}
+		return true;
+	}
+
+	// processes other values of typed item
+	bool otherValue()
+	{
+		if(_depth == 1)
+			invalidItem();
+		if(extensionValue())
+			invalidExtensionValue();
+		if(_depth == 2 ? _property != Property::Unknown : _depth == 3 && !skipped())
+			invalidValue();
+		return true;
+	}
+
+	[[noreturn]] void invalidItem() const
+	{
+		switch(_section) {
+		case Section::Nodes:     throw GltfError("Node is not an object.");
+		case Section::Accessors: throw GltfError("Accessor is not an object.");
+		default:                 throw GltfError("BufferView is not an object.");
+		}
+	}
+
+public:
+
+	StreamingParser(GltfJson& r) : _r(r)  {}
+
+	bool null()
+	{
+		if(_section == Section::Dom)
+			return domValue(nullptr);
+		return otherValue();
+	}
+
+	bool boolean(bool value)
+	{
+		if(_section == Section::Dom)
+			return domValue(value);
+		if(_depth == 2 && _property == Property::Normalized) {
+			_accessor.normalized = value;
+			return true;
+		}
+		return otherValue();
+	}
+
+	bool number_integer(json::number_integer_t value)
+	{
+		if(_section == Section::Dom)
+			return domValue(value);
+		return numberValue(double(value), 0, false);
+	}
+
+	bool number_unsigned(json::number_unsigned_t value)
+	{
+		if(_section == Section::Dom)
+			return domValue(value);
+		return numberValue(double(value), value, true);
+	}
+
+	bool number_float(json::number_float_t value, const json::string_t&)
+	{
+		if(_section == Section::Dom)
+			return domValue(value);
+		return numberValue(value, 0, false);
+	}
+
+	bool string(json::string_t& value)
+	{
+		if(_section == Section::Dom)
+			return domValue(std::move(value));
+		if(_depth == 2 && _property == Property::Type) {
+			_accessor.type = accessorType(value);
+			return true;
+		}
+		if(inExtension() && _section == Section::BufferViews &&
+		   (_extensionProperty == Property::Mode || _extensionProperty == Property::Filter)) {
+			if(_extensionProperty == Property::Mode)
+				_meshopt.mode = meshoptMode(value);
+			else
+				_meshopt.filter = meshoptFilter(value);
+			return true;
+		}
+		return otherValue();
+	}
+
+	bool binary(json::binary_t& value)
+	{
+		if(_section == Section::Dom)
+			return domValue(json::binary(std::move(value)));
+		return otherValue();
+	}
+
+	bool start_object(size_t)
+	{
+		if(_section == Section::Dom)
+			return domStart(json::value_t::object);
+
+		switch(_depth) {
+		case 1:
+			// start item
+			switch(_section) {
+			case Section::Nodes:     _node.reset(uint32_t(_r.nodeChildList.size())); break;
+			case Section::Accessors: _accessor = {}; break;
+			default:                 _bufferView = {}; break;
+			}
+			_property = Property::Unknown;
+			_hasExtension = false;
+			break;
+		case 2:
+			// object property
+			// (accessor.sparse is recorded, node and bufferView extensions are parsed,
+			// other object properties, such as accessor extensions and extras, are skipped)
+			if(_property == Property::Sparse)
+				_accessor.sparse = true;
+			else if(_property == Property::Extensions)
+				_extension = false;
+			else if(_property != Property::Unknown)
+				invalidValue();
+			break;
+		case 3:
+			if(_property == Property::Extensions && _extension) {
+				// start EXT_mesh_gpu_instancing or EXT_meshopt_compression
+				if(_section == Section::Nodes)
+					_instancing = {};
+				else
+					_meshopt = {};
+				_extensionProperty = Property::Unknown;
+				_hasExtension = true;
+			}
+			else if(!skipped())
+				invalidValue();
+			break;
+		case 4:
+			// EXT_mesh_gpu_instancing.attributes is the only object property of the extensions
+			if(inExtension() && _extensionProperty != Property::Unknown) {
+				if(_extensionProperty != Property::Attributes)
+					invalidExtensionValue();
+				_instancingAttribute = Property::Unknown;
+			}
+			break;
+		case 5:
+			if(extensionValue())
+				invalidExtensionValue();
+			break;
+		}
+		_depth++;
+		return true;
+	}
+
+	bool end_object()
+	{
+		if(_section == Section::Dom) {
+			_domStack.pop_back();
+			return true;
+		}
+
+		// finish item
+		if(_depth == 2)
+			switch(_section) {
+			case Section::Nodes:
+				if(_hasExtension) {
+					_node.instancing = uint32_t(_r.instancingList.size());
+					_r.instancingList.emplace_back(_instancing);
+				}
+				_r.nodeList.emplace_back(composeNode(_node, uint32_t(_r.nodeChildList.size()) - _node.firstChild));
+				break;
+			case Section::Accessors:
+				_r.accessorList.emplace_back(_accessor);
+				break;
+			default:
+				if(_hasExtension) {
+					_bufferView.meshoptCompression = uint32_t(_r.meshoptCompressionList.size());
+					_r.meshoptCompressionList.emplace_back(_meshopt);
+				}
+				_r.bufferViewList.emplace_back(_bufferView);
+			}
+		_depth--;
+		return true;
+	}
+
+	bool start_array(size_t)
+	{
+		if(_section == Section::Dom) {
+
+			// start typed section
+			if(_nextSection != Section::Dom && _domStack.size() == 1) {
+				_section = _nextSection;
+				_nextSection = Section::Dom;
+				_depth = 1;
+				return true;
+			}
+
+			return domStart(json::value_t::array);
+		}
+
+		switch(_depth) {
+		case 1: invalidItem();
+		case 2:
+			// array property
+			switch(_property) {
+			case Property::Matrix:
+			case Property::Scale:
+			case Property::Rotation:
+			case Property::Translation:
+			case Property::Children:
+			case Property::Min:
+			case Property::Max:
+			case Property::Unknown:
+				_propertySize = 0;
+				break;
+			default:
+				invalidValue();
+			}
+			break;
+		case 3:
+			if(!skipped())
+				invalidValue();
+			break;
+		case 4:
+		case 5:
+			if(extensionValue())
+				invalidExtensionValue();
+			break;
+		}
+		_depth++;
+		return true;
+	}
+
+	bool end_array()
+	{
+		if(_section == Section::Dom) {
+			_domStack.pop_back();
+			return true;
+		}
+
+		switch(_depth) {
+		case 1:
+			// end typed section
+			// (lists are grown without knowing their final size, so return their unused capacity)
+			switch(_section) {
+			case Section::Nodes:
+				_r.nodeList.shrink_to_fit();
+				_r.nodeChildList.shrink_to_fit();
+				_r.instancingList.shrink_to_fit();
+				break;
+			case Section::Accessors: _r.accessorList.shrink_to_fit(); break;
+			default:
+				_r.bufferViewList.shrink_to_fit();
+				_r.meshoptCompressionList.shrink_to_fit();
+			}
+			_section = Section::Dom;
+			_depth = 0;
+			return true;
+		case 3:
+			// end of array property
+			switch(_property) {
+			case Property::Matrix:      _node.matrixSize = _propertySize; break;
+			case Property::Scale:       _node.scaleSize = _propertySize; break;
+			case Property::Rotation:    _node.rotationSize = _propertySize; break;
+			case Property::Translation: _node.translationSize = _propertySize; break;
+			case Property::Min:         _accessor.minSize = uint8_t(_propertySize); break;
+			case Property::Max:         _accessor.maxSize = uint8_t(_propertySize); break;
+			default: break;
+			}
+			break;
+		}
+		_depth--;
+		return true;
+	}
+
+	bool key(json::string_t& value)
+	{
+		if(_section == Section::Dom) {
+
+			// typed sections start by root items of the given key
+			if(_domStack.size() == 1) {
+				if(value == "nodes") {
+					_nextSection = Section::Nodes;
+					_r.nodeList.clear();
+					_r.nodeChildList.clear();
+					_r.instancingList.clear();
+				}
+				else if(value == "accessors") {
+					_nextSection = Section::Accessors;
+					_r.accessorList.clear();
+				}
+				else if(value == "bufferViews") {
+					_nextSection = Section::BufferViews;
+					_r.bufferViewList.clear();
+					_r.meshoptCompressionList.clear();
+				}
+				else {
+					_nextSection = Section::Dom;
+					_domKey = std::move(value);
+					return true;
+				}
+				_r.root.get_ref<json::object_t&>().erase(value);
+				_domKey.clear();
+				return true;
+			}
+
+			_domKey = std::move(value);
+			return true;
+		}
+
+		// property of typed item
+		if(_depth == 2) {
+			switch(_section) {
+			case Section::Nodes:     _property = nodeProperty(value); break;
+			case Section::Accessors: _property = accessorProperty(value); break;
+			default:                 _property = bufferViewProperty(value); break;
+			}
+			if(_property != Property::Unknown)
+				_propertyName = value;
+		}
+
+		// node and bufferView extensions
+		else if(_property == Property::Extensions) {
+			if(_depth == 3)
+				_extension = (value == ((_section == Section::Nodes) ? "EXT_mesh_gpu_instancing" : "EXT_meshopt_compression"));
+			else if(inExtension()) {
+				if(_section == Section::Nodes)
+					_extensionProperty = (value == "attributes") ? Property::Attributes : Property::Unknown;
+				else
+					_extensionProperty = meshoptProperty(value);
+			}
+			else if(inInstancingAttributes())
+				_instancingAttribute = instancingAttribute(value);
+		}
+		return true;
+	}
+
+	bool parse_error(size_t, const std::string&, const nlohmann::detail::exception& e)
+	{
+		throw GltfError(std::string("glTF json parse error: ") + e.what());
+	}
+
+};
+
+}
+
+
+void GltfJson::parseStreaming(const uint8_t* data, size_t size)
+{
+	clear();
+	StreamingParser parser(*this);
+	json::sax_parse(data, data + size, &parser);
+}
+
+
+void GltfJson::clear() noexcept
+{
+	root = nullptr;
+	nodeList.clear();
+	nodeChildList.clear();
+	instancingList.clear();
+	accessorList.clear();
+	bufferViewList.clear();
+	meshoptCompressionList.clear();
+}
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <nlohmann/json.hpp>
+#include <CadGltf/MeshoptDecoder.h>
+
+namespace CadGltf {
+
+
+/** Parsed json of glTF file.
+ *
+ *  Nodes, accessors and bufferViews are the items whose count grows with the model size,
+ *  reaching millions in CAD generated files. They are stored in compact typed lists,
+ *  while the rest of the document is kept as json DOM in root. The typed lists
+ *  are produced either by parsing the whole DOM and converting the three root arrays
+ *  (parseDom()), or by SAX parser that never builds DOM of the three arrays (parseStreaming()).
+ *  Both give identical results. The streaming one consumes a fraction of memory
+ *  and time on large files.
+ *
+ *  Mandatory properties of the typed items are checked during parsing,
+ *  so GltfError is thrown on their absence. Validation depending on the usage
+ *  of the item, such as accessor type of particular attribute, is left on the caller.
+ */
+class CADGLTF_EXPORT GltfJson {
+public:
+
+	enum class AccessorType : uint8_t { Unknown, Scalar, Vec2, Vec3, Vec4, Mat2, Mat3, Mat4 };
+
+	struct Node {
+		glm::mat4 matrix;  //< Node matrix, or matrix composed from translation, rotation and scale.
+		uint32_t meshIndex;  //< Index of the mesh or ~0 if the node has no mesh.
+		uint32_t firstChild;  //< Index of the first child in nodeChildList.
+		uint32_t numChildren;
+		uint32_t instancing;  //< Index into instancingList or ~0 if the node does not use EXT_mesh_gpu_instancing.
+	};
+
+	struct Instancing {  //< Attributes of EXT_mesh_gpu_instancing extension of node.
+		uint32_t translation = ~uint32_t(0);  //< Accessor index or ~0 if the attribute is not present.
+		uint32_t rotation = ~uint32_t(0);
+		uint32_t scale = ~uint32_t(0);
+	};
+
+	struct Accessor {
+		uint64_t byteOffset = 0;
+		uint64_t count = 0;
+		uint32_t bufferView = ~uint32_t(0);  //< Index of the bufferView or ~0 if it is omitted.
+		uint32_t componentType = 0;
+		AccessorType type = AccessorType::Unknown;
+		bool normalized = false;
+		bool sparse = false;  //< Accessor contains sparse property.
+		uint8_t minSize = 0;  //< Number of components of min property. Zero if it is not present. Only the first three components are stored.
+		uint8_t maxSize = 0;  //< Number of components of max property. Zero if it is not present. Only the first three components are stored.
+		float min[3];
+		float max[3];
+	};
+
+	struct BufferView {
+		uint64_t byteOffset = 0;
+		uint64_t byteLength = 0;
+		uint32_t buffer = ~uint32_t(0);
+		uint32_t byteStride = 0;  //< Zero means tightly packed data.
+		uint32_t meshoptCompression = ~uint32_t(0);  //< Index into meshoptCompressionList or ~0 if the bufferView is not compressed.
+	};
+
+	struct MeshoptCompression {  //< EXT_meshopt_compression extension of bufferView.
+		uint64_t byteOffset = 0;
+		uint64_t byteLength = 0;
+		uint64_t count = 0;
+		uint32_t buffer = ~uint32_t(0);
+		uint32_t byteStride = 0;
+		MeshoptDecoder::Mode mode = MeshoptDecoder::Mode::Unknown;  //< Mode, or Unknown if it is missing or not recognized.
+		MeshoptDecoder::Filter filter = MeshoptDecoder::Filter::None;  //< Filter, or Unknown if it is not recognized.
+	};
+
+	nlohmann::json root;  //< Json document without nodes, accessors and bufferViews root arrays.
+	std::vector<Node> nodeList;
+	std::vector<uint32_t> nodeChildList;  //< Children of all nodes. See Node::firstChild.
+	std::vector<Instancing> instancingList;  //< Instancing of nodes. See Node::instancing.
+	std::vector<Accessor> accessorList;
+	std::vector<BufferView> bufferViewList;
+	std::vector<MeshoptCompression> meshoptCompressionList;  //< Compressed bufferViews. See BufferView::meshoptCompression.
+
+	void parseDom(const uint8_t* data, size_t size);  //< Parses json into DOM and converts nodes, accessors and bufferViews into typed lists.
+	void parseStreaming(const uint8_t* data, size_t size);  //< Parses json by SAX parser. Nodes, accessors and bufferViews go directly into typed lists, DOM is built only for the rest of the document.
+	void clear() noexcept;
+
+};
+
+
+}
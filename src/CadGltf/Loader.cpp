@@ -0,0 +1,4319 @@
+// SPDX-FileCopyrightText: 2019-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include <CadGltf/Loader.h>
+#include <CadGltf/MeshSimplifier.h>
+#include <CadGltf/VertexCacheOptimizer.h>
+#include <CadR/BcEncoder.h>
+#include <CadR/BoundingBox.h>
+#include <CadR/Exceptions.h>
+#include <CadR/ImageStorage.h>
+#include <CadR/Renderer.h>
+#include <CadR/StagingBuffer.h>
+#include <CadR/StagingData.h>
+#include <CadR/StateSet.h>
+#include <CadR/VulkanDevice.h>
+#include <CadR/VulkanInstance.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "../../3rdParty/stb/stb_image.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <tuple>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define CADGLTF_SSE2
+#endif
+
+using namespace std;
+using namespace CadGltf;
+
+using json = nlohmann::json;
+typedef CadR::LogicError GltfError;
+
+
+// material data structures
+// (they are stored in DataStorage and read by the shaders)
+
+struct UnlitMaterialData {
+	glm::vec4 colorAndAlpha;
+#if 1  // optional members
+	float alphaCutoff;  // offset 16
+#endif
+};
+constexpr unsigned unlitMaterialDataSize = 16;  // size without optional members
+struct PhongMaterialData {
+	glm::vec3 ambient;  // offset 0
+	uint32_t padding1;
+	glm::vec4 diffuseAndAlpha;  // offset 16
+	glm::vec3 specular;  // offset 32
+	float shininess;  // offset 44
+	glm::vec3 emission;  // offset 48
+	float alphaCutoff;  // offset 60
+#if 0  // optional members
+	glm::vec3 reflection;  // offset 64
+#endif
+};
+static_assert(sizeof(PhongMaterialData) == 64 && "Wrong size of PhongMaterialData structure.");
+constexpr unsigned phongMaterialDataSize = 64;  // size without optional members
+struct MetallicRoughnessMaterialData {
+	glm::vec4 baseColorFactor;
+	float alphaCutoff;
+	float metallicFactor;
+	float roughnessFactor;
+	uint32_t padding1;
+	glm::vec3 emissiveFactor;
+	uint32_t padding2;
+};
+static_assert(sizeof(MetallicRoughnessMaterialData) == 48 && "Wrong size of MetallicRoughnessMaterialData structure.");
+constexpr unsigned metallicRoughnessMaterialDataSize = 48;
+
+
+// decode URI
+// replacing percent-encoded octets (f.ex. %20)
+// by their corresponding character (f.ex. ' ')
+static string decodeURI(const string& s)
+{
+	// count number of '%'
+	size_t n = 0;
+	size_t i = 0;
+	string::value_type c = s[0];
+	while(c != 0) {
+		if(c == '%')
+			n += 2;
+		i++;
+		c = s[i];
+	}
+
+	// no decoding needed
+	if(n == 0)
+		return s;
+
+	// reserve memory
+	string r(s.length() - n, 0);
+
+	// decode string from s to r
+	i = 0;
+	size_t j = 0;
+	c = s[0];
+	while(c != 0) {
+		if(c == '%') {
+			c = s[++i];
+			if(c == 0)
+				throw GltfError("URI error. Wrong % encoding.");
+			string::value_type a = (c <= '9') ? c - '0' : (c <= 'Z') ? c - 'A' + 10 : c - 'a' + 10;
+			c = s[++i];
+			if(c == 0)
+				throw GltfError("URI error. Wrong % encoding.");
+			string::value_type b = (c <= '9') ? c - '0' : (c <= 'Z') ? c - 'A' + 10 : c - 'a' + 10;
+			if(uint8_t(a) > 15 || uint8_t(b) > 15)
+				throw GltfError("URI error. Wrong % encoding.");
+			r[j] = (a<<4) | b;
+		}
+		else
+			r[j] = c;
+		i++;
+		j++;
+		c = s[i];
+	}
+	return r;
+}
+
+
+// compute 64-bit hash of the data
+// (it is used for content based deduplication, e.g. the same images
+// embedded many times in the glTF file; 8 bytes are processed per step
+// and MurmurHash3 finalizer is used for the final avalanche)
+static uint64_t hashData(const void* data, size_t size, uint64_t seed = 0)
+{
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+	uint64_t h = seed ^ (size * 0x9e3779b97f4a7c15ull);
+	size_t n = size / 8;
+	for(size_t i=0; i<n; i++) {
+		uint64_t k;
+		memcpy(&k, p + i*8, 8);
+		k *= 0x87c37b91114253d5ull;
+		k = (k << 31) | (k >> 33);
+		k *= 0x4cf5ad432745937full;
+		h ^= k;
+		h = ((h << 27) | (h >> 37)) * 5 + 0x52dce729;
+	}
+	uint64_t k = 0;
+	memcpy(&k, p + n*8, size & 7);
+	h ^= k * 0x87c37b91114253d5ull;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+
+// vertex attribute readers
+// (they are used by primitive processing that runs on worker threads,
+// so they must not touch any shared state)
+
+static glm::vec4 getColorFromVec4f(uint8_t* srcPtr)
+{
+	glm::vec4 r = *reinterpret_cast<glm::vec4*>(srcPtr);
+	return glm::clamp(r, 0.f, 1.f);
+}
+
+static glm::vec4 getColorFromVec3f(uint8_t* srcPtr)
+{
+	return
+		glm::vec4(
+			glm::clamp(*reinterpret_cast<glm::vec3*>(srcPtr), 0.f, 1.f),
+			1.f
+		);
+}
+
+static glm::vec4 getColorFromVec4us(uint8_t* srcPtr)
+{
+	return
+		glm::vec4(
+			float(reinterpret_cast<uint16_t*>(srcPtr)[0]) / 65535.f,
+			float(reinterpret_cast<uint16_t*>(srcPtr)[1]) / 65535.f,
+			float(reinterpret_cast<uint16_t*>(srcPtr)[2]) / 65535.f,
+			float(reinterpret_cast<uint16_t*>(srcPtr)[3]) / 65535.f
+		);
+}
+
+static glm::vec4 getColorFromVec3us(uint8_t* srcPtr)
+{
+	return
+		glm::vec4(
+			float(reinterpret_cast<uint16_t*>(srcPtr)[0]) / 65535.f,
+			float(reinterpret_cast<uint16_t*>(srcPtr)[1]) / 65535.f,
+			float(reinterpret_cast<uint16_t*>(srcPtr)[2]) / 65535.f,
+			1.f
+		);
+}
+
+static glm::vec4 getColorFromVec4ub(uint8_t* srcPtr)
+{
+	return
+		glm::vec4(
+			float(reinterpret_cast<uint8_t*>(srcPtr)[0]) / 255.f,
+			float(reinterpret_cast<uint8_t*>(srcPtr)[1]) / 255.f,
+			float(reinterpret_cast<uint8_t*>(srcPtr)[2]) / 255.f,
+			float(reinterpret_cast<uint8_t*>(srcPtr)[3]) / 255.f
+		);
+}
+
+static glm::vec4 getColorFromVec3ub(uint8_t* srcPtr)
+{
+	return
+		glm::vec4(
+			float(reinterpret_cast<uint8_t*>(srcPtr)[0]) / 255.f,
+			float(reinterpret_cast<uint8_t*>(srcPtr)[1]) / 255.f,
+			float(reinterpret_cast<uint8_t*>(srcPtr)[2]) / 255.f,
+			1.f
+		);
+}
+
+static unsigned componentSize(unsigned componentType)
+{
+	switch(componentType) {
+	case 5120:  // BYTE
+	case 5121: return 1;  // UNSIGNED_BYTE
+	case 5122:  // SHORT
+	case 5123: return 2;  // UNSIGNED_SHORT
+	default: return 4;  // FLOAT
+	}
+}
+
+static float readComponent(uint8_t* srcPtr, unsigned componentType, bool normalized)
+{
+	switch(componentType) {
+	case 5120: {
+		float v = *reinterpret_cast<int8_t*>(srcPtr);
+		return normalized ? max(v / 127.f, -1.f) : v;
+	}
+	case 5121: {
+		float v = *reinterpret_cast<uint8_t*>(srcPtr);
+		return normalized ? v / 255.f : v;
+	}
+	case 5122: {
+		float v = *reinterpret_cast<int16_t*>(srcPtr);
+		return normalized ? max(v / 32767.f, -1.f) : v;
+	}
+	case 5123: {
+		float v = *reinterpret_cast<uint16_t*>(srcPtr);
+		return normalized ? v / 65535.f : v;
+	}
+	default:
+		return *reinterpret_cast<float*>(srcPtr);
+	}
+}
+
+static glm::vec3 readVec3(uint8_t* srcPtr, unsigned componentType, bool normalized)
+{
+	unsigned s = componentSize(componentType);
+	return
+		glm::vec3(
+			readComponent(srcPtr, componentType, normalized),
+			readComponent(srcPtr + s, componentType, normalized),
+			readComponent(srcPtr + 2*s, componentType, normalized)
+		);
+}
+
+// data of EXT_mesh_gpu_instancing attribute
+// (data is nullptr if the attribute is not present)
+struct InstancingAttribute {
+	uint8_t* data = nullptr;
+	unsigned stride = 0;
+	unsigned componentType = 5126;
+	bool normalized = false;
+};
+
+static inline void readInstancingAttribute(const InstancingAttribute& a, size_t index, float* dst, unsigned numComponents)
+{
+	uint8_t* srcPtr = a.data + index * a.stride;
+	if(a.componentType == 5126)
+		memcpy(dst, srcPtr, numComponents * sizeof(float));
+	else {
+		unsigned s = componentSize(a.componentType);
+		for(unsigned i=0; i<numComponents; i++)
+			dst[i] = readComponent(srcPtr + i*s, a.componentType, a.normalized);
+	}
+}
+
+// composes matrices of EXT_mesh_gpu_instancing node
+// (dst[i] = nodeMatrix * T[i] * R[i] * S[i] * D, where D is position dequantization;
+// local TRS matrix is composed by scalar code in 3x4 form,
+// while the product with the node matrix is computed by SSE2 when available)
+static void composeInstancingMatrices(glm::mat4* dst, size_t firstInstance, size_t numInstances,
+	const glm::mat4& nodeMatrix, const glm::vec4& dequantization, const InstancingAttribute& translation,
+	const InstancingAttribute& rotation, const InstancingAttribute& scale)
+{
+#ifdef CADGLTF_SSE2
+	__m128 n0 = _mm_loadu_ps(&nodeMatrix[0][0]);
+	__m128 n1 = _mm_loadu_ps(&nodeMatrix[1][0]);
+	__m128 n2 = _mm_loadu_ps(&nodeMatrix[2][0]);
+	__m128 n3 = _mm_loadu_ps(&nodeMatrix[3][0]);
+#endif
+
+	for(size_t i=firstInstance, e=firstInstance+numInstances; i<e; i++) {
+
+		// read TRS
+		// (absent attributes use identity values)
+		float t[3] = { 0.f, 0.f, 0.f };
+		float q[4] = { 0.f, 0.f, 0.f, 1.f };
+		float s[3] = { 1.f, 1.f, 1.f };
+		if(translation.data)
+			readInstancingAttribute(translation, i, t, 3);
+		if(rotation.data)
+			readInstancingAttribute(rotation, i, q, 4);
+		if(scale.data)
+			readInstancingAttribute(scale, i, s, 3);
+
+		// local matrix
+		glm::mat3 l = glm::mat3_cast(glm::quat(q[3], q[0], q[1], q[2]));
+		l[0] *= s[0];
+		l[1] *= s[1];
+		l[2] *= s[2];
+		glm::vec3 lt(t[0], t[1], t[2]);
+		if(dequantization.w != 0.f) {
+			lt += l * glm::vec3(dequantization);
+			l *= dequantization.w;
+		}
+
+		// product with the node matrix
+#ifdef CADGLTF_SSE2
+		float* m = &dst[i][0][0];
+		for(unsigned j=0; j<3; j++)
+			_mm_storeu_ps(m + j*4,
+				_mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(n0, _mm_set1_ps(l[j][0])), _mm_mul_ps(n1, _mm_set1_ps(l[j][1]))),
+					_mm_mul_ps(n2, _mm_set1_ps(l[j][2]))));
+		_mm_storeu_ps(m + 12,
+			_mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(n0, _mm_set1_ps(lt.x)), _mm_mul_ps(n1, _mm_set1_ps(lt.y))),
+				_mm_add_ps(_mm_mul_ps(n2, _mm_set1_ps(lt.z)), n3)));
+#else
+		dst[i] = nodeMatrix * glm::mat4(glm::vec4(l[0], 0.f), glm::vec4(l[1], 0.f), glm::vec4(l[2], 0.f), glm::vec4(lt, 1.f));
+#endif
+	}
+}
+
+static uint32_t encodeOctahedral(glm::vec3 v)
+{
+	// project the vector on octahedron and fold its lower half over the upper half
+	// (the result is decoded by type 0x44 of readVec3() in UberShaderReadFuncs.glsl)
+	float l1 = abs(v.x) + abs(v.y) + abs(v.z);
+	if(l1 == 0.f)
+		return 0;
+	glm::vec2 e = glm::vec2(v) / l1;
+	if(v.z < 0.f)
+		e = (1.f - glm::abs(glm::vec2(e.y, e.x))) *
+		    glm::vec2(e.x >= 0.f ? 1.f : -1.f, e.y >= 0.f ? 1.f : -1.f);
+	return glm::packSnorm2x16(e);
+}
+
+static glm::vec3 bakeDirection(const glm::mat3& m, glm::vec3 v)
+{
+	// transform and renormalize the vector
+	// (zero vectors are kept as they are)
+	v = m * v;
+	float l = glm::length(v);
+	return (l > 0.f) ? v / l : v;
+}
+
+
+Loader::Loader(CadR::Renderer& renderer, CadR::VulkanInstance& instance, vk::PhysicalDevice physicalDevice,
+               CadPL::PipelineSceneGraph& pipelineSceneGraph, CadR::StateSet& textureStateSet,
+               const LoaderSettings& settings)
+	: _renderer(&renderer)
+	, _vulkanInstance(&instance)
+	, _physicalDevice(physicalDevice)
+	, _pipelineSceneGraph(&pipelineSceneGraph)
+	, _textureStateSet(&textureStateSet)
+	, _settings(settings)
+	, _defaultMaterial(renderer.dataStorage(), CadR::DataAllocation::noHandle)
+	, _textureAtlasDataAllocation(renderer.dataStorage())
+{
+}
+
+
+Loader::~Loader() noexcept
+{
+	stopWorkerThreads();
+
+	// release objects in the reverse order of their dependencies
+	// (Drawables reference Geometries, MatrixLists and materials; Textures reference images)
+	_drawableList.clear();
+	_geometryList.clear();
+	_textureList.clear();
+	_imageList.clear();
+	_samplerList.clear();
+	_materialList.clear();
+	_matrixLists.clear();
+	_mergedMatrixLists.clear();
+	_defaultSampler = nullptr;
+	_defaultAtlasSampler = nullptr;
+	_defaultMaterial.free();
+	_textureAtlasDataAllocation.free();
+}
+
+
+void Loader::reportProgress(LoaderStage stage, size_t numDone, size_t numTotal)
+{
+	if(_progressCallback)
+		_progressCallback(stage, numDone, numTotal);
+}
+
+
+void Loader::log(const string& message)
+{
+	if(_logCallback)
+		_logCallback(message);
+}
+
+
+void Loader::parse(const filesystem::path& filePath)
+{
+	// map file
+	_filePath = filePath;
+	_gltfFile.open(filePath);
+	_gltfFile.adviseSequential();
+	const uint8_t* fileData = _gltfFile.data();
+	size_t fileSize = _gltfFile.size();
+
+	// parse json
+	// (.glb file is recognized by its magic;
+	// it contains json chunk optionally followed by BIN chunk)
+	auto parseJson =
+		[this](const uint8_t* data, size_t size) {
+			if(_settings.streamingJsonParse)
+				_gltfJson.parseStreaming(data, size);
+			else
+				_gltfJson.parseDom(data, size);
+		};
+	auto readUint32 = [](const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; };
+	if(fileSize >= 12 && readUint32(fileData) == 0x46546C67) {  // "glTF" magic
+		if(readUint32(fileData+4) != 2)
+			throw GltfError("Unsupported .glb container version " + to_string(readUint32(fileData+4)) + ".");
+		size_t length = readUint32(fileData+8);
+		if(length > fileSize)
+			throw GltfError("Truncated .glb file " + filePath.string() + ".");
+		size_t offset = 12;
+		const uint8_t* jsonData = nullptr;
+		size_t jsonSize = 0;
+		while(offset + 8 <= length) {
+			size_t chunkLength = readUint32(fileData+offset);
+			uint32_t chunkType = readUint32(fileData+offset+4);
+			offset += 8;
+			if(chunkLength > length - offset)
+				throw GltfError("Invalid chunk length in .glb file " + filePath.string() + ".");
+			if(chunkType == 0x4E4F534A) {  // JSON chunk
+				if(jsonData == nullptr) {
+					jsonData = fileData + offset;
+					jsonSize = chunkLength;
+				}
+			}
+			else if(chunkType == 0x004E4942) {  // BIN chunk
+				if(_glbBinChunkData == nullptr) {
+					_glbBinChunkData = fileData + offset;
+					_glbBinChunkSize = chunkLength;
+				}
+			}
+			offset += chunkLength;
+		}
+		if(jsonData == nullptr)
+			throw GltfError("No JSON chunk in .glb file " + filePath.string() + ".");
+		parseJson(jsonData, jsonSize);
+	}
+	else
+		parseJson(fileData, fileSize);
+
+	// read root objects
+	// (asset item is mandatory, the rest is optional)
+	auto getRootItem =
+		[](json& glTF, json& newGltfItems, const string& key) -> json::array_t&
+		{
+			auto it = glTF.find(key);
+			if(it != glTF.end())
+				return it->get_ref<json::array_t&>();
+			auto& ref = newGltfItems[key];
+			if(ref.is_null())
+				ref = json::array();
+			return ref.get_ref<json::array_t&>();
+		};
+	json& glTF = _gltfJson.root;
+	json& asset = glTF.at("asset");
+	json::array_t& extensionsRequired = getRootItem(glTF, _newGltfItems, "extensionsRequired");
+	_extensionsUsed = &getRootItem(glTF, _newGltfItems, "extensionsUsed");
+	_scenes = &getRootItem(glTF, _newGltfItems, "scenes");
+	_meshes = &getRootItem(glTF, _newGltfItems, "meshes");
+	_buffers = &getRootItem(glTF, _newGltfItems, "buffers");
+	_materials = &getRootItem(glTF, _newGltfItems, "materials");
+	_textures = &getRootItem(glTF, _newGltfItems, "textures");
+	_images = &getRootItem(glTF, _newGltfItems, "images");
+	_samplers = &getRootItem(glTF, _newGltfItems, "samplers");
+	json::array_t& extensionsUsed = *_extensionsUsed;
+	json::array_t& scenes = *_scenes;
+	json::array_t& meshes = *_meshes;
+	const vector<GltfJson::Node>& nodeList = _gltfJson.nodeList;
+	const vector<uint32_t>& nodeChildList = _gltfJson.nodeChildList;
+	const vector<GltfJson::Accessor>& accessorList = _gltfJson.accessorList;
+	json::array_t& materials = *_materials;
+	json::array_t& textures = *_textures;
+	json::array_t& images = *_images;
+
+	// print glTF info
+	// (version item is mandatory, the rest is optional)
+	auto getStringWithDefault =
+		[](json& node, const string& key, const string& defaultVal)
+		{
+			auto it = node.find(key);
+			return (it != node.end())
+				? it->get_ref<json::string_t&>()
+				: defaultVal;
+		};
+	ostringstream info;
+	info << "glTF info:\n";
+	info << "   Generator:   " << getStringWithDefault(asset, "generator", "< none >") << '\n';
+	info << "   Copyright:   " << getStringWithDefault(asset, "copyright", "< none >") << '\n';
+	info << "   Version:     " << asset.at("version").get_ref<json::string_t&>() << '\n';
+	info << "   MinVersion:  " << getStringWithDefault(asset, "minVersion", "< none >") << '\n';
+	info << "   Required extensions:  ";
+	if(extensionsRequired.empty())
+		info << "< none >\n";
+	else {
+		info << extensionsRequired.front().get_ref<json::string_t&>();
+		for(auto it=extensionsRequired.begin()+1,e=extensionsRequired.end(); it!=e; it++)
+			info << ", " << it->get_ref<json::string_t&>();
+		info << '\n';
+	}
+	info << "   Optional extensions:  ";
+	{
+		auto isInList =
+			[&](const string& s){
+				for(auto it=extensionsRequired.begin(),e=extensionsRequired.end(); it!=e; it++)
+					if(s == it->get_ref<json::string_t&>())
+						return true;
+				return false;
+			};
+		auto it = extensionsUsed.begin();
+		auto e = extensionsUsed.end();
+		if(it == e)
+			info << "< none >";
+		else
+			do {
+				string* extension = &it->get_ref<json::string_t&>();
+				it++;
+				if(!isInList(*extension)) {
+					info << *extension;
+					while(it != e) {
+						extension = &it->get_ref<json::string_t&>();
+						it++;
+						if(!isInList(*extension))
+							info << ", " << *extension;
+					}
+					break;
+				}
+				info << "< none >";
+			} while(it != e);
+		info << '\n';
+	}
+
+	// check model version and support of required extensions
+	{
+		auto parseVersion =
+			[](const string& s) -> tuple<int, int> {
+				const char* start = s.c_str();
+				const char* end = start + s.size();
+				char* pos;
+				long major = strtol(start, &pos, 10);
+				if(pos >= end || *pos != '.')
+					throw GltfError("Version string must be in the format <major>.<minor>.");
+				pos++;
+				if(pos >= end)
+					throw GltfError("Version string must be in the format <major>.<minor>.");
+				long minor = strtol(pos, &pos, 10);
+				if(pos != end)
+					throw GltfError("Version string must be in the format <major>.<minor>.");
+				return { int(major), int(minor) };
+			};
+		if(auto it=asset.find("minVersion"); it != asset.end()) {
+			// check minVersion
+			auto v = parseVersion(*it);
+			if(get<0>(v) > 2 || (get<0>(v) == 2 && get<1>(v) > 0))
+				throw GltfError(string("Unsupported glTF format. "
+					"Minimal version required is ") + it->get_ref<json::string_t&>() +
+					" while currently supported version is 2.0.");
+		}
+		else {
+			// check version
+			const string& s = asset.at("version").get_ref<json::string_t&>();
+			auto v = parseVersion(s);
+			if(get<0>(v) != 2)
+				throw GltfError(string("Unsupported glTF format ") + s +
+					" while currently supported version is 2.0.");
+		}
+
+		// check required extensions
+		if(!extensionsRequired.empty()) {
+			constexpr const array supportedExtensions{
+				"KHR_materials_unlit",
+				"KHR_texture_transform",
+				"KHR_materials_emissive_strength",
+				"KHR_mesh_quantization",
+				"EXT_meshopt_compression",
+				"EXT_mesh_gpu_instancing",
+			};
+			vector<string*> unsupportedExtensions;
+			for(auto it=extensionsRequired.begin(),e=extensionsRequired.end(); it!=e; it++)
+				if(find(supportedExtensions.begin(), supportedExtensions.end(), *it) == supportedExtensions.end())
+					unsupportedExtensions.push_back(it->get_ptr<json::string_t*>());
+			if(!unsupportedExtensions.empty()) {
+				string s;
+				if(unsupportedExtensions.size() == 1)
+					s = "Unsupported glTF extension: ";
+				else
+					s = "Unsupported glTF extensions: ";
+				s += *unsupportedExtensions[0];
+				for(size_t i=1,c=unsupportedExtensions.size(); i<c; i++)
+					s += ", " + *unsupportedExtensions[i];
+				throw GltfError(s);
+			}
+		}
+	}
+
+	_meshQuantizationUsed =
+		find(extensionsUsed.begin(), extensionsUsed.end(), "KHR_mesh_quantization") != extensionsUsed.end();
+
+	// print info and stats
+	info << "Stats:\n";
+	info << "   Scenes:    " << scenes.size() << '\n';
+	info << "   Nodes:     " << nodeList.size() << '\n';
+	info << "   Meshes:    " << meshes.size() << '\n';
+	info << "   Textures:  " << textures.size() << '\n';
+	log(info.str());
+
+	// process scene description
+	// (nodes were already read into nodeList by json parser
+	// that composed their matrices from translation, rotation and scale)
+
+	// get default scene
+	size_t numScenes = scenes.size();
+	if(numScenes == 0) {
+		log("There is no scene in the file.");
+		return;
+	}
+	size_t defaultSceneIndex = glTF.value<json::number_unsigned_t>("scene", ~size_t(0));
+	if(defaultSceneIndex == ~size_t(0)) {
+		log("There is no default scene in the file. Using the first scene.");
+		defaultSceneIndex = 0;
+	}
+	json& scene = scenes.at(defaultSceneIndex);
+	_sceneAvailable = true;
+
+	// iterate through root nodes
+	// and fill meshMatrixList and meshInstancedNodeList
+	vector<vector<glm::mat4>>& meshMatrixList = _meshMatrixList;
+	vector<vector<InstancedNode>>& meshInstancedNodeList = _meshInstancedNodeList;
+	vector<size_t>& meshNumInstancesList = _meshNumInstancesList;
+	meshMatrixList.assign(meshes.size(), {});
+	meshInstancedNodeList.assign(meshes.size(), {});
+	meshNumInstancesList.assign(meshes.size(), 0);
+	const vector<GltfJson::Instancing>& instancingList = _gltfJson.instancingList;
+
+	// append instances of the node to its mesh
+	// (EXT_mesh_gpu_instancing nodes are recorded with their instance count,
+	// their matrices are composed when the mesh is built as the buffers are not read yet)
+	auto appendMeshInstances =
+		[&meshMatrixList, &meshInstancedNodeList, &meshNumInstancesList, &instancingList, &accessorList]
+		(const GltfJson::Node& node, const glm::mat4& m) -> void
+		{
+			if(node.meshIndex == ~uint32_t(0))
+				return;
+			if(node.meshIndex >= meshMatrixList.size())
+				throw GltfError("Node.mesh index out of range.");
+
+			// single instance
+			if(node.instancing == ~uint32_t(0)) {
+				meshMatrixList[node.meshIndex].emplace_back(m);
+				meshNumInstancesList[node.meshIndex]++;
+				return;
+			}
+
+			// EXT_mesh_gpu_instancing
+			// (all attribute accessors must have the same count)
+			const GltfJson::Instancing& instancing = instancingList[node.instancing];
+			uint64_t numInstances = ~uint64_t(0);
+			for(uint32_t accessorIndex : { instancing.translation, instancing.rotation, instancing.scale }) {
+				if(accessorIndex == ~uint32_t(0))
+					continue;
+				uint64_t count = accessorList.at(accessorIndex).count;
+				if(numInstances != ~uint64_t(0) && numInstances != count)
+					throw GltfError("EXT_mesh_gpu_instancing attributes do not have the same count.");
+				numInstances = count;
+			}
+			if(numInstances == ~uint64_t(0))
+				throw GltfError("EXT_mesh_gpu_instancing contains no attributes.");
+			meshInstancedNodeList[node.meshIndex].push_back({ m, node.instancing, size_t(numInstances) });
+			meshNumInstancesList[node.meshIndex] += size_t(numInstances);
+		};
+
+	if(auto rootNodesIt=scene.find("nodes"); rootNodesIt!=scene.end()) {
+		json& rootNodes = *rootNodesIt;
+		for(auto it=rootNodes.begin(); it!= rootNodes.end(); it++) {
+
+			// process node function
+			auto processNode =
+				[](size_t nodeIndex, const glm::mat4& parentMatrix, const vector<GltfJson::Node>& nodeList,
+				   const vector<uint32_t>& nodeChildList, const auto& appendMeshInstances,
+				   const auto& processNode) -> void
+				{
+					// get node
+					const GltfJson::Node& node = nodeList.at(nodeIndex);
+
+					// compute local matrix
+					glm::mat4 m = parentMatrix * node.matrix;
+
+					// assign instancing matrices to the mesh
+					appendMeshInstances(node, m);
+
+					// process children
+					for(size_t i=node.firstChild,e=node.firstChild+node.numChildren; i<e; i++)
+						processNode(nodeChildList[i], m, nodeList, nodeChildList, appendMeshInstances, processNode);
+				};
+
+			// get node
+			size_t rootNodeIndex = size_t(it->get_ref<json::number_unsigned_t&>());
+			const GltfJson::Node& node = nodeList.at(rootNodeIndex);
+
+			// compute root matrix
+			// (we need to flip y and z axes to get from glTF coordinate system to Vulkan coordinate system)
+			glm::mat4 m = node.matrix;
+			for(unsigned i=0; i<4; i++) {
+				m[i][1] = -m[i][1];
+				m[i][2] = -m[i][2];
+			}
+
+			// append instancing matrices to the mesh
+			appendMeshInstances(node, m);
+
+			// process children
+			for(size_t i=node.firstChild,e=node.firstChild+node.numChildren; i<e; i++)
+				processNode(nodeChildList[i], m, nodeList, nodeChildList, appendMeshInstances, processNode);
+
+		}
+	}
+
+	// position quantization
+	// (when vertex compression is enabled, float positions of each mesh are stored
+	// as normalized ushort3 relative to the mesh bounding box; the dequantization,
+	// e.g. uniform scale by the largest box extent and translation to the box corner,
+	// is folded into mesh matrices; the scale is uniform to not distort normals;
+	// meshes containing positions quantized by KHR_mesh_quantization are not quantized again
+	// as their dequantization is already part of node transformations)
+	vector<glm::vec4>& meshDequantizationList = _meshDequantizationList;
+	meshDequantizationList.assign(meshes.size(), glm::vec4(0.f));
+	if(_settings.useVertexCompression)
+		for(size_t meshIndex=0, c=meshes.size(); meshIndex<c; meshIndex++) {
+			optional<CadR::BoundingBox> meshBB =
+				[](json& mesh, const vector<GltfJson::Accessor>& accessorList) -> optional<CadR::BoundingBox>
+				{
+					auto primitivesIt = mesh.find("primitives");
+					if(primitivesIt == mesh.end())
+						return nullopt;
+					CadR::BoundingBox bb = CadR::BoundingBox::empty();
+					for(auto& primitive : *primitivesIt) {
+						auto attributesIt = primitive.find("attributes");
+						if(attributesIt == primitive.end())
+							return nullopt;
+						auto positionIt = attributesIt->find("POSITION");
+						if(positionIt == attributesIt->end())
+							continue;
+						const GltfJson::Accessor& accessor = accessorList.at(positionIt->get_ref<json::number_unsigned_t&>());
+						if(accessor.componentType != 5126)
+							return nullopt;
+						if(accessor.minSize != 3 || accessor.maxSize != 3)
+							return nullopt;  // errors are reported during mesh processing
+						bb.extendBy(CadR::BoundingBox{
+							.min = glm::vec3(accessor.min[0], accessor.min[1], accessor.min[2]),
+							.max = glm::vec3(accessor.max[0], accessor.max[1], accessor.max[2]),
+						});
+					}
+					if(bb.isEmpty())
+						return nullopt;
+					return bb;
+				}(meshes[meshIndex], accessorList);
+			if(meshBB) {
+				glm::vec3 extent = meshBB->max - meshBB->min;
+				float scale = max(max(extent.x, extent.y), extent.z);
+				meshDequantizationList[meshIndex] = glm::vec4(meshBB->min, (scale > 0.f) ? scale : 1.f);
+			}
+		}
+
+	// construct texture-glTF-index to image-glTF-index map
+	uint32_t numGltfTextures = uint32_t(textures.size());
+	uint32_t numGltfImages = uint32_t(images.size());
+	vector<size_t> gltfTextureToGltfImageMap(numGltfTextures, ~size_t(0));
+	for(uint32_t i=0; i<numGltfTextures; i++) {
+		auto& texture = textures[i];
+		auto sourceIt = texture.find("source");
+		if(sourceIt == texture.end())
+			throw GltfError("Unsupported functionality: Texture.source is not defined for the texture.");
+		size_t imageIndex = sourceIt->get_ref<json::number_unsigned_t&>();
+		if(imageIndex >= numGltfImages)
+			throw GltfError("Texture.source contains invalid value.");
+		gltfTextureToGltfImageMap[i] = imageIndex;
+	}
+
+	// default material
+	// (material data are created in buildMaterialsAndTextures())
+	_defaultStateSetMaterialData = {
+		.unlit = false,
+		.doubleSided = false,
+		.transparencyEnabled = false,
+		.alphaTest = false,
+		.materialTexturingParamsOffset = 0,
+		.shaderTextureSetup = { 0 },  // no textures
+	};
+
+
+	// process materials
+	//
+	// (During the process, we mark textures whether we use them with sRGB opto-electronic
+	// transfer function, or if we use them with linear transfer function.
+	// We also construct mapping between texture and image indices inside glTF file
+	// and the indices into textureList and imageList used by the application.)
+	size_t numMaterials = materials.size();
+	_materialDataList.clear();
+	_materialDataList.reserve(numMaterials);
+	_materialTextureRecordList.clear();
+	vector<StateSetMaterialData>& stateSetMaterialDataList = _stateSetMaterialDataList;
+	stateSetMaterialDataList.assign(numMaterials, {});
+	vector<LinearAndSrgbIndices>& gltfImageToAppImageMap = _gltfImageToAppImageMap;
+	gltfImageToAppImageMap.assign(numGltfImages, { ~unsigned(0), ~unsigned(0) });
+	vector<LinearAndSrgbIndices> gltfTextureToAppTextureMap(numGltfTextures, { ~unsigned(0), ~unsigned(0) });
+	vector<bool>& gltfImageIsNormalMap = _gltfImageIsNormalMap;
+	gltfImageIsNormalMap.assign(numGltfImages, false);
+	unsigned& numAppImages = _numAppImages;
+	unsigned& numAppTextures = _numAppTextures;
+	numAppImages = 0;
+	numAppTextures = 0;
+	vector<AppTextureInfo>& appTextureInfoList = _appTextureInfoList;
+	appTextureInfoList.clear();
+	appTextureInfoList.reserve(numGltfTextures);  // this will just fit the size if each texture is either linear or sRGB but not both
+	for(size_t materialIndex=0; materialIndex<numMaterials; materialIndex++) {
+
+		auto& material = materials.at(materialIndex);
+
+		struct TextureData {
+			unsigned textureID;
+			unsigned coordIndex;
+			float strength;
+			bool transformEnabled;
+			glm::vec2 offset;
+			float rotation;
+			glm::vec2 scale;
+		};
+
+		// values to be read from glTF
+		bool unlit;
+		bool doubleSided;
+		glm::vec4 baseColorFactor;
+		TextureData baseColorTexture;
+		TextureData metallicRoughnessOcclusionTexture;
+		TextureData metallicRoughnessTexture;
+		TextureData occlusionTexture;
+		TextureData normalTexture;
+		TextureData emissiveTexture;
+
+		float metallicFactor;
+		float roughnessFactor;
+		glm::vec3 emissiveFactor;
+		float emissiveStrength = 1.f;
+		bool transparencyEnabled;
+		bool alphaTest;
+		float alphaCutoff;
+
+		auto readTextureData =
+			[](TextureData& t, const char* jsonPropertyName, json& jsonParent, const unsigned numTextures,
+			   const char* strengthPropertyName = nullptr)
+			{
+				if(auto textureIt = jsonParent.find(jsonPropertyName); textureIt != jsonParent.end()) {
+
+					t.textureID = unsigned(textureIt->at("index").get_ref<json::number_unsigned_t&>());
+					if(t.textureID >= numTextures)
+						throw GltfError("baseColorTexture.index is out of range. It is not index to a valid texture.");
+					t.coordIndex = textureIt->value("texCoord", 0);
+					if(strengthPropertyName)
+						if(auto it = textureIt->find(strengthPropertyName); it != textureIt->end())
+							t.strength = float(it->get<json::number_float_t>());
+						else
+							t.strength = 1.f;
+					else
+						t.strength = 1.f;
+					if(auto extIt = textureIt->find("extensions"); extIt != textureIt->end()) {
+
+						// KHR_texture_transform
+						auto transformIt = extIt->find("KHR_texture_transform");
+						if(transformIt != extIt->end())
+						{
+							t.transformEnabled = true;
+
+							// KHR_texture_transform.offset
+							if(auto offsetIt = transformIt->find("offset"); offsetIt != transformIt->end()) {
+								json::array_t& a = offsetIt->get_ref<json::array_t&>();
+								if(a.size() != 2)
+									throw GltfError("Material.baseColorTexture.extensions.offset is not vector of two components.");
+								t.offset[0] = float(a[0].get<json::number_float_t>());
+								t.offset[1] = float(a[1].get<json::number_float_t>());
+							}
+							else {
+								t.offset[0] = 0.f;
+								t.offset[1] = 0.f;
+							}
+
+							// KHR_texture_transform.rotation
+							t.rotation = float(transformIt->value<json::number_float_t>("rotation", 0.f));
+
+							// KHR_texture_transform.scale
+							if(auto scaleIt = transformIt->find("scale"); scaleIt != transformIt->end()) {
+								json::array_t& a = scaleIt->get_ref<json::array_t&>();
+								if(a.size() != 2)
+									throw GltfError("Material.baseColorTexture.extensions.scale is not vector of two components.");
+								t.scale[0] = float(a[0].get<json::number_float_t>());
+								t.scale[1] = float(a[1].get<json::number_float_t>());
+							}
+							else {
+								t.scale[0] = 1.f;
+								t.scale[1] = 1.f;
+							}
+
+							// KHR_texture_transform.texCoord
+							if(auto texCoordIt = transformIt->find("texCoord"); texCoordIt != transformIt->end())
+								t.coordIndex = unsigned(texCoordIt->get_ref<json::number_unsigned_t&>());
+						}
+						else
+							t.transformEnabled = false;
+					}
+					else
+						t.transformEnabled = false;
+				}
+				else {
+					t.textureID = ~unsigned(0);
+					t.coordIndex = ~unsigned(0);
+				}
+			};
+
+		// unlit material extension
+		if(auto extIt = material.find("extensions"); extIt == material.end()) {
+			unlit = false;
+		}
+		else {
+			auto it = extIt->find("KHR_materials_unlit");
+			unlit = (it != extIt->end());
+			it = extIt->find("KHR_materials_emissive_strength");
+			if(it != extIt->end())
+				emissiveStrength = float(it->value<json::number_float_t>("emissiveStrength", 1.0));
+		}
+
+		// material.doubleSided is optional with the default value of false
+		doubleSided = material.value<json::boolean_t>("doubleSided", false);
+
+		// read pbr material properties
+		if(auto pbrIt = material.find("pbrMetallicRoughness"); pbrIt != material.end()) {
+
+			// read baseColorFactor
+			if(auto baseColorFactorIt = pbrIt->find("baseColorFactor"); baseColorFactorIt != pbrIt->end()) {
+				json::array_t& a = baseColorFactorIt->get_ref<json::array_t&>();
+				if(a.size() != 4)
+					throw GltfError("Material.pbrMetallicRoughness.baseColorFactor is not vector of four components.");
+				baseColorFactor[0] = float(a[0].get<json::number_float_t>());
+				baseColorFactor[1] = float(a[1].get<json::number_float_t>());
+				baseColorFactor[2] = float(a[2].get<json::number_float_t>());
+				baseColorFactor[3] = float(a[3].get<json::number_float_t>());
+			}
+			else
+				baseColorFactor = glm::vec4(1.f, 1.f, 1.f, 1.f);
+
+			// read properties
+			metallicFactor = float(pbrIt->value<json::number_float_t>("metallicFactor", 1.0));
+			roughnessFactor = float(pbrIt->value<json::number_float_t>("roughnessFactor", 1.0));
+
+			// base color texture
+			readTextureData(baseColorTexture, "baseColorTexture", *pbrIt, numGltfTextures);
+
+			// metallic-roughness texture
+			if(_settings.materialModel == MaterialModel::BlinPhong) {
+
+				// for Phong model, ignore metallic-roughness texture because it is not supported in the shader
+				metallicRoughnessTexture.textureID = ~unsigned(0);
+				metallicRoughnessTexture.coordIndex = ~unsigned(0);
+
+				// expect average value of metallic-roughness texture to be 0.5 =>
+				// multiply metallicFactor and roughnessFactor by 0.5
+				metallicFactor *= 0.5f;
+				roughnessFactor *= 0.5f;
+
+			}
+			else
+				readTextureData(metallicRoughnessTexture, "metallicRoughnessTexture", *pbrIt, numGltfTextures);
+
+		}
+		else
+		{
+			// default values when pbrMetallicRoughness is not present
+			baseColorFactor = glm::vec4(1.f, 1.f, 1.f, 1.f);
+			baseColorTexture.textureID = ~unsigned(0);
+			baseColorTexture.coordIndex = ~unsigned(0);
+			metallicRoughnessTexture.textureID = ~unsigned(0);
+			metallicRoughnessTexture.coordIndex = ~unsigned(0);
+			metallicFactor = 1.f;
+			roughnessFactor = 1.f;
+		}
+
+		// read emissiveFactor
+		if(auto emissiveFactorIt = material.find("emissiveFactor"); emissiveFactorIt != material.end()) {
+			json::array_t& a = emissiveFactorIt->get_ref<json::array_t&>();
+			if(a.size() != 3)
+				throw GltfError("Material.emissiveFactor is not vector of three components.");
+			emissiveFactor[0] = float(a[0].get<json::number_float_t>());
+			emissiveFactor[1] = float(a[1].get<json::number_float_t>());
+			emissiveFactor[2] = float(a[2].get<json::number_float_t>());
+		}
+		else
+			emissiveFactor = glm::vec3(0.f, 0.f, 0.f);
+
+		// normal texture
+		readTextureData(normalTexture, "normalTexture", material, numGltfTextures, "scale");
+
+		// occlusion texture
+		readTextureData(occlusionTexture, "occlusionTexture", material, numGltfTextures, "strength");
+
+		// emissive texture
+		readTextureData(emissiveTexture, "emissiveTexture", material, numGltfTextures);
+
+		// alphaMode
+		if(auto it=material.find("alphaMode"); it != material.end()) {
+			string alphaMode = it->get_ref<json::string_t&>();
+			if(alphaMode == "OPAQUE") {
+				transparencyEnabled = false;
+				alphaTest = false;
+			}
+			else if(alphaMode == "BLEND") {
+				transparencyEnabled = true;
+				alphaTest = false;
+				if(!_settings.transparencySupported)
+					throw GltfError("BLEND alpha mode is not supported by the current rendering setup.");
+			}
+			else if(alphaMode == "MASK") {
+				transparencyEnabled = false;
+				alphaTest = true;
+			}
+			else
+				throw GltfError("Unknown alpha mode.");
+		}
+		else {
+			transparencyEnabled = false;
+			alphaTest = false;
+		}
+
+		// alphaCutoff
+		alphaCutoff = float(material.value<json::number_float_t>("alphaCutoff", 0.5));
+
+		// combine metallicRoughnessTexture and occlusionTexture
+		// into metallicRoughnessOcclusionTexture
+		if(metallicRoughnessTexture.textureID != ~unsigned(0) &&
+		   metallicRoughnessTexture.textureID == occlusionTexture.textureID &&
+		   metallicRoughnessTexture.coordIndex == occlusionTexture.coordIndex &&
+		   metallicRoughnessTexture.transformEnabled == occlusionTexture.transformEnabled &&
+		   (!metallicRoughnessTexture.transformEnabled ||
+		      (metallicRoughnessTexture.offset == occlusionTexture.offset &&
+		       metallicRoughnessTexture.rotation == occlusionTexture.rotation &&
+		       metallicRoughnessTexture.scale == occlusionTexture.scale)
+		   ))
+		{
+			metallicRoughnessOcclusionTexture.textureID = metallicRoughnessTexture.textureID;
+			metallicRoughnessOcclusionTexture.coordIndex = metallicRoughnessTexture.coordIndex;
+			metallicRoughnessOcclusionTexture.strength = occlusionTexture.strength;
+			metallicRoughnessOcclusionTexture.transformEnabled = metallicRoughnessTexture.transformEnabled;
+			metallicRoughnessOcclusionTexture.offset = metallicRoughnessTexture.offset;
+			metallicRoughnessOcclusionTexture.rotation = metallicRoughnessTexture.rotation;
+			metallicRoughnessOcclusionTexture.scale = metallicRoughnessTexture.scale;
+			metallicRoughnessTexture.textureID = ~unsigned(0);
+			metallicRoughnessTexture.coordIndex = ~unsigned(0);
+			occlusionTexture.textureID = ~unsigned(0);
+			occlusionTexture.coordIndex = ~unsigned(0);
+		}
+		else {
+			// do not use metallicRoughnessOcclusionTexture
+			metallicRoughnessOcclusionTexture.textureID = ~unsigned(0);
+			metallicRoughnessOcclusionTexture.coordIndex = ~unsigned(0);
+		}
+
+		// core material size
+		unsigned materialSize = unlit ? unlitMaterialDataSize :
+			(_settings.materialModel==MaterialModel::BlinPhong) ? phongMaterialDataSize : metallicRoughnessMaterialDataSize;
+		if(unlit && alphaTest)
+			materialSize += 4;
+		unsigned coreMaterialSize = materialSize;
+
+		// texturing params size that are stored inside material
+		//
+		// each texture occupies at least 4 bytes inside material;
+		// if strength is used, it needs additional 4 bytes,
+		// if texture coordinate transform is enabled, addition 6 floats are needed,
+		// if blend color is used, extra 3 float are stored;
+		// so texturing data size varies between 4 and 4+4+24+12=44 bytes per one texture
+		auto getMaterialTexturingParamsSize =
+			[](const TextureData& t) -> unsigned
+			{
+				// texture not used
+				if(t.textureID == ~unsigned(0))
+					return 0;
+
+				unsigned r = 4;
+				if(t.transformEnabled)
+					r += 6*4;
+				if(t.strength != 1.f)
+					r += 4;
+				return r;
+			};
+
+		// append texturing params to material size
+		materialSize += getMaterialTexturingParamsSize(baseColorTexture);
+		materialSize += getMaterialTexturingParamsSize(metallicRoughnessOcclusionTexture);
+		materialSize += getMaterialTexturingParamsSize(metallicRoughnessTexture);
+		materialSize += getMaterialTexturingParamsSize(occlusionTexture);
+		materialSize += getMaterialTexturingParamsSize(normalTexture);
+		materialSize += getMaterialTexturingParamsSize(emissiveTexture);
+
+		// material
+		vector<uint8_t>& materialData = _materialDataList.emplace_back(materialSize);
+		uint8_t* p = materialData.data();
+		if(unlit) {
+			UnlitMaterialData* m = reinterpret_cast<UnlitMaterialData*>(p);
+			m->colorAndAlpha = baseColorFactor;
+			if(alphaTest)
+				m->alphaCutoff = alphaCutoff;
+		}
+		else if(_settings.materialModel == MaterialModel::BlinPhong) {
+			PhongMaterialData* m = reinterpret_cast<PhongMaterialData*>(p);
+			m->ambient = glm::vec3(baseColorFactor);
+			m->padding1 = 0;
+			m->diffuseAndAlpha = glm::vec4(glm::vec3(baseColorFactor) * (1.f - metallicFactor), baseColorFactor.a);  // very vague and imprecise conversion
+			m->specular = baseColorFactor * metallicFactor;  // very vague and imprecise conversion
+			m->shininess = (1.f - (roughnessFactor * roughnessFactor)) * 128.f;  // very vague and imprecise conversion
+			m->emission = emissiveFactor * emissiveStrength;
+			m->alphaCutoff = alphaCutoff;
+		}
+		else {
+			MetallicRoughnessMaterialData* m = reinterpret_cast<MetallicRoughnessMaterialData*>(p);
+			m->baseColorFactor = baseColorFactor;
+			m->alphaCutoff = alphaCutoff;
+			m->metallicFactor = metallicFactor;
+			m->roughnessFactor = roughnessFactor;
+			m->padding1 = 0;
+			m->emissiveFactor =emissiveFactor * emissiveStrength;
+			m->padding2 = 0;
+		}
+		p += coreMaterialSize;
+
+		// StateSetMaterialData
+		auto& ssm = stateSetMaterialDataList[materialIndex];
+		ssm.unlit = unlit;
+		ssm.doubleSided = doubleSided;
+		ssm.transparencyEnabled = transparencyEnabled;
+		ssm.alphaTest = alphaTest;
+		ssm.materialTexturingParamsOffset =
+			(materialSize == coreMaterialSize)
+				? 0  // no texture info
+				: coreMaterialSize;  // texture info just material data
+
+		// write texture record into material
+		auto writeTexture =
+			[&materialData, materialIndex, this](const TextureData& t, uint8_t type, uint8_t*& p,
+			   decltype(StateSetMaterialData::shaderTextureSetup)& shaderTextureSetup,
+			   unsigned& textureIndex)
+			{
+				// write texture transform
+				uint16_t settings;
+				if(t.transformEnabled)
+				{
+					settings = 0x1;
+					float* f = reinterpret_cast<float*>(p);
+					if(t.rotation == 0) {
+						f[0] = t.scale.x;
+						f[1] = 0.f;
+						f[2] = 0.f;
+						f[3] = t.scale.y;
+					} else {
+						float c = cos(t.rotation);
+						float s = sin(t.rotation);
+						f[0] = c * t.scale.x;
+						f[1] = -s * t.scale.x;
+						f[2] = s * t.scale.y;
+						f[3] = c * t.scale.y;
+					}
+					f[4] = t.offset.x;
+					f[5] = t.offset.y;
+					p += 24;
+				}
+				else {
+					settings = 0;
+				}
+
+				// write textureID
+				// (t.textureID holds app texture index here; the final textureId
+				// is known after the textures are created, so it is written by buildMaterialsAndTextures())
+				_materialTextureRecordList.push_back({
+					.materialIndex = unsigned(materialIndex),
+					.textureIdOffset = unsigned(p - materialData.data()),
+					.appTextureIndex = t.textureID,
+					.textureSetupIndex = textureIndex,
+				});
+				*reinterpret_cast<uint32_t*>(p) = t.textureID;
+				p += 4;
+
+				// write strength
+				if(t.strength != 1.f)
+				{
+					settings |= 0x2;
+					*reinterpret_cast<float*>(p) = t.strength;
+					p += 4;
+				}
+
+				// write textureSetup
+				shaderTextureSetup[textureIndex] =
+					(4 + t.coordIndex) |  // texture coordinates are placed on attribute 4 and following
+					(type << 8) |  // texture type (base, normal, emission,...)
+					(settings << 16);
+				textureIndex++;
+
+			};
+
+		// replace texture index used by the glTF file
+		// by the index into textureList used by the application;
+		// allocate the space in textureList and imageList and
+		// create related mapping in appTextureIndices and appImageIndices
+		auto remapByTransferFunction =
+			[&](TextureData& t, bool srgb) -> void
+			{
+				size_t gltfImageIndex = gltfTextureToGltfImageMap[t.textureID];
+				LinearAndSrgbIndices& appTextureIndices = gltfTextureToAppTextureMap[t.textureID];
+				LinearAndSrgbIndices& appImageIndices = gltfImageToAppImageMap[gltfImageIndex];
+				if(srgb) {
+					if(appTextureIndices.srgb == ~unsigned(0)) {
+						appTextureIndices.srgb = numAppTextures;
+						appTextureInfoList.emplace_back(t.textureID, true);
+						numAppTextures++;
+					}
+					if(appImageIndices.srgb == ~unsigned(0)) {
+						appImageIndices.srgb = numAppImages;
+						numAppImages++;
+					}
+					t.textureID = appTextureIndices.srgb;
+				}
+				else {
+					if(appTextureIndices.linear == ~unsigned(0)) {
+						appTextureIndices.linear = numAppTextures;
+						appTextureInfoList.emplace_back(t.textureID, false);
+						numAppTextures++;
+					}
+					if(appImageIndices.linear == ~unsigned(0)) {
+						appImageIndices.linear = numAppImages;
+						numAppImages++;
+					}
+					t.textureID = appTextureIndices.linear;
+				}
+			};
+
+		// write textures
+		unsigned textureIndex = 0;
+		if(baseColorTexture.textureID != ~unsigned(0)) {
+			remapByTransferFunction(baseColorTexture, true);  // base texture uses sRGB transfer function
+			writeTexture(baseColorTexture, 1, p, ssm.shaderTextureSetup, textureIndex);
+		}
+		if(metallicRoughnessOcclusionTexture.textureID != ~unsigned(0)) {
+			remapByTransferFunction(metallicRoughnessOcclusionTexture, false);  // metallic-roughness-occlusion texture uses linear transfer function
+			writeTexture(metallicRoughnessOcclusionTexture, 2, p, ssm.shaderTextureSetup, textureIndex);
+		}
+		if(metallicRoughnessTexture.textureID != ~unsigned(0)) {
+			remapByTransferFunction(metallicRoughnessTexture, false);  // metallic-roughness texture uses linear transfer function
+			writeTexture(metallicRoughnessTexture, 3, p, ssm.shaderTextureSetup, textureIndex);
+		}
+		if(occlusionTexture.textureID != ~unsigned(0)) {
+			remapByTransferFunction(occlusionTexture, false);  // occlusion texture uses linear transfer function
+			writeTexture(occlusionTexture, 4, p, ssm.shaderTextureSetup, textureIndex);
+		}
+		if(normalTexture.textureID != ~unsigned(0)) {
+			gltfImageIsNormalMap[gltfTextureToGltfImageMap[normalTexture.textureID]] = true;
+			remapByTransferFunction(normalTexture, false);  // normal texture uses linear transfer function
+			writeTexture(normalTexture, 5, p, ssm.shaderTextureSetup, textureIndex);
+		}
+		if(emissiveTexture.textureID != ~unsigned(0)) {
+			remapByTransferFunction(emissiveTexture, true);  // emissive texture uses sRGB transfer function
+			writeTexture(emissiveTexture, 6, p, ssm.shaderTextureSetup, textureIndex);
+		}
+
+		// fill remaining textureSetup items with zero
+		for(; textureIndex<ssm.shaderTextureSetup.size(); textureIndex++)
+			ssm.shaderTextureSetup[textureIndex] = 0;
+
+	}
+	gltfTextureToGltfImageMap.clear();  // no needed any more
+	gltfTextureToAppTextureMap.clear();  // no needed any more
+	assert(_materialDataList.size() == numMaterials && "Not all materials were processed.");
+
+}
+
+
+void Loader::resolveBuffers()
+{
+	if(!_sceneAvailable)
+		return;
+
+	// map buffers
+	// (buffer content is not copied; accessors read directly from the mapped memory)
+	json::array_t& buffers = *_buffers;
+	_mappedFileList.clear();
+	_mappedFileList.reserve(buffers.size());
+	_bufferDataList.clear();
+	_bufferDataList.reserve(buffers.size());
+	for(size_t i=0,c=buffers.size(); i<c; i++) {
+
+		json& b = buffers[i];
+
+		// fallback buffer of EXT_meshopt_compression
+		// (it is referenced only by compressed bufferViews, so it has no data; uri might be missing)
+		if(auto extIt=b.find("extensions"); extIt!=b.end())
+			if(auto meshoptIt=extIt->find("EXT_meshopt_compression"); meshoptIt!=extIt->end())
+				if(meshoptIt->value("fallback", false)) {
+					_bufferDataList.push_back({ nullptr, 0 });
+					reportProgress(LoaderStage::ResolveBuffers, i+1, c);
+					continue;
+				}
+
+		// buffer without uri refers to BIN chunk of .glb file
+		auto uriIt = b.find("uri");
+		if(uriIt == b.end()) {
+			if(i != 0 || _glbBinChunkData == nullptr)
+				throw GltfError("Unsupported functionality: Undefined buffer.uri.");
+			_gltfFile.adviseSequential(_glbBinChunkData - _gltfFile.data(), _glbBinChunkSize);
+			_bufferDataList.push_back({ _glbBinChunkData, _glbBinChunkSize });
+			reportProgress(LoaderStage::ResolveBuffers, i+1, c);
+			continue;
+		}
+
+		// get path
+		const string& bufferURI = uriIt->get_ref<json::string_t&>();
+		string s = decodeURI(bufferURI);
+		filesystem::path p = u8string_view(reinterpret_cast<const char8_t*>(s.data()), s.size());
+		if(p.is_relative())
+			p = _filePath.parent_path() / p;
+
+		// map file
+		log("Opening buffer " + s + "...");
+		MappedFile& f = _mappedFileList.emplace_back(p);
+		f.adviseSequential();
+		_bufferDataList.push_back({ f.data(), f.size() });
+		reportProgress(LoaderStage::ResolveBuffers, i+1, c);
+	}
+
+	// EXT_meshopt_compression
+	decodeMeshoptBufferViews();
+}
+
+
+void Loader::decodeMeshoptBufferViews()
+{
+	// collect compressed bufferViews
+	// and assign them offsets in the block of decoded data
+	// (each bufferView is aligned to 16 bytes)
+	vector<GltfJson::BufferView>& bufferViewList = _gltfJson.bufferViewList;
+	vector<GltfJson::MeshoptCompression>& meshoptCompressionList = _gltfJson.meshoptCompressionList;
+	_meshoptDecodedData.reset();
+	if(meshoptCompressionList.empty())
+		return;
+	struct CompressedView { GltfJson::BufferView* bufferView; size_t dstOffset; };
+	vector<CompressedView> compressedViewList;
+	compressedViewList.reserve(meshoptCompressionList.size());
+	size_t decodedSize = 0;
+	for(GltfJson::BufferView& bufferView : bufferViewList) {
+		if(bufferView.meshoptCompression == ~uint32_t(0))
+			continue;
+		const GltfJson::MeshoptCompression& m = meshoptCompressionList[bufferView.meshoptCompression];
+
+		// decoded data must cover the whole bufferView
+		if(m.byteStride == 0 || m.count > (~size_t(0) - decodedSize) / m.byteStride)
+			throw GltfError("EXT_meshopt_compression: Invalid byteStride or count.");
+		size_t size = m.count * m.byteStride;
+		if(bufferView.byteLength > size)
+			throw GltfError("EXT_meshopt_compression: Decompressed data are smaller than BufferView.byteLength.");
+
+		compressedViewList.push_back({ &bufferView, decodedSize });
+		decodedSize += (size + 15) & ~size_t(15);
+	}
+	log("Decoding " + to_string(compressedViewList.size()) + " EXT_meshopt_compression bufferViews...");
+
+	// decode bufferViews in parallel
+	// (each bufferView is written into its own range of the block, so no synchronization is needed)
+	_meshoptDecodedData.reset(new uint8_t[decodedSize]);
+	startWorkerThreads();
+	parallelFor(compressedViewList.size(),
+		[this, &compressedViewList, &meshoptCompressionList](size_t i)
+		{
+			const CompressedView& v = compressedViewList[i];
+			const GltfJson::MeshoptCompression& m = meshoptCompressionList[v.bufferView->meshoptCompression];
+			const BufferData& bufferData = _bufferDataList.at(m.buffer);
+			if(m.byteOffset > bufferData.size || m.byteLength > bufferData.size - m.byteOffset)
+				throw GltfError("EXT_meshopt_compression: Compressed data are not completely inside their Buffer.");
+			MeshoptDecoder::decode(_meshoptDecodedData.get() + v.dstOffset, m.count, m.byteStride, m.mode, m.filter,
+			                       bufferData.data + m.byteOffset, m.byteLength);
+		}
+	);
+
+	// redirect bufferViews to decoded data
+	// (decoded data are appended to _bufferDataList after the glTF buffers)
+	uint32_t decodedBufferIndex = uint32_t(_bufferDataList.size());
+	_bufferDataList.push_back({ _meshoptDecodedData.get(), decodedSize });
+	for(CompressedView& v : compressedViewList) {
+		v.bufferView->buffer = decodedBufferIndex;
+		v.bufferView->byteOffset = v.dstOffset;
+	}
+}
+
+
+void Loader::decodeImages()
+{
+	if(!_sceneAvailable)
+		return;
+
+	// process images
+	//
+	// (Identical images are loaded only once. They are detected by the hash of the encoded file content
+	// and by the hash of decoded pixels after format conversion. Each duplicate image
+	// is remapped to the first image of the same content using appImageRemap.)
+	json::array_t& textures = *_textures;
+	json::array_t& images = *_images;
+	json::array_t& samplers = *_samplers;
+	uint32_t numGltfTextures = uint32_t(textures.size());
+	_decodedImageList.clear();
+	_decodedImageList.resize(_numAppImages);
+	vector<unsigned>& appImageRemap = _appImageRemap;
+	appImageRemap.resize(_numAppImages);
+	for(unsigned i=0; i<_numAppImages; i++)
+		appImageRemap[i] = i;
+	if(!images.empty()) {
+
+		// get format support
+		// sRGB formats:
+		//    R8G8B8Srgb+R8G8Srgb+R8Srgb format support is optional in Vulkan 1.0
+		//    R8G8B8A8Srgb is mandatory in Vulkan 1.0
+		// UNorm formats:
+		//    R8G8B8Unorm format is optional in Vulkan 1.0
+		//    R8G8B8A8Unorm+R8G8Unorm+R8Unorm support is mandatory in Vulkan 1.0
+		vk::FormatProperties fp = _vulkanInstance->getPhysicalDeviceFormatProperties(
+			_physicalDevice, vk::Format::eR8G8B8Srgb);
+		bool rgb8srgbSupported =
+			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) &&
+			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eTransferDst);
+		fp = _vulkanInstance->getPhysicalDeviceFormatProperties(_physicalDevice, vk::Format::eR8G8Srgb);
+		bool rg8srgbSupported =
+			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) &&
+			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eTransferDst);
+		fp = _vulkanInstance->getPhysicalDeviceFormatProperties(_physicalDevice, vk::Format::eR8Srgb);
+		bool r8srgbSupported =
+			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) &&
+			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eTransferDst);
+		fp = _vulkanInstance->getPhysicalDeviceFormatProperties(_physicalDevice, vk::Format::eR8G8B8Unorm);
+		bool rgb8unormSupported =
+			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) &&
+			(fp.optimalTilingFeatures & vk::FormatFeatureFlagBits::eTransferDst);
+
+		// load images
+		size_t numGltfImages = images.size();
+		log("Processing images (" + to_string(numGltfImages) + " in total)...");
+		// (hash is used as the key only, so the content is always compared on the hash hit)
+		multimap<tuple<uint64_t, size_t, bool>, tuple<unsigned, size_t>> encodedContentToAppImageMap;  // key: hash, file size, sRGB; value: app image index, gltf image index of the encoded content
+		multimap<tuple<uint64_t, vk::Format, int, int>, unsigned> pixelContentToAppImageMap;  // key: hash, format, width, height
+		vector<size_t> appImageToGltfImageMap(_numAppImages, ~size_t(0));  // gltf image index of the source of each stored app image
+		unsigned numSharedImages = 0;
+
+		// images that might be packed into atlases
+		// (packed textures are wrapped in the shader using repeat mode,
+		// so we pack only images whose all textures use repeat wrapping)
+		vector<bool> gltfImagePackable(numGltfImages, _settings.useTextureAtlas);
+		for(uint32_t i=0; i<numGltfTextures; i++) {
+			auto& texture = textures[i];
+			auto samplerIt = texture.find("sampler");
+			if(samplerIt == texture.end())
+				continue;
+			auto& sampler = samplers.at(samplerIt->get_ref<json::number_unsigned_t&>());
+			auto wrapSIt = sampler.find("wrapS");
+			auto wrapTIt = sampler.find("wrapT");
+			if((wrapSIt != sampler.end() && wrapSIt->get_ref<json::number_unsigned_t&>() != 10497) ||
+			   (wrapTIt != sampler.end() && wrapTIt->get_ref<json::number_unsigned_t&>() != 10497))
+			{
+				size_t imageIndex = textures[i].at("source").get_ref<json::number_unsigned_t&>();
+				gltfImagePackable.at(imageIndex) = false;
+			}
+		}
+
+		// BCn encoder
+		// (it compresses images on its thread pool between image decoding and staging buffer fill)
+		optional<CadR::BcEncoder> bcEncoder;
+		unsigned numCompressedImages = 0;
+		unsigned numCachedCompressedImages = 0;
+		if(_settings.useTextureCompression) {
+			bcEncoder.emplace();
+			if(!_settings.textureCacheDirectory.empty()) {
+				try {
+					bcEncoder->setCacheDirectory(_settings.textureCacheDirectory);
+				} catch(filesystem::filesystem_error& e) {
+					log(string("Failed to create texture cache directory: ") + e.what());
+				}
+			}
+		}
+
+		// store decoded image,
+		// optionally compressed into BCn format
+		// (images are uploaded into ImageStorage by buildGeometry())
+		auto storeImage =
+			[&](unsigned appImageIndex, unique_ptr<stbi_uc[], void(*)(stbi_uc*)>&& pixels, int width, int height,
+			    int numComponents, vk::Format format, size_t alignment, bool packable, bool srgb, bool normalMap,
+			    uint64_t pixelHash)
+			{
+				DecodedImage& d = _decodedImageList[appImageIndex];
+				d.width = width;
+				d.height = height;
+				d.numComponents = numComponents;
+
+				// compress image
+				if(bcEncoder) {
+
+					// choose format
+					CadR::BcEncoder::Format bcFormat =
+						CadR::BcEncoder::chooseFormat(
+							numComponents,
+							CadR::BcEncoder::hasAlpha(pixels.get(), size_t(width) * height, numComponents),
+							srgb,
+							normalMap);
+
+					// encode
+					size_t bufferSize = CadR::BcEncoder::encodedSize(bcFormat, width, height);
+					d.data = { new uint8_t[bufferSize], [](uint8_t* p) { delete[] p; } };
+					if(bcEncoder->encodeCached(pixelHash, bcFormat, pixels.get(), width, height, numComponents, d.data.get()))
+						numCachedCompressedImages++;
+					numCompressedImages++;
+					d.dataSize = bufferSize;
+					d.format = CadR::BcEncoder::vkFormat(bcFormat, srgb);
+					d.alignment = CadR::BcEncoder::blockSize(bcFormat);
+					d.compressed = true;
+					return;
+				}
+
+				// take ownership of pixels
+				d.data = { pixels.release(), [](uint8_t* p) { stbi_image_free(p); } };
+				d.dataSize = size_t(width) * height * numComponents;
+				d.format = format;
+				d.alignment = alignment;
+				d.packable = packable;
+			};
+
+		// image source
+		// (image is stored either in a file that is memory-mapped
+		// or in a bufferView that points into already mapped buffer)
+		auto openImageSource =
+			[&](size_t gltfImageIndex, MappedFile& mappedImage, const uint8_t*& imgData, size_t& fileSize) -> bool
+			{
+				auto& image = images[gltfImageIndex];
+				auto uriIt = image.find("uri");
+				if(uriIt != image.end()) {
+
+					// image file name
+					string s = decodeURI(uriIt->get_ref<json::string_t&>());
+					filesystem::path p = u8string_view(reinterpret_cast<const char8_t*>(s.data()), s.size());
+					if(p.is_relative())
+						p = _filePath.parent_path() / p;
+
+					// map file
+					try {
+						mappedImage.open(p);
+					} catch(CadR::LogicError&) {
+						return false;
+					}
+					mappedImage.adviseSequential();
+					imgData = mappedImage.data();
+					fileSize = mappedImage.size();
+				}
+				else {
+
+					// bufferView range
+					// (bufferView.buffer and bufferView.byteLength are mandatory, byteOffset is optional)
+					auto bufferViewIt = image.find("bufferView");
+					if(bufferViewIt == image.end())
+						return false;
+					const GltfJson::BufferView& bufferView = _gltfJson.bufferViewList.at(bufferViewIt->get_ref<json::number_unsigned_t&>());
+					size_t offset = bufferView.byteOffset;
+					fileSize = bufferView.byteLength;
+					BufferData& bufferData = _bufferDataList.at(bufferView.buffer);
+					if(offset + fileSize > bufferData.size)
+						return false;
+					imgData = bufferData.data + offset;
+				}
+				return imgData != nullptr;
+			};
+
+		// compare encoded content with the source of another gltf image
+		auto encodedContentEquals =
+			[&](size_t gltfImageIndex, const uint8_t* imgData, size_t fileSize) -> bool
+			{
+				MappedFile mappedImage;
+				const uint8_t* otherData = nullptr;
+				size_t otherSize = 0;
+				if(!openImageSource(gltfImageIndex, mappedImage, otherData, otherSize))
+					return false;
+				return otherSize == fileSize && memcmp(otherData, imgData, fileSize) == 0;
+			};
+
+		// compare decoded pixels with the pixels of stored app image
+		// (compressed images do not keep their pixels, so their source is decoded again)
+		auto pixelContentEquals =
+			[&](unsigned appImageIndex, const stbi_uc* pixels, size_t bufferSize) -> bool
+			{
+				const DecodedImage& d = _decodedImageList[appImageIndex];
+				if(!d.compressed)
+					return d.dataSize == bufferSize && memcmp(d.data.get(), pixels, bufferSize) == 0;
+				MappedFile mappedImage;
+				const uint8_t* otherData = nullptr;
+				size_t otherSize = 0;
+				if(!openImageSource(appImageToGltfImageMap[appImageIndex], mappedImage, otherData, otherSize))
+					return false;
+				int width, height;
+				unique_ptr<stbi_uc[], void(*)(stbi_uc*)> otherPixels(
+					stbi_load_from_memory(otherData, int(otherSize), &width, &height, nullptr, d.numComponents),
+					[](stbi_uc* ptr) { stbi_image_free(ptr); }
+				);
+				return otherPixels != nullptr && size_t(width) * height * d.numComponents == bufferSize &&
+				       memcmp(otherPixels.get(), pixels, bufferSize) == 0;
+			};
+
+		// find app image of the same content
+		// (returns ~0 if there is no such image)
+		auto findEncodedContent =
+			[&](uint64_t encodedHash, size_t fileSize, bool srgb, const uint8_t* imgData) -> unsigned
+			{
+				auto [it, endIt] = encodedContentToAppImageMap.equal_range({ encodedHash, fileSize, srgb });
+				for(; it!=endIt; it++)
+					if(encodedContentEquals(get<1>(it->second), imgData, fileSize))
+						return get<0>(it->second);
+				return ~unsigned(0);
+			};
+		auto findPixelContent =
+			[&](uint64_t pixelHash, vk::Format format, int width, int height, const stbi_uc* pixels, size_t bufferSize) -> unsigned
+			{
+				auto [it, endIt] = pixelContentToAppImageMap.equal_range({ pixelHash, format, width, height });
+				for(; it!=endIt; it++)
+					if(pixelContentEquals(it->second, pixels, bufferSize))
+						return it->second;
+				return ~unsigned(0);
+			};
+
+		for(size_t i=0; i<numGltfImages; i++) {
+
+			// skip not used images
+			auto [ linearImageIndex, srgbImageIndex ] = _gltfImageToAppImageMap[i];
+			if(linearImageIndex == ~unsigned(0) && srgbImageIndex == ~unsigned(0)) {
+				reportProgress(LoaderStage::DecodeImages, i+1, numGltfImages);
+				continue;
+			}
+
+			auto& image = images[i];
+			auto uriIt = image.find("uri");
+			auto bufferViewIt = image.find("bufferView");
+			if(uriIt != image.end() || bufferViewIt != image.end()) {
+
+				// image source
+				string imageName;
+				MappedFile mappedImage;
+				const uint8_t* imgData = nullptr;
+				size_t fileSize = 0;
+				if(uriIt != image.end())
+					imageName = uriIt->get_ref<json::string_t&>();
+				else
+					imageName = "bufferView " + to_string(bufferViewIt->get_ref<json::number_unsigned_t&>());
+				string message = "   " + imageName;
+				if(!openImageSource(i, mappedImage, imgData, fileSize))
+					goto failed;
+				else {
+
+					// share already loaded images of the same file content
+					uint64_t encodedHash = hashData(imgData, fileSize);
+					if(srgbImageIndex != ~unsigned(0)) {
+						unsigned sharedImageIndex = findEncodedContent(encodedHash, fileSize, true, imgData);
+						if(sharedImageIndex != ~unsigned(0)) {
+							appImageRemap[srgbImageIndex] = sharedImageIndex;
+							srgbImageIndex = ~unsigned(0);
+							numSharedImages++;
+						}
+					}
+					if(linearImageIndex != ~unsigned(0)) {
+						unsigned sharedImageIndex = findEncodedContent(encodedHash, fileSize, false, imgData);
+						if(sharedImageIndex != ~unsigned(0)) {
+							appImageRemap[linearImageIndex] = sharedImageIndex;
+							linearImageIndex = ~unsigned(0);
+							numSharedImages++;
+						}
+					}
+					if(srgbImageIndex == ~unsigned(0) && linearImageIndex == ~unsigned(0)) {
+						message += " (shared)";
+						goto succeed;
+					}
+
+					// image info
+					bool packable = gltfImagePackable[i];
+					int width, height, imgNumComponents;
+					if(!stbi_info_from_memory(imgData, int(fileSize), &width, &height, &imgNumComponents))
+						goto failed;
+					int srgbNumComponents = imgNumComponents;
+
+					unique_ptr<stbi_uc[], void(*)(stbi_uc*)> data(
+						nullptr,
+						[](stbi_uc* ptr) { stbi_image_free(ptr); }
+					);
+					if(srgbImageIndex != ~unsigned(0))
+					{
+						vk::Format format;
+						size_t alignment;
+						switch(srgbNumComponents) {
+						case 4: // red, green, blue, alpha
+							format = vk::Format::eR8G8B8A8Srgb;
+							alignment = 4;
+							break;
+						case 3: // red, green, blue
+							if(rgb8srgbSupported) {
+								format = vk::Format::eR8G8B8Srgb;
+								alignment = 3;
+							}
+							else {
+								// fallback to alpha always one
+								format = vk::Format::eR8G8B8A8Srgb;
+								alignment = 4;
+								srgbNumComponents = 4;
+							}
+							break;
+						case 2: // grey, alpha
+							if(rg8srgbSupported) {
+								format = vk::Format::eR8G8Srgb;
+								alignment = 2;
+							}
+							else {
+								// fallback to expand grey into red+green+blue+alpha
+								format = vk::Format::eR8G8B8A8Srgb;
+								alignment = 4;
+								srgbNumComponents = 4;
+							}
+							break;
+						case 1: // grey
+							if(r8srgbSupported) {
+								format = vk::Format::eR8Srgb;
+								alignment = 1;
+							}
+							else if(rg8srgbSupported) {
+								// fallback to expand grey into grey+alpha
+								format = vk::Format::eR8G8Srgb;
+								alignment = 2;
+								srgbNumComponents = 2;
+							}
+							else if(rgb8srgbSupported) {
+								// fallback to expand grey into red+green+blue
+								format = vk::Format::eR8G8B8Srgb;
+								alignment = 3;
+								srgbNumComponents = 3;
+							}
+							else {
+								// fallback to expand grey into red+green+blue+alpha
+								format = vk::Format::eR8G8B8A8Srgb;
+								alignment = 4;
+								srgbNumComponents = 4;
+							}
+							break;
+						default: goto failed;
+						}
+
+						// load image
+						data.reset(
+							stbi_load_from_memory(imgData, int(fileSize),
+								&width, &height, nullptr, srgbNumComponents)
+						);
+						if(data == nullptr)
+							goto failed;
+
+						// share already loaded image of the same pixel content
+						size_t bufferSize = size_t(width) * height * srgbNumComponents;
+						uint64_t pixelHash = hashData(data.get(), bufferSize);
+						unsigned sharedImageIndex = findPixelContent(pixelHash, format, width, height, data.get(), bufferSize);
+						if(sharedImageIndex != ~unsigned(0)) {
+							encodedContentToAppImageMap.emplace(tuple{ encodedHash, fileSize, true }, tuple{ sharedImageIndex, i });
+							appImageRemap[srgbImageIndex] = sharedImageIndex;
+							numSharedImages++;
+						}
+						else {
+							pixelContentToAppImageMap.emplace(tuple{ pixelHash, format, width, height }, srgbImageIndex);
+							encodedContentToAppImageMap.emplace(tuple{ encodedHash, fileSize, true }, tuple{ srgbImageIndex, i });
+							appImageToGltfImageMap[srgbImageIndex] = i;
+							storeImage(srgbImageIndex, std::move(data), width, height, srgbNumComponents, format, alignment,
+							           packable, true, false, pixelHash);
+						}
+					}
+
+					if(linearImageIndex != ~unsigned(0))
+					{
+						vk::Format format;
+						size_t alignment;
+						int linearNumComponents = imgNumComponents;
+						switch(linearNumComponents) {
+						case 4: // red, green, blue, alpha
+							format = vk::Format::eR8G8B8A8Unorm;
+							alignment = 4;
+							break;
+						case 3: // red, green, blue
+							if(rgb8unormSupported) {
+								format = vk::Format::eR8G8B8Unorm;
+								alignment = 3;
+							}
+							else {
+								// fallback to alpha always one
+								format = vk::Format::eR8G8B8A8Unorm;
+								alignment = 4;
+								linearNumComponents = 4;
+							}
+							break;
+						case 2: // grey, alpha
+							format = vk::Format::eR8G8Unorm;
+							alignment = 2;
+							break;
+						case 1: // grey
+							format = vk::Format::eR8Unorm;
+							alignment = 1;
+							break;
+						default: goto failed;
+						}
+
+						// reload image only if necessary
+						if(!data || srgbNumComponents != linearNumComponents)
+						{
+							// load image
+							data.reset(
+								stbi_load_from_memory(imgData, int(fileSize),
+									&width, &height, nullptr, linearNumComponents)
+							);
+							if(data == nullptr)
+								goto failed;
+						}
+
+						// share already loaded image of the same pixel content
+						size_t bufferSize = size_t(width) * height * linearNumComponents;
+						uint64_t pixelHash = hashData(data.get(), bufferSize);
+						unsigned sharedImageIndex = findPixelContent(pixelHash, format, width, height, data.get(), bufferSize);
+						if(sharedImageIndex != ~unsigned(0)) {
+							encodedContentToAppImageMap.emplace(tuple{ encodedHash, fileSize, false }, tuple{ sharedImageIndex, i });
+							appImageRemap[linearImageIndex] = sharedImageIndex;
+							numSharedImages++;
+						}
+						else {
+							pixelContentToAppImageMap.emplace(tuple{ pixelHash, format, width, height }, linearImageIndex);
+							encodedContentToAppImageMap.emplace(tuple{ encodedHash, fileSize, false }, tuple{ linearImageIndex, i });
+							appImageToGltfImageMap[linearImageIndex] = i;
+							storeImage(linearImageIndex, std::move(data), width, height, linearNumComponents, format, alignment,
+							           packable, false, _gltfImageIsNormalMap[i], pixelHash);
+						}
+					}
+
+				}
+				goto succeed;
+			failed:
+				log(message + " - failed");
+				throw GltfError("Failed to load texture " + imageName + ".");
+			succeed:
+				log(message);
+			}
+			reportProgress(LoaderStage::DecodeImages, i+1, numGltfImages);
+		}
+		if(numSharedImages > 0)
+			log("   " + to_string(numSharedImages) + " image(s) shared with identical images.");
+		if(numCompressedImages > 0)
+			log("   " + to_string(numCompressedImages) + " image(s) compressed into BCn formats, " +
+			    to_string(numCachedCompressedImages) + " of them taken from the cache.");
+	}
+}
+
+
+bool Loader::buildGeometry(size_t maxNumMeshes)
+{
+	// nothing to build
+	if(!_sceneAvailable) {
+		_buildGeometryStarted = true;
+		return true;
+	}
+
+	// materials, textures and matrices are created by the first call
+	json::array_t& meshes = *_meshes;
+	size_t numMeshes = meshes.size();
+	if(!_buildGeometryStarted) {
+		_buildGeometryStarted = true;
+		if(numMeshes == 0)
+			throw GltfError("No meshes in the model.");
+		buildMaterialsAndTextures();
+		_meshBoundingSphereList.assign(numMeshes, CadR::BoundingSphere::empty());
+		_nextMeshIndex = 0;
+		startWorkerThreads();
+	}
+
+	// process meshes
+	// (primitives of all the processed meshes are handled in parallel by the worker threads)
+	size_t numMeshesToBuild = min(maxNumMeshes, numMeshes - _nextMeshIndex);
+	buildMeshes(_nextMeshIndex, numMeshesToBuild);
+	_nextMeshIndex += numMeshesToBuild;
+	reportProgress(LoaderStage::BuildGeometry, _nextMeshIndex, numMeshes);
+	if(_nextMeshIndex < numMeshes)
+		return false;
+
+	// scene bounding sphere
+	computeSceneBoundingSphere();
+	return true;
+}
+
+
+void Loader::buildMaterialsAndTextures()
+{
+	json::array_t& meshes = *_meshes;
+	json::array_t& textures = *_textures;
+	json::array_t& samplers = *_samplers;
+	CadR::Renderer& renderer = *_renderer;
+
+	// matrixLists
+	// (their content is written by buildMeshes(); see fillMeshMatrices())
+	_matrixLists.reserve(meshes.size());
+	for(size_t i=0, c=meshes.size(); i<c; i++)
+		_matrixLists.emplace_back(renderer);
+
+	// default material
+	if(_settings.materialModel == MaterialModel::BlinPhong) {
+		// Phong material
+		CadR::StagingData sd = _defaultMaterial.alloc(sizeof(PhongMaterialData));
+		PhongMaterialData* m = sd.data<PhongMaterialData>();
+		m->ambient = glm::vec3(1.f, 1.f, 1.f);
+		m->padding1 = 0;
+		m->diffuseAndAlpha = glm::vec4(1.f, 1.f, 1.f, 1.f);
+		m->specular = glm::vec3(0.f, 0.f, 0.f);
+		m->shininess = 0.f;
+		m->emission = glm::vec3(0.f, 0.f, 0.f);
+		m->alphaCutoff = 0.5f;
+	} else {
+		// Metallic-roughness material
+		CadR::StagingData sd = _defaultMaterial.alloc(sizeof(MetallicRoughnessMaterialData));
+		MetallicRoughnessMaterialData* m = sd.data<MetallicRoughnessMaterialData>();
+		m->baseColorFactor = glm::vec4(1.f, 1.f, 1.f, 1.f);
+		m->alphaCutoff = 0.5f;
+		m->metallicFactor = 1.f;
+		m->roughnessFactor = 1.f;
+		m->emissiveFactor = glm::vec3(0.f, 0.f, 0.f);
+	}
+
+	// upload images,
+	// either as compressed image, as standalone image or packed into an atlas
+	CadR::ImageStorage& imageStorage = renderer.imageStorage();
+	vector<CadR::PackedImageAllocation> packedImageList(_numAppImages);
+	_imageList.reserve(_numAppImages);
+	for(unsigned i=0; i<_numAppImages; i++)
+		_imageList.emplace_back(imageStorage);
+	for(unsigned appImageIndex=0; appImageIndex<_numAppImages; appImageIndex++) {
+
+		// skip shared and not loaded images
+		DecodedImage& d = _decodedImageList[appImageIndex];
+		if(!d.data)
+			continue;
+		int width = d.width;
+		int height = d.height;
+		int numComponents = d.numComponents;
+
+		// compressed image
+		if(d.compressed) {
+
+			// copy data to staging buffer
+			CadR::StagingBuffer sb(imageStorage, d.dataSize, d.alignment);
+			memcpy(sb.data(), d.data.get(), d.dataSize);
+
+			// create ImageAllocation
+			CadR::ImageAllocation& a = _imageList[appImageIndex];
+			a.alloc(
+				vk::MemoryPropertyFlagBits::eDeviceLocal,  // requiredFlags
+				vk::ImageCreateInfo(  // imageCreateInfo
+					vk::ImageCreateFlags{},  // flags
+					vk::ImageType::e2D,  // imageType
+					d.format,  // format
+					vk::Extent3D(width, height, 1),  // extent
+					1,  // mipLevels
+					1,  // arrayLayers
+					vk::SampleCountFlagBits::e1,  // samples
+					vk::ImageTiling::eOptimal,  // tiling
+					vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,  // usage
+					vk::SharingMode::eExclusive,  // sharingMode
+					0,  // queueFamilyIndexCount
+					nullptr,  // pQueueFamilyIndices
+					vk::ImageLayout::eUndefined  // initialLayout
+				),
+				renderer.device()  // vulkanDevice
+			);
+
+			// submit copy
+			// (bufferRowLength and bufferImageHeight must be multiples of the block size)
+			sb.submit(
+				a,  // ImageAllocation
+				vk::ImageLayout::eUndefined,  // currentLayout,
+				vk::ImageLayout::eTransferDstOptimal,  // copyLayout,
+				vk::ImageLayout::eShaderReadOnlyOptimal,  // newLayout,
+				vk::PipelineStageFlagBits::eFragmentShader,  // newLayoutBarrierDstStages,
+				vk::AccessFlagBits::eShaderRead,  // newLayoutBarrierDstAccessFlags,
+				vk::BufferImageCopy{  // region
+					sb.bufferOffset(),  // bufferOffset
+					(uint32_t(width) + 3) & ~3u,  // bufferRowLength
+					(uint32_t(height) + 3) & ~3u,  // bufferImageHeight
+					vk::ImageSubresourceLayers{  // imageSubresource
+						vk::ImageAspectFlagBits::eColor,  // aspectMask
+						0,  // mipLevel
+						0,  // baseArrayLayer
+						1,  // layerCount
+					},
+					{0, 0, 0},  // imageOffset
+					{uint32_t(width), uint32_t(height), 1}  // imageExtent
+				},
+				d.dataSize  // dataSize
+			);
+			d.data.reset();
+			continue;
+		}
+
+		// pack small images into atlases
+		// (the border around the packed image contains wrapped texels of the image,
+		// so bilinear filtering on the image edges matches repeat wrapping mode)
+		const uint8_t* pixels = d.data.get();
+		if(d.packable && imageStorage.canBePacked(width, height)) {
+			CadR::PackedImageAllocation& pa = packedImageList[appImageIndex];
+			pa = imageStorage.allocPacked(d.format, width, height);
+			int b = int(pa.border);
+			int w = width + 2*b;
+			int h = height + 2*b;
+			size_t bufferSize = size_t(w) * h * numComponents;
+			CadR::StagingBuffer sb(imageStorage, bufferSize, d.alignment);
+			uint8_t* dst = sb.data<uint8_t>();
+			for(int y=0; y<h; y++) {
+				int srcY = (y - b + height) % height;
+				for(int x=0; x<w; x++) {
+					int srcX = (x - b + width) % width;
+					memcpy(dst, pixels + (size_t(srcY)*width + srcX) * numComponents, numComponents);
+					dst += numComponents;
+				}
+			}
+			imageStorage.submitPacked(
+				sb,  // stagingBuffer
+				pa,  // packedImageAllocation
+				vk::PipelineStageFlagBits::eFragmentShader,  // newLayoutBarrierDstStages
+				vk::AccessFlagBits::eShaderRead  // newLayoutBarrierDstAccessFlags
+			);
+			d.data.reset();
+			continue;
+		}
+
+		// copy data to staging buffer
+		CadR::StagingBuffer sb(imageStorage, d.dataSize, d.alignment);
+		memcpy(sb.data(), pixels, d.dataSize);
+
+		// create ImageAllocation
+		CadR::ImageAllocation& a = _imageList[appImageIndex];
+		a.alloc(
+			vk::MemoryPropertyFlagBits::eDeviceLocal,  // requiredFlags
+			vk::ImageCreateInfo(  // imageCreateInfo
+				vk::ImageCreateFlags{},  // flags
+				vk::ImageType::e2D,  // imageType
+				d.format,  // format
+				vk::Extent3D(width, height, 1),  // extent
+				1,  // mipLevels
+				1,  // arrayLayers
+				vk::SampleCountFlagBits::e1,  // samples
+				vk::ImageTiling::eOptimal,  // tiling
+				vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,  // usage
+				vk::SharingMode::eExclusive,  // sharingMode
+				0,  // queueFamilyIndexCount
+				nullptr,  // pQueueFamilyIndices
+				vk::ImageLayout::eUndefined  // initialLayout
+			),
+			renderer.device()  // vulkanDevice
+		);
+		sb.submit(
+			a,  // ImageAllocation
+			vk::ImageLayout::eUndefined,  // currentLayout,
+			vk::ImageLayout::eTransferDstOptimal,  // copyLayout,
+			vk::ImageLayout::eShaderReadOnlyOptimal,  // newLayout,
+			vk::PipelineStageFlagBits::eFragmentShader,  // newLayoutBarrierDstStages,
+			vk::AccessFlagBits::eShaderRead,  // newLayoutBarrierDstAccessFlags,
+			vk::Extent2D(width, height),  // imageExtent
+			d.dataSize  // dataSize
+		);
+		d.data.reset();
+	}
+
+	// process image samplers
+	// (create infos are kept for the samplers of textures packed in atlases)
+	vector<vk::SamplerCreateInfo> samplerCreateInfoList;
+	if(!samplers.empty()) {
+
+		// default settings for samplers
+		vk::SamplerCreateInfo samplerCreateInfo(
+			vk::SamplerCreateFlags(),  // flags
+			vk::Filter::eNearest,  // magFilter - will be set later
+			vk::Filter::eNearest,  // minFilter - will be set later
+			vk::SamplerMipmapMode::eNearest,  // mipmapMode - will be set later
+			vk::SamplerAddressMode::eRepeat,  // addressModeU - will be set later
+			vk::SamplerAddressMode::eRepeat,  // addressModeV - will be set later
+			vk::SamplerAddressMode::eRepeat,  // addressModeW
+			0.f,  // mipLodBias
+			VK_TRUE,  // anisotropyEnable
+			_settings.maxSamplerAnisotropy,  // maxAnisotropy
+			VK_FALSE,  // compareEnable
+			vk::CompareOp::eNever,  // compareOp
+			0.f,  // minLod
+			0.f,  // maxLod
+			vk::BorderColor::eFloatTransparentBlack,  // borderColor
+			VK_FALSE  // unnormalizedCoordinates
+		);
+
+		// read image samplers
+		size_t c = samplers.size();
+		_samplerList.reserve(c);
+		samplerCreateInfoList.reserve(c);
+		for(size_t i=0; i<c; i++) {
+			auto& sampler = samplers[i];
+
+			// magFilter
+			auto magFilterIt = sampler.find("magFilter");
+			if(magFilterIt != sampler.end()) {
+				switch(magFilterIt->get_ref<json::number_unsigned_t&>()) {
+				case 9728:  // GL_NEAREST
+					samplerCreateInfo.magFilter = vk::Filter::eNearest;
+					break;
+				case 9729:  // GL_LINEAR
+					samplerCreateInfo.magFilter = vk::Filter::eLinear;
+					break;
+				default:
+					throw GltfError("Sampler.magFilter contains invalid value.");
+				}
+			}
+			else {
+				// no defaults specified in glTF 2.0 spec
+				samplerCreateInfo.magFilter = vk::Filter::eNearest;
+			}
+
+			// minFilter
+			auto minFilterIt = sampler.find("minFilter");
+			if(minFilterIt != sampler.end()) {
+				switch(minFilterIt->get_ref<json::number_unsigned_t&>()) {
+				case 9728:  // GL_NEAREST
+					samplerCreateInfo.minFilter = vk::Filter::eNearest;
+					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;  // probably highest texture detail should be chosen here
+					break;
+				case 9729:  // GL_LINEAR
+					samplerCreateInfo.minFilter = vk::Filter::eLinear;
+					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;  // probably highest texture detail should be chosen here
+					break;
+				case 9984:  // GL_NEAREST_MIPMAP_NEAREST
+					samplerCreateInfo.minFilter = vk::Filter::eNearest;
+					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
+					break;
+				case 9985:  // GL_LINEAR_MIPMAP_NEAREST
+					samplerCreateInfo.minFilter = vk::Filter::eLinear;
+					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
+					break;
+				case 9986:  // GL_NEAREST_MIPMAP_LINEAR
+					samplerCreateInfo.minFilter = vk::Filter::eNearest;
+					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+					break;
+				case 9987: // GL_LINEAR_MIPMAP_LINEAR
+					samplerCreateInfo.minFilter = vk::Filter::eLinear;
+					samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+					break;
+				default:
+					throw GltfError("Sampler.minFilter contains invalid value.");
+				}
+			}
+			else {
+				// no defaults specified in glTF 2.0 spec
+				samplerCreateInfo.minFilter = vk::Filter::eNearest;
+				samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
+			}
+
+			// wrapS
+			auto wrapSIt = sampler.find("wrapS");
+			if(wrapSIt != sampler.end()) {
+				switch(wrapSIt->get_ref<json::number_unsigned_t&>()) {
+				case 33071:  // GL_CLAMP_TO_EDGE
+					samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+					break;
+				case 33648:  // GL_MIRRORED_REPEAT
+					samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eMirroredRepeat;
+					break;
+				case 10497:  // GL_REPEAT
+					samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
+					break;
+				default:
+					throw GltfError("Sampler.wrapS contains invalid value.");
+				}
+			}
+			else  // default is GL_REPEAT
+				samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
+
+			// wrapT
+			auto wrapTIt = sampler.find("wrapT");
+			if(wrapTIt != sampler.end()) {
+				switch(wrapTIt->get_ref<json::number_unsigned_t&>()) {
+				case 33071:  // GL_CLAMP_TO_EDGE
+					samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+					break;
+				case 33648:  // GL_MIRRORED_REPEAT
+					samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eMirroredRepeat;
+					break;
+				case 10497:  // GL_REPEAT
+					samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
+					break;
+				default:
+					throw GltfError("Sampler.wrapT contains invalid value.");
+				}
+			}
+			else  // default is GL_REPEAT
+				samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
+
+			// get sampler
+			// (identical samplers are shared through renderer's sampler cache)
+			_samplerList.emplace_back(renderer.getOrCreateSampler(samplerCreateInfo));
+			samplerCreateInfoList.emplace_back(samplerCreateInfo);
+
+		}
+	}
+
+	// process textures
+	//
+	// (Textures using the same image and sampler share single CadR::Texture object and its descriptor.
+	// Material texturing params reference either the descriptor directly,
+	// or the texture atlas entry if the texture is packed in an atlas.)
+	uint32_t numAppTextures = _numAppTextures;
+	vector<uint32_t> appTextureIdList(numAppTextures);  // textureId written into material texturing params
+	vector<bool> appTexturePackedList(numAppTextures, false);
+	struct TextureAtlasEntry {  // it must match TextureAtlasEntry in UberShaderInterface.glsl
+		array<float,4> scaleAndOffset;
+		uint32_t descriptorIndex;
+		array<uint32_t,3> padding;
+	};
+	vector<TextureAtlasEntry> textureAtlasData;
+	if(numAppTextures > 0) {
+		_textureList.reserve(numAppTextures);
+		map<tuple<CadR::ImageAllocation*, vk::Sampler>, uint32_t> imageAndSamplerToTextureListMap;
+		for(uint32_t i=0; i<numAppTextures; i++) {
+
+			// glTF texture
+			auto [ gltfTextureIndex, srgb ] = _appTextureInfoList[i];
+			auto& texture = textures[gltfTextureIndex];
+
+			// source / glTF image index
+			auto sourceIt = texture.find("source");
+			if(sourceIt == texture.end())
+				throw GltfError("Unsupported functionality: Texture.source is not defined for the texture.");
+			size_t gltfImageIndex = sourceIt->get_ref<json::number_unsigned_t&>();
+			LinearAndSrgbIndices appImageIndices = _gltfImageToAppImageMap[gltfImageIndex];
+			size_t appImageIndex = _appImageRemap[srgb ? appImageIndices.srgb : appImageIndices.linear];
+
+			// image or atlas
+			CadR::ImageAllocation* imageAllocation;
+			const CadR::PackedImageAllocation& packedImage = packedImageList[appImageIndex];
+			if(packedImage.isValid())
+				imageAllocation = packedImage.atlas;
+			else
+				imageAllocation = &_imageList[appImageIndex];
+
+			// sampler
+			// (textures packed in atlas use samplers without anisotropic filtering
+			// because anisotropic footprint might reach beyond the border of the packed image)
+			auto samplerIt = texture.find("sampler");
+			vk::Sampler vkSampler;
+			if(samplerIt != texture.end()) {
+				size_t samplerIndex = samplerIt->get_ref<json::number_unsigned_t&>();
+				vkSampler = _samplerList.at(samplerIndex);
+				if(packedImage.isValid()) {
+					vk::SamplerCreateInfo samplerCreateInfo = samplerCreateInfoList[samplerIndex];
+					samplerCreateInfo.anisotropyEnable = VK_FALSE;
+					vkSampler = renderer.getOrCreateSampler(samplerCreateInfo);
+				}
+			}
+			else {
+				// create default sampler only if needed
+				vk::Sampler& defaultSampler = packedImage.isValid() ? _defaultAtlasSampler : _defaultSampler;
+				if(!defaultSampler) {
+					defaultSampler = renderer.getOrCreateSampler(
+						vk::SamplerCreateInfo(
+							vk::SamplerCreateFlags(),  // flags
+							vk::Filter::eNearest,  // magFilter - glTF specifies to use "auto filtering", but what is that?
+							vk::Filter::eNearest,  // minFilter - glTF specifies to use "auto filtering", but what is that?
+							vk::SamplerMipmapMode::eNearest,  // mipmapMode
+							vk::SamplerAddressMode::eRepeat,  // addressModeU
+							vk::SamplerAddressMode::eRepeat,  // addressModeV
+							vk::SamplerAddressMode::eRepeat,  // addressModeW
+							0.f,  // mipLodBias
+							packedImage.isValid() ? VK_FALSE : VK_TRUE,  // anisotropyEnable
+							_settings.maxSamplerAnisotropy,  // maxAnisotropy
+							VK_FALSE,  // compareEnable
+							vk::CompareOp::eNever,  // compareOp
+							0.f,  // minLod
+							0.f,  // maxLod
+							vk::BorderColor::eFloatTransparentBlack,  // borderColor
+							VK_FALSE  // unnormalizedCoordinates
+						)
+					);
+				}
+				vkSampler = defaultSampler;
+			}
+
+			// reuse texture of the same image and sampler
+			// (textures packed in atlas reference the atlas entry holding the descriptor index
+			// and uv scale and offset of the packed image)
+			auto [textureIt, newTexture] =
+				imageAndSamplerToTextureListMap.try_emplace({ imageAllocation, vkSampler }, uint32_t(_textureList.size()));
+			if(packedImage.isValid()) {
+				appTextureIdList[i] = uint32_t(textureAtlasData.size());
+				appTexturePackedList[i] = true;
+				textureAtlasData.push_back({ packedImage.uvScaleAndOffset, textureIt->second, {} });
+			}
+			else
+				appTextureIdList[i] = textureIt->second;
+			if(!newTexture)
+				continue;
+
+			// create texture
+			_textureList.emplace_back(
+				*imageAllocation, // imageAllocation
+				vk::ImageViewCreateInfo(  // imageViewCreateInfo
+					vk::ImageViewCreateFlags(),  // flags
+					nullptr,  // image - will be filled in later
+					vk::ImageViewType::e2D,  // viewType
+					_decodedImageList[appImageIndex].format,  // format
+					vk::ComponentMapping{  // components
+						vk::ComponentSwizzle::eR,
+						vk::ComponentSwizzle::eG,
+						vk::ComponentSwizzle::eB,
+						vk::ComponentSwizzle::eA,
+					},
+					vk::ImageSubresourceRange{  // subresourceRange
+						vk::ImageAspectFlagBits::eColor,  // aspectMask
+						0,  // baseMipLevel
+						1,  // levelCount
+						0,  // baseArrayLayer
+						1,  // layerCount
+					}
+				),
+				vkSampler,  // sampler
+				renderer.device()  // device
+			);
+		}
+	}
+
+	// texture descriptors
+	// (they are allocated in the texture StateSet; its pipeline provides the pipeline layout for binding;
+	// there is one descriptor for each CadR::Texture)
+	uint32_t numTextures = uint32_t(_textureList.size());
+	uint32_t numTextureDescriptors = numTextures>0 ? numTextures : 1;
+	CadR::StateSet& textureStateSet = *_textureStateSet;
+	textureStateSet.allocDescriptorSets(
+		vk::DescriptorPoolCreateInfo(
+			vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind,  // flags
+			1,  // maxSets
+			1,  // poolSizeCount
+			array{  // pPoolSizes
+				vk::DescriptorPoolSize(
+					vk::DescriptorType::eCombinedImageSampler,  // type
+					numTextureDescriptors  // descriptorCount
+				),
+			}.data()
+		),
+		_pipelineSceneGraph->descriptorSetLayoutList(),
+		&(const vk::DescriptorSetVariableDescriptorCountAllocateInfo&)vk::DescriptorSetVariableDescriptorCountAllocateInfo(
+			1,  // descriptorSetCount
+			&numTextureDescriptors  // pDescriptorCounts
+		)
+	);
+
+	// update descriptor sets
+	if(numTextures > 0) {
+		vector<vk::DescriptorImageInfo> imageInfoList(numTextures);
+		for(uint32_t i=0; i<numTextures; i++) {
+			const CadR::Texture& t = _textureList[i];
+			imageInfoList[i] = {
+				t.sampler(),  // sampler
+				t.imageView(), // imageView
+				vk::ImageLayout::eShaderReadOnlyOptimal  // imageLayout
+			};
+		}
+		vk::WriteDescriptorSet writeInfo(
+			textureStateSet.descriptorSet(0),  // dstSet
+			0,  // dstBinding
+			0,  // dstArrayElement
+			numTextures,  // descriptorCount
+			vk::DescriptorType::eCombinedImageSampler,  // descriptorType
+			imageInfoList.data(),  // pImageInfo
+			nullptr,  // pBufferInfo
+			nullptr  // pTexelBufferView
+		);
+		textureStateSet.updateDescriptorSet(1, &writeInfo);
+	}
+
+	// texture atlas data
+	// (descriptor index, scale and offset of each texture packed in an atlas)
+	if(!textureAtlasData.empty()) {
+		size_t atlasDataSize = textureAtlasData.size() * sizeof(TextureAtlasEntry);
+		CadR::StagingData sd = _textureAtlasDataAllocation.alloc(atlasDataSize);
+		memcpy(sd.data(), textureAtlasData.data(), atlasDataSize);
+		log("   " + to_string(imageStorage.numAtlases()) + " texture atlas(es) used.");
+	}
+
+	// write textureIds into material data
+	// and mark textures packed in atlases in textureSetup
+	for(const MaterialTextureRecord& r : _materialTextureRecordList) {
+		memcpy(&_materialDataList[r.materialIndex][r.textureIdOffset], &appTextureIdList[r.appTextureIndex], sizeof(uint32_t));
+		if(appTexturePackedList[r.appTextureIndex])
+			_stateSetMaterialDataList[r.materialIndex].shaderTextureSetup[r.textureSetupIndex] |= 0x200000;
+	}
+
+	// materials
+	// (material data were prepared by parse())
+	_materialList.reserve(_materialDataList.size());
+	for(const vector<uint8_t>& materialData : _materialDataList) {
+		CadR::DataAllocation& a = _materialList.emplace_back(renderer.dataStorage());
+		CadR::StagingData sd = a.alloc(materialData.size());
+		memcpy(sd.data(), materialData.data(), materialData.size());
+	}
+
+	_materialDataList.clear();  // no needed any more
+	_gltfImageToAppImageMap.clear();  // no needed any more
+	_appTextureInfoList.clear();  // no needed any more
+	_materialTextureRecordList.clear();  // no needed any more
+	_gltfImageIsNormalMap.clear();  // no needed any more
+	_decodedImageList.clear();  // no needed any more
+	_appImageRemap.clear();  // no needed any more
+}
+
+
+// data of single mesh.primitive passed between the stages of buildMeshes()
+struct Loader::PrimitiveData {
+
+	size_t meshIndex;
+	size_t primitiveIndex;
+	json* primitive;
+	bool empty = false;  // primitive without vertices and indices; it is ignored
+	glm::vec4 dequantization;  // position dequantization; see Loader::_meshDequantizationList
+
+	// attributes
+	size_t numVertices = 0;
+	uint8_t* positionData = nullptr;
+	uint8_t* normalData = nullptr;
+	unsigned positionDataStride;
+	unsigned normalDataStride;
+	unsigned positionComponentType;
+	unsigned normalComponentType;
+	bool positionNormalized;
+	uint8_t* colorData = nullptr;
+	glm::vec4 (*getColorFunc)(uint8_t* srcPtr);
+	unsigned colorDataStride;
+	unsigned colorComponentType;
+	struct TexCoordAttribInfo {
+		uint8_t* data;
+		unsigned stride;
+		unsigned componentType;
+		bool normalized;
+	};
+	vector<TexCoordAttribInfo> texCoordAttribInfoList;
+	uint8_t* tangentData = nullptr;
+	unsigned tangentDataStride;
+	unsigned tangentComponentType;
+	CadR::BoundingBox primitiveSetBB = CadR::BoundingBox::empty();
+
+	// vertex layout
+	uint32_t vertexSize = 0;
+	uint16_t positionAccessInfo = 0x2000;
+	uint16_t normalAccessInfo = 0;
+	uint16_t tangentAccessInfo = 0;
+	uint16_t colorAccessInfo = 0;
+	array<uint16_t, CadPL::ShaderState::maxNumAttribs> texCoordAccessInfoList;
+
+	// indices
+	// (numIndices is the number of indices after conversion of strips, fans and loops into lists)
+	unsigned mode;
+	size_t numIndices;
+	void* indexData;
+	unsigned indexComponentType;
+	bool use16BitIndices;
+
+	// material and StateSet
+	size_t materialIndex;  // ~0 for the default material
+	CadR::StateSet* stateSet;
+
+	// merging of static primitives
+	// (matrix of merged primitive is baked into its vertices
+	// and its indices are rebased by baseVertex)
+	size_t mergeGroupIndex = ~size_t(0);
+	uint32_t subDrawIndex;
+	uint32_t baseVertex = 0;
+	glm::mat4 bakeMatrix;
+	glm::mat3 bakeNormalMatrix;
+
+	// vertex cache optimization
+	// (numbers of cache misses before and after the optimization)
+	size_t numCacheMissesBefore = 0;
+	size_t numCacheMissesAfter = 0;
+
+	// levels of detail
+	// (index data of primitives with levels of detail are kept in indexBuffer
+	// until the levels are generated and the index staging data of the final size are allocated;
+	// primitiveSetOffsets of the levels are assigned when PrimitiveSets are written)
+	bool generateLods = false;
+	vector<uint8_t> indexBuffer;
+	vector<uint8_t> lodIndexData;
+	vector<LodDrawable::Level> lodLevelList;
+
+	// staging data reserved in DataStorage
+	size_t geometryIndex;
+	uint8_t* vertexStagingData;
+	void* indexStagingData;
+
+	// primitiveSet bounding sphere
+	CadR::BoundingSphere primitiveSetBS;
+
+	PrimitiveData(size_t meshIndex_, size_t primitiveIndex_, json* primitive_, const glm::vec4& dequantization_)
+		: meshIndex(meshIndex_), primitiveIndex(primitiveIndex_), primitive(primitive_), dequantization(dequantization_)  {}
+};
+
+
+void Loader::startWorkerThreads()
+{
+	if(!_threadList.empty())
+		return;
+
+	// the calling thread works as well,
+	// so one thread less is created
+	unsigned numThreads = _settings.numThreads;
+	if(numThreads == 0)
+		numThreads = max(thread::hardware_concurrency(), 1u);
+	_exitThreads = false;
+	_threadList.reserve(numThreads-1);
+	for(unsigned i=1; i<numThreads; i++)
+		_threadList.emplace_back(&Loader::workerMain, this);
+}
+
+
+void Loader::stopWorkerThreads() noexcept
+{
+	{
+		lock_guard lock(_jobMutex);
+		_exitThreads = true;
+	}
+	_jobAvailableCondition.notify_all();
+	for(thread& t : _threadList)
+		t.join();
+	_threadList.clear();
+}
+
+
+void Loader::workerMain()
+{
+	unique_lock lock(_jobMutex);
+	while(true) {
+		_jobAvailableCondition.wait(lock, [this]{ return _exitThreads || !_jobQueue.empty(); });
+		if(_exitThreads)
+			return;
+		function<void()> job = move(_jobQueue.front());
+		_jobQueue.pop_front();
+		lock.unlock();
+		job();
+		lock.lock();
+	}
+}
+
+
+void Loader::parallelFor(size_t numItems, const function<void(size_t)>& func)
+{
+	// process the items on the calling thread
+	// if there is nothing to parallelize
+	if(numItems <= 1 || _threadList.empty()) {
+		for(size_t i=0; i<numItems; i++)
+			func(i);
+		return;
+	}
+
+	// items are taken one by one by all the threads,
+	// so large and small items are balanced among them;
+	// the first exception stops the processing and it is rethrown on the calling thread
+	atomic<size_t> nextItem = 0;
+	exception_ptr firstException;
+	auto processItems =
+		[&]() {
+			try {
+				for(size_t i=nextItem++; i<numItems; i=nextItem++)
+					func(i);
+			} catch(...) {
+				nextItem = numItems;
+				lock_guard lock(_jobMutex);
+				if(!firstException)
+					firstException = current_exception();
+			}
+		};
+
+	// submit jobs
+	size_t numJobs = min(_threadList.size(), numItems-1);
+	size_t numUnfinishedJobs = numJobs;
+	{
+		lock_guard lock(_jobMutex);
+		for(size_t i=0; i<numJobs; i++)
+			_jobQueue.emplace_back(
+				[this, &processItems, &numUnfinishedJobs]() {
+					processItems();
+					lock_guard lock(_jobMutex);
+					numUnfinishedJobs--;
+					if(numUnfinishedJobs == 0)
+						_jobFinishedCondition.notify_all();
+				}
+			);
+	}
+	_jobAvailableCondition.notify_all();
+
+	// help with the items and wait for completion of the jobs
+	processItems();
+	unique_lock lock(_jobMutex);
+	_jobFinishedCondition.wait(lock, [&numUnfinishedJobs]{ return numUnfinishedJobs == 0; });
+	if(firstException)
+		rethrow_exception(firstException);
+}
+
+
+glm::mat4* Loader::fillMeshMatrices(size_t meshIndex)
+{
+	// allocate matrices
+	// (position dequantization, if used, is folded into the matrices)
+	const vector<glm::mat4>& nodeMatrices = _meshMatrixList[meshIndex];
+	const glm::vec4& d = _meshDequantizationList[meshIndex];
+	glm::mat4* matrices = _matrixLists[meshIndex].editNewContent(_meshNumInstancesList[meshIndex]);
+
+	// matrices of ordinary nodes
+	if(d.w == 0.f)
+		memcpy(matrices, nodeMatrices.data(), nodeMatrices.size() * sizeof(glm::mat4));
+	else {
+		glm::mat4 dequantizationMatrix = glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(d)), glm::vec3(d.w));
+		for(size_t i=0, c=nodeMatrices.size(); i<c; i++)
+			matrices[i] = nodeMatrices[i] * dequantizationMatrix;
+	}
+
+	// EXT_mesh_gpu_instancing attribute accessor
+	// (TRANSLATION and SCALE are VEC3, ROTATION is VEC4; float, normalized or KHR_mesh_quantization types are accepted)
+	auto getInstancingAttribute =
+		[this](uint32_t accessorIndex, size_t numInstances, unsigned numComponents) -> InstancingAttribute
+		{
+			InstancingAttribute a;
+			if(accessorIndex == ~uint32_t(0))
+				return a;
+			const GltfJson::Accessor& accessor = _gltfJson.accessorList.at(accessorIndex);
+			if(accessor.type != ((numComponents == 4) ? GltfJson::AccessorType::Vec4 : GltfJson::AccessorType::Vec3))
+				throw GltfError("EXT_mesh_gpu_instancing attribute accessor is of invalid type.");
+			if((accessor.componentType < 5120 || accessor.componentType > 5123) && accessor.componentType != 5126)
+				throw GltfError("EXT_mesh_gpu_instancing attribute accessor has invalid componentType.");
+			a.componentType = accessor.componentType;
+			a.normalized = accessor.normalized;
+			void* data;
+			tie(data, a.stride) = getDataPointerAndStride(accessor, numInstances, numComponents * componentSize(accessor.componentType));
+			a.data = static_cast<uint8_t*>(data);
+			return a;
+		};
+
+	// matrices of EXT_mesh_gpu_instancing nodes
+	// (large nodes are split into chunks composed in parallel)
+	glm::mat4* dst = matrices + nodeMatrices.size();
+	for(const InstancedNode& n : _meshInstancedNodeList[meshIndex]) {
+		if(n.numInstances == 0)
+			continue;
+		const GltfJson::Instancing& instancing = _gltfJson.instancingList[n.instancing];
+		InstancingAttribute translation = getInstancingAttribute(instancing.translation, n.numInstances, 3);
+		InstancingAttribute rotation = getInstancingAttribute(instancing.rotation, n.numInstances, 4);
+		InstancingAttribute scale = getInstancingAttribute(instancing.scale, n.numInstances, 3);
+		constexpr size_t chunkSize = 16384;
+		size_t numChunks = (n.numInstances + chunkSize - 1) / chunkSize;
+		if(numChunks == 1)
+			composeInstancingMatrices(dst, 0, n.numInstances, n.matrix, d, translation, rotation, scale);
+		else
+			parallelFor(numChunks,
+				[&](size_t chunkIndex) {
+					size_t first = chunkIndex * chunkSize;
+					composeInstancingMatrices(dst, first, min(chunkSize, n.numInstances - first),
+					                          n.matrix, d, translation, rotation, scale);
+				});
+		dst += n.numInstances;
+	}
+
+	return matrices;
+}
+
+
+void Loader::buildMeshes(size_t firstMeshIndex, size_t numMeshes)
+{
+	// collect primitives
+	// (non-instanced meshes are ignored; mesh.primitives are mandatory)
+	vector<PrimitiveData> primitiveDataList;
+	for(size_t meshIndex=firstMeshIndex, e=firstMeshIndex+numMeshes; meshIndex<e; meshIndex++) {
+		if(_meshNumInstancesList[meshIndex] == 0)
+			continue;
+		auto& primitives = (*_meshes)[meshIndex].at("primitives");
+		if(primitives.empty())
+			throw GltfError("No primitives in the mesh.");
+		for(size_t i=0, c=primitives.size(); i<c; i++)
+			primitiveDataList.emplace_back(meshIndex, i, &primitives[i], _meshDequantizationList[meshIndex]);
+	}
+
+	// process attributes and indices of all the primitives in parallel
+	// (it validates the primitives and computes the sizes of their vertex and index data)
+	parallelFor(primitiveDataList.size(),
+		[this, &primitiveDataList](size_t i) { processPrimitive(primitiveDataList[i]); });
+
+	// resolve materials and StateSets
+	// (StateSets are created on the calling thread as PipelineSceneGraph is not thread-safe)
+	for(PrimitiveData& d : primitiveDataList)
+		if(!d.empty)
+			resolveStateSet(d);
+
+	// group static primitives for merging
+	// (static primitives belong to the meshes with a single instance;
+	// the mesh is merged either completely or not at all;
+	// primitives of a group share StateSet and material and they are rendered by a single Drawable)
+	struct MergeGroup {
+		CadR::StateSet* stateSet;
+		size_t materialIndex;
+		size_t mergedDrawableIndex;
+		CadR::BoundingBox bb;
+		glm::vec4 dequantization;
+		size_t geometryIndex;
+		CadR::GeometryMerger::StagingPointers stagingPointers;
+	};
+	vector<MergeGroup> mergeGroupList;
+	if(_settings.mergeStaticPrimitives) {
+		map<pair<CadR::StateSet*, size_t>, size_t> openGroupMap;
+		for(size_t i=0, c=primitiveDataList.size(); i<c; ) {
+
+			// primitives of the mesh
+			size_t meshIndex = primitiveDataList[i].meshIndex;
+			size_t e = i + 1;
+			while(e < c && primitiveDataList[e].meshIndex == meshIndex)
+				e++;
+
+			// is the mesh mergeable?
+			// (meshes with mirroring matrix are not merged as baking would flip triangle winding;
+			// positions quantized by KHR_mesh_quantization are copied as they are, so they cannot be baked)
+			const vector<glm::mat4>& matrices = _meshMatrixList[meshIndex];
+			bool mergeable = _meshNumInstancesList[meshIndex] == 1 && matrices.size() == 1 &&
+			                 glm::determinant(glm::mat3(matrices[0])) > 0.f;
+			for(size_t j=i; j<e && mergeable; j++) {
+				const PrimitiveData& d = primitiveDataList[j];
+				if(!d.empty)
+					mergeable = d.positionComponentType == 5126 && d.numVertices <= _settings.mergeMaxNumVertices;
+			}
+			if(!mergeable) {
+				i = e;
+				continue;
+			}
+
+			// append primitives into merge groups
+			const glm::mat4& m = matrices[0];
+			glm::mat3 normalMatrix = glm::inverseTranspose(glm::mat3(m));
+			for(; i<e; i++) {
+
+				PrimitiveData& d = primitiveDataList[i];
+				if(d.empty)
+					continue;
+
+				// find the group or open a new one when the primitive does not fit
+				auto [it, inserted] = openGroupMap.try_emplace(make_pair(d.stateSet, d.materialIndex), mergeGroupList.size());
+				if(inserted ||
+				   !_mergedDrawableList[mergeGroupList[it->second].mergedDrawableIndex].merger.canAppend(d.numVertices, d.numIndices))
+				{
+					it->second = mergeGroupList.size();
+					mergeGroupList.emplace_back(MergeGroup{
+						.stateSet = d.stateSet,
+						.materialIndex = d.materialIndex,
+						.mergedDrawableIndex = _mergedDrawableList.size(),
+						.bb = CadR::BoundingBox::empty(),
+						.dequantization = d.dequantization,
+					});
+					_mergedDrawableList.emplace_back(MergedDrawable{
+						.drawableIndex = ~size_t(0),
+						.merger = CadR::GeometryMerger(d.vertexSize, d.use16BitIndices),
+					});
+				}
+				MergeGroup& g = mergeGroupList[it->second];
+				MergedDrawable& md = _mergedDrawableList[g.mergedDrawableIndex];
+
+				// append the primitive
+				// (primitiveSetBB is transformed into the world space as the matrix is baked into the vertices)
+				d.mergeGroupIndex = it->second;
+				d.subDrawIndex = md.merger.append(uint32_t(d.numVertices), uint32_t(d.numIndices));
+				d.bakeMatrix = m;
+				d.bakeNormalMatrix = normalMatrix;
+				glm::vec3 center = d.primitiveSetBB.getCenter();
+				glm::vec3 halfExtents = d.primitiveSetBB.max - center;
+				d.primitiveSetBB =
+					CadR::BoundingBox::createByCenterAndHalfExtents(
+						glm::vec3(m * glm::vec4(center, 1.f)),  // center
+						glm::abs(glm::vec3(m[0])) * halfExtents.x +  // halfExtents
+							glm::abs(glm::vec3(m[1])) * halfExtents.y +
+							glm::abs(glm::vec3(m[2])) * halfExtents.z
+					);
+				g.bb.extendBy(d.primitiveSetBB);
+				md.sourcePrimitiveList.emplace_back(meshIndex, d.primitiveIndex);
+			}
+		}
+
+		// position dequantization of each group
+		// (quantized positions of merged primitives are relative to the group bounding box)
+		for(MergeGroup& g : mergeGroupList)
+			if(g.dequantization.w != 0.f) {
+				glm::vec3 extent = g.bb.max - g.bb.min;
+				float scale = max(max(extent.x, extent.y), extent.z);
+				g.dequantization = glm::vec4(g.bb.min, (scale > 0.f) ? scale : 1.f);
+			}
+		for(PrimitiveData& d : primitiveDataList)
+			if(d.mergeGroupIndex != ~size_t(0))
+				d.dequantization = mergeGroupList[d.mergeGroupIndex].dequantization;
+	}
+
+	// create Geometries and reserve their staging data
+	// (DataStorage is not thread-safe, so this is done on the calling thread)
+	struct PrimitiveSetGpuData {
+		uint32_t count;
+		uint32_t first;
+	};
+	_geometryList.reserve(_geometryList.size() + primitiveDataList.size());
+	for(PrimitiveData& d : primitiveDataList) {
+
+		if(d.empty || d.mergeGroupIndex != ~size_t(0))
+			continue;
+
+		// create Geometry
+		d.geometryIndex = _geometryList.size();
+		CadR::Geometry& g = _geometryList.emplace_back(*_renderer);
+
+		// vertex data
+		CadR::StagingData sd = g.createVertexStagingData(d.numVertices * d.vertexSize);
+		d.vertexStagingData = sd.data<uint8_t>();
+
+		// primitives with levels of detail
+		// (their index and primitiveSet data are allocated after the levels are generated)
+		size_t numBytes = d.numIndices * (d.use16BitIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+		d.generateLods = _settings.numLodLevels > 0 && d.mode >= 4 && d.positionData && d.numIndices >= 64*3;
+		if(d.generateLods) {
+			d.indexBuffer.resize(numBytes);
+			d.indexStagingData = d.indexBuffer.data();
+			continue;
+		}
+
+		// index data
+		// (16-bit index data are padded to 4 bytes
+		// as the shaders read them by 32-bit words)
+		sd = g.createIndexStagingData((numBytes + 3) & ~size_t(3));
+		if(numBytes & 0x3)
+			memset(sd.data<uint8_t>() + (numBytes & ~size_t(3)), 0, 4);
+		d.indexStagingData = sd.data();
+
+		// primitiveSet data
+		sd = g.createPrimitiveSetStagingData(sizeof(PrimitiveSetGpuData));
+		PrimitiveSetGpuData* ps = sd.data<PrimitiveSetGpuData>();
+		ps->count = uint32_t(d.numIndices);
+		ps->first = 0;
+	}
+
+	// create merged Geometries
+	// and assign their parts to the merged primitives
+	for(MergeGroup& g : mergeGroupList) {
+		g.geometryIndex = _geometryList.size();
+		CadR::Geometry& geometry = _geometryList.emplace_back(*_renderer);
+		g.stagingPointers = _mergedDrawableList[g.mergedDrawableIndex].merger.createStagingData(geometry);
+	}
+	for(PrimitiveData& d : primitiveDataList) {
+		if(d.mergeGroupIndex == ~size_t(0))
+			continue;
+		MergeGroup& g = mergeGroupList[d.mergeGroupIndex];
+		const CadR::GeometryMerger::SubDraw& subDraw =
+			_mergedDrawableList[g.mergedDrawableIndex].merger.subDraw(d.subDrawIndex);
+		d.geometryIndex = g.geometryIndex;
+		d.vertexStagingData = g.stagingPointers.vertexData + size_t(subDraw.firstVertex) * d.vertexSize;
+		d.indexStagingData =
+			g.stagingPointers.indexData +
+			size_t(subDraw.firstIndex) * (d.use16BitIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+		d.baseVertex = subDraw.firstVertex;
+	}
+
+	// fill vertex and index data in parallel
+	// (each primitive writes only into its own staging data)
+	parallelFor(primitiveDataList.size(),
+		[this, &primitiveDataList](size_t i) { fillPrimitiveStagingData(primitiveDataList[i]); });
+	if(_settings.optimizeVertexCache) {
+		size_t numTriangles = 0;
+		size_t numMissesBefore = 0;
+		size_t numMissesAfter = 0;
+		for(PrimitiveData& d : primitiveDataList)
+			if(!d.empty && d.mode >= 4) {
+				numTriangles += d.numIndices / 3;
+				numMissesBefore += d.numCacheMissesBefore;
+				numMissesAfter += d.numCacheMissesAfter;
+			}
+		if(numTriangles > 0) {
+			ostringstream ss;
+			ss << fixed << setprecision(3) << "   Vertex cache optimization of " << numTriangles
+			   << " triangle(s): ACMR " << double(numMissesBefore) / numTriangles
+			   << " -> " << double(numMissesAfter) / numTriangles << ".";
+			log(ss.str());
+		}
+	}
+
+	// index and primitiveSet data of primitives with levels of detail
+	// (index data of the levels follow the full detail indices;
+	// PrimitiveSet at offset 0 renders the full detail and it is followed by PrimitiveSets of the levels)
+	size_t numLodPrimitives = 0;
+	size_t numLodLevels = 0;
+	for(PrimitiveData& d : primitiveDataList) {
+
+		if(!d.generateLods)
+			continue;
+		CadR::Geometry& g = _geometryList[d.geometryIndex];
+
+		// index data
+		size_t numBytes = d.indexBuffer.size() + d.lodIndexData.size();
+		CadR::StagingData sd = g.createIndexStagingData((numBytes + 3) & ~size_t(3));
+		uint8_t* p = sd.data<uint8_t>();
+		if(numBytes & 0x3)
+			memset(p + (numBytes & ~size_t(3)), 0, 4);
+		memcpy(p, d.indexBuffer.data(), d.indexBuffer.size());
+		memcpy(p + d.indexBuffer.size(), d.lodIndexData.data(), d.lodIndexData.size());
+		d.indexBuffer = {};
+		d.lodIndexData = {};
+
+		// primitiveSet data
+		sd = g.createPrimitiveSetStagingData(sizeof(PrimitiveSetGpuData) * (1 + d.lodLevelList.size()));
+		PrimitiveSetGpuData* ps = sd.data<PrimitiveSetGpuData>();
+		ps[0].count = uint32_t(d.numIndices);
+		ps[0].first = 0;
+		uint32_t first = uint32_t(d.numIndices);
+		for(size_t i=0, c=d.lodLevelList.size(); i<c; i++) {
+			LodDrawable::Level& level = d.lodLevelList[i];
+			level.primitiveSetOffset = uint32_t((i + 1) * sizeof(PrimitiveSetGpuData));
+			ps[i+1].count = level.numIndices;
+			ps[i+1].first = first;
+			first += level.numIndices;
+		}
+		if(!d.lodLevelList.empty()) {
+			numLodPrimitives++;
+			numLodLevels += d.lodLevelList.size();
+		}
+	}
+	if(numLodPrimitives > 0)
+		log("   " + to_string(numLodLevels) + " level(s) of detail generated for " +
+		    to_string(numLodPrimitives) + " primitive(s).");
+
+	// create Drawables
+	// and compute mesh bounding spheres
+	for(size_t i=0, c=primitiveDataList.size(); i<c; ) {
+
+		size_t meshIndex = primitiveDataList[i].meshIndex;
+		CadR::BoundingBox meshBB = CadR::BoundingBox::empty();
+		vector<CadR::BoundingSphere> primitiveSetBSList;
+		bool meshMerged = false;
+		for(; i<c && primitiveDataList[i].meshIndex==meshIndex; i++) {
+
+			PrimitiveData& d = primitiveDataList[i];
+			if(d.empty)
+				continue;
+
+			// update mesh bounds
+			// (meshBB contains always valid value;
+			// this is guaranteed by primitiveSetBB being always valid unless POSITION attribute is not specified,
+			// which was tested by processPrimitive() by numVertices being non-zero)
+			meshBB.extendBy(d.primitiveSetBB);
+			primitiveSetBSList.emplace_back(d.primitiveSetBS);
+
+			// merged primitives are rendered by the Drawables of their merge groups
+			if(d.mergeGroupIndex != ~size_t(0)) {
+				meshMerged = true;
+				continue;
+			}
+
+			// drawable
+			_drawableList.emplace_back(
+				_geometryList[d.geometryIndex],  // geometry
+				0,  // primitiveSetOffset
+				_matrixLists[meshIndex],  // matrixList
+				(d.materialIndex==~size_t(0))  // drawableData
+					? _defaultMaterial
+					: _materialList[d.materialIndex],
+				*d.stateSet  // stateSet
+			);
+
+			// levels of detail
+			if(!d.lodLevelList.empty()) {
+				LodDrawable& ld = _lodDrawableList.emplace_back(LodDrawable{ .drawableIndex = _drawableList.size() - 1 });
+				ld.levelList.reserve(1 + d.lodLevelList.size());
+				ld.levelList.push_back({ .primitiveSetOffset = 0, .numIndices = uint32_t(d.numIndices), .error = 0.f });
+				ld.levelList.insert(ld.levelList.end(), d.lodLevelList.begin(), d.lodLevelList.end());
+			}
+		}
+
+		// ignore meshes composed of empty primitives only
+		if(primitiveSetBSList.empty())
+			continue;
+
+		// mesh bounding sphere
+		// (meshBS is always valid)
+		CadR::BoundingSphere meshBS{
+			.center = meshBB.getCenter(),
+			.radius = 0.f,
+		};
+		for(size_t i=0,c=primitiveSetBSList.size(); i<c; i++)
+			meshBS.extendRadiusBy(primitiveSetBSList[i]);
+
+		// matrix of merged mesh is baked into the vertices,
+		// so meshBS is already in the world space
+		if(meshMerged) {
+			_meshBoundingSphereList[meshIndex] = meshBS;
+			continue;
+		}
+
+		// write instancing matrices into MatrixList
+		// (staging memory is host cached, so the matrices are read back for bounding volumes;
+		// non-instanced meshes were not processed, so matrices are never empty here)
+		glm::mat4* matrices = fillMeshMatrices(meshIndex);
+		size_t numMatrices = _meshNumInstancesList[meshIndex];
+
+		// matrices include position dequantization,
+		// so meshBS is converted into quantized space
+		const glm::vec4& dq = _meshDequantizationList[meshIndex];
+		if(dq.w != 0.f) {
+			meshBS.center = (meshBS.center - glm::vec3(dq)) / dq.w;
+			meshBS.radius /= dq.w;
+		}
+
+		// first instance's bounding box
+		CadR::BoundingBox instancesBB =
+			CadR::BoundingBox::createByCenterAndHalfExtents(
+				glm::mat3(matrices[0]) * meshBS.center + glm::vec3(matrices[0][3]),  // center
+				glm::abs(glm::mat3(matrices[0]) * glm::vec3(meshBS.radius))  // halfExtents
+			);
+
+		// remaining instance's bounding boxes
+		for(size_t instanceIndex=1, instanceCount=numMatrices;
+			instanceIndex<instanceCount; instanceIndex++)
+		{
+			const glm::mat4& m = matrices[instanceIndex];
+			instancesBB.extendBy(
+				CadR::BoundingBox::createByCenterAndHalfExtents(
+					glm::mat3(m) * meshBS.center + glm::vec3(m[3]),  // center
+					glm::abs(glm::mat3(m) * glm::vec3(meshBS.radius))  // radius
+				)
+			);
+		}
+
+		// bounding sphere of all instances of particular mesh
+		// (instancesDB is always valid)
+		CadR::BoundingSphere instancesBS{
+			.center = instancesBB.getCenter(),
+			.radius = 0.f,
+		};
+		vector<CadR::BoundingSphere> instanceBSList(numMatrices);
+		meshBS.transform(matrices, numMatrices, instanceBSList.data());
+		for(const CadR::BoundingSphere& bs : instanceBSList)
+			instancesBS.extendRadiusBy(bs);
+		_meshBoundingSphereList[meshIndex] = instancesBS;
+	}
+
+	// create Drawables of merge groups
+	// (position dequantization, if used, is the only matrix)
+	size_t numMergedPrimitives = 0;
+	for(MergeGroup& g : mergeGroupList) {
+		CadR::MatrixList& ml = _mergedMatrixLists.emplace_back(*_renderer);
+		const glm::vec4& dq = g.dequantization;
+		ml.setMatrices(
+			(dq.w != 0.f)
+				? glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(dq)), glm::vec3(dq.w))
+				: glm::mat4(1.f));
+		MergedDrawable& md = _mergedDrawableList[g.mergedDrawableIndex];
+		md.drawableIndex = _drawableList.size();
+		numMergedPrimitives += md.merger.numSubDraws();
+		_drawableList.emplace_back(
+			_geometryList[g.geometryIndex],  // geometry
+			0,  // primitiveSetOffset
+			ml,  // matrixList
+			(g.materialIndex==~size_t(0))  // drawableData
+				? _defaultMaterial
+				: _materialList[g.materialIndex],
+			*g.stateSet  // stateSet
+		);
+	}
+	if(!mergeGroupList.empty())
+		log("   " + to_string(numMergedPrimitives) + " static primitive(s) merged into " +
+		    to_string(mergeGroupList.size()) + " Drawable(s).");
+}
+
+
+void Loader::resolveStateSet(PrimitiveData& d)
+{
+	// material
+	json& primitive = *d.primitive;
+	auto materialIt = primitive.find("material");
+	d.materialIndex =
+		(materialIt != primitive.end())
+			? materialIt->get_ref<json::number_unsigned_t&>()
+			: ~size_t(0);
+	StateSetMaterialData& ssMaterialData =
+		(materialIt != primitive.end())
+		? _stateSetMaterialDataList.at(d.materialIndex)
+		: _defaultStateSetMaterialData;
+
+	// pipeline
+	const unsigned mode = d.mode;
+	CadPL::ShaderState shaderState{
+		.idBuffer = false,
+		.transparency = ssMaterialData.transparencyEnabled,
+		.primitiveTopology =
+			[](unsigned mode) -> vk::PrimitiveTopology
+			{
+				switch(mode) {
+				case 0:  // POINTS
+					return vk::PrimitiveTopology::ePointList;
+				case 1:  // LINES
+				case 2:  // LINE_LOOP
+				case 3:  // LINE_STRIP
+					return vk::PrimitiveTopology::eLineList;
+				case 4:  // TRIANGLES
+				case 5:  // TRIANGLE_STRIP
+				case 6:  // TRIANGLE_FAN
+					return vk::PrimitiveTopology::eTriangleList;
+				default:
+					throw GltfError("Invalid value for mesh.primitive.mode.");
+				}
+			}(mode),
+		.projectionHandling =
+			CadPL::ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants,
+		.attribAccessInfo =
+			[&]() {
+				decltype(CadPL::ShaderState::attribAccessInfo) r;
+
+				// vertices, normals, tangents and colors
+				// (their formats and offsets were determined when computing vertex layout)
+				r[0] = d.positionAccessInfo;
+				r[1] = d.normalAccessInfo;
+				r[2] = d.tangentAccessInfo;
+				r[3] = d.colorAccessInfo;
+
+				// texCoords
+				for(size_t i=0,c=d.texCoordAttribInfoList.size(); i<c; i++)
+					r[4+i] = d.texCoordAccessInfoList[i];
+
+				// fill the rest with zeros
+				for(size_t i=4+d.texCoordAttribInfoList.size(),c=r.size(); i<c; i++)
+					r[i] = 0;
+
+				return r;
+			}(),
+		.attribSetup =
+			(d.normalData || ssMaterialData.unlit || (mode <= 3) ? 0 : 1) |  // generateFlatNormals if normals are missing, just skip unlit materials and points and lines
+			(d.use16BitIndices ? 0x2 : 0) |  // 16-bit indices
+			d.vertexSize,  // vertexDataSize
+		.materialSetup =
+			(ssMaterialData.unlit ? 0x0 : uint32_t(_settings.materialModel)) |  // Unlit vs Blin-Phong or Metallic-roughness
+			ssMaterialData.materialTexturingParamsOffset |  // texture params offset inside material
+			(ssMaterialData.doubleSided ? 0x0100 : 0) |  // two sided lighting
+			((mode <= 3) && (d.normalData == nullptr) ? 0x0200 : 0) |  // disable lighting for points and lines without normals
+			(ssMaterialData.alphaTest ? 0x0400 : 0) |  // alphaTest
+			0x0 |  // do not ignore alpha anywhere (on color attribute, on material and on base texture)
+			0x8000 |  // color attribute (if present) multiplies material ambient and diffuse color instead of ignoring them when computing ambient and diffuse color contributions
+			0x10000,  // separate emission on Phong material
+		.pointSize = 1.f,
+		.textureSetup = ssMaterialData.shaderTextureSetup,
+		.lightSetup = { 2 },  // one light; we use point light at the position of camera and call it headlight
+		.optimizeFlags = _settings.optimizeFlags,
+	};
+	auto transparencyBlendAttachmentState =
+		[]() {
+			return CadPL::PipelineState::BlendAttachmentState{
+				.blendEnable = true,
+				.srcColorBlendFactor = vk::BlendFactor::eOne,
+				.dstColorBlendFactor = vk::BlendFactor::eOne,
+				.colorBlendOp = vk::BlendOp::eAdd,
+				.srcAlphaBlendFactor = vk::BlendFactor::eOne,
+				.dstAlphaBlendFactor = vk::BlendFactor::eOne,
+				.alphaBlendOp = vk::BlendOp::eAdd,
+				.colorWriteMask =
+					vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+					vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA,
+			};
+		};
+	CadPL::PipelineState pipelineState = _settings.pipelineState;
+	pipelineState.cullMode =
+		(ssMaterialData.doubleSided)
+			? vk::CullModeFlagBits::eNone   // eNone - nothing is discarded
+			: vk::CullModeFlagBits::eBack;  // eBack - back-facing triangles are discarded, eFront - front-facing triangles are discarded
+	pipelineState.depthWriteEnable = !ssMaterialData.transparencyEnabled;  // disable depth writes for transparent geometry
+	for(uint32_t i=0; i<pipelineState.numColorAttachments; i++)
+		pipelineState.blendState[i] =
+			ssMaterialData.transparencyEnabled
+				? transparencyBlendAttachmentState()
+				: CadPL::PipelineState::BlendAttachmentState{ .blendEnable = false };
+	d.stateSet =
+		(_settings.getOrCreateStateSetFunc)
+			? &_settings.getOrCreateStateSetFunc(shaderState, pipelineState)
+			: &_pipelineSceneGraph->getOrCreateStateSet(shaderState, pipelineState);
+}
+
+
+tuple<void*, unsigned> Loader::getDataPointerAndStride(const GltfJson::Accessor& accessor, size_t numElements, size_t elementSize) const
+{
+	// accessor.sparse is not supported yet
+	if(accessor.sparse)
+		throw GltfError("Unsupported functionality: Property sparse.");
+
+	// get accessor.bufferView (it is optional)
+	if(accessor.bufferView == ~uint32_t(0))
+		throw GltfError("Unsupported functionality: Omitted bufferView.");
+	const GltfJson::BufferView& bufferView = _gltfJson.bufferViewList.at(accessor.bufferView);
+
+	// bufferView.byteStride (it is optional (but mandatory in some cases), if not provided, data are tightly packed)
+	unsigned stride = (bufferView.byteStride != 0) ? bufferView.byteStride : unsigned(elementSize);
+	size_t dataSize = (numElements-1) * stride + elementSize;
+
+	// get accessor.byteOffset (it is optional with default value 0)
+	uint64_t offset = accessor.byteOffset;
+
+	// make sure we not run over bufferView.byteLength (byteLength is mandatory and >=1)
+	if(offset + dataSize > bufferView.byteLength)
+		throw GltfError("Accessor range is not completely inside its BufferView.");
+
+	// append bufferView.byteOffset (byteOffset is optional with default value 0)
+	offset += bufferView.byteOffset;
+
+	// get bufferView.buffer (buffer is mandatory)
+	size_t bufferIndex = bufferView.buffer;
+
+	// make sure we do not run over buffer.byteLength (byteLength is mandatory)
+	// (indices past the glTF buffers refer to data decoded from EXT_meshopt_compression,
+	// that are not described by json)
+	json::array_t& buffers = *_buffers;
+	if(bufferIndex < buffers.size())
+		if(offset + dataSize > buffers[bufferIndex].at("byteLength").get_ref<json::number_unsigned_t&>())
+			throw GltfError("BufferView range is not completely inside its Buffer.");
+
+	// return pointer to buffer data and data stride
+	// (buffer data are read-only mapped memory; they are only read by the callers)
+	const BufferData& bufferData = _bufferDataList.at(bufferIndex);
+	if(offset + dataSize > bufferData.size)
+		throw GltfError("BufferView range is not completely inside data range.");
+	return { const_cast<uint8_t*>(bufferData.data) + offset, stride };
+}
+
+
+void Loader::processPrimitive(PrimitiveData& d)
+{
+	const vector<GltfJson::Accessor>& accessorList = _gltfJson.accessorList;
+	const bool useVertexCompression = _settings.useVertexCompression;
+	const bool meshQuantizationUsed = _meshQuantizationUsed;
+	json& primitive = *d.primitive;
+
+	// mesh.primitive helper functions
+	auto updateNumVertices =
+		[](const GltfJson::Accessor& accessor, size_t& numVertices) -> void
+		{
+			// get position count (accessor.count is mandatory and >=1)
+			uint64_t count = accessor.count;
+
+			// update numVertices if still set to 0
+			if(numVertices != count) {
+				if(numVertices == 0) {
+					if(count != 0)
+						numVertices = count;
+					else
+						throw GltfError("Accessor's count member must be greater than zero.");
+				}
+				else
+					throw GltfError("Number of elements is not the same for all primitive attributes.");
+			}
+		};
+
+	// attributes (mesh.primitive.attributes is mandatory)
+	// (local names refer to the members of PrimitiveData)
+	auto& attributes = primitive.at("attributes");
+	size_t& numVertices = d.numVertices;
+	uint8_t*& positionData = d.positionData;
+	uint8_t*& normalData = d.normalData;
+	unsigned& positionDataStride = d.positionDataStride;
+	unsigned& normalDataStride = d.normalDataStride;
+	unsigned& positionComponentType = d.positionComponentType;
+	unsigned& normalComponentType = d.normalComponentType;
+	bool& positionNormalized = d.positionNormalized;
+	uint8_t*& colorData = d.colorData;
+	glm::vec4 (*&getColorFunc)(uint8_t* srcPtr) = d.getColorFunc;
+	unsigned& colorDataStride = d.colorDataStride;
+	unsigned& colorComponentType = d.colorComponentType;
+	using TexCoordAttribInfo = PrimitiveData::TexCoordAttribInfo;
+	vector<TexCoordAttribInfo>& texCoordAttribInfoList = d.texCoordAttribInfoList;
+	uint8_t*& tangentData = d.tangentData;
+	unsigned& tangentDataStride = d.tangentDataStride;
+	unsigned& tangentComponentType = d.tangentComponentType;
+	CadR::BoundingBox& primitiveSetBB = d.primitiveSetBB;
+	for(auto it = attributes.begin(); it != attributes.end(); it++) {
+		if(it.key() == "POSITION") {
+
+			// accessor
+			const GltfJson::Accessor& accessor = accessorList.at(it.value().get_ref<json::number_unsigned_t&>());
+
+			// accessor.type is mandatory and it must be VEC3 for position accessor
+			if(accessor.type != GltfJson::AccessorType::Vec3)
+				throw GltfError("Position attribute is not of VEC3 type.");
+
+			// accessor.componentType is mandatory and it must be FLOAT (5126) for position accessor;
+			// KHR_mesh_quantization allows also BYTE (5120), UNSIGNED_BYTE (5121), SHORT (5122)
+			// and UNSIGNED_SHORT (5123), normalized or not
+			positionComponentType = accessor.componentType;
+			if(positionComponentType != 5126)
+				if(!meshQuantizationUsed || positionComponentType < 5120 || positionComponentType > 5123)
+					throw GltfError("Position attribute componentType is not float.");
+
+			// accessor.normalized is optional with default value false; it must be false for float componentType
+			positionNormalized = false;
+			if(accessor.normalized) {
+				if(positionComponentType == 5126)
+					throw GltfError("Position attribute normalized flag is true.");
+				positionNormalized = true;
+			}
+
+			// update numVertices
+			updateNumVertices(accessor, numVertices);
+
+			// position data and stride
+			tie(reinterpret_cast<void*&>(positionData), positionDataStride) =
+				getDataPointerAndStride(accessor, numVertices, 3 * componentSize(positionComponentType));
+
+			// quantized positions
+			// (min and max values of quantized data are computed directly from the data
+			// as they are in the same space as the values used for rendering)
+			if(positionComponentType != 5126) {
+				primitiveSetBB = CadR::BoundingBox::empty();
+				uint8_t* srcPtr = positionData;
+				for(size_t i=0; i<numVertices; i++, srcPtr+=positionDataStride) {
+					glm::vec3 pos = readVec3(srcPtr, positionComponentType, positionNormalized);
+					primitiveSetBB.min = glm::min(primitiveSetBB.min, pos);
+					primitiveSetBB.max = glm::max(primitiveSetBB.max, pos);
+				}
+				continue;
+			}
+
+			// get min and max
+			// (they are always specified for POSITION attribute and,
+			// since count is always >=1, they always contain valid value)
+			if(accessor.minSize == 0)
+				throw GltfError("Accessor.min must be defined for POSITION accessor.");
+			if(accessor.minSize != 3)
+				throw GltfError("POSITION's Accessor.min is not vector of three components.");
+			primitiveSetBB.min = glm::vec3(accessor.min[0], accessor.min[1], accessor.min[2]);
+			if(accessor.maxSize == 0)
+				throw GltfError("Accessor.max must be defined for POSITION accessor.");
+			if(accessor.maxSize != 3)
+				throw GltfError("POSITION's Accessor.max is not vector of three components.");
+			primitiveSetBB.max = glm::vec3(accessor.max[0], accessor.max[1], accessor.max[2]);
+
+		}
+		else if(it.key() == "NORMAL") {
+
+			// accessor
+			const GltfJson::Accessor& accessor = accessorList.at(it.value().get_ref<json::number_unsigned_t&>());
+
+			// accessor.type is mandatory and it must be VEC3 for normal accessor
+			if(accessor.type != GltfJson::AccessorType::Vec3)
+				throw GltfError("Normal attribute is not of VEC3 type.");
+
+			// accessor.componentType is mandatory and it must be FLOAT (5126) for normal accessor;
+			// KHR_mesh_quantization allows also normalized BYTE (5120) and normalized SHORT (5122)
+			normalComponentType = accessor.componentType;
+			bool normalized = accessor.normalized;
+			if(normalComponentType == 5126) {
+				if(normalized)
+					throw GltfError("Normal attribute normalized flag is true.");
+			}
+			else if(!meshQuantizationUsed || (normalComponentType != 5120 && normalComponentType != 5122))
+				throw GltfError("Normal attribute componentType is not float.");
+			else if(!normalized)
+				throw GltfError("Normal attribute of byte or short componentType does not have normalized flag set to true.");
+
+			// update numVertices
+			updateNumVertices(accessor, numVertices);
+
+			// normal data and stride
+			tie(reinterpret_cast<void*&>(normalData), normalDataStride) =
+				getDataPointerAndStride(accessor, numVertices, 3 * componentSize(normalComponentType));
+
+		}
+		else if(it.key() == "COLOR_0") {
+
+			// accessor
+			const GltfJson::Accessor& accessor = accessorList.at(it.value().get_ref<json::number_unsigned_t&>());
+
+			// accessor.type is mandatory and it must be VEC3 or VEC4 for color accessors
+			const GltfJson::AccessorType t = accessor.type;
+			if(t != GltfJson::AccessorType::Vec3 && t != GltfJson::AccessorType::Vec4)
+				throw GltfError("Color attribute is not of VEC3 or VEC4 type.");
+
+			// accessor.componentType is mandatory and it must be FLOAT (5126),
+			// UNSIGNED_BYTE (5121) or UNSIGNED_SHORT (5123) for color accessors
+			const unsigned ct = accessor.componentType;
+			if(ct != 5126 && ct != 5121 && ct != 5123)
+				throw GltfError("Color attribute componentType is not float, unsigned byte, or unsigned short.");
+			colorComponentType = ct;
+
+			// accessor.normalized is optional with default value false; it must be false for float componentType
+			if(!accessor.normalized) {
+				if(ct == 5121 || ct == 5123)
+					throw GltfError("Color attribute component type is set to unsigned byte or unsigned short while normalized flag is not true.");
+			}
+			else
+				if(ct == 5126)
+					throw GltfError("Color attribute component type is set to float while normalized flag is true.");
+
+			// update numVertices
+			updateNumVertices(accessor, numVertices);
+
+			// getColorFunc and elementSize
+			size_t elementSize;
+			if(t == GltfJson::AccessorType::Vec4)
+				switch(ct) {
+				case 5126: getColorFunc = getColorFromVec4f;  elementSize = 16; break;
+				case 5121: getColorFunc = getColorFromVec4ub; elementSize = 4;  break;
+				case 5123: getColorFunc = getColorFromVec4us; elementSize = 8;  break;
+				}
+			else // "VEC3"
+				switch(ct) {
+				case 5126: getColorFunc = getColorFromVec3f;  elementSize = 12; break;
+				case 5121: getColorFunc = getColorFromVec3ub; elementSize = 3;  break;
+				case 5123: getColorFunc = getColorFromVec3us; elementSize = 6;  break;
+				}
+
+			// color data and stride
+			tie(reinterpret_cast<void*&>(colorData), colorDataStride) =
+				getDataPointerAndStride(accessor, numVertices, elementSize);
+
+		}
+		else if(it.key().starts_with("TEXCOORD_")) {
+
+			// get texCoordIndex from TEXCOORD_[texCoordIndex] string
+			char* endp;
+			const char* startp = it.key().c_str();
+			unsigned texCoordIndex = strtoul(startp+9, &endp, 10);
+			if(endp-startp != std::ptrdiff_t(it.key().size()))
+				throw GltfError("TexCoord attribute name is invalid.");
+
+			// accessor
+			const GltfJson::Accessor& accessor = accessorList.at(it.value().get_ref<json::number_unsigned_t&>());
+
+			// accessor.type is mandatory and it must be VEC2 for texCoord accessors
+			if(accessor.type != GltfJson::AccessorType::Vec2)
+				throw GltfError("TexCoord attribute is not of VEC2 type.");
+
+			// accessor.componentType is mandatory and it must be FLOAT (5126),
+			// UNSIGNED_BYTE (5121) or UNSIGNED_SHORT (5123) for texCoord accessors;
+			// KHR_mesh_quantization allows also BYTE (5120) and SHORT (5122)
+			const unsigned ct = accessor.componentType;
+			if(ct != 5126 && ct != 5121 && ct != 5123)
+				if(!meshQuantizationUsed || (ct != 5120 && ct != 5122))
+					throw GltfError("TexCoord attribute componentType is not float, unsigned byte, or unsigned short.");
+
+			// accessor.normalized is optional with default value false; it must be false for float componentType;
+			// KHR_mesh_quantization allows integer component types without normalized flag
+			bool normalized = accessor.normalized;
+			if(normalized) {
+				if(ct == 5126)
+					throw GltfError("TexCoord attribute component type is set to float while normalized flag is true.");
+			}
+			else
+				if(ct != 5126 && !meshQuantizationUsed)
+					throw GltfError("TexCoord attribute component type is set to unsigned byte or unsigned short while normalized flag is not true.");
+
+			// update numVertices
+			updateNumVertices(accessor, numVertices);
+
+			// texCoord data and stride
+			uint8_t* texCoordData;
+			unsigned texCoordDataStride;
+			tie(reinterpret_cast<void*&>(texCoordData), texCoordDataStride) =
+				getDataPointerAndStride(accessor, numVertices, 2 * componentSize(ct));
+
+			// insert data into texCoordAttribInfoList
+			if(texCoordAttribInfoList.size() <= texCoordIndex) {
+				if(texCoordAttribInfoList.capacity() <= texCoordIndex)
+					texCoordAttribInfoList.reserve(max(size_t(texCoordIndex)+1, texCoordAttribInfoList.capacity()*2));
+				texCoordAttribInfoList.resize(size_t(texCoordIndex)+1, TexCoordAttribInfo{ nullptr, 0, 0, false });
+			}
+			texCoordAttribInfoList[texCoordIndex] =
+				TexCoordAttribInfo{ texCoordData, texCoordDataStride, ct, normalized };
+
+		}
+		else if(it.key() == "TANGENT") {
+
+			// accessor
+			const GltfJson::Accessor& accessor = accessorList.at(it.value().get_ref<json::number_unsigned_t&>());
+
+			// accessor.type is mandatory and it must be VEC4 for tangent accessor
+			if(accessor.type != GltfJson::AccessorType::Vec4)
+				throw GltfError("Tangent attribute is not of VEC4 type.");
+
+			// accessor.componentType is mandatory and it must be FLOAT (5126) for tangent accessor;
+			// KHR_mesh_quantization allows also normalized BYTE (5120) and normalized SHORT (5122)
+			tangentComponentType = accessor.componentType;
+			bool normalized = accessor.normalized;
+			if(tangentComponentType == 5126) {
+				if(normalized)
+					throw GltfError("Tangent attribute normalized flag is true.");
+			}
+			else if(!meshQuantizationUsed || (tangentComponentType != 5120 && tangentComponentType != 5122))
+				throw GltfError("Tangent attribute componentType is not float.");
+			else if(!normalized)
+				throw GltfError("Tangent attribute of byte or short componentType does not have normalized flag set to true.");
+
+			// update numVertices
+			updateNumVertices(accessor, numVertices);
+
+			// tangent data and stride
+			tie(reinterpret_cast<void*&>(tangentData), tangentDataStride) =
+				getDataPointerAndStride(accessor, numVertices, 4 * componentSize(tangentComponentType));
+
+		}
+		else
+			throw GltfError("Unsupported functionality: " + it.key() + " attribute.");
+	}
+
+	// vertex layout
+	// (with vertex compression, attributes are tightly packed on 4-byte alignment:
+	// positions as ushort3 quantized relative to the mesh bounding box (8 bytes)
+	// or as they come from KHR_mesh_quantization (4 or 8 bytes),
+	// normals and tangents in octahedral encoding (4 bytes), colors as ubyte4 or ushort4 (4 or 8 bytes),
+	// texCoords as half2, float2 or as they come from KHR_mesh_quantization (4 or 8 bytes);
+	// without vertex compression, each attribute occupies 16 bytes;
+	// position is always stored on offset 0)
+	const glm::vec4& meshDequantization = d.dequantization;
+	uint32_t& vertexSize = d.vertexSize;
+	auto appendAttrib =
+		[&vertexSize](uint16_t type, uint32_t size) -> uint16_t {
+			uint16_t accessInfo = type | uint16_t(vertexSize);
+			vertexSize += size;
+			return accessInfo;
+		};
+	uint16_t& positionAccessInfo = d.positionAccessInfo;
+	uint16_t& normalAccessInfo = d.normalAccessInfo;
+	uint16_t& tangentAccessInfo = d.tangentAccessInfo;
+	uint16_t& colorAccessInfo = d.colorAccessInfo;
+	array<uint16_t, CadPL::ShaderState::maxNumAttribs>& texCoordAccessInfoList = d.texCoordAccessInfoList;
+	if(positionData) {
+		if(!useVertexCompression)
+			positionAccessInfo = appendAttrib(0x2000, 16);  // float3, alignment 16
+		else
+			switch(positionComponentType) {
+			case 5126: positionAccessInfo = (meshDequantization.w != 0.f) ? appendAttrib(0x2c00, 8) : appendAttrib(0x2100, 12); break;  // quantized ushort3 normalized, or float3 alignment 4
+			case 5120: positionAccessInfo = appendAttrib(positionNormalized ? 0x3c00 : 0x3d00, 4); break;  // byte3
+			case 5121: positionAccessInfo = appendAttrib(positionNormalized ? 0x3400 : 0x3500, 4); break;  // ubyte3
+			case 5122: positionAccessInfo = appendAttrib(positionNormalized ? 0x3000 : 0x3100, 8); break;  // short3
+			case 5123: positionAccessInfo = appendAttrib(positionNormalized ? 0x2c00 : 0x2d00, 8); break;  // ushort3
+			}
+	}
+	if(normalData)
+		normalAccessInfo = useVertexCompression ? appendAttrib(0x4400, 4) : appendAttrib(0x2000, 16);  // octahedral or float3
+	if(tangentData)
+		tangentAccessInfo = useVertexCompression ? appendAttrib(0x4400, 4) : appendAttrib(0x2000, 16);  // octahedral or float3 (w is ignored by the shaders)
+	if(colorData) {
+		if(!useVertexCompression)
+			colorAccessInfo = appendAttrib(0x0100, 16);  // float4
+		else
+			colorAccessInfo = (colorComponentType == 5123) ? appendAttrib(0x0b00, 8) : appendAttrib(0x1500, 4);  // ushort4 or ubyte4, normalized
+	}
+	for(size_t i=0,c=texCoordAttribInfoList.size(); i<c && i<texCoordAccessInfoList.size(); i++) {
+		TexCoordAttribInfo& t = texCoordAttribInfoList[i];
+		if(t.data == nullptr)
+			throw GltfError("Invalid texture coordinate attributes.");
+		if(!useVertexCompression)
+			texCoordAccessInfoList[i] = appendAttrib(0x5000, 16);  // float2, alignment 8
+		else
+			switch(t.componentType) {
+			case 5126: {
+
+				// half2 if all coordinates are in -1..1 range where half precision
+				// is at least 1/2048, float2 otherwise
+				bool useHalf = true;
+				uint8_t* srcPtr = t.data;
+				for(size_t j=0; j<numVertices; j++, srcPtr+=t.stride) {
+					glm::vec2 uv = *reinterpret_cast<glm::vec2*>(srcPtr);
+					if(!(abs(uv.x) <= 1.f && abs(uv.y) <= 1.f)) {
+						useHalf = false;
+						break;
+					}
+				}
+				texCoordAccessInfoList[i] = useHalf ? appendAttrib(0x5200, 4) : appendAttrib(0x5100, 8);
+				break;
+			}
+			case 5120: texCoordAccessInfoList[i] = appendAttrib(t.normalized ? 0x6c00 : 0x6d00, 4); break;  // byte2
+			case 5121: texCoordAccessInfoList[i] = appendAttrib(t.normalized ? 0x6400 : 0x6500, 4); break;  // ubyte2
+			case 5122: texCoordAccessInfoList[i] = appendAttrib(t.normalized ? 0x6000 : 0x6100, 4); break;  // short2
+			case 5123: texCoordAccessInfoList[i] = appendAttrib(t.normalized ? 0x5c00 : 0x5d00, 4); break;  // ushort2
+			}
+	}
+	if(vertexSize > 0x1fc)
+		throw GltfError("Too large vertex size.");
+
+	// indices
+	// (they are optional)
+	size_t& numIndices = d.numIndices;
+	void*& indexData = d.indexData;
+	unsigned& indexComponentType = d.indexComponentType;
+	if(auto indicesIt=primitive.find("indices"); indicesIt!=primitive.end()) {
+
+		// accessor
+		const GltfJson::Accessor& accessor = accessorList.at(indicesIt.value().get_ref<json::number_unsigned_t&>());
+
+		// accessor.type is mandatory and it must be SCALAR for index accessors
+		if(accessor.type != GltfJson::AccessorType::Scalar)
+			throw GltfError("Indices are not of SCALAR type.");
+
+		// accessor.componentType is mandatory and it must be UNSIGNED_INT (5125) for index accessors;
+		// unsigned short and unsigned byte component types seems not allowed by the spec
+		// but they are used in Khronos sample models, for example Box.gltf
+		// (https://github.com/KhronosGroup/glTF-Sample-Models/blob/main/2.0/Box/glTF/Box.gltf)
+		indexComponentType = accessor.componentType;
+		if(indexComponentType != 5125 && indexComponentType != 5123 && indexComponentType != 5121)
+			throw GltfError("Index componentType is not unsigned int, unsigned short or unsigned byte.");
+
+		// accessor.normalized is optional and must be false for index accessor
+		if(accessor.normalized)
+			throw GltfError("Indices cannot have normalized flag set to true.");
+
+		// get index count (accessor.count is mandatory and >=1)
+		numIndices = accessor.count;
+		if(numIndices == 0)
+			throw GltfError("Accessor's count member must be greater than zero.");
+
+		// index data
+		size_t elementSize;
+		switch(indexComponentType) {
+		case 5125: elementSize = sizeof(uint32_t); break;
+		case 5123: elementSize = sizeof(uint16_t); break;
+		case 5121: elementSize = sizeof(uint8_t); break;
+		}
+		size_t tmp;
+		tie(indexData, tmp) =
+			getDataPointerAndStride(accessor, numIndices, elementSize);
+	}
+	else {
+		numIndices = numVertices;
+		indexData = nullptr;
+	}
+
+	// ignore empty primitives
+	if(indexData == nullptr && numVertices == 0) {
+		d.empty = true;
+		return;
+	}
+
+	// verify texture data count
+	// (validity of texture data was verified when computing vertex layout)
+	if(texCoordAttribInfoList.size()+4 >= CadPL::ShaderState::maxNumAttribs)
+		throw GltfError("Too many texture coordinate attributes.");
+
+	// mesh.primitive.mode is optional with default value 4 (TRIANGLES)
+	unsigned mode = unsigned(primitive.value<json::number_unsigned_t>("mode", 4));
+	d.mode = mode;
+
+	// number of indices after conversion of strips, fans and loops into lists
+	switch(mode) {
+	case 4:  // TRIANGLES
+		if(numIndices < 3)
+			throw GltfError("Invalid number of indices for TRIANGLES.");
+		break;
+	case 1:  // LINES
+		if(numIndices < 2)
+			throw GltfError("Invalid number of indices for LINES.");
+		break;
+	case 0:  // POINTS
+		if(numIndices < 1)
+			throw GltfError("Invalid number of indices for POINTS.");
+		break;
+	case 5:  // TRIANGLE_STRIP
+		if(numIndices < 3)
+			throw GltfError("Invalid number of indices for TRIANGLE_STRIP.");
+		numIndices = (numIndices-2) * 3;
+		break;
+	case 6:  // TRIANGLE_FAN
+		if(numIndices < 3)
+			throw GltfError("Invalid number of indices for TRIANGLE_FAN.");
+		numIndices = (numIndices-2) * 3;
+		break;
+	case 3:  // LINE_STRIP
+		if(numIndices < 2)
+			throw GltfError("Invalid number of indices for LINE_STRIP.");
+		numIndices = (numIndices-1) * 2;
+		break;
+	case 2:  // LINE_LOOP
+		if(numIndices < 2)
+			throw GltfError("Invalid number of indices for LINE_LOOP.");
+		numIndices = numIndices * 2;
+		break;
+	default:
+		throw GltfError("Invalid value for mesh.primitive.mode.");
+	}
+	if(indexData == nullptr && numIndices >= size_t((~uint32_t(0))-1)) // value 0xffffffff is forbidden, thus (~0)-1
+		throw GltfError("Too large primitive. Index out of 32-bit integer range.");
+
+	// 16-bit indices are used whenever all the vertices can be addressed by them,
+	// otherwise 32-bit indices are used
+	d.use16BitIndices = numVertices <= 0x10000;
+}
+
+
+void Loader::fillPrimitiveStagingData(PrimitiveData& d)
+{
+	if(d.empty)
+		return;
+
+	// attribute data
+	// (local copies of data pointers are advanced while the vertices are processed)
+	const bool useVertexCompression = _settings.useVertexCompression;
+	const glm::vec4& meshDequantization = d.dequantization;
+	size_t numVertices = d.numVertices;
+	uint32_t vertexSize = d.vertexSize;
+	uint8_t* positionData = d.positionData;
+	uint8_t* normalData = d.normalData;
+	uint8_t* tangentData = d.tangentData;
+	uint8_t* colorData = d.colorData;
+	const unsigned positionDataStride = d.positionDataStride;
+	const unsigned normalDataStride = d.normalDataStride;
+	const unsigned tangentDataStride = d.tangentDataStride;
+	const unsigned colorDataStride = d.colorDataStride;
+	const unsigned positionComponentType = d.positionComponentType;
+	const unsigned normalComponentType = d.normalComponentType;
+	const unsigned tangentComponentType = d.tangentComponentType;
+	const unsigned colorComponentType = d.colorComponentType;
+	const bool positionNormalized = d.positionNormalized;
+	glm::vec4 (*getColorFunc)(uint8_t* srcPtr) = d.getColorFunc;
+	const uint16_t positionAccessInfo = d.positionAccessInfo;
+	const uint16_t normalAccessInfo = d.normalAccessInfo;
+	const uint16_t tangentAccessInfo = d.tangentAccessInfo;
+	const uint16_t colorAccessInfo = d.colorAccessInfo;
+	const array<uint16_t, CadPL::ShaderState::maxNumAttribs>& texCoordAccessInfoList = d.texCoordAccessInfoList;
+	using TexCoordAttribInfo = PrimitiveData::TexCoordAttribInfo;
+	vector<TexCoordAttribInfo> texCoordAttribInfoList = d.texCoordAttribInfoList;
+
+	// matrix baking of merged primitives
+	const bool bake = d.mergeGroupIndex != ~size_t(0);
+	const glm::mat4& bakeMatrix = d.bakeMatrix;
+	const glm::mat3& bakeNormalMatrix = d.bakeNormalMatrix;
+
+	// prepare for computing primitiveSet bounding sphere
+	// (float positions are processed by the batched SIMD kernel after the vertex loop,
+	// quantized and baked positions are processed in the loop)
+	const bool batchedBS = positionData && positionComponentType == 5126 && !bake;
+	CadR::BoundingSphere primitiveSetBS{
+		.center = positionData ? d.primitiveSetBB.getCenter() : glm::vec3(0.f, 0.f, 0.f),
+		.radius = 0.f,  // actually, radius^2 is stored here in the following loop as an performance optimization
+	};
+
+	// set vertex data
+	// (padding bytes are zeroed to not leave uninitialized memory in the buffer)
+	uint8_t* p = d.vertexStagingData;
+	memset(p, 0, numVertices * vertexSize);
+	for(size_t i=0; i<numVertices; i++, p+=vertexSize) {
+		if(positionData) {
+
+			// copy position
+			// (quantized data of KHR_mesh_quantization are copied as they are)
+			glm::vec3 pos = readVec3(positionData, positionComponentType, positionNormalized);
+			if(bake)
+				pos = glm::vec3(bakeMatrix * glm::vec4(pos, 1.f));
+			uint8_t* dst = p + (positionAccessInfo & 0x00ff);
+			if(!useVertexCompression)
+				*reinterpret_cast<glm::vec4*>(dst) = glm::vec4(pos.x, pos.y, pos.z, 1.f);
+			else if(positionComponentType != 5126)
+				memcpy(dst, positionData, 3 * componentSize(positionComponentType));
+			else if(meshDequantization.w != 0.f) {
+				glm::vec3 q = glm::clamp((pos - glm::vec3(meshDequantization)) / meshDequantization.w, 0.f, 1.f);
+				uint16_t* v = reinterpret_cast<uint16_t*>(dst);
+				v[0] = uint16_t(q.x * 65535.f + 0.5f);
+				v[1] = uint16_t(q.y * 65535.f + 0.5f);
+				v[2] = uint16_t(q.z * 65535.f + 0.5f);
+			}
+			else
+				*reinterpret_cast<glm::vec3*>(dst) = pos;
+			positionData += positionDataStride;
+
+			// update bounding sphere
+			// (square of radius is stored in primitiveBS.radius)
+			if(!batchedBS)
+				primitiveSetBS.extendRadiusByPointUsingRadius2(pos);
+
+		}
+		if(normalData) {
+			glm::vec3 normal = readVec3(normalData, normalComponentType, true);
+			if(bake)
+				normal = bakeDirection(bakeNormalMatrix, normal);
+			uint8_t* dst = p + (normalAccessInfo & 0x00ff);
+			if(useVertexCompression)
+				*reinterpret_cast<uint32_t*>(dst) = encodeOctahedral(normal);
+			else
+				*reinterpret_cast<glm::vec4*>(dst) = glm::vec4(normal.x, normal.y, normal.z, 0.f);
+			normalData += normalDataStride;
+		}
+		if(tangentData) {
+			glm::vec3 tangent = readVec3(tangentData, tangentComponentType, true);
+			if(bake)
+				tangent = bakeDirection(glm::mat3(bakeMatrix), tangent);
+			uint8_t* dst = p + (tangentAccessInfo & 0x00ff);
+			if(useVertexCompression)
+				*reinterpret_cast<uint32_t*>(dst) = encodeOctahedral(tangent);
+			else
+				*reinterpret_cast<glm::vec4*>(dst) =
+					glm::vec4(tangent, readComponent(tangentData + 3*componentSize(tangentComponentType), tangentComponentType, true));
+			tangentData += tangentDataStride;
+		}
+		if(colorData) {
+			glm::vec4 color = getColorFunc(colorData);
+			uint8_t* dst = p + (colorAccessInfo & 0x00ff);
+			if(!useVertexCompression)
+				*reinterpret_cast<glm::vec4*>(dst) = color;
+			else if(colorComponentType == 5123)
+				*reinterpret_cast<glm::u16vec4*>(dst) = glm::u16vec4(color * 65535.f + 0.5f);
+			else
+				*reinterpret_cast<uint32_t*>(dst) = glm::packUnorm4x8(color);
+			colorData += colorDataStride;
+		}
+		for(size_t j=0,c=texCoordAttribInfoList.size(); j<c; j++) {
+			TexCoordAttribInfo& t = texCoordAttribInfoList[j];
+			uint8_t* dst = p + (texCoordAccessInfoList[j] & 0x00ff);
+			if(!useVertexCompression) {
+				unsigned s = componentSize(t.componentType);
+				*reinterpret_cast<glm::vec2*>(dst) =
+					glm::vec2(readComponent(t.data, t.componentType, t.normalized),
+					          readComponent(t.data + s, t.componentType, t.normalized));
+			}
+			else if(t.componentType != 5126)
+				memcpy(dst, t.data, 2 * componentSize(t.componentType));
+			else if((texCoordAccessInfoList[j] & 0xff00) == 0x5200)
+				*reinterpret_cast<uint32_t*>(dst) = glm::packHalf2x16(*reinterpret_cast<glm::vec2*>(t.data));
+			else
+				*reinterpret_cast<glm::vec2*>(dst) = *reinterpret_cast<glm::vec2*>(t.data);
+			t.data += t.stride;
+		}
+	}
+
+	// primitiveSet bounding sphere
+	// (convert square of radius stored in primitiveBS.radius back to radius)
+	primitiveSetBS.radius = sqrt(primitiveSetBS.radius);
+	if(batchedBS)
+		primitiveSetBS.extendRadiusByPoints(d.positionData, numVertices, positionDataStride);
+	d.primitiveSetBS = primitiveSetBS;
+
+	// index data
+	const unsigned mode = d.mode;
+	const size_t numIndices = d.numIndices;
+	void* indexData = d.indexData;
+	const unsigned indexComponentType = d.indexComponentType;
+
+	// set index data
+	// (staging memory was already reserved, including padding of 16-bit index data)
+	auto createIndices =
+		[&]<typename D>() -> void {
+		if(mode == 4 || mode == 1 || mode == 0) {
+
+			// POINTS, LINES, TRIANGLES - copy indices directly,
+			// while converting them to the index type D
+			size_t indexDataSize = numIndices * sizeof(D);
+			D* pi = static_cast<D*>(d.indexStagingData);
+			if(indexData)
+				switch(indexComponentType) {
+				case 5125: {
+					if constexpr(sizeof(D) == sizeof(uint32_t))
+						memcpy(pi, indexData, indexDataSize);
+					else
+						for(size_t i=0; i<numIndices; i++)
+							pi[i] = D(reinterpret_cast<uint32_t*>(indexData)[i]);
+					break;
+				}
+				case 5123: {
+					if constexpr(sizeof(D) == sizeof(uint16_t))
+						memcpy(pi, indexData, indexDataSize);
+					else
+						for(size_t i=0; i<numIndices; i++)
+							pi[i] = reinterpret_cast<uint16_t*>(indexData)[i];
+					break;
+				}
+				case 5121: {
+					for(size_t i=0; i<numIndices; i++)
+						pi[i] = reinterpret_cast<uint8_t*>(indexData)[i];
+					break;
+				}
+				}
+			else {
+				for(uint32_t i=0; i<uint32_t(numIndices); i++)
+					pi[i] = i;
+			}
+		}
+		else if(mode == 5) {
+
+			// TRIANGLE_STRIP - convert strip indices to indices of separate triangles
+			// while considering even and odd triangle ordering
+			D* stgIndices = static_cast<D*>(d.indexStagingData);
+			if(indexData) {
+
+				// create new indices
+				auto createTriangleStripIndices =
+					[]<typename T>(D* dst, void* srcPtr, size_t numIndices) {
+
+						T* src = reinterpret_cast<T*>(srcPtr);
+						D* dstEnd = dst + numIndices;
+						uint32_t v1 = *src;
+						src++;
+						uint32_t v2 = *src;
+						src++;
+						uint32_t v3 = *src;
+						src++;
+						while(true) {
+
+							// odd triangle
+							*dst = v1;
+							dst++;
+							*dst = v2;
+							dst++;
+							*dst = v3;
+							dst++;
+							if(dst == dstEnd)
+								break;
+							v1 = v2;
+							v2 = v3;
+							v3 = *src;
+							src++;
+
+							// even triangle
+							*dst = v2;
+							dst++;
+							*dst = v1;
+							dst++;
+							*dst = v3;
+							dst++;
+							if(dst == dstEnd)
+								break;
+							v1 = v2;
+							v2 = v3;
+							v3 = *src;
+							src++;
+						}
+					};
+				switch(indexComponentType) {
+				case 5125: createTriangleStripIndices.template operator()<uint32_t>(stgIndices, indexData, numIndices); break;
+				case 5123: createTriangleStripIndices.template operator()<uint16_t>(stgIndices, indexData, numIndices); break;
+				case 5121: createTriangleStripIndices.template operator()<uint8_t >(stgIndices, indexData, numIndices); break;
+				}
+			}
+			else {
+
+				// generate indices
+
+				uint32_t i = 0;
+				uint32_t v1 = i;
+				i++;
+				uint32_t v2 = i;
+				i++;
+				uint32_t v3 = i;
+				i++;
+				D* e = stgIndices + numIndices;
+				while(true) {
+
+					// odd triangle
+					*stgIndices = v1;
+					stgIndices++;
+					*stgIndices = v2;
+					stgIndices++;
+					*stgIndices = v3;
+					stgIndices++;
+					if(stgIndices == e)
+						break;
+					v1 = v2;
+					v2 = v3;
+					v3 = i;
+					i++;
+
+					// even triangle
+					*stgIndices = v2;
+					stgIndices++;
+					*stgIndices = v1;
+					stgIndices++;
+					*stgIndices = v3;
+					stgIndices++;
+					if(stgIndices == e)
+						break;
+					v1 = v2;
+					v2 = v3;
+					v3 = i;
+					i++;
+				}
+			}
+		}
+		else if(mode == 6) {
+
+			// TRIANGLE_FAN
+			D* stgIndices = static_cast<D*>(d.indexStagingData);
+			if(indexData) {
+
+				// create new indices
+				auto createTriangleStripIndices =
+					[]<typename T>(D* dst, void* srcPtr, size_t numIndices) {
+
+						T* src = reinterpret_cast<T*>(srcPtr);
+						D* dstEnd = dst + numIndices;
+						uint32_t v1 = *src;
+						src++;
+						uint32_t v2 = *src;
+						src++;
+						uint32_t v3 = *src;
+						src++;
+						while(true) {
+							*dst = v1;
+							dst++;
+							*dst = v2;
+							dst++;
+							*dst = v3;
+							dst++;
+							if(dst == dstEnd)
+								break;
+							v2 = v3;
+							v3 = *src;
+							src++;
+						}
+					};
+				switch(indexComponentType) {
+				case 5125: createTriangleStripIndices.template operator()<uint32_t>(stgIndices, indexData, numIndices); break;
+				case 5123: createTriangleStripIndices.template operator()<uint16_t>(stgIndices, indexData, numIndices); break;
+				case 5121: createTriangleStripIndices.template operator()<uint8_t >(stgIndices, indexData, numIndices); break;
+				}
+			}
+			else {
+
+				// generate indices
+
+				uint32_t i = 0;
+				uint32_t v1 = i;
+				i++;
+				uint32_t v2 = i;
+				i++;
+				uint32_t v3 = i;
+				i++;
+				D* e = stgIndices + numIndices;
+				while(true) {
+					*stgIndices = v1;
+					stgIndices++;
+					*stgIndices = v2;
+					stgIndices++;
+					*stgIndices = v3;
+					stgIndices++;
+					if(stgIndices == e)
+						break;
+					v2 = v3;
+					v3 = i;
+					i++;
+				}
+			}
+		}
+		else if(mode == 3) {
+
+			// LINE_STRIP
+			D* stgIndices = static_cast<D*>(d.indexStagingData);
+			if(indexData) {
+
+				// create new indices
+				auto createLineStripIndices =
+					[]<typename T>(D* dst, void* srcPtr, size_t numIndices) {
+						T* src = reinterpret_cast<T*>(srcPtr);
+						*dst = *src;
+						D* dstEnd = dst + (numIndices-1);
+						dst++; src++;
+						while(dst < dstEnd) {
+							*dst = *src;
+							dst++;
+							*dst = *src;
+							dst++; src++;
+						}
+						*dst = *src;
+					};
+				switch(indexComponentType) {
+				case 5125: createLineStripIndices.template operator()<uint32_t>(stgIndices, indexData, numIndices); break;
+				case 5123: createLineStripIndices.template operator()<uint16_t>(stgIndices, indexData, numIndices); break;
+				case 5121: createLineStripIndices.template operator()<uint8_t >(stgIndices, indexData, numIndices); break;
+				}
+			}
+			else {
+
+				// generate indices
+				uint32_t i = 0;
+				*stgIndices = i;
+				D* e = stgIndices + (numIndices-1);
+				stgIndices++;
+				i++;
+				while(stgIndices < e) {
+					*stgIndices = i;
+					stgIndices++;
+					*stgIndices = i;
+					stgIndices++;
+					i++;
+				}
+				*stgIndices = i;
+			}
+		}
+		else if(mode == 2) {
+
+			// LINE_LOOP
+			D* stgIndices = static_cast<D*>(d.indexStagingData);
+			if(indexData) {
+
+				// create new indices
+				auto createLineLoopIndices =
+					[]<typename T>(D* dst, void* srcPtr, size_t numIndices) {
+						T* src = reinterpret_cast<T*>(srcPtr);
+						uint32_t firstValue = *src;
+						*dst = *src;
+						D* dstEnd = dst + (numIndices-1);
+						dst++; src++;
+						while(dst < dstEnd) {
+							*dst = *src;
+							dst++;
+							*dst = *src;
+							dst++; src++;
+						}
+						*dst = firstValue;
+					};
+				switch(indexComponentType) {
+				case 5125: createLineLoopIndices.template operator()<uint32_t>(stgIndices, indexData, numIndices); break;
+				case 5123: createLineLoopIndices.template operator()<uint16_t>(stgIndices, indexData, numIndices); break;
+				case 5121: createLineLoopIndices.template operator()<uint8_t >(stgIndices, indexData, numIndices); break;
+				}
+			}
+			else {
+
+				// generate indices
+				uint32_t i = 0;
+				*stgIndices = i;
+				D* e = stgIndices + (numIndices-1);
+				stgIndices++;
+				i++;
+				while(stgIndices < e) {
+					*stgIndices = i;
+					stgIndices++;
+					*stgIndices = i;
+					stgIndices++;
+					i++;
+				}
+				*stgIndices = 0;
+			}
+		}
+		else
+			throw GltfError("Invalid value for mesh.primitive.mode.");
+		};
+	if(d.use16BitIndices)
+		createIndices.operator()<uint16_t>();
+	else
+		createIndices.operator()<uint32_t>();
+
+	// reorder triangles for vertex cache locality and reduced overdraw
+	// and generate simplified levels of detail
+	// (positions are used for overdraw sorting and simplification only, so they are not dequantized;
+	// each level is simplified from the previous one while the simplifier state
+	// keeps the errors measured against the full detail mesh)
+	if(mode >= 4 && (_settings.optimizeVertexCache || d.generateLods)) {
+		vector<glm::vec3> positions;
+		if(d.positionData) {
+			positions.resize(d.numVertices);
+			for(size_t i=0; i<d.numVertices; i++)
+				positions[i] = readVec3(d.positionData + i*d.positionDataStride, d.positionComponentType, d.positionNormalized);
+		}
+		const glm::vec3* positionPtr = positions.empty() ? nullptr : positions.data();
+		auto processTriangles =
+			[&]<typename T>() {
+				T* indices = static_cast<T*>(d.indexStagingData);
+				if(_settings.optimizeVertexCache) {
+					d.numCacheMissesBefore = VertexCacheOptimizer::countCacheMisses(indices, numIndices, d.numVertices);
+					VertexCacheOptimizer::optimize(indices, numIndices, d.numVertices, positionPtr);
+					d.numCacheMissesAfter = VertexCacheOptimizer::countCacheMisses(indices, numIndices, d.numVertices);
+				}
+				if(!d.generateLods)
+					return;
+				vector<T> lodIndices;
+				vector<T> levelIndices(numIndices);
+				const T* src = indices;
+				size_t n = numIndices;
+				MeshSimplifier::State simplifierState;
+				for(unsigned level=0, c=min(_settings.numLodLevels, LoaderSettings::maxNumLodLevels); level<c; level++) {
+					size_t targetNumIndices = size_t(float(n / 3) * _settings.lodReductionRatio) * 3;
+					float error;
+					size_t count = MeshSimplifier::simplify(levelIndices.data(), src, n, positionPtr, d.numVertices,
+					                                        targetNumIndices, error, &simplifierState);
+					if(count == 0 || count > n * 4 / 5)
+						break;
+					if(_settings.optimizeVertexCache)
+						VertexCacheOptimizer::optimize(levelIndices.data(), count, d.numVertices, positionPtr);
+					size_t first = lodIndices.size();
+					lodIndices.insert(lodIndices.end(), levelIndices.begin(), levelIndices.begin() + count);
+					d.lodLevelList.push_back({ .primitiveSetOffset = 0, .numIndices = uint32_t(count), .error = error });
+					src = &lodIndices[first];
+					n = count;
+				}
+				d.lodIndexData.resize(lodIndices.size() * sizeof(T));
+				memcpy(d.lodIndexData.data(), lodIndices.data(), d.lodIndexData.size());
+			};
+		if(d.use16BitIndices)
+			processTriangles.operator()<uint16_t>();
+		else
+			processTriangles.operator()<uint32_t>();
+	}
+
+	// rebase indices of merged primitive
+	CadR::GeometryMerger::rebaseIndices(d.indexStagingData, numIndices, d.use16BitIndices, d.baseVertex);
+}
+
+
+void Loader::computeSceneBoundingSphere()
+{
+	// scene bounding box
+	// (sceneBB might be valid or even completely empty)
+	CadR::BoundingBox sceneBB = _meshBoundingSphereList[0].getBoundingBox();
+	for(size_t i=1, c=_meshBoundingSphereList.size(); i<c; i++)
+		sceneBB.extendBy(_meshBoundingSphereList[i].getBoundingBox());
+
+	// scene bounding sphere
+	// (generate valid sceneBoundingSphere although sceneBB might be empty,
+	// and meshBoundingSphereList might contain empty spheres)
+	if(sceneBB.isEmpty())
+		_sceneBoundingSphere = { .center = glm::vec3(0.f, 0.f, 0.f), .radius = 0.f };
+	else {
+		_sceneBoundingSphere.center = sceneBB.getCenter();
+		_sceneBoundingSphere.radius = 0.f;
+		for(size_t i=0, c=_meshBoundingSphereList.size(); i<c; i++)
+			_sceneBoundingSphere.extendRadiusBy(_meshBoundingSphereList[i]);
+		_sceneBoundingSphere.radius *= 1.001f;  // increase radius to accommodate for all floating computations imprecisions
+	}
+}
+
+
+void Loader::upload()
+{
+	// upload all staging buffers
+	_renderer->executeCopyOperations();
+
+	// worker threads are not needed any more
+	stopWorkerThreads();
+
+	// release data no longer needed
+	// (geometry and textures live in DataStorage and ImageStorage from now on)
+	_bufferDataList.clear();
+	_bufferDataList.shrink_to_fit();
+	_meshoptDecodedData.reset();
+	_mappedFileList.clear();
+	_mappedFileList.shrink_to_fit();
+	_glbBinChunkData = nullptr;
+	_glbBinChunkSize = 0;
+	_gltfFile.close();
+	_gltfJson = {};
+	_newGltfItems = nullptr;
+	_extensionsUsed = nullptr;
+	_scenes = nullptr;
+	_meshes = nullptr;
+	_buffers = nullptr;
+	_materials = nullptr;
+	_textures = nullptr;
+	_images = nullptr;
+	_samplers = nullptr;
+	_meshMatrixList.clear();
+	_meshInstancedNodeList.clear();
+	_meshNumInstancesList.clear();
+	_meshDequantizationList.clear();
+	_stateSetMaterialDataList.clear();
+	reportProgress(LoaderStage::Upload, 1, 1);
+}
+
+
+void Loader::load(const filesystem::path& filePath)
+{
+	parse(filePath);
+	resolveBuffers();
+	decodeImages();
+	buildGeometry();
+	upload();
+}
@@ -0,0 +1,309 @@
+// SPDX-FileCopyrightText: 2019-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <nlohmann/json.hpp>
+#include <CadR/BoundingSphere.h>
+#include <CadR/DataAllocation.h>
+#include <CadR/Drawable.h>
+#include <CadR/Geometry.h>
+#include <CadR/GeometryMerger.h>
+#include <CadR/ImageAllocation.h>
+#include <CadR/MatrixList.h>
+#include <CadR/Texture.h>
+#include <CadPL/PipelineSceneGraph.h>
+#include <CadGltf/GltfJson.h>
+#include <CadGltf/MappedFile.h>
+
+namespace CadR {
+	class Renderer;
+	class StateSet;
+	class VulkanInstance;
+}
+
+namespace CadGltf {
+
+
+enum class MaterialModel { Unknown, BlinPhong = 0x1, MetallicRoughness = 0x2 };
+
+
+/** Loading stages in the order they need to be called.
+ *  Parse, ResolveBuffers and DecodeImages do not touch the renderer
+ *  and they might run on a worker thread while the application renders frames.
+ *  BuildGeometry and Upload use DataStorage and ImageStorage of the renderer, that are not thread-safe,
+ *  so they must not run concurrently with any other use of the renderer.
+ */
+enum class LoaderStage {
+	Parse,  //< Parses json and processes scene description: nodes, instancing matrices, materials and texture usage.
+	ResolveBuffers,  //< Reads glTF buffers.
+	DecodeImages,  //< Reads, decodes and deduplicates images and optionally compresses them into BCn formats.
+	BuildGeometry,  //< Creates materials, images, textures, Geometries, StateSets and Drawables. It might be split into multiple calls, each processing a few meshes, so the frames can be rendered in between. Primitives are processed by worker threads, while DataStorage is used only by the calling thread.
+	Upload,  //< Submits all the remaining staging data and releases the data no longer needed.
+};
+
+
+struct LoaderSettings {
+	MaterialModel materialModel = MaterialModel::MetallicRoughness;
+	bool useVertexCompression = true;  //< Stores vertex attributes in compact and quantized formats instead of 16 bytes per attribute.
+	bool useTextureAtlas = true;  //< Packs small textures into texture atlases.
+	bool useTextureCompression = false;  //< Compresses uncompressed textures into BCn formats.
+	std::filesystem::path textureCacheDirectory;  //< Directory for caching of compressed textures. Empty path disables the cache.
+	float maxSamplerAnisotropy = 1.f;
+	bool transparencySupported = true;  //< If false, materials with BLEND alpha mode throw an exception.
+	std::bitset<CadPL::ShaderState::numOptimizeFlags> optimizeFlags = CadPL::ShaderState::OptimizeNone;  //< ShaderState::optimizeFlags of all created StateSets.
+	CadPL::PipelineState pipelineState;  //< Template for PipelineState of created StateSets. Rasterization samples, color attachments, render pass and attachment formats are taken from here while culling, depth writes and blending are set according to each material.
+	std::function<CadR::StateSet&(const CadPL::ShaderState&, const CadPL::PipelineState&)> getOrCreateStateSetFunc;  //< Function returning StateSet for the given states. If not set, PipelineSceneGraph::getOrCreateStateSet() is used.
+	unsigned numThreads = 0;  //< Number of threads processing mesh primitives in buildGeometry(), including the calling thread. Zero means std::thread::hardware_concurrency().
+	bool mergeStaticPrimitives = false;  //< Merges small primitives of non-instanced meshes sharing StateSet and material into shared Geometries rendered by a single Drawable. The mesh matrices are baked into vertex data, so the merged meshes cannot be moved individually. Merging is performed among the meshes processed by the same buildGeometry() call. See Loader::mergedDrawableList() for picking.
+	uint32_t mergeMaxNumVertices = 4096;  //< Primitives with more vertices are not merged. Meshes containing such primitives are not merged at all.
+	bool streamingJsonParse = true;  //< Parses json by SAX parser that stores nodes, accessors and bufferViews directly in compact typed lists without building their DOM. It reduces memory consumption and parse time of large files. If false, DOM of the whole json is built first and then converted.
+	bool optimizeVertexCache = false;  //< Reorders triangles of each primitive by Tipsify algorithm for post-transform vertex cache locality and sorts the resulting triangle clusters to reduce overdraw. Average cache miss ratio (ACMR) before and after the optimization is logged. The reuse takes effect only with indexed draws, see CadPL::PipelineSceneGraph::setIndexedDraw().
+	static constexpr const unsigned maxNumLodLevels = 4;
+	unsigned numLodLevels = 0;  //< Number of simplified levels of detail generated for each triangle primitive, up to maxNumLodLevels. The levels are stored as additional PrimitiveSets of the primitive's Geometry, so they share its vertex data. Merged primitives and primitives of less than 64 triangles are not simplified. See Loader::lodDrawableList() for their selection.
+	float lodReductionRatio = 0.5f;  //< Target ratio of the triangle counts of consecutive levels of detail. The generation of further levels stops when the simplification does not reduce the triangle count by at least 20%.
+};
+
+
+/** Drawable created by merging of static primitives.
+ *  See LoaderSettings::mergeStaticPrimitives.
+ */
+struct MergedDrawable {
+	size_t drawableIndex;  //< Index into Loader::drawableList().
+	CadR::GeometryMerger merger;  //< Sub-draws of the Drawable. Use merger.findSubDraw() to map gl_PrimitiveID from id-buffer to the sub-draw.
+	std::vector<std::pair<size_t,size_t>> sourcePrimitiveList;  //< glTF mesh index and primitive index of each sub-draw.
+};
+
+
+/** Drawable with simplified levels of detail.
+ *  See LoaderSettings::numLodLevels.
+ */
+struct LodDrawable {
+	struct Level {
+		uint32_t primitiveSetOffset;  //< PrimitiveSet of the level. Pass it to CadR::Drawable::setPrimitiveSetOffset() to render the level.
+		uint32_t numIndices;
+		float error;  //< Geometric error of the level in the coordinate space of glTF mesh, i.e. before node transformations are applied. Multiply it by the scale of node matrix and by the projection scale divided by the distance to get the error in pixels.
+	};
+	size_t drawableIndex;  //< Index into Loader::drawableList().
+	std::vector<Level> levelList;  //< Levels starting by the full detail level of zero error, followed by the simplified levels of increasing error.
+	size_t selectLevel(float errorScale, float maxError) const;  //< Returns index of the coarsest level whose error multiplied by errorScale does not exceed maxError.
+};
+
+
+class CADGLTF_EXPORT Loader {
+public:
+	typedef std::function<void(LoaderStage stage, size_t numDone, size_t numTotal)> ProgressCallback;
+	typedef std::function<void(const std::string& message)> LogCallback;
+protected:
+
+	CadR::Renderer* _renderer;
+	CadR::VulkanInstance* _vulkanInstance;
+	vk::PhysicalDevice _physicalDevice;
+	CadPL::PipelineSceneGraph* _pipelineSceneGraph;
+	CadR::StateSet* _textureStateSet;  //< StateSet that receives descriptor set of all the textures. Its pipeline must use PipelineSceneGraph's pipeline layout.
+	LoaderSettings _settings;
+	ProgressCallback _progressCallback;
+	LogCallback _logCallback;
+
+	// parse stage
+	std::filesystem::path _filePath;
+	MappedFile _gltfFile;  //< Mapping of .gltf or .glb file. It is kept until upload() because BIN chunk of .glb file is used directly as buffer data.
+	const uint8_t* _glbBinChunkData = nullptr;  //< BIN chunk of .glb file. Null if the file is not .glb or it has no BIN chunk.
+	size_t _glbBinChunkSize = 0;
+	GltfJson _gltfJson;  //< Parsed json. Nodes, accessors and bufferViews are stored in its typed lists, the rest of the document in its root.
+	nlohmann::json _newGltfItems;  //< Empty root arrays for the items missing in the file.
+	nlohmann::json::array_t* _extensionsUsed;
+	nlohmann::json::array_t* _scenes;
+	nlohmann::json::array_t* _meshes;
+	nlohmann::json::array_t* _buffers;
+	nlohmann::json::array_t* _materials;
+	nlohmann::json::array_t* _textures;
+	nlohmann::json::array_t* _images;
+	nlohmann::json::array_t* _samplers;
+	bool _sceneAvailable = false;  //< False if the file contains no scene, so there is nothing to load.
+	bool _meshQuantizationUsed = false;  //< KHR_mesh_quantization is listed in extensionsUsed.
+	std::vector<std::vector<glm::mat4>> _meshMatrixList;  //< Instancing matrices of each mesh.
+	struct InstancedNode {
+		glm::mat4 matrix;  //< Node matrix in the scene.
+		uint32_t instancing;  //< Index into GltfJson::instancingList.
+		size_t numInstances;
+	};
+	std::vector<std::vector<InstancedNode>> _meshInstancedNodeList;  //< Nodes of each mesh using EXT_mesh_gpu_instancing. Their instancing matrices are composed directly into MatrixList.
+	std::vector<size_t> _meshNumInstancesList;  //< Number of instances of each mesh, including the instances of _meshInstancedNodeList.
+	std::vector<glm::vec4> _meshDequantizationList;  //< Position dequantization of each mesh. xyz - offset, w - scale; zero scale means no quantization.
+	struct StateSetMaterialData {
+		bool unlit;
+		bool doubleSided;
+		bool transparencyEnabled;
+		bool alphaTest;
+		unsigned materialTexturingParamsOffset;
+		std::array<uint32_t,10> shaderTextureSetup;
+	};
+	std::vector<std::vector<uint8_t>> _materialDataList;  //< Material data of each material as they will be stored in DataStorage.
+	std::vector<StateSetMaterialData> _stateSetMaterialDataList;
+	struct MaterialTextureRecord {
+		unsigned materialIndex;
+		unsigned textureIdOffset;  //< Offset of textureId inside material data.
+		unsigned appTextureIndex;
+		unsigned textureSetupIndex;  //< Index into StateSetMaterialData::shaderTextureSetup.
+	};
+	std::vector<MaterialTextureRecord> _materialTextureRecordList;  //< Textures referenced by materials. Their textureIds are written into material data by buildMaterialsAndTextures().
+	StateSetMaterialData _defaultStateSetMaterialData;
+	struct LinearAndSrgbIndices { unsigned linear; unsigned srgb; };
+	std::vector<LinearAndSrgbIndices> _gltfImageToAppImageMap;
+	std::vector<bool> _gltfImageIsNormalMap;
+	struct AppTextureInfo { unsigned gltfTextureIndex; bool srgb; };
+	std::vector<AppTextureInfo> _appTextureInfoList;
+	unsigned _numAppImages = 0;
+	unsigned _numAppTextures = 0;
+
+	// resolve buffers stage
+	struct BufferData { const uint8_t* data; size_t size; };
+	std::vector<MappedFile> _mappedFileList;  //< Mappings of external buffer files.
+	std::vector<BufferData> _bufferDataList;  //< Content of each glTF buffer. It points either into _mappedFileList or into BIN chunk of .glb file. Data decoded from EXT_meshopt_compression follow the glTF buffers.
+	std::unique_ptr<uint8_t[]> _meshoptDecodedData;  //< Content of all bufferViews decoded from EXT_meshopt_compression.
+	void decodeMeshoptBufferViews();  //< Decodes compressed bufferViews in parallel and redirects them to the decoded data.
+
+	// decode images stage
+	struct DecodedImage {
+		std::unique_ptr<uint8_t[], void(*)(uint8_t*)> data = { nullptr, [](uint8_t*){} };  //< Pixels or BCn encoded blocks. Null if the image is not uploaded by the application, e.g. it is shared with another image.
+		size_t dataSize = 0;
+		int width = 0;
+		int height = 0;
+		int numComponents = 0;
+		vk::Format format = vk::Format::eUndefined;
+		size_t alignment = 0;
+		bool packable = false;  //< Image might be packed into texture atlas.
+		bool compressed = false;  //< Data contain BCn encoded blocks.
+	};
+	std::vector<DecodedImage> _decodedImageList;  //< Decoded images indexed by application image index.
+	std::vector<unsigned> _appImageRemap;  //< Maps application image index to the index of the image of identical content.
+
+	// build geometry stage
+	bool _buildGeometryStarted = false;
+	size_t _nextMeshIndex = 0;
+	std::vector<CadR::Geometry> _geometryList;
+	std::vector<CadR::Drawable> _drawableList;
+	std::vector<CadR::MatrixList> _matrixLists;
+	std::vector<CadR::DataAllocation> _materialList;
+	std::vector<CadR::ImageAllocation> _imageList;
+	std::vector<vk::Sampler> _samplerList;  //< Samplers are owned by renderer's sampler cache.
+	std::vector<CadR::Texture> _textureList;
+	vk::Sampler _defaultSampler;  //< Owned by renderer's sampler cache.
+	vk::Sampler _defaultAtlasSampler;  //< Default sampler of textures packed in atlas. It does not use anisotropic filtering. Owned by renderer's sampler cache.
+	CadR::DataAllocation _defaultMaterial;
+	CadR::HandlelessAllocation _textureAtlasDataAllocation;
+	std::vector<CadR::BoundingSphere> _meshBoundingSphereList;
+	CadR::BoundingSphere _sceneBoundingSphere{ glm::vec3(0.f, 0.f, 0.f), 0.f };
+	std::vector<MergedDrawable> _mergedDrawableList;
+	std::vector<LodDrawable> _lodDrawableList;
+	std::deque<CadR::MatrixList> _mergedMatrixLists;  //< MatrixLists of merged Drawables. Deque is used as Drawables keep pointers to their MatrixLists.
+
+	// worker threads processing mesh primitives
+	std::vector<std::thread> _threadList;
+	std::deque<std::function<void()>> _jobQueue;
+	std::mutex _jobMutex;
+	std::condition_variable _jobAvailableCondition;
+	std::condition_variable _jobFinishedCondition;
+	bool _exitThreads = false;
+
+	struct PrimitiveData;
+	void buildMaterialsAndTextures();
+	void buildMeshes(size_t firstMeshIndex, size_t numMeshes);
+	void processPrimitive(PrimitiveData& d);  //< Validates attributes and indices and computes vertex layout and data sizes. Called on worker threads.
+	void resolveStateSet(PrimitiveData& d);  //< Resolves material and StateSet of the primitive.
+	void fillPrimitiveStagingData(PrimitiveData& d);  //< Fills reserved staging data by vertices and indices and computes bounding sphere. Called on worker threads.
+	glm::mat4* fillMeshMatrices(size_t meshIndex);  //< Writes instancing matrices of the mesh into its MatrixList and returns pointer to them. The pointer is valid until the staging data are submitted.
+	std::tuple<void*, unsigned> getDataPointerAndStride(const GltfJson::Accessor& accessor, size_t numElements, size_t elementSize) const;  //< Returns pointer to accessor data and their stride. Called on worker threads.
+	void startWorkerThreads();
+	void stopWorkerThreads() noexcept;
+	void workerMain();
+	void parallelFor(size_t numItems, const std::function<void(size_t)>& func);  //< Calls func for each item on the worker threads and the calling thread. The first exception is rethrown.
+	void computeSceneBoundingSphere();
+	void reportProgress(LoaderStage stage, size_t numDone, size_t numTotal);
+	void log(const std::string& message);
+
+public:
+
+	// construction and destruction
+	Loader(CadR::Renderer& renderer, CadR::VulkanInstance& instance, vk::PhysicalDevice physicalDevice,
+	       CadPL::PipelineSceneGraph& pipelineSceneGraph, CadR::StateSet& textureStateSet,
+	       const LoaderSettings& settings = {});
+	~Loader() noexcept;
+	Loader(const Loader&) = delete;
+	Loader& operator=(const Loader&) = delete;
+
+	// loading stages
+	// (see LoaderStage for the threading rules)
+	void parse(const std::filesystem::path& filePath);
+	void resolveBuffers();
+	void decodeImages();
+	bool buildGeometry(size_t maxNumMeshes = ~size_t(0));  //< Processes up to maxNumMeshes meshes. Returns true when all the meshes were processed and the scene bounding sphere is available.
+	void upload();
+	void load(const std::filesystem::path& filePath);  //< Performs all the stages on the calling thread.
+
+	// callbacks
+	// (they are called from the thread that performs the stage)
+	void setProgressCallback(ProgressCallback&& progressCallback);
+	void setLogCallback(LogCallback&& logCallback);
+
+	// settings and results
+	const LoaderSettings& settings() const;
+	bool sceneAvailable() const;
+	const CadR::BoundingSphere& sceneBoundingSphere() const;
+	const std::vector<CadR::BoundingSphere>& meshBoundingSphereList() const;
+	std::vector<CadR::Geometry>& geometryList();
+	std::vector<CadR::Drawable>& drawableList();
+	std::vector<CadR::MatrixList>& matrixLists();
+	const std::vector<MergedDrawable>& mergedDrawableList() const;  //< Drawables created by merging of static primitives. See LoaderSettings::mergeStaticPrimitives.
+	const std::vector<LodDrawable>& lodDrawableList() const;  //< Drawables with simplified levels of detail. See LoaderSettings::numLodLevels.
+	std::vector<CadR::DataAllocation>& materialList();
+	std::vector<CadR::ImageAllocation>& imageList();
+	std::vector<CadR::Texture>& textureList();
+	CadR::HandlelessAllocation& textureAtlasDataAllocation();
+
+};
+
+
+}
+
+
+// inline methods
+namespace CadGltf {
+
+inline size_t LodDrawable::selectLevel(float errorScale, float maxError) const  { size_t i = levelList.size() - 1; while(i > 0 && levelList[i].error * errorScale > maxError) i--; return i; }
+
+inline void Loader::setProgressCallback(ProgressCallback&& progressCallback)  { _progressCallback = std::move(progressCallback); }
+inline void Loader::setLogCallback(LogCallback&& logCallback)  { _logCallback = std::move(logCallback); }
+inline const LoaderSettings& Loader::settings() const  { return _settings; }
+inline bool Loader::sceneAvailable() const  { return _sceneAvailable; }
+inline const CadR::BoundingSphere& Loader::sceneBoundingSphere() const  { return _sceneBoundingSphere; }
+inline const std::vector<CadR::BoundingSphere>& Loader::meshBoundingSphereList() const  { return _meshBoundingSphereList; }
+inline std::vector<CadR::Geometry>& Loader::geometryList()  { return _geometryList; }
+inline std::vector<CadR::Drawable>& Loader::drawableList()  { return _drawableList; }
+inline std::vector<CadR::MatrixList>& Loader::matrixLists()  { return _matrixLists; }
+inline const std::vector<MergedDrawable>& Loader::mergedDrawableList() const  { return _mergedDrawableList; }
+inline const std::vector<LodDrawable>& Loader::lodDrawableList() const  { return _lodDrawableList; }
+inline std::vector<CadR::DataAllocation>& Loader::materialList()  { return _materialList; }
+inline std::vector<CadR::ImageAllocation>& Loader::imageList()  { return _imageList; }
+inline std::vector<CadR::Texture>& Loader::textureList()  { return _textureList; }
+inline CadR::HandlelessAllocation& Loader::textureAtlasDataAllocation()  { return _textureAtlasDataAllocation; }
+
+}
@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include "MappedFile.h"
+#include <CadR/Exceptions.h>
+#include <utility>
+#ifdef _WIN32
+# define WIN32_LEAN_AND_MEAN  // this reduces win32 headers default namespace pollution
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+using namespace std;
+using namespace CadGltf;
+
+
+void MappedFile::open(const filesystem::path& path)
+{
+	close();
+
+#ifdef _WIN32
+
+	// open file
+	HANDLE fileHandle = CreateFileW(path.native().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+	                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(fileHandle == INVALID_HANDLE_VALUE)
+		throw CadR::LogicError("Cannot open file \"" + path.string() + "\".");
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(fileHandle, &fileSize)) {
+		CloseHandle(fileHandle);
+		throw CadR::LogicError("Cannot get size of file \"" + path.string() + "\".");
+	}
+	_fileHandle = fileHandle;
+	_size = size_t(fileSize.QuadPart);
+	if(_size == 0)
+		return;
+
+	// map file
+	HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mappingHandle == nullptr) {
+		close();
+		throw CadR::LogicError("Cannot map file \"" + path.string() + "\".");
+	}
+	_mappingHandle = mappingHandle;
+	_data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if(_data == nullptr) {
+		close();
+		throw CadR::LogicError("Cannot map file \"" + path.string() + "\".");
+	}
+
+#else
+
+	// open file
+	_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if(_fd == -1)
+		throw CadR::LogicError("Cannot open file \"" + path.string() + "\".");
+	struct stat st;
+	if(fstat(_fd, &st) != 0) {
+		close();
+		throw CadR::LogicError("Cannot get size of file \"" + path.string() + "\".");
+	}
+	_size = size_t(st.st_size);
+	if(_size == 0)
+		return;
+
+	// map file
+	void* p = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+	if(p == MAP_FAILED) {
+		close();
+		throw CadR::LogicError("Cannot map file \"" + path.string() + "\".");
+	}
+	_data = static_cast<const uint8_t*>(p);
+
+#endif
+}
+
+
+void MappedFile::close() noexcept
+{
+#ifdef _WIN32
+	if(_data)
+		UnmapViewOfFile(_data);
+	if(_mappingHandle)
+		CloseHandle(_mappingHandle);
+	if(_fileHandle)
+		CloseHandle(_fileHandle);
+	_mappingHandle = nullptr;
+	_fileHandle = nullptr;
+#else
+	if(_data)
+		munmap(const_cast<uint8_t*>(_data), _size);
+	if(_fd != -1)
+		::close(_fd);
+	_fd = -1;
+#endif
+	_data = nullptr;
+	_size = 0;
+}
+
+
+void MappedFile::adviseSequential(size_t offset, size_t size) noexcept
+{
+	if(_data == nullptr || offset >= _size)
+		return;
+	if(size > _size - offset)
+		size = _size - offset;
+
+#ifdef _WIN32
+	// Windows uses FILE_FLAG_SEQUENTIAL_SCAN given on file opening
+	// and does not provide per-range hints for mapped views
+#else
+	// madvise() requires page-aligned start address
+	size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+	size_t alignedOffset = offset & ~(pageSize-1);
+	madvise(const_cast<uint8_t*>(_data) + alignedOffset, size + (offset - alignedOffset),
+	        MADV_SEQUENTIAL);
+	madvise(const_cast<uint8_t*>(_data) + alignedOffset, size + (offset - alignedOffset),
+	        MADV_WILLNEED);
+#endif
+}
+
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: _data(other._data)
+	, _size(other._size)
+#ifdef _WIN32
+	, _fileHandle(other._fileHandle)
+	, _mappingHandle(other._mappingHandle)
+#else
+	, _fd(other._fd)
+#endif
+{
+	other._data = nullptr;
+	other._size = 0;
+#ifdef _WIN32
+	other._fileHandle = nullptr;
+	other._mappingHandle = nullptr;
+#else
+	other._fd = -1;
+#endif
+}
+
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if(this == &other)
+		return *this;
+
+	close();
+	_data = exchange(other._data, nullptr);
+	_size = exchange(other._size, 0);
+#ifdef _WIN32
+	_fileHandle = exchange(other._fileHandle, nullptr);
+	_mappingHandle = exchange(other._mappingHandle, nullptr);
+#else
+	_fd = exchange(other._fd, -1);
+#endif
+	return *this;
+}
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace CadGltf {
+
+
+/** Read-only memory mapping of a file.
+ *  The file content is paged in by the operating system on the first access,
+ *  so no heap copy of the file is made. Empty files are not mapped;
+ *  data() returns nullptr and size() returns zero for them.
+ */
+class CADGLTF_EXPORT MappedFile {
+protected:
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+#ifdef _WIN32
+	void* _fileHandle = nullptr;
+	void* _mappingHandle = nullptr;
+#else
+	int _fd = -1;
+#endif
+public:
+
+	// construction and destruction
+	MappedFile() noexcept = default;
+	MappedFile(const std::filesystem::path& path);
+	~MappedFile() noexcept;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	void open(const std::filesystem::path& path);  //< Maps the file. Throws CadR::LogicError on failure.
+	void close() noexcept;
+	void adviseSequential(size_t offset = 0, size_t size = ~size_t(0)) noexcept;  //< Hints the system that the given range will be read sequentially, so it can read ahead aggressively. No-op where unsupported.
+
+	const uint8_t* data() const;
+	size_t size() const;
+	bool isOpen() const;
+
+};
+
+
+}
+
+
+// inline methods
+namespace CadGltf {
+
+inline MappedFile::MappedFile(const std::filesystem::path& path)  { open(path); }
+inline MappedFile::~MappedFile() noexcept  { close(); }
+inline const uint8_t* MappedFile::data() const  { return _data; }
+inline size_t MappedFile::size() const  { return _size; }
+#ifdef _WIN32
+inline bool MappedFile::isOpen() const  { return _fileHandle != nullptr; }
+#else
+inline bool MappedFile::isOpen() const  { return _fd != -1; }
+#endif
+
+}
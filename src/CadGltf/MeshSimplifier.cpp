@@ -0,0 +1,332 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include <CadGltf/MeshSimplifier.h>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+using namespace CadGltf;
+
+
+using MeshSimplifier::Quadric;
+
+
+namespace {
+
+struct Collapse {
+	uint32_t src;  // vertex moved into dst
+	uint32_t dst;
+	double cost;
+};
+
+}
+
+
+static void addPlane(Quadric& q, const glm::dvec3& n, double d, double w)
+{
+	q.a00 += w * n.x * n.x;
+	q.a01 += w * n.x * n.y;
+	q.a02 += w * n.x * n.z;
+	q.a11 += w * n.y * n.y;
+	q.a12 += w * n.y * n.z;
+	q.a22 += w * n.z * n.z;
+	q.b0 += w * n.x * d;
+	q.b1 += w * n.y * d;
+	q.b2 += w * n.z * d;
+	q.c += w * d * d;
+	q.w += w;
+}
+
+
+static void addQuadric(Quadric& q, const Quadric& r)
+{
+	q.a00 += r.a00; q.a01 += r.a01; q.a02 += r.a02;
+	q.a11 += r.a11; q.a12 += r.a12; q.a22 += r.a22;
+	q.b0 += r.b0; q.b1 += r.b1; q.b2 += r.b2;
+	q.c += r.c;
+	q.w += r.w;
+}
+
+
+/// Returns weighted average of squared distances of p from the planes of the quadric.
+static double evaluate(const Quadric& q, const glm::vec3& p)
+{
+	if(q.w <= 0.)
+		return 0.;
+	double x = p.x, y = p.y, z = p.z;
+	double r = q.a00*x*x + q.a11*y*y + q.a22*z*z + 2.*(q.a01*x*y + q.a02*x*z + q.a12*y*z) +
+	           2.*(q.b0*x + q.b1*y + q.b2*z) + q.c;
+	return max(r / q.w, 0.);
+}
+
+
+template<typename T>
+static size_t simplifyT(T* dst, const T* indices, size_t numIndices, const glm::vec3* positions, size_t numVertices,
+                        size_t targetNumIndices, float& resultError, MeshSimplifier::State* state)
+{
+	resultError = state ? state->error : 0.f;
+	numIndices = numIndices / 3 * 3;
+
+	// indices out of range or nothing to simplify
+	// (indices are copied unchanged)
+	auto copyUnchanged =
+		[&]() {
+			memcpy(dst, indices, numIndices * sizeof(T));
+			return numIndices;
+		};
+	if(numIndices <= targetNumIndices)
+		return copyUnchanged();
+	for(size_t i=0; i<numIndices; i++)
+		if(indices[i] >= numVertices)
+			return copyUnchanged();
+
+	// weld vertices by positions
+	// (canonical vertex is the one with the lowest index among the vertices of the same position)
+	vector<uint32_t> canonical(numVertices);
+	{
+		vector<uint32_t> order(numVertices);
+		iota(order.begin(), order.end(), 0);
+		stable_sort(order.begin(), order.end(),
+			[positions](uint32_t a, uint32_t b) {
+				const glm::vec3& p1 = positions[a];
+				const glm::vec3& p2 = positions[b];
+				if(p1.x != p2.x)  return p1.x < p2.x;
+				if(p1.y != p2.y)  return p1.y < p2.y;
+				return p1.z < p2.z;
+			});
+		for(size_t i=0; i<numVertices; ) {
+			size_t e = i + 1;
+			while(e < numVertices && positions[order[e]] == positions[order[i]])
+				e++;
+			for(size_t j=i; j<e; j++)
+				canonical[order[j]] = order[i];
+			i = e;
+		}
+	}
+
+	// working copy of triangles
+	vector<uint32_t> triangles(indices, indices + numIndices);
+
+	// lock seam vertices
+	// (seam vertex is referenced by more than one vertex of the same position)
+	constexpr uint32_t none = ~uint32_t(0);
+	vector<uint8_t> locked(numVertices, 0);
+	{
+		vector<uint32_t> referencedVertex(numVertices, none);
+		for(uint32_t v : triangles) {
+			uint32_t& r = referencedVertex[canonical[v]];
+			if(r == none)
+				r = v;
+			else if(r != v)
+				locked[canonical[v]] = 1;
+		}
+	}
+
+	// lock vertices of border and non-manifold edges
+	// (edges are identified by sorted canonical vertex pairs)
+	{
+		vector<uint64_t> edgeList;
+		edgeList.reserve(numIndices);
+		for(size_t i=0; i<numIndices; i+=3)
+			for(unsigned j=0; j<3; j++) {
+				uint32_t a = canonical[triangles[i+j]];
+				uint32_t b = canonical[triangles[i+(j+1)%3]];
+				if(a != b)
+					edgeList.push_back((uint64_t(min(a, b)) << 32) | max(a, b));
+			}
+		sort(edgeList.begin(), edgeList.end());
+		for(size_t i=0, c=edgeList.size(); i<c; ) {
+			size_t e = i + 1;
+			while(e < c && edgeList[e] == edgeList[i])
+				e++;
+			if(e - i != 2) {
+				locked[uint32_t(edgeList[i] >> 32)] = 1;
+				locked[uint32_t(edgeList[i])] = 1;
+			}
+			i = e;
+		}
+	}
+
+	// area weighted plane quadrics of canonical vertices
+	// (the quadrics of the previous level are reused, so the collapse costs are measured against the original mesh)
+	vector<Quadric> localQuadrics;
+	vector<Quadric>& quadrics = state ? state->quadrics : localQuadrics;
+	if(quadrics.size() != numVertices) {
+		quadrics.assign(numVertices, Quadric{});
+		for(size_t i=0; i<numIndices; i+=3) {
+			glm::dvec3 p0 = positions[triangles[i+0]];
+			glm::dvec3 p1 = positions[triangles[i+1]];
+			glm::dvec3 p2 = positions[triangles[i+2]];
+			glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+			double l = glm::length(n);
+			if(l == 0.)
+				continue;
+			n /= l;
+			double d = -glm::dot(n, p0);
+			for(unsigned j=0; j<3; j++)
+				addPlane(quadrics[canonical[triangles[i+j]]], n, d, l * 0.5);
+		}
+	}
+
+	// collapse passes
+	// (each pass computes the costs of all collapses and performs the cheapest ones;
+	// each collapse locks one-ring of its source vertex for the rest of the pass,
+	// so the triangles affected by a collapse are not modified by another collapse of the same pass)
+	size_t numTriangles = numIndices / 3;
+	size_t targetNumTriangles = targetNumIndices / 3;
+	double maxError = double(resultError) * resultError;
+	vector<uint32_t> adjacencyOffset(numVertices + 1);
+	vector<uint32_t> adjacency;
+	vector<Collapse> collapseList;
+	vector<uint8_t> touched(numVertices);
+	vector<uint32_t> remap(numVertices);
+	iota(remap.begin(), remap.end(), 0);
+	while(numTriangles > targetNumTriangles) {
+
+		// vertex-triangle adjacency of canonical vertices
+		fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+		for(uint32_t v : triangles)
+			adjacencyOffset[canonical[v] + 1]++;
+		partial_sum(adjacencyOffset.begin(), adjacencyOffset.end(), adjacencyOffset.begin());
+		adjacency.resize(triangles.size());
+		{
+			vector<uint32_t> fillPos(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+			for(size_t i=0, c=triangles.size(); i<c; i++)
+				adjacency[fillPos[canonical[triangles[i]]]++] = uint32_t(i / 3);
+		}
+
+		// collapse candidates
+		// (each edge is considered in both directions;
+		// the source must not be locked and the destination keeps its real vertex,
+		// i.e. the copy of seam vertex on the side of the source)
+		collapseList.clear();
+		for(size_t i=0, c=triangles.size(); i<c; i+=3)
+			for(unsigned j=0; j<3; j++) {
+				uint32_t v1 = triangles[i+j];
+				uint32_t v2 = triangles[i+(j+1)%3];
+				uint32_t c1 = canonical[v1];
+				uint32_t c2 = canonical[v2];
+				if(c1 == c2)
+					continue;
+				Quadric q = quadrics[c1];
+				addQuadric(q, quadrics[c2]);
+				if(!locked[c1])
+					collapseList.push_back({ v1, v2, evaluate(q, positions[v2]) });
+				if(!locked[c2])
+					collapseList.push_back({ v2, v1, evaluate(q, positions[v1]) });
+			}
+		if(collapseList.empty())
+			break;
+		sort(collapseList.begin(), collapseList.end(),
+			[](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		// perform the cheapest collapses
+		// (the collapses much more expensive than the cheap ones are postponed to the next passes
+		// as the cheap ones might change their costs)
+		double passLimit = collapseList[collapseList.size() / 8].cost * 1.5;
+		size_t numToRemove = numTriangles - targetNumTriangles;
+		size_t numRemoved = 0;
+		size_t numCollapses = 0;
+		fill(touched.begin(), touched.end(), 0);
+		for(const Collapse& collapse : collapseList) {
+
+			if(collapse.cost > passLimit || numRemoved >= numToRemove)
+				break;
+			uint32_t cs = canonical[collapse.src];
+			uint32_t cd = canonical[collapse.dst];
+			if(touched[cs] || touched[cd])
+				continue;
+
+			// reject collapses that flip triangles or turn them by more than about 75 degrees
+			// and count the triangles that degenerate
+			const glm::vec3& newPos = positions[collapse.dst];
+			size_t numDegenerated = 0;
+			bool valid = true;
+			for(uint32_t i=adjacencyOffset[cs], e=adjacencyOffset[cs+1]; i<e; i++) {
+				const uint32_t* t = &triangles[size_t(adjacency[i]) * 3];
+				uint32_t tc[3] = { canonical[t[0]], canonical[t[1]], canonical[t[2]] };
+				if(tc[0] == cd || tc[1] == cd || tc[2] == cd) {
+					numDegenerated++;
+					continue;
+				}
+				glm::vec3 p[3] = { positions[t[0]], positions[t[1]], positions[t[2]] };
+				glm::vec3 oldNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+				for(unsigned j=0; j<3; j++)
+					if(tc[j] == cs)
+						p[j] = newPos;
+				glm::vec3 newNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+				if(glm::dot(oldNormal, newNormal) <= 0.25f * glm::length(oldNormal) * glm::length(newNormal)) {
+					valid = false;
+					break;
+				}
+			}
+			if(!valid)
+				continue;
+
+			// collapse
+			remap[collapse.src] = collapse.dst;
+			addQuadric(quadrics[cd], quadrics[cs]);
+			maxError = max(maxError, collapse.cost);
+			for(uint32_t i=adjacencyOffset[cs], e=adjacencyOffset[cs+1]; i<e; i++) {
+				const uint32_t* t = &triangles[size_t(adjacency[i]) * 3];
+				touched[canonical[t[0]]] = 1;
+				touched[canonical[t[1]]] = 1;
+				touched[canonical[t[2]]] = 1;
+			}
+			numRemoved += numDegenerated;
+			numCollapses++;
+		}
+		if(numCollapses == 0)
+			break;
+
+		// apply collapses and remove degenerated triangles
+		size_t n = 0;
+		for(size_t i=0, c=triangles.size(); i<c; i+=3) {
+			uint32_t v0 = remap[triangles[i+0]];
+			uint32_t v1 = remap[triangles[i+1]];
+			uint32_t v2 = remap[triangles[i+2]];
+			uint32_t c0 = canonical[v0];
+			uint32_t c1 = canonical[v1];
+			uint32_t c2 = canonical[v2];
+			if(c0 == c1 || c1 == c2 || c2 == c0)
+				continue;
+			triangles[n+0] = v0;
+			triangles[n+1] = v1;
+			triangles[n+2] = v2;
+			n += 3;
+		}
+		triangles.resize(n);
+		numTriangles = n / 3;
+		iota(remap.begin(), remap.end(), 0);
+	}
+
+	// write result
+	for(size_t i=0, c=triangles.size(); i<c; i++)
+		dst[i] = T(triangles[i]);
+	resultError = float(sqrt(maxError));
+	if(state)
+		state->error = resultError;
+	return triangles.size();
+}
+
+
+size_t MeshSimplifier::simplify(uint16_t* dst, const uint16_t* indices, size_t numIndices,
+                                const glm::vec3* positions, size_t numVertices,
+                                size_t targetNumIndices, float& resultError, State* state)
+{
+	return simplifyT(dst, indices, numIndices, positions, numVertices, targetNumIndices, resultError, state);
+}
+
+
+size_t MeshSimplifier::simplify(uint32_t* dst, const uint32_t* indices, size_t numIndices,
+                                const glm::vec3* positions, size_t numVertices,
+                                size_t targetNumIndices, float& resultError, State* state)
+{
+	return simplifyT(dst, indices, numIndices, positions, numVertices, targetNumIndices, resultError, state);
+}
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CadGltf {
+
+
+/** Simplification of triangle lists for generating levels of detail.
+ *
+ *  Triangles are simplified by edge collapses ordered by quadric error metric (Garland, Heckbert:
+ *  Surface Simplification Using Quadric Error Metrics, 1997). Only the indices are modified;
+ *  each collapse moves one vertex into its neighbour, so the simplified index lists
+ *  reference the original vertices and they can share vertex data with the full detail mesh.
+ *
+ *  Vertices are welded by their positions, so the vertices split by normals or texture coordinates
+ *  are recognized as seams. The vertices on seams and on open borders are never moved,
+ *  which preserves the mesh outline and the attribute discontinuities,
+ *  such as sharp edges of CAD models. Collapses flipping the triangles are rejected.
+ *
+ *  The resulting error is the square root of area weighted average of squared distances
+ *  from the planes of the original triangles, i.e. approximate geometric deviation
+ *  in the units of positions. It might be used for screen-space error based selection of the levels.
+ *  When the levels are simplified one from another, the same State shall be passed to all the calls,
+ *  so the error of each level is measured against the original mesh.
+ *
+ *  All the functions are thread-safe, so separate index lists might be processed in parallel.
+ */
+namespace MeshSimplifier {
+
+	/** Quadric of squared distances from planes,
+	 *  i.e. symmetric matrix A, vector b and scalar c for p^T*A*p + 2*b^T*p + c.
+	 *  The planes are weighted and the weight sum is stored in w.
+	 */
+	struct Quadric {
+		double a00, a01, a02, a11, a12, a22;
+		double b0, b1, b2;
+		double c;
+		double w;
+	};
+
+	/** Simplification state passed between the simplifications of consecutive levels.
+	 *  It holds the quadrics of the welded vertices accumulated by all the collapses so far
+	 *  and the error of the last level, so the errors of the levels are measured against
+	 *  the original mesh and they never decrease.
+	 */
+	struct State {
+		std::vector<Quadric> quadrics;  //< Quadrics indexed by vertex index. Empty until the first simplify() call.
+		float error = 0.f;  //< Error of the last simplified level.
+	};
+
+	CADGLTF_EXPORT size_t simplify(uint16_t* dst, const uint16_t* indices, size_t numIndices,
+	                               const glm::vec3* positions, size_t numVertices,
+	                               size_t targetNumIndices, float& resultError,
+	                               State* state = nullptr);  //< Writes simplified triangle list into dst and returns its number of indices. The dst must have the space for numIndices indices and it must not overlap indices. The simplification stops when targetNumIndices is reached or no more edges can be collapsed. If any index is out of numVertices range, the indices are copied unchanged. If state is given, the simplification continues from the state of the previous call on the same vertices and the state is updated for the next call.
+	CADGLTF_EXPORT size_t simplify(uint32_t* dst, const uint32_t* indices, size_t numIndices,
+	                               const glm::vec3* positions, size_t numVertices,
+	                               size_t targetNumIndices, float& resultError,
+	                               State* state = nullptr);  //< Writes simplified triangle list into dst and returns its number of indices. The dst must have the space for numIndices indices and it must not overlap indices. The simplification stops when targetNumIndices is reached or no more edges can be collapsed. If any index is out of numVertices range, the indices are copied unchanged. If state is given, the simplification continues from the state of the previous call on the same vertices and the state is updated for the next call.
+
+}
+
+
+}
@@ -0,0 +1,497 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include <CadGltf/MeshoptDecoder.h>
+#include <CadR/Exceptions.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+using namespace CadGltf;
+
+typedef CadR::LogicError GltfError;
+
+
+// vertex codec constants
+static constexpr uint8_t vertexHeader = 0xa0;
+static constexpr size_t vertexBlockSizeBytes = 8192;  // maximal size of decoded block
+static constexpr size_t vertexBlockMaxSize = 256;  // maximal number of vertices in the block
+static constexpr size_t byteGroupSize = 16;
+static constexpr size_t byteGroupDecodeLimit = 24;  // maximal number of bytes read by decoding of one byte group
+static constexpr size_t tailMaxSize = 32;
+
+// index codec constants
+static constexpr uint8_t indexHeader = 0xe0;
+static constexpr uint8_t sequenceHeader = 0xd0;
+
+
+static inline uint8_t unzigzag8(uint8_t v)
+{
+	return uint8_t(-(v & 1) ^ (v >> 1));
+}
+
+
+// decodes group of 16 bytes encoded by 0, 2, 4 or 8 bits per byte;
+// values with all the bits set are escaped and stored in full after the group
+static const uint8_t* decodeBytesGroup(const uint8_t* data, uint8_t* dst, unsigned bitsLog2)
+{
+	switch(bitsLog2) {
+	case 0:
+		memset(dst, 0, byteGroupSize);
+		return data;
+	case 1: {
+		const uint8_t* escaped = data + 4;
+		for(unsigned i=0; i<4; i++) {
+			uint8_t b = data[i];
+			for(unsigned j=0; j<4; j++, b<<=2) {
+				uint8_t v = b >> 6;
+				if(v == 3)
+					v = *escaped++;
+				*dst++ = v;
+			}
+		}
+		return escaped;
+	}
+	case 2: {
+		const uint8_t* escaped = data + 8;
+		for(unsigned i=0; i<8; i++) {
+			uint8_t b = data[i];
+			for(unsigned j=0; j<2; j++, b<<=4) {
+				uint8_t v = b >> 4;
+				if(v == 15)
+					v = *escaped++;
+				*dst++ = v;
+			}
+		}
+		return escaped;
+	}
+	default:
+		memcpy(dst, data, byteGroupSize);
+		return data + byteGroupSize;
+	}
+}
+
+
+// decodes byte groups of one byte channel of the vertex block;
+// returns nullptr if data are truncated
+static const uint8_t* decodeBytes(const uint8_t* data, const uint8_t* dataEnd, uint8_t* dst, size_t dstSize)
+{
+	// 2-bit header of each group
+	size_t headerSize = (dstSize / byteGroupSize + 3) / 4;
+	if(size_t(dataEnd - data) < headerSize)
+		return nullptr;
+	const uint8_t* header = data;
+	data += headerSize;
+
+	for(size_t i=0; i<dstSize; i+=byteGroupSize) {
+		if(size_t(dataEnd - data) < byteGroupDecodeLimit)
+			return nullptr;
+		size_t groupIndex = i / byteGroupSize;
+		unsigned bitsLog2 = (header[groupIndex / 4] >> ((groupIndex % 4) * 2)) & 3;
+		data = decodeBytesGroup(data, dst + i, bitsLog2);
+	}
+	return data;
+}
+
+
+void MeshoptDecoder::decodeVertexBuffer(void* dst, size_t count, size_t byteStride, const uint8_t* src, size_t srcSize)
+{
+	if(byteStride == 0 || byteStride > 256 || byteStride % 4 != 0)
+		throw GltfError("EXT_meshopt_compression: Invalid byteStride of vertex data.");
+	if(srcSize < 1 + byteStride)
+		throw GltfError("EXT_meshopt_compression: Truncated vertex data.");
+	if(src[0] != vertexHeader)
+		throw GltfError("EXT_meshopt_compression: Unsupported vertex data header.");
+
+	// vertex blocks
+	// (each byte of the vertex is stored as separate channel of deltas to the previous vertex;
+	// the first vertex is predicted from the vertex stored at the end of the data)
+	const uint8_t* data = src + 1;
+	const uint8_t* dataEnd = src + srcSize;
+	uint8_t* vertexData = static_cast<uint8_t*>(dst);
+	uint8_t lastVertex[256];
+	memcpy(lastVertex, dataEnd - byteStride, byteStride);
+	size_t blockSize = min((vertexBlockSizeBytes / byteStride) & ~(byteGroupSize - 1), vertexBlockMaxSize);
+	uint8_t buffer[vertexBlockMaxSize];
+	for(size_t vertexOffset=0; vertexOffset<count; vertexOffset+=blockSize) {
+
+		size_t numVertices = min(blockSize, count - vertexOffset);
+		size_t numVerticesAligned = (numVertices + byteGroupSize - 1) & ~(byteGroupSize - 1);
+		uint8_t* blockData = vertexData + vertexOffset * byteStride;
+		for(size_t k=0; k<byteStride; k++) {
+			data = decodeBytes(data, dataEnd, buffer, numVerticesAligned);
+			if(data == nullptr)
+				throw GltfError("EXT_meshopt_compression: Truncated vertex data.");
+			uint8_t p = lastVertex[k];
+			uint8_t* d = blockData + k;
+			for(size_t i=0; i<numVertices; i++, d+=byteStride) {
+				p = uint8_t(unzigzag8(buffer[i]) + p);
+				*d = p;
+			}
+		}
+		memcpy(lastVertex, blockData + (numVertices-1) * byteStride, byteStride);
+	}
+
+	// tail of the data
+	// (it contains the first vertex prediction padded to at least 32 bytes)
+	if(size_t(dataEnd - data) != max(byteStride, tailMaxSize))
+		throw GltfError("EXT_meshopt_compression: Invalid size of vertex data.");
+}
+
+
+static inline unsigned decodeVByte(const uint8_t*& data)
+{
+	uint8_t lead = *data++;
+	if(lead < 128)
+		return lead;
+
+	// up to four more bytes
+	// (the loop always terminates, even on malformed data)
+	unsigned result = lead & 127;
+	unsigned shift = 7;
+	for(unsigned i=0; i<4; i++) {
+		uint8_t group = *data++;
+		result |= unsigned(group & 127) << shift;
+		shift += 7;
+		if(group < 128)
+			break;
+	}
+	return result;
+}
+
+
+static inline unsigned decodeIndex(const uint8_t*& data, unsigned last)
+{
+	unsigned v = decodeVByte(data);
+	unsigned d = (v >> 1) ^ unsigned(-int(v & 1));
+	return last + d;
+}
+
+
+
+
+template<typename T>
+static inline void writeTriangle(void* dst, size_t i, unsigned a, unsigned b, unsigned c)
+{
+	T* p = static_cast<T*>(dst) + i;
+	p[0] = T(a);
+	p[1] = T(b);
+	p[2] = T(c);
+}
+
+
+template<typename T>
+static void decodeIndexBufferImpl(T* dst, size_t count, const uint8_t* src, size_t srcSize)
+{
+	// index codec version
+	// (version 1 encodes small deltas of the last free index by the edge fifo codes 13 and 14)
+	unsigned version = src[0] & 0x0f;
+	if((src[0] & 0xf0) != indexHeader || version > 1)
+		throw GltfError("EXT_meshopt_compression: Unsupported triangle data header.");
+	unsigned fecMax = (version >= 1) ? 13 : 15;
+
+	// fifos of recently seen edges and vertices
+	unsigned edgeFifo[16][2];
+	unsigned vertexFifo[16];
+	memset(edgeFifo, -1, sizeof(edgeFifo));
+	memset(vertexFifo, -1, sizeof(vertexFifo));
+	size_t edgeFifoOffset = 0;
+	size_t vertexFifoOffset = 0;
+	auto pushEdge =
+		[&](unsigned a, unsigned b) {
+			edgeFifo[edgeFifoOffset][0] = a;
+			edgeFifo[edgeFifoOffset][1] = b;
+			edgeFifoOffset = (edgeFifoOffset + 1) & 15;
+		};
+	auto pushVertex =
+		[&](unsigned v, bool cond = true) {
+			vertexFifo[vertexFifoOffset] = v;
+			vertexFifoOffset = (vertexFifoOffset + cond) & 15;
+		};
+
+	// triangles
+	// (each triangle is given by one code byte, optionally followed by data bytes;
+	// each triangle reads at most 16 data bytes, so the 16-byte table after dataSafeEnd
+	// guarantees that no read goes past the end of the source data)
+	unsigned next = 0;
+	unsigned last = 0;
+	const uint8_t* code = src + 1;
+	const uint8_t* data = code + count / 3;
+	const uint8_t* dataSafeEnd = src + srcSize - 16;
+	const uint8_t* codeAuxTable = dataSafeEnd;
+	for(size_t i=0; i<count; i+=3) {
+
+		if(data > dataSafeEnd)
+			throw GltfError("EXT_meshopt_compression: Truncated triangle data.");
+
+		uint8_t codeTri = *code++;
+		if(codeTri < 0xf0) {
+
+			// triangle sharing an edge from the edge fifo
+			unsigned fe = codeTri >> 4;
+			unsigned a = edgeFifo[(edgeFifoOffset - 1 - fe) & 15][0];
+			unsigned b = edgeFifo[(edgeFifoOffset - 1 - fe) & 15][1];
+			unsigned c;
+			unsigned fec = codeTri & 15;
+			if(fec < fecMax) {
+				// third vertex is the next one or it comes from the vertex fifo
+				c = (fec == 0) ? next : vertexFifo[(vertexFifoOffset - 1 - fec) & 15];
+				next += (fec == 0);
+				pushVertex(c, fec == 0);
+			}
+			else {
+				// third vertex is encoded relative to the last free index;
+				// 13 and 14 mean -1 and +1 while 15 means explicitly encoded delta
+				c = (fec != 15) ? last + (fec - (fec ^ 3)) : decodeIndex(data, last);
+				last = c;
+				pushVertex(c);
+			}
+			writeTriangle<T>(dst, i, a, b, c);
+			pushEdge(c, b);
+			pushEdge(a, c);
+
+		}
+		else if(codeTri < 0xfe) {
+
+			// new triangle with vertices given by the code from the auxiliary table
+			uint8_t codeAux = codeAuxTable[codeTri & 15];
+			unsigned feb = codeAux >> 4;
+			unsigned fec = codeAux & 15;
+			unsigned a = next++;
+			unsigned b = (feb == 0) ? next : vertexFifo[(vertexFifoOffset - feb) & 15];
+			next += (feb == 0);
+			unsigned c = (fec == 0) ? next : vertexFifo[(vertexFifoOffset - fec) & 15];
+			next += (fec == 0);
+			writeTriangle<T>(dst, i, a, b, c);
+			pushVertex(a);
+			pushVertex(b, feb == 0);
+			pushVertex(c, fec == 0);
+			pushEdge(b, a);
+			pushEdge(c, b);
+			pushEdge(a, c);
+
+		}
+		else {
+
+			// new triangle with vertices given by the code from the data;
+			// 0 means the next vertex, 15 explicitly encoded index
+			// and the other values refer to the vertex fifo
+			uint8_t codeAux = *data++;
+			unsigned fea = (codeTri == 0xfe) ? 0 : 15;
+			unsigned feb = codeAux >> 4;
+			unsigned fec = codeAux & 15;
+			unsigned a = (fea == 0) ? next++ : 0;
+			unsigned b = (feb == 0) ? next++ : vertexFifo[(vertexFifoOffset - feb) & 15];
+			unsigned c = (fec == 0) ? next++ : vertexFifo[(vertexFifoOffset - fec) & 15];
+			if(fea == 15)
+				last = a = decodeIndex(data, last);
+			if(feb == 15)
+				last = b = decodeIndex(data, last);
+			if(fec == 15)
+				last = c = decodeIndex(data, last);
+			writeTriangle<T>(dst, i, a, b, c);
+			pushVertex(a);
+			pushVertex(b, feb == 0 || feb == 15);
+			pushVertex(c, fec == 0 || fec == 15);
+			pushEdge(b, a);
+			pushEdge(c, b);
+			pushEdge(a, c);
+
+		}
+	}
+
+	// all the data must be consumed
+	if(data != dataSafeEnd)
+		throw GltfError("EXT_meshopt_compression: Invalid size of triangle data.");
+}
+
+
+void MeshoptDecoder::decodeIndexBuffer(void* dst, size_t count, size_t byteStride, const uint8_t* src, size_t srcSize)
+{
+	if(count % 3 != 0)
+		throw GltfError("EXT_meshopt_compression: Number of triangle indices is not multiple of three.");
+
+	// header, one code byte per triangle and 16-byte table of auxiliary codes
+	if(srcSize < 1 + count / 3 + 16)
+		throw GltfError("EXT_meshopt_compression: Truncated triangle data.");
+
+	if(byteStride == 2)
+		decodeIndexBufferImpl(static_cast<uint16_t*>(dst), count, src, srcSize);
+	else if(byteStride == 4)
+		decodeIndexBufferImpl(static_cast<uint32_t*>(dst), count, src, srcSize);
+	else
+		throw GltfError("EXT_meshopt_compression: Invalid byteStride of triangle data.");
+}
+
+
+template<typename T>
+static void decodeIndexSequenceImpl(T* dst, size_t count, const uint8_t* src, size_t srcSize)
+{
+	if(src[0] != (sequenceHeader | 1))
+		throw GltfError("EXT_meshopt_compression: Unsupported index data header.");
+
+	// indices
+	// (each index is delta to one of two baselines, its lowest bit selects the baseline;
+	// each index reads at most 5 bytes, so the 4-byte tail after dataSafeEnd
+	// guarantees that no read goes past the end of the source data)
+	const uint8_t* data = src + 1;
+	const uint8_t* dataSafeEnd = src + srcSize - 4;
+	unsigned last[2] = { 0, 0 };
+	for(size_t i=0; i<count; i++) {
+		if(data >= dataSafeEnd)
+			throw GltfError("EXT_meshopt_compression: Truncated index data.");
+		unsigned v = decodeVByte(data);
+		unsigned current = v & 1;
+		v >>= 1;
+		unsigned index = last[current] + ((v >> 1) ^ unsigned(-int(v & 1)));
+		last[current] = index;
+		dst[i] = T(index);
+	}
+
+	// all the data must be consumed
+	if(data != dataSafeEnd)
+		throw GltfError("EXT_meshopt_compression: Invalid size of index data.");
+}
+
+
+void MeshoptDecoder::decodeIndexSequence(void* dst, size_t count, size_t byteStride, const uint8_t* src, size_t srcSize)
+{
+	// header, at least one byte per index and 4-byte tail
+	if(srcSize < 1 + count + 4)
+		throw GltfError("EXT_meshopt_compression: Truncated index data.");
+
+	if(byteStride == 2)
+		decodeIndexSequenceImpl(static_cast<uint16_t*>(dst), count, src, srcSize);
+	else if(byteStride == 4)
+		decodeIndexSequenceImpl(static_cast<uint32_t*>(dst), count, src, srcSize);
+	else
+		throw GltfError("EXT_meshopt_compression: Invalid byteStride of index data.");
+}
+
+
+static inline int roundToInt(float v)
+{
+	return int(v + ((v >= 0.f) ? 0.5f : -0.5f));
+}
+
+
+template<typename T>
+static void decodeOctahedralFilterImpl(T* data, size_t count)
+{
+	const float maxValue = float((1 << (sizeof(T) * 8 - 1)) - 1);
+	for(size_t i=0; i<count; i++, data+=4) {
+
+		// reconstruct z from x and y
+		// (z component stores the value of one at the same bit count)
+		float x = float(data[0]);
+		float y = float(data[1]);
+		float z = float(data[2]) - fabs(x) - fabs(y);
+
+		// unfold the lower hemisphere
+		float t = (z >= 0.f) ? 0.f : z;
+		x += (x >= 0.f) ? t : -t;
+		y += (y >= 0.f) ? t : -t;
+
+		// normalize
+		float s = maxValue / sqrt(x*x + y*y + z*z);
+		data[0] = T(roundToInt(x * s));
+		data[1] = T(roundToInt(y * s));
+		data[2] = T(roundToInt(z * s));
+	}
+}
+
+
+void MeshoptDecoder::decodeOctahedralFilter(void* data, size_t count, size_t byteStride)
+{
+	if(byteStride == 4)
+		decodeOctahedralFilterImpl(static_cast<int8_t*>(data), count);
+	else if(byteStride == 8)
+		decodeOctahedralFilterImpl(static_cast<int16_t*>(data), count);
+	else
+		throw GltfError("EXT_meshopt_compression: Invalid byteStride for octahedral filter.");
+}
+
+
+void MeshoptDecoder::decodeQuaternionFilter(void* data, size_t count, size_t byteStride)
+{
+	if(byteStride != 8)
+		throw GltfError("EXT_meshopt_compression: Invalid byteStride for quaternion filter.");
+
+	const float scale = 1.f / sqrt(2.f);
+	int16_t* q = static_cast<int16_t*>(data);
+	for(size_t i=0; i<count; i++, q+=4) {
+
+		// the fourth component holds scale in its upper bits
+		// and index of the largest (omitted) component in the lowest two bits
+		int sf = q[3] | 3;
+		float ss = scale / float(sf);
+		float x = float(q[0]) * ss;
+		float y = float(q[1]) * ss;
+		float z = float(q[2]) * ss;
+
+		// reconstruct the largest component
+		// (it is clamped to zero to avoid NaN caused by precision errors)
+		float ww = 1.f - x*x - y*y - z*z;
+		float w = sqrt(max(ww, 0.f));
+
+		// write components in the order given by the index of the largest component
+		int qc = q[3] & 3;
+		int xf = roundToInt(x * 32767.f);
+		int yf = roundToInt(y * 32767.f);
+		int zf = roundToInt(z * 32767.f);
+		int wf = int(w * 32767.f + 0.5f);
+		q[(qc + 1) & 3] = int16_t(xf);
+		q[(qc + 2) & 3] = int16_t(yf);
+		q[(qc + 3) & 3] = int16_t(zf);
+		q[(qc + 0) & 3] = int16_t(wf);
+	}
+}
+
+
+void MeshoptDecoder::decodeExponentialFilter(void* data, size_t count, size_t byteStride)
+{
+	if(byteStride == 0 || byteStride % 4 != 0)
+		throw GltfError("EXT_meshopt_compression: Invalid byteStride for exponential filter.");
+
+	// each 32-bit value is composed of signed 24-bit mantissa and signed 8-bit exponent
+	uint32_t* p = static_cast<uint32_t*>(data);
+	for(size_t i=0, c=count*(byteStride/4); i<c; i++) {
+		uint32_t v = p[i];
+		int m = int32_t(v << 8) >> 8;
+		int e = int32_t(v) >> 24;
+		float f = ldexp(float(m), e);
+		memcpy(&p[i], &f, sizeof(float));
+	}
+}
+
+
+void MeshoptDecoder::decode(void* dst, size_t count, size_t byteStride, Mode mode, Filter filter,
+                            const uint8_t* src, size_t srcSize)
+{
+	switch(mode) {
+	case Mode::Attributes:
+		decodeVertexBuffer(dst, count, byteStride, src, srcSize);
+		switch(filter) {
+		case Filter::None: break;
+		case Filter::Octahedral: decodeOctahedralFilter(dst, count, byteStride); break;
+		case Filter::Quaternion: decodeQuaternionFilter(dst, count, byteStride); break;
+		case Filter::Exponential: decodeExponentialFilter(dst, count, byteStride); break;
+		default: throw GltfError("EXT_meshopt_compression: Unsupported filter.");
+		}
+		return;
+	case Mode::Triangles:
+		if(filter != Filter::None)
+			throw GltfError("EXT_meshopt_compression: Filter is allowed only for ATTRIBUTES mode.");
+		decodeIndexBuffer(dst, count, byteStride, src, srcSize);
+		return;
+	case Mode::Indices:
+		if(filter != Filter::None)
+			throw GltfError("EXT_meshopt_compression: Filter is allowed only for ATTRIBUTES mode.");
+		decodeIndexSequence(dst, count, byteStride, src, srcSize);
+		return;
+	default:
+		throw GltfError("EXT_meshopt_compression: Unsupported mode.");
+	}
+}
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace CadGltf {
+
+
+/** Decoder of bufferViews compressed by EXT_meshopt_compression glTF extension.
+ *
+ *  The extension compresses vertex attributes by the vertex codec (mode ATTRIBUTES),
+ *  triangle lists by the index codec (mode TRIANGLES) and other index data
+ *  by the index sequence codec (mode INDICES). Attribute data might be further
+ *  transformed by octahedral, quaternion or exponential filter before compression,
+ *  and the filter is reverted after decoding. The bitstreams follow the extension specification,
+ *  e.g. vertex codec version 0, index codec version 1 and index sequence codec version 1.
+ *
+ *  All the functions are thread-safe, so separate bufferViews might be decoded in parallel.
+ *  Malformed data throw CadR::LogicError. The decoders never read outside of the source data.
+ */
+namespace MeshoptDecoder {
+
+	enum class Mode : uint8_t { Unknown, Attributes, Triangles, Indices };
+	enum class Filter : uint8_t { None, Octahedral, Quaternion, Exponential, Unknown };
+
+	CADGLTF_EXPORT void decode(void* dst, size_t count, size_t byteStride, Mode mode, Filter filter,
+	                           const uint8_t* src, size_t srcSize);  //< Decodes count elements of byteStride size into dst using the given mode and filter. Throws if byteStride is not allowed for the mode or filter.
+
+	// codecs
+	CADGLTF_EXPORT void decodeVertexBuffer(void* dst, size_t count, size_t byteStride, const uint8_t* src, size_t srcSize);  //< Decodes vertex codec data. byteStride must be multiple of 4 up to 256.
+	CADGLTF_EXPORT void decodeIndexBuffer(void* dst, size_t count, size_t byteStride, const uint8_t* src, size_t srcSize);  //< Decodes index codec data of triangle list. count must be multiple of 3, byteStride 2 or 4.
+	CADGLTF_EXPORT void decodeIndexSequence(void* dst, size_t count, size_t byteStride, const uint8_t* src, size_t srcSize);  //< Decodes index sequence codec data. byteStride must be 2 or 4.
+
+	// filters
+	// (they are applied in place on decoded data)
+	CADGLTF_EXPORT void decodeOctahedralFilter(void* data, size_t count, size_t byteStride);  //< Reconstructs unit vectors from octahedral encoding. byteStride is 4 for 8-bit components and 8 for 16-bit components. The fourth component is preserved.
+	CADGLTF_EXPORT void decodeQuaternionFilter(void* data, size_t count, size_t byteStride);  //< Reconstructs unit quaternions stored as three smallest 16-bit components. byteStride must be 8.
+	CADGLTF_EXPORT void decodeExponentialFilter(void* data, size_t count, size_t byteStride);  //< Converts 24-bit mantissa and 8-bit exponent values into floats. byteStride must be multiple of 4.
+
+}
+
+
+}
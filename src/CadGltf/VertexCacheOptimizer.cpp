@@ -0,0 +1,223 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include <CadGltf/VertexCacheOptimizer.h>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+using namespace CadGltf;
+
+
+template<typename T>
+static size_t countCacheMissesT(const T* indices, size_t numIndices, size_t numVertices, unsigned cacheSize)
+{
+	// FIFO cache simulation
+	// (vertex is in the cache if less than cacheSize misses happened since its insertion;
+	// time starts above cacheSize, so zero-initialized insertion times mean empty cache)
+	vector<size_t> insertionTime(numVertices, 0);
+	size_t time = size_t(cacheSize) + 1;
+	size_t numMisses = 0;
+	for(size_t i=0; i<numIndices; i++) {
+		size_t v = indices[i];
+		if(v >= numVertices) {
+			numMisses++;
+			continue;
+		}
+		if(time - insertionTime[v] > cacheSize) {
+			insertionTime[v] = time;
+			time++;
+			numMisses++;
+		}
+	}
+	return numMisses;
+}
+
+
+template<typename T>
+static void optimizeT(T* indices, size_t numIndices, size_t numVertices, const glm::vec3* positions, unsigned cacheSize)
+{
+	size_t numTriangles = numIndices / 3;
+	if(numTriangles < 2)
+		return;
+	numIndices = numTriangles * 3;
+
+	// number of not emitted triangles of each vertex
+	// (indices out of range leave the data unchanged)
+	vector<uint32_t> liveCount(numVertices, 0);
+	for(size_t i=0; i<numIndices; i++) {
+		if(indices[i] >= numVertices)
+			return;
+		liveCount[indices[i]]++;
+	}
+
+	// vertex-triangle adjacency
+	vector<uint32_t> adjacencyOffset(numVertices + 1);
+	adjacencyOffset[0] = 0;
+	partial_sum(liveCount.begin(), liveCount.end(), adjacencyOffset.begin() + 1);
+	vector<uint32_t> adjacency(numIndices);
+	{
+		vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for(size_t i=0; i<numIndices; i++)
+			adjacency[fill[indices[i]]++] = uint32_t(i / 3);
+	}
+
+	// Tipsify
+	// (the cache is simulated by insertion times as in countCacheMisses();
+	// cluster boundaries are recorded on dead ends if they are needed for overdraw sorting)
+	vector<T> output;
+	output.reserve(numIndices);
+	vector<uint32_t> insertionTime(numVertices, 0);
+	vector<uint8_t> emitted(numTriangles, 0);
+	vector<uint32_t> deadEndStack;
+	deadEndStack.reserve(numIndices);
+	vector<uint32_t> candidates;
+	vector<size_t> clusterStartList;
+	clusterStartList.push_back(0);
+	uint32_t time = cacheSize + 1;
+	size_t cursor = 0;
+	constexpr uint32_t none = ~uint32_t(0);
+	uint32_t fanningVertex = indices[0];
+	while(fanningVertex != none) {
+
+		// emit all not emitted triangles of the fanning vertex
+		candidates.clear();
+		for(uint32_t i=adjacencyOffset[fanningVertex], e=adjacencyOffset[fanningVertex+1]; i<e; i++) {
+			uint32_t t = adjacency[i];
+			if(emitted[t])
+				continue;
+			emitted[t] = 1;
+			for(unsigned j=0; j<3; j++) {
+				uint32_t v = indices[t*3+j];
+				output.push_back(T(v));
+				deadEndStack.push_back(v);
+				candidates.push_back(v);
+				liveCount[v]--;
+				if(time - insertionTime[v] > cacheSize) {
+					insertionTime[v] = time;
+					time++;
+				}
+			}
+		}
+
+		// choose next fanning vertex among the vertices of emitted triangles;
+		// prefer the vertex that stays in the cache while its remaining triangles are emitted
+		// and that was inserted into the cache the earliest
+		uint32_t next = none;
+		int64_t bestPriority = -1;
+		for(uint32_t v : candidates) {
+			if(liveCount[v] == 0)
+				continue;
+			int64_t priority = 0;
+			int64_t age = time - insertionTime[v];
+			if(age + 2 * int64_t(liveCount[v]) <= int64_t(cacheSize))
+				priority = age;
+			if(priority > bestPriority) {
+				bestPriority = priority;
+				next = v;
+			}
+		}
+
+		// dead end
+		// (use the most recently referenced vertex with remaining triangles,
+		// or scan vertices for any remaining triangles)
+		if(next == none) {
+			while(!deadEndStack.empty()) {
+				uint32_t v = deadEndStack.back();
+				deadEndStack.pop_back();
+				if(liveCount[v] > 0) {
+					next = v;
+					break;
+				}
+			}
+			if(next == none)
+				for(; cursor<numVertices; cursor++)
+					if(liveCount[cursor] > 0) {
+						next = uint32_t(cursor);
+						break;
+					}
+			if(next != none && positions)
+				clusterStartList.push_back(output.size() / 3);
+		}
+
+		fanningVertex = next;
+	}
+
+	// sort clusters to reduce overdraw
+	// (clusters facing out of mesh centroid are rendered first;
+	// the centroids and normals are area weighted)
+	size_t numClusters = clusterStartList.size();
+	if(positions && numClusters > 1) {
+		clusterStartList.push_back(numTriangles);
+		vector<glm::vec3> clusterCentroid(numClusters, glm::vec3(0.f));
+		vector<glm::vec3> clusterNormal(numClusters, glm::vec3(0.f));
+		vector<float> clusterArea(numClusters, 0.f);
+		glm::vec3 meshCentroid(0.f);
+		float meshArea = 0.f;
+		for(size_t c=0; c<numClusters; c++) {
+			for(size_t t=clusterStartList[c], e=clusterStartList[c+1]; t<e; t++) {
+				const glm::vec3& p0 = positions[output[t*3+0]];
+				const glm::vec3& p1 = positions[output[t*3+1]];
+				const glm::vec3& p2 = positions[output[t*3+2]];
+				glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(n);
+				clusterCentroid[c] += (p0 + p1 + p2) * area;
+				clusterNormal[c] += n;
+				clusterArea[c] += area;
+			}
+			meshCentroid += clusterCentroid[c];
+			meshArea += clusterArea[c];
+		}
+		if(meshArea == 0.f)
+			return void(memcpy(indices, output.data(), numIndices * sizeof(T)));
+		meshCentroid /= meshArea * 3.f;
+		vector<float> key(numClusters, 0.f);
+		for(size_t c=0; c<numClusters; c++) {
+			float normalLength = glm::length(clusterNormal[c]);
+			if(clusterArea[c] > 0.f && normalLength > 0.f)
+				key[c] = glm::dot(clusterCentroid[c] / (clusterArea[c] * 3.f) - meshCentroid, clusterNormal[c] / normalLength);
+		}
+		vector<uint32_t> order(numClusters);
+		iota(order.begin(), order.end(), 0);
+		stable_sort(order.begin(), order.end(), [&key](uint32_t a, uint32_t b) { return key[a] > key[b]; });
+
+		// write indices in the cluster order
+		T* dst = indices;
+		for(uint32_t c : order) {
+			size_t n = (clusterStartList[c+1] - clusterStartList[c]) * 3;
+			memcpy(dst, &output[clusterStartList[c] * 3], n * sizeof(T));
+			dst += n;
+		}
+		return;
+	}
+
+	memcpy(indices, output.data(), numIndices * sizeof(T));
+}
+
+
+size_t VertexCacheOptimizer::countCacheMisses(const uint16_t* indices, size_t numIndices, size_t numVertices, unsigned cacheSize)
+{
+	return countCacheMissesT(indices, numIndices, numVertices, cacheSize);
+}
+
+
+size_t VertexCacheOptimizer::countCacheMisses(const uint32_t* indices, size_t numIndices, size_t numVertices, unsigned cacheSize)
+{
+	return countCacheMissesT(indices, numIndices, numVertices, cacheSize);
+}
+
+
+void VertexCacheOptimizer::optimize(uint16_t* indices, size_t numIndices, size_t numVertices, const glm::vec3* positions, unsigned cacheSize)
+{
+	optimizeT(indices, numIndices, numVertices, positions, cacheSize);
+}
+
+
+void VertexCacheOptimizer::optimize(uint32_t* indices, size_t numIndices, size_t numVertices, const glm::vec3* positions, unsigned cacheSize)
+{
+	optimizeT(indices, numIndices, numVertices, positions, cacheSize);
+}
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace CadGltf {
+
+
+/** Reordering of triangle lists for post-transform vertex cache locality and reduced overdraw.
+ *
+ *  Triangles are reordered by Tipsify algorithm (Sander, Nehab, Barczak: Fast Triangle Reordering
+ *  for Vertex Locality and Reduced Overdraw, 2007) that runs in linear time. The algorithm fans
+ *  around the vertices while preferring the vertices that stay in the cache. When it reaches
+ *  the dead end, it restarts from a vertex with remaining triangles. The restarts split
+ *  the triangles into clusters. If vertex positions are provided, the clusters are sorted
+ *  so that the clusters facing out of the mesh center are rendered first, as they tend to occlude
+ *  the other clusters. The order of triangles inside the clusters is kept, so the cache locality
+ *  is affected only on the cluster boundaries.
+ *
+ *  The cache efficiency is measured by average cache miss ratio (ACMR), i.e. the number of
+ *  vertex shader invocations per triangle using FIFO cache of the given size. It is 3 for no reuse
+ *  and about 0.5 for optimal ordering of large regular meshes.
+ *
+ *  All the functions are thread-safe, so separate index lists might be processed in parallel.
+ */
+namespace VertexCacheOptimizer {
+
+	constexpr unsigned defaultCacheSize = 16;
+
+	// cache simulation
+	CADGLTF_EXPORT size_t countCacheMisses(const uint16_t* indices, size_t numIndices, size_t numVertices, unsigned cacheSize = defaultCacheSize);  //< Returns the number of misses of FIFO cache of cacheSize entries while processing the indices. Indices out of numVertices range are counted as misses.
+	CADGLTF_EXPORT size_t countCacheMisses(const uint32_t* indices, size_t numIndices, size_t numVertices, unsigned cacheSize = defaultCacheSize);  //< Returns the number of misses of FIFO cache of cacheSize entries while processing the indices. Indices out of numVertices range are counted as misses.
+	inline double computeAcmr(const uint16_t* indices, size_t numIndices, size_t numVertices, unsigned cacheSize = defaultCacheSize);  //< Returns average cache miss ratio of triangle list.
+	inline double computeAcmr(const uint32_t* indices, size_t numIndices, size_t numVertices, unsigned cacheSize = defaultCacheSize);  //< Returns average cache miss ratio of triangle list.
+
+	// reordering
+	CADGLTF_EXPORT void optimize(uint16_t* indices, size_t numIndices, size_t numVertices,
+	                             const glm::vec3* positions = nullptr, unsigned cacheSize = defaultCacheSize);  //< Reorders triangles of triangle list in place. If positions of numVertices vertices are given, triangle clusters are sorted to reduce overdraw. If any index is out of numVertices range, the indices are left unchanged.
+	CADGLTF_EXPORT void optimize(uint32_t* indices, size_t numIndices, size_t numVertices,
+	                             const glm::vec3* positions = nullptr, unsigned cacheSize = defaultCacheSize);  //< Reorders triangles of triangle list in place. If positions of numVertices vertices are given, triangle clusters are sorted to reduce overdraw. If any index is out of numVertices range, the indices are left unchanged.
+
+}
+
+
+// inline functions
+inline double VertexCacheOptimizer::computeAcmr(const uint16_t* indices, size_t numIndices, size_t numVertices, unsigned cacheSize)  { return (numIndices >= 3) ? double(countCacheMisses(indices, numIndices, numVertices, cacheSize)) / double(numIndices / 3) : 0.; }
+inline double VertexCacheOptimizer::computeAcmr(const uint32_t* indices, size_t numIndices, size_t numVertices, unsigned cacheSize)  { return (numIndices >= 3) ? double(countCacheMisses(indices, numIndices, numVertices, cacheSize)) / double(numIndices / 3) : 0.; }
+
+
+}
@@ -3,7 +3,13 @@
 // SPDX-License-Identifier: MIT
 
 #include <CadPL/PipelineLibrary.h>
+#include <CadPL/ShaderGenerator.h>
+#include <CadR/Exceptions.h>
 #include <CadR/VulkanDevice.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
 
 using namespace std;
 using namespace CadPL;
@@ -19,6 +25,9 @@ static constexpr const vk::PipelineVertexInputStateCreateInfo pipelineVertexInpu
 );
 
 // specialization data map
+// (the first six entries describe projection constants;
+// the remaining entries describe optimization constants, see PipelineLibrary::SpecializationData)
+static constexpr const uint32_t numProjectionConstants = 6;
 static constexpr const std::array specializationMap {
 	vk::SpecializationMapEntry{0,0,4},  // constantID, offset, size
 	vk::SpecializationMapEntry{1,4,4},
@@ -26,13 +35,96 @@ static constexpr const std::array specializationMap {
 	vk::SpecializationMapEntry{3,12,4},
 	vk::SpecializationMapEntry{4,16,4},
 	vk::SpecializationMapEntry{5,20,4},
+	vk::SpecializationMapEntry{6,24,4},
+	vk::SpecializationMapEntry{7,28,4},
+	vk::SpecializationMapEntry{8,32,4},
+	vk::SpecializationMapEntry{9,36,4},
+	vk::SpecializationMapEntry{10,40,4},
+	vk::SpecializationMapEntry{11,44,4},
+	vk::SpecializationMapEntry{12,48,4},
+	vk::SpecializationMapEntry{13,52,4},
+	vk::SpecializationMapEntry{14,56,4},
+	vk::SpecializationMapEntry{15,60,4},
+	vk::SpecializationMapEntry{16,64,4},
+	vk::SpecializationMapEntry{17,68,4},
+	vk::SpecializationMapEntry{18,72,4},
+	vk::SpecializationMapEntry{19,76,4},
+	vk::SpecializationMapEntry{20,80,4},
+	vk::SpecializationMapEntry{21,84,4},
+	vk::SpecializationMapEntry{22,88,4},
+	vk::SpecializationMapEntry{23,92,4},
+	vk::SpecializationMapEntry{24,96,4},
+	vk::SpecializationMapEntry{25,100,4},
+	vk::SpecializationMapEntry{26,104,4},
+	vk::SpecializationMapEntry{27,108,4},
+	vk::SpecializationMapEntry{28,112,4},
 };
 
+// default values of projection constants as declared in the shaders
+static constexpr const array<float,6> defaultProjectionConstants{ 0.f, 0.f, 0.f, 0.f, 0.f, 1.f };
+
+// materialSetup and textureSetup bits covered by particular optimize flags
+// (they must match the values in UberShaderInterface.glsl)
+static constexpr const uint32_t materialModelBits = 0x000103ff;
+static constexpr const uint32_t materialColorAttributeBits = 0x0000c000;
+static constexpr const uint32_t materialAlphaBits = 0x00003c00;
+static constexpr const uint32_t textureTypesAndTexCoordIndicesBits = 0x0000ffff;
+static constexpr const uint32_t textureFlagsBits = 0xffff0000;
+
+
+array<uint32_t,PipelineFamily::numOptimizationConstants> PipelineFamily::computeOptimizationConstants(const ShaderState& shaderState)
+{
+	// all data that are not baked into the pipeline are set to zero,
+	// so the pipelines differing only in unoptimized data get the same specialization
+	array<uint32_t,numOptimizationConstants> r{};
+	const auto& flags = shaderState.optimizeFlags;
+	r[0] = uint32_t(flags.to_ulong());
+
+	// attribs
+	if((flags & ShaderState::OptimizeAttribs).any()) {
+		static_assert(sizeof(ShaderState::attribAccessInfo) == 8*sizeof(uint32_t), "Unexpected attribAccessInfo size.");
+		memcpy(&r[1], shaderState.attribAccessInfo.data(), sizeof(shaderState.attribAccessInfo));
+		r[9] = shaderState.attribSetup;
+	}
+
+	// material
+	uint32_t materialBits =
+		((flags & ShaderState::OptimizeMaterialModel).any() ? materialModelBits : 0) |
+		((flags & ShaderState::OptimizeMaterialColorAttribute).any() ? materialColorAttributeBits : 0) |
+		((flags & ShaderState::OptimizeMaterialAlpha).any() ? materialAlphaBits : 0);
+	r[10] = shaderState.materialSetup & materialBits;
+
+	// textures
+	uint32_t textureBits =
+		((flags & ShaderState::OptimizeTextureTypesAndTexCoordIndices).any() ? textureTypesAndTexCoordIndicesBits : 0) |
+		((flags & ShaderState::OptimizeTextureFlags).any() ? textureFlagsBits : 0);
+	for(size_t i=0; i<shaderState.textureSetup.size(); i++)
+		r[11+i] = shaderState.textureSetup[i] & textureBits;
+
+	// lights
+	if((flags & ShaderState::OptimizeLightTypes).any()) {
+		static_assert(sizeof(ShaderState::lightSetup) == 2*sizeof(uint32_t), "Unexpected lightSetup size.");
+		memcpy(&r[21], shaderState.lightSetup.data(), sizeof(shaderState.lightSetup));
+	}
+
+	return r;
+}
+
 
 
 
 PipelineLibrary::~PipelineLibrary()
 {
+	// release pipelines of asynchronous creation and stop worker threads
+	discardAsyncPipelines();
+	{
+		lock_guard lock(_jobMutex);
+		_exitThreads = true;
+	}
+	_jobAvailableCondition.notify_all();
+	for(thread& t : _threadList)
+		t.join();
+
 	assert(_pipelineFamilyMap.empty() && "PipelineLibrary::~PipelineLibrary(): All pipelines "
 		"owned by PipelineLibrary must be released before destroying PipelineLibrary.");
 }
@@ -41,6 +133,7 @@ PipelineLibrary::~PipelineLibrary()
 PipelineFamily::~PipelineFamily()
 {
 	assert(_pipelineMap.empty() && "PipelineFamily::~PipelineFamily(): All SharedPipelines must be released before destroying PipelineFamily or PipelineLibrary.");
+	destroyShaderObjects();
 }
 
 
@@ -56,12 +149,8 @@ void PipelineFamily::destroyPipeline(void* pipelineObject) noexcept
 }
 
 
-SharedPipeline PipelineFamily::getOrCreatePipeline(const PipelineState& pipelineState)
+SharedPipeline PipelineFamily::initPipelineObject(std::map<PipelineState, PipelineObject>::iterator it) noexcept
 {
-	auto [it, newRecord] = _pipelineMap.try_emplace(pipelineState);
-	if(!newRecord)
-		return SharedPipeline(&it->second);
-
 	// initialize new record
 	// (do not throw until SharedPipeline is created)
 	it->second.cadrPipeline.init(
@@ -72,17 +161,272 @@ SharedPipeline PipelineFamily::getOrCreatePipeline(const PipelineState& pipeline
 	it->second.referenceCounter = 0;
 	it->second.pipelineFamily = this;
 	it->second.mapIterator = it;
-	SharedPipeline sharedPipeline(&it->second);
+	it->second.pending = false;
+	return SharedPipeline(&it->second);
+}
 
+
+bool PipelineFamily::isReadyForCreation(const PipelineState& pipelineState) const
+{
 	// if viewport, scissor or projection matrix were not set yet
-	// and they are required by the pipeline, skip pipeline creation;
+	// and they are required by the pipeline, the pipeline cannot be created yet
 	// (the pipeline will be created in setProjectionViewportAndScissor() or similar function)
 	if(pipelineState.viewportAndScissorHandling == PipelineState::ViewportAndScissorHandling::SetFunction &&
 		(_pipelineLibrary->_viewportList.empty() || _pipelineLibrary->_scissorList.empty()))
-			return sharedPipeline;
+			return false;
 	if(_mapIterator->first.projectionHandling == ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants &&
 		_pipelineLibrary->_specializationData.empty())
-			return sharedPipeline;
+			return false;
+	return true;
+}
+
+
+static void recordDynamicState(const PipelineState& s, vk::PrimitiveTopology primitiveTopology,
+	vk::CommandBuffer commandBuffer, CadR::VulkanDevice& device)
+{
+	// viewport and scissor
+	if(s.viewportAndScissorHandling != PipelineState::ViewportAndScissorHandling::DynamicState) {
+		device.cmdSetViewportWithCountEXT(commandBuffer, 1, &s.viewport);
+		device.cmdSetScissorWithCountEXT(commandBuffer, 1, &s.scissor);
+	}
+
+	// input assembly and vertex input
+	// (vertex data are read through buffer device address, so there are no vertex attributes)
+	device.cmdSetPrimitiveTopologyEXT(commandBuffer, primitiveTopology);
+	device.cmdSetPrimitiveRestartEnableEXT(commandBuffer, VK_FALSE);
+	device.cmdSetVertexInputEXT(commandBuffer, 0, nullptr, 0, nullptr);
+
+	// rasterization
+	device.cmdSetRasterizerDiscardEnableEXT(commandBuffer, VK_FALSE);
+	device.cmdSetDepthClampEnableEXT(commandBuffer, VK_FALSE);
+	device.cmdSetPolygonModeEXT(commandBuffer, vk::PolygonMode::eFill);
+	device.cmdSetCullModeEXT(commandBuffer, s.cullMode);
+	device.cmdSetFrontFaceEXT(commandBuffer, s.frontFace);
+	device.cmdSetDepthBiasEnableEXT(commandBuffer, s.depthBiasEnable);
+	if(s.depthBiasEnable && !s.depthBiasDynamicState)
+		device.cmdSetDepthBias(commandBuffer, s.depthBiasConstantFactor, s.depthBiasClamp, s.depthBiasSlopeFactor);
+	if(!s.lineWidthDynamicState)
+		device.cmdSetLineWidth(commandBuffer, s.lineWidth);
+
+	// multisampling
+	// (sample mask covers up to 64 samples)
+	static constexpr const array<vk::SampleMask,2> sampleMask{ ~uint32_t(0), ~uint32_t(0) };
+	device.cmdSetRasterizationSamplesEXT(commandBuffer, s.rasterizationSamples);
+	device.cmdSetSampleMaskEXT(commandBuffer, s.rasterizationSamples, sampleMask.data());
+	device.cmdSetAlphaToCoverageEnableEXT(commandBuffer, VK_FALSE);
+	device.cmdSetAlphaToOneEnableEXT(commandBuffer, VK_FALSE);
+
+	// depth and stencil
+	device.cmdSetDepthTestEnableEXT(commandBuffer, s.depthTestEnable);
+	device.cmdSetDepthWriteEnableEXT(commandBuffer, s.depthWriteEnable);
+	device.cmdSetDepthCompareOpEXT(commandBuffer, vk::CompareOp::eLess);
+	device.cmdSetDepthBoundsTestEnableEXT(commandBuffer, VK_FALSE);
+	device.cmdSetStencilTestEnableEXT(commandBuffer, VK_FALSE);
+
+	// color blending
+	device.cmdSetLogicOpEnableEXT(commandBuffer, VK_FALSE);
+	if(s.numColorAttachments == 0)
+		return;
+	array<vk::Bool32,PipelineState::maxColorAttachments> blendEnableList;
+	array<vk::ColorBlendEquationEXT,PipelineState::maxColorAttachments> blendEquationList;
+	array<vk::ColorComponentFlags,PipelineState::maxColorAttachments> colorWriteMaskList;
+	for(uint32_t i=0; i<s.numColorAttachments; i++) {
+		const PipelineState::BlendAttachmentState& b = s.blendState[i];
+		blendEnableList[i] = b.blendEnable;
+		blendEquationList[i] =
+			vk::ColorBlendEquationEXT(
+				b.srcColorBlendFactor,  // srcColorBlendFactor
+				b.dstColorBlendFactor,  // dstColorBlendFactor
+				b.colorBlendOp,  // colorBlendOp
+				b.srcAlphaBlendFactor,  // srcAlphaBlendFactor
+				b.dstAlphaBlendFactor,  // dstAlphaBlendFactor
+				b.alphaBlendOp  // alphaBlendOp
+			);
+		colorWriteMaskList[i] = b.colorWriteMask;
+	}
+	device.cmdSetColorBlendEnableEXT(commandBuffer, 0, s.numColorAttachments, blendEnableList.data());
+	device.cmdSetColorBlendEquationEXT(commandBuffer, 0, s.numColorAttachments, blendEquationList.data());
+	device.cmdSetColorWriteMaskEXT(commandBuffer, 0, s.numColorAttachments, colorWriteMaskList.data());
+}
+
+
+void PipelineFamily::destroyShaderObjects() noexcept
+{
+	for(const array<vk::ShaderEXT,3>& shaders : _shaderObjectList)
+		for(vk::ShaderEXT s : shaders)
+			_device->destroy(s);
+	_shaderObjectList.clear();
+}
+
+
+void PipelineFamily::createShaderObjects()
+{
+	PipelineLibrary& l = *_pipelineLibrary;
+	const ShaderState& shaderState = this->shaderState();
+
+	// one set of shader objects for each projection
+	// (projection is baked into the shaders through specialization constants,
+	// so no shader objects can be created until the projection is set)
+	bool perspectiveConstants =
+		shaderState.projectionHandling == ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants;
+	size_t numSets = (perspectiveConstants) ? l._specializationData.size() : 1;
+
+	// shader code
+	bool fragmentShaderBarycentric = l._shaderLibrary->fragmentShaderBarycentric();
+	auto [vertexCode, vertexCodeSize] = ShaderGenerator::getVertexShaderCode(shaderState, fragmentShaderBarycentric);
+	auto [geometryCode, geometryCodeSize] =
+		(fragmentShaderBarycentric)
+			? tuple<const uint32_t*,size_t>(nullptr, 0)
+			: ShaderGenerator::getGeometryShaderCode(shaderState);
+	auto [fragmentCode, fragmentCodeSize] = ShaderGenerator::getFragmentShaderCode(shaderState, fragmentShaderBarycentric);
+	const vector<vk::DescriptorSetLayout>& descriptorSetLayoutList = l.descriptorSetLayoutList();
+
+	// create shader objects
+	// (shaders are not linked, so they can be freely combined in the future)
+	vector<array<vk::ShaderEXT,3>> shaderObjectList;
+	shaderObjectList.reserve(numSets);
+	for(size_t i=0; i<numSets; i++) {
+
+		// specialization constants
+		PipelineLibrary::SpecializationData specializationData{
+			(perspectiveConstants) ? l._specializationData[i] : defaultProjectionConstants,  // projection
+			_optimizationConstants,  // optimization
+		};
+		vk::SpecializationInfo specializationInfo(
+			uint32_t(specializationMap.size()),  // mapEntryCount
+			specializationMap.data(),  // pMapEntries
+			sizeof(PipelineLibrary::SpecializationData),  // dataSize
+			&specializationData  // pData
+		);
+
+		// create infos
+		auto createInfo =
+			[&](vk::ShaderStageFlagBits stage, vk::ShaderStageFlags nextStage, const uint32_t* code, size_t codeSize) {
+				return
+					vk::ShaderCreateInfoEXT(
+						vk::ShaderCreateFlagsEXT(),  // flags
+						stage,  // stage
+						nextStage,  // nextStage
+						vk::ShaderCodeTypeEXT::eSpirv,  // codeType
+						codeSize,  // codeSize
+						code,  // pCode
+						"main",  // pName
+						uint32_t(descriptorSetLayoutList.size()),  // setLayoutCount
+						descriptorSetLayoutList.data(),  // pSetLayouts
+						1,  // pushConstantRangeCount
+						&ShaderLibrary::pushConstantRange,  // pPushConstantRanges
+						&specializationInfo  // pSpecializationInfo
+					);
+			};
+		array<vk::ShaderCreateInfoEXT,3> createInfoList;
+		uint32_t numShaders = 0;
+		createInfoList[numShaders++] =
+			createInfo(vk::ShaderStageFlagBits::eVertex,
+			           (geometryCode) ? vk::ShaderStageFlagBits::eGeometry : vk::ShaderStageFlagBits::eFragment,
+			           vertexCode, vertexCodeSize);
+		if(geometryCode)
+			createInfoList[numShaders++] =
+				createInfo(vk::ShaderStageFlagBits::eGeometry, vk::ShaderStageFlagBits::eFragment,
+				           geometryCode, geometryCodeSize);
+		createInfoList[numShaders++] =
+			createInfo(vk::ShaderStageFlagBits::eFragment, vk::ShaderStageFlags(),
+			           fragmentCode, fragmentCodeSize);
+
+		// create shaders
+		array<vk::ShaderEXT,3> shaders{};
+		VkResult r =
+			_device->vkCreateShadersEXT(
+				_device->handle(),  // device
+				numShaders,  // createInfoCount
+				reinterpret_cast<VkShaderCreateInfoEXT*>(createInfoList.data()),  // pCreateInfos
+				nullptr,  // pAllocator
+				reinterpret_cast<VkShaderEXT*>(shaders.data())  // pShaders
+			);
+		if(r != VK_SUCCESS) {
+			for(vk::ShaderEXT s : shaders)
+				_device->destroy(s);
+			for(const array<vk::ShaderEXT,3>& createdShaders : shaderObjectList)
+				for(vk::ShaderEXT s : createdShaders)
+					_device->destroy(s);
+		#if VK_HEADER_VERSION < 256  // throwResultException moved to detail namespace on 2023-06-28 and the change went public in 1.3.256
+			vk::throwResultException(vk::Result(r), "vk::Device::createShadersEXT");
+		#else
+			vk::detail::throwResultException(vk::Result(r), "vk::Device::createShadersEXT");
+		#endif
+		}
+		shaderObjectList.push_back({ shaders[0], (geometryCode) ? shaders[1] : nullptr, shaders[numShaders-1] });
+	}
+
+	// replace shader objects and update all pipelines
+	destroyShaderObjects();
+	_shaderObjectList = move(shaderObjectList);
+	for(auto& [pipelineState, pipelineObject] : _pipelineMap)
+		updateShaderObjectPipeline(pipelineObject);
+}
+
+
+void PipelineFamily::updateShaderObjectPipeline(PipelineObject& pipelineObject) noexcept
+{
+	// use shader objects of the pipeline's projection
+	// (they are null if the projection was not set yet)
+	size_t i =
+		(shaderState().projectionHandling == ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants)
+			? pipelineObject.mapIterator->first.projectionIndex
+			: 0;
+	if(i < _shaderObjectList.size()) {
+		const array<vk::ShaderEXT,3>& shaders = _shaderObjectList[i];
+		pipelineObject.cadrPipeline.setShaderObjects(shaders[0], shaders[1], shaders[2]);
+	}
+	else
+		pipelineObject.cadrPipeline.setShaderObjects(nullptr, nullptr, nullptr);
+}
+
+
+void PipelineFamily::initShaderObjectPipeline(PipelineObject& pipelineObject)
+{
+	// shader objects do not support render passes
+	const PipelineState* pipelineState = &pipelineObject.mapIterator->first;
+	if(pipelineState->renderPass)
+		throw CadR::LogicError("PipelineFamily::getOrCreatePipeline(): Shader objects support dynamic rendering only. "
+		                       "PipelineState::renderPass must be null.");
+
+	// record all the PipelineState as dynamic state
+	// (PipelineState is the key of _pipelineMap, so its address does not change
+	// and viewport and scissor updates made by PipelineLibrary::setProjectionViewportAndScissor() are visible)
+	vk::PrimitiveTopology primitiveTopology = _primitiveTopology;
+	pipelineObject.cadrPipeline.setDynamicStateFunc(
+		[pipelineState, primitiveTopology](vk::CommandBuffer commandBuffer, CadR::VulkanDevice& device) {
+			recordDynamicState(*pipelineState, primitiveTopology, commandBuffer, device);
+		}
+	);
+
+	// create shader objects on the first use
+	if(_shaderObjectList.empty())
+		createShaderObjects();
+	else
+		updateShaderObjectPipeline(pipelineObject);
+}
+
+
+SharedPipeline PipelineFamily::getOrCreatePipeline(const PipelineState& pipelineState)
+{
+	auto [it, newRecord] = _pipelineMap.try_emplace(pipelineState);
+	if(!newRecord)
+		return SharedPipeline(&it->second);
+
+	// initialize new record
+	SharedPipeline sharedPipeline = initPipelineObject(it);
+
+	// shader objects are shared by all the pipelines of the family,
+	// so no pipeline is created
+	if(_useShaderObjects) {
+		initShaderObjectPipeline(it->second);
+		return sharedPipeline;
+	}
+
+	// skip pipeline creation if viewport, scissor or projection matrix were not set yet
+	if(!isReadyForCreation(pipelineState))
+		return sharedPipeline;
 
 	// create pipeline
 	PipelineLibrary::CreationDataSet creationDataSet(*_pipelineLibrary);
@@ -92,22 +436,339 @@ SharedPipeline PipelineFamily::getOrCreatePipeline(const PipelineState& pipeline
 }
 
 
-SharedPipeline PipelineLibrary::getOrCreatePipeline(const ShaderState& shaderState, const PipelineState& pipelineState)
+SharedPipeline PipelineFamily::getOrCreatePipelineAsync(const PipelineState& pipelineState)
+{
+	// shader objects are created at most once per family,
+	// so there is nothing to be created asynchronously
+	if(_useShaderObjects)
+		return getOrCreatePipeline(pipelineState);
+
+	auto [it, newRecord] = _pipelineMap.try_emplace(pipelineState);
+	if(!newRecord)
+		return SharedPipeline(&it->second);
+
+	// initialize new record
+	SharedPipeline sharedPipeline = initPipelineObject(it);
+
+	// skip pipeline creation if viewport, scissor or projection matrix were not set yet
+	if(!isReadyForCreation(pipelineState))
+		return sharedPipeline;
+
+	// append the pipeline into the set of pipelines
+	// that will be submitted to the worker threads by PipelineLibrary::updateAsyncPipelines()
+	PipelineLibrary& l = *_pipelineLibrary;
+	if(!l._asyncCreationData)
+		l._asyncCreationData = make_unique<PipelineLibrary::AsyncCreationData>(l);
+	l._asyncCreationData->requestTimeList.emplace_back(chrono::steady_clock::now());
+	try {
+		l._asyncCreationData->creationDataSet.append(SharedPipeline(&it->second), pipelineState);
+	} catch(...) {
+		l._asyncCreationData->requestTimeList.pop_back();
+		throw;
+	}
+	it->second.pending = true;
+	l._asyncPipelineStats.numRequested++;
+	l._asyncPipelineStats.numPending++;
+	return sharedPipeline;
+}
+
+
+PipelineFamily& PipelineLibrary::getOrCreatePipelineFamily(const ShaderState& shaderState)
 {
 	auto [it, newRecord] = _pipelineFamilyMap.try_emplace(shaderState, *this);
 	if(newRecord) {
 		try {
-			it->second._vertexShader = _shaderLibrary->getOrCreateVertexShader(shaderState);
-			it->second._geometryShader = _shaderLibrary->getOrCreateGeometryShader(shaderState);
-			it->second._fragmentShader = _shaderLibrary->getOrCreateFragmentShader(shaderState);
+			// shader modules are not needed by shader objects
+			if(!_useShaderObjects) {
+				it->second._vertexShader = _shaderLibrary->getOrCreateVertexShader(shaderState);
+				it->second._geometryShader = _shaderLibrary->getOrCreateGeometryShader(shaderState);
+				it->second._fragmentShader = _shaderLibrary->getOrCreateFragmentShader(shaderState);
+			}
 		} catch(...) {
 			_pipelineFamilyMap.erase(it);
 			throw;
 		}
 		it->second._mapIterator = it;
 		it->second._primitiveTopology = shaderState.primitiveTopology;
+		it->second._optimizationConstants = PipelineFamily::computeOptimizationConstants(shaderState);
+	}
+	return it->second;
+}
+
+
+SharedPipeline PipelineLibrary::getOrCreatePipeline(const ShaderState& shaderState, const PipelineState& pipelineState)
+{
+	return getOrCreatePipelineFamily(shaderState).getOrCreatePipeline(pipelineState);
+}
+
+
+SharedPipeline PipelineLibrary::getOrCreatePipelineAsync(const ShaderState& shaderState, const PipelineState& pipelineState)
+{
+	return getOrCreatePipelineFamily(shaderState).getOrCreatePipelineAsync(pipelineState);
+}
+
+
+vector<SharedPipeline> PipelineLibrary::prewarm(const vector<pair<ShaderState,PipelineState>>& pipelineList)
+{
+	vector<SharedPipeline> sharedPipelineList;
+	sharedPipelineList.reserve(pipelineList.size());
+	CreationDataSet creationDataSet(*this);
+
+	for(const auto& [shaderState, pipelineState] : pipelineList) {
+
+		// shader object families do not create pipelines
+		PipelineFamily& f = getOrCreatePipelineFamily(shaderState);
+		if(f._useShaderObjects) {
+			sharedPipelineList.emplace_back(f.getOrCreatePipeline(pipelineState));
+			continue;
+		}
+
+		// reuse existing pipeline
+		auto [it, newRecord] = f._pipelineMap.try_emplace(pipelineState);
+		if(!newRecord) {
+			sharedPipelineList.emplace_back(SharedPipeline(&it->second));
+			continue;
+		}
+
+		// initialize new record and append it for creation
+		// (skip pipeline creation if viewport, scissor or projection matrix were not set yet)
+		sharedPipelineList.emplace_back(f.initPipelineObject(it));
+		if(f.isReadyForCreation(pipelineState))
+			creationDataSet.append(SharedPipeline(&it->second), pipelineState);
 	}
-	return it->second.getOrCreatePipeline(pipelineState);
+
+	// create all pipelines in parallel
+	creationDataSet.createPipelines(*this);
+	return sharedPipelineList;
+}
+
+
+size_t PipelineLibrary::updateAsyncPipelines()
+{
+	// swap in pipeline handles of finished AsyncCreationData
+	size_t numSwapped = 0;
+	auto now = chrono::steady_clock::now();
+	for(auto it=_submittedAsyncCreationDataList.begin(); it!=_submittedAsyncCreationDataList.end(); ) {
+
+		// skip unfinished
+		AsyncCreationData& d = **it;
+		{
+			lock_guard lock(_jobMutex);
+			if(!d.finished) {
+				it++;
+				continue;
+			}
+		}
+
+		// process all pipelines
+		size_t i = 0;
+		for(CreationDataBatch& b : d.creationDataSet.batchList)
+			for(size_t j=0, c=b.numSharedPipelines; j<c; j++, i++) {
+				SharedPipeline& sharedPipeline = b.sharedPipelineList[j];
+				vk::Pipeline pipeline = b.createdPipelineList[j];
+				if(!sharedPipeline.pending()) {
+					// pipeline was recreated synchronously in the mean time
+					// (the result of asynchronous creation is outdated)
+					_device->destroy(pipeline);
+					_asyncPipelineStats.numDiscarded++;
+				}
+				else if(!pipeline) {
+					// creation failed
+					sharedPipeline.setPending(false);
+					_asyncPipelineStats.numFailed++;
+				}
+				else {
+					// swap in new pipeline
+					sharedPipeline.replacePipelineHandle(pipeline, *_device);
+					sharedPipeline.setPending(false);
+					double t = chrono::duration<double>(now - d.requestTimeList[i]).count();
+					_asyncPipelineStats.numCompleted++;
+					_asyncPipelineStats.totalTimeToOptimized += t;
+					_asyncPipelineStats.maxTimeToOptimized = max(_asyncPipelineStats.maxTimeToOptimized, t);
+					numSwapped++;
+				}
+			}
+		_asyncPipelineStats.numPending -= i;
+
+		// release AsyncCreationData
+		it = _submittedAsyncCreationDataList.erase(it);
+	}
+
+	// submit newly requested pipelines to the worker threads
+	// (each batch is submitted as a separate job, so the batches are created in parallel)
+	if(_asyncCreationData) {
+		if(_threadList.empty())
+			startThreads();
+		AsyncCreationData* d = _asyncCreationData.get();
+		_submittedAsyncCreationDataList.emplace_back(move(_asyncCreationData));
+		{
+			lock_guard lock(_jobMutex);
+			d->numUnfinishedBatches = d->creationDataSet.batchList.size();
+			for(CreationDataBatch& b : d->creationDataSet.batchList)
+				_jobQueue.emplace_back(
+					[this, d, &b]() {
+						// create pipelines
+						// (failed batches leave null handles in createdPipelineList;
+						// the failures are reported through AsyncPipelineStats::numFailed)
+						try {
+							b.createdPipelineList = b.createPipelines(*_device, _pipelineCache);
+						} catch(...) {
+							b.createdPipelineList.fill(nullptr);
+						}
+						{
+							lock_guard lock(_jobMutex);
+							d->numUnfinishedBatches--;
+							if(d->numUnfinishedBatches == 0)
+								d->finished = true;
+						}
+						_jobFinishedCondition.notify_all();
+					}
+				);
+		}
+		_jobAvailableCondition.notify_all();
+	}
+
+	return numSwapped;
+}
+
+
+void PipelineLibrary::waitForAsyncPipelines()
+{
+	// submit all requested pipelines
+	updateAsyncPipelines();
+
+	// wait for all AsyncCreationData to finish
+	{
+		unique_lock lock(_jobMutex);
+		_jobFinishedCondition.wait(lock,
+			[this]() {
+				for(auto& d : _submittedAsyncCreationDataList)
+					if(!d->finished)
+						return false;
+				return true;
+			}
+		);
+	}
+
+	// swap in pipeline handles
+	updateAsyncPipelines();
+}
+
+
+void PipelineLibrary::discardAsyncPipelines() noexcept
+{
+	// release pipelines that were not submitted yet
+	if(_asyncCreationData) {
+		for(CreationDataBatch& b : _asyncCreationData->creationDataSet.batchList)
+			for(size_t j=0, c=b.numSharedPipelines; j<c; j++)
+				b.sharedPipelineList[j].setPending(false);
+		_asyncPipelineStats.numDiscarded += _asyncCreationData->numPipelines();
+		_asyncPipelineStats.numPending -= _asyncCreationData->numPipelines();
+		_asyncCreationData.reset();
+	}
+
+	// wait for submitted pipelines and destroy them
+	{
+		unique_lock lock(_jobMutex);
+		_jobFinishedCondition.wait(lock,
+			[this]() {
+				for(auto& d : _submittedAsyncCreationDataList)
+					if(!d->finished)
+						return false;
+				return true;
+			}
+		);
+	}
+	for(auto& d : _submittedAsyncCreationDataList) {
+		for(CreationDataBatch& b : d->creationDataSet.batchList)
+			for(size_t j=0, c=b.numSharedPipelines; j<c; j++) {
+				_device->destroy(b.createdPipelineList[j]);
+				b.sharedPipelineList[j].setPending(false);
+			}
+		_asyncPipelineStats.numDiscarded += d->numPipelines();
+		_asyncPipelineStats.numPending -= d->numPipelines();
+	}
+	_submittedAsyncCreationDataList.clear();
+}
+
+
+void PipelineLibrary::startThreads()
+{
+	// leave one core for the rendering thread
+	unsigned numThreads = max(thread::hardware_concurrency(), 2u) - 1;
+	_threadList.reserve(numThreads);
+	for(unsigned i=0; i<numThreads; i++)
+		_threadList.emplace_back(&PipelineLibrary::workerMain, this);
+}
+
+
+void PipelineLibrary::workerMain()
+{
+	unique_lock lock(_jobMutex);
+	while(true) {
+		_jobAvailableCondition.wait(lock, [this]{ return _exitThreads || !_jobQueue.empty(); });
+		if(_exitThreads)
+			return;
+		function<void()> job = move(_jobQueue.front());
+		_jobQueue.pop_front();
+		lock.unlock();
+		job();
+		lock.lock();
+	}
+}
+
+
+void PipelineLibrary::runInParallel(size_t numItems, const function<void(size_t)>& func)
+{
+	// single item is processed by the calling thread
+	if(numItems <= 1) {
+		if(numItems == 1)
+			func(0);
+		return;
+	}
+	if(_threadList.empty())
+		startThreads();
+
+	// items are taken by the jobs and by the calling thread until all of them are processed
+	// (the job might start after this function returned, so the state is reference counted
+	// and such job finds no remaining items and does not touch func)
+	struct State {
+		atomic<size_t> nextItem{0};
+		size_t numActiveJobs = 0;  // protected by _jobMutex
+	};
+	shared_ptr<State> state = make_shared<State>();
+	auto processItems =
+		[state, numItems, &func]() {
+			for(size_t i=state->nextItem++; i<numItems; i=state->nextItem++)
+				func(i);
+		};
+
+	// submit jobs
+	// (if submission fails, the remaining work is done by the calling thread)
+	try {
+		lock_guard lock(_jobMutex);
+		for(size_t i=0, c=min(numItems-1, _threadList.size()); i<c; i++)
+			_jobQueue.emplace_back(
+				[this, state, processItems]() {
+					{
+						lock_guard lock(_jobMutex);
+						state->numActiveJobs++;
+					}
+					processItems();
+					{
+						lock_guard lock(_jobMutex);
+						state->numActiveJobs--;
+					}
+					_jobFinishedCondition.notify_all();
+				}
+			);
+	} catch(...) {}
+	_jobAvailableCondition.notify_all();
+
+	// process items and wait for the jobs
+	processItems();
+	unique_lock lock(_jobMutex);
+	_jobFinishedCondition.wait(lock, [&state]() { return state->numActiveJobs == 0; });
 }
 
 
@@ -149,17 +810,55 @@ void PipelineLibrary::setProjectionViewportAndScissor(const std::vector<glm::mat
 				const_cast<vk::Rect2D&>(pipelineState.scissor) =
 					scissorList.at(pipelineState.scissorIndex);
 
+				// shader objects read viewport and scissor from PipelineState when recording dynamic state
+				if(f._useShaderObjects)
+					continue;
+
 				// append pipeline into the set for recompilation
+				// (pending asynchronous creation of the pipeline is superseded by the recompilation)
 				creationDataSet.append(SharedPipeline(&pipelineIt->second), pipelineState);
+				pipelineIt->second.pending = false;
 			}
-			else if(shaderState.projectionHandling == ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants)
+			else if(shaderState.projectionHandling == ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants &&
+			        !f._useShaderObjects)
+			{
 				// append pipeline into the set for recompilation
 				creationDataSet.append(SharedPipeline(&pipelineIt->second), pipelineState);
+				pipelineIt->second.pending = false;
+			}
 		}
+
+		// recreate shader objects that depend on projection
+		if(f._useShaderObjects &&
+		   shaderState.projectionHandling == ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants)
+			f.createShaderObjects();
 	}
 
 	// create pipelines
 	creationDataSet.createPipelines(*this);
+
+	// requested asynchronous pipelines that were not submitted yet
+	// use outdated projection, viewport and scissor data,
+	// so create new AsyncCreationData and move all still pending pipelines there
+	if(_asyncCreationData) {
+		unique_ptr<AsyncCreationData> oldData = move(_asyncCreationData);
+		size_t i = 0;
+		for(CreationDataBatch& b : oldData->creationDataSet.batchList)
+			for(size_t j=0, c=b.numSharedPipelines; j<c; j++, i++) {
+				SharedPipeline& sharedPipeline = b.sharedPipelineList[j];
+				if(sharedPipeline.pending()) {
+					if(!_asyncCreationData)
+						_asyncCreationData = make_unique<AsyncCreationData>(*this);
+					const PipelineState& pipelineState = *sharedPipeline.pipelineState();
+					_asyncCreationData->creationDataSet.append(move(sharedPipeline), pipelineState);
+					_asyncCreationData->requestTimeList.emplace_back(oldData->requestTimeList[i]);
+				}
+				else {
+					_asyncPipelineStats.numDiscarded++;
+					_asyncPipelineStats.numPending--;
+				}
+			}
+	}
 }
 
 
@@ -173,9 +872,9 @@ PipelineLibrary::CreationDataSet::CreationDataSet(const PipelineLibrary& pipelin
 		get<0>(s) = pipelineLibrary._specializationData[i];
 		get<1>(s) =
 			vk::SpecializationInfo(
-				uint32_t(specializationMap.size()),  // mapEntryCount
+				numProjectionConstants,  // mapEntryCount
 				specializationMap.data(),  // pMapEntries
-				6 * sizeof(float),  // dataSize
+				numProjectionConstants * sizeof(float),  // dataSize
 				get<0>(s).data()  // pData
 			);
 
@@ -203,10 +902,34 @@ void PipelineLibrary::CreationDataBatch::append(SharedPipeline&& sharedPipeline,
 	numCreateInfos++;
 
 	// specializationInfo
-	vk::SpecializationInfo* specializationInfo =
-		(shaderState.projectionHandling == ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants)
-			? &get<1>(creationDataSet->specializationList.at(pipelineState.projectionIndex))
-			: nullptr;
+	// (projection constants are shared by all pipelines of the CreationDataSet
+	// while optimized pipelines get their own SpecializationInfo that includes
+	// both - projection constants and optimization constants)
+	bool perspectiveConstants =
+		shaderState.projectionHandling == ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants;
+	vk::SpecializationInfo* specializationInfo;
+	if(shaderState.optimizeFlags.none())
+		specializationInfo =
+			(perspectiveConstants)
+				? &get<1>(creationDataSet->specializationList.at(pipelineState.projectionIndex))
+				: nullptr;
+	else {
+		auto& s = specializationList[numSpecializations];
+		numSpecializations++;
+		get<0>(s).projection =
+			(perspectiveConstants)
+				? get<0>(creationDataSet->specializationList.at(pipelineState.projectionIndex))
+				: defaultProjectionConstants;
+		get<0>(s).optimization = pipelineFamily._optimizationConstants;
+		get<1>(s) =
+			vk::SpecializationInfo(
+				uint32_t(specializationMap.size()),  // mapEntryCount
+				specializationMap.data(),  // pMapEntries
+				sizeof(SpecializationData),  // dataSize
+				&get<0>(s)  // pData
+			);
+		specializationInfo = &get<1>(s);
+	}
 
 	// stageCount and pStages
 	vk::PipelineShaderStageCreateInfo* shaderStages = &shaderStageList[numShaderStages];
@@ -225,7 +948,7 @@ void PipelineLibrary::CreationDataBatch::append(SharedPipeline&& sharedPipeline,
 			vk::ShaderStageFlagBits::eFragment,  // stage
 			pipelineFamily._fragmentShader,  // module
 			"main",  // pName
-			nullptr,  // pSpecializationInfo
+			specializationInfo,  // pSpecializationInfo
 		};
 	if(pipelineFamily._geometryShader && pipelineFamily._geometryShader.get()) {
 		shaderStages[2] =
@@ -520,25 +1243,47 @@ void PipelineLibrary::CreationDataBatch::append(SharedPipeline&& sharedPipeline,
 }
 
 
-void PipelineLibrary::CreationDataSet::createPipelines(const PipelineLibrary& pipelineLibrary)
+void PipelineLibrary::CreationDataSet::createPipelines(PipelineLibrary& pipelineLibrary)
 {
-	array<vk::Pipeline,CreationDataBatch::numPipelines> pipelines;
-	while(!batchList.empty())
-	{
-		CreationDataBatch& batch = batchList.front();
-
-		// create pipelines
-		// note: do not throw in the following code until pipelines are safely replaced through
-		// SharedPipeline objects; otherwise pipeline handles will be leaked
-		pipelines = batch.createPipelines(*pipelineLibrary._device, pipelineLibrary._pipelineCache);
-
-		// update pipelines inside SharedPipeline object
-		for(size_t i=0, c=batch.numSharedPipelines; i<c; i++)
-			batch.sharedPipelineList[i].replacePipelineHandle(pipelines[i], *pipelineLibrary._device);
+	// create pipelines
+	// (the batches are distributed among the worker threads and the calling thread;
+	// vk::PipelineCache is internally synchronized, so all the threads share the same cache;
+	// exceptions are stored and the first one is rethrown after all the created pipelines
+	// are safely stored in SharedPipeline objects; otherwise pipeline handles would be leaked)
+	vector<CreationDataBatch*> batchPtrList;
+	batchPtrList.reserve(batchList.size());
+	for(CreationDataBatch& b : batchList)
+		batchPtrList.emplace_back(&b);
+	vector<exception_ptr> exceptionList(batchPtrList.size());
+	pipelineLibrary.runInParallel(batchPtrList.size(),
+		[&batchPtrList, &exceptionList, &pipelineLibrary](size_t i) {
+			CreationDataBatch& b = *batchPtrList[i];
+			try {
+				b.createdPipelineList = b.createPipelines(*pipelineLibrary._device, pipelineLibrary._pipelineCache);
+			} catch(...) {
+				exceptionList[i] = current_exception();
+			}
+		}
+	);
 
-		// release CreationDataBatch
-		batchList.pop_front();
+	// update pipelines inside SharedPipeline objects
+	// (pipelines of failed batches are left intact)
+	exception_ptr firstException;
+	for(size_t i=0, c=batchPtrList.size(); i<c; i++) {
+		CreationDataBatch& b = *batchPtrList[i];
+		if(exceptionList[i]) {
+			if(!firstException)
+				firstException = exceptionList[i];
+			continue;
+		}
+		for(size_t j=0, n=b.numSharedPipelines; j<n; j++)
+			b.sharedPipelineList[j].replacePipelineHandle(b.createdPipelineList[j], *pipelineLibrary._device);
 	}
+
+	// release CreationDataBatches
+	batchList.clear();
+	if(firstException)
+		rethrow_exception(firstException);
 }
 
 
@@ -635,6 +1380,95 @@ bool PipelineState::operator<(const PipelineState& rhs) const
 }
 
 
+bool PipelineState::operator==(const PipelineState& rhs) const
+{
+	if(cullMode != rhs.cullMode || frontFace != rhs.frontFace || depthBiasEnable != rhs.depthBiasEnable)
+		return false;
+	if(depthBiasEnable) {
+		if(depthBiasDynamicState != rhs.depthBiasDynamicState)  return false;
+		if(!depthBiasDynamicState)
+			if(depthBiasConstantFactor != rhs.depthBiasConstantFactor || depthBiasClamp != rhs.depthBiasClamp ||
+			   depthBiasSlopeFactor != rhs.depthBiasSlopeFactor)
+				return false;
+	}
+	if(lineWidthDynamicState != rhs.lineWidthDynamicState)  return false;
+	if(!lineWidthDynamicState && lineWidth != rhs.lineWidth)  return false;
+	if(rasterizationSamples != rhs.rasterizationSamples || sampleShadingEnable != rhs.sampleShadingEnable ||
+	   minSampleShading != rhs.minSampleShading || depthTestEnable != rhs.depthTestEnable ||
+	   depthWriteEnable != rhs.depthWriteEnable)
+		return false;
+
+	if(numColorAttachments != rhs.numColorAttachments)  return false;
+	for(uint32_t i=0,c=numColorAttachments; i<c; i++)
+		if(!(blendState[i] == rhs.blendState[i]))
+			return false;
+	if(renderPass != rhs.renderPass)  return false;
+	if(renderPass) {
+		if(subpass != rhs.subpass)  return false;
+	}
+	else
+		if(colorAttachmentFormats != rhs.colorAttachmentFormats || depthAttachmentFormat != rhs.depthAttachmentFormat ||
+		   stencilAttachmentFormat != rhs.stencilAttachmentFormat)
+			return false;
+
+	if(projectionIndex != rhs.projectionIndex || viewportAndScissorHandling != rhs.viewportAndScissorHandling)
+		return false;
+	if(viewportAndScissorHandling == ViewportAndScissorHandling::SetFunction)
+		return viewportIndex == rhs.viewportIndex && scissorIndex == rhs.scissorIndex;
+	else if(viewportAndScissorHandling == ViewportAndScissorHandling::Value)
+		return viewport == rhs.viewport && scissor == rhs.scissor;
+	else
+		return true;
+}
+
+
+uint64_t PipelineState::hash() const
+{
+	// floats are hashed by their bit pattern;
+	// adding zero turns -0.f into +0.f, so the values equal by operator==() give equal hash
+	auto floatWord = [](float f) { return hashWord(f + 0.f); };
+
+	uint64_t h = hashCombine(
+		uint64_t(cullMode) | (uint64_t(frontFace) << 8) | (uint64_t(depthBiasEnable) << 16) |
+		(uint64_t(lineWidthDynamicState) << 17) | (uint64_t(sampleShadingEnable) << 18) |
+		(uint64_t(depthTestEnable) << 19) | (uint64_t(depthWriteEnable) << 20),
+		uint64_t(rasterizationSamples) | (uint64_t(numColorAttachments) << 32));
+	if(depthBiasEnable) {
+		h = hashCombine(h, depthBiasDynamicState);
+		if(!depthBiasDynamicState) {
+			h = hashCombine(h, floatWord(depthBiasConstantFactor) | (floatWord(depthBiasClamp) << 32));
+			h = hashCombine(h, floatWord(depthBiasSlopeFactor));
+		}
+	}
+	if(!lineWidthDynamicState)
+		h = hashCombine(h, floatWord(lineWidth));
+	h = hashCombine(h, floatWord(minSampleShading));
+
+	for(uint32_t i=0,c=numColorAttachments; i<c; i++)
+		h = hashCombine(h, blendState[i].hash());
+	h = hashCombine(h, hashWord(static_cast<VkRenderPass>(renderPass)));
+	if(renderPass)
+		h = hashCombine(h, subpass);
+	else {
+		for(vk::Format f : colorAttachmentFormats)
+			h = hashCombine(h, uint64_t(f));
+		h = hashCombine(h, uint64_t(depthAttachmentFormat) | (uint64_t(stencilAttachmentFormat) << 32));
+	}
+
+	h = hashCombine(h, uint64_t(projectionIndex) | (uint64_t(viewportAndScissorHandling) << 32));
+	if(viewportAndScissorHandling == ViewportAndScissorHandling::SetFunction)
+		h = hashCombine(h, uint64_t(viewportIndex) | (uint64_t(scissorIndex) << 32));
+	else if(viewportAndScissorHandling == ViewportAndScissorHandling::Value) {
+		h = hashCombine(h, floatWord(viewport.x) | (floatWord(viewport.y) << 32));
+		h = hashCombine(h, floatWord(viewport.width) | (floatWord(viewport.height) << 32));
+		h = hashCombine(h, floatWord(viewport.minDepth) | (floatWord(viewport.maxDepth) << 32));
+		h = hashCombine(h, hashWord(scissor.offset));
+		h = hashCombine(h, hashWord(scissor.extent));
+	}
+	return h;
+}
+
+
 bool PipelineState::BlendAttachmentState::operator<(const BlendAttachmentState& rhs) const
 {
 	if(blendEnable < rhs.blendEnable)  return true;
@@ -657,3 +1491,26 @@ bool PipelineState::BlendAttachmentState::operator<(const BlendAttachmentState&
 
 	return colorWriteMask < rhs.colorWriteMask;
 }
+
+
+bool PipelineState::BlendAttachmentState::operator==(const BlendAttachmentState& rhs) const
+{
+	if(blendEnable != rhs.blendEnable)  return false;
+	if(blendEnable)
+		if(srcColorBlendFactor != rhs.srcColorBlendFactor || dstColorBlendFactor != rhs.dstColorBlendFactor ||
+		   colorBlendOp != rhs.colorBlendOp || srcAlphaBlendFactor != rhs.srcAlphaBlendFactor ||
+		   dstAlphaBlendFactor != rhs.dstAlphaBlendFactor || alphaBlendOp != rhs.alphaBlendOp)
+			return false;
+	return colorWriteMask == rhs.colorWriteMask;
+}
+
+
+uint64_t PipelineState::BlendAttachmentState::hash() const
+{
+	uint64_t h = uint64_t(blendEnable) | (uint64_t(static_cast<VkColorComponentFlags>(colorWriteMask)) << 8);
+	if(blendEnable)
+		h = hashCombine(h,
+			uint64_t(srcColorBlendFactor) | (uint64_t(dstColorBlendFactor) << 8) | (uint64_t(colorBlendOp) << 16) |
+			(uint64_t(srcAlphaBlendFactor) << 32) | (uint64_t(dstAlphaBlendFactor) << 40) | (uint64_t(alphaBlendOp) << 48));
+	return h;
+}
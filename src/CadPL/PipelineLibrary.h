@@ -5,10 +5,18 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
+#include <chrono>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <tuple>
+#include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <glm/mat4x4.hpp>
@@ -34,7 +42,7 @@ struct PipelineState {
 		DynamicState,  //< viewport and scissor is specified by Vulkan dynamic state; values of PipelineState::viewport and PipelineState::scissor are ignored
 		SetFunction,  //< PipelineState::viewport and PipelineState::scissor values are set each time PipelineLibrary::setProjectionViewportAndScissor() is called
 	};
-	ViewportAndScissorHandling viewportAndScissorHandling = ViewportAndScissorHandling::SetFunction;
+	ViewportAndScissorHandling viewportAndScissorHandling = ViewportAndScissorHandling::SetFunction;  //< When shader objects are used (see PipelineLibrary::setUseShaderObjects()), ViewportAndScissorHandling::DynamicState means that the user sets viewport and scissor using vkCmdSetViewportWithCount() and vkCmdSetScissorWithCount().
 	unsigned projectionIndex = 0;  //< When ShaderState::projectionHandling is set to ProjectionHandling::PerspectivePushAndSpecializationConstants, it is the index into projection matrix list passed as parameter into PipelineLibrary::setProjectionViewportAndScissor() function.
 	unsigned viewportIndex = 0;  //< When PipelineState::viewportAndScissorHandling is set to ViewportAndScissorHandling::SetFunction, it is the index into viewport list passed as parameter into PipelineLibrary::setProjectionViewportAndScissor() function.
 	unsigned scissorIndex = 0;  //< When PipelineState::viewportAndScissorHandling is set to ViewportAndScissorHandling::SetFunction, it is the index into scissor list passed as parameter into PipelineLibrary::setProjectionViewportAndScissor() function.
@@ -51,7 +59,7 @@ struct PipelineState {
 	bool lineWidthDynamicState = false;
 	float lineWidth = 1.f;
 	vk::SampleCountFlagBits rasterizationSamples = vk::SampleCountFlagBits::e1;
-	bool sampleShadingEnable = false;
+	bool sampleShadingEnable = false;  //< Ignored when shader objects are used, as sample shading cannot be set through dynamic state.
 	float minSampleShading;
 	bool depthTestEnable = true;
 	bool depthWriteEnable = true;
@@ -69,22 +77,40 @@ struct PipelineState {
 			vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
 
 		bool operator<(const BlendAttachmentState& rhs) const;
+		bool operator==(const BlendAttachmentState& rhs) const;
+		uint64_t hash() const;
 	};
 	static constexpr const unsigned maxColorAttachments = 5;
 	uint32_t numColorAttachments;
 	std::array<BlendAttachmentState, maxColorAttachments> blendState;
 
-	vk::RenderPass renderPass = nullptr;  //< If set to nullptr, generated pipelines will use dynamic rendering. Otherwise, they will use specified render pass.
+	vk::RenderPass renderPass = nullptr;  //< If set to nullptr, generated pipelines will use dynamic rendering. Otherwise, they will use specified render pass. Shader objects support dynamic rendering only.
 	uint32_t subpass = 0;
 	std::array<vk::Format, maxColorAttachments> colorAttachmentFormats;
 	vk::Format depthAttachmentFormat;
 	vk::Format stencilAttachmentFormat;
 
 	bool operator<(const PipelineState& rhs) const;
+	bool operator==(const PipelineState& rhs) const;  //< Compares the same members as operator<(), e.g. viewport and scissor are compared only for ViewportAndScissorHandling::Value.
+	bool operator!=(const PipelineState& rhs) const;
+	uint64_t hash() const;  //< Returns 64-bit hash of the members compared by operator==(). Equal states always produce equal hash.
 
 };
 
 
+struct AsyncPipelineStats {
+	size_t numRequested = 0;  //< Number of pipelines scheduled for asynchronous creation.
+	size_t numCompleted = 0;  //< Number of asynchronously created pipelines whose handles were already swapped in.
+	size_t numFailed = 0;  //< Number of pipelines whose asynchronous creation failed.
+	size_t numDiscarded = 0;  //< Number of pipelines whose asynchronous creation was superseded by synchronous recreation of all pipelines in PipelineLibrary::setProjectionViewportAndScissor().
+	size_t numPending = 0;  //< Number of pipelines that are still being created.
+	double totalTimeToOptimized = 0.;  //< Sum of the times from the request till the swap of pipeline handle of all completed pipelines, in seconds.
+	double maxTimeToOptimized = 0.;  //< The longest time from the request till the swap of pipeline handle, in seconds.
+
+	double averageTimeToOptimized() const;
+};
+
+
 class CADPL_EXPORT SharedPipeline {
 protected:
 	void* _pipelineObject = nullptr;
@@ -107,12 +133,15 @@ public:
 	const CadR::Pipeline* cadrPipeline() const;
 	const PipelineFamily* pipelineFamily() const;
 	const PipelineState* pipelineState() const;
+	bool pending() const;  //< Returns true if the pipeline is being created asynchronously and its handle was not swapped in yet.
+	explicit operator bool() const;
 
 protected:
 	friend PipelineFamily;
 	friend PipelineLibrary;
 	SharedPipeline(void* pipelineOwner) noexcept;
 	void replacePipelineHandle(vk::Pipeline pipeline, CadR::VulkanDevice& device) noexcept;
+	void setPending(bool value) noexcept;
 };
 
 
@@ -128,11 +157,18 @@ protected:
 	SharedShaderModule _fragmentShader;
 	vk::PrimitiveTopology _primitiveTopology;
 
+	static constexpr const unsigned numOptimizationConstants = 23;
+	std::array<uint32_t,numOptimizationConstants> _optimizationConstants;  //< Values of specialization constants 6..28 that bake the parts of ShaderState selected by ShaderState::optimizeFlags into the pipeline. See UberShaderInterface.glsl for details.
+
+	bool _useShaderObjects;  //< True if the family uses shader objects instead of pipelines. All PipelineStates are then set through dynamic state, so no pipelines are created.
+	std::vector<std::array<vk::ShaderEXT,3>> _shaderObjectList;  //< Vertex, geometry and fragment shader objects shared by all PipelineStates of the family. There is one item for each projection when ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants is used. Otherwise, there is just one item.
+
 	struct PipelineObject {
 		size_t referenceCounter;
 		CadR::Pipeline cadrPipeline;
 		PipelineFamily* pipelineFamily;
 		std::map<PipelineState, PipelineObject>::iterator mapIterator;
+		bool pending;  //< True while the pipeline is being created asynchronously.
 	};
 
 	std::map<PipelineState, PipelineObject> _pipelineMap;
@@ -140,6 +176,13 @@ protected:
 	static void refPipeline(void* pipelineObject) noexcept;
 	static void unrefPipeline(void* pipelineObject) noexcept;
 	static void destroyPipeline(void* pipelineObject) noexcept;
+	SharedPipeline initPipelineObject(std::map<PipelineState, PipelineObject>::iterator it) noexcept;
+	bool isReadyForCreation(const PipelineState& pipelineState) const;
+	static std::array<uint32_t,numOptimizationConstants> computeOptimizationConstants(const ShaderState& shaderState);
+	void createShaderObjects();  //< Creates (or recreates) shader objects of the family and updates all its pipelines. No shader objects are created if they require projection that was not set yet.
+	void destroyShaderObjects() noexcept;
+	void initShaderObjectPipeline(PipelineObject& pipelineObject);
+	void updateShaderObjectPipeline(PipelineObject& pipelineObject) noexcept;
 
 	friend SharedPipeline;
 	friend PipelineLibrary;
@@ -151,10 +194,12 @@ public:
 	~PipelineFamily() noexcept;
 
 	SharedPipeline getOrCreatePipeline(const PipelineState& pipelineState);
+	SharedPipeline getOrCreatePipelineAsync(const PipelineState& pipelineState);
 	SharedPipeline getPipeline(const PipelineState& pipelineState);
 	const std::map<PipelineState, PipelineObject>& pipelineMap() const;
 
 	const ShaderState& shaderState() const;
+	bool useShaderObjects() const;
 
 };
 
@@ -166,6 +211,7 @@ protected:
 	std::map<ShaderState, PipelineFamily> _pipelineFamilyMap;
 	CadR::VulkanDevice* _device;
 	vk::PipelineCache _pipelineCache;
+	bool _useShaderObjects = false;
 
 	std::vector<std::array<float,6>> _specializationData;
 	std::vector<vk::Viewport> _viewportList;
@@ -173,6 +219,11 @@ protected:
 
 	struct CreationDataSet;  // forward declaration
 
+	struct SpecializationData {
+		std::array<float,6> projection;  //< specialization constants 0..5
+		std::array<uint32_t,PipelineFamily::numOptimizationConstants> optimization;  //< specialization constants 6..28
+	};
+
 	struct CreationDataBatch
 	{
 		static const size_t numPipelines = 16;
@@ -181,6 +232,8 @@ protected:
 		uint32_t numSharedPipelines = 0;
 		std::array<vk::PipelineShaderStageCreateInfo,numPipelines*3> shaderStageList;
 		uint32_t numShaderStages = 0;
+		std::array<std::tuple<SpecializationData,vk::SpecializationInfo>,numPipelines> specializationList;
+		uint32_t numSpecializations = 0;
 		std::array<vk::PipelineInputAssemblyStateCreateInfo,numPipelines> inputAssemblyStateList;
 		uint32_t numInputAssemblyStates = 0;
 		std::array<std::tuple<vk::PipelineViewportStateCreateInfo,vk::Viewport,vk::Rect2D>,numPipelines> viewportStateList;
@@ -202,6 +255,8 @@ protected:
 		std::array<vk::PipelineRenderingCreateInfo,numPipelines> pipelineRenderingInfoList;
 		uint32_t numPipelineRenderingInfos = 0;
 
+		std::array<vk::Pipeline,numPipelines> createdPipelineList{};  //< Pipeline handles created by the worker threads or by the calling thread. They are swapped into sharedPipelineList by CreationDataSet::createPipelines() or by updateAsyncPipelines().
+
 		CreationDataBatch(CreationDataSet* creationDataSet);
 		bool isFull() const;
 		void append(SharedPipeline&& sharedPipeline, const PipelineState& pipelineState);
@@ -218,9 +273,38 @@ protected:
 
 		CreationDataSet(const PipelineLibrary& pipelineLibrary);
 		void append(SharedPipeline&& sharedPipeline, const PipelineState& pipelineState);
-		void createPipelines(const PipelineLibrary& pipelineLibrary);
+		void createPipelines(PipelineLibrary& pipelineLibrary);  //< Creates pipelines of all batches. The batches are distributed among the worker threads and the calling thread.
 	};
 
+	// asynchronous pipeline creation
+	struct AsyncCreationData
+	{
+		CreationDataSet creationDataSet;
+		std::vector<std::chrono::steady_clock::time_point> requestTimeList;  //< Request time of each pipeline in creationDataSet.
+		size_t numUnfinishedBatches = 0;  //< Number of batches that are still being created by the worker threads. Protected by PipelineLibrary::_jobMutex.
+		bool finished = false;  //< Set by the worker thread when all the pipelines are created. Protected by PipelineLibrary::_jobMutex.
+
+		AsyncCreationData(const PipelineLibrary& pipelineLibrary);
+		size_t numPipelines() const;
+	};
+	std::unique_ptr<AsyncCreationData> _asyncCreationData;  //< Pipelines requested for asynchronous creation that are not submitted to the worker threads yet. They are submitted by updateAsyncPipelines().
+	std::list<std::unique_ptr<AsyncCreationData>> _submittedAsyncCreationDataList;  //< Pipelines submitted to the worker threads.
+	AsyncPipelineStats _asyncPipelineStats;
+
+	// worker threads
+	std::vector<std::thread> _threadList;
+	std::deque<std::function<void()>> _jobQueue;
+	std::mutex _jobMutex;
+	std::condition_variable _jobAvailableCondition;
+	std::condition_variable _jobFinishedCondition;
+	bool _exitThreads = false;
+
+	PipelineFamily& getOrCreatePipelineFamily(const ShaderState& shaderState);
+	void startThreads();
+	void workerMain();
+	void runInParallel(size_t numItems, const std::function<void(size_t)>& func);  //< Calls func for each item index from 0 to numItems-1 using the worker threads and the calling thread. It returns when all the items are processed. The func must not throw.
+	void discardAsyncPipelines() noexcept;
+
 	friend PipelineFamily;
 
 public:
@@ -239,6 +323,18 @@ public:
 	// synchronous API to get and create pipelines
 	SharedPipeline getOrCreatePipeline(const ShaderState& shaderState, const PipelineState& pipelineState);
 	SharedPipeline getPipeline(const ShaderState& shaderState, const PipelineState& pipelineState);
+	std::vector<SharedPipeline> prewarm(const std::vector<std::pair<ShaderState,PipelineState>>& pipelineList);  //< Creates all the pipelines in pipelineList using all cpu cores and returns SharedPipeline for each item of pipelineList. The pipelines stay alive only while referenced, so the returned list should be kept until the pipelines are referenced by other means, for example by StateSets. Pipelines requiring projection, viewport or scissor that were not set yet are created later by setProjectionViewportAndScissor().
+
+	// asynchronous API to create pipelines
+	SharedPipeline getOrCreatePipelineAsync(const ShaderState& shaderState, const PipelineState& pipelineState);  //< Returns SharedPipeline immediately while the pipeline is created by the worker threads. The pipeline handle is null and SharedPipeline::pending() returns true until the handle is swapped in by updateAsyncPipelines().
+	size_t updateAsyncPipelines();  //< Swaps in the handles of asynchronously created pipelines that were finished and submits newly requested pipelines to the worker threads. It is supposed to be called once per frame on the frame boundary, e.g. after CadR::Renderer::beginFrame(). Returns the number of swapped pipeline handles.
+	void waitForAsyncPipelines();  //< Waits until all asynchronously created pipelines are finished and swaps in their handles.
+	const AsyncPipelineStats& asyncPipelineStats() const;
+	void resetAsyncPipelineStats();
+
+	// shader objects
+	bool useShaderObjects() const;  //< Returns true if VK_EXT_shader_object backend is used instead of pipelines.
+	void setUseShaderObjects(bool value);  //< Enables or disables VK_EXT_shader_object backend. If enabled, vk::ShaderEXT objects are created once per ShaderState and shared by all its PipelineStates, while all the PipelineState is set through dynamic state when the StateSet is recorded. Thus, the number of created objects does not grow with the number of PipelineStates. The device must have VK_EXT_shader_object extension and shaderObject feature enabled. It affects only the ShaderStates that get their first pipeline after the call.
 
 	// getters
 	CadR::VulkanDevice& device() const;
@@ -252,6 +348,7 @@ public:
 
 
 // inline functions
+inline double AsyncPipelineStats::averageTimeToOptimized() const  { return (numCompleted) ? totalTimeToOptimized / numCompleted : 0.; }
 inline SharedPipeline::SharedPipeline(void* pipelineObject) noexcept  : _pipelineObject(pipelineObject) { PipelineFamily::refPipeline(pipelineObject); }
 inline SharedPipeline::~SharedPipeline() noexcept  { if(_pipelineObject) PipelineFamily::unrefPipeline(_pipelineObject); }
 inline SharedPipeline::SharedPipeline(SharedPipeline&& other) noexcept  : _pipelineObject(other._pipelineObject) { other._pipelineObject=nullptr; }
@@ -261,18 +358,25 @@ inline SharedPipeline& SharedPipeline::operator=(const SharedPipeline& rhs) noex
 inline void SharedPipeline::reset() noexcept  { if(!_pipelineObject) return; PipelineFamily::unrefPipeline(_pipelineObject); _pipelineObject=nullptr; }
 inline const CadR::Pipeline* SharedPipeline::cadrPipeline() const  { return (_pipelineObject) ? &static_cast<PipelineFamily::PipelineObject*>(_pipelineObject)->cadrPipeline : nullptr; }
 inline const PipelineFamily* SharedPipeline::pipelineFamily() const  { return (_pipelineObject) ? static_cast<PipelineFamily::PipelineObject*>(_pipelineObject)->pipelineFamily : nullptr; }
+inline bool PipelineState::operator!=(const PipelineState& rhs) const  { return !operator==(rhs); }
 inline const PipelineState* SharedPipeline::pipelineState() const  { return (_pipelineObject) ? &static_cast<PipelineFamily::PipelineObject*>(_pipelineObject)->mapIterator->first : nullptr; }
+inline bool SharedPipeline::pending() const  { return (_pipelineObject) ? static_cast<PipelineFamily::PipelineObject*>(_pipelineObject)->pending : false; }
+inline SharedPipeline::operator bool() const  { return _pipelineObject; }
+inline void SharedPipeline::setPending(bool value) noexcept  { static_cast<PipelineFamily::PipelineObject*>(_pipelineObject)->pending = value; }
 inline void SharedPipeline::replacePipelineHandle(vk::Pipeline newPipeline, CadR::VulkanDevice& device) noexcept  { assert(_pipelineObject && "SharedPipeline was not properly initialized yet."); CadR::Pipeline& cadrPipeline = static_cast<PipelineFamily::PipelineObject*>(_pipelineObject)->cadrPipeline; device.destroy(cadrPipeline.get()); cadrPipeline.set(newPipeline); }
 
 inline void PipelineFamily::refPipeline(void* pipelineObject) noexcept  { PipelineObject* po=static_cast<PipelineObject*>(pipelineObject); po->referenceCounter++; }
 inline void PipelineFamily::unrefPipeline(void* pipelineObject) noexcept  { PipelineObject* po=static_cast<PipelineObject*>(pipelineObject); if(po->referenceCounter==1) PipelineFamily::destroyPipeline(po); else po->referenceCounter--; }
-inline PipelineFamily::PipelineFamily(PipelineLibrary& pipelineLibrary) noexcept  : _device(pipelineLibrary._device), _pipelineLibrary(&pipelineLibrary) {}
+inline PipelineFamily::PipelineFamily(PipelineLibrary& pipelineLibrary) noexcept  : _device(pipelineLibrary._device), _pipelineLibrary(&pipelineLibrary), _useShaderObjects(pipelineLibrary._useShaderObjects) {}
 inline SharedPipeline PipelineFamily::getPipeline(const PipelineState& pipelineState)  { auto it=_pipelineMap.find(pipelineState); return (it!=_pipelineMap.end()) ? SharedPipeline(&it->second) : SharedPipeline(); }
 inline const std::map<PipelineState, PipelineFamily::PipelineObject>& PipelineFamily::pipelineMap() const  { return _pipelineMap; }
 inline const ShaderState& PipelineFamily::shaderState() const  { return _mapIterator->first; }
+inline bool PipelineFamily::useShaderObjects() const  { return _useShaderObjects; }
 
 inline PipelineLibrary::CreationDataBatch::CreationDataBatch(PipelineLibrary::CreationDataSet* creationDataSet_)  : creationDataSet(creationDataSet_) {}
 inline bool PipelineLibrary::CreationDataBatch::isFull() const  { return numSharedPipelines == numPipelines; }
+inline PipelineLibrary::AsyncCreationData::AsyncCreationData(const PipelineLibrary& pipelineLibrary)  : creationDataSet(pipelineLibrary) {}
+inline size_t PipelineLibrary::AsyncCreationData::numPipelines() const  { return requestTimeList.size(); }
 inline void PipelineLibrary::CreationDataSet::append(SharedPipeline&& sharedPipeline, const PipelineState& pipelineState)  { if(batchList.empty() || batchList.back().isFull()) batchList.emplace_back(this); batchList.back().append(std::move(sharedPipeline), pipelineState); }
 
 inline PipelineLibrary::PipelineLibrary() noexcept  : _shaderLibrary(nullptr), _device(nullptr) {}
@@ -280,6 +384,10 @@ inline PipelineLibrary::PipelineLibrary(ShaderLibrary& shaderLibrary, vk::Pipeli
 inline void PipelineLibrary::init(ShaderLibrary& shaderLibrary, vk::PipelineCache pipelineCache)  { _device=&shaderLibrary.device(); _shaderLibrary=&shaderLibrary; _pipelineCache=pipelineCache; }
 inline void PipelineLibrary::setProjectionViewportAndScissor(const glm::mat4x4& projectionMatrix, const vk::Viewport& viewport, const vk::Rect2D& scissor)  { setProjectionViewportAndScissor(std::vector{projectionMatrix}, std::vector{viewport}, std::vector{scissor}); }
 inline SharedPipeline PipelineLibrary::getPipeline(const ShaderState& shaderState, const PipelineState& pipelineState)  { auto it=_pipelineFamilyMap.find(shaderState); return (it!=_pipelineFamilyMap.end()) ? it->second.getPipeline(pipelineState) : SharedPipeline(); }
+inline const AsyncPipelineStats& PipelineLibrary::asyncPipelineStats() const  { return _asyncPipelineStats; }
+inline void PipelineLibrary::resetAsyncPipelineStats()  { size_t numPending=_asyncPipelineStats.numPending; _asyncPipelineStats={}; _asyncPipelineStats.numPending=numPending; }
+inline bool PipelineLibrary::useShaderObjects() const  { return _useShaderObjects; }
+inline void PipelineLibrary::setUseShaderObjects(bool value)  { _useShaderObjects = value; }
 inline CadR::VulkanDevice& PipelineLibrary::device() const  { return *_device; }
 inline ShaderLibrary& PipelineLibrary::shaderLibrary() const  { return *_shaderLibrary; }
 inline vk::PipelineCache PipelineLibrary::pipelineCache() const  { return _pipelineCache; }
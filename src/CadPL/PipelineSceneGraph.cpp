@@ -3,18 +3,129 @@
 // SPDX-License-Identifier: MIT
 
 #include <CadPL/PipelineSceneGraph.h>
+#include <algorithm>
 
 using namespace std;
 using namespace CadPL;
 
 
-CadR::StateSet& PipelineSceneGraph::createStateSet(const ShaderState& shaderState,
-	const PipelineState& pipelineState, decltype(_stateSetMap)::insert_commit_data& insertData)
+PipelineSceneGraph::StateSetMapItem* PipelineSceneGraph::findStateSetMapItem(uint64_t hash,
+	const ShaderState& shaderState, const PipelineState& pipelineState) const
 {
-	StateSetMapItem* item = new StateSetMapItem(shaderState, pipelineState, _root->renderer());
-	_stateSetMap.insert_commit(*item, insertData);
-	item->sharedPipeline = _pipelineLibrary->getOrCreatePipeline(shaderState, pipelineState);
+	if(_stateSetMap.empty())
+		return nullptr;
+
+	// linear probing until empty slot is found
+	size_t mask = _stateSetMap.size() - 1;
+	for(size_t i=hash&mask; ; i=(i+1)&mask) {
+		StateSetMapItem* item = _stateSetMap[i];
+		if(item == nullptr)
+			return nullptr;
+		if(item->hash == hash && item->shaderState == shaderState && item->pipelineState == pipelineState)
+			return item;
+	}
+}
+
+
+void PipelineSceneGraph::insertStateSetMapItem(StateSetMapItem* item)
+{
+	// grow the table to keep load factor at most 0.5
+	if((_numStateSets+1)*2 > _stateSetMap.size()) {
+		vector<StateSetMapItem*> oldMap(max(_stateSetMap.size()*2, size_t(64)), nullptr);
+		oldMap.swap(_stateSetMap);
+		size_t mask = _stateSetMap.size() - 1;
+		for(StateSetMapItem* oldItem : oldMap)
+			if(oldItem) {
+				size_t i = oldItem->hash & mask;
+				while(_stateSetMap[i])
+					i = (i+1) & mask;
+				_stateSetMap[i] = oldItem;
+			}
+	}
+
+	// insert item
+	size_t mask = _stateSetMap.size() - 1;
+	size_t i = item->hash & mask;
+	while(_stateSetMap[i])
+		i = (i+1) & mask;
+	_stateSetMap[i] = item;
+	_numStateSets++;
+}
+
+
+void PipelineSceneGraph::eraseStateSetMapItem(StateSetMapItem* item) noexcept
+{
+	// find item's slot
+	size_t mask = _stateSetMap.size() - 1;
+	size_t i = item->hash & mask;
+	while(_stateSetMap[i] != item)
+		i = (i+1) & mask;
+
+	// backward shift deletion
+	// (the following items of the probe sequence are moved into the hole
+	// unless their home slot lies between the hole and their current slot,
+	// so no tombstones are needed)
+	for(size_t j=(i+1)&mask; _stateSetMap[j]!=nullptr; j=(j+1)&mask) {
+		size_t home = _stateSetMap[j]->hash & mask;
+		if(((j-home) & mask) >= ((j-i) & mask)) {
+			_stateSetMap[i] = _stateSetMap[j];
+			i = j;
+		}
+	}
+	_stateSetMap[i] = nullptr;
+	_numStateSets--;
+}
+
+
+void PipelineSceneGraph::clearStateSetMap() noexcept
+{
+	for(StateSetMapItem* item : _stateSetMap)
+		delete item;
+	_stateSetMap.clear();
+	_numStateSets = 0;
+}
+
+
+CadR::StateSet& PipelineSceneGraph::createStateSet(uint64_t hash, const ShaderState& shaderState,
+	const PipelineState& pipelineState, CreationMode mode)
+{
+	StateSetMapItem* item = new StateSetMapItem(hash, shaderState, pipelineState, _root->renderer());
+	try {
+		insertStateSetMapItem(item);
+	} catch(...) {
+		delete item;
+		throw;
+	}
+	if(mode == CreationMode::Auto && shaderState.optimizeFlags.any()) {
+
+		// use uber-shader pipeline until the StateSet is promoted by updateAutoOptimization()
+		item->uberPipeline = _pipelineLibrary->getOrCreatePipeline(shaderState.uberShaderState(), pipelineState);
+		item->sharedPipeline = item->uberPipeline;
+		_autoItemList.push_back(item);
+		item->autoOptimized = true;
+		_autoOptimizationStats.numStateSets++;
+
+	}
+	else if(mode == CreationMode::Async && shaderState.optimizeFlags.any()) {
+
+		// use uber-shader pipeline until the optimized pipeline is created
+		item->uberPipeline = _pipelineLibrary->getOrCreatePipeline(shaderState.uberShaderState(), pipelineState);
+		item->pendingPipeline = _pipelineLibrary->getOrCreatePipelineAsync(shaderState, pipelineState);
+		if(item->pendingPipeline.pending()) {
+			item->sharedPipeline = item->uberPipeline;
+			_pendingItemList.push_back(item);
+		}
+		else
+			item->sharedPipeline = std::move(item->pendingPipeline);
+
+	}
+	else
+		item->sharedPipeline = _pipelineLibrary->getOrCreatePipeline(shaderState, pipelineState);
 	item->stateSet.pipeline = item->sharedPipeline.cadrPipeline();
+	if(_indexedDraw) {
+		item->stateSet.indexType = (shaderState.attribSetup & 0x2) ? vk::IndexType::eUint16 : vk::IndexType::eUint32;  // bit 1: 16-bit indices
+		item->stateSet.drawIndexOffsetPushConstantOffset = ShaderLibrary::drawIndexOffsetPushConstantOffset;
+	}
 	_root->childList.append(item->stateSet);
 
 	struct {
@@ -31,9 +142,11 @@ CadR::StateSet& PipelineSceneGraph::createStateSet(const ShaderState& shaderStat
 	struct {
 		array<uint32_t,10> textureSetup;
 		array<uint8_t,8> lightSetup;
+		uint32_t drawIndexOffset;
 	} pushData2 = {
 		shaderState.textureSetup,
 		shaderState.lightSetup,
+		0,  // drawIndexOffset; updated by StateSet for each run of indexed draws
 	};
 	item->stateSet.recordCallList.emplace_back(
 		[pushData1,pushData2](CadR::StateSet& ss, vk::CommandBuffer commandBuffer, vk::PipelineLayout currentPipelineLayout) {
@@ -59,3 +172,115 @@ CadR::StateSet& PipelineSceneGraph::createStateSet(const ShaderState& shaderStat
 
 	return item->stateSet;
 }
+
+
+size_t PipelineSceneGraph::updateAsyncPipelines()
+{
+	// swap in pipeline handles inside PipelineLibrary
+	_pipelineLibrary->updateAsyncPipelines();
+
+	// switch StateSets to the optimized pipelines
+	size_t numSwitched = 0;
+	for(size_t i=0; i<_pendingItemList.size(); ) {
+		StateSetMapItem* item = _pendingItemList[i];
+		if(item->pendingPipeline.pending()) {
+			i++;
+			continue;
+		}
+		if(item->pendingPipeline.cadrPipeline()->get()) {
+			item->sharedPipeline = std::move(item->pendingPipeline);
+			item->stateSet.pipeline = item->sharedPipeline.cadrPipeline();
+			numSwitched++;
+		}
+		else
+			// creation failed, so stay with uber-shader pipeline
+			item->pendingPipeline.reset();
+		_pendingItemList[i] = _pendingItemList.back();
+		_pendingItemList.pop_back();
+	}
+	return numSwitched;
+}
+
+
+void PipelineSceneGraph::promote(StateSetMapItem& item)
+{
+	// request optimized pipeline
+	// (it is created asynchronously and swapped in by updateAsyncPipelines(),
+	// unless it exists already)
+	item.pendingPipeline = _pipelineLibrary->getOrCreatePipelineAsync(item.shaderState, item.pipelineState);
+	if(item.pendingPipeline.pending())
+		_pendingItemList.push_back(&item);
+	else {
+		item.sharedPipeline = std::move(item.pendingPipeline);
+		item.stateSet.pipeline = item.sharedPipeline.cadrPipeline();
+	}
+	item.promoted = true;
+	item.numColdUpdates = 0;
+	_autoOptimizationStats.numPromoted++;
+	_autoOptimizationStats.numPromotions++;
+}
+
+
+void PipelineSceneGraph::demote(StateSetMapItem& item) noexcept
+{
+	// switch back to uber-shader pipeline
+	// (releasing of the optimized pipeline destroys it if it is not used by any other StateSet;
+	// pipeline still being created is destroyed when its creation finishes)
+	removeFromPendingList(item);
+	item.pendingPipeline.reset();
+	item.sharedPipeline = item.uberPipeline;
+	item.stateSet.pipeline = item.sharedPipeline.cadrPipeline();
+	item.promoted = false;
+	item.numColdUpdates = 0;
+	_autoOptimizationStats.numPromoted--;
+	_autoOptimizationStats.numDemotions++;
+}
+
+
+size_t PipelineSceneGraph::updateAutoOptimization()
+{
+	// update usage
+	const AutoOptimizationPolicy& policy = _autoOptimizationPolicy;
+	for(StateSetMapItem* item : _autoItemList)
+		item->usage =
+			(policy.usageFunc)
+				? policy.usageFunc(item->stateSet)
+				: double(item->stateSet.getNumDrawables());
+
+	// mark the heaviest items as hot
+	// (nth_element() moves them to the beginning of _autoItemSortList;
+	// items with usage below policy.minUsage are never hot)
+	_autoItemSortList.assign(_autoItemList.begin(), _autoItemList.end());
+	size_t numHot = min(policy.maxOptimizedStateSets, _autoItemSortList.size());
+	nth_element(_autoItemSortList.begin(), _autoItemSortList.begin() + numHot, _autoItemSortList.end(),
+		[](const StateSetMapItem* a, const StateSetMapItem* b) { return a->usage > b->usage; });
+	for(StateSetMapItem* item : _autoItemList)
+		item->hot = false;
+	for(size_t i=0; i<numHot; i++)
+		if(_autoItemSortList[i]->usage >= policy.minUsage)
+			_autoItemSortList[i]->hot = true;
+
+	// promote hot items and demote cold ones
+	// (the items are demoted only after staying cold for policy.demotionDelay updates
+	// to avoid repeated recompilation of StateSets with fluctuating usage)
+	size_t numChanged = 0;
+	for(StateSetMapItem* item : _autoItemList) {
+		if(item->hot) {
+			if(!item->promoted) {
+				promote(*item);
+				numChanged++;
+			}
+			else
+				item->numColdUpdates = 0;
+		}
+		else if(item->promoted) {
+			item->numColdUpdates++;
+			if(item->numColdUpdates >= policy.demotionDelay) {
+				demote(*item);
+				numChanged++;
+			}
+		}
+	}
+
+	return numChanged;
+}
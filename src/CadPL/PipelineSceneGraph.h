@@ -1,14 +1,15 @@
-// SPDX-FileCopyrightText: 2025 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2025-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
 #pragma once
 
+#include <algorithm>
 #include <bitset>
+#include <cstdint>
+#include <functional>
 #include <map>
-#include <tuple>
 #include <vector>
-#include <boost/intrusive/splay_set.hpp>
 #include <glm/mat4x4.hpp>
 #include <CadR/StateSet.h>
 #include <CadPL/PipelineLibrary.h>
@@ -17,6 +18,22 @@
 namespace CadPL {
 
 
+struct AutoOptimizationPolicy {
+	size_t maxOptimizedStateSets = 64;  //< Maximal number of StateSets rendered by optimized pipelines. Only the StateSets with the highest usage are promoted.
+	double minUsage = 1.;  //< StateSets with lower usage are never promoted.
+	unsigned demotionDelay = 60;  //< Number of consecutive PipelineSceneGraph::updateAutoOptimization() calls the promoted StateSet must stay out of the heaviest StateSets before it is demoted back to uber-shader.
+	std::function<double(const CadR::StateSet&)> usageFunc;  //< Returns usage of the StateSet, e.g. gpu time or number of fragment invocations measured by the application. If not set, the number of drawables of the StateSet is used.
+};
+
+
+struct AutoOptimizationStats {
+	size_t numStateSets = 0;  //< Number of StateSets managed by automatic optimization.
+	size_t numPromoted = 0;  //< Number of StateSets currently rendered by optimized pipelines or waiting for them.
+	size_t numPromotions = 0;  //< Total number of promotions to optimized pipelines.
+	size_t numDemotions = 0;  //< Total number of demotions back to uber-shader pipelines.
+};
+
+
 class CADPL_EXPORT PipelineSceneGraph {
 protected:
 
@@ -24,27 +41,41 @@ protected:
 	ShaderLibrary* _shaderLibrary;
 	bool _deleteLibraries;
 	CadR::StateSet* _root;  //< The root StateSet under which uber-shader StateSet and all kinds of optimized StateSets are placed.
+	bool _indexedDraw = true;
 
 	// StateSet map
 	struct StateSetMapItem {
-		boost::intrusive::bs_set_member_hook<> memberHook;
+		uint64_t hash;  //< Precomputed hash of shaderState and pipelineState.
 		ShaderState shaderState;
 		PipelineState pipelineState;
 		CadR::StateSet stateSet;
-		SharedPipeline sharedPipeline;
-
-		StateSetMapItem(const ShaderState& shaderState, const PipelineState& pipelineState,
+		SharedPipeline sharedPipeline;  //< Pipeline used by stateSet.
+		SharedPipeline uberPipeline;  //< Uber-shader pipeline used by stateSet until pendingPipeline is created. It is kept alive even after the switch to pendingPipeline.
+		SharedPipeline pendingPipeline;  //< Optimized pipeline that is being created asynchronously. Its handle replaces uberPipeline in stateSet in updateAsyncPipelines().
+		bool autoOptimized = false;  //< True if the item is promoted and demoted by updateAutoOptimization().
+		bool promoted = false;  //< True if the optimized pipeline is used by stateSet or it is being created for it.
+		bool hot = false;  //< True if the item was among the heaviest items in the last updateAutoOptimization() call.
+		unsigned numColdUpdates = 0;  //< Number of consecutive updateAutoOptimization() calls when the promoted item was not among the heaviest items.
+		double usage = 0.;  //< Usage of the item computed by the last updateAutoOptimization() call.
+
+		StateSetMapItem(uint64_t hash, const ShaderState& shaderState, const PipelineState& pipelineState,
 		                CadR::Renderer& renderer);
 	};
-	struct mapKey {
-		using type = std::tuple<const ShaderState&,const PipelineState&>;
-		type operator()(const StateSetMapItem& item) const  { return type{item.shaderState, item.pipelineState}; }
-	};
-	boost::intrusive::splay_set<StateSetMapItem,
-		boost::intrusive::key_of_value<mapKey>,
-		boost::intrusive::member_hook<StateSetMapItem, boost::intrusive::bs_set_member_hook<>,
-			&StateSetMapItem::memberHook>> _stateSetMap;
+	std::vector<StateSetMapItem*> _stateSetMap;  //< Open addressing hash table with linear probing. Its size is power of two and nullptr marks empty slot. The items are compared by their hash first, so full comparison of the states is performed only for the matching item.
+	size_t _numStateSets = 0;
 	static StateSetMapItem& stateSetToStateSetMapItem(CadR::StateSet& ss);
+	static uint64_t stateSetHash(const ShaderState& shaderState, const PipelineState& pipelineState);
+	StateSetMapItem* findStateSetMapItem(uint64_t hash, const ShaderState& shaderState, const PipelineState& pipelineState) const;
+	void insertStateSetMapItem(StateSetMapItem* item);
+	void eraseStateSetMapItem(StateSetMapItem* item) noexcept;
+	void clearStateSetMap() noexcept;
+	std::vector<StateSetMapItem*> _pendingItemList;  //< Items waiting for asynchronous creation of their pendingPipeline.
+
+	// automatic optimization
+	std::vector<StateSetMapItem*> _autoItemList;  //< Items managed by updateAutoOptimization().
+	std::vector<StateSetMapItem*> _autoItemSortList;  //< Helper buffer for updateAutoOptimization() to avoid memory reallocations.
+	AutoOptimizationPolicy _autoOptimizationPolicy;
+	AutoOptimizationStats _autoOptimizationStats;
 
 	// optimization levels
 	std::vector<std::bitset<ShaderState::numOptimizeFlags>> _optimizationLevels;
@@ -53,10 +84,14 @@ protected:
 	};
 
 	// internal functions
+	enum class CreationMode { Sync, Async, Auto };
 	PipelineSceneGraph(nullptr_t, CadR::StateSet& root,
 	                   const std::vector<std::bitset<ShaderState::numOptimizeFlags>>& optimizationLevels);
-	CadR::StateSet& createStateSet(const ShaderState& shaderState, const PipelineState& pipelineState,
-	                               decltype(_stateSetMap)::insert_commit_data& insertData);
+	CadR::StateSet& createStateSet(uint64_t hash, const ShaderState& shaderState, const PipelineState& pipelineState,
+	                               CreationMode mode);
+	void promote(StateSetMapItem& item);
+	void demote(StateSetMapItem& item) noexcept;
+	void removeFromPendingList(StateSetMapItem& item) noexcept;
 
 public:
 
@@ -77,6 +112,25 @@ public:
 	CadR::StateSet& getOrCreateStateSet(const ShaderState& shaderState, const PipelineState& pipelineState);
 	CadR::StateSet* getStateSet(const ShaderState& shaderState, const PipelineState& pipelineState);
 	void deleteStateSet(CadR::StateSet& ss) noexcept;
+	size_t numStateSets() const;
+
+	// asynchronous API to create StateSets
+	CadR::StateSet& getOrCreateStateSetAsync(const ShaderState& shaderState, const PipelineState& pipelineState);  //< Returns StateSet immediately. If shaderState requests any optimizations, the StateSet is rendered by uber-shader pipeline until the optimized pipeline is created by the worker threads and swapped in by updateAsyncPipelines().
+	size_t updateAsyncPipelines();  //< Swaps in asynchronously created pipelines. It is supposed to be called once per frame on the frame boundary, e.g. after CadR::Renderer::beginFrame(). Returns the number of StateSets that switched to the optimized pipeline.
+	void waitForAsyncPipelines();
+	const AsyncPipelineStats& asyncPipelineStats() const;
+
+	// automatic optimization of StateSets
+	CadR::StateSet& getOrCreateStateSetAuto(const ShaderState& shaderState, const PipelineState& pipelineState);  //< Returns StateSet rendered by uber-shader pipeline. If shaderState requests any optimizations, the StateSet is promoted to the optimized pipeline by updateAutoOptimization() when it becomes one of the heaviest StateSets, and demoted back when it is not used much any more.
+	size_t updateAutoOptimization();  //< Updates usage of StateSets created by getOrCreateStateSetAuto(), promotes the heaviest ones to optimized pipelines and demotes the cold ones to uber-shader pipeline. The optimized pipelines are created asynchronously, so updateAsyncPipelines() needs to be called as well. It is supposed to be called once per frame or less frequently. Returns the number of promoted and demoted StateSets.
+	void setAutoOptimizationPolicy(const AutoOptimizationPolicy& policy);
+	const AutoOptimizationPolicy& autoOptimizationPolicy() const;
+	const AutoOptimizationStats& autoOptimizationStats() const;
+	double stateSetUsage(CadR::StateSet& ss) const;  //< Returns usage of the StateSet computed by the last updateAutoOptimization() call.
+
+	// indexed draws
+	bool indexedDraw() const;
+	void setIndexedDraw(bool value);  //< Sets whether created StateSets record indexed draws, e.g. whether they set CadR::StateSet::indexType according to 16-bit index flag of ShaderState::attribSetup. Indexed draws let the hardware reuse vertex shader results of repeated indices. It affects only the StateSets created after the call. Default is true.
 
 	// projection, viewport and scissor for pipelines
 	void setProjectionViewportAndScissor(const glm::mat4x4& projectionMatrix, const vk::Viewport& viewport, const vk::Rect2D& scissor);
@@ -102,21 +156,34 @@ public:
 #include <CadR/Renderer.h>
 namespace CadPL {
 
-inline PipelineSceneGraph::StateSetMapItem::StateSetMapItem(const ShaderState& shaderState_, const PipelineState& pipelineState_, CadR::Renderer& renderer)  : shaderState(shaderState_), pipelineState(pipelineState_), stateSet(renderer) {}
+inline PipelineSceneGraph::StateSetMapItem::StateSetMapItem(uint64_t hash_, const ShaderState& shaderState_, const PipelineState& pipelineState_, CadR::Renderer& renderer)  : hash(hash_), shaderState(shaderState_), pipelineState(pipelineState_), stateSet(renderer) {}
 inline PipelineSceneGraph::StateSetMapItem& PipelineSceneGraph::stateSetToStateSetMapItem(CadR::StateSet& ss)  { return *reinterpret_cast<StateSetMapItem*>(reinterpret_cast<char*>(&ss) - reinterpret_cast<char*>(&static_cast<StateSetMapItem*>(nullptr)->stateSet)); }
+inline uint64_t PipelineSceneGraph::stateSetHash(const ShaderState& shaderState, const PipelineState& pipelineState)  { return hashCombine(shaderState.hash(), pipelineState.hash()); }
 
 inline PipelineSceneGraph::PipelineSceneGraph() noexcept  : _deleteLibraries(false) {}
 inline PipelineSceneGraph::PipelineSceneGraph(nullptr_t, CadR::StateSet& root, const std::vector<std::bitset<ShaderState::numOptimizeFlags>>& optimizationLevels)  : _pipelineLibrary(nullptr), _shaderLibrary(nullptr), _deleteLibraries(true), _root(&root), _optimizationLevels(optimizationLevels) {}
 inline PipelineSceneGraph::PipelineSceneGraph(CadR::StateSet& root, const std::vector<std::bitset<ShaderState::numOptimizeFlags>>& optimizationLevels, vk::PipelineCache pipelineCache, uint32_t maxTextures)  : PipelineSceneGraph(nullptr, root, optimizationLevels) { _shaderLibrary=new ShaderLibrary(root.renderer().device(), maxTextures); _pipelineLibrary=new PipelineLibrary(*_shaderLibrary, pipelineCache); }
 inline PipelineSceneGraph::PipelineSceneGraph(PipelineLibrary& pipelineLibrary, ShaderLibrary& shaderLibrary, CadR::StateSet& root, const std::vector<std::bitset<ShaderState::numOptimizeFlags>>& optimizationLevels)  : _pipelineLibrary(&pipelineLibrary), _shaderLibrary(&shaderLibrary), _deleteLibraries(false), _root(&root), _optimizationLevels(optimizationLevels) {}
-inline PipelineSceneGraph::~PipelineSceneGraph() noexcept  { _stateSetMap.clear_and_dispose([](StateSetMapItem* item){ delete item; }); if(_deleteLibraries) { delete _pipelineLibrary; delete _shaderLibrary; } }
+inline PipelineSceneGraph::~PipelineSceneGraph() noexcept  { _pendingItemList.clear(); _autoItemList.clear(); clearStateSetMap(); if(_deleteLibraries) { delete _pipelineLibrary; delete _shaderLibrary; } }
 inline void PipelineSceneGraph::init(CadR::StateSet& root, const std::vector<std::bitset<ShaderState::numOptimizeFlags>>& optimizationLevels, vk::PipelineCache pipelineCache, uint32_t maxTextures)  { destroy(); _deleteLibraries=true; _root=&root; _shaderLibrary=new ShaderLibrary(root.renderer().device()); _pipelineLibrary=new PipelineLibrary(*_shaderLibrary, pipelineCache); }
-inline void PipelineSceneGraph::destroy() noexcept  { _stateSetMap.clear_and_dispose([](StateSetMapItem* item){ delete item; }); if(_deleteLibraries) { delete _pipelineLibrary; delete _shaderLibrary; _pipelineLibrary=nullptr; _shaderLibrary=nullptr; } }
-inline CadR::StateSet& PipelineSceneGraph::getOrCreateStateSet(const ShaderState& shaderState, const PipelineState& pipelineState)  { decltype(_stateSetMap)::insert_commit_data insertData; auto [it, canInsert]=_stateSetMap.insert_check(std::tuple{shaderState, pipelineState}, insertData); return (canInsert) ? createStateSet(shaderState, pipelineState, insertData) : it->stateSet; }
-inline CadR::StateSet* PipelineSceneGraph::getStateSet(const ShaderState& shaderState, const PipelineState& pipelineState)  { auto it=_stateSetMap.find(std::tuple{shaderState, pipelineState}); return (it!=_stateSetMap.end()) ? &it->stateSet : nullptr; }
-inline void PipelineSceneGraph::deleteStateSet(CadR::StateSet& ss) noexcept  { _stateSetMap.erase_and_dispose(decltype(_stateSetMap)::s_iterator_to(stateSetToStateSetMapItem(ss)), [](StateSetMapItem* item){ delete item; }); }
+inline void PipelineSceneGraph::destroy() noexcept  { _pendingItemList.clear(); _autoItemList.clear(); _autoOptimizationStats={}; clearStateSetMap(); if(_deleteLibraries) { delete _pipelineLibrary; delete _shaderLibrary; _pipelineLibrary=nullptr; _shaderLibrary=nullptr; } }
+inline CadR::StateSet& PipelineSceneGraph::getOrCreateStateSet(const ShaderState& shaderState, const PipelineState& pipelineState)  { uint64_t h=stateSetHash(shaderState, pipelineState); StateSetMapItem* item=findStateSetMapItem(h, shaderState, pipelineState); return (item) ? item->stateSet : createStateSet(h, shaderState, pipelineState, CreationMode::Sync); }
+inline CadR::StateSet& PipelineSceneGraph::getOrCreateStateSetAsync(const ShaderState& shaderState, const PipelineState& pipelineState)  { uint64_t h=stateSetHash(shaderState, pipelineState); StateSetMapItem* item=findStateSetMapItem(h, shaderState, pipelineState); return (item) ? item->stateSet : createStateSet(h, shaderState, pipelineState, CreationMode::Async); }
+inline CadR::StateSet& PipelineSceneGraph::getOrCreateStateSetAuto(const ShaderState& shaderState, const PipelineState& pipelineState)  { uint64_t h=stateSetHash(shaderState, pipelineState); StateSetMapItem* item=findStateSetMapItem(h, shaderState, pipelineState); return (item) ? item->stateSet : createStateSet(h, shaderState, pipelineState, CreationMode::Auto); }
+inline CadR::StateSet* PipelineSceneGraph::getStateSet(const ShaderState& shaderState, const PipelineState& pipelineState)  { StateSetMapItem* item=findStateSetMapItem(stateSetHash(shaderState, pipelineState), shaderState, pipelineState); return (item) ? &item->stateSet : nullptr; }
+inline void PipelineSceneGraph::deleteStateSet(CadR::StateSet& ss) noexcept  { StateSetMapItem& item=stateSetToStateSetMapItem(ss); removeFromPendingList(item); if(item.autoOptimized) { _autoItemList.erase(std::find(_autoItemList.begin(), _autoItemList.end(), &item)); _autoOptimizationStats.numStateSets--; if(item.promoted) _autoOptimizationStats.numPromoted--; } eraseStateSetMapItem(&item); delete &item; }
+inline size_t PipelineSceneGraph::numStateSets() const  { return _numStateSets; }
 inline void PipelineSceneGraph::setProjectionViewportAndScissor(const glm::mat4x4& projectionMatrix, const vk::Viewport& viewport, const vk::Rect2D& scissor)  { _pipelineLibrary->setProjectionViewportAndScissor(projectionMatrix, viewport, scissor); }
 inline void PipelineSceneGraph::setProjectionViewportAndScissor(const std::vector<glm::mat4x4>& projectionMatrixList, const std::vector<vk::Viewport>& viewportList, const std::vector<vk::Rect2D>& scissorList)  { _pipelineLibrary->setProjectionViewportAndScissor(projectionMatrixList, viewportList, scissorList); }
+inline void PipelineSceneGraph::waitForAsyncPipelines()  { _pipelineLibrary->waitForAsyncPipelines(); updateAsyncPipelines(); }
+inline const AsyncPipelineStats& PipelineSceneGraph::asyncPipelineStats() const  { return _pipelineLibrary->asyncPipelineStats(); }
+inline void PipelineSceneGraph::removeFromPendingList(StateSetMapItem& item) noexcept  { if(item.pendingPipeline) _pendingItemList.erase(std::find(_pendingItemList.begin(), _pendingItemList.end(), &item)); }
+inline void PipelineSceneGraph::setAutoOptimizationPolicy(const AutoOptimizationPolicy& policy)  { _autoOptimizationPolicy = policy; }
+inline const AutoOptimizationPolicy& PipelineSceneGraph::autoOptimizationPolicy() const  { return _autoOptimizationPolicy; }
+inline const AutoOptimizationStats& PipelineSceneGraph::autoOptimizationStats() const  { return _autoOptimizationStats; }
+inline double PipelineSceneGraph::stateSetUsage(CadR::StateSet& ss) const  { return stateSetToStateSetMapItem(ss).usage; }
+inline bool PipelineSceneGraph::indexedDraw() const  { return _indexedDraw; }
+inline void PipelineSceneGraph::setIndexedDraw(bool value)  { _indexedDraw = value; }
 inline CadR::VulkanDevice& PipelineSceneGraph::device() const  { return _pipelineLibrary->device(); }
 inline PipelineLibrary& PipelineSceneGraph::pipelineLibrary() const  { return *_pipelineLibrary; }
 inline ShaderLibrary& PipelineSceneGraph::shaderLibrary() const  { return *_shaderLibrary; }
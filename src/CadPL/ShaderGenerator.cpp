@@ -16,6 +16,12 @@ static const uint32_t vertexUberShaderSpirv[]={
 static const uint32_t vertexIdBufferUberShaderSpirv[]={
 #include "shaders/UberShader-idBuffer.vert.spv"
 };
+static const uint32_t vertexBarycentricUberShaderSpirv[]={
+#include "shaders/UberShaderBarycentric.vert.spv"
+};
+static const uint32_t vertexBarycentricIdBufferUberShaderSpirv[]={
+#include "shaders/UberShaderBarycentric-idBuffer.vert.spv"
+};
 static const uint32_t geometryUberShaderTrianglesSpirv[]={
 #include "shaders/UberShaderTriangles.geom.spv"
 };
@@ -46,6 +52,24 @@ static const uint32_t fragmentIdBufferUberShaderLinesSpirv[]={
 static const uint32_t fragmentTransparencyUberShaderLinesSpirv[]={
 #include "shaders/UberShaderLines-transparency.frag.spv"
 };
+static const uint32_t fragmentBarycentricUberShaderTrianglesSpirv[]={
+#include "shaders/UberShaderTriangles-barycentric.frag.spv"
+};
+static const uint32_t fragmentBarycentricIdBufferUberShaderTrianglesSpirv[]={
+#include "shaders/UberShaderTriangles-barycentric-idBuffer.frag.spv"
+};
+static const uint32_t fragmentBarycentricTransparencyUberShaderTrianglesSpirv[]={
+#include "shaders/UberShaderTriangles-barycentric-transparency.frag.spv"
+};
+static const uint32_t fragmentBarycentricUberShaderLinesSpirv[]={
+#include "shaders/UberShaderLines-barycentric.frag.spv"
+};
+static const uint32_t fragmentBarycentricIdBufferUberShaderLinesSpirv[]={
+#include "shaders/UberShaderLines-barycentric-idBuffer.frag.spv"
+};
+static const uint32_t fragmentBarycentricTransparencyUberShaderLinesSpirv[]={
+#include "shaders/UberShaderLines-barycentric-transparency.frag.spv"
+};
 static const uint32_t vertexUberShaderPointsSpirv[]={
 #include "shaders/UberShaderPoints.vert.spv"
 };
@@ -64,7 +88,7 @@ static const uint32_t fragmentTransparencyUberShaderPointsSpirv[]={
 
 
 
-vk::ShaderModule ShaderGenerator::createVertexShader(const ShaderState& state, CadR::VulkanDevice& device)
+tuple<const uint32_t*,size_t> ShaderGenerator::getVertexShaderCode(const ShaderState& state, bool fragmentShaderBarycentric)
 {
 	const uint32_t* code;
 	size_t size;
@@ -78,6 +102,16 @@ vk::ShaderModule ShaderGenerator::createVertexShader(const ShaderState& state, C
 			size = sizeof(vertexUberShaderPointsSpirv);
 		}
 	}
+	else if(fragmentShaderBarycentric) {
+		if(state.idBuffer) {
+			code = vertexBarycentricIdBufferUberShaderSpirv;
+			size = sizeof(vertexBarycentricIdBufferUberShaderSpirv);
+		}
+		else {
+			code = vertexBarycentricUberShaderSpirv;
+			size = sizeof(vertexBarycentricUberShaderSpirv);
+		}
+	}
 	else {
 		if(state.idBuffer) {
 			code = vertexIdBufferUberShaderSpirv;
@@ -89,18 +123,11 @@ vk::ShaderModule ShaderGenerator::createVertexShader(const ShaderState& state, C
 		}
 	}
 
-	return
-		device.createShaderModule(
-			vk::ShaderModuleCreateInfo(
-				vk::ShaderModuleCreateFlags(),  // flags
-				size,  // codeSize
-				code   // pCode
-			)
-		);
+	return { code, size };
 }
 
 
-vk::ShaderModule ShaderGenerator::createGeometryShader(const ShaderState& state, CadR::VulkanDevice& device)
+tuple<const uint32_t*,size_t> ShaderGenerator::getGeometryShaderCode(const ShaderState& state)
 {
 	const uint32_t* code;
 	size_t size;
@@ -129,21 +156,15 @@ vk::ShaderModule ShaderGenerator::createGeometryShader(const ShaderState& state,
 		}
 		break;
 	default:
-		return vk::ShaderModule(nullptr);
+		code = nullptr;
+		size = 0;
 	}
 
-	return
-		device.createShaderModule(
-			vk::ShaderModuleCreateInfo(
-				vk::ShaderModuleCreateFlags(),  // flags
-				size,  // codeSize
-				code   // pCode
-			)
-		);
+	return { code, size };
 }
 
 
-vk::ShaderModule ShaderGenerator::createFragmentShader(const ShaderState& state, CadR::VulkanDevice& device)
+tuple<const uint32_t*,size_t> ShaderGenerator::getFragmentShaderCode(const ShaderState& state, bool fragmentShaderBarycentric)
 {
 	const uint32_t* code;
 	size_t size;
@@ -151,7 +172,21 @@ vk::ShaderModule ShaderGenerator::createFragmentShader(const ShaderState& state,
 	case vk::PrimitiveTopology::eTriangleList:
 	case vk::PrimitiveTopology::eTriangleStrip:
 	case vk::PrimitiveTopology::eTriangleFan:
-		if(state.idBuffer) {
+		if(fragmentShaderBarycentric) {
+			if(state.idBuffer) {
+				code = fragmentBarycentricIdBufferUberShaderTrianglesSpirv;
+				size = sizeof(fragmentBarycentricIdBufferUberShaderTrianglesSpirv);
+			}
+			else if(state.transparency) {
+				code = fragmentBarycentricTransparencyUberShaderTrianglesSpirv;
+				size = sizeof(fragmentBarycentricTransparencyUberShaderTrianglesSpirv);
+			}
+			else {
+				code = fragmentBarycentricUberShaderTrianglesSpirv;
+				size = sizeof(fragmentBarycentricUberShaderTrianglesSpirv);
+			}
+		}
+		else if(state.idBuffer) {
 			code = fragmentIdBufferUberShaderTrianglesSpirv;
 			size = sizeof(fragmentIdBufferUberShaderTrianglesSpirv);
 		}
@@ -166,7 +201,21 @@ vk::ShaderModule ShaderGenerator::createFragmentShader(const ShaderState& state,
 		break;
 	case vk::PrimitiveTopology::eLineList:
 	case vk::PrimitiveTopology::eLineStrip:
-		if(state.idBuffer) {
+		if(fragmentShaderBarycentric) {
+			if(state.idBuffer) {
+				code = fragmentBarycentricIdBufferUberShaderLinesSpirv;
+				size = sizeof(fragmentBarycentricIdBufferUberShaderLinesSpirv);
+			}
+			else if(state.transparency) {
+				code = fragmentBarycentricTransparencyUberShaderLinesSpirv;
+				size = sizeof(fragmentBarycentricTransparencyUberShaderLinesSpirv);
+			}
+			else {
+				code = fragmentBarycentricUberShaderLinesSpirv;
+				size = sizeof(fragmentBarycentricUberShaderLinesSpirv);
+			}
+		}
+		else if(state.idBuffer) {
 			code = fragmentIdBufferUberShaderLinesSpirv;
 			size = sizeof(fragmentIdBufferUberShaderLinesSpirv);
 		}
@@ -198,12 +247,39 @@ vk::ShaderModule ShaderGenerator::createFragmentShader(const ShaderState& state,
 		size = 0;
 	}
 
+	return { code, size };
+}
+
+
+static vk::ShaderModule createShaderModule(tuple<const uint32_t*,size_t> code, CadR::VulkanDevice& device)
+{
 	return
 		device.createShaderModule(
 			vk::ShaderModuleCreateInfo(
 				vk::ShaderModuleCreateFlags(),  // flags
-				size,  // codeSize
-				code   // pCode
+				get<1>(code),  // codeSize
+				get<0>(code)   // pCode
 			)
 		);
 }
+
+
+vk::ShaderModule ShaderGenerator::createVertexShader(const ShaderState& state, CadR::VulkanDevice& device, bool fragmentShaderBarycentric)
+{
+	return createShaderModule(getVertexShaderCode(state, fragmentShaderBarycentric), device);
+}
+
+
+vk::ShaderModule ShaderGenerator::createGeometryShader(const ShaderState& state, CadR::VulkanDevice& device)
+{
+	auto code = getGeometryShaderCode(state);
+	if(get<0>(code) == nullptr)
+		return vk::ShaderModule(nullptr);
+	return createShaderModule(code, device);
+}
+
+
+vk::ShaderModule ShaderGenerator::createFragmentShader(const ShaderState& state, CadR::VulkanDevice& device, bool fragmentShaderBarycentric)
+{
+	return createShaderModule(getFragmentShaderCode(state, fragmentShaderBarycentric), device);
+}
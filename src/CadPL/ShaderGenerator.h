@@ -1,9 +1,11 @@
-// SPDX-FileCopyrightText: 2025 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2025-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
 #pragma once
 
+#include <cstdint>
+#include <tuple>
 #include <vulkan/vulkan.hpp>
 
 namespace CadR {
@@ -18,19 +20,22 @@ struct ShaderState;
 
 class CADPL_EXPORT ShaderGenerator {
 public:
-	[[nodiscard]] static vk::ShaderModule createVertexShader(const ShaderState& state, CadR::VulkanDevice& device);
+	static std::tuple<const uint32_t*,size_t> getVertexShaderCode(const ShaderState& state, bool fragmentShaderBarycentric = false);  //< Returns SPIR-V code and its size in bytes.
+	static std::tuple<const uint32_t*,size_t> getGeometryShaderCode(const ShaderState& state);  //< Returns SPIR-V code and its size in bytes. Null code is returned if the state does not use geometry shader.
+	static std::tuple<const uint32_t*,size_t> getFragmentShaderCode(const ShaderState& state, bool fragmentShaderBarycentric = false);  //< Returns SPIR-V code and its size in bytes.
+	[[nodiscard]] static vk::ShaderModule createVertexShader(const ShaderState& state, CadR::VulkanDevice& device, bool fragmentShaderBarycentric = false);
 	[[nodiscard]] static vk::ShaderModule createGeometryShader(const ShaderState& state, CadR::VulkanDevice& device);
-	[[nodiscard]] static vk::ShaderModule createFragmentShader(const ShaderState& state, CadR::VulkanDevice& device);
-	static vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice> createVertexShaderUnique(const ShaderState& state, CadR::VulkanDevice& device);
+	[[nodiscard]] static vk::ShaderModule createFragmentShader(const ShaderState& state, CadR::VulkanDevice& device, bool fragmentShaderBarycentric = false);
+	static vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice> createVertexShaderUnique(const ShaderState& state, CadR::VulkanDevice& device, bool fragmentShaderBarycentric = false);
 	static vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice> createGeometryShaderUnique(const ShaderState& state, CadR::VulkanDevice& device);
-	static vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice> createFragmentShaderUnique(const ShaderState& state, CadR::VulkanDevice& device);
+	static vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice> createFragmentShaderUnique(const ShaderState& state, CadR::VulkanDevice& device, bool fragmentShaderBarycentric = false);
 };
 
 
 // inline functions
-inline vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice> ShaderGenerator::createVertexShaderUnique(const ShaderState& state, CadR::VulkanDevice& device)  { return vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice>(createVertexShader(state, device)); }
+inline vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice> ShaderGenerator::createVertexShaderUnique(const ShaderState& state, CadR::VulkanDevice& device, bool fragmentShaderBarycentric)  { return vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice>(createVertexShader(state, device, fragmentShaderBarycentric)); }
 inline vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice> ShaderGenerator::createGeometryShaderUnique(const ShaderState& state, CadR::VulkanDevice& device)  { return vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice>(createGeometryShader(state, device)); }
-inline vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice> ShaderGenerator::createFragmentShaderUnique(const ShaderState& state, CadR::VulkanDevice& device)  { return vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice>(createFragmentShader(state, device)); }
+inline vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice> ShaderGenerator::createFragmentShaderUnique(const ShaderState& state, CadR::VulkanDevice& device, bool fragmentShaderBarycentric)  { return vk::UniqueHandle<vk::ShaderModule, CadR::VulkanDevice>(createFragmentShader(state, device, fragmentShaderBarycentric)); }
 
 
 }
@@ -47,6 +47,7 @@ void ShaderLibrary::init(CadR::VulkanDevice& device, uint32_t maxTextures)
 	destroy();
 
 	_device = &device;
+	_fragmentShaderBarycentric = device.isExtensionEnabled(VK_KHR_FRAGMENT_SHADER_BARYCENTRIC_EXTENSION_NAME);
 
 	_descriptorSetLayout =
 		_device->createDescriptorSetLayout(
@@ -81,13 +82,7 @@ void ShaderLibrary::init(CadR::VulkanDevice& device, uint32_t maxTextures)
 				1,  // setLayoutCount
 				&_descriptorSetLayout,  // pSetLayouts
 				1,  // pushConstantRangeCount
-				array{
-					vk::PushConstantRange{  // pPushConstantRanges
-						vk::ShaderStageFlagBits::eAllGraphics,  // stageFlags
-						0,  // offset
-						112  // size
-					},
-				}.data()
+				&pushConstantRange  // pPushConstantRanges
 			)
 		);
 	_descriptorSetLayoutList.reserve(1);
@@ -113,11 +108,11 @@ void ShaderLibrary::destroyShaderModule(void* shaderModuleObject) noexcept
 
 SharedShaderModule ShaderLibrary::getOrCreateVertexShader(const ShaderState& state)
 {
-	VertexShaderMapKey key(state);
+	VertexShaderMapKey key(state, _fragmentShaderBarycentric);
 	auto [it, newRecord] = _vertexShaderMap.try_emplace(key);
 	if(newRecord) {
 		try {
-			it->second.shaderModule = ShaderGenerator::createVertexShader(state, *_device);
+			it->second.shaderModule = ShaderGenerator::createVertexShader(state, *_device, _fragmentShaderBarycentric);
 		} catch(...) {
 			_vertexShaderMap.erase(it);
 			throw;
@@ -133,11 +128,14 @@ SharedShaderModule ShaderLibrary::getOrCreateVertexShader(const ShaderState& sta
 
 SharedShaderModule ShaderLibrary::getOrCreateGeometryShader(const ShaderState& state)
 {
-	GeometryShaderMapKey key(state);
+	GeometryShaderMapKey key(state, _fragmentShaderBarycentric);
 	auto [it, newRecord] = _geometryShaderMap.try_emplace(key);
 	if(newRecord) {
 		try {
-			it->second.shaderModule = ShaderGenerator::createGeometryShader(state, *_device);
+			it->second.shaderModule =
+				(key.type != GeometryShaderMapKey::Type::Invalid)
+					? ShaderGenerator::createGeometryShader(state, *_device)
+					: vk::ShaderModule(nullptr);
 		} catch(...) {
 			_geometryShaderMap.erase(it);
 			throw;
@@ -153,11 +151,11 @@ SharedShaderModule ShaderLibrary::getOrCreateGeometryShader(const ShaderState& s
 
 SharedShaderModule ShaderLibrary::getOrCreateFragmentShader(const ShaderState& state)
 {
-	FragmentShaderMapKey key(state);
+	FragmentShaderMapKey key(state, _fragmentShaderBarycentric);
 	auto [it, newRecord] = _fragmentShaderMap.try_emplace(key);
 	if(newRecord) {
 		try {
-			it->second.shaderModule = ShaderGenerator::createFragmentShader(state, *_device);
+			it->second.shaderModule = ShaderGenerator::createFragmentShader(state, *_device, _fragmentShaderBarycentric);
 		} catch(...) {
 			_fragmentShaderMap.erase(it);
 			throw;
@@ -171,6 +169,20 @@ SharedShaderModule ShaderLibrary::getOrCreateFragmentShader(const ShaderState& s
 }
 
 
+ShaderState ShaderState::uberShaderState() const
+{
+	ShaderState r = *this;
+	r.attribAccessInfo.fill(0);
+	r.attribSetup = 0;
+	r.materialSetup = 0;
+	r.pointSize = 0.f;
+	r.textureSetup.fill(0);
+	r.lightSetup.fill(0);
+	r.optimizeFlags = OptimizeNone;
+	return r;
+}
+
+
 bool ShaderState::operator<(const ShaderState& rhs) const
 {
 	if(attribAccessInfo < rhs.attribAccessInfo)  return true;
@@ -189,11 +201,46 @@ bool ShaderState::operator<(const ShaderState& rhs) const
 	if(transparency > rhs.transparency)  return false;
 	if(primitiveTopology < rhs.primitiveTopology)  return true;
 	if(primitiveTopology > rhs.primitiveTopology)  return false;
-	return projectionHandling < rhs.projectionHandling;
+	if(projectionHandling < rhs.projectionHandling)  return true;
+	if(projectionHandling > rhs.projectionHandling)  return false;
+	return optimizeFlags.to_ulong() < rhs.optimizeFlags.to_ulong();
+}
+
+
+bool ShaderState::operator==(const ShaderState& rhs) const
+{
+	return attribAccessInfo == rhs.attribAccessInfo &&
+	       attribSetup == rhs.attribSetup &&
+	       materialSetup == rhs.materialSetup &&
+	       textureSetup == rhs.textureSetup &&
+	       lightSetup == rhs.lightSetup &&
+	       idBuffer == rhs.idBuffer &&
+	       transparency == rhs.transparency &&
+	       primitiveTopology == rhs.primitiveTopology &&
+	       projectionHandling == rhs.projectionHandling &&
+	       optimizeFlags == rhs.optimizeFlags;
+}
+
+
+uint64_t ShaderState::hash() const
+{
+	// hash arrays by 64-bit words
+	uint64_t words[(sizeof(attribAccessInfo)+sizeof(textureSetup)+sizeof(lightSetup)+7)/8] = {};
+	memcpy(words, attribAccessInfo.data(), sizeof(attribAccessInfo));
+	memcpy(reinterpret_cast<char*>(words)+sizeof(attribAccessInfo), textureSetup.data(), sizeof(textureSetup));
+	memcpy(reinterpret_cast<char*>(words)+sizeof(attribAccessInfo)+sizeof(textureSetup), lightSetup.data(), sizeof(lightSetup));
+	uint64_t h = hashCombine(attribSetup, uint64_t(materialSetup) << 32);
+	for(uint64_t w : words)
+		h = hashCombine(h, w);
+
+	// hash small members packed into a single word
+	return hashCombine(h,
+		uint64_t(idBuffer) | (uint64_t(transparency) << 1) | (uint64_t(projectionHandling) << 2) |
+		(optimizeFlags.to_ullong() << 8) | (uint64_t(primitiveTopology) << 32));
 }
 
 
-ShaderLibrary::VertexShaderMapKey::VertexShaderMapKey(const ShaderState& shaderState)
+ShaderLibrary::VertexShaderMapKey::VertexShaderMapKey(const ShaderState& shaderState, bool fragmentShaderBarycentric)
 {
 	switch(shaderState.primitiveTopology) {
 	case vk::PrimitiveTopology::eTriangleList:
@@ -201,7 +248,10 @@ ShaderLibrary::VertexShaderMapKey::VertexShaderMapKey(const ShaderState& shaderS
 	case vk::PrimitiveTopology::eTriangleFan:
 	case vk::PrimitiveTopology::eLineList:
 	case vk::PrimitiveTopology::eLineStrip:
-		type = shaderState.idBuffer ? Type::TrianglesAndLinesIdBuffer : Type::TrianglesAndLines;
+		if(fragmentShaderBarycentric)
+			type = shaderState.idBuffer ? Type::TrianglesAndLinesBarycentricIdBuffer : Type::TrianglesAndLinesBarycentric;
+		else
+			type = shaderState.idBuffer ? Type::TrianglesAndLinesIdBuffer : Type::TrianglesAndLines;
 		break;
 	case vk::PrimitiveTopology::ePointList:
 		type = shaderState.idBuffer ? Type::PointsIdBuffer : Type::Points;
@@ -212,8 +262,14 @@ ShaderLibrary::VertexShaderMapKey::VertexShaderMapKey(const ShaderState& shaderS
 }
 
 
-ShaderLibrary::GeometryShaderMapKey::GeometryShaderMapKey(const ShaderState& shaderState)
+ShaderLibrary::GeometryShaderMapKey::GeometryShaderMapKey(const ShaderState& shaderState, bool fragmentShaderBarycentric)
 {
+	// no geometry shader is used when rendering with fragment shader barycentrics
+	if(fragmentShaderBarycentric) {
+		type = Type::Invalid;
+		return;
+	}
+
 	switch(shaderState.primitiveTopology) {
 	case vk::PrimitiveTopology::eTriangleList:
 	case vk::PrimitiveTopology::eTriangleStrip:
@@ -230,19 +286,19 @@ ShaderLibrary::GeometryShaderMapKey::GeometryShaderMapKey(const ShaderState& sha
 }
 
 
-ShaderLibrary::FragmentShaderMapKey::FragmentShaderMapKey(const ShaderState& shaderState)
+ShaderLibrary::FragmentShaderMapKey::FragmentShaderMapKey(const ShaderState& shaderState, bool fragmentShaderBarycentric)
 {
 	switch(shaderState.primitiveTopology) {
 	case vk::PrimitiveTopology::eTriangleList:
 	case vk::PrimitiveTopology::eTriangleStrip:
 	case vk::PrimitiveTopology::eTriangleFan:
-		type = Type::Triangles;
+		type = fragmentShaderBarycentric ? Type::TrianglesBarycentric : Type::Triangles;
 		if(shaderState.idBuffer)  type = Type(uint32_t(type) + 1);
 		if(shaderState.transparency)  type = Type(uint32_t(type) + 2);
 		break;
 	case vk::PrimitiveTopology::eLineList:
 	case vk::PrimitiveTopology::eLineStrip:
-		type = Type::Lines;
+		type = fragmentShaderBarycentric ? Type::LinesBarycentric : Type::Lines;
 		if(shaderState.idBuffer)  type = Type(uint32_t(type) + 1);
 		if(shaderState.transparency)  type = Type(uint32_t(type) + 2);
 		break;
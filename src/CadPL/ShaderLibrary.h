@@ -6,6 +6,8 @@
 
 #include <array>
 #include <bitset>
+#include <cstdint>
+#include <cstring>
 #include <map>
 #include <vulkan/vulkan.hpp>
 
@@ -16,6 +18,10 @@ class VulkanDevice;
 namespace CadPL {
 
 
+uint64_t hashCombine(uint64_t seed, uint64_t value);  //< Mixes value into the hash seed. It is used by ShaderState::hash() and PipelineState::hash().
+template<typename T> uint64_t hashWord(const T& value);  //< Returns bit pattern of up to eight bytes long value as 64-bit word suitable for hashCombine().
+
+
 struct CADPL_EXPORT ShaderState {
 
 	bool idBuffer;
@@ -48,7 +54,11 @@ struct CADPL_EXPORT ShaderState {
 
 	std::bitset<numOptimizeFlags> optimizeFlags = OptimizeNone;
 
+	ShaderState uberShaderState() const;  //< Returns ShaderState of the uber-shader pipeline that renders this state using push constants only. All the members passed through push constants are zeroed and optimizeFlags are set to OptimizeNone, so all the states differing only in these members share the same PipelineFamily.
 	bool operator<(const ShaderState& rhs) const;
+	bool operator==(const ShaderState& rhs) const;  //< Compares the same members as operator<(), so pointSize is ignored.
+	bool operator!=(const ShaderState& rhs) const;
+	uint64_t hash() const;  //< Returns 64-bit hash of the members compared by operator==(). Equal states always produce equal hash.
 
 };
 
@@ -81,6 +91,7 @@ class CADPL_EXPORT ShaderLibrary {
 protected:
 
 	CadR::VulkanDevice* _device = nullptr;
+	bool _fragmentShaderBarycentric = false;
 
 	enum class OwningMap { eUnknown = 0, eVertex, eGeometry, eFragment };
 	struct AbstractShaderModuleObject {
@@ -96,22 +107,24 @@ protected:
 
 	struct VertexShaderMapKey {
 		enum class Type { Invalid, TrianglesAndLines, TrianglesAndLinesIdBuffer,
-			Points, PointsIdBuffer };
+			Points, PointsIdBuffer, TrianglesAndLinesBarycentric, TrianglesAndLinesBarycentricIdBuffer };
 		Type type;
-		VertexShaderMapKey(const ShaderState& shaderState);
+		VertexShaderMapKey(const ShaderState& shaderState, bool fragmentShaderBarycentric);
 		bool operator<(const VertexShaderMapKey& rhs) const;
 	};
 	struct GeometryShaderMapKey {
 		enum class Type { Invalid, Triangles, TrianglesIdBuffer, Lines, LinesIdBuffer };
 		Type type;
-		GeometryShaderMapKey(const ShaderState& shaderState);
+		GeometryShaderMapKey(const ShaderState& shaderState, bool fragmentShaderBarycentric);
 		bool operator<(const GeometryShaderMapKey& rhs) const;
 	};
 	struct FragmentShaderMapKey {
 		enum class Type : uint32_t { Invalid, Triangles, TrianglesIdBuffer, TrianglesTransparency,
-			Lines, LinesIdBuffer, LinesTransparency, Points, PointsIdBuffer, PointsTransparency };  // The items are in certain order. See the constructor code.
+			Lines, LinesIdBuffer, LinesTransparency, Points, PointsIdBuffer, PointsTransparency,
+			TrianglesBarycentric, TrianglesBarycentricIdBuffer, TrianglesBarycentricTransparency,
+			LinesBarycentric, LinesBarycentricIdBuffer, LinesBarycentricTransparency };  // The items are in certain order. See the constructor code.
 		Type type;
-		FragmentShaderMapKey(const ShaderState& shaderState);
+		FragmentShaderMapKey(const ShaderState& shaderState, bool fragmentShaderBarycentric);
 		bool operator<(const FragmentShaderMapKey& rhs) const;
 	};
 
@@ -144,7 +157,13 @@ public:
 	SharedShaderModule getGeometryShader(const ShaderState& state);
 	SharedShaderModule getFragmentShader(const ShaderState& state);
 
+	// geometry shader free rendering
+	bool fragmentShaderBarycentric() const;  //< Returns true if triangles and lines are rendered without geometry shader. The fragment shader reads the data of all the primitive's vertices using VK_KHR_fragment_shader_barycentric extension instead. It is enabled by init() if the device was created with the extension enabled.
+	void setFragmentShaderBarycentric(bool value);  //< Enables or disables rendering without geometry shader. If enabled, the device must have VK_KHR_fragment_shader_barycentric extension and fragmentShaderBarycentric feature enabled. It affects only the shaders created after the call.
+
 	// getters
+	static constexpr const vk::PushConstantRange pushConstantRange{ vk::ShaderStageFlagBits::eAllGraphics, 0, 116 };  //< Push constant range of pipelineLayout(). See UberShaderInterface.glsl for the push constant layout.
+	static constexpr const uint32_t drawIndexOffsetPushConstantOffset = 112;  //< Push constant offset of drawIndexOffset. It is used by CadR::StateSet for indexed draws split into several draw commands.
 	CadR::VulkanDevice& device() const;
 	vk::PipelineLayout pipelineLayout() const;
 	vk::DescriptorSetLayout descriptorSetLayout() const;
@@ -154,6 +173,9 @@ public:
 
 
 // inline functions
+inline uint64_t hashCombine(uint64_t seed, uint64_t value)  { uint64_t h=(seed^value)*0x9e3779b97f4a7c15; return h^(h>>32); }
+template<typename T> inline uint64_t hashWord(const T& value)  { static_assert(sizeof(T)<=8, "hashWord(): Value too large."); uint64_t r=0; std::memcpy(&r, &value, sizeof(T)); return r; }
+inline bool ShaderState::operator!=(const ShaderState& rhs) const  { return !operator==(rhs); }
 inline SharedShaderModule::SharedShaderModule(void* shaderModuleObject) noexcept  : _smObject(shaderModuleObject) { ShaderLibrary::refShaderModule(shaderModuleObject); }
 inline SharedShaderModule::~SharedShaderModule() noexcept  { if(_smObject) ShaderLibrary::unrefShaderModule(_smObject); }
 inline SharedShaderModule::SharedShaderModule(SharedShaderModule&& other) noexcept  : _smObject(other._smObject) { other._smObject=nullptr; }
@@ -170,9 +192,11 @@ inline bool ShaderLibrary::GeometryShaderMapKey::operator<(const GeometryShaderM
 inline bool ShaderLibrary::FragmentShaderMapKey::operator<(const FragmentShaderMapKey& rhs) const  { return type < rhs.type; }
 inline void ShaderLibrary::refShaderModule(void* shaderModuleObject) noexcept  { auto* smObject=static_cast<ShaderLibrary::AbstractShaderModuleObject*>(shaderModuleObject); smObject->referenceCounter++; }
 inline void ShaderLibrary::unrefShaderModule(void* shaderModuleObject) noexcept  { auto* smObject=static_cast<ShaderLibrary::AbstractShaderModuleObject*>(shaderModuleObject); if(smObject->referenceCounter==1) ShaderLibrary::destroyShaderModule(smObject); else smObject->referenceCounter--; }
-inline SharedShaderModule ShaderLibrary::getVertexShader(const ShaderState& state)  { auto it=_vertexShaderMap.find(state); return (it!=_vertexShaderMap.end()) ? SharedShaderModule(&it->second) : SharedShaderModule(); }
-inline SharedShaderModule ShaderLibrary::getGeometryShader(const ShaderState& state)  { auto it=_geometryShaderMap.find(state); return (it!=_geometryShaderMap.end()) ? SharedShaderModule(&it->second) : SharedShaderModule(); }
-inline SharedShaderModule ShaderLibrary::getFragmentShader(const ShaderState& state)  { auto it=_fragmentShaderMap.find(state); return (it!=_fragmentShaderMap.end()) ? SharedShaderModule(&it->second) : SharedShaderModule(); }
+inline SharedShaderModule ShaderLibrary::getVertexShader(const ShaderState& state)  { auto it=_vertexShaderMap.find(VertexShaderMapKey(state, _fragmentShaderBarycentric)); return (it!=_vertexShaderMap.end()) ? SharedShaderModule(&it->second) : SharedShaderModule(); }
+inline SharedShaderModule ShaderLibrary::getGeometryShader(const ShaderState& state)  { auto it=_geometryShaderMap.find(GeometryShaderMapKey(state, _fragmentShaderBarycentric)); return (it!=_geometryShaderMap.end()) ? SharedShaderModule(&it->second) : SharedShaderModule(); }
+inline SharedShaderModule ShaderLibrary::getFragmentShader(const ShaderState& state)  { auto it=_fragmentShaderMap.find(FragmentShaderMapKey(state, _fragmentShaderBarycentric)); return (it!=_fragmentShaderMap.end()) ? SharedShaderModule(&it->second) : SharedShaderModule(); }
+inline bool ShaderLibrary::fragmentShaderBarycentric() const  { return _fragmentShaderBarycentric; }
+inline void ShaderLibrary::setFragmentShaderBarycentric(bool value)  { _fragmentShaderBarycentric = value; }
 inline CadR::VulkanDevice& ShaderLibrary::device() const  { return *_device; }
 inline vk::PipelineLayout ShaderLibrary::pipelineLayout() const  { return _pipelineLayout; }
 inline vk::DescriptorSetLayout ShaderLibrary::descriptorSetLayout() const  { return _descriptorSetLayout; }
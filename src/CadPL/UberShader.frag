@@ -7,12 +7,15 @@
 #extension GL_ARB_gpu_shader_int64 : require
 #extension GL_EXT_nonuniform_qualifier : require  // this enables SPV_EXT_descriptor_indexing
 #extension GL_GOOGLE_include_directive : require
+#ifdef BARYCENTRIC
+# extension GL_EXT_fragment_shader_barycentric : require
+#endif
 #include "UberShaderReadFuncs.glsl"
 #include "UberShaderInterface.glsl"
 
 
 // input and output
-#if defined(TRIANGLES) || defined(LINES)
+#if (defined(TRIANGLES) || defined(LINES)) && !defined(BARYCENTRIC)
 layout(location = 0) in flat u64vec4 inVertexAndDrawableDataPtrList;  // VertexData on indices 0..2 for triangles and 0..1 for lines. DrawableData on index 3. The vector occupies locations 0 and 1.
 # ifdef TRIANGLES
 layout(location = 2) in smooth vec3 inBarycentricCoords;  // barycentric coordinates using perspective correction
@@ -20,6 +23,18 @@ layout(location = 2) in smooth vec3 inBarycentricCoords;  // barycentric coordin
 # ifdef LINES
 layout(location = 2) in smooth vec2 inBarycentricCoords;  // barycentric coordinates using perspective correction
 # endif
+#endif
+#if (defined(TRIANGLES) || defined(LINES)) && defined(BARYCENTRIC)
+layout(location = 0) pervertexEXT in uint64_t inVertexDataPtr[3];  // VertexData of each vertex of the primitive; only indices 0..1 are used for lines
+layout(location = 1) in flat uint64_t inDrawableDataPtr;
+# ifdef TRIANGLES
+#  define inBarycentricCoords gl_BaryCoordEXT  // barycentric coordinates using perspective correction
+# endif
+# ifdef LINES
+#  define inBarycentricCoords gl_BaryCoordEXT.xy  // barycentric coordinates using perspective correction
+# endif
+#endif
+#if defined(TRIANGLES) || defined(LINES)
 layout(location = 3) in smooth vec3 inFragmentPosition3;  // in eye coordinates
 layout(location = 4) in smooth vec3 inFragmentNormal;  // in eye coordinates
 layout(location = 5) in smooth vec3 inFragmentTangent;  // in eye coordinates
@@ -53,6 +68,25 @@ layout(location = 4) out float outCount;
 // textures
 layout(set=0, binding=0) uniform sampler2D textureList[];
 
+vec4 sampleTexture(uint textureIndex, inout uint64_t textureParamsPtr, vec2 uv)
+{
+	uint textureId = getTextureIdAndUpdatePtr(textureParamsPtr);
+
+	// textures packed in atlas
+	// (texture coordinates are wrapped into 0..1 range and mapped into the atlas region;
+	// gradients are computed from unwrapped coordinates to avoid filtering artifacts on the wrap boundary;
+	// the condition comes from textureSetup, so it is uniform and often resolved by specialization constants)
+	if(getTexturePackedInAtlas(textureIndex)) {
+		TextureAtlasEntry entry = TextureAtlasDataRef(SceneDataRef(sceneDataPtr).textureAtlasDataPtr).entryList[textureId];
+		vec2 scale = entry.scaleAndOffset.xy;
+		return textureGrad(textureList[entry.descriptorIndex], fract(uv) * scale + entry.scaleAndOffset.zw,
+		                   dFdx(uv) * scale, dFdy(uv) * scale);
+	}
+
+	// standalone textures
+	return texture(textureList[textureId], uv);
+}
+
 
 const float Pi = 3.1415926536;
 float sqr(float v)  { return v * v; }
@@ -337,14 +371,22 @@ void main()
 	// input data and structures
 	SceneDataRef scene = SceneDataRef(sceneDataPtr);
 	vec3 viewerToFragmentDirection = normalize(inFragmentPosition3);
-#ifdef TRIANGLES
+#if defined(TRIANGLES) && !defined(BARYCENTRIC)
 	u64vec3 vertexDataPtrList = inVertexAndDrawableDataPtrList.xyz;
 	uint64_t drawableDataPtr = inVertexAndDrawableDataPtrList.w;
 #endif
-#ifdef LINES
+#if defined(LINES) && !defined(BARYCENTRIC)
 	u64vec2 vertexDataPtrList = inVertexAndDrawableDataPtrList.xy;
 	uint64_t drawableDataPtr = inVertexAndDrawableDataPtrList.w;
 #endif
+#if defined(TRIANGLES) && defined(BARYCENTRIC)
+	u64vec3 vertexDataPtrList = u64vec3(inVertexDataPtr[0], inVertexDataPtr[1], inVertexDataPtr[2]);
+	uint64_t drawableDataPtr = inDrawableDataPtr;
+#endif
+#if defined(LINES) && defined(BARYCENTRIC)
+	u64vec2 vertexDataPtrList = u64vec2(inVertexDataPtr[0], inVertexDataPtr[1]);
+	uint64_t drawableDataPtr = inDrawableDataPtr;
+#endif
 #ifdef POINTS
 	uint64_t vertexDataPtr = inVertexDataPtr;
 	uint64_t drawableDataPtr = inDrawableDataPtr;
@@ -416,7 +458,7 @@ void main()
 #endif
 
 			// sample texture
-			vec4 baseTextureValue = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv);
+			vec4 baseTextureValue = sampleTexture(textureIndex, textureParamsPtr, uv);
 
 			// apply texture alpha using texEnv
 			uint texEnv = getTextureEnvironment(textureIndex);
@@ -548,7 +590,7 @@ void main()
 #endif
 
 			// sample texture
-			baseTextureValue = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv);
+			baseTextureValue = sampleTexture(textureIndex, textureParamsPtr, uv);
 
 			// multiply by strength
 			if(getTextureUseStrength(textureIndex))
@@ -599,7 +641,7 @@ void main()
 			#endif
 
 				// sample texture
-				occlusionTextureValue = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv).r;
+				occlusionTextureValue = sampleTexture(textureIndex, textureParamsPtr, uv).r;
 
 				// multiply by strength
 				if(getTextureUseStrength(textureIndex))
@@ -636,10 +678,14 @@ void main()
 			#endif
 
 				// sample texture
-				vec3 tangentSpaceNormal = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv).rgb;
-
-				// transform in tangent space and normalize
-				tangentSpaceNormal = tangentSpaceNormal * 2 - 1;  // transform from 0..1 to -1..1
+				vec2 sampledNormal = sampleTexture(textureIndex, textureParamsPtr, uv).rg;
+
+				// transform in tangent space and normalize;
+				// z is reconstructed from x and y because BC5 compressed normal maps store only two channels
+				// (blue channel of BC5 textures reads as zero)
+				vec3 tangentSpaceNormal;
+				tangentSpaceNormal.xy = sampledNormal * 2 - 1;  // transform from 0..1 to -1..1
+				tangentSpaceNormal.z = sqrt(max(0.0, 1 - dot(tangentSpaceNormal.xy, tangentSpaceNormal.xy)));
 				if(getTextureUseStrength(textureIndex))
 					tangentSpaceNormal.xy *= getTextureStrengthAndUpdatePtr(textureParamsPtr);
 				tangentSpaceNormal = normalize(tangentSpaceNormal);
@@ -660,8 +706,9 @@ void main()
 			LightRef lightData = LightRef(lightDataPtr);
 
 			// iterate over all light sources
-			uint lightSettings = lightData.settings;
-			if(lightSettings != 0) {
+			uint lightIndex = 0;
+			uint lightType = getLightType(lightIndex, lightData);
+			if(lightType != 0) {
 
 				// Phong color products
 				vec3 ambientProduct  = vec3(0);
@@ -671,7 +718,6 @@ void main()
 				// iterate over all lights
 				do{
 
-					uint lightType = getLightType(lightSettings);
 					if(lightType == 1)
 						openGLDirectionalLight(lightData, normal,
 							viewerToFragmentDirection, phongMaterial.shininess,
@@ -687,9 +733,10 @@ void main()
 
 					lightDataPtr += getLightDataSize();
 					lightData = LightRef(lightDataPtr);
-					lightSettings = lightData.settings;
+					lightIndex++;
+					lightType = getLightType(lightIndex, lightData);
 
-				} while(lightSettings != 0);
+				} while(lightType != 0);
 
 				// Phong equation except emission color
 				outColor.rgb = ((ambientProduct + scene.ambientLight) * ambientColor * occlusionTextureValue) +
@@ -740,7 +787,7 @@ void main()
 #endif
 
 			// sample texture
-			vec3 emission = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv).rgb;
+			vec3 emission = sampleTexture(textureIndex, textureParamsPtr, uv).rgb;
 
 			// multiply by strength
 			if(getTextureUseStrength(textureIndex))
@@ -829,7 +876,7 @@ void main()
 #endif
 
 			// sample texture
-			vec4 baseTextureValue = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv);
+			vec4 baseTextureValue = sampleTexture(textureIndex, textureParamsPtr, uv);
 
 			// multiply by strength
 			if(getTextureUseStrength(textureIndex))
@@ -872,7 +919,7 @@ void main()
 			#endif
 
 				// sample texture
-				vec4 value = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv);
+				vec4 value = sampleTexture(textureIndex, textureParamsPtr, uv);
 				occlusionTextureValue = value.r;
 				roughnessTextureValue = value.g;
 				metalnessTextureValue = value.b;
@@ -900,7 +947,7 @@ void main()
 				#endif
 
 					// sample texture
-					vec4 value = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv);
+					vec4 value = sampleTexture(textureIndex, textureParamsPtr, uv);
 					roughnessTextureValue = value.g;
 					metalnessTextureValue = value.b;
 
@@ -926,7 +973,7 @@ void main()
 				#endif
 
 					// sample texture
-					occlusionTextureValue = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv).r;
+					occlusionTextureValue = sampleTexture(textureIndex, textureParamsPtr, uv).r;
 
 					// multiply by strength
 					if(getTextureUseStrength(textureIndex))
@@ -965,10 +1012,14 @@ void main()
 			#endif
 
 				// sample texture
-				vec3 tangentSpaceNormal = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv).rgb;
-
-				// transform in tangent space and normalize
-				tangentSpaceNormal = tangentSpaceNormal * 2 - 1;  // transform from 0..1 to -1..1
+				vec2 sampledNormal = sampleTexture(textureIndex, textureParamsPtr, uv).rg;
+
+				// transform in tangent space and normalize;
+				// z is reconstructed from x and y because BC5 compressed normal maps store only two channels
+				// (blue channel of BC5 textures reads as zero)
+				vec3 tangentSpaceNormal;
+				tangentSpaceNormal.xy = sampledNormal * 2 - 1;  // transform from 0..1 to -1..1
+				tangentSpaceNormal.z = sqrt(max(0.0, 1 - dot(tangentSpaceNormal.xy, tangentSpaceNormal.xy)));
 				if(getTextureUseStrength(textureIndex))
 					tangentSpaceNormal.xy *= getTextureStrengthAndUpdatePtr(textureParamsPtr);
 				tangentSpaceNormal = normalize(tangentSpaceNormal);
@@ -999,11 +1050,11 @@ void main()
 			outColor.rgb = scene.ambientLight * baseColor.rgb * occlusionTextureValue;
 
 			// iterate over all light sources
-			uint lightSettings = lightData.settings;
-			while(lightSettings != 0) {
+			uint lightIndex = 0;
+			uint lightType = getLightType(lightIndex, lightData);
+			while(lightType != 0) {
 
 				vec3 colorProduct;
-				uint lightType = getLightType(lightSettings);
 				if(lightType == 1) {
 
 					// directional light
@@ -1072,7 +1123,8 @@ void main()
 
 				lightDataPtr += getLightDataSize();
 				lightData = LightRef(lightDataPtr);
-				lightSettings = lightData.settings;
+				lightIndex++;
+				lightType = getLightType(lightIndex, lightData);
 
 			}
 
@@ -1090,7 +1142,7 @@ void main()
 #endif
 
 			// sample texture
-			vec3 emission = texture(textureList[getTextureIdAndUpdatePtr(textureParamsPtr)], uv).rgb;
+			vec3 emission = sampleTexture(textureIndex, textureParamsPtr, uv).rgb;
 
 			// multiply by strength
 			if(getTextureUseStrength(textureIndex))
@@ -1116,9 +1168,9 @@ void main()
 	// write id-buffer
 #ifdef ID_BUFFER
 	outId[0] = stateSetID;
-	outId[1] = inId[0];  // gl_DrawID - index of indirect drawing structure
+	outId[1] = inId[0];  // drawIndexOffset + gl_DrawID - index of Drawable inside StateSet
 	outId[2] = inId[1];  // gl_InstanceIndex
-	outId[3] = gl_PrimitiveID;
+	outId[3] = gl_PrimitiveID;  // index of primitive inside the draw
 #endif
 
 
@@ -14,6 +14,7 @@ SceneDataRef {
 	float p11,p22,p33,p43;  // alternative specification of projectionMatrix - only members that depend on zNear
 	                        // and zFar clipping planes; remaining members are passed in as specialization constants
 	vec3 ambientLight;      // scene ambient light
+	layout(offset=160) uint64_t textureAtlasDataPtr;  // pointer to TextureAtlasDataRef or zero if no textures are packed in atlases
 	layout(offset=192) uint lightData[];  // array of OpenGLLight and GltfLight structures is stored here
 };
 uint getLightDataOffset()  { return 192; }
@@ -39,19 +40,116 @@ pushConstants {
 #endif
 	layout(offset=64) uint textureSetup[10];  // each uint holds texCoordIndex, type and settings of a texture
 	layout(offset=104) uint64_t lightSetup;  // 1 byte for each light; it holds lightType
+	layout(offset=112) uint drawIndexOffset;  // index of the first Drawable of the current draw command inside the StateSet; gl_DrawID restarts from zero in each draw command, so the Drawable index is drawIndexOffset+gl_DrawID; it is non-zero only for indexed draws split into several draw commands (see CadR::StateSet::indexType)
 };
 
+// specialization constants
+//
+// Constants 0..5 hold the projection (see UberShader.geom and UberShaderPoints.vert).
+// Constants 6..28 hold the parts of ShaderState that are baked into the pipeline according to
+// ShaderState::optimizeFlags. The getters bellow return the specialized value when the corresponding
+// optimize flag is set and push constant value otherwise. As the flags are known
+// during the pipeline creation, the shader compiler removes the unused code paths.
+layout(constant_id = 6) const uint optimizeFlags = 0;  // ShaderState::optimizeFlags
+layout(constant_id = 7) const uint specAttribAccessInfo0 = 0;
+layout(constant_id = 8) const uint specAttribAccessInfo1 = 0;
+layout(constant_id = 9) const uint specAttribAccessInfo2 = 0;
+layout(constant_id = 10) const uint specAttribAccessInfo3 = 0;
+layout(constant_id = 11) const uint specAttribAccessInfo4 = 0;
+layout(constant_id = 12) const uint specAttribAccessInfo5 = 0;
+layout(constant_id = 13) const uint specAttribAccessInfo6 = 0;
+layout(constant_id = 14) const uint specAttribAccessInfo7 = 0;
+layout(constant_id = 15) const uint specAttribSetup = 0;
+layout(constant_id = 16) const uint specMaterialSetup = 0;
+layout(constant_id = 17) const uint specTextureSetup0 = 0;
+layout(constant_id = 18) const uint specTextureSetup1 = 0;
+layout(constant_id = 19) const uint specTextureSetup2 = 0;
+layout(constant_id = 20) const uint specTextureSetup3 = 0;
+layout(constant_id = 21) const uint specTextureSetup4 = 0;
+layout(constant_id = 22) const uint specTextureSetup5 = 0;
+layout(constant_id = 23) const uint specTextureSetup6 = 0;
+layout(constant_id = 24) const uint specTextureSetup7 = 0;
+layout(constant_id = 25) const uint specTextureSetup8 = 0;
+layout(constant_id = 26) const uint specTextureSetup9 = 0;
+layout(constant_id = 27) const uint specLightSetup0 = 0;  // light types of lights 0..3
+layout(constant_id = 28) const uint specLightSetup1 = 0;  // light types of lights 4..7
+uint getSpecAttribAccessInfo(uint index)
+{
+	switch(index) {
+	case 0: return specAttribAccessInfo0;
+	case 1: return specAttribAccessInfo1;
+	case 2: return specAttribAccessInfo2;
+	case 3: return specAttribAccessInfo3;
+	case 4: return specAttribAccessInfo4;
+	case 5: return specAttribAccessInfo5;
+	case 6: return specAttribAccessInfo6;
+	default: return specAttribAccessInfo7;
+	}
+}
+uint getSpecTextureSetup(uint textureIndex)
+{
+	switch(textureIndex) {
+	case 0: return specTextureSetup0;
+	case 1: return specTextureSetup1;
+	case 2: return specTextureSetup2;
+	case 3: return specTextureSetup3;
+	case 4: return specTextureSetup4;
+	case 5: return specTextureSetup5;
+	case 6: return specTextureSetup6;
+	case 7: return specTextureSetup7;
+	case 8: return specTextureSetup8;
+	default: return specTextureSetup9;
+	}
+}
+
+// optimizeFlags bits; the values match ShaderState::Optimize* constants
+bool getOptimizeAttribs()  { return (optimizeFlags & 0x01) != 0; }
+bool getOptimizeMaterialModel()  { return (optimizeFlags & 0x02) != 0; }
+bool getOptimizeMaterialColorAttribute()  { return (optimizeFlags & 0x04) != 0; }
+bool getOptimizeMaterialAlpha()  { return (optimizeFlags & 0x08) != 0; }
+bool getOptimizeTextureTypesAndTexCoordIndices()  { return (optimizeFlags & 0x10) != 0; }
+bool getOptimizeTextureFlags()  { return (optimizeFlags & 0x20) != 0; }
+bool getOptimizeLightTypes()  { return (optimizeFlags & 0x40) != 0; }
+
+// materialSetup and textureSetup bits covered by particular optimize flags
+const uint materialModelBits = 0x000103ff;  // material model, texturing params offset, two sided lighting, disable lighting and Phong emission style
+const uint materialColorAttributeBits = 0x0000c000;
+const uint materialAlphaBits = 0x00003c00;
+const uint textureTypesAndTexCoordIndicesBits = 0x0000ffff;
+const uint textureFlagsBits = 0xffff0000;
+
+uint getAttribAccessInfoList(uint index)  { return getOptimizeAttribs() ? getSpecAttribAccessInfo(index) : attribAccessInfoList[index]; }
+uint getAttribSetup()  { return getOptimizeAttribs() ? specAttribSetup : attribSetup; }
+uint getMaterialSetup()
+{
+	uint specializedBits =
+		(getOptimizeMaterialModel() ? materialModelBits : 0) |
+		(getOptimizeMaterialColorAttribute() ? materialColorAttributeBits : 0) |
+		(getOptimizeMaterialAlpha() ? materialAlphaBits : 0);
+	return (specMaterialSetup & specializedBits) | (materialSetup & ~specializedBits);
+}
+uint getTextureSetup(uint textureIndex)
+{
+	uint specializedBits =
+		(getOptimizeTextureTypesAndTexCoordIndices() ? textureTypesAndTexCoordIndicesBits : 0) |
+		(getOptimizeTextureFlags() ? textureFlagsBits : 0);
+	return (getSpecTextureSetup(textureIndex) & specializedBits) | (textureSetup[textureIndex] & ~specializedBits);
+}
+
 // pushConstants.attribAccessInfoList
-uint getPositionAccessInfo()  { return attribAccessInfoList[0] & 0xffff; }
-uint getNormalAccessInfo()  { return attribAccessInfoList[0] >> 16; }
-uint getTangentAccessInfo()  { return attribAccessInfoList[1] & 0xffff; }
-uint getColorAccessInfo()  { return attribAccessInfoList[1] >> 16; }
-uint getTexCoordAccessInfo(uint attribIndex) { uint texCoordAccessInfo = attribAccessInfoList[attribIndex>>1]; if((attribIndex & 0x1) == 0) texCoordAccessInfo &= 0x0000ffff; else texCoordAccessInfo >>= 16; return texCoordAccessInfo; }
+uint getPositionAccessInfo()  { return getAttribAccessInfoList(0) & 0xffff; }
+uint getNormalAccessInfo()  { return getAttribAccessInfoList(0) >> 16; }
+uint getTangentAccessInfo()  { return getAttribAccessInfoList(1) & 0xffff; }
+uint getColorAccessInfo()  { return getAttribAccessInfoList(1) >> 16; }
+uint getTexCoordAccessInfo(uint attribIndex) { uint texCoordAccessInfo = getAttribAccessInfoList(attribIndex>>1); if((attribIndex & 0x1) == 0) texCoordAccessInfo &= 0x0000ffff; else texCoordAccessInfo >>= 16; return texCoordAccessInfo; }
 
 // pushConstants.attribSetup
+// bit 0: generate flat normals
+// bit 1: 16-bit indices; if not set, 32-bit indices are used
 // bit 2..8: vertex data size (0, 4, 8,..., 508)
-uint getVertexDataSize()  { return attribSetup & 0x01fc; }
-bool getGenerateFlatNormals()  { return (attribSetup & 0x0001) != 0; }
+uint getVertexDataSize()  { return getAttribSetup() & 0x01fc; }
+bool getGenerateFlatNormals()  { return (getAttribSetup() & 0x0001) != 0; }
+bool getUse16BitIndices()  { return (getAttribSetup() & 0x0002) != 0; }
 
 // pushConstants.materialSetup
 // bits 0..1: material model; 0 - unlit, 1 - phong, 2 - metallicRoughness
@@ -101,19 +199,19 @@ bool getGenerateFlatNormals()  { return (attribSetup & 0x0001) != 0; }
 //                        Material emission color is not involved in any color calculations
 //                        except that it is multiplied by emissive texture, if used, and added
 //                        to the final fragment shader output.
-uint getMaterialModel()  { return materialSetup & 0x03; }
-uint getMaterialTexturingParamsOffset()  { return materialSetup & 0xfc; }
-bool getMaterialTwoSidedLighting()  { return (materialSetup & 0x0100) != 0; }
-bool getMaterialDisableLighting()  { return (materialSetup & 0x0200) != 0; }
-bool getMaterialAlphaTest()  { return (materialSetup & 0x0400) != 0; }
-bool getMaterialIgnoreColorAttributeAlpha()  { return (materialSetup & 0x0800) != 0; }
-bool getMaterialIgnoreMaterialAlpha()  { return (materialSetup & 0x1000) != 0; }
-bool getMaterialIgnoreBaseTextureAlpha()  { return (materialSetup & 0x2000) != 0; }
-bool getUnlitMaterialMultiplyColorAttributeWithMaterial()  { return (materialSetup & 0x8000) != 0; }
-bool getPhongMaterialApplyColorAttributeOnDiffuseOnly()  { return (materialSetup & 0x4000) != 0; }
-bool getPhongMaterialMultiplyColorAttributeWithMaterial()  { return (materialSetup & 0x8000) != 0; }
-bool getPhongMaterialOpenGLStyleEmission()  { return (materialSetup & 0x10000) == 0; }
-bool getPhongMaterialSeparateEmission()  { return (materialSetup & 0x10000) != 0; }
+uint getMaterialModel()  { return getMaterialSetup() & 0x03; }
+uint getMaterialTexturingParamsOffset()  { return getMaterialSetup() & 0xfc; }
+bool getMaterialTwoSidedLighting()  { return (getMaterialSetup() & 0x0100) != 0; }
+bool getMaterialDisableLighting()  { return (getMaterialSetup() & 0x0200) != 0; }
+bool getMaterialAlphaTest()  { return (getMaterialSetup() & 0x0400) != 0; }
+bool getMaterialIgnoreColorAttributeAlpha()  { return (getMaterialSetup() & 0x0800) != 0; }
+bool getMaterialIgnoreMaterialAlpha()  { return (getMaterialSetup() & 0x1000) != 0; }
+bool getMaterialIgnoreBaseTextureAlpha()  { return (getMaterialSetup() & 0x2000) != 0; }
+bool getUnlitMaterialMultiplyColorAttributeWithMaterial()  { return (getMaterialSetup() & 0x8000) != 0; }
+bool getPhongMaterialApplyColorAttributeOnDiffuseOnly()  { return (getMaterialSetup() & 0x4000) != 0; }
+bool getPhongMaterialMultiplyColorAttributeWithMaterial()  { return (getMaterialSetup() & 0x8000) != 0; }
+bool getPhongMaterialOpenGLStyleEmission()  { return (getMaterialSetup() & 0x10000) == 0; }
+bool getPhongMaterialSeparateEmission()  { return (getMaterialSetup() & 0x10000) != 0; }
 
 // pushConstants.textureSetup[10];
 // texCoordIndex - bits 0..7
@@ -131,11 +229,13 @@ bool getPhongMaterialSeparateEmission()  { return (materialSetup & 0x10000) != 0
 //                 0 - modulate, 1 - replace, 2 - decal, 3 - blend, 4 - add;
 //                 note: when blend texture environment is used (e.g. bits 18..20 are set to 3),
 //                       blendColor is included in textureInfo and occupies extra 12 bytes
-uint getTextureCoordinateIndex(uint textureIndex)  { return textureSetup[textureIndex] & 0x00ff; }
-uint getTextureTypeShL8(uint textureIndex)  { return textureSetup[textureIndex] & 0xff00; }
-bool getTextureUseCoordinateTranform(uint textureIndex)  { return (textureSetup[textureIndex] & 0x10000) != 0; }
-bool getTextureUseStrength(uint textureIndex)  { return (textureSetup[textureIndex] & 0x20000) != 0; }
-uint getTextureEnvironment(uint textureIndex)  { return (textureSetup[textureIndex] >> 18) & 0x7; }
+//   bit 21 - texture is packed in texture atlas; textureID indexes TextureAtlasDataRef
+uint getTextureCoordinateIndex(uint textureIndex)  { return getTextureSetup(textureIndex) & 0x00ff; }
+uint getTextureTypeShL8(uint textureIndex)  { return getTextureSetup(textureIndex) & 0xff00; }
+bool getTextureUseCoordinateTranform(uint textureIndex)  { return (getTextureSetup(textureIndex) & 0x10000) != 0; }
+bool getTextureUseStrength(uint textureIndex)  { return (getTextureSetup(textureIndex) & 0x20000) != 0; }
+uint getTextureEnvironment(uint textureIndex)  { return (getTextureSetup(textureIndex) >> 18) & 0x7; }
+bool getTexturePackedInAtlas(uint textureIndex)  { return (getTextureSetup(textureIndex) & 0x200000) != 0; }
 
 
 
@@ -205,7 +305,8 @@ MetallicRoughnessMaterialRef {
 // The data items are sorted in the order as they are needed in the shader.
 //
 // optional: float rs1,rs2,rs3,rs4,t1,t2;  // rotation and scale in 2x2 matrix (rs1..rs4), translation in vec2 (t1,t2)
-// uint textureID;  // index of the texture in the descriptor array
+// uint textureID;  // index of the texture in the descriptor array,
+//                 // or index into TextureAtlasDataRef if the texture is packed in texture atlas
 // optional: float strength;  // strength of the effect (of occlusion or emissive texture,...),
 //                            // or scale (of normals in normal texture)
 // optional: vec3 blendColor;  // blend color used in blend texture environment
@@ -217,6 +318,22 @@ uint getTextureIdAndUpdatePtr(inout uint64_t ptr)  { uint r=AlignedUIntRef(ptr).
 float getTextureStrengthAndUpdatePtr(inout uint64_t ptr)  { float r=AlignedFloatRef(ptr).value; ptr+=4; return r; }
 vec3 getTextureBlendColorAndUpdatePtr(inout uint64_t ptr)  { vec3 r=UnalignedVec3Ref(ptr).value; ptr+=12; return r; }
 
+// Texture atlas data
+//
+// Textures packed into atlases (see CadR::ImageStorage::allocPacked()) are described
+// by TextureAtlasDataRef array indexed by textureID. Each item holds scale (xy) and offset (zw)
+// that maps texture coordinates from 0..1 range into the texture region inside the atlas
+// and the index of the atlas texture in the descriptor array.
+// Textures packed in atlas are marked by bit 21 of textureSetup.
+struct TextureAtlasEntry {
+	vec4 scaleAndOffset;
+	uint descriptorIndex;
+};
+layout(buffer_reference, std430, buffer_reference_align=16) restrict readonly buffer
+TextureAtlasDataRef {
+	TextureAtlasEntry entryList[];
+};
+
 layout(buffer_reference, std430, buffer_reference_align=4) restrict readonly buffer
 TextureTransformDataRef {
 	vec4 rotationAndScale;
@@ -371,6 +488,15 @@ uint getLightDataSize()  { return 128; }
 // bits 0..1: 1 - directional light, 2 - point light, 3 - spotlight
 uint getLightType(uint lightSettings)  { return lightSettings & 0x3; }
 
+// light type of lightIndex-th light; it is taken from the specialization constants
+// for the first eight lights when light types are optimized, or from lightData.settings otherwise
+uint getLightType(uint lightIndex, LightRef lightData)
+{
+	if(getOptimizeLightTypes() && lightIndex < 8)
+		return ((lightIndex < 4) ? specLightSetup0 >> (lightIndex*8) : specLightSetup1 >> ((lightIndex-4)*8)) & 0xff;
+	return getLightType(lightData.settings);
+}
+
 
 
 //
@@ -386,10 +512,13 @@ MatrixListRef {
 };
 
 // indices
+// (see readIndex() for reading of 16-bit and 32-bit indices;
+// zero indexDataPtr means indexed draw, so vertexIndex is already the index fetched from the index buffer)
 layout(buffer_reference, std430, buffer_reference_align=4) restrict readonly buffer
 IndexDataRef {
 	uint indices[];
 };
+uint readIndex(uint64_t indexDataPtr, uint vertexIndex)  { return (indexDataPtr != 0) ? readIndex(indexDataPtr, vertexIndex, getUse16BitIndices()) : vertexIndex; }
 
 // drawable data pointers
 layout(buffer_reference, std430, buffer_reference_align=8) restrict readonly buffer
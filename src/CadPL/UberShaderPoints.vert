@@ -35,16 +35,15 @@ layout(constant_id = 5) const float p44 = 1.;
 void main()
 {
 	// DrawablePointers
-	DrawablePointersRef dp = DrawablePointersRef(drawablePointersBufferPtr + (gl_DrawID * DrawablePointersSize));
+	DrawablePointersRef dp = DrawablePointersRef(drawablePointersBufferPtr + ((drawIndexOffset + gl_DrawID) * DrawablePointersSize));
 	outDrawableDataPtr = dp.drawableDataPtr;
 
 	// model matrix list
 	MatrixListRef modelMatrixList = MatrixListRef(dp.matrixListPtr);
 
 	// vertex data
-	IndexDataRef indexData = IndexDataRef(dp.indexDataPtr);
 	uint vertexDataSize = getVertexDataSize();
-	uint index = indexData.indices[gl_VertexIndex];
+	uint index = readIndex(dp.indexDataPtr, gl_VertexIndex);
 	uint64_t vertexDataPtr = dp.vertexDataPtr + (index * vertexDataSize);
 	outVertexDataPtr = vertexDataPtr;
 
@@ -89,7 +88,7 @@ void main()
 		outVertexTangent = vec3(1,0,0);
 
 #ifdef ID_BUFFER
-	outId.x = gl_DrawID;
+	outId.x = drawIndexOffset + gl_DrawID;
 	outId.y = gl_InstanceIndex;
 #endif
 
@@ -99,6 +99,22 @@ AlignedIntRef {
 
 
 
+//
+//  read index
+//
+uint readIndex(uint64_t indexDataPtr, uint vertexIndex, bool use16BitIndices)
+{
+	// 16-bit indices are read by 32-bit words holding two indices,
+	// so index data must be padded to the multiple of four bytes
+	if(use16BitIndices) {
+		uint v = AlignedUIntRef(indexDataPtr + (uint64_t(vertexIndex >> 1) << 2)).value;
+		return ((vertexIndex & 0x1) == 0) ? v & 0xffff : v >> 16;
+	}
+	return AlignedUIntRef(indexDataPtr + (uint64_t(vertexIndex) << 2)).value;
+}
+
+
+
 //
 //  read float
 //
@@ -622,6 +638,7 @@ vec3 readVec3(uint attribAccessInfo, uint64_t vertexDataPtr)
 	//   - 0x41 - byte3, alignment 4, on 4 bytes extracts first three bytes, reads the values with additional offset +2
 	//   - 0x42 - byte3, alignment 4, on 4 bytes extracts last three bytes, reads the values with additional offset +2, normalize
 	//   - 0x43 - byte3, alignment 4, on 4 bytes extracts last three bytes, reads the values with additional offset +2
+	//   - 0x44 - octahedral encoded unit vector in short2, alignment 4, returns normalized vector
 
 	uint offset = attribAccessInfo & 0x00ff;  // max offset is 255
 	uint64_t addr = vertexDataPtr + offset;
@@ -833,6 +850,20 @@ vec3 readVec3(uint attribAccessInfo, uint64_t vertexDataPtr)
 		return vec3(r);
 	}
 
+	// octahedral encoding
+	// (used for compact normals and tangents; the vector is folded onto octahedron
+	// and its xy coordinates are stored as two normalized shorts)
+	if(type == 0x4400) {
+		// alignment 4
+		uint v = AlignedUIntRef(addr).value;
+		vec2 e = unpackSnorm2x16(v);
+		vec3 r = vec3(e, 1. - abs(e.x) - abs(e.y));
+		float t = max(-r.z, 0.);
+		r.x += (r.x >= 0.) ? -t : t;
+		r.y += (r.y >= 0.) ? -t : t;
+		return normalize(r);
+	}
+
 	// return NaN
 	return vec3(0/0);
 }
@@ -0,0 +1,938 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include <CadR/BcEncoder.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "CpuFeatures.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define CADR_BCENCODER_SSE2
+# if defined(CADR_SIMD_DISPATCH)
+#  include <immintrin.h>
+#  define CADR_BCENCODER_AVX2_AND_SSE41
+# endif
+#endif
+
+using namespace std;
+using namespace CadR;
+
+
+namespace {
+
+/// Block of 16 pixels in structure-of-arrays layout.
+/// Each channel holds 16 values in the range 0..255.
+struct alignas(32) Block {
+	float c[4][16];
+};
+
+
+#if defined(CADR_BCENCODER_AVX2_AND_SSE41)
+
+/** AVX2 version of findIndices(). All 16 pixels are processed at once in two registers. */
+CADR_TARGET_AVX2 static float findIndicesAvx2(const Block& b, unsigned numChannels, const float* palette,
+                                              unsigned numEntries, uint8_t indices[16])
+{
+	__m256 bestError0 = _mm256_set1_ps(INFINITY);
+	__m256 bestError1 = _mm256_set1_ps(INFINITY);
+	__m256 bestIndex0 = _mm256_setzero_ps();
+	__m256 bestIndex1 = _mm256_setzero_ps();
+	for(unsigned e=0; e<numEntries; e++) {
+		__m256 p = _mm256_set1_ps(palette[e*4+0]);
+		__m256 d0 = _mm256_sub_ps(_mm256_load_ps(&b.c[0][0]), p);
+		__m256 d1 = _mm256_sub_ps(_mm256_load_ps(&b.c[0][8]), p);
+		__m256 error0 = _mm256_mul_ps(d0, d0);
+		__m256 error1 = _mm256_mul_ps(d1, d1);
+		for(unsigned ch=1; ch<numChannels; ch++) {
+			p = _mm256_set1_ps(palette[e*4+ch]);
+			d0 = _mm256_sub_ps(_mm256_load_ps(&b.c[ch][0]), p);
+			d1 = _mm256_sub_ps(_mm256_load_ps(&b.c[ch][8]), p);
+			error0 = _mm256_add_ps(error0, _mm256_mul_ps(d0, d0));
+			error1 = _mm256_add_ps(error1, _mm256_mul_ps(d1, d1));
+		}
+		__m256 index = _mm256_set1_ps(float(e));
+		__m256 mask0 = _mm256_cmp_ps(error0, bestError0, _CMP_LT_OQ);
+		__m256 mask1 = _mm256_cmp_ps(error1, bestError1, _CMP_LT_OQ);
+		bestError0 = _mm256_min_ps(error0, bestError0);
+		bestError1 = _mm256_min_ps(error1, bestError1);
+		bestIndex0 = _mm256_blendv_ps(bestIndex0, index, mask0);
+		bestIndex1 = _mm256_blendv_ps(bestIndex1, index, mask1);
+	}
+	alignas(32) int32_t tmp[16];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(tmp), _mm256_cvtps_epi32(bestIndex0));
+	_mm256_store_si256(reinterpret_cast<__m256i*>(tmp+8), _mm256_cvtps_epi32(bestIndex1));
+	for(unsigned j=0; j<16; j++)
+		indices[j] = uint8_t(tmp[j]);
+	alignas(32) float errors[16];
+	_mm256_store_ps(errors, bestError0);
+	_mm256_store_ps(errors+8, bestError1);
+	float totalError = 0.f;
+	for(unsigned j=0; j<16; j++)
+		totalError += errors[j];
+	return totalError;
+}
+
+
+/** SSE4.1 version of findIndices(). */
+CADR_TARGET_SSE41 static float findIndicesSse41(const Block& b, unsigned numChannels, const float* palette,
+                                                unsigned numEntries, uint8_t indices[16])
+{
+	__m128 totalError = _mm_setzero_ps();
+	for(unsigned i=0; i<16; i+=4) {
+		__m128 bestError = _mm_set1_ps(INFINITY);
+		__m128 bestIndex = _mm_setzero_ps();
+		for(unsigned e=0; e<numEntries; e++) {
+			__m128 d = _mm_sub_ps(_mm_load_ps(&b.c[0][i]), _mm_set1_ps(palette[e*4+0]));
+			__m128 error = _mm_mul_ps(d, d);
+			for(unsigned ch=1; ch<numChannels; ch++) {
+				d = _mm_sub_ps(_mm_load_ps(&b.c[ch][i]), _mm_set1_ps(palette[e*4+ch]));
+				error = _mm_add_ps(error, _mm_mul_ps(d, d));
+			}
+			__m128 mask = _mm_cmplt_ps(error, bestError);
+			bestError = _mm_min_ps(error, bestError);
+			bestIndex = _mm_blendv_ps(bestIndex, _mm_set1_ps(float(e)), mask);
+		}
+		totalError = _mm_add_ps(totalError, bestError);
+		alignas(16) int32_t tmp[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(tmp), _mm_cvtps_epi32(bestIndex));
+		for(unsigned j=0; j<4; j++)
+			indices[i+j] = uint8_t(tmp[j]);
+	}
+	alignas(16) float tmp[4];
+	_mm_store_ps(tmp, totalError);
+	return tmp[0] + tmp[1] + tmp[2] + tmp[3];
+}
+
+#endif
+#if defined(CADR_BCENCODER_SSE2)
+
+/** SSE2 version of findIndices(). */
+static float findIndicesSse2(const Block& b, unsigned numChannels, const float* palette,
+                             unsigned numEntries, uint8_t indices[16])
+{
+	__m128 totalError = _mm_setzero_ps();
+	for(unsigned i=0; i<16; i+=4) {
+		__m128 bestError = _mm_set1_ps(INFINITY);
+		__m128 bestIndex = _mm_setzero_ps();
+		for(unsigned e=0; e<numEntries; e++) {
+			__m128 d = _mm_sub_ps(_mm_load_ps(&b.c[0][i]), _mm_set1_ps(palette[e*4+0]));
+			__m128 error = _mm_mul_ps(d, d);
+			for(unsigned ch=1; ch<numChannels; ch++) {
+				d = _mm_sub_ps(_mm_load_ps(&b.c[ch][i]), _mm_set1_ps(palette[e*4+ch]));
+				error = _mm_add_ps(error, _mm_mul_ps(d, d));
+			}
+			// select the entry where the error is lower (and/andnot/or as SSE2 lacks blend instruction)
+			__m128 mask = _mm_cmplt_ps(error, bestError);
+			bestError = _mm_min_ps(error, bestError);
+			bestIndex = _mm_or_ps(_mm_and_ps(mask, _mm_set1_ps(float(e))), _mm_andnot_ps(mask, bestIndex));
+		}
+		totalError = _mm_add_ps(totalError, bestError);
+		alignas(16) int32_t tmp[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(tmp), _mm_cvtps_epi32(bestIndex));
+		for(unsigned j=0; j<4; j++)
+			indices[i+j] = uint8_t(tmp[j]);
+	}
+	alignas(16) float tmp[4];
+	_mm_store_ps(tmp, totalError);
+	return tmp[0] + tmp[1] + tmp[2] + tmp[3];
+}
+
+#endif
+
+
+/** Finds the nearest palette entry for each of 16 pixels.
+ *  The palette contains numEntries colors of numChannels channels each, stored as palette[entry*4+channel].
+ *  Returns the sum of squared errors of the block.
+ *  AVX2 or SSE4.1 kernel is used if the CPU supports it, SSE2 kernel on other x86 and x86-64 CPUs. */
+static float findIndices(const Block& b, unsigned numChannels, const float* palette, unsigned numEntries,
+                         uint8_t indices[16])
+{
+#if defined(CADR_BCENCODER_AVX2_AND_SSE41)
+	if(CpuFeatures::hasAvx2())
+		return findIndicesAvx2(b, numChannels, palette, numEntries, indices);
+	if(CpuFeatures::hasSse41())
+		return findIndicesSse41(b, numChannels, palette, numEntries, indices);
+#endif
+#if defined(CADR_BCENCODER_SSE2)
+
+	return findIndicesSse2(b, numChannels, palette, numEntries, indices);
+
+#else
+
+	float totalError = 0.f;
+	for(unsigned i=0; i<16; i++) {
+		float bestError = INFINITY;
+		unsigned bestIndex = 0;
+		for(unsigned e=0; e<numEntries; e++) {
+			float error = 0.f;
+			for(unsigned ch=0; ch<numChannels; ch++) {
+				float d = b.c[ch][i] - palette[e*4+ch];
+				error += d * d;
+			}
+			if(error < bestError) {
+				bestError = error;
+				bestIndex = e;
+			}
+		}
+		indices[i] = uint8_t(bestIndex);
+		totalError += bestError;
+	}
+	return totalError;
+
+#endif
+}
+
+
+/** Computes the endpoints of the line approximating the block colors
+ *  using the principal axis of the color distribution.
+ *  The endpoints are placed at the extreme projections of the pixels on the axis. */
+static void computePrincipalEndpoints(const Block& b, unsigned numChannels, float e0[4], float e1[4])
+{
+	// mean
+	float mean[4] = { 0.f, 0.f, 0.f, 0.f };
+	for(unsigned ch=0; ch<numChannels; ch++) {
+		for(unsigned i=0; i<16; i++)
+			mean[ch] += b.c[ch][i];
+		mean[ch] *= 1.f/16.f;
+	}
+
+	// covariance matrix
+	float cov[4][4] = {};
+	for(unsigned i=0; i<16; i++) {
+		float d[4];
+		for(unsigned ch=0; ch<numChannels; ch++)
+			d[ch] = b.c[ch][i] - mean[ch];
+		for(unsigned r=0; r<numChannels; r++)
+			for(unsigned c=r; c<numChannels; c++)
+				cov[r][c] += d[r] * d[c];
+	}
+	for(unsigned r=0; r<numChannels; r++)
+		for(unsigned c=0; c<r; c++)
+			cov[r][c] = cov[c][r];
+
+	// principal axis by power iteration,
+	// starting with the diagonal of the bounding box
+	float axis[4] = { 0.f, 0.f, 0.f, 0.f };
+	for(unsigned ch=0; ch<numChannels; ch++) {
+		float mn = b.c[ch][0];
+		float mx = b.c[ch][0];
+		for(unsigned i=1; i<16; i++) {
+			mn = min(mn, b.c[ch][i]);
+			mx = max(mx, b.c[ch][i]);
+		}
+		axis[ch] = mx - mn;
+	}
+	for(unsigned iteration=0; iteration<4; iteration++) {
+		float v[4] = { 0.f, 0.f, 0.f, 0.f };
+		for(unsigned r=0; r<numChannels; r++)
+			for(unsigned c=0; c<numChannels; c++)
+				v[r] += cov[r][c] * axis[c];
+		float m = max(max(fabs(v[0]), fabs(v[1])), max(fabs(v[2]), fabs(v[3])));
+		if(m < 1e-6f)
+			break;
+		for(unsigned ch=0; ch<numChannels; ch++)
+			axis[ch] = v[ch] / m;
+	}
+	float axisLength2 = 0.f;
+	for(unsigned ch=0; ch<numChannels; ch++)
+		axisLength2 += axis[ch] * axis[ch];
+
+	// degenerated case - all pixels are of the same color
+	if(axisLength2 < 1e-12f) {
+		for(unsigned ch=0; ch<numChannels; ch++)
+			e0[ch] = e1[ch] = mean[ch];
+		return;
+	}
+
+	// extreme projections
+	float minT = INFINITY;
+	float maxT = -INFINITY;
+	for(unsigned i=0; i<16; i++) {
+		float t = 0.f;
+		for(unsigned ch=0; ch<numChannels; ch++)
+			t += (b.c[ch][i] - mean[ch]) * axis[ch];
+		minT = min(minT, t);
+		maxT = max(maxT, t);
+	}
+	minT /= axisLength2;
+	maxT /= axisLength2;
+	for(unsigned ch=0; ch<numChannels; ch++) {
+		e0[ch] = clamp(mean[ch] + axis[ch] * maxT, 0.f, 255.f);
+		e1[ch] = clamp(mean[ch] + axis[ch] * minT, 0.f, 255.f);
+	}
+}
+
+
+/** Computes endpoints minimizing the squared error for the given indices.
+ *  The weights give the fraction of e1 for each index.
+ *  Returns false if the system is singular, e.g. when all pixels use the same index. */
+static bool leastSquaresEndpoints(const Block& b, unsigned numChannels, const uint8_t indices[16],
+                                  const float* weights, float e0[4], float e1[4])
+{
+	float aa = 0.f, bb = 0.f, ab = 0.f;
+	float ax[4] = { 0.f, 0.f, 0.f, 0.f };
+	float bx[4] = { 0.f, 0.f, 0.f, 0.f };
+	for(unsigned i=0; i<16; i++) {
+		float beta = weights[indices[i]];
+		float alpha = 1.f - beta;
+		aa += alpha * alpha;
+		bb += beta * beta;
+		ab += alpha * beta;
+		for(unsigned ch=0; ch<numChannels; ch++) {
+			ax[ch] += alpha * b.c[ch][i];
+			bx[ch] += beta * b.c[ch][i];
+		}
+	}
+	float det = aa * bb - ab * ab;
+	if(fabs(det) < 1e-6f)
+		return false;
+	float f = 1.f / det;
+	for(unsigned ch=0; ch<numChannels; ch++) {
+		e0[ch] = clamp((bb * ax[ch] - ab * bx[ch]) * f, 0.f, 255.f);
+		e1[ch] = clamp((aa * bx[ch] - ab * ax[ch]) * f, 0.f, 255.f);
+	}
+	return true;
+}
+
+
+// BC1 color block
+static inline uint16_t packRgb565(const float c[4])
+{
+	unsigned r = unsigned(c[0] * (31.f/255.f) + 0.5f);
+	unsigned g = unsigned(c[1] * (63.f/255.f) + 0.5f);
+	unsigned b = unsigned(c[2] * (31.f/255.f) + 0.5f);
+	return uint16_t((r << 11) | (g << 5) | b);
+}
+static inline void unpackRgb565(uint16_t v, float c[4])
+{
+	unsigned r = (v >> 11) & 0x1f;
+	unsigned g = (v >> 5) & 0x3f;
+	unsigned b = v & 0x1f;
+	c[0] = float((r << 3) | (r >> 2));
+	c[1] = float((g << 2) | (g >> 4));
+	c[2] = float((b << 3) | (b >> 2));
+	c[3] = 255.f;
+}
+static void bc1Palette(uint16_t c0, uint16_t c1, float palette[4*4])
+{
+	unpackRgb565(c0, &palette[0]);
+	unpackRgb565(c1, &palette[4]);
+	for(unsigned ch=0; ch<4; ch++) {
+		palette[8+ch] = floor((2.f*palette[ch] + palette[4+ch]) / 3.f + 0.5f);
+		palette[12+ch] = floor((palette[ch] + 2.f*palette[4+ch]) / 3.f + 0.5f);
+	}
+}
+static float encodeBC1Endpoints(const Block& b, const float e0[4], const float e1[4],
+                                uint16_t& c0, uint16_t& c1, uint8_t indices[16])
+{
+	c0 = packRgb565(e0);
+	c1 = packRgb565(e1);
+	if(c0 < c1)
+		swap(c0, c1);
+	if(c0 == c1) {
+		// single color block
+		// (in 3-color mode, index 0 means c0)
+		float palette[4];
+		unpackRgb565(c0, palette);
+		memset(indices, 0, 16);
+		float error = 0.f;
+		for(unsigned i=0; i<16; i++)
+			for(unsigned ch=0; ch<3; ch++) {
+				float d = b.c[ch][i] - palette[ch];
+				error += d * d;
+			}
+		return error;
+	}
+	float palette[4*4];
+	bc1Palette(c0, c1, palette);
+	return findIndices(b, 3, palette, 4, indices);
+}
+static void encodeBC1(const Block& b, uint8_t* dst)
+{
+	// initial endpoints
+	float e0[4], e1[4];
+	computePrincipalEndpoints(b, 3, e0, e1);
+	uint16_t c0, c1;
+	uint8_t indices[16];
+	float error = encodeBC1Endpoints(b, e0, e1, c0, c1, indices);
+
+	// refine endpoints by least squares
+	static const float weights[4] = { 0.f, 1.f, 1.f/3.f, 2.f/3.f };
+	if(c0 != c1 && leastSquaresEndpoints(b, 3, indices, weights, e0, e1)) {
+		uint16_t refinedC0, refinedC1;
+		uint8_t refinedIndices[16];
+		float refinedError = encodeBC1Endpoints(b, e0, e1, refinedC0, refinedC1, refinedIndices);
+		if(refinedError < error) {
+			c0 = refinedC0;
+			c1 = refinedC1;
+			memcpy(indices, refinedIndices, 16);
+		}
+	}
+
+	// write block
+	uint32_t packedIndices = 0;
+	for(unsigned i=0; i<16; i++)
+		packedIndices |= uint32_t(indices[i]) << (i*2);
+	dst[0] = uint8_t(c0);
+	dst[1] = uint8_t(c0 >> 8);
+	dst[2] = uint8_t(c1);
+	dst[3] = uint8_t(c1 >> 8);
+	dst[4] = uint8_t(packedIndices);
+	dst[5] = uint8_t(packedIndices >> 8);
+	dst[6] = uint8_t(packedIndices >> 16);
+	dst[7] = uint8_t(packedIndices >> 24);
+}
+static void decodeBC1(const uint8_t* src, uint8_t rgba[16*4], bool alwaysFourColors)
+{
+	uint16_t c0 = uint16_t(src[0] | (src[1] << 8));
+	uint16_t c1 = uint16_t(src[2] | (src[3] << 8));
+	uint32_t packedIndices = src[4] | (src[5] << 8) | (src[6] << 16) | (uint32_t(src[7]) << 24);
+	float palette[4*4];
+	bc1Palette(c0, c1, palette);
+	if(c0 <= c1 && !alwaysFourColors)
+		for(unsigned ch=0; ch<4; ch++) {
+			palette[8+ch] = floor((palette[ch] + palette[4+ch]) / 2.f);
+			palette[12+ch] = 0.f;
+		}
+	for(unsigned i=0; i<16; i++) {
+		unsigned index = (packedIndices >> (i*2)) & 0x3;
+		for(unsigned ch=0; ch<4; ch++)
+			rgba[i*4+ch] = uint8_t(palette[index*4+ch]);
+	}
+}
+
+
+// BC4 single channel block
+static void encodeBC4(const Block& b, unsigned channel, uint8_t* dst)
+{
+	// endpoints
+	float mn = b.c[channel][0];
+	float mx = b.c[channel][0];
+	for(unsigned i=1; i<16; i++) {
+		mn = min(mn, b.c[channel][i]);
+		mx = max(mx, b.c[channel][i]);
+	}
+	unsigned r0 = unsigned(mx + 0.5f);
+	unsigned r1 = unsigned(mn + 0.5f);
+	dst[0] = uint8_t(r0);
+	dst[1] = uint8_t(r1);
+
+	// indices
+	// (index 0 is r0, index 1 is r1, indices 2..7 interpolate from r0 to r1)
+	uint8_t indices[16];
+	if(r0 == r1)
+		memset(indices, 0, 16);
+	else {
+		Block single;
+		memcpy(single.c[0], b.c[channel], sizeof(single.c[0]));
+		float palette[8*4];
+		palette[0] = float(r0);
+		palette[4] = float(r1);
+		for(unsigned k=2; k<8; k++)
+			palette[k*4] = float(((8-k)*r0 + (k-1)*r1) / 7);
+		findIndices(single, 1, palette, 8, indices);
+	}
+	uint64_t packedIndices = 0;
+	for(unsigned i=0; i<16; i++)
+		packedIndices |= uint64_t(indices[i]) << (i*3);
+	for(unsigned i=0; i<6; i++)
+		dst[2+i] = uint8_t(packedIndices >> (i*8));
+}
+static void decodeBC4(const uint8_t* src, uint8_t* dst, unsigned stride)
+{
+	unsigned r0 = src[0];
+	unsigned r1 = src[1];
+	unsigned palette[8] = { r0, r1 };
+	if(r0 > r1)
+		for(unsigned k=2; k<8; k++)
+			palette[k] = ((8-k)*r0 + (k-1)*r1) / 7;
+	else {
+		for(unsigned k=2; k<6; k++)
+			palette[k] = ((6-k)*r0 + (k-1)*r1) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+	uint64_t packedIndices = 0;
+	for(unsigned i=0; i<6; i++)
+		packedIndices |= uint64_t(src[2+i]) << (i*8);
+	for(unsigned i=0; i<16; i++)
+		dst[i*stride] = uint8_t(palette[(packedIndices >> (i*3)) & 0x7]);
+}
+
+
+// BC7 mode 6 block
+// (single subset, RGBA endpoints of 7 bits plus one p-bit per endpoint, 4-bit indices)
+static const unsigned bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BC7Endpoint {
+	uint8_t q[4];  ///< 7-bit quantized values
+	uint8_t p;  ///< p-bit
+	inline unsigned value(unsigned ch) const  { return (q[ch] << 1) | p; }
+};
+
+static BC7Endpoint quantizeBC7Endpoint(const float e[4])
+{
+	BC7Endpoint best;
+	float bestError = INFINITY;
+	for(uint8_t p=0; p<2; p++) {
+		BC7Endpoint ep;
+		ep.p = p;
+		float error = 0.f;
+		for(unsigned ch=0; ch<4; ch++) {
+			int q = int(floor((e[ch] - p) * 0.5f + 0.5f));
+			ep.q[ch] = uint8_t(clamp(q, 0, 127));
+			float d = float(ep.value(ch)) - e[ch];
+			error += d * d;
+		}
+		if(error < bestError) {
+			bestError = error;
+			best = ep;
+		}
+	}
+	return best;
+}
+static void bc7Palette(const BC7Endpoint& ep0, const BC7Endpoint& ep1, float palette[16*4])
+{
+	for(unsigned k=0; k<16; k++) {
+		unsigned w = bc7Weights4[k];
+		for(unsigned ch=0; ch<4; ch++)
+			palette[k*4+ch] = float(((64-w)*ep0.value(ch) + w*ep1.value(ch) + 32) >> 6);
+	}
+}
+static float encodeBC7Endpoints(const Block& b, const float e0[4], const float e1[4],
+                                BC7Endpoint& ep0, BC7Endpoint& ep1, uint8_t indices[16])
+{
+	ep0 = quantizeBC7Endpoint(e0);
+	ep1 = quantizeBC7Endpoint(e1);
+	float palette[16*4];
+	bc7Palette(ep0, ep1, palette);
+	return findIndices(b, 4, palette, 16, indices);
+}
+
+class BitWriter {
+	uint8_t* _dst;
+	unsigned _pos = 0;
+public:
+	BitWriter(uint8_t* dst, size_t numBytes) : _dst(dst)  { memset(dst, 0, numBytes); }
+	void write(unsigned value, unsigned numBits) {
+		for(unsigned i=0; i<numBits; i++, _pos++)
+			_dst[_pos >> 3] |= uint8_t(((value >> i) & 1) << (_pos & 7));
+	}
+};
+class BitReader {
+	const uint8_t* _src;
+	unsigned _pos = 0;
+public:
+	BitReader(const uint8_t* src) : _src(src)  {}
+	unsigned read(unsigned numBits) {
+		unsigned value = 0;
+		for(unsigned i=0; i<numBits; i++, _pos++)
+			value |= ((_src[_pos >> 3] >> (_pos & 7)) & 1) << i;
+		return value;
+	}
+};
+
+static void encodeBC7(const Block& b, uint8_t* dst)
+{
+	// initial endpoints
+	float e0[4], e1[4];
+	computePrincipalEndpoints(b, 4, e0, e1);
+	BC7Endpoint ep0, ep1;
+	uint8_t indices[16];
+	float error = encodeBC7Endpoints(b, e0, e1, ep0, ep1, indices);
+
+	// refine endpoints by least squares
+	static const float weights[16] = {
+		0.f/64.f, 4.f/64.f, 9.f/64.f, 13.f/64.f, 17.f/64.f, 21.f/64.f, 26.f/64.f, 30.f/64.f,
+		34.f/64.f, 38.f/64.f, 43.f/64.f, 47.f/64.f, 51.f/64.f, 55.f/64.f, 60.f/64.f, 64.f/64.f,
+	};
+	if(error > 0.f && leastSquaresEndpoints(b, 4, indices, weights, e0, e1)) {
+		BC7Endpoint refinedEp0, refinedEp1;
+		uint8_t refinedIndices[16];
+		float refinedError = encodeBC7Endpoints(b, e0, e1, refinedEp0, refinedEp1, refinedIndices);
+		if(refinedError < error) {
+			ep0 = refinedEp0;
+			ep1 = refinedEp1;
+			memcpy(indices, refinedIndices, 16);
+		}
+	}
+
+	// anchor index must have its highest bit zero
+	if(indices[0] & 0x8) {
+		swap(ep0, ep1);
+		for(unsigned i=0; i<16; i++)
+			indices[i] = uint8_t(15 - indices[i]);
+	}
+
+	// write block
+	BitWriter w(dst, 16);
+	w.write(1 << 6, 7);  // mode 6
+	for(unsigned ch=0; ch<4; ch++) {
+		w.write(ep0.q[ch], 7);
+		w.write(ep1.q[ch], 7);
+	}
+	w.write(ep0.p, 1);
+	w.write(ep1.p, 1);
+	w.write(indices[0], 3);
+	for(unsigned i=1; i<16; i++)
+		w.write(indices[i], 4);
+}
+static void decodeBC7(const uint8_t* src, uint8_t rgba[16*4])
+{
+	// only mode 6 is supported
+	if((src[0] & 0x7f) != 0x40) {
+		memset(rgba, 0, 16*4);
+		return;
+	}
+
+	BitReader r(src);
+	r.read(7);
+	BC7Endpoint ep0, ep1;
+	for(unsigned ch=0; ch<4; ch++) {
+		ep0.q[ch] = uint8_t(r.read(7));
+		ep1.q[ch] = uint8_t(r.read(7));
+	}
+	ep0.p = uint8_t(r.read(1));
+	ep1.p = uint8_t(r.read(1));
+	float palette[16*4];
+	bc7Palette(ep0, ep1, palette);
+	for(unsigned i=0; i<16; i++) {
+		unsigned index = r.read(i==0 ? 3 : 4);
+		for(unsigned ch=0; ch<4; ch++)
+			rgba[i*4+ch] = uint8_t(palette[index*4+ch]);
+	}
+}
+
+
+/// Loads 4x4 block of the image at the block coordinates bx and by.
+/// The components are placed in the same channels as in R8, R8G8, R8G8B8 and R8G8B8A8 formats.
+/// The pixels outside of the image are replaced by the nearest edge pixels.
+static void loadBlock(const uint8_t* pixels, uint32_t width, uint32_t height, unsigned numComponents,
+                      uint32_t bx, uint32_t by, uint8_t rgba[16*4])
+{
+	for(unsigned y=0; y<4; y++) {
+		uint32_t py = min(by*4+y, height-1);
+		for(unsigned x=0; x<4; x++) {
+			uint32_t px = min(bx*4+x, width-1);
+			const uint8_t* p = pixels + (size_t(py)*width + px) * numComponents;
+			uint8_t* d = &rgba[(y*4+x)*4];
+			switch(numComponents) {
+			case 1: d[0] = p[0]; d[1] = 0; d[2] = 0; d[3] = 255; break;
+			case 2: d[0] = p[0]; d[1] = p[1]; d[2] = 0; d[3] = 255; break;
+			case 3: d[0] = p[0]; d[1] = p[1]; d[2] = p[2]; d[3] = 255; break;
+			default: d[0] = p[0]; d[1] = p[1]; d[2] = p[2]; d[3] = p[3];
+			}
+		}
+	}
+}
+
+
+static void encodeBlockRows(BcEncoder::Format format, const uint8_t* pixels, uint32_t width, uint32_t height,
+                            unsigned numComponents, uint8_t* dst, uint32_t firstBlockRow, uint32_t numBlockRows)
+{
+	uint32_t numBlocksX = (width + 3) / 4;
+	size_t blockSize = BcEncoder::blockSize(format);
+	uint8_t* p = dst + size_t(firstBlockRow) * numBlocksX * blockSize;
+	uint8_t rgba[16*4];
+	for(uint32_t by=firstBlockRow, e=firstBlockRow+numBlockRows; by<e; by++)
+		for(uint32_t bx=0; bx<numBlocksX; bx++) {
+			loadBlock(pixels, width, height, numComponents, bx, by, rgba);
+			BcEncoder::encodeBlock(format, rgba, p);
+			p += blockSize;
+		}
+}
+
+}
+
+
+
+BcEncoder::BcEncoder(unsigned numThreads)
+{
+	if(numThreads == 0)
+		numThreads = max(thread::hardware_concurrency(), 1u);
+	_threadList.reserve(numThreads);
+	for(unsigned i=0; i<numThreads; i++)
+		_threadList.emplace_back(&BcEncoder::workerMain, this);
+}
+
+
+BcEncoder::~BcEncoder() noexcept
+{
+	{
+		lock_guard lock(_jobMutex);
+		_exitThreads = true;
+	}
+	_jobAvailableCondition.notify_all();
+	for(thread& t : _threadList)
+		t.join();
+}
+
+
+void BcEncoder::workerMain()
+{
+	unique_lock lock(_jobMutex);
+	while(true) {
+		_jobAvailableCondition.wait(lock, [this]{ return _exitThreads || !_jobQueue.empty(); });
+		if(_exitThreads)
+			return;
+		function<void()> job = move(_jobQueue.front());
+		_jobQueue.pop_front();
+		lock.unlock();
+		job();
+		lock.lock();
+	}
+}
+
+
+void BcEncoder::encode(Format format, const uint8_t* pixels, uint32_t width, uint32_t height,
+                       unsigned numComponents, void* dst)
+{
+	if(width == 0 || height == 0)
+		return;
+
+	// split the image into the jobs of block rows
+	uint32_t numBlockRows = (height + 3) / 4;
+	uint32_t rowsPerJob = max(numBlockRows / (numThreads() * 4), 1u);
+	uint32_t numJobs = (numBlockRows + rowsPerJob - 1) / rowsPerJob;
+	if(numJobs == 1) {
+		encodeBlockRows(format, pixels, width, height, numComponents, static_cast<uint8_t*>(dst), 0, numBlockRows);
+		return;
+	}
+
+	// submit jobs
+	size_t numUnfinishedJobs = numJobs;
+	{
+		lock_guard lock(_jobMutex);
+		for(uint32_t firstRow=0; firstRow<numBlockRows; firstRow+=rowsPerJob) {
+			uint32_t numRows = min(rowsPerJob, numBlockRows - firstRow);
+			_jobQueue.emplace_back(
+				[this, format, pixels, width, height, numComponents, dst, firstRow, numRows, &numUnfinishedJobs]() {
+					encodeBlockRows(format, pixels, width, height, numComponents, static_cast<uint8_t*>(dst),
+					                firstRow, numRows);
+					lock_guard lock(_jobMutex);
+					numUnfinishedJobs--;
+					if(numUnfinishedJobs == 0)
+						_jobFinishedCondition.notify_all();
+				}
+			);
+		}
+	}
+	_jobAvailableCondition.notify_all();
+
+	// help with the jobs and wait for their completion
+	unique_lock lock(_jobMutex);
+	while(numUnfinishedJobs != 0) {
+		if(!_jobQueue.empty()) {
+			function<void()> job = move(_jobQueue.front());
+			_jobQueue.pop_front();
+			lock.unlock();
+			job();
+			lock.lock();
+		}
+		else
+			_jobFinishedCondition.wait(lock);
+	}
+}
+
+
+void BcEncoder::encodeBlock(Format format, const uint8_t rgba[16*4], void* dst)
+{
+	// convert to structure-of-arrays
+	Block b;
+	for(unsigned i=0; i<16; i++)
+		for(unsigned ch=0; ch<4; ch++)
+			b.c[ch][i] = float(rgba[i*4+ch]);
+
+	uint8_t* d = static_cast<uint8_t*>(dst);
+	switch(format) {
+	case Format::BC1: encodeBC1(b, d); break;
+	case Format::BC3: encodeBC4(b, 3, d); encodeBC1(b, d+8); break;
+	case Format::BC4: encodeBC4(b, 0, d); break;
+	case Format::BC5: encodeBC4(b, 0, d); encodeBC4(b, 1, d+8); break;
+	case Format::BC7: encodeBC7(b, d); break;
+	}
+}
+
+
+void BcEncoder::decodeBlock(Format format, const void* src, uint8_t rgba[16*4])
+{
+	const uint8_t* s = static_cast<const uint8_t*>(src);
+	switch(format) {
+	case Format::BC1:
+		decodeBC1(s, rgba, false);
+		break;
+	case Format::BC3:
+		decodeBC1(s+8, rgba, true);
+		decodeBC4(s, rgba+3, 4);
+		break;
+	case Format::BC4:
+		decodeBC4(s, rgba, 4);
+		for(unsigned i=0; i<16; i++) {
+			rgba[i*4+1] = 0;
+			rgba[i*4+2] = 0;
+			rgba[i*4+3] = 255;
+		}
+		break;
+	case Format::BC5:
+		decodeBC4(s, rgba, 4);
+		decodeBC4(s+8, rgba+1, 4);
+		for(unsigned i=0; i<16; i++) {
+			rgba[i*4+2] = 0;
+			rgba[i*4+3] = 255;
+		}
+		break;
+	case Format::BC7:
+		decodeBC7(s, rgba);
+		break;
+	}
+}
+
+
+bool BcEncoder::encodeCached(uint64_t sourceHash, Format format, const uint8_t* pixels, uint32_t width, uint32_t height,
+                             unsigned numComponents, void* dst)
+{
+	CacheKey key(sourceHash, format, width, height, numComponents);
+	size_t size = encodedSize(format, width, height);
+
+	// memory cache
+	filesystem::path path;
+	{
+		lock_guard lock(_cacheMutex);
+		auto it = _memoryCache.find(key);
+		if(it != _memoryCache.end()) {
+			memcpy(dst, it->second.data(), size);
+			return true;
+		}
+		if(!_cacheDirectory.empty())
+			path = cacheFilePath(key);
+	}
+
+	// disk cache
+	// (the file contains the key, so the collisions of file names are detected)
+	struct FileHeader {
+		char magic[8];
+		uint64_t sourceHash;
+		uint32_t format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t numComponents;
+		uint64_t dataSize;
+	};
+	FileHeader expectedHeader{ { 'C', 'a', 'd', 'R', 'B', 'C', 'n', '1' }, sourceHash, uint32_t(format),
+	                           width, height, numComponents, size };
+	bool found = false;
+	if(!path.empty()) {
+		ifstream f(path, ios::in | ios::binary);
+		if(f) {
+			FileHeader h;
+			f.read(reinterpret_cast<char*>(&h), sizeof(h));
+			if(f && memcmp(&h, &expectedHeader, sizeof(h)) == 0) {
+				f.read(static_cast<char*>(dst), size);
+				found = bool(f);
+			}
+		}
+	}
+
+	// encode
+	if(!found) {
+		encode(format, pixels, width, height, numComponents, dst);
+
+		// store in the disk cache
+		// (write into temporary file and rename it, so concurrent readers never see partially written file;
+		// the disk cache is only an optimization, so errors are ignored)
+		if(!path.empty()) {
+			filesystem::path tmpPath = path;
+			tmpPath += ".tmp" + to_string(hash<thread::id>()(this_thread::get_id()));
+			{
+				ofstream f(tmpPath, ios::out | ios::binary | ios::trunc);
+				f.write(reinterpret_cast<const char*>(&expectedHeader), sizeof(expectedHeader));
+				f.write(static_cast<const char*>(dst), size);
+				f.close();
+				if(!f) {
+					error_code ec;
+					filesystem::remove(tmpPath, ec);
+					tmpPath.clear();
+				}
+			}
+			if(!tmpPath.empty()) {
+				error_code ec;
+				filesystem::rename(tmpPath, path, ec);
+				if(ec)
+					filesystem::remove(tmpPath, ec);
+			}
+		}
+	}
+
+	// store in the memory cache
+	{
+		lock_guard lock(_cacheMutex);
+		if(_memoryCacheSize + size <= _memoryCacheLimit) {
+			auto [it, inserted] = _memoryCache.try_emplace(key);
+			if(inserted) {
+				it->second.assign(static_cast<const uint8_t*>(dst), static_cast<const uint8_t*>(dst) + size);
+				_memoryCacheSize += size;
+			}
+		}
+	}
+
+	return found;
+}
+
+
+filesystem::path BcEncoder::cacheFilePath(const CacheKey& key) const
+{
+	char name[96];
+	snprintf(name, sizeof(name), "%016llx-%s-%ux%u-%u.bcn",
+	         static_cast<unsigned long long>(get<0>(key)), formatName(get<1>(key)),
+	         unsigned(get<2>(key)), unsigned(get<3>(key)), get<4>(key));
+	return _cacheDirectory / name;
+}
+
+
+void BcEncoder::setCacheDirectory(const filesystem::path& directory)
+{
+	if(!directory.empty())
+		filesystem::create_directories(directory);
+
+	lock_guard lock(_cacheMutex);
+	_cacheDirectory = directory;
+}
+
+
+void BcEncoder::clearMemoryCache()
+{
+	lock_guard lock(_cacheMutex);
+	_memoryCache.clear();
+	_memoryCacheSize = 0;
+}
+
+
+BcEncoder::Format BcEncoder::chooseFormat(unsigned numComponents, bool hasAlpha, bool srgb, bool normalMap)
+{
+	if(!srgb) {
+		if(numComponents == 1)
+			return Format::BC4;
+		if(numComponents == 2 || normalMap)
+			return Format::BC5;
+	}
+	if(hasAlpha || numComponents == 2)
+		return Format::BC7;
+	return Format::BC1;
+}
+
+
+bool BcEncoder::hasAlpha(const uint8_t* pixels, size_t numPixels, unsigned numComponents)
+{
+	if(numComponents != 4)
+		return false;
+	const uint8_t* p = pixels + numComponents - 1;
+	const uint8_t* e = p + numPixels * numComponents;
+	for(; p<e; p+=numComponents)
+		if(*p != 255)
+			return true;
+	return false;
+}
@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef CADR_BC_ENCODER_HEADER
+# define CADR_BC_ENCODER_HEADER
+
+# ifndef CADR_NO_INLINE_FUNCTIONS
+#  define CADR_NO_INLINE_FUNCTIONS
+#  undef CADR_NO_INLINE_FUNCTIONS
+# else
+# endif
+# include <vulkan/vulkan.hpp>
+# include <condition_variable>
+# include <cstdint>
+# include <deque>
+# include <filesystem>
+# include <functional>
+# include <map>
+# include <mutex>
+# include <thread>
+# include <tuple>
+# include <vector>
+
+namespace CadR {
+
+
+/** \brief BcEncoder compresses uncompressed 8-bit images into BCn block compressed formats.
+ *
+ *  The encoder targets real-time usage during the scene load,
+ *  so it prefers speed over the best possible quality.
+ *  It supports BC1, BC3, BC4, BC5 and BC7, while BC7 is encoded using mode 6 only.
+ *  The nearest palette entry search is vectorized using SSE2 on x86 and x86-64,
+ *  or using AVX2 or SSE4.1 when the CPU supports them.
+ *
+ *  The images are split into the rows of blocks that are processed by the internal thread pool.
+ *  Encoded images might be cached, both in memory and on the disk,
+ *  using the hash of the source image, so each image is encoded only once.
+ */
+class CADR_EXPORT BcEncoder {
+public:
+
+	enum class Format : uint8_t {
+		BC1,  ///< RGB, 4 bits per pixel
+		BC3,  ///< RGBA, 8 bits per pixel; alpha is encoded as in BC4
+		BC4,  ///< single channel, 4 bits per pixel
+		BC5,  ///< two channels, 8 bits per pixel; suitable for normal maps
+		BC7,  ///< RGBA, 8 bits per pixel; encoded using mode 6 only
+	};
+
+protected:
+
+	// thread pool
+	std::vector<std::thread> _threadList;
+	std::deque<std::function<void()>> _jobQueue;
+	std::mutex _jobMutex;
+	std::condition_variable _jobAvailableCondition;
+	std::condition_variable _jobFinishedCondition;
+	bool _exitThreads = false;
+
+	// cache
+	using CacheKey = std::tuple<uint64_t, Format, uint32_t, uint32_t, unsigned>;  // sourceHash, format, width, height, numComponents
+	std::map<CacheKey, std::vector<uint8_t>> _memoryCache;
+	std::mutex _cacheMutex;
+	size_t _memoryCacheSize = 0;
+	size_t _memoryCacheLimit = 64 << 20;
+	std::filesystem::path _cacheDirectory;
+
+	void workerMain();
+	std::filesystem::path cacheFilePath(const CacheKey& key) const;
+
+public:
+
+	// construction and destruction
+	BcEncoder(unsigned numThreads = 0);  ///< Creates encoder and its thread pool. Zero numThreads means std::thread::hardware_concurrency().
+	~BcEncoder() noexcept;
+	BcEncoder(const BcEncoder&) = delete;
+	BcEncoder& operator=(const BcEncoder&) = delete;
+
+	// encoding
+	void encode(Format format, const uint8_t* pixels, uint32_t width, uint32_t height,
+	            unsigned numComponents, void* dst);  ///< Encodes the image. The pixels are tightly packed with numComponents 8-bit components per pixel, placed in the channels as in R8, R8G8, R8G8B8 and R8G8B8A8 formats. The dst must provide encodedSize() bytes.
+	bool encodeCached(uint64_t sourceHash, Format format, const uint8_t* pixels, uint32_t width, uint32_t height,
+	                  unsigned numComponents, void* dst);  ///< Encodes the image or takes the encoded data from the cache. The sourceHash must identify the content of pixels. Returns true if the data were found in the cache.
+	static void encodeBlock(Format format, const uint8_t rgba[16*4], void* dst);  ///< Encodes single 4x4 block given by 16 RGBA pixels.
+	static void decodeBlock(Format format, const void* src, uint8_t rgba[16*4]);  ///< Decodes single 4x4 block into 16 RGBA pixels. BC7 decoding supports only mode 6 produced by this encoder.
+
+	// cache
+	void setCacheDirectory(const std::filesystem::path& directory);  ///< Sets the directory for the disk cache. Empty path disables the disk cache.
+	inline const std::filesystem::path& cacheDirectory() const;
+	inline void setMemoryCacheLimit(size_t numBytes);  ///< Sets the maximal amount of memory used by the memory cache. Zero disables the memory cache.
+	inline size_t memoryCacheLimit() const;
+	inline size_t memoryCacheSize() const;
+	void clearMemoryCache();
+
+	// helper functions
+	inline unsigned numThreads() const;
+	static Format chooseFormat(unsigned numComponents, bool hasAlpha, bool srgb, bool normalMap);  ///< Chooses the format for the image: BC4 and BC5 for linear single and two channel images, BC5 for normal maps, BC7 for images with alpha and BC1 otherwise.
+	static bool hasAlpha(const uint8_t* pixels, size_t numPixels, unsigned numComponents);  ///< Returns true if any pixel has alpha different from 255. Only images with 4 components might have alpha.
+	static inline size_t blockSize(Format format);
+	static inline size_t encodedSize(Format format, uint32_t width, uint32_t height);
+	static inline vk::Format vkFormat(Format format, bool srgb);
+	static inline const char* formatName(Format format);
+
+};
+
+
+}
+
+#endif
+
+
+// inline methods
+#if !defined(CADR_BC_ENCODER_INLINE_FUNCTIONS) && !defined(CADR_NO_INLINE_FUNCTIONS)
+# define CADR_BC_ENCODER_INLINE_FUNCTIONS
+namespace CadR {
+
+inline const std::filesystem::path& BcEncoder::cacheDirectory() const  { return _cacheDirectory; }
+inline void BcEncoder::setMemoryCacheLimit(size_t numBytes)  { _memoryCacheLimit = numBytes; if(numBytes < _memoryCacheSize) clearMemoryCache(); }
+inline size_t BcEncoder::memoryCacheLimit() const  { return _memoryCacheLimit; }
+inline size_t BcEncoder::memoryCacheSize() const  { return _memoryCacheSize; }
+inline unsigned BcEncoder::numThreads() const  { return unsigned(_threadList.size()); }
+inline size_t BcEncoder::blockSize(Format format)  { return (format == Format::BC1 || format == Format::BC4) ? 8 : 16; }
+inline size_t BcEncoder::encodedSize(Format format, uint32_t width, uint32_t height)  { return size_t((width+3)/4) * ((height+3)/4) * blockSize(format); }
+inline vk::Format BcEncoder::vkFormat(Format format, bool srgb)
+{
+	switch(format) {
+	case Format::BC1: return srgb ? vk::Format::eBc1RgbSrgbBlock : vk::Format::eBc1RgbUnormBlock;
+	case Format::BC3: return srgb ? vk::Format::eBc3SrgbBlock : vk::Format::eBc3UnormBlock;
+	case Format::BC4: return vk::Format::eBc4UnormBlock;
+	case Format::BC5: return vk::Format::eBc5UnormBlock;
+	case Format::BC7: return srgb ? vk::Format::eBc7SrgbBlock : vk::Format::eBc7UnormBlock;
+	default: return vk::Format::eUndefined;
+	}
+}
+inline const char* BcEncoder::formatName(Format format)
+{
+	switch(format) {
+	case Format::BC1: return "BC1";
+	case Format::BC3: return "BC3";
+	case Format::BC4: return "BC4";
+	case Format::BC5: return "BC5";
+	case Format::BC7: return "BC7";
+	default: return "Unknown";
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include <CadR/BoundingBox.h>
+#include "BoundingVolumeSimd.h"
+#include <glm/common.hpp>
+
+using namespace std;
+using namespace CadR;
+using namespace CadR::BoundingVolumeSimd;
+
+
+#if defined(CADR_BOUNDING_VOLUME_AVX2)
+
+/** Extends min and max by the points, 8 points per iteration.
+ *  The last point is always left for the scalar code as it cannot be read by 16-byte load.
+ *  Returns the number of processed points. */
+CADR_TARGET_AVX2 static size_t extendByPointsAvx2(const uint8_t* p, size_t numPoints, size_t stride,
+                                                  glm::vec3& min, glm::vec3& max)
+{
+	size_t i = 0;
+	if(numPoints > 8) {
+		__m256 minX = _mm256_set1_ps(min.x);
+		__m256 minY = _mm256_set1_ps(min.y);
+		__m256 minZ = _mm256_set1_ps(min.z);
+		__m256 maxX = _mm256_set1_ps(max.x);
+		__m256 maxY = _mm256_set1_ps(max.y);
+		__m256 maxZ = _mm256_set1_ps(max.z);
+		for(; i+8<numPoints; i+=8, p+=8*stride) {
+			__m256 x, y, z;
+			loadPoints(p, stride, x, y, z);
+			minX = _mm256_min_ps(minX, x);
+			minY = _mm256_min_ps(minY, y);
+			minZ = _mm256_min_ps(minZ, z);
+			maxX = _mm256_max_ps(maxX, x);
+			maxY = _mm256_max_ps(maxY, y);
+			maxZ = _mm256_max_ps(maxZ, z);
+		}
+		min = { horizontalMin(minX), horizontalMin(minY), horizontalMin(minZ) };
+		max = { horizontalMax(maxX), horizontalMax(maxY), horizontalMax(maxZ) };
+	}
+	return i;
+}
+
+#endif
+#if defined(CADR_BOUNDING_VOLUME_SSE2)
+
+/** Extends min and max by the points, 4 points per iteration.
+ *  The last point is always left for the scalar code as it cannot be read by 16-byte load.
+ *  Returns the number of processed points. */
+static size_t extendByPointsSse2(const uint8_t* p, size_t numPoints, size_t stride,
+                                 glm::vec3& min, glm::vec3& max)
+{
+	size_t i = 0;
+	if(numPoints > 4) {
+		__m128 minX = _mm_set1_ps(min.x);
+		__m128 minY = _mm_set1_ps(min.y);
+		__m128 minZ = _mm_set1_ps(min.z);
+		__m128 maxX = _mm_set1_ps(max.x);
+		__m128 maxY = _mm_set1_ps(max.y);
+		__m128 maxZ = _mm_set1_ps(max.z);
+		for(; i+4<numPoints; i+=4, p+=4*stride) {
+			__m128 x, y, z;
+			loadPoints(p, stride, x, y, z);
+			minX = _mm_min_ps(minX, x);
+			minY = _mm_min_ps(minY, y);
+			minZ = _mm_min_ps(minZ, z);
+			maxX = _mm_max_ps(maxX, x);
+			maxY = _mm_max_ps(maxY, y);
+			maxZ = _mm_max_ps(maxZ, z);
+		}
+		min = { horizontalMin(minX), horizontalMin(minY), horizontalMin(minZ) };
+		max = { horizontalMax(maxX), horizontalMax(maxY), horizontalMax(maxZ) };
+	}
+	return i;
+}
+
+#endif
+
+
+void BoundingBox::extendByPoints(const void* points, size_t numPoints, size_t stride)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(points);
+	size_t i = 0;
+
+	// SIMD kernels
+#if defined(CADR_BOUNDING_VOLUME_AVX2)
+	if(CpuFeatures::hasAvx2())
+		i = extendByPointsAvx2(p, numPoints, stride, min, max);
+	else
+		i = extendByPointsSse2(p, numPoints, stride, min, max);
+#elif defined(CADR_BOUNDING_VOLUME_SSE2)
+	i = extendByPointsSse2(p, numPoints, stride, min, max);
+#endif
+	p += i*stride;
+
+	// remaining points
+	for(; i<numPoints; i++, p+=stride) {
+		const glm::vec3& v = *reinterpret_cast<const glm::vec3*>(p);
+		min = glm::min(min, v);
+		max = glm::max(max, v);
+	}
+}
@@ -5,12 +5,13 @@
 #pragma once
 
 #include <glm/vec3.hpp>
+#include <cstddef>
 #include <limits>
 
 namespace CadR {
 
 
-struct BoundingBox {
+struct CADR_EXPORT BoundingBox {
 
 	glm::vec3 min;
 	glm::vec3 max;
@@ -25,6 +26,9 @@ struct BoundingBox {
 	void setByCenterAndHalfExtents(glm::vec3 center, glm::vec3 halfExtents);
 	void extendBy(const BoundingBox& bb);
 
+	static BoundingBox createByPoints(const void* points, size_t numPoints, size_t stride = sizeof(glm::vec3));  //< Computes bounding box of float3 points. The stride is given in bytes; it must be at least 12 and multiple of 4. SSE2 is used on x86 and x86-64 and AVX2 if the CPU supports it.
+	void extendByPoints(const void* points, size_t numPoints, size_t stride = sizeof(glm::vec3));  //< Extends bounding box to contain all float3 points. See createByPoints() for details.
+
 };
 
 
@@ -52,6 +56,11 @@ inline void BoundingBox::setByCenterAndHalfExtents(glm::vec3 center, glm::vec3 h
 	min = center - halfExtents;
 	max = center + halfExtents;
 }
+inline BoundingBox BoundingBox::createByPoints(const void* points, size_t numPoints, size_t stride) {
+	BoundingBox bb = empty();
+	bb.extendByPoints(points, numPoints, stride);
+	return bb;
+}
 inline void BoundingBox::extendBy(const BoundingBox& bb) {
 	if(bb.min.x < min.x)
 		min.x = bb.min.x;
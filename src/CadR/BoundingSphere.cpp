@@ -0,0 +1,472 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include <CadR/BoundingSphere.h>
+#include "BoundingVolumeSimd.h"
+
+using namespace std;
+using namespace CadR;
+using namespace CadR::BoundingVolumeSimd;
+
+
+static inline const glm::vec3& getPoint(const uint8_t* points, size_t index, size_t stride)
+{
+	return *reinterpret_cast<const glm::vec3*>(points + index*stride);
+}
+
+
+#if defined(CADR_BOUNDING_VOLUME_AVX2)
+
+/** Updates minValue, maxValue, minIndex and maxIndex by the points with minimal and maximal x, y and z,
+ *  8 points per iteration. The last point is always left for the scalar code
+ *  as it cannot be read by 16-byte load. Returns the number of processed points. */
+CADR_TARGET_AVX2 static size_t findExtremePointsAvx2(const uint8_t* p, size_t numPoints, size_t stride,
+	float minValue[3], float maxValue[3], size_t minIndex[3], size_t maxIndex[3])
+{
+	if(numPoints <= 8)
+		return 0;
+
+	__m256 minV[3], maxV[3];
+	__m256 minI[3], maxI[3];
+	for(unsigned a=0; a<3; a++) {
+		minV[a] = _mm256_set1_ps(minValue[a]);
+		maxV[a] = _mm256_set1_ps(maxValue[a]);
+		minI[a] = maxI[a] = _mm256_setzero_ps();
+	}
+	__m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i step = _mm256_set1_epi32(8);
+	size_t i = 0;
+	for(; i+8<numPoints; i+=8, index=_mm256_add_epi32(index, step)) {
+		__m256 v[3];
+		loadPoints(p + i*stride, stride, v[0], v[1], v[2]);
+		__m256 indexF = _mm256_castsi256_ps(index);
+		for(unsigned a=0; a<3; a++) {
+			__m256 lt = _mm256_cmp_ps(v[a], minV[a], _CMP_LT_OQ);
+			__m256 gt = _mm256_cmp_ps(v[a], maxV[a], _CMP_GT_OQ);
+			minV[a] = _mm256_blendv_ps(minV[a], v[a], lt);
+			maxV[a] = _mm256_blendv_ps(maxV[a], v[a], gt);
+			minI[a] = _mm256_blendv_ps(minI[a], indexF, lt);
+			maxI[a] = _mm256_blendv_ps(maxI[a], indexF, gt);
+		}
+	}
+
+	// reduce the lanes
+	alignas(32) float laneValue[8];
+	alignas(32) uint32_t laneIndex[8];
+	for(unsigned a=0; a<3; a++) {
+		_mm256_store_ps(laneValue, minV[a]);
+		_mm256_store_ps(reinterpret_cast<float*>(laneIndex), minI[a]);
+		for(unsigned l=0; l<8; l++)
+			if(laneValue[l] < minValue[a]) {
+				minValue[a] = laneValue[l];
+				minIndex[a] = laneIndex[l];
+			}
+		_mm256_store_ps(laneValue, maxV[a]);
+		_mm256_store_ps(reinterpret_cast<float*>(laneIndex), maxI[a]);
+		for(unsigned l=0; l<8; l++)
+			if(laneValue[l] > maxValue[a]) {
+				maxValue[a] = laneValue[l];
+				maxIndex[a] = laneIndex[l];
+			}
+	}
+	return i;
+}
+
+/** Skips the groups of 8 points lying inside the sphere, starting at index i.
+ *  Returns the index of the first group having a point outside of the sphere,
+ *  or the index where the processing stopped if there is no such group
+ *  (the last point is always left for the scalar code as it cannot be read by 16-byte load). */
+CADR_TARGET_AVX2 static size_t skipPointsInsideAvx2(const uint8_t* p, size_t numPoints, size_t stride, size_t i,
+	const glm::vec3& center, float radius2)
+{
+	const __m256 cx = _mm256_set1_ps(center.x);
+	const __m256 cy = _mm256_set1_ps(center.y);
+	const __m256 cz = _mm256_set1_ps(center.z);
+	const __m256 r2 = _mm256_set1_ps(radius2);
+	for(; i+8<numPoints; i+=8) {
+		__m256 x, y, z;
+		loadPoints(p + i*stride, stride, x, y, z);
+		__m256 dx = _mm256_sub_ps(x, cx);
+		__m256 dy = _mm256_sub_ps(y, cy);
+		__m256 dz = _mm256_sub_ps(z, cz);
+		__m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+		if(_mm256_movemask_ps(_mm256_cmp_ps(d2, r2, _CMP_GT_OQ)) != 0)
+			break;
+	}
+	return i;
+}
+
+/** Computes the maximal squared distance of the points from the center, 8 points per iteration.
+ *  The last point is always left for the scalar code as it cannot be read by 16-byte load.
+ *  Returns the number of processed points. */
+CADR_TARGET_AVX2 static size_t maxDistance2Avx2(const uint8_t* p, size_t numPoints, size_t stride,
+	const glm::vec3& center, float& maxDist2)
+{
+	size_t i = 0;
+	if(numPoints > 8) {
+		const __m256 cx = _mm256_set1_ps(center.x);
+		const __m256 cy = _mm256_set1_ps(center.y);
+		const __m256 cz = _mm256_set1_ps(center.z);
+		__m256 m = _mm256_set1_ps(maxDist2);
+		for(; i+8<numPoints; i+=8, p+=8*stride) {
+			__m256 x, y, z;
+			loadPoints(p, stride, x, y, z);
+			__m256 dx = _mm256_sub_ps(x, cx);
+			__m256 dy = _mm256_sub_ps(y, cy);
+			__m256 dz = _mm256_sub_ps(z, cz);
+			m = _mm256_max_ps(m, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz)));
+		}
+		maxDist2 = horizontalMax(m);
+	}
+	return i;
+}
+
+/** Transforms the sphere by the matrices, two matrices per iteration, one in each 128-bit lane.
+ *  Returns the number of processed matrices. */
+CADR_TARGET_AVX2 static size_t transformAvx2(const BoundingSphere& bs, const glm::mat4* matrices, size_t numMatrices,
+	BoundingSphere* results)
+{
+	const __m256 cx = _mm256_set1_ps(bs.center.x);
+	const __m256 cy = _mm256_set1_ps(bs.center.y);
+	const __m256 cz = _mm256_set1_ps(bs.center.z);
+	const __m256 r = _mm256_set1_ps(bs.radius);
+	size_t i = 0;
+	for(; i+2<=numMatrices; i+=2) {
+		const uint8_t* m0 = reinterpret_cast<const uint8_t*>(&matrices[i][0][0]);
+		const uint8_t* m1 = reinterpret_cast<const uint8_t*>(&matrices[i+1][0][0]);
+		__m256 c0 = load2(m0,    m1);
+		__m256 c1 = load2(m0+16, m1+16);
+		__m256 c2 = load2(m0+32, m1+32);
+		__m256 c3 = load2(m0+48, m1+48);
+
+		// center = M * vec4(center, 1)
+		__m256 newCenter = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c0, cx), _mm256_mul_ps(c1, cy)),
+		                                 _mm256_add_ps(_mm256_mul_ps(c2, cz), c3));
+
+		// radius is scaled by the longest of the first three columns
+		__m256 t0 = _mm256_unpacklo_ps(c0, c1);  // c0x c1x c0y c1y
+		__m256 t1 = _mm256_unpacklo_ps(c2, c3);  // c2x c3x c2y c3y
+		__m256 t2 = _mm256_unpackhi_ps(c0, c1);  // c0z c1z c0w c1w
+		__m256 t3 = _mm256_unpackhi_ps(c2, c3);  // c2z c3z c2w c3w
+		__m256 x = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1,0,1,0));
+		__m256 y = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3,2,3,2));
+		__m256 z = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1,0,1,0));
+		__m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+		__m256 maxLen2 = _mm256_max_ps(_mm256_max_ps(
+			_mm256_shuffle_ps(len2, len2, _MM_SHUFFLE(0,0,0,0)),
+			_mm256_shuffle_ps(len2, len2, _MM_SHUFFLE(1,1,1,1))),
+			_mm256_shuffle_ps(len2, len2, _MM_SHUFFLE(2,2,2,2)));
+		__m256 newRadius = _mm256_mul_ps(_mm256_sqrt_ps(maxLen2), r);
+
+		// store center in xyz and radius in w of each lane
+		_mm256_storeu_ps(reinterpret_cast<float*>(&results[i]), _mm256_blend_ps(newCenter, newRadius, 0x88));
+	}
+	return i;
+}
+
+#endif
+#if defined(CADR_BOUNDING_VOLUME_SSE2)
+
+static inline __m128 select(__m128 a, __m128 b, __m128 mask)
+{
+	return _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b));
+}
+
+/** Updates minValue, maxValue, minIndex and maxIndex by the points with minimal and maximal x, y and z,
+ *  4 points per iteration. The last point is always left for the scalar code
+ *  as it cannot be read by 16-byte load. Returns the number of processed points. */
+static size_t findExtremePointsSse2(const uint8_t* p, size_t numPoints, size_t stride,
+	float minValue[3], float maxValue[3], size_t minIndex[3], size_t maxIndex[3])
+{
+	if(numPoints <= 4)
+		return 0;
+
+	__m128 minV[3], maxV[3];
+	__m128 minI[3], maxI[3];
+	for(unsigned a=0; a<3; a++) {
+		minV[a] = _mm_set1_ps(minValue[a]);
+		maxV[a] = _mm_set1_ps(maxValue[a]);
+		minI[a] = maxI[a] = _mm_setzero_ps();
+	}
+	__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i step = _mm_set1_epi32(4);
+	size_t i = 0;
+	for(; i+4<numPoints; i+=4, index=_mm_add_epi32(index, step)) {
+		__m128 v[3];
+		loadPoints(p + i*stride, stride, v[0], v[1], v[2]);
+		__m128 indexF = _mm_castsi128_ps(index);
+		for(unsigned a=0; a<3; a++) {
+			__m128 lt = _mm_cmplt_ps(v[a], minV[a]);
+			__m128 gt = _mm_cmpgt_ps(v[a], maxV[a]);
+			minV[a] = select(minV[a], v[a], lt);
+			maxV[a] = select(maxV[a], v[a], gt);
+			minI[a] = select(minI[a], indexF, lt);
+			maxI[a] = select(maxI[a], indexF, gt);
+		}
+	}
+
+	// reduce the lanes
+	alignas(16) float laneValue[4];
+	alignas(16) uint32_t laneIndex[4];
+	for(unsigned a=0; a<3; a++) {
+		_mm_store_ps(laneValue, minV[a]);
+		_mm_store_ps(reinterpret_cast<float*>(laneIndex), minI[a]);
+		for(unsigned l=0; l<4; l++)
+			if(laneValue[l] < minValue[a]) {
+				minValue[a] = laneValue[l];
+				minIndex[a] = laneIndex[l];
+			}
+		_mm_store_ps(laneValue, maxV[a]);
+		_mm_store_ps(reinterpret_cast<float*>(laneIndex), maxI[a]);
+		for(unsigned l=0; l<4; l++)
+			if(laneValue[l] > maxValue[a]) {
+				maxValue[a] = laneValue[l];
+				maxIndex[a] = laneIndex[l];
+			}
+	}
+	return i;
+}
+
+/** Skips the groups of 4 points lying inside the sphere, starting at index i.
+ *  Returns the index of the first group having a point outside of the sphere,
+ *  or the index where the processing stopped if there is no such group
+ *  (the last point is always left for the scalar code as it cannot be read by 16-byte load). */
+static size_t skipPointsInsideSse2(const uint8_t* p, size_t numPoints, size_t stride, size_t i,
+	const glm::vec3& center, float radius2)
+{
+	const __m128 cx = _mm_set1_ps(center.x);
+	const __m128 cy = _mm_set1_ps(center.y);
+	const __m128 cz = _mm_set1_ps(center.z);
+	const __m128 r2 = _mm_set1_ps(radius2);
+	for(; i+4<numPoints; i+=4) {
+		__m128 x, y, z;
+		loadPoints(p + i*stride, stride, x, y, z);
+		__m128 dx = _mm_sub_ps(x, cx);
+		__m128 dy = _mm_sub_ps(y, cy);
+		__m128 dz = _mm_sub_ps(z, cz);
+		__m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		if(_mm_movemask_ps(_mm_cmpgt_ps(d2, r2)) != 0)
+			break;
+	}
+	return i;
+}
+
+/** Computes the maximal squared distance of the points from the center, 4 points per iteration.
+ *  The last point is always left for the scalar code as it cannot be read by 16-byte load.
+ *  Returns the number of processed points. */
+static size_t maxDistance2Sse2(const uint8_t* p, size_t numPoints, size_t stride,
+	const glm::vec3& center, float& maxDist2)
+{
+	size_t i = 0;
+	if(numPoints > 4) {
+		const __m128 cx = _mm_set1_ps(center.x);
+		const __m128 cy = _mm_set1_ps(center.y);
+		const __m128 cz = _mm_set1_ps(center.z);
+		__m128 m = _mm_set1_ps(maxDist2);
+		for(; i+4<numPoints; i+=4, p+=4*stride) {
+			__m128 x, y, z;
+			loadPoints(p, stride, x, y, z);
+			__m128 dx = _mm_sub_ps(x, cx);
+			__m128 dy = _mm_sub_ps(y, cy);
+			__m128 dz = _mm_sub_ps(z, cz);
+			m = _mm_max_ps(m, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+		}
+		maxDist2 = horizontalMax(m);
+	}
+	return i;
+}
+
+/** Transforms the sphere by the matrices, one matrix per iteration.
+ *  Returns the number of processed matrices. */
+static size_t transformSse2(const BoundingSphere& bs, const glm::mat4* matrices, size_t numMatrices,
+	BoundingSphere* results)
+{
+	const __m128 cx = _mm_set1_ps(bs.center.x);
+	const __m128 cy = _mm_set1_ps(bs.center.y);
+	const __m128 cz = _mm_set1_ps(bs.center.z);
+	const __m128 r = _mm_set1_ps(bs.radius);
+	size_t i = 0;
+	for(; i<numMatrices; i++) {
+		const float* m = &matrices[i][0][0];
+		__m128 c0 = _mm_loadu_ps(m);
+		__m128 c1 = _mm_loadu_ps(m+4);
+		__m128 c2 = _mm_loadu_ps(m+8);
+		__m128 c3 = _mm_loadu_ps(m+12);
+
+		// center = M * vec4(center, 1)
+		__m128 newCenter = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, cx), _mm_mul_ps(c1, cy)),
+		                              _mm_add_ps(_mm_mul_ps(c2, cz), c3));
+
+		// radius is scaled by the longest of the first three columns
+		__m128 t0 = _mm_unpacklo_ps(c0, c1);  // c0x c1x c0y c1y
+		__m128 t1 = _mm_unpacklo_ps(c2, c3);  // c2x c3x c2y c3y
+		__m128 t2 = _mm_unpackhi_ps(c0, c1);  // c0z c1z c0w c1w
+		__m128 t3 = _mm_unpackhi_ps(c2, c3);  // c2z c3z c2w c3w
+		__m128 x = _mm_movelh_ps(t0, t1);
+		__m128 y = _mm_movehl_ps(t1, t0);
+		__m128 z = _mm_movelh_ps(t2, t3);
+		__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		__m128 maxLen2 = _mm_max_ss(_mm_max_ss(len2, _mm_shuffle_ps(len2, len2, _MM_SHUFFLE(1,1,1,1))),
+		                            _mm_movehl_ps(len2, len2));
+		__m128 newRadius = _mm_mul_ss(_mm_sqrt_ss(maxLen2), r);
+
+		// store center in xyz and radius in w
+		// (tmp = (center.z, radius, ...), result = (center.x, center.y, center.z, radius))
+		__m128 tmp = _mm_unpackhi_ps(newCenter, _mm_shuffle_ps(newRadius, newRadius, _MM_SHUFFLE(0,0,0,0)));
+		_mm_storeu_ps(reinterpret_cast<float*>(&results[i]), _mm_shuffle_ps(newCenter, tmp, _MM_SHUFFLE(1,0,1,0)));
+	}
+	return i;
+}
+
+#endif
+
+
+BoundingSphere BoundingSphere::createByPoints(const void* points, size_t numPoints, size_t stride)
+{
+	if(numPoints == 0)
+		return empty();
+
+	const uint8_t* p = static_cast<const uint8_t*>(points);
+
+	// find indices of the points with minimal and maximal x, y and z
+	float minValue[3];
+	float maxValue[3];
+	size_t minIndex[3] = { 0, 0, 0 };
+	size_t maxIndex[3] = { 0, 0, 0 };
+	for(unsigned a=0; a<3; a++)
+		minValue[a] = maxValue[a] = getPoint(p, 0, stride)[a];
+	size_t i = 0;
+
+	// SIMD search for extreme points
+	// (indices are tracked in 32-bit lanes, so huge arrays are left for the scalar code)
+	if(numPoints <= 0x7fffffff) {
+#if defined(CADR_BOUNDING_VOLUME_AVX2)
+		if(CpuFeatures::hasAvx2())
+			i = findExtremePointsAvx2(p, numPoints, stride, minValue, maxValue, minIndex, maxIndex);
+		else
+			i = findExtremePointsSse2(p, numPoints, stride, minValue, maxValue, minIndex, maxIndex);
+#elif defined(CADR_BOUNDING_VOLUME_SSE2)
+		i = findExtremePointsSse2(p, numPoints, stride, minValue, maxValue, minIndex, maxIndex);
+#endif
+	}
+
+	// remaining points
+	for(; i<numPoints; i++) {
+		const glm::vec3& v = getPoint(p, i, stride);
+		for(unsigned a=0; a<3; a++) {
+			if(v[a] < minValue[a]) {
+				minValue[a] = v[a];
+				minIndex[a] = i;
+			}
+			if(v[a] > maxValue[a]) {
+				maxValue[a] = v[a];
+				maxIndex[a] = i;
+			}
+		}
+	}
+
+	// initial sphere is given by the most distant pair of extreme points
+	unsigned axis = 0;
+	float maxDist2 = -1.f;
+	for(unsigned a=0; a<3; a++) {
+		float d2 = glm::distance2(getPoint(p, minIndex[a], stride), getPoint(p, maxIndex[a], stride));
+		if(d2 > maxDist2) {
+			maxDist2 = d2;
+			axis = a;
+		}
+	}
+	const glm::vec3& p1 = getPoint(p, minIndex[axis], stride);
+	const glm::vec3& p2 = getPoint(p, maxIndex[axis], stride);
+	BoundingSphere bs{ .center = (p1 + p2) * 0.5f, .radius = sqrt(maxDist2) * 0.5f };
+	float radius2 = bs.radius * bs.radius;
+
+	// grow the sphere by the points lying outside of it
+	auto growBy =
+		[&bs, &radius2](const glm::vec3& v) {
+			float d2 = glm::distance2(v, bs.center);
+			if(d2 > radius2) {
+				float d = sqrt(d2);
+				float newRadius = (bs.radius + d) * 0.5f;
+				bs.center += (v - bs.center) * ((d - newRadius) / d);
+				bs.radius = newRadius;
+				radius2 = newRadius * newRadius;
+			}
+		};
+	i = 0;
+
+	// test groups of points at once and process them one by one only if any of them is outside
+#if defined(CADR_BOUNDING_VOLUME_SSE2)
+	size_t groupSize = 4;
+	size_t (*skipPointsInside)(const uint8_t*, size_t, size_t, size_t, const glm::vec3&, float) = skipPointsInsideSse2;
+# if defined(CADR_BOUNDING_VOLUME_AVX2)
+	if(CpuFeatures::hasAvx2()) {
+		groupSize = 8;
+		skipPointsInside = skipPointsInsideAvx2;
+	}
+# endif
+	while(true) {
+		i = skipPointsInside(p, numPoints, stride, i, bs.center, radius2);
+		if(i+groupSize >= numPoints)
+			break;
+		for(size_t e=i+groupSize; i<e; i++)
+			growBy(getPoint(p, i, stride));
+	}
+#endif
+
+	// remaining points
+	for(; i<numPoints; i++)
+		growBy(getPoint(p, i, stride));
+
+	return bs;
+}
+
+
+void BoundingSphere::extendRadiusByPoints(const void* points, size_t numPoints, size_t stride)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(points);
+	float maxDist2 = radius * radius;
+	size_t i = 0;
+
+	// SIMD kernels
+#if defined(CADR_BOUNDING_VOLUME_AVX2)
+	if(CpuFeatures::hasAvx2())
+		i = maxDistance2Avx2(p, numPoints, stride, center, maxDist2);
+	else
+		i = maxDistance2Sse2(p, numPoints, stride, center, maxDist2);
+#elif defined(CADR_BOUNDING_VOLUME_SSE2)
+	i = maxDistance2Sse2(p, numPoints, stride, center, maxDist2);
+#endif
+	p += i*stride;
+
+	// remaining points
+	for(; i<numPoints; i++, p+=stride) {
+		float d2 = glm::distance2(*reinterpret_cast<const glm::vec3*>(p), center);
+		if(d2 > maxDist2)
+			maxDist2 = d2;
+	}
+
+	// sqrt is performed only once
+	if(maxDist2 > radius * radius)
+		radius = sqrt(maxDist2);
+}
+
+
+void BoundingSphere::transform(const glm::mat4* matrices, size_t numMatrices, BoundingSphere* results) const
+{
+	size_t i = 0;
+
+	// SIMD kernels
+#if defined(CADR_BOUNDING_VOLUME_AVX2)
+	if(CpuFeatures::hasAvx2())
+		i = transformAvx2(*this, matrices, numMatrices, results);
+	else
+		i = transformSse2(*this, matrices, numMatrices, results);
+#elif defined(CADR_BOUNDING_VOLUME_SSE2)
+	i = transformSse2(*this, matrices, numMatrices, results);
+#endif
+
+	// remaining matrices
+	for(; i<numMatrices; i++)
+		results[i] = matrices[i] * *this;
+}
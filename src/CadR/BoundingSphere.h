@@ -10,12 +10,13 @@
 #include <glm/gtx/norm.hpp>  // glm::distance2()
 #include <algorithm>  // std::max()
 #include <cmath>  // std::sqrt()
+#include <cstddef>
 #include <limits>
 
 namespace CadR {
 
 
-struct BoundingSphere {
+struct CADR_EXPORT BoundingSphere {
 
 	glm::vec3 center;
 	float radius;
@@ -30,10 +31,19 @@ struct BoundingSphere {
 	void extendRadiusBy(glm::vec3 point);  //< Extends BoundingSphere radius so it contains point given by argument. If you are processing many points, you might consider to use extendRadiusByPointUsingRadius2() to avoid expensive sqrt operation with each point.
 	void extendRadiusByPointUsingRadius2(glm::vec3 point);  //< Extends BoundingSphere radius so it contains point given by argument. This is optimized version that goes around high computing cost of sqrt. Instead, it treats radius member as to contain square of radius (e.g. radius*radius), so high const of sqrt is avoided. A typical usage scenario is to convert initial radius to square of radius first. Initial radius is often zero. Then, to process number of points with extendRadiusByPointUsingRadius2() with the final radius stored as square of radius. Finally, to perform sqrt on BoundingSphere.radius to convert it back from square radius to radius. So, this optimized approach does sqrt only once instead on every point.
 
+	// batched kernels
+	// (they process float3 points given by pointer and stride in bytes, that must be at least 12 and multiple of 4;
+	// SSE2 is used on x86 and x86-64 and AVX2 if the CPU supports it)
+	static BoundingSphere createByPoints(const void* points, size_t numPoints, size_t stride = sizeof(glm::vec3));  //< Computes bounding sphere of the points using Ritter's algorithm. The sphere is usually 5-20% larger than the minimal one.
+	void extendRadiusByPoints(const void* points, size_t numPoints, size_t stride = sizeof(glm::vec3));  //< Extends radius so the sphere contains all the points while keeping the center. It is the batched version of extendRadiusBy(glm::vec3).
+	void transform(const glm::mat4* matrices, size_t numMatrices, BoundingSphere* results) const;  //< Transforms the sphere by each of the matrices and stores the results in the results array. It is the batched version of operator*(const glm::mat4&, const BoundingSphere).
+
 };
 
 BoundingSphere operator*(const glm::mat4& transformationMatrix, const BoundingSphere bs);
 
+static_assert(sizeof(BoundingSphere) == 16, "BoundingSphere is expected to be tightly packed for SIMD processing.");
+
 
 // inline functions
 inline BoundingSphere BoundingSphere::empty() {
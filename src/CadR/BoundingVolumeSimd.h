@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// helper functions of SIMD kernels of BoundingBox and BoundingSphere
+//
+// SSE2 kernels are used on x86 and x86-64 where SSE2 is the baseline.
+// AVX2 kernels are compiled for AVX2 by CADR_TARGET_AVX2 attribute
+// and they are used instead of SSE2 kernels when the CPU supports AVX2 (see CpuFeatures.h).
+
+#include "CpuFeatures.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define CADR_BOUNDING_VOLUME_SSE2
+# if defined(CADR_SIMD_DISPATCH)
+#  include <immintrin.h>
+#  define CADR_BOUNDING_VOLUME_AVX2
+# endif
+#endif
+#include <cstddef>
+#include <cstdint>
+
+namespace CadR {
+namespace BoundingVolumeSimd {
+
+
+#if defined(CADR_BOUNDING_VOLUME_AVX2)
+
+/** Loads two unaligned 16-byte values into the lower and upper lane. */
+CADR_TARGET_AVX2 inline __m256 load2(const uint8_t* lo, const uint8_t* hi)
+{
+	return _mm256_insertf128_ps(
+		_mm256_castps128_ps256(_mm_loadu_ps(reinterpret_cast<const float*>(lo))),
+		_mm_loadu_ps(reinterpret_cast<const float*>(hi)), 1);
+}
+
+/** Loads 8 float3 points into structure-of-arrays layout.
+ *  Each point is read by 16-byte load, so the four bytes following each point must be readable.
+ *  The callers ensure it by never loading the last point of the array this way. */
+CADR_TARGET_AVX2 inline void loadPoints(const uint8_t* p, size_t stride, __m256& x, __m256& y, __m256& z)
+{
+	__m256 a = load2(p,          p+4*stride);
+	__m256 b = load2(p+stride,   p+5*stride);
+	__m256 c = load2(p+2*stride, p+6*stride);
+	__m256 d = load2(p+3*stride, p+7*stride);
+	__m256 t0 = _mm256_unpacklo_ps(a, b);  // ax bx ay by
+	__m256 t1 = _mm256_unpacklo_ps(c, d);  // cx dx cy dy
+	__m256 t2 = _mm256_unpackhi_ps(a, b);  // az bz aw bw
+	__m256 t3 = _mm256_unpackhi_ps(c, d);  // cz dz cw dw
+	x = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1,0,1,0));
+	y = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3,2,3,2));
+	z = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1,0,1,0));
+}
+
+CADR_TARGET_AVX2 inline float horizontalMin(__m256 v)
+{
+	__m128 m = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+	m = _mm_min_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1,1,1,1)));
+	return _mm_cvtss_f32(m);
+}
+
+CADR_TARGET_AVX2 inline float horizontalMax(__m256 v)
+{
+	__m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+	m = _mm_max_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1,1,1,1)));
+	return _mm_cvtss_f32(m);
+}
+
+#endif
+#if defined(CADR_BOUNDING_VOLUME_SSE2)
+
+/** Loads 4 float3 points into structure-of-arrays layout.
+ *  Each point is read by 16-byte load, so the four bytes following each point must be readable.
+ *  The callers ensure it by never loading the last point of the array this way. */
+inline void loadPoints(const uint8_t* p, size_t stride, __m128& x, __m128& y, __m128& z)
+{
+	__m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(p));
+	__m128 b = _mm_loadu_ps(reinterpret_cast<const float*>(p+stride));
+	__m128 c = _mm_loadu_ps(reinterpret_cast<const float*>(p+2*stride));
+	__m128 d = _mm_loadu_ps(reinterpret_cast<const float*>(p+3*stride));
+	__m128 t0 = _mm_unpacklo_ps(a, b);  // ax bx ay by
+	__m128 t1 = _mm_unpacklo_ps(c, d);  // cx dx cy dy
+	__m128 t2 = _mm_unpackhi_ps(a, b);  // az bz aw bw
+	__m128 t3 = _mm_unpackhi_ps(c, d);  // cz dz cw dw
+	x = _mm_movelh_ps(t0, t1);
+	y = _mm_movehl_ps(t1, t0);
+	z = _mm_movelh_ps(t2, t3);
+}
+
+inline float horizontalMin(__m128 m)
+{
+	m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+	m = _mm_min_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1,1,1,1)));
+	return _mm_cvtss_f32(m);
+}
+
+inline float horizontalMax(__m128 m)
+{
+	m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+	m = _mm_max_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1,1,1,1)));
+	return _mm_cvtss_f32(m);
+}
+
+#endif
+
+
+}
+}
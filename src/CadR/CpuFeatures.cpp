@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include "CpuFeatures.h"
+#if defined(CADR_SIMD_DISPATCH) && defined(_MSC_VER) && !defined(__clang__)
+# include <intrin.h>
+# include <immintrin.h>
+#endif
+
+using namespace CadR;
+
+
+#if defined(CADR_SIMD_DISPATCH) && defined(_MSC_VER) && !defined(__clang__)
+
+static bool detectAvx2()
+{
+	// AVX2 requires AVX support of the CPU (ecx bit 28 of leaf 1),
+	// saving of ymm registers by the operating system (OSXSAVE, ecx bit 27 of leaf 1, and XCR0 bits 1 and 2)
+	// and AVX2 support itself (ebx bit 5 of leaf 7)
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	if((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+		return false;
+	if((_xgetbv(0) & 0x6) != 0x6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+}
+
+static bool detectSse41()
+{
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 19)) != 0;
+}
+
+#elif defined(CADR_SIMD_DISPATCH)
+
+static bool detectAvx2()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+static bool detectSse41()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse4.1");
+}
+
+#else
+
+static bool detectAvx2()  { return false; }
+static bool detectSse41()  { return false; }
+
+#endif
+
+
+bool CpuFeatures::hasAvx2()
+{
+	static const bool r = detectAvx2();
+	return r;
+}
+
+
+bool CpuFeatures::hasSse41()
+{
+	static const bool r = detectSse41();
+	return r;
+}
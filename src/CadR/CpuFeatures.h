@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// runtime detection of x86 instruction set extensions
+//
+// SIMD kernels using instruction sets beyond the compiler target are compiled
+// with CADR_TARGET_AVX2 or CADR_TARGET_SSE41 function attribute
+// and they are called only when CpuFeatures reports the support of the instruction set.
+// CADR_SIMD_DISPATCH is defined if the compiler supports such kernels,
+// e.g. GCC, Clang and MSVC on x86 and x86-64.
+//
+// Note that functions compiled with the target attribute cannot be inlined into functions without it.
+// It applies to lambdas as well, so the kernels should not use lambdas calling intrinsics.
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+# define CADR_SIMD_DISPATCH
+# define CADR_TARGET_AVX2 __attribute__((target("avx2")))
+# define CADR_TARGET_SSE41 __attribute__((target("sse4.1")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+# define CADR_SIMD_DISPATCH
+# define CADR_TARGET_AVX2
+# define CADR_TARGET_SSE41
+#endif
+
+namespace CadR {
+namespace CpuFeatures {
+
+
+bool hasAvx2();  ///< Returns true if the CPU and the operating system support AVX2 instructions. The detection is performed on the first call only.
+bool hasSse41();  ///< Returns true if the CPU supports SSE4.1 instructions. The detection is performed on the first call only.
+
+
+}
+}
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2023-2025 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2023-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
@@ -55,6 +55,7 @@ DataMemory::DataMemory(DataStorage& dataStorage, size_t size)
 				vk::BufferCreateFlags(),  // flags
 				size,  // size
 				vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress |  // usage
+					vk::BufferUsageFlagBits::eIndexBuffer |  // indexed draws bind the buffer as index buffer, see StateSet::indexType
 					vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst,
 				vk::SharingMode::eExclusive,  // sharingMode
 				0,  // queueFamilyIndexCount
@@ -146,6 +147,7 @@ DataMemory* DataMemory::tryCreate(DataStorage& dataStorage, size_t size)
 				vk::BufferCreateFlags(),  // flags
 				size,  // size
 				vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress |  // usage
+					vk::BufferUsageFlagBits::eIndexBuffer |  // indexed draws bind the buffer as index buffer, see StateSet::indexType
 					vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst,
 				vk::SharingMode::eExclusive,  // sharingMode
 				0,  // queueFamilyIndexCount
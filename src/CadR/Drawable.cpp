@@ -26,9 +26,10 @@ void Drawable::destroy() noexcept
 {
 	if(_indexIntoStateSet != ~0u) {
 		_stateSet->removeDrawableInternal(*this);
-		_drawableListHook.unlink();
 		_indexIntoStateSet = ~0u;
 	}
+	_drawableListHook.unlink();
+	_geometry = nullptr;
 }
 
 
@@ -38,6 +39,7 @@ Drawable::Drawable(Geometry& geometry, uint32_t primitiveSetOffset,
 {
 	// register in Geometry's drawable list
 	geometry._drawableList.push_back(*this);  // initializes _drawableListHook
+	_geometry = &geometry;
 
 	// append into StateSet
 	// (it initializes _stateSet and _indexIntoStateSet)
@@ -61,6 +63,7 @@ Drawable::Drawable(Geometry& geometry, uint32_t primitiveSetOffset, MatrixList&
 {
 	// register in Geometry's drawable list
 	geometry._drawableList.push_back(*this);  // initializes _drawableListHook
+	_geometry = &geometry;
 
 	// append into StateSet
 	// (it initializes _stateSet and _indexIntoStateSet)
@@ -79,28 +82,44 @@ Drawable::Drawable(Geometry& geometry, uint32_t primitiveSetOffset, MatrixList&
 
 
 Drawable::Drawable(Drawable&& other) noexcept
-	: _stateSet(other._stateSet)
+	: _geometry(other._geometry)
+	, _stateSet(other._stateSet)
 	, _matrixList(other._matrixList)
 	, _drawableData(other._drawableData)
 	, _indexIntoStateSet(other._indexIntoStateSet)
-	, _drawableListHook(std::move(other._drawableListHook))
 {
-	_stateSet->_drawablePtrList[_indexIntoStateSet] = this;
-	other._indexIntoStateSet = ~0;
+	// take the place of other in Geometry's drawable list
+	// (moved or copied auto_unlink hook is not linked, so the nodes are swapped)
+	_drawableListHook.swap_nodes(other._drawableListHook);
+	other._geometry = nullptr;
+
+	if(_indexIntoStateSet != ~0u) {
+		_stateSet->_drawablePtrList[_indexIntoStateSet] = this;
+		other._indexIntoStateSet = ~0;
+	}
 }
 
 
 Drawable& Drawable::operator=(Drawable&& rhs) noexcept
 {
+	if(this == &rhs)
+		return *this;
 	if(_indexIntoStateSet != ~0u)
 		_stateSet->removeDrawableInternal(*this);
+	_geometry = rhs._geometry;
 	_stateSet = rhs._stateSet;
 	_matrixList = rhs._matrixList;
 	_drawableData = rhs._drawableData;
 	_indexIntoStateSet = rhs._indexIntoStateSet;
-	_stateSet->_drawablePtrList[_indexIntoStateSet] = this;
-	rhs._indexIntoStateSet = ~0;
-	_drawableListHook = std::move(rhs._drawableListHook);
+	if(_indexIntoStateSet != ~0u) {
+		_stateSet->_drawablePtrList[_indexIntoStateSet] = this;
+		rhs._indexIntoStateSet = ~0;
+	}
+
+	// take the place of rhs in Geometry's drawable list
+	_drawableListHook.unlink();
+	_drawableListHook.swap_nodes(rhs._drawableListHook);
+	rhs._geometry = nullptr;
 	return *this;
 }
 
@@ -109,7 +128,9 @@ void Drawable::create(Geometry& geometry, uint32_t primitiveSetOffset, MatrixLis
                       DataAllocation* drawableData, StateSet& stateSet)
 {
 	// bind with new geometry
+	_drawableListHook.unlink();
 	geometry._drawableList.push_back(*this);
+	_geometry = &geometry;
 
 	// set members
 	_matrixList = &matrixList;
@@ -36,7 +36,7 @@ struct DrawableGpuData {
 	uint64_t drawableDataHandle;
 	uint64_t primitiveSetHandle;
 	uint32_t primitiveSetOffset;
-	uint32_t padding;
+	uint32_t indexOffset;  ///< Offset of index data in the index buffer in number of indices. It is written by StateSet when indexed draw is recorded. Otherwise, it is ~0 meaning that the shaders fetch the indices themselves.
 
 	DrawableGpuData()  {}
 	inline constexpr DrawableGpuData(uint64_t vertexDataHandle, uint64_t indexDataHandle, uint64_t matrixListHandle, uint64_t drawableDataHandle, uint64_t primitiveSetHandle, uint32_t primitiveSetOffset);
@@ -50,6 +50,7 @@ struct DrawableGpuData {
  */
 class CADR_EXPORT Drawable {
 protected:
+	Geometry* _geometry = nullptr;  ///< Geometry rendered by this Drawable. It is used to find index buffer of indexed draws, see StateSet::indexType.
 	StateSet* _stateSet;  ///< StateSet that draws this Drawable. The drawable is drawn if _indexIntoStateSet is valid (any value except ~0). If _indexIntoStateSet is not valid, _stateSet variable keeps the last value that was written there allowing easy re-association with the StateSet when valid value of _indexIntoStateSet is set again.
 	MatrixList* _matrixList;
 	DataAllocation* _drawableData;
@@ -84,13 +85,16 @@ public:
 	                   DataAllocation& drawableData, StateSet& stateSet);
 	void destroy() noexcept;
 	inline bool isValid() const;
+	inline void setPrimitiveSetOffset(uint32_t primitiveSetOffset);  ///< Switches the Drawable to another PrimitiveSet of the same Geometry, for example, to another level of detail. The Drawable must be valid.
 
 	// getters
 	inline Renderer& renderer() const;
+	inline Geometry* geometry() const;
 	inline StateSet& stateSet() const;
 	inline MatrixList& matrixList() const;
 	inline DataAllocation* drawableData() const;
 
+	friend Geometry;
 	friend StateSet;
 };
 
@@ -119,14 +123,16 @@ typedef boost::intrusive::list<
 namespace CadR {
 
 inline constexpr DrawableGpuData::DrawableGpuData(uint64_t vertexDataHandle_, uint64_t indexDataHandle_, uint64_t matrixListHandle_, uint64_t drawableDataHandle_, uint64_t primitiveSetHandle_, uint32_t primitiveSetOffset_)
-	: vertexDataHandle(vertexDataHandle_), indexDataHandle(indexDataHandle_), matrixListHandle(matrixListHandle_), drawableDataHandle(drawableDataHandle_), primitiveSetHandle(primitiveSetHandle_), primitiveSetOffset(primitiveSetOffset_), padding(0) {}
+	: vertexDataHandle(vertexDataHandle_), indexDataHandle(indexDataHandle_), matrixListHandle(matrixListHandle_), drawableDataHandle(drawableDataHandle_), primitiveSetHandle(primitiveSetHandle_), primitiveSetOffset(primitiveSetOffset_), indexOffset(~0u) {}
 
 inline Drawable::Drawable(MatrixList* matrixList, DataAllocation* drawableData)  : _matrixList(matrixList), _drawableData(drawableData) {}
 inline bool Drawable::isValid() const  { return _indexIntoStateSet!=~0u; }
+inline void Drawable::setPrimitiveSetOffset(uint32_t primitiveSetOffset)  { _stateSet->_drawableDataList[_indexIntoStateSet].primitiveSetOffset = primitiveSetOffset; }
 inline void Drawable::create(Geometry& geometry, uint32_t primitiveSetOffset, MatrixList& matrixList, StateSet& stateSet)  { create(geometry, primitiveSetOffset, matrixList, nullptr, stateSet); }
 inline void Drawable::create(Geometry& geometry, uint32_t primitiveSetOffset, MatrixList& matrixList, DataAllocation& drawableData, StateSet& stateSet)  { create(geometry, primitiveSetOffset, matrixList, &drawableData, stateSet); }
 
 inline Renderer& Drawable::renderer() const  { return _stateSet->renderer(); }
+inline Geometry* Drawable::geometry() const  { return _geometry; }
 inline StateSet& Drawable::stateSet() const  { return *_stateSet; }
 inline MatrixList& Drawable::matrixList() const  { return *_matrixList; }
 inline DataAllocation* Drawable::drawableData() const  { return _drawableData; }
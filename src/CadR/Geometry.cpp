@@ -1,8 +1,48 @@
-// SPDX-FileCopyrightText: 2020-2024 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2020-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
 #include <CadR/Geometry.h>
+#include <CadR/Drawable.h>
 
 using namespace std;
 using namespace CadR;
+
+
+
+Geometry::Geometry(Geometry&& other) noexcept
+	: _vertices(std::move(other._vertices))
+	, _indices(std::move(other._indices))
+	, _primitiveSets(std::move(other._primitiveSets))
+	, _drawableList(std::move(other._drawableList))
+{
+	// update Drawable's geometry pointers
+	for(Drawable& d : _drawableList)
+		d._geometry = this;
+}
+
+
+Geometry::~Geometry() noexcept
+{
+	// Drawables might outlive the Geometry,
+	// so reset their geometry pointers
+	for(Drawable& d : _drawableList)
+		d._geometry = nullptr;
+}
+
+
+Geometry& Geometry::operator=(Geometry&& rhs) noexcept
+{
+	_vertices = std::move(rhs._vertices);
+	_indices = std::move(rhs._indices);
+	_primitiveSets = std::move(rhs._primitiveSets);
+
+	// drawable lists are swapped by move assignment,
+	// so update geometry pointers of both lists
+	_drawableList = std::move(rhs._drawableList);
+	for(Drawable& d : _drawableList)
+		d._geometry = this;
+	for(Drawable& d : rhs._drawableList)
+		d._geometry = &rhs;
+	return *this;
+}
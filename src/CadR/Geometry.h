@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2020-2025 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2020-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
@@ -46,12 +46,12 @@ public:
 	// construction and destruction
 	inline Geometry(Renderer& r);  ///< Constructs the object without allocating or reserving any memory.
 	Geometry(const Geometry&) = delete;  ///< No copy constructor.
-	Geometry(Geometry&& other) = default;  ///< Move constructor.
-	inline ~Geometry();  ///< Destructor.
+	Geometry(Geometry&& other) noexcept;  ///< Move constructor.
+	~Geometry() noexcept;  ///< Destructor.
 
 	// operators
 	Geometry& operator=(const Geometry&) = delete;  ///< No copy assignment.
-	Geometry& operator=(Geometry&& rhs) = default;  ///< Move assignment operator.
+	Geometry& operator=(Geometry&& rhs) noexcept;  ///< Move assignment operator.
 
 	// getters
 	inline Renderer& renderer() const;
@@ -100,7 +100,6 @@ public:
 namespace CadR {
 
 inline Geometry::Geometry(Renderer& r) : _vertices(r.dataStorage()), _indices(r.dataStorage()), _primitiveSets(r.dataStorage())  {}
-inline Geometry::~Geometry()  {}
 
 inline Renderer& Geometry::renderer() const  { return _vertices.dataStorage().renderer(); }
 inline DataStorage& Geometry::dataStorage() const  { return _vertices.dataStorage(); }
@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#include <CadR/GeometryMerger.h>
+#include <CadR/Exceptions.h>
+#include <CadR/Geometry.h>
+#include <CadR/PrimitiveSet.h>
+#include <CadR/StagingData.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+using namespace CadR;
+
+
+uint32_t GeometryMerger::append(uint32_t numVertices, uint32_t numIndices)
+{
+	if(!canAppend(numVertices, numIndices))
+		throw LogicError("GeometryMerger::append(): Primitive does not fit into the merged Geometry.");
+
+	uint32_t subDrawIndex = uint32_t(_subDrawList.size());
+	_subDrawList.emplace_back(SubDraw{
+		.firstVertex = _numVertices,
+		.numVertices = numVertices,
+		.firstIndex = _numIndices,
+		.numIndices = numIndices,
+	});
+	_numVertices += numVertices;
+	_numIndices += numIndices;
+	return subDrawIndex;
+}
+
+
+GeometryMerger::StagingPointers GeometryMerger::createStagingData(Geometry& g) const
+{
+	StagingPointers r;
+
+	// vertex data
+	StagingData sd = g.createVertexStagingData(size_t(_numVertices) * _vertexSize);
+	r.vertexData = sd.data<uint8_t>();
+
+	// index data
+	// (16-bit index data are padded to 4 bytes
+	// as the shaders read them by 32-bit words)
+	size_t numBytes = size_t(_numIndices) * (_use16BitIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+	sd = g.createIndexStagingData((numBytes + 3) & ~size_t(3));
+	if(numBytes & 0x3)
+		memset(sd.data<uint8_t>() + (numBytes & ~size_t(3)), 0, 4);
+	r.indexData = sd.data<uint8_t>();
+
+	// primitiveSet data
+	// (the whole Geometry followed by sub-draws)
+	sd = g.createPrimitiveSetStagingData((_subDrawList.size() + 1) * sizeof(PrimitiveSet));
+	PrimitiveSet* ps = sd.data<PrimitiveSet>();
+	ps[0] = { .indexCount = _numIndices, .startIndex = 0 };
+	for(size_t i=0, c=_subDrawList.size(); i<c; i++)
+		ps[i+1] = { .indexCount = _subDrawList[i].numIndices, .startIndex = _subDrawList[i].firstIndex };
+
+	return r;
+}
+
+
+void GeometryMerger::rebaseIndices(void* indices, size_t numIndices, bool use16BitIndices, uint32_t firstVertex)
+{
+	if(firstVertex == 0)
+		return;
+
+	if(use16BitIndices) {
+		uint16_t* p = static_cast<uint16_t*>(indices);
+		for(size_t i=0; i<numIndices; i++)
+			p[i] = uint16_t(p[i] + firstVertex);
+	}
+	else {
+		uint32_t* p = static_cast<uint32_t*>(indices);
+		for(size_t i=0; i<numIndices; i++)
+			p[i] += firstVertex;
+	}
+}
+
+
+size_t GeometryMerger::findSubDraw(uint32_t primitiveID, uint32_t numIndicesPerPrimitive) const
+{
+	// find the last sub-draw starting at or before the index
+	// (sub-draws are sorted by firstIndex as they are appended)
+	uint64_t index = uint64_t(primitiveID) * numIndicesPerPrimitive;
+	if(index >= _numIndices)
+		return ~size_t(0);
+	auto it = upper_bound(_subDrawList.begin(), _subDrawList.end(), index,
+		[](uint64_t index, const SubDraw& s) { return index < s.firstIndex; });
+	return size_t(it - _subDrawList.begin()) - 1;
+}
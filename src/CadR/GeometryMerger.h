@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef CADR_GEOMETRY_MERGER_HEADER
+# define CADR_GEOMETRY_MERGER_HEADER
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+namespace CadR {
+
+class Geometry;
+
+
+/** \brief GeometryMerger packs vertex and index data of many small primitives into a single Geometry,
+ *  so all of them are rendered by a single Drawable.
+ *
+ *  CAD exports are often composed of huge number of tiny parts. Each of them consumes
+ *  its own Geometry with three DataAllocation handles and its own Drawable with per-draw overhead.
+ *  Merging them reduces the handle count, the drawable count and the per-draw overhead together.
+ *
+ *  The merged primitives must share the vertex layout and the index type,
+ *  e.g. they are expected to be rendered by the same StateSet with the same drawable data.
+ *  PrimitiveSet does not carry vertex offset, so indices of each primitive
+ *  need to be rebased by its firstVertex (see rebaseIndices()).
+ *
+ *  PrimitiveSet at offset 0 covers all the merged primitives and it is the one used by the Drawable.
+ *  It is followed by PrimitiveSets of each merged primitive, called sub-draws here.
+ *  The sub-draw index serves as ID of the original primitive: findSubDraw() maps gl_PrimitiveID
+ *  stored in id-buffer back to the sub-draw, and the sub-draw's PrimitiveSet at primitiveSetOffset()
+ *  might be used to draw the original primitive alone, for example, for highlighting.
+ */
+class CADR_EXPORT GeometryMerger {
+public:
+
+	struct SubDraw {
+		uint32_t firstVertex;
+		uint32_t numVertices;
+		uint32_t firstIndex;
+		uint32_t numIndices;
+	};
+
+	struct StagingPointers {
+		uint8_t* vertexData;  ///< Start of vertex data of the whole merged Geometry.
+		uint8_t* indexData;   ///< Start of index data of the whole merged Geometry.
+	};
+
+protected:
+	uint32_t _vertexSize;
+	bool _use16BitIndices;
+	uint32_t _maxNumVertices;
+	uint32_t _numVertices = 0;
+	uint32_t _numIndices = 0;
+	std::vector<SubDraw> _subDrawList;
+public:
+
+	// construction
+	GeometryMerger(uint32_t vertexSize, bool use16BitIndices, uint32_t maxNumVertices = 0);  ///< Constructs empty merger. Zero maxNumVertices means the limit given by the index type, e.g. 0x10000 for 16-bit indices.
+
+	// merging
+	bool canAppend(size_t numVertices, size_t numIndices) const;  ///< Returns true if the primitive fits into the merged Geometry without exceeding vertex limit.
+	uint32_t append(uint32_t numVertices, uint32_t numIndices);  ///< Appends primitive and returns its sub-draw index. Call canAppend() first.
+	StagingPointers createStagingData(Geometry& g) const;  ///< Allocates vertex, index and primitiveSet data of all appended primitives in the Geometry and writes the PrimitiveSets. Vertex and index data are left to be filled by the caller, while the padding of 16-bit index data is zeroed.
+	static void rebaseIndices(void* indices, size_t numIndices, bool use16BitIndices, uint32_t firstVertex);  ///< Adds firstVertex to each index.
+
+	// picking
+	size_t findSubDraw(uint32_t primitiveID, uint32_t numIndicesPerPrimitive) const;  ///< Returns sub-draw index containing the primitive given by gl_PrimitiveID, or ~0 if it is out of range. numIndicesPerPrimitive is 3 for triangles, 2 for lines and 1 for points.
+	static constexpr uint32_t primitiveSetOffset(size_t subDrawIndex);  ///< Returns primitiveSetOffset of the sub-draw. Offset 0 is used by the PrimitiveSet of the whole merged Geometry.
+
+	// getters
+	uint32_t vertexSize() const;
+	bool use16BitIndices() const;
+	uint32_t maxNumVertices() const;
+	uint32_t numVertices() const;
+	uint32_t numIndices() const;
+	size_t numSubDraws() const;
+	const SubDraw& subDraw(size_t index) const;
+	const std::vector<SubDraw>& subDrawList() const;
+
+};
+
+
+}
+
+#endif
+
+
+// inline functions
+#if !defined(CADR_GEOMETRY_MERGER_INLINE_FUNCTIONS) && !defined(CADR_NO_INLINE_FUNCTIONS)
+# define CADR_GEOMETRY_MERGER_INLINE_FUNCTIONS
+# include <CadR/PrimitiveSet.h>
+namespace CadR {
+
+inline GeometryMerger::GeometryMerger(uint32_t vertexSize, bool use16BitIndices, uint32_t maxNumVertices)
+	: _vertexSize(vertexSize), _use16BitIndices(use16BitIndices)
+	, _maxNumVertices((maxNumVertices != 0 && (maxNumVertices <= 0x10000 || !use16BitIndices)) ? maxNumVertices : use16BitIndices ? 0x10000 : 0xffffffff)  {}
+inline bool GeometryMerger::canAppend(size_t numVertices, size_t numIndices) const  { return numVertices <= _maxNumVertices - _numVertices && numIndices <= 0xffffffff - _numIndices; }
+inline constexpr uint32_t GeometryMerger::primitiveSetOffset(size_t subDrawIndex)  { return uint32_t((subDrawIndex + 1) * sizeof(PrimitiveSet)); }
+inline uint32_t GeometryMerger::vertexSize() const  { return _vertexSize; }
+inline bool GeometryMerger::use16BitIndices() const  { return _use16BitIndices; }
+inline uint32_t GeometryMerger::maxNumVertices() const  { return _maxNumVertices; }
+inline uint32_t GeometryMerger::numVertices() const  { return _numVertices; }
+inline uint32_t GeometryMerger::numIndices() const  { return _numIndices; }
+inline size_t GeometryMerger::numSubDraws() const  { return _subDrawList.size(); }
+inline const GeometryMerger::SubDraw& GeometryMerger::subDraw(size_t index) const  { return _subDrawList[index]; }
+inline const std::vector<GeometryMerger::SubDraw>& GeometryMerger::subDrawList() const  { return _subDrawList; }
+
+}
+#endif
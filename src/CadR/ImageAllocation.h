@@ -125,6 +125,9 @@ public:
 	inline vk::Image image() const;
 	inline const vk::ImageCreateInfo& imageCreateInfo() const;
 
+	// image changed notifications
+	inline void addImageChangedCallback(ImageChangedCallback& c);  ///< Registers callback that is called whenever the image is recreated or replaced. The callback is unregistered automatically when ImageChangedCallback is destroyed.
+
 	// data update
 	inline StagingBuffer createStagingBuffer(size_t numBytes, size_t alignment);
 	inline void submit(StagingBuffer& stagingBuffer, vk::ImageLayout oldLayout, vk::ImageLayout copyLayout,
@@ -176,6 +179,7 @@ inline ImageStorage& ImageAllocation::imageStorage() const  { return _record->im
 inline Renderer& ImageAllocation::renderer() const  { return _record->imageMemory->imageStorage().renderer(); }
 inline vk::Image ImageAllocation::image() const  { return _record->image; }
 inline const vk::ImageCreateInfo& ImageAllocation::imageCreateInfo() const  { return _record->imageCreateInfo; }
+inline void ImageAllocation::addImageChangedCallback(ImageChangedCallback& c)  { _record->imageChangedCallbackList.push_back(c); }
 
 inline StagingBuffer ImageAllocation::createStagingBuffer(size_t numBytes, size_t alignment)  { return StagingBuffer(_record->imageMemory->imageStorage(), numBytes, alignment); }
 inline void ImageAllocation::submit(StagingBuffer& stagingBuffer, vk::ImageLayout oldLayout, vk::ImageLayout copyLayout, vk::ImageLayout newLayout, vk::PipelineStageFlags newLayoutBarrierStageFlags, vk::AccessFlags newLayoutBarrierAccessFlags, const vk::BufferImageCopy& region, size_t dataSize)  { stagingBuffer.submit(*this, oldLayout, copyLayout, newLayout, newLayoutBarrierStageFlags, newLayoutBarrierAccessFlags, region, dataSize); }
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2024-2025 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2024-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
@@ -161,13 +161,27 @@ bool ImageMemory::allocInternal(ImageAllocationRecord*& recPtr, size_t numBytes,
 
 size_t ImageMemory::BufferToImageUpload::record(VulkanDevice& device, vk::CommandBuffer commandBuffer)
 {
+	// source scope of oldLayout -> copyLayout barrier
+	// (undefined content does not need to wait for anything;
+	// defined content might be read by shaders, so the copy must wait for them (write-after-read hazard))
+	vk::PipelineStageFlags srcStage;
+	vk::AccessFlags srcAccessMask;
+	if(oldLayout == vk::ImageLayout::eUndefined) {
+		srcStage = vk::PipelineStageFlagBits::eTopOfPipe;
+		srcAccessMask = vk::AccessFlags();
+	}
+	else {
+		srcStage = vk::PipelineStageFlagBits::eFragmentShader;
+		srcAccessMask = vk::AccessFlagBits::eShaderRead;
+	}
+
 	if(regionCount <= 1) {
 
 		// change image layout (oldLayout -> copyLayout)
 		if(oldLayout != copyLayout)
 			device.cmdPipelineBarrier(
 				commandBuffer,  // commandBuffer
-				vk::PipelineStageFlagBits::eTopOfPipe,  // srcStage
+				srcStage,  // srcStage
 				vk::PipelineStageFlagBits::eTransfer,  // dstStage
 				vk::DependencyFlags(),  // dependencyFlags
 				0,  // memoryBarrierCount
@@ -176,7 +190,7 @@ size_t ImageMemory::BufferToImageUpload::record(VulkanDevice& device, vk::Comman
 				nullptr,  // pBufferMemoryBarriers
 				1,  // imageMemoryBarrierCount
 				&(const vk::ImageMemoryBarrier&)vk::ImageMemoryBarrier(  // pImageMemoryBarriers
-					vk::AccessFlags(),  // srcAccessMask
+					srcAccessMask,  // srcAccessMask
 					vk::AccessFlagBits::eTransferWrite,  // dstAccessMask
 					oldLayout,  // oldLayout
 					copyLayout,  // newLayout
@@ -237,7 +251,7 @@ size_t ImageMemory::BufferToImageUpload::record(VulkanDevice& device, vk::Comman
 			imageMemoryBarrierList = make_unique<vk::ImageMemoryBarrier[]>(regionCount);
 			for(size_t i=0; i<regionCount; i++) {
 				imageMemoryBarrierList[i] = {
-					vk::AccessFlags(),  // srcAccessMask
+					srcAccessMask,  // srcAccessMask
 					vk::AccessFlagBits::eTransferWrite,  // dstAccessMask
 					oldLayout,  // oldLayout
 					copyLayout,  // newLayout
@@ -257,7 +271,7 @@ size_t ImageMemory::BufferToImageUpload::record(VulkanDevice& device, vk::Comman
 			// change image layout (oldLayout -> copyLayout)
 			device.cmdPipelineBarrier(
 				commandBuffer,  // commandBuffer
-				vk::PipelineStageFlagBits::eTopOfPipe,  // srcStageMask
+				srcStage,  // srcStageMask
 				vk::PipelineStageFlagBits::eTransfer,  // dstStageMask
 				vk::DependencyFlags(),  // dependencyFlags
 				0,  // memoryBarrierCount
@@ -5,6 +5,7 @@
 #include <CadR/ImageStorage.h>
 #include <CadR/Exceptions.h>
 #include <CadR/Renderer.h>
+#include <CadR/StagingBuffer.h>
 #include <CadR/StagingManager.h>
 #include <CadR/StagingMemory.h>
 #include <CadR/TransferResources.h>
@@ -21,6 +22,10 @@ void ImageStorage::cleanUp() noexcept
 	// destroy all handles
 	//_handleTable.destroyAll();
 
+	// release atlases
+	// (it must be done before ImageMemory objects are destroyed)
+	_atlasList.clear();
+
 	// destroy ImageMemory objects
 	for(MemoryTypeManagement& mtm : _memoryTypeManagementList)
 		for(ImageMemory* im : mtm._imageMemoryList)
@@ -176,6 +181,140 @@ haveMemory:
 }
 
 
+PackedImageAllocation ImageStorage::allocPacked(vk::Format format, uint32_t width, uint32_t height, uint32_t border)
+{
+	if(!canBePacked(width, height, border))
+		throw OutOfResources("CadR::ImageStorage::allocPacked() error: Image is too large to be packed. "
+		                     "Requested size: " + to_string(width) + "x" + to_string(height) + " texels.");
+
+	uint32_t w = width + 2*border;
+	uint32_t h = height + 2*border;
+
+	// find atlas with free space
+	// (shelf packing is used: images are placed side by side into horizontal shelves;
+	// when the image does not fit into the current shelf, new shelf is started above it;
+	// only the most recent atlases are searched as the older ones are likely full)
+	Atlas* atlas = nullptr;
+	uint32_t x = 0, y = 0;
+	size_t atlasIndex = _atlasList.size();
+	for(size_t i=_atlasList.size(), numChecked=0; i>0 && numChecked<4; ) {
+		i--;
+		Atlas& a = *_atlasList[i];
+		if(a.format != format)
+			continue;
+		numChecked++;
+
+		// try current shelf
+		if(a.shelfX+w <= a.size && a.shelfY+h <= a.size && h <= a.shelfHeight) {
+			x = a.shelfX;
+			y = a.shelfY;
+			a.shelfX += w;
+			atlas = &a;
+			atlasIndex = i;
+			break;
+		}
+
+		// try new shelf
+		uint32_t newShelfY = a.shelfY + a.shelfHeight;
+		if(newShelfY+h <= a.size) {
+			x = 0;
+			y = newShelfY;
+			a.shelfX = w;
+			a.shelfY = newShelfY;
+			a.shelfHeight = h;
+			atlas = &a;
+			atlasIndex = i;
+			break;
+		}
+	}
+
+	// create new atlas
+	if(atlas == nullptr) {
+		_atlasList.emplace_back(make_unique<Atlas>(*this, format, _atlasSize));
+		atlas = _atlasList.back().get();
+		try {
+			atlas->imageAllocation.alloc(
+				vk::MemoryPropertyFlagBits::eDeviceLocal,  // requiredFlags
+				vk::ImageCreateInfo(  // imageCreateInfo
+					vk::ImageCreateFlags{},  // flags
+					vk::ImageType::e2D,  // imageType
+					format,  // format
+					vk::Extent3D(_atlasSize, _atlasSize, 1),  // extent
+					1,  // mipLevels
+					1,  // arrayLayers
+					vk::SampleCountFlagBits::e1,  // samples
+					vk::ImageTiling::eOptimal,  // tiling
+					vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,  // usage
+					vk::SharingMode::eExclusive,  // sharingMode
+					0,  // queueFamilyIndexCount
+					nullptr,  // pQueueFamilyIndices
+					vk::ImageLayout::eUndefined  // initialLayout
+				),
+				_renderer->device()  // vulkanDevice
+			);
+		} catch(...) {
+			_atlasList.pop_back();
+			throw;
+		}
+		atlasIndex = _atlasList.size() - 1;
+		x = 0;
+		y = 0;
+		atlas->shelfX = w;
+		atlas->shelfY = 0;
+		atlas->shelfHeight = h;
+	}
+
+	// return packed allocation
+	PackedImageAllocation r;
+	r.atlas = &atlas->imageAllocation;
+	r.atlasIndex = uint32_t(atlasIndex);
+	r.offset = vk::Offset2D(int32_t(x + border), int32_t(y + border));
+	r.extent = vk::Extent2D(width, height);
+	r.border = border;
+	float s = 1.f / float(atlas->size);
+	r.uvScaleAndOffset = { float(width) * s, float(height) * s, float(x + border) * s, float(y + border) * s };
+	return r;
+}
+
+
+void ImageStorage::submitPacked(StagingBuffer& stagingBuffer, const PackedImageAllocation& a,
+	vk::PipelineStageFlags newLayoutBarrierDstStages, vk::AccessFlags newLayoutBarrierDstAccessFlags)
+{
+	Atlas& atlas = *_atlasList[a.atlasIndex];
+	uint32_t w = a.extent.width + 2*a.border;
+	uint32_t h = a.extent.height + 2*a.border;
+
+	// the first upload does not need to preserve undefined content of the atlas;
+	// all following uploads preserve the content already uploaded
+	vk::ImageLayout oldLayout =
+		atlas.contentInitialized ? vk::ImageLayout::eShaderReadOnlyOptimal : vk::ImageLayout::eUndefined;
+
+	stagingBuffer.submit(
+		atlas.imageAllocation,  // ImageAllocation
+		oldLayout,  // currentLayout
+		vk::ImageLayout::eTransferDstOptimal,  // copyLayout
+		vk::ImageLayout::eShaderReadOnlyOptimal,  // newLayout
+		newLayoutBarrierDstStages,  // newLayoutBarrierDstStages
+		newLayoutBarrierDstAccessFlags,  // newLayoutBarrierDstAccessFlags
+		vk::BufferImageCopy{  // region
+			stagingBuffer.bufferOffset(),  // bufferOffset
+			w,  // bufferRowLength
+			h,  // bufferImageHeight
+			vk::ImageSubresourceLayers{  // imageSubresource
+				vk::ImageAspectFlagBits::eColor,  // aspectMask
+				0,  // mipLevel
+				0,  // baseArrayLayer
+				1,  // layerCount
+			},
+			{ a.offset.x - int32_t(a.border), a.offset.y - int32_t(a.border), 0 },  // imageOffset
+			{ w, h, 1 }  // imageExtent
+		},
+		stagingBuffer.sizeInBytes()  // dataSize
+	);
+	atlas.contentInitialized = true;
+}
+
+
 void ImageStorage::endFrame()
 {
 	_lastFrameStagingBytesTransferred = _currentFrameStagingBytesTransferred;
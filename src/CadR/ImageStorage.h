@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2024-2025 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2024-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
@@ -16,15 +16,39 @@
 #  include <CadR/ImageMemory.h>
 #  include <CadR/TransferResources.h>
 # endif
+#include <algorithm>
+#include <array>
+#include <memory>
 #include <vector>
 
 namespace CadR {
 
 class Renderer;
+class StagingBuffer;
 class StagingManager;
 class VulkanDevice;
 
 
+/** PackedImageAllocation describes small image packed into shared atlas image.
+ *
+ *  It is returned by ImageStorage::allocPacked(). The atlas image is owned by ImageStorage
+ *  and it is released in ImageStorage::cleanUp(). The packed image occupies rectangle
+ *  of the atlas given by offset and extent. The rectangle is surrounded by the border
+ *  of the given width that is used to avoid filtering artifacts on the rectangle edges.
+ *  Texture coordinates in the range 0..1 are mapped to the rectangle by uvScaleAndOffset.
+ */
+struct PackedImageAllocation {
+	ImageAllocation* atlas = nullptr;  ///< Atlas image holding the packed image.
+	uint32_t atlasIndex = ~0u;  ///< Index of the atlas image inside ImageStorage.
+	vk::Offset2D offset;  ///< Offset of the packed image inside the atlas, not including the border.
+	vk::Extent2D extent;  ///< Size of the packed image, not including the border.
+	uint32_t border = 0;  ///< Width of the border around the packed image in texels.
+	std::array<float,4> uvScaleAndOffset = { 1.f, 1.f, 0.f, 0.f };  ///< Scale (x,y) and offset (z,w) mapping texture coordinates from 0..1 range into the atlas.
+
+	inline bool isValid() const  { return atlas != nullptr; }
+};
+
+
 class CADR_EXPORT ImageStorage {
 protected:
 
@@ -47,6 +71,21 @@ protected:
 	size_t _currentFrameLargeMemoryCount = 0;
 	size_t _currentFrameSuperSizeMemoryCount = 0;
 
+	// atlas images for packing of small images
+	struct Atlas {
+		ImageAllocation imageAllocation;
+		vk::Format format;
+		uint32_t size;  ///< Width and height of the atlas image.
+		uint32_t shelfX = 0;  ///< Position of the first free texel on the current shelf.
+		uint32_t shelfY = 0;  ///< Y coordinate of the current shelf.
+		uint32_t shelfHeight = 0;  ///< Height of the current shelf.
+		bool contentInitialized = false;  ///< False until the first upload into the atlas. It allows to skip preserving of undefined content on the first upload.
+		inline Atlas(ImageStorage& storage, vk::Format format, uint32_t size) noexcept;
+	};
+	std::vector<std::unique_ptr<Atlas>> _atlasList;
+	uint32_t _atlasSize = 2048;  ///< Width and height of newly created atlas images.
+	uint32_t _maxPackedImageSize = 256;  ///< Images with width or height (including the borders) bigger than this value are not packed.
+
 	inline bool allocFromMemoryType(ImageAllocation& a, size_t numBytes, size_t alignment, uint32_t memoryTypeIndex,
 		vk::Image image, const vk::ImageCreateInfo& imageCreateInfo);
 		//< Allocates memory for the image and Vulkan handles.
@@ -95,6 +134,27 @@ public:
 	inline void free(ImageAllocation& a) noexcept;
 	StagingBuffer createStagingBuffer(size_t numBytes, size_t alignment);
 
+	// packing of small images
+	PackedImageAllocation allocPacked(vk::Format format, uint32_t width, uint32_t height, uint32_t border = 1);
+		//< Allocates space for a small image inside shared atlas image of the given format.
+		//< Many small images packed into a few atlases save per-image memory overhead and descriptors.
+		//< The default one texel border covers bilinear filtering of a single mip level only;
+		//< samplers of packed images should not use anisotropic filtering.
+		//< The space inside the atlas is never released individually. All atlases are released in cleanUp().
+		//< OutOfResources is thrown if the image is too large to be packed (see canBePacked()).
+	void submitPacked(StagingBuffer& stagingBuffer, const PackedImageAllocation& a,
+		vk::PipelineStageFlags newLayoutBarrierDstStages, vk::AccessFlags newLayoutBarrierDstAccessFlags);
+		//< Submits upload of the packed image including its border. The staging buffer must contain
+		//< tightly packed texels of (width+2*border) x (height+2*border) rectangle.
+		//< The atlas is kept in eShaderReadOnlyOptimal layout.
+	inline bool canBePacked(uint32_t width, uint32_t height, uint32_t border = 1) const;
+	inline void setPackingParameters(uint32_t atlasSize, uint32_t maxPackedImageSize);
+	inline uint32_t atlasSize() const;
+	inline uint32_t maxPackedImageSize() const;
+	inline size_t numAtlases() const;
+	inline ImageAllocation& atlas(size_t index) const;
+	inline vk::Format atlasFormat(size_t index) const;
+
 	// upload functions
 	std::tuple<TransferResources,size_t> recordUploads(vk::CommandBuffer commandBuffer);
 	void endFrame();
@@ -114,12 +174,20 @@ public:
 namespace CadR {
 
 inline bool ImageStorage::allocFromMemoryType(ImageAllocation& a, size_t numBytes, size_t alignment, uint32_t memoryTypeIndex, vk::Image image, const vk::ImageCreateInfo& imageCreateInfo)  { if(a._record->size != 0) free(a); if(!allocInternalFromMemoryType(a._record, numBytes, alignment, memoryTypeIndex)) return false; a._record->image=image; a._record->imageCreateInfo=imageCreateInfo; return true; }
+inline ImageStorage::Atlas::Atlas(ImageStorage& storage, vk::Format format_, uint32_t size_) noexcept  : imageAllocation(storage), format(format_), size(size_) {}
 inline ImageStorage::ImageStorage(Renderer& r) noexcept  : _renderer(&r), _stagingManager(nullptr)  {}
 inline ImageStorage::~ImageStorage() noexcept  { cleanUp(); }
 inline void ImageStorage::init(StagingManager& stagingManager, uint32_t memoryTypeCount)  { _stagingManager = &stagingManager; _memoryTypeManagementList.resize(memoryTypeCount); }
 inline Renderer& ImageStorage::renderer() const  { return *_renderer; }
 inline ImageAllocationRecord* ImageStorage::zeroSizeAllocationRecord() noexcept  { return &_zeroSizeAllocationRecord; }
 inline void ImageStorage::free(ImageAllocation& a) noexcept  { a.free(); }
+inline bool ImageStorage::canBePacked(uint32_t width, uint32_t height, uint32_t border) const  { return width+2*border <= _maxPackedImageSize && height+2*border <= _maxPackedImageSize; }
+inline void ImageStorage::setPackingParameters(uint32_t atlasSize, uint32_t maxPackedImageSize)  { _atlasSize = atlasSize; _maxPackedImageSize = std::min(maxPackedImageSize, atlasSize); }
+inline uint32_t ImageStorage::atlasSize() const  { return _atlasSize; }
+inline uint32_t ImageStorage::maxPackedImageSize() const  { return _maxPackedImageSize; }
+inline size_t ImageStorage::numAtlases() const  { return _atlasList.size(); }
+inline ImageAllocation& ImageStorage::atlas(size_t index) const  { return _atlasList[index]->imageAllocation; }
+inline vk::Format ImageStorage::atlasFormat(size_t index) const  { return _atlasList[index]->format; }
 
 }
 #endif
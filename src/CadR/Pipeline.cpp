@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2020 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2020-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
@@ -6,4 +6,29 @@
 #include <CadR/Renderer.h>
 #include <CadR/VulkanDevice.h>
 
+using namespace std;
 using namespace CadR;
+
+
+void Pipeline::recordShaderObjects(vk::CommandBuffer commandBuffer, VulkanDevice& device) const
+{
+	// bind shaders
+	// (tessellation stages are unbound and geometry stage is unbound if there is no geometry shader)
+	array<vk::ShaderEXT,shaderObjectStages.size()> shaders{
+		_shaderObjectList[0],  // vertex
+		nullptr,  // tessellation control
+		nullptr,  // tessellation evaluation
+		_shaderObjectList[1],  // geometry
+		_shaderObjectList[2],  // fragment
+	};
+	device.cmdBindShadersEXT(
+		commandBuffer,  // commandBuffer
+		uint32_t(shaderObjectStages.size()),  // stageCount
+		shaderObjectStages.data(),  // pStages
+		shaders.data()  // pShaders
+	);
+
+	// record dynamic state
+	if(_dynamicStateFunc)
+		_dynamicStateFunc(commandBuffer, device);
+}
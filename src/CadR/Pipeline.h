@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2020-2025 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2020-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
@@ -6,6 +6,8 @@
 # define CADR_PIPELINE_HEADER
 
 # include <vulkan/vulkan.hpp>
+# include <array>
+# include <functional>
 
 namespace CadR {
 
@@ -17,6 +19,8 @@ protected:
 	vk::Pipeline _pipeline;
 	vk::PipelineLayout _pipelineLayout;
 	const std::vector<vk::DescriptorSetLayout>* _descriptorSetLayoutList = nullptr;
+	std::array<vk::ShaderEXT,3> _shaderObjectList = {};  ///< Vertex, geometry and fragment shader objects used instead of _pipeline when VK_EXT_shader_object is used. Geometry shader might be null.
+	std::function<void(vk::CommandBuffer, VulkanDevice&)> _dynamicStateFunc;  ///< Function recording all the state that shader objects take from Vulkan dynamic state.
 public:
 
 	// construction and destruction
@@ -29,11 +33,22 @@ public:
 	// set functions
 	inline void init(vk::Pipeline pipeline, vk::PipelineLayout pipelineLayout, const std::vector<vk::DescriptorSetLayout>* descriptorSetLayoutList) noexcept;
 	inline void set(vk::Pipeline pipeline) noexcept;
+	inline void setShaderObjects(vk::ShaderEXT vertexShader, vk::ShaderEXT geometryShader, vk::ShaderEXT fragmentShader) noexcept;
+	inline void setDynamicStateFunc(std::function<void(vk::CommandBuffer, VulkanDevice&)>&& dynamicStateFunc);
+
+	// shader objects
+	static constexpr const std::array<vk::ShaderStageFlagBits,5> shaderObjectStages{
+		vk::ShaderStageFlagBits::eVertex, vk::ShaderStageFlagBits::eTessellationControl,
+		vk::ShaderStageFlagBits::eTessellationEvaluation, vk::ShaderStageFlagBits::eGeometry,
+		vk::ShaderStageFlagBits::eFragment };  ///< Stages bound by recordShaderObjects(). Tessellation stages are always unbound.
+	inline bool usesShaderObjects() const;
+	void recordShaderObjects(vk::CommandBuffer commandBuffer, VulkanDevice& device) const;  ///< Binds shader objects and records dynamic state. It is used instead of binding vk::Pipeline when VK_EXT_shader_object is used.
 
 	// getters
 	inline vk::Pipeline get() const;
 	inline vk::PipelineLayout layout() const;
 	inline const std::vector<vk::DescriptorSetLayout>& descriptorSetLayoutList() const;
+	inline const std::array<vk::ShaderEXT,3>& shaderObjectList() const;
 
 };
 
@@ -58,10 +73,15 @@ inline void Pipeline::destroyDescriptorSetLayouts(VulkanDevice& device) noexcept
 
 inline void Pipeline::init(vk::Pipeline pipeline, vk::PipelineLayout pipelineLayout, const std::vector<vk::DescriptorSetLayout>* descriptorSetLayoutList) noexcept  { _pipeline=pipeline; _pipelineLayout=pipelineLayout; _descriptorSetLayoutList=descriptorSetLayoutList; }
 inline void Pipeline::set(vk::Pipeline pipeline) noexcept  { _pipeline=pipeline; }
+inline void Pipeline::setShaderObjects(vk::ShaderEXT vertexShader, vk::ShaderEXT geometryShader, vk::ShaderEXT fragmentShader) noexcept  { _shaderObjectList={ vertexShader, geometryShader, fragmentShader }; }
+inline void Pipeline::setDynamicStateFunc(std::function<void(vk::CommandBuffer, VulkanDevice&)>&& dynamicStateFunc)  { _dynamicStateFunc=std::move(dynamicStateFunc); }
+
+inline bool Pipeline::usesShaderObjects() const  { return bool(_shaderObjectList[0]); }
 
 inline vk::Pipeline Pipeline::get() const  { return _pipeline; }
 inline vk::PipelineLayout Pipeline::layout() const  { return _pipelineLayout; }
 inline const std::vector<vk::DescriptorSetLayout>& Pipeline::descriptorSetLayoutList() const  { return *_descriptorSetLayoutList; }
+inline const std::array<vk::ShaderEXT,3>& Pipeline::shaderObjectList() const  { return _shaderObjectList; }
 
 }
 #endif
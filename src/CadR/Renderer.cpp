@@ -8,9 +8,15 @@
 #include <CadR/ImageStorage.h>
 #include <CadR/StagingManager.h>
 #include <CadR/StateSet.h>
+#include <CadR/Texture.h>
 #include <CadR/TransferResources.h>
 #include <CadR/VulkanDevice.h>
 #include <CadR/VulkanInstance.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
 
 using namespace std;
 using namespace CadR;
@@ -60,6 +66,94 @@ Renderer* Renderer::_defaultRenderer = nullptr;
 static inline double getCpuTimestampPeriod();
 
 
+// pipeline cache file
+// (the file header identifies the device and the driver that produced the data;
+// the data itself start by VkPipelineCacheHeaderVersionOne that is validated as well)
+struct PipelineCacheFileHeader {
+	char magic[8];
+	uint32_t headerSize;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	uint64_t dataSize;
+	uint64_t dataHash;
+};
+
+static PipelineCacheFileHeader createPipelineCacheFileHeader(uint32_t vendorID, uint32_t deviceID, uint32_t driverVersion,
+                                                             const uint8_t* pipelineCacheUUID)
+{
+	PipelineCacheFileHeader h{ { 'C', 'a', 'd', 'R', 'P', 'L', 'C', '1' }, uint32_t(sizeof(PipelineCacheFileHeader)),
+	                           vendorID, deviceID, driverVersion, {}, 0, 0 };
+	memcpy(h.pipelineCacheUUID, pipelineCacheUUID, VK_UUID_SIZE);
+	return h;
+}
+
+static uint64_t hashPipelineCacheData(const uint8_t* data, size_t size)
+{
+	// FNV-1a like hash processing 8 bytes at once;
+	// it serves only for detection of damaged files
+	uint64_t h = 0xcbf29ce484222325 ^ size;
+	size_t i = 0;
+	for(; i+8<=size; i+=8) {
+		uint64_t w;
+		memcpy(&w, data+i, 8);
+		h = (h ^ w) * 0x100000001b3;
+		h ^= h >> 29;
+	}
+	for(; i<size; i++)
+		h = (h ^ data[i]) * 0x100000001b3;
+	return h;
+}
+
+static bool isVulkanPipelineCacheHeaderValid(const vector<uint8_t>& data, const PipelineCacheFileHeader& expectedHeader)
+{
+	// VkPipelineCacheHeaderVersionOne
+	// (headerSize, headerVersion, vendorID, deviceID and pipelineCacheUUID)
+	constexpr size_t vulkanHeaderSize = 4*sizeof(uint32_t) + VK_UUID_SIZE;
+	if(data.size() < vulkanHeaderSize)
+		return false;
+	uint32_t v[4];
+	memcpy(v, data.data(), sizeof(v));
+	return v[0] >= vulkanHeaderSize && v[0] <= data.size() &&
+	       v[1] == uint32_t(VK_PIPELINE_CACHE_HEADER_VERSION_ONE) &&
+	       v[2] == expectedHeader.vendorID && v[3] == expectedHeader.deviceID &&
+	       memcmp(data.data() + sizeof(v), expectedHeader.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+static const char* readPipelineCacheFile(const filesystem::path& path, const PipelineCacheFileHeader& expectedHeader,
+                                         size_t maxSize, vector<uint8_t>& data)
+{
+	// read and validate the header
+	ifstream f(path, ios::in | ios::binary);
+	if(!f)
+		return "not found";
+	PipelineCacheFileHeader h;
+	f.read(reinterpret_cast<char*>(&h), sizeof(h));
+	if(!f || memcmp(h.magic, expectedHeader.magic, sizeof(h.magic)) != 0 || h.headerSize != expectedHeader.headerSize)
+		return "invalid header";
+	if(h.vendorID != expectedHeader.vendorID || h.deviceID != expectedHeader.deviceID)
+		return "device mismatch";
+	if(h.driverVersion != expectedHeader.driverVersion)
+		return "driver mismatch";
+	if(memcmp(h.pipelineCacheUUID, expectedHeader.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		return "cache UUID mismatch";
+	if(h.dataSize > maxSize)
+		return "size limit exceeded";
+
+	// read and validate the data
+	data.resize(size_t(h.dataSize));
+	f.read(reinterpret_cast<char*>(data.data()), data.size());
+	if(!f || hashPipelineCacheData(data.data(), data.size()) != h.dataHash ||
+	   !isVulkanPipelineCacheHeaderValid(data, expectedHeader))
+	{
+		data.clear();
+		return "corrupted data";
+	}
+	return "loaded";
+}
+
+
 
 Renderer::Renderer(bool makeDefault) noexcept
 	: _device(nullptr)
@@ -103,6 +197,9 @@ void Renderer::init(VulkanDevice& device, VulkanInstance& instance, vk::Physical
 	if(makeDefault)
 		Renderer::set(*this);
 
+	auto initStartTime = chrono::steady_clock::now();
+	_startupInfo = {};
+
 	_device = &device;
 	_graphicsQueueFamily = graphicsQueueFamily;
 	_graphicsQueue = _device->getQueue(_graphicsQueueFamily, 0);
@@ -139,6 +236,12 @@ void Renderer::init(VulkanDevice& device, VulkanInstance& instance, vk::Physical
 	if((nonCoherentAtomSize & _nonCoherentAtom_addition) != 0)  // is it power of two?
 		throw LogicError("Platform problem: nonCoherentAtomSize is not power of two.");
 
+	// device identification for pipeline cache validation
+	_vendorID = p.vendorID;
+	_deviceID = p.deviceID;
+	_driverVersion = p.driverVersion;
+	memcpy(_pipelineCacheUUID.data(), p.pipelineCacheUUID.data(), VK_UUID_SIZE);
+
 	// timestamp periods
 	_gpuTimestampPeriod = p.limits.timestampPeriod * 1e-9f;
 	_cpuTimestampPeriod = getCpuTimestampPeriod();
@@ -194,14 +297,48 @@ void Renderer::init(VulkanDevice& device, VulkanInstance& instance, vk::Physical
 				processDrawablesL3ShaderSpirv  // pCode
 			)
 		);
-	_pipelineCache =
-		_device->createPipelineCache(
-			vk::PipelineCacheCreateInfo(
-				vk::PipelineCacheCreateFlags(),  // flags
-				0,       // initialDataSize
-				nullptr  // pInitialData
-			)
-		);
+
+	// pipeline cache
+	// (restore its content from _pipelineCacheFile if it was produced by the same device and driver;
+	// if the driver refuses the data, empty cache is created)
+	auto t1 = chrono::steady_clock::now();
+	vector<uint8_t> pipelineCacheData;
+	if(!_pipelineCacheFile.empty())
+		_startupInfo.pipelineCacheStatus =
+			readPipelineCacheFile(
+				_pipelineCacheFile,
+				createPipelineCacheFileHeader(_vendorID, _deviceID, _driverVersion, _pipelineCacheUUID.data()),
+				_pipelineCacheMaxSize,
+				pipelineCacheData
+			);
+	if(!pipelineCacheData.empty()) {
+		try {
+			_pipelineCache =
+				_device->createPipelineCache(
+					vk::PipelineCacheCreateInfo(
+						vk::PipelineCacheCreateFlags(),  // flags
+						pipelineCacheData.size(),  // initialDataSize
+						pipelineCacheData.data()  // pInitialData
+					)
+				);
+			_startupInfo.pipelineCacheLoadedSize = pipelineCacheData.size();
+		}
+		catch(vk::Error&) {
+			_startupInfo.pipelineCacheStatus = "rejected by driver";
+		}
+	}
+	if(!_pipelineCache)
+		_pipelineCache =
+			_device->createPipelineCache(
+				vk::PipelineCacheCreateInfo(
+					vk::PipelineCacheCreateFlags(),  // flags
+					0,       // initialDataSize
+					nullptr  // pInitialData
+				)
+			);
+	auto t2 = chrono::steady_clock::now();
+	_startupInfo.pipelineCacheLoadTime = chrono::duration<double>(t2 - t1).count();
+
 	_processDrawablesPipelineLayout =
 		_device->createPipelineLayout(
 			vk::PipelineLayoutCreateInfo{
@@ -216,12 +353,12 @@ void Renderer::init(VulkanDevice& device, VulkanInstance& instance, vk::Physical
 				}
 			}
 		);
+	t1 = chrono::steady_clock::now();
 	for(size_t i=0; i<3; i++)
 	{
 		_processDrawablesPipelineList[i] =
 			_device->createComputePipeline(
-				//_pipelineCache,  // pipelineCache
-				nullptr,
+				_pipelineCache,  // pipelineCache
 				vk::ComputePipelineCreateInfo(  // createInfo
 					vk::PipelineCreateFlagBits::eDispatchBase,  // flags
 					vk::PipelineShaderStageCreateInfo(  // stage
@@ -237,6 +374,7 @@ void Renderer::init(VulkanDevice& device, VulkanInstance& instance, vk::Physical
 				)
 			);
 	}
+	_startupInfo.processDrawablesPipelinesTime = chrono::duration<double>(chrono::steady_clock::now() - t1).count();
 
 	// transientCommandPool and uploadingCommandBuffer
 	_transientCommandPool =
@@ -310,6 +448,8 @@ void Renderer::init(VulkanDevice& device, VulkanInstance& instance, vk::Physical
 				vk::QueryPipelineStatisticFlags()  // pipelineStatistics
 			)
 		);
+
+	_startupInfo.initTime = chrono::duration<double>(chrono::steady_clock::now() - initStartTime).count();
 }
 
 
@@ -331,8 +471,15 @@ void Renderer::finalize()
 		_device->destroy(_processDrawablesPipelineList[i]);
 		_processDrawablesPipelineList[i] = nullptr;
 	}
+	savePipelineCache();
 	_device->destroy(_pipelineCache);
 	_pipelineCache = nullptr;
+	for(auto& [createInfo, sampler] : _samplerCache)
+		_device->destroy(sampler);
+	_samplerCache.clear();
+	for(auto& [frameNumber, imageView] : _retiredImageViewList)
+		_device->destroy(imageView);
+	_retiredImageViewList.clear();
 	_device->destroy(_frameInfoTimestampPool);
 	_frameInfoTimestampPool = nullptr;
 
@@ -376,12 +523,72 @@ void Renderer::finalize()
 }
 
 
+void Renderer::setPipelineCacheFile(const filesystem::path& path, size_t maxSize)
+{
+	_pipelineCacheFile = path;
+	_pipelineCacheMaxSize = maxSize;
+}
+
+
+bool Renderer::savePipelineCache()
+{
+	if(_pipelineCacheFile.empty() || !_pipelineCache)
+		return false;
+
+	// get pipeline cache data
+	// (the cache might grow between the two calls, so eIncomplete results in another attempt)
+	vector<uint8_t> data;
+	vk::Result r;
+	do {
+		size_t size;
+		if(_device->getPipelineCacheData(_pipelineCache, &size, nullptr) != vk::Result::eSuccess)
+			return false;
+		if(size > _pipelineCacheMaxSize)
+			return false;
+		data.resize(size);
+		r = _device->getPipelineCacheData(_pipelineCache, &size, data.data());
+		data.resize(size);
+	} while(r == vk::Result::eIncomplete);
+	if(r != vk::Result::eSuccess)
+		return false;
+
+	// write into temporary file and rename it,
+	// so the readers never see partially written file
+	PipelineCacheFileHeader h =
+		createPipelineCacheFileHeader(_vendorID, _deviceID, _driverVersion, _pipelineCacheUUID.data());
+	h.dataSize = data.size();
+	h.dataHash = hashPipelineCacheData(data.data(), data.size());
+	filesystem::path tmpPath = _pipelineCacheFile;
+	tmpPath += ".tmp";
+	{
+		ofstream f(tmpPath, ios::out | ios::binary | ios::trunc);
+		f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+		f.write(reinterpret_cast<const char*>(data.data()), data.size());
+		f.close();
+		if(!f) {
+			error_code ec;
+			filesystem::remove(tmpPath, ec);
+			return false;
+		}
+	}
+	error_code ec;
+	filesystem::rename(tmpPath, _pipelineCacheFile, ec);
+	if(ec) {
+		filesystem::remove(tmpPath, ec);
+		return false;
+	}
+	return true;
+}
+
+
 void Renderer::leakResources()
 {
 	// release storage and staging resources before we assign nullptr to _device
 	_dataStorage.cleanUp();
 	_imageStorage.cleanUp();
 	_stagingManager.cleanUp();
+	_samplerCache.clear();
+	_retiredImageViewList.clear();
 
 	_device = nullptr;
 }
@@ -396,6 +603,26 @@ size_t Renderer::beginFrame()
 	_currentFrameUploadBytes = 0;
 	_dataStorage.setStagingDataSizeHint(_lastFrameUploadBytes);
 
+	// update descriptors of changed Textures
+	flushDescriptorUpdates();
+
+	// destroy retired image views;
+	// image view retired during frame n was referenced by descriptors until the flush at the beginning of frame n+1,
+	// so it might be used by frame n that is known to be finished at the beginning of frame n+2
+	// (frame number of views retired before the first frame is -1, so they are destroyed at the beginning of frame 1)
+	if(!_retiredImageViewList.empty()) {
+		auto it =
+			remove_if(_retiredImageViewList.begin(), _retiredImageViewList.end(),
+				[this](const tuple<size_t, vk::ImageView>& item) {
+					if(get<0>(item) + 2 > _frameNumber)
+						return false;
+					_device->destroy(get<1>(item));
+					return true;
+				}
+			);
+		_retiredImageViewList.erase(it, _retiredImageViewList.end());
+	}
+
 	// collect frame statistics
 	if(_collectFrameInfo) {
 
@@ -414,6 +641,72 @@ size_t Renderer::beginFrame()
 }
 
 
+void Renderer::flushDescriptorUpdates()
+{
+	if(_pendingDescriptorUpdaterList.empty())
+		return;
+
+	// collect descriptor writes;
+	// writes into the same descriptor are merged and the last scheduled one wins
+	_descriptorWriteList.clear();
+	_descriptorImageInfoList.clear();
+	map<tuple<vk::DescriptorSet, uint32_t, uint32_t>, size_t> slotMap;
+	do {
+		StateSetDescriptorUpdater& u = _pendingDescriptorUpdaterList.front();
+		_pendingDescriptorUpdaterList.pop_front();
+
+		// custom update function
+		if(u.updateFunc) {
+			u.updateFunc(*u.texture);
+			continue;
+		}
+
+		vk::DescriptorImageInfo imageInfo(
+			u.texture->sampler(),  // sampler
+			u.texture->imageView(),  // imageView
+			u.imageLayout  // imageLayout
+		);
+		auto [it, inserted] =
+			slotMap.try_emplace(
+				tuple<vk::DescriptorSet, uint32_t, uint32_t>(u.descritorSet, u.dstBinding, u.dstArrayElement),
+				_descriptorWriteList.size()
+			);
+		if(!inserted) {
+			_descriptorImageInfoList[it->second] = imageInfo;
+			_descriptorWriteList[it->second].descriptorType = u.descriptorType;
+			continue;
+		}
+		_descriptorImageInfoList.emplace_back(imageInfo);
+		_descriptorWriteList.emplace_back(
+			u.descritorSet,  // dstSet
+			u.dstBinding,  // dstBinding
+			u.dstArrayElement,  // dstArrayElement
+			1,  // descriptorCount
+			u.descriptorType,  // descriptorType
+			nullptr,  // pImageInfo - set below
+			nullptr,  // pBufferInfo
+			nullptr  // pTexelBufferView
+		);
+	} while(!_pendingDescriptorUpdaterList.empty());
+
+	if(_descriptorWriteList.empty())
+		return;
+
+	// set pImageInfo pointers
+	// (_descriptorImageInfoList is not reallocated any more)
+	for(size_t i=0, c=_descriptorWriteList.size(); i<c; i++)
+		_descriptorWriteList[i].pImageInfo = &_descriptorImageInfoList[i];
+
+	// update all descriptors by a single call
+	_device->updateDescriptorSets(
+		uint32_t(_descriptorWriteList.size()),  // descriptorWriteCount
+		_descriptorWriteList.data(),  // pDescriptorWrites
+		0,  // descriptorCopyCount
+		nullptr  // pDescriptorCopies
+	);
+}
+
+
 void Renderer::beginRecording(vk::CommandBuffer commandBuffer)
 {
 	// begin command buffer recording
@@ -464,7 +757,7 @@ size_t Renderer::prepareSceneRendering(StateSet& stateSetRoot)
 		if(n < 128)
 			n = 128;
 		_drawableBufferSize = n * sizeof(DrawableGpuData);
-		size_t drawIndirectBufferSize = n * sizeof(vk::DrawIndirectCommand);
+		size_t drawIndirectBufferSize = n * drawIndirectRecordSize;
 		size_t drawablePointersBufferSize = n * drawablePointersRecordSize;
 
 		// free previous buffers (if any)
@@ -943,6 +1236,28 @@ tuple<vk::DeviceMemory, uint32_t> Renderer::allocatePointerAccessMemoryNoThrow(s
 }
 
 
+vk::Sampler Renderer::getOrCreateSampler(const vk::SamplerCreateInfo& samplerCreateInfo)
+{
+	if(samplerCreateInfo.pNext)
+		throw LogicError("Renderer::getOrCreateSampler(): samplerCreateInfo.pNext must be null.");
+
+	// return existing sampler
+	for(auto& [createInfo, sampler] : _samplerCache)
+		if(createInfo == samplerCreateInfo)
+			return sampler;
+
+	// create new sampler
+	vk::Sampler sampler = _device->createSampler(samplerCreateInfo);
+	try {
+		_samplerCache.emplace_back(samplerCreateInfo, sampler);
+	} catch(...) {
+		_device->destroy(sampler);
+		throw;
+	}
+	return sampler;
+}
+
+
 void Renderer::executeCopyOperations()
 {
 	// start recording
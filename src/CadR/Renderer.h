@@ -12,6 +12,7 @@
 #  include <CadR/ImageStorage.h>
 #  include <CadR/MatrixList.h>
 #  include <CadR/StagingManager.h>
+#  include <CadR/StateSet.h>
 #  undef CADR_NO_INLINE_FUNCTIONS
 # else
 #  include <CadR/DataStorage.h>
@@ -19,9 +20,11 @@
 #  include <CadR/ImageStorage.h>
 #  include <CadR/MatrixList.h>
 #  include <CadR/StagingManager.h>
+#  include <CadR/StateSet.h>
 # endif
 # include <vulkan/vulkan.hpp>
 # include <array>
+# include <filesystem>
 # include <tuple>
 
 namespace CadR {
@@ -37,6 +40,13 @@ public:
 	using RequiredFeaturesStructChain = vk::StructureChain<vk::PhysicalDeviceFeatures2,
 		vk::PhysicalDeviceVulkan11Features, vk::PhysicalDeviceVulkan12Features,
 		vk::PhysicalDeviceVulkan13Features, vk::PhysicalDeviceVulkan14Features>;
+	struct StartupInfo {  ///< Timing and pipeline cache information collected by init().
+		double initTime = 0.;  ///< Total time spent in init(), given in seconds.
+		double pipelineCacheLoadTime = 0.;  ///< Time spent by reading and validating the pipeline cache file, given in seconds.
+		double processDrawablesPipelinesTime = 0.;  ///< Time spent by creating processDrawables compute pipelines, given in seconds.
+		size_t pipelineCacheLoadedSize = 0;  ///< Size of pipeline cache data restored from the file. It is zero if nothing was restored.
+		const char* pipelineCacheStatus = "disabled";  ///< Result of pipeline cache loading, such as "loaded", "not found" or "device mismatch".
+	};
 protected:
 
 	VulkanDevice* _device = nullptr;
@@ -75,10 +85,23 @@ protected:
 	vk::Fence _fence;  ///< Fence for general synchronization.
 
 	vk::PipelineCache _pipelineCache;
+	std::filesystem::path _pipelineCacheFile;  ///< File used to restore the pipeline cache in init() and to store it in savePipelineCache(). Empty path disables the persistent pipeline cache.
+	size_t _pipelineCacheMaxSize = defaultPipelineCacheMaxSize;  ///< Maximal size of pipeline cache data that are stored in or restored from _pipelineCacheFile.
+	uint32_t _vendorID;  ///< PhysicalDeviceProperties::vendorID used to validate the pipeline cache file.
+	uint32_t _deviceID;  ///< PhysicalDeviceProperties::deviceID used to validate the pipeline cache file.
+	uint32_t _driverVersion;  ///< PhysicalDeviceProperties::driverVersion used to validate the pipeline cache file.
+	std::array<uint8_t,VK_UUID_SIZE> _pipelineCacheUUID;  ///< PhysicalDeviceProperties::pipelineCacheUUID used to validate the pipeline cache file.
+	StartupInfo _startupInfo;
 	std::array<vk::ShaderModule,3> _processDrawablesShaderList;
 	vk::PipelineLayout _processDrawablesPipelineLayout;
 	std::array<vk::Pipeline,3> _processDrawablesPipelineList;
 	vk::DescriptorPool _descriptorPool;
+	std::vector<std::tuple<vk::SamplerCreateInfo, vk::Sampler>> _samplerCache;  ///< Samplers created by getOrCreateSampler(). The number of distinct samplers is usually small, so linear search is used.
+
+	PendingDescriptorUpdaterList _pendingDescriptorUpdaterList;  ///< Descriptor updates scheduled for the next flushDescriptorUpdates() call.
+	std::vector<vk::WriteDescriptorSet> _descriptorWriteList;  ///< Helper buffer for flushDescriptorUpdates() to avoid memory reallocations.
+	std::vector<vk::DescriptorImageInfo> _descriptorImageInfoList;  ///< Helper buffer for flushDescriptorUpdates() to avoid memory reallocations.
+	std::vector<std::tuple<size_t, vk::ImageView>> _retiredImageViewList;  ///< Image views waiting for destruction by beginFrame(), together with the frame number of their retirement. See retireImageView().
 
 	size_t _frameNumber = ~size_t(0);  ///< Monotonically increasing frame number. The first frame is 0. The initial value is -1, marking pre-first frame time.
 	double _cpuTimestampPeriod;  ///< The time period of cpu timestamp begin incremented by 1. The period is given in seconds.
@@ -104,6 +127,7 @@ public:
 	static constexpr const size_t smallMemorySize = 64 << 10;  // 64KiB
 	static constexpr const size_t mediumMemorySize = 2 << 20;  // 2MiB
 	static constexpr const size_t largeMemorySize = 32 << 20;  // 32MiB
+	static constexpr const size_t defaultPipelineCacheMaxSize = 64 << 20;  // 64MiB
 
 	// general static functions
 	static inline Renderer& get();
@@ -162,6 +186,12 @@ public:
 	uint64_t getCpuTimestamp() const;  ///< Returns the cpu timestamp.
 	uint64_t getGpuTimestamp() const;  ///< Returns the gpu timestamp.
 
+	// descriptor updates
+	inline void scheduleDescriptorUpdate(StateSetDescriptorUpdater& u);  ///< Schedules the descriptor update to be performed by the next flushDescriptorUpdates() call. Scheduling the same updater more times results in a single update.
+	void flushDescriptorUpdates();  ///< Performs all scheduled descriptor updates. All the descriptor writes are submitted by a single vkUpdateDescriptorSets() call and multiple writes into the same descriptor are merged into one. The function is called automatically by beginFrame().
+	inline bool hasPendingDescriptorUpdates() const;  ///< Returns true if there are any descriptor updates waiting for flushDescriptorUpdates().
+	inline void retireImageView(vk::ImageView imageView);  ///< Schedules destruction of the image view that was replaced by a new one. The descriptors still refer to the image view until the next flushDescriptorUpdates() and the frames recorded before still use it, so the image view is destroyed by the beginFrame() that starts two frames after the current one, e.g. when the last frame using it is finished.
+
 	// storage
 	inline DataStorage& dataStorage() const;
 	inline ImageStorage& imageStorage() const;
@@ -184,6 +214,17 @@ public:
 	inline vk::CommandPool transientCommandPool() const;
 	inline vk::CommandPool precompiledCommandPool() const;
 
+	// persistent pipeline cache
+	void setPipelineCacheFile(const std::filesystem::path& path, size_t maxSize = defaultPipelineCacheMaxSize);  ///< Sets the file used to persist the pipeline cache between application runs. The cache is restored from the file in init(), so the function needs to be called before init() to take effect on the current run. The file is written by savePipelineCache() and by finalize(). The data larger than maxSize are neither stored nor restored. Empty path disables the persistent pipeline cache.
+	inline const std::filesystem::path& pipelineCacheFile() const;
+	inline size_t pipelineCacheMaxSize() const;
+	bool savePipelineCache();  ///< Stores the pipeline cache data into the file set by setPipelineCacheFile(). The file is written atomically through a temporary file, so the readers never see partially written file. Returns false if no file is set, the data exceed pipelineCacheMaxSize() or writing failed.
+	inline const StartupInfo& startupInfo() const;  ///< Returns timing and pipeline cache information collected by init().
+
+	// samplers
+	vk::Sampler getOrCreateSampler(const vk::SamplerCreateInfo& samplerCreateInfo);  ///< Returns sampler matching samplerCreateInfo. The sampler is created on the first request and shared by all subsequent requests with identical samplerCreateInfo. The sampler is owned by the Renderer and destroyed in finalize(). samplerCreateInfo.pNext must be null.
+	inline size_t numCachedSamplers() const;  ///< Returns the number of samplers created by getOrCreateSampler().
+
 	// memory
 	inline vk::DeviceMemory allocateMemoryType(size_t size, uint32_t memoryTypeIndex);
 	vk::DeviceMemory allocateMemoryTypeNoThrow(size_t size, uint32_t memoryTypeIndex) noexcept;
@@ -199,6 +240,7 @@ public:
 	void executeCopyOperations();
 
 	static constexpr uint32_t drawablePointersRecordSize = 4 * sizeof(uint64_t);
+	static constexpr uint32_t drawIndirectRecordSize = sizeof(vk::DrawIndexedIndirectCommand);  ///< Stride of drawIndirectBuffer records. Each record holds either vk::DrawIndirectCommand or vk::DrawIndexedIndirectCommand, depending on StateSet::indexType.
 
 };
 
@@ -232,6 +274,9 @@ inline bool Renderer::collectFrameInfo() const  { return _collectFrameInfo; }
 inline const FrameInfo& Renderer::getCurrentFrameInfo()  { return _inProgressFrameInfo; }
 inline double Renderer::cpuTimestampPeriod() const  { return _cpuTimestampPeriod; }
 inline float Renderer::gpuTimestampPeriod() const  { return _gpuTimestampPeriod; }
+inline void Renderer::scheduleDescriptorUpdate(StateSetDescriptorUpdater& u)  { if(!u._pendingHook.is_linked()) _pendingDescriptorUpdaterList.push_back(u); }
+inline bool Renderer::hasPendingDescriptorUpdates() const  { return !_pendingDescriptorUpdaterList.empty(); }
+inline void Renderer::retireImageView(vk::ImageView imageView)  { _retiredImageViewList.emplace_back(_frameNumber, imageView); }
 inline DataStorage& Renderer::dataStorage() const  { return _dataStorage; }
 inline ImageStorage& Renderer::imageStorage() const  { return _imageStorage; }
 inline StagingManager& Renderer::stagingManager() const  { return _stagingManager; }
@@ -244,10 +289,14 @@ inline vk::DeviceAddress Renderer::drawIndirectBufferAddress() const  { return _
 inline vk::Buffer Renderer::drawablePointersBuffer() const  { return _drawablePointersBuffer; }
 inline vk::DeviceAddress Renderer::drawablePointersBufferAddress() const  { return _drawablePointersBufferAddress; }
 inline vk::PipelineCache Renderer::pipelineCache() const  { return _pipelineCache; }
+inline const std::filesystem::path& Renderer::pipelineCacheFile() const  { return _pipelineCacheFile; }
+inline size_t Renderer::pipelineCacheMaxSize() const  { return _pipelineCacheMaxSize; }
+inline const Renderer::StartupInfo& Renderer::startupInfo() const  { return _startupInfo; }
 inline vk::Pipeline Renderer::processDrawablesPipeline(size_t handleLevel) const  { return _processDrawablesPipelineList[handleLevel-1]; }
 inline vk::PipelineLayout Renderer::processDrawablesPipelineLayout() const  { return _processDrawablesPipelineLayout; }
 inline vk::CommandPool Renderer::transientCommandPool() const  { return _transientCommandPool; }
 inline vk::CommandPool Renderer::precompiledCommandPool() const  { return _precompiledCommandPool; }
+inline size_t Renderer::numCachedSamplers() const  { return _samplerCache.size(); }
 inline vk::DeviceMemory Renderer::allocateMemoryType(size_t size, uint32_t memoryTypeIndex)  { vk::DeviceMemory m = allocateMemoryTypeNoThrow(size, memoryTypeIndex); if(!m) throw std::runtime_error("Cannot allocate memory of specified memory type."); return m; }
 inline std::tuple<vk::DeviceMemory, uint32_t> Renderer::allocateMemory(vk::Buffer buffer, vk::MemoryPropertyFlags requiredFlags)  { vk::MemoryRequirements r = _device->getBufferMemoryRequirements(buffer); return allocateMemory(r.size, r.memoryTypeBits, requiredFlags); }
 inline std::tuple<vk::DeviceMemory, uint32_t> Renderer::allocateMemory(vk::Image image, vk::MemoryPropertyFlags requiredFlags)  { vk::MemoryRequirements r = _device->getImageMemoryRequirements(image); return allocateMemory(r.size, r.memoryTypeBits, requiredFlags); }
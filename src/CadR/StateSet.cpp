@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: MIT
 
 #include <CadR/StateSet.h>
+#include <CadR/Geometry.h>
 #include <CadR/Pipeline.h>
 #include <CadR/Renderer.h>
 #include <CadR/VulkanDevice.h>
@@ -207,6 +208,8 @@ void StateSet::recordToCommandBuffer(vk::CommandBuffer commandBuffer, vk::Pipeli
 	if(pipeline) {
 		if(pipeline->get())
 			device.cmdBindPipeline(commandBuffer, vk::PipelineBindPoint::eGraphics, pipeline->get());
+		else if(pipeline->usesShaderObjects())
+			pipeline->recordShaderObjects(commandBuffer, device);
 		currentPipelineLayout = pipeline->layout();
 	}
 
@@ -227,7 +230,14 @@ void StateSet::recordToCommandBuffer(vk::CommandBuffer commandBuffer, vk::Pipeli
 		f(*this, commandBuffer, currentPipelineLayout);
 
 	size_t numDrawables = _drawableDataList.size();
-	if(numDrawables > 0) {
+	if(numDrawables > 0 && indexType != vk::IndexType::eNoneKHR) {
+
+		// indexed draws
+		recordIndexedDraws(commandBuffer, currentPipelineLayout, drawableCounter);
+		drawableCounter += numDrawables;
+
+	}
+	else if(numDrawables > 0) {
 
 		// copy drawable data
 		memcpy(
@@ -252,9 +262,9 @@ void StateSet::recordToCommandBuffer(vk::CommandBuffer commandBuffer, vk::Pipeli
 		device.cmdDrawIndirect(
 			commandBuffer,  // commandBuffer
 			_renderer->drawIndirectBuffer(),  // buffer
-			drawableCounter * sizeof(vk::DrawIndirectCommand),  // offset
+			drawableCounter * Renderer::drawIndirectRecordSize,  // offset
 			uint32_t(numDrawables),  // drawCount
-			sizeof(vk::DrawIndirectCommand)  // stride
+			Renderer::drawIndirectRecordSize  // stride
 		);
 
 		// update drawableCounter
@@ -266,3 +276,113 @@ void StateSet::recordToCommandBuffer(vk::CommandBuffer commandBuffer, vk::Pipeli
 	for(StateSet& child : childList)
 		child.recordToCommandBuffer(commandBuffer, currentPipelineLayout, drawableCounter);
 }
+
+
+/** Records indexed draws of the Drawables of this StateSet.
+ *
+ *  Index data of each Drawable are bound as index buffer. As Vulkan binds vk::Buffer
+ *  while the index data might be spread over several DataMemory objects,
+ *  the Drawables are split into runs of consecutive Drawables sharing the same DataMemory,
+ *  and each run is recorded by a single vkCmdDrawIndexedIndirect().
+ *  Offset of index data inside the DataMemory is written into DrawableGpuData::indexOffset,
+ *  so processDrawables.comp can write vk::DrawIndexedIndirectCommand of each Drawable.
+ */
+void StateSet::recordIndexedDraws(vk::CommandBuffer commandBuffer, vk::PipelineLayout currentPipelineLayout, size_t drawableCounter)
+{
+	// copy drawable data
+	size_t numDrawables = _drawableDataList.size();
+	DrawableGpuData* gpuData = &_renderer->drawableStagingData()[drawableCounter];
+	memcpy(
+		gpuData,  // dst
+		_drawableDataList.data(),  // src
+		numDrawables*sizeof(DrawableGpuData)  // size
+	);
+
+	// update address of drawable pointers
+	// (it points to the first Drawable of the StateSet as for non-indexed draws,
+	// so the shaders see the same drawable indices)
+	VulkanDevice& device = _renderer->device();
+	device.cmdPushConstants(
+		commandBuffer,  // commandBuffer
+		currentPipelineLayout,  // pipelineLayout
+		vk::ShaderStageFlagBits::eAllGraphics,  // stageFlags
+		8,  // offset
+		sizeof(uint64_t),  // size
+		array<uint64_t,1>{  // pValues
+			_renderer->drawablePointersBufferAddress() + (drawableCounter * Renderer::drawablePointersRecordSize),  // stateSetDrawablePointersPtr
+		}.data()
+	);
+
+	auto recordRun =
+		[&](vk::Buffer indexBuffer, size_t startIndex, size_t endIndex)
+		{
+			// update index of the first Drawable of the run
+			// (gl_DrawID starts from zero for each draw command;
+			// if the push constant offset of drawIndexOffset is not set,
+			// drawable pointers address is advanced to the first Drawable of the run instead)
+			if(drawIndexOffsetPushConstantOffset != ~0u)
+				device.cmdPushConstants(
+					commandBuffer,  // commandBuffer
+					currentPipelineLayout,  // pipelineLayout
+					vk::ShaderStageFlagBits::eAllGraphics,  // stageFlags
+					drawIndexOffsetPushConstantOffset,  // offset
+					sizeof(uint32_t),  // size
+					array<uint32_t,1>{  // pValues
+						uint32_t(startIndex),  // drawIndexOffset
+					}.data()
+				);
+			else if(startIndex != 0)
+				device.cmdPushConstants(
+					commandBuffer,  // commandBuffer
+					currentPipelineLayout,  // pipelineLayout
+					vk::ShaderStageFlagBits::eAllGraphics,  // stageFlags
+					8,  // offset
+					sizeof(uint64_t),  // size
+					array<uint64_t,1>{  // pValues
+						_renderer->drawablePointersBufferAddress() + ((drawableCounter + startIndex) * Renderer::drawablePointersRecordSize),  // stateSetDrawablePointersPtr
+					}.data()
+				);
+
+			// bind index buffer and draw
+			device.cmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType);
+			device.cmdDrawIndexedIndirect(
+				commandBuffer,  // commandBuffer
+				_renderer->drawIndirectBuffer(),  // buffer
+				(drawableCounter + startIndex) * Renderer::drawIndirectRecordSize,  // offset
+				uint32_t(endIndex - startIndex),  // drawCount
+				Renderer::drawIndirectRecordSize  // stride
+			);
+		};
+
+	// set index offsets and record runs of Drawables sharing index buffer
+	// (Drawables without Geometry or without index data are appended to the current run
+	// with zero indexOffset; their PrimitiveSets are expected to be empty)
+	unsigned indexSizeShift = (indexType == vk::IndexType::eUint16) ? 1 : (indexType == vk::IndexType::eUint8EXT) ? 0 : 2;
+	vk::Buffer runBuffer;
+	size_t runStart = 0;
+	for(size_t i=0; i<numDrawables; i++) {
+		Geometry* g = _drawablePtrList[i]->_geometry;
+		if(g == nullptr || g->indexDataSize() == 0) {
+			gpuData[i].indexOffset = 0;
+			continue;
+		}
+		const DataAllocation& indexData = g->indexDataAllocation();
+		gpuData[i].indexOffset = uint32_t(indexData.offset() >> indexSizeShift);
+		vk::Buffer b = indexData.buffer();
+		if(b != runBuffer) {
+			if(runBuffer)
+				recordRun(runBuffer, runStart, i);
+			runBuffer = b;
+			runStart = i;
+		}
+	}
+	if(runBuffer)
+		recordRun(runBuffer, runStart, numDrawables);
+
+	// restore zero drawIndexOffset for StateSets recorded later with the same pipeline layout
+	if(runStart != 0 && drawIndexOffsetPushConstantOffset != ~0u) {
+		uint32_t zero = 0;
+		device.cmdPushConstants(commandBuffer, currentPipelineLayout, vk::ShaderStageFlagBits::eAllGraphics,
+		                        drawIndexOffsetPushConstantOffset, sizeof(uint32_t), &zero);
+	}
+}
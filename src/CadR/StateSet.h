@@ -24,9 +24,24 @@ class Renderer;
 class Texture;
 
 
+/** StateSetDescriptorUpdater keeps the descriptor of StateSet up-to-date with the Texture.
+ *
+ *  If updateFunc is set, it is called to perform the update.
+ *  Otherwise, the descriptor given by descritorSet, dstBinding and dstArrayElement
+ *  is written with the texture's sampler and image view.
+ *  The updates caused by Texture changes are not performed immediately.
+ *  They are scheduled in the Renderer and flushed by Renderer::flushDescriptorUpdates(),
+ *  which is called from Renderer::beginFrame().
+ */
 struct StateSetDescriptorUpdater {
-	std::function<void(Texture& t)> updateFunc;
+	std::function<void(Texture& t)> updateFunc;  ///< Custom update function. If empty, the descriptor write is performed by Renderer::flushDescriptorUpdates().
 	vk::DescriptorSet descritorSet;
+	StateSet* stateSet = nullptr;  ///< StateSet owning this updater.
+	Texture* texture = nullptr;  ///< Texture that is written into the descriptor.
+	uint32_t dstBinding = 0;
+	uint32_t dstArrayElement = 0;
+	vk::DescriptorType descriptorType = vk::DescriptorType::eCombinedImageSampler;
+	vk::ImageLayout imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
 
 	boost::intrusive::list_member_hook<
 		boost::intrusive::link_mode<boost::intrusive::auto_unlink>
@@ -34,9 +49,23 @@ struct StateSetDescriptorUpdater {
 	boost::intrusive::list_member_hook<
 		boost::intrusive::link_mode<boost::intrusive::auto_unlink>
 	> _updaterHook;  ///< List hook of the object doing descriptor update.
+	boost::intrusive::list_member_hook<
+		boost::intrusive::link_mode<boost::intrusive::auto_unlink>
+	> _pendingHook;  ///< List hook of Renderer::_pendingDescriptorUpdaterList. It is linked while the update is scheduled and not flushed yet.
 };
 
 
+typedef boost::intrusive::list<
+	StateSetDescriptorUpdater,
+	boost::intrusive::member_hook<
+		StateSetDescriptorUpdater,
+		boost::intrusive::list_member_hook<
+			boost::intrusive::link_mode<boost::intrusive::auto_unlink>>,
+		&StateSetDescriptorUpdater::_pendingHook>,
+	boost::intrusive::constant_time_size<false>
+> PendingDescriptorUpdaterList;
+
+
 class CADR_EXPORT StateSet {
 protected:
 
@@ -66,6 +95,17 @@ public:
 	// pipeline to bind
 	const CadR::Pipeline* pipeline = nullptr;
 
+	// index type of indexed draws;
+	// if set to vk::IndexType::eNoneKHR, non-indexed draws are recorded and the shaders fetch the indices from DrawablePointers::indexDataPtr;
+	// otherwise, index data of Drawables are bound as index buffer, so the vertex shader results are reused for the repeated indices,
+	// and the shaders receive zero indexDataPtr and the vertex index in gl_VertexIndex;
+	// Drawables using different index buffers are drawn by separate draw commands and gl_DrawID restarts from zero in each of them,
+	// so the index of the first Drawable of each draw command is pushed as uint at drawIndexOffsetPushConstantOffset,
+	// or, if drawIndexOffsetPushConstantOffset is not set, the drawable pointers address pushed at offset 8
+	// is advanced to the first Drawable of each draw command
+	vk::IndexType indexType = vk::IndexType::eNoneKHR;
+	uint32_t drawIndexOffsetPushConstantOffset = ~0u;  ///< Push constant offset of the index of the first Drawable of the current draw command. The pipeline layout must contain it. Used by indexed draws only. The value ~0 means not set.
+
 	// list of functions that will be called during the preparation for StateSet's command buffer recording
 	std::vector<std::function<void(StateSet&)>> prepareCallList;
 
@@ -118,6 +158,9 @@ public:
 	inline StateSetDescriptorUpdater& createDescriptorUpdater(
 		std::function<void(CadR::Texture& t)>&& updateFunc,
 		vk::DescriptorSet descriptorSet);
+	inline StateSetDescriptorUpdater& createDescriptorUpdater(
+		vk::DescriptorSet descriptorSet, uint32_t dstBinding, uint32_t dstArrayElement,
+		vk::DescriptorType descriptorType, vk::ImageLayout imageLayout);
 
 	// rendering functions
 	size_t prepareRecording();
@@ -125,6 +168,7 @@ public:
 		///< If set to false, the recording will happen only if there are any Drawables in this StateSet or in any child StateSet. The recording can also be forced by requestRecording() on per-frame basis.
 	inline void requestRecording();  ///< Requests the recording of this StateSet for the current frame even if it does not contain any Drawables. This function shall be called from prepareCallList callbacks only. Otherwise, it has no effect.
 	void recordToCommandBuffer(vk::CommandBuffer cb, vk::PipelineLayout currentPipelineLayout, size_t& drawableCounter);
+	void recordIndexedDraws(vk::CommandBuffer cb, vk::PipelineLayout currentPipelineLayout, size_t drawableCounter);  ///< Records indexed draws of Drawables of this StateSet. It is called by recordToCommandBuffer() if indexType is not vk::IndexType::eNoneKHR.
 
 	// drawable functions
 	inline void appendDrawable(Drawable& d, const DrawableGpuData& gpuData);
@@ -165,7 +209,8 @@ inline void StateSet::setDescriptorSets(vk::DescriptorPool descriptorPool, std::
 inline void StateSet::setFirstDescriptorSetIndex(uint32_t value)  { _firstDescriptorSetIndex = value; }
 inline void StateSet::setDynamicOffsets(const std::vector<uint32_t>& offsets)  { _dynamicOffsets = offsets; }
 inline void StateSet::setDynamicOffsets(std::vector<uint32_t>&& offsets)  { _dynamicOffsets = std::move(offsets); }
-inline StateSetDescriptorUpdater& StateSet::createDescriptorUpdater(std::function<void(Texture& t)>&& updateFunc, vk::DescriptorSet descriptorSet)  { auto& updater=*new StateSetDescriptorUpdater{ std::move(updateFunc), descriptorSet }; _descriptorUpdaterList.push_back(updater); return updater; }
+inline StateSetDescriptorUpdater& StateSet::createDescriptorUpdater(std::function<void(Texture& t)>&& updateFunc, vk::DescriptorSet descriptorSet)  { auto& updater=*new StateSetDescriptorUpdater{ std::move(updateFunc), descriptorSet, this }; _descriptorUpdaterList.push_back(updater); return updater; }
+inline StateSetDescriptorUpdater& StateSet::createDescriptorUpdater(vk::DescriptorSet descriptorSet, uint32_t dstBinding, uint32_t dstArrayElement, vk::DescriptorType descriptorType, vk::ImageLayout imageLayout)  { auto& updater=*new StateSetDescriptorUpdater{ nullptr, descriptorSet, this, nullptr, dstBinding, dstArrayElement, descriptorType, imageLayout }; _descriptorUpdaterList.push_back(updater); return updater; }
 inline void StateSet::setForceRecording(bool value)  { _forceRecording = value; }
 inline void StateSet::requestRecording()  { _skipRecording = false; }
 inline void StateSet::appendDrawable(Drawable& d, const DrawableGpuData& gpuData)  { if(d._indexIntoStateSet != ~0u) d._stateSet->removeDrawableInternal(d); appendDrawableInternal(d, gpuData); }
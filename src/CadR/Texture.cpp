@@ -1,10 +1,11 @@
-// SPDX-FileCopyrightText: 2025 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2025-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
 #include <CadR/Texture.h>
 #include <CadR/Exceptions.h>
 #include <CadR/ImageAllocation.h>
+#include <CadR/Renderer.h>
 #include <CadR/StateSet.h>
 #include <CadR/VulkanDevice.h>
 
@@ -33,7 +34,7 @@ Texture::Texture(ImageAllocation& a, const vk::ImageViewCreateInfo& imageViewCre
 	_imageViewCreateInfo.image = a.image();
 	_imageView = _device->createImageView(_imageViewCreateInfo);
 	initImageChangedCallback();
-	callDescriptorUpdaters();
+	a.addImageChangedCallback(_imageChangedCallback);
 }
 
 
@@ -48,7 +49,7 @@ Texture::Texture(ImageAllocation& a, const vk::ImageViewCreateInfo& imageViewCre
 	_imageViewCreateInfo.image = a.image();
 	_imageView = _device->createImageView(_imageViewCreateInfo);
 	initImageChangedCallback();
-	callDescriptorUpdaters();
+	a.addImageChangedCallback(_imageChangedCallback);
 }
 
 
@@ -61,13 +62,18 @@ Texture::Texture(Texture&& other) noexcept
 	other._imageView = nullptr;
 	other._imageViewCreateInfo.pNext = nullptr;
 	initImageChangedCallback();
-	other._imageChangedCallback._callbackHook.unlink();
+	_imageChangedCallback._callbackHook.swap_nodes(other._imageChangedCallback._callbackHook);
+	_descriptorUpdaterList.swap(other._descriptorUpdaterList);
+	for(auto& u : _descriptorUpdaterList)
+		u.texture = this;
 }
 
 
 Texture& Texture::operator=(Texture&& rhs) noexcept
 {
+	_descriptorUpdaterList.clear_and_dispose([](StateSetDescriptorUpdater* u){ delete u; });
 	releaseHandles();
+	free(const_cast<void*>(_imageViewCreateInfo.pNext));
 	_imageView = rhs._imageView;
 	_device = rhs._device;
 	_sampler = rhs._sampler;
@@ -75,7 +81,11 @@ Texture& Texture::operator=(Texture&& rhs) noexcept
 	rhs._imageView = nullptr;
 	rhs._imageViewCreateInfo.pNext = nullptr;
 	initImageChangedCallback();
-	rhs._imageChangedCallback._callbackHook.unlink();
+	_imageChangedCallback._callbackHook.unlink();
+	_imageChangedCallback._callbackHook.swap_nodes(rhs._imageChangedCallback._callbackHook);
+	_descriptorUpdaterList.swap(rhs._descriptorUpdaterList);
+	for(auto& u : _descriptorUpdaterList)
+		u.texture = this;
 	return *this;
 }
 
@@ -91,7 +101,17 @@ void Texture::releaseHandles() noexcept
 
 void Texture::recreateHandles(vk::Image image)
 {
-	releaseHandles();
+	// release old imageView;
+	// if descriptors refer to it, its destruction is postponed
+	// until the descriptors are updated by Renderer::flushDescriptorUpdates()
+	// and the frames using it are finished
+	if(_imageView) {
+		if(_descriptorUpdaterList.empty())
+			_device->destroy(_imageView);
+		else
+			_descriptorUpdaterList.front().stateSet->renderer().retireImageView(_imageView);
+		_imageView = nullptr;
+	}
 
 	// imageView
 	_imageViewCreateInfo.image = image;
@@ -122,6 +142,47 @@ void Texture::attachStateSet(StateSet& ss,
 			bind(descriptorUpdateFunc, ref(ss), descriptorSet, placeholders::_1),
 			descriptorSet
 		);
+	u.texture = this;
 	_descriptorUpdaterList.push_back(u);
 	u.updateFunc(*this);
 }
+
+
+void Texture::attachStateSet(StateSet& ss,
+	vk::DescriptorSet descriptorSet, uint32_t dstBinding, uint32_t dstArrayElement,
+	vk::DescriptorType descriptorType, vk::ImageLayout imageLayout)
+{
+	StateSetDescriptorUpdater& u =
+		ss.createDescriptorUpdater(descriptorSet, dstBinding, dstArrayElement, descriptorType, imageLayout);
+	u.texture = this;
+	_descriptorUpdaterList.push_back(u);
+
+	// write the descriptor immediately
+	// (later changes are scheduled and flushed by Renderer::flushDescriptorUpdates())
+	vk::DescriptorImageInfo imageInfo(
+		_sampler,  // sampler
+		_imageView,  // imageView
+		imageLayout  // imageLayout
+	);
+	ss.updateDescriptorSet(
+		vk::WriteDescriptorSet(
+			descriptorSet,  // dstSet
+			dstBinding,  // dstBinding
+			dstArrayElement,  // dstArrayElement
+			1,  // descriptorCount
+			descriptorType,  // descriptorType
+			&imageInfo,  // pImageInfo
+			nullptr,  // pBufferInfo
+			nullptr  // pTexelBufferView
+		)
+	);
+}
+
+
+void Texture::callDescriptorUpdaters()
+{
+	// schedule descriptor updates;
+	// they will be performed in a single batch by Renderer::flushDescriptorUpdates()
+	for(auto& u : _descriptorUpdaterList)
+		u.stateSet->renderer().scheduleDescriptorUpdate(u);
+}
@@ -72,6 +72,16 @@ public:
 	void attachStateSet(StateSet& ss,
 	                    vk::DescriptorSet descriptorSet,
 	                    void(*descriptorUpdateFunc)(StateSet& ss, vk::DescriptorSet descriptorSet, Texture& t));
+	void attachStateSet(StateSet& ss,
+	                    vk::DescriptorSet descriptorSet,
+	                    uint32_t dstBinding,
+	                    uint32_t dstArrayElement = 0,
+	                    vk::DescriptorType descriptorType = vk::DescriptorType::eCombinedImageSampler,
+	                    vk::ImageLayout imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal);
+		//< Attaches the texture to the descriptor given by descriptorSet, dstBinding and dstArrayElement.
+		//< The descriptor is written immediately. Whenever the texture changes later,
+		//< the descriptor update is scheduled in the Renderer and performed together with other updates
+		//< by Renderer::flushDescriptorUpdates().
 
 };
 
@@ -81,7 +91,6 @@ public:
 inline vk::ImageView Texture::imageView() const  { return _imageView; }
 inline VulkanDevice& Texture::device() const  { return *_device; }
 inline vk::Sampler Texture::sampler() const  { return _sampler; }
-inline void Texture::callDescriptorUpdaters()  { for(auto& u : _descriptorUpdaterList) u.updateFunc(*this); }
 
 }
 
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2019-2025 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2019-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
@@ -60,6 +60,7 @@ void VulkanDevice::init(VulkanInstance& instance, vk::PhysicalDevice physicalDev
 	vkFreeDescriptorSets =getProcAddr<PFN_vkFreeDescriptorSets >("vkFreeDescriptorSets");
 	vkCreatePipelineCache=getProcAddr<PFN_vkCreatePipelineCache>("vkCreatePipelineCache");
 	vkDestroyPipelineCache=getProcAddr<PFN_vkDestroyPipelineCache>("vkDestroyPipelineCache");
+	vkGetPipelineCacheData=getProcAddr<PFN_vkGetPipelineCacheData>("vkGetPipelineCacheData");
 	vkCreatePipelineLayout=getProcAddr<PFN_vkCreatePipelineLayout>("vkCreatePipelineLayout");
 	vkDestroyPipelineLayout=getProcAddr<PFN_vkDestroyPipelineLayout>("vkDestroyPipelineLayout");
 	vkCreateGraphicsPipelines=getProcAddr<PFN_vkCreateGraphicsPipelines>("vkCreateGraphicsPipelines");
@@ -102,6 +103,33 @@ void VulkanDevice::init(VulkanInstance& instance, vk::PhysicalDevice physicalDev
 	vkCmdSetDepthBias    =getProcAddr<PFN_vkCmdSetDepthBias    >("vkCmdSetDepthBias");
 	vkCmdSetLineWidth    =getProcAddr<PFN_vkCmdSetLineWidth    >("vkCmdSetLineWidth");
 	vkCmdSetLineStippleEXT=getProcAddr<PFN_vkCmdSetLineStippleEXT>("vkCmdSetLineStippleEXT");
+	vkCreateShadersEXT=getProcAddr<PFN_vkCreateShadersEXT>("vkCreateShadersEXT");
+	vkDestroyShaderEXT=getProcAddr<PFN_vkDestroyShaderEXT>("vkDestroyShaderEXT");
+	vkCmdBindShadersEXT=getProcAddr<PFN_vkCmdBindShadersEXT>("vkCmdBindShadersEXT");
+	vkCmdSetViewportWithCountEXT=getProcAddr<PFN_vkCmdSetViewportWithCountEXT>("vkCmdSetViewportWithCountEXT");
+	vkCmdSetScissorWithCountEXT=getProcAddr<PFN_vkCmdSetScissorWithCountEXT>("vkCmdSetScissorWithCountEXT");
+	vkCmdSetRasterizerDiscardEnableEXT=getProcAddr<PFN_vkCmdSetRasterizerDiscardEnableEXT>("vkCmdSetRasterizerDiscardEnableEXT");
+	vkCmdSetCullModeEXT=getProcAddr<PFN_vkCmdSetCullModeEXT>("vkCmdSetCullModeEXT");
+	vkCmdSetFrontFaceEXT=getProcAddr<PFN_vkCmdSetFrontFaceEXT>("vkCmdSetFrontFaceEXT");
+	vkCmdSetDepthBiasEnableEXT=getProcAddr<PFN_vkCmdSetDepthBiasEnableEXT>("vkCmdSetDepthBiasEnableEXT");
+	vkCmdSetPrimitiveTopologyEXT=getProcAddr<PFN_vkCmdSetPrimitiveTopologyEXT>("vkCmdSetPrimitiveTopologyEXT");
+	vkCmdSetPrimitiveRestartEnableEXT=getProcAddr<PFN_vkCmdSetPrimitiveRestartEnableEXT>("vkCmdSetPrimitiveRestartEnableEXT");
+	vkCmdSetDepthTestEnableEXT=getProcAddr<PFN_vkCmdSetDepthTestEnableEXT>("vkCmdSetDepthTestEnableEXT");
+	vkCmdSetDepthWriteEnableEXT=getProcAddr<PFN_vkCmdSetDepthWriteEnableEXT>("vkCmdSetDepthWriteEnableEXT");
+	vkCmdSetDepthCompareOpEXT=getProcAddr<PFN_vkCmdSetDepthCompareOpEXT>("vkCmdSetDepthCompareOpEXT");
+	vkCmdSetDepthBoundsTestEnableEXT=getProcAddr<PFN_vkCmdSetDepthBoundsTestEnableEXT>("vkCmdSetDepthBoundsTestEnableEXT");
+	vkCmdSetStencilTestEnableEXT=getProcAddr<PFN_vkCmdSetStencilTestEnableEXT>("vkCmdSetStencilTestEnableEXT");
+	vkCmdSetVertexInputEXT=getProcAddr<PFN_vkCmdSetVertexInputEXT>("vkCmdSetVertexInputEXT");
+	vkCmdSetPolygonModeEXT=getProcAddr<PFN_vkCmdSetPolygonModeEXT>("vkCmdSetPolygonModeEXT");
+	vkCmdSetRasterizationSamplesEXT=getProcAddr<PFN_vkCmdSetRasterizationSamplesEXT>("vkCmdSetRasterizationSamplesEXT");
+	vkCmdSetSampleMaskEXT=getProcAddr<PFN_vkCmdSetSampleMaskEXT>("vkCmdSetSampleMaskEXT");
+	vkCmdSetAlphaToCoverageEnableEXT=getProcAddr<PFN_vkCmdSetAlphaToCoverageEnableEXT>("vkCmdSetAlphaToCoverageEnableEXT");
+	vkCmdSetAlphaToOneEnableEXT=getProcAddr<PFN_vkCmdSetAlphaToOneEnableEXT>("vkCmdSetAlphaToOneEnableEXT");
+	vkCmdSetLogicOpEnableEXT=getProcAddr<PFN_vkCmdSetLogicOpEnableEXT>("vkCmdSetLogicOpEnableEXT");
+	vkCmdSetDepthClampEnableEXT=getProcAddr<PFN_vkCmdSetDepthClampEnableEXT>("vkCmdSetDepthClampEnableEXT");
+	vkCmdSetColorBlendEnableEXT=getProcAddr<PFN_vkCmdSetColorBlendEnableEXT>("vkCmdSetColorBlendEnableEXT");
+	vkCmdSetColorBlendEquationEXT=getProcAddr<PFN_vkCmdSetColorBlendEquationEXT>("vkCmdSetColorBlendEquationEXT");
+	vkCmdSetColorWriteMaskEXT=getProcAddr<PFN_vkCmdSetColorWriteMaskEXT>("vkCmdSetColorWriteMaskEXT");
 	vkQueueSubmit        =getProcAddr<PFN_vkQueueSubmit        >("vkQueueSubmit");
 	vkWaitForFences      =getProcAddr<PFN_vkWaitForFences      >("vkWaitForFences");
 	vkResetFences        =getProcAddr<PFN_vkResetFences        >("vkResetFences");
@@ -124,6 +152,8 @@ void VulkanDevice::create(VulkanInstance& instance, vk::PhysicalDevice physicalD
 		return;
 
 	init(instance, physicalDevice, instance.createDevice(physicalDevice, createInfo));
+	_enabledExtensions.assign(createInfo.ppEnabledExtensionNames,
+	                          createInfo.ppEnabledExtensionNames + createInfo.enabledExtensionCount);
 }
 
 
@@ -208,6 +238,7 @@ void VulkanDevice::destroy()
 		_device = nullptr;
 		vkGetDeviceProcAddr = nullptr;
 		vkDestroyDevice = nullptr;
+		_enabledExtensions.clear();
 
 	}
 }
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2019-2025 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+// SPDX-FileCopyrightText: 2019-2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
 //
 // SPDX-License-Identifier: MIT
 
@@ -6,7 +6,10 @@
 
 #include <CadR/CallbackList.h>
 #include <vulkan/vulkan.hpp>
+#include <cstring>
+#include <string>
 #include <tuple>
+#include <vector>
 
 namespace CadR {
 
@@ -17,6 +20,7 @@ class CADR_EXPORT VulkanDevice {
 protected:
 	vk::Device _device;
 	uint32_t _version;
+	std::vector<std::string> _enabledExtensions;  ///< Device extensions enabled by create(). It is empty when the device was initialized by existing vk::Device handle.
 public:
 
 	// constructors and destructor
@@ -107,6 +111,8 @@ public:
 	uint32_t version() const;
 	bool supportsVersion(uint32_t version) const;
 	bool supportsVersion(uint32_t major,uint32_t minor,uint32_t patch=0) const;
+	const std::vector<std::string>& enabledExtensions() const;
+	bool isExtensionEnabled(const char* name) const;
 
 	VkDevice handle() const;
 	vk::Device cppHandle() const;
@@ -165,6 +171,7 @@ public:
 	inline vk::Result createPipelineCache(const vk::PipelineCacheCreateInfo* pCreateInfo,const vk::AllocationCallbacks* pAllocator,vk::PipelineCache* pPipelineCache) const  { return _device.createPipelineCache(pCreateInfo,pAllocator,pPipelineCache,*this); }
 	inline void destroyPipelineCache(vk::PipelineCache pipelineCache,const vk::AllocationCallbacks* pAllocator) const  { _device.destroyPipelineCache(pipelineCache,pAllocator,*this); }
 	inline void destroy(vk::PipelineCache pipelineCache,const vk::AllocationCallbacks* pAllocator) const  { _device.destroy(pipelineCache,pAllocator,*this); }
+	inline vk::Result getPipelineCacheData(vk::PipelineCache pipelineCache,size_t* pDataSize,void* pData) const  { return _device.getPipelineCacheData(pipelineCache,pDataSize,pData,*this); }
 	inline vk::Result createPipelineLayout(const vk::PipelineLayoutCreateInfo* pCreateInfo,const vk::AllocationCallbacks* pAllocator,vk::PipelineLayout* pPipelineLayout) const  { return _device.createPipelineLayout(pCreateInfo,pAllocator,pPipelineLayout,*this); }
 	inline void destroyPipelineLayout(vk::PipelineLayout pipelineLayout,const vk::AllocationCallbacks* pAllocator) const  { _device.destroyPipelineLayout(pipelineLayout,pAllocator,*this); }
 	inline void destroy(vk::PipelineLayout pipelineLayout,const vk::AllocationCallbacks* pAllocator) const  { _device.destroy(pipelineLayout,pAllocator,*this); }
@@ -211,6 +218,34 @@ public:
 	inline void cmdSetDepthBias(vk::CommandBuffer commandBuffer,float constantFactor,float clamp,float slopeFactor) const  { commandBuffer.setDepthBias(constantFactor,clamp,slopeFactor,*this); }
 	inline void cmdSetLineWidth(vk::CommandBuffer commandBuffer,float lineWidth) const  { commandBuffer.setLineWidth(lineWidth,*this); }
 	inline void cmdSetLineStippleEXT(vk::CommandBuffer commandBuffer,uint32_t factor,uint16_t pattern) const  { commandBuffer.setLineStippleEXT(factor,pattern,*this); }
+	inline vk::Result createShadersEXT(uint32_t createInfoCount,const vk::ShaderCreateInfoEXT* pCreateInfos,const vk::AllocationCallbacks* pAllocator,vk::ShaderEXT* pShaders) const  { return _device.createShadersEXT(createInfoCount,pCreateInfos,pAllocator,pShaders,*this); }
+	inline void destroyShaderEXT(vk::ShaderEXT shader,const vk::AllocationCallbacks* pAllocator) const  { _device.destroyShaderEXT(shader,pAllocator,*this); }
+	inline void destroy(vk::ShaderEXT shader,const vk::AllocationCallbacks* pAllocator) const  { _device.destroy(shader,pAllocator,*this); }
+	inline void cmdBindShadersEXT(vk::CommandBuffer commandBuffer,uint32_t stageCount,const vk::ShaderStageFlagBits* pStages,const vk::ShaderEXT* pShaders) const  { commandBuffer.bindShadersEXT(stageCount,pStages,pShaders,*this); }
+	inline void cmdSetViewportWithCountEXT(vk::CommandBuffer commandBuffer,uint32_t viewportCount,const vk::Viewport* pViewports) const  { commandBuffer.setViewportWithCountEXT(viewportCount,pViewports,*this); }
+	inline void cmdSetScissorWithCountEXT(vk::CommandBuffer commandBuffer,uint32_t scissorCount,const vk::Rect2D* pScissors) const  { commandBuffer.setScissorWithCountEXT(scissorCount,pScissors,*this); }
+	inline void cmdSetRasterizerDiscardEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 rasterizerDiscardEnable) const  { commandBuffer.setRasterizerDiscardEnableEXT(rasterizerDiscardEnable,*this); }
+	inline void cmdSetCullModeEXT(vk::CommandBuffer commandBuffer,vk::CullModeFlags cullMode) const  { commandBuffer.setCullModeEXT(cullMode,*this); }
+	inline void cmdSetFrontFaceEXT(vk::CommandBuffer commandBuffer,vk::FrontFace frontFace) const  { commandBuffer.setFrontFaceEXT(frontFace,*this); }
+	inline void cmdSetDepthBiasEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 depthBiasEnable) const  { commandBuffer.setDepthBiasEnableEXT(depthBiasEnable,*this); }
+	inline void cmdSetPrimitiveTopologyEXT(vk::CommandBuffer commandBuffer,vk::PrimitiveTopology primitiveTopology) const  { commandBuffer.setPrimitiveTopologyEXT(primitiveTopology,*this); }
+	inline void cmdSetPrimitiveRestartEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 primitiveRestartEnable) const  { commandBuffer.setPrimitiveRestartEnableEXT(primitiveRestartEnable,*this); }
+	inline void cmdSetDepthTestEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 depthTestEnable) const  { commandBuffer.setDepthTestEnableEXT(depthTestEnable,*this); }
+	inline void cmdSetDepthWriteEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 depthWriteEnable) const  { commandBuffer.setDepthWriteEnableEXT(depthWriteEnable,*this); }
+	inline void cmdSetDepthCompareOpEXT(vk::CommandBuffer commandBuffer,vk::CompareOp depthCompareOp) const  { commandBuffer.setDepthCompareOpEXT(depthCompareOp,*this); }
+	inline void cmdSetDepthBoundsTestEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 depthBoundsTestEnable) const  { commandBuffer.setDepthBoundsTestEnableEXT(depthBoundsTestEnable,*this); }
+	inline void cmdSetStencilTestEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 stencilTestEnable) const  { commandBuffer.setStencilTestEnableEXT(stencilTestEnable,*this); }
+	inline void cmdSetVertexInputEXT(vk::CommandBuffer commandBuffer,uint32_t vertexBindingDescriptionCount,const vk::VertexInputBindingDescription2EXT* pVertexBindingDescriptions,uint32_t vertexAttributeDescriptionCount,const vk::VertexInputAttributeDescription2EXT* pVertexAttributeDescriptions) const  { commandBuffer.setVertexInputEXT(vertexBindingDescriptionCount,pVertexBindingDescriptions,vertexAttributeDescriptionCount,pVertexAttributeDescriptions,*this); }
+	inline void cmdSetPolygonModeEXT(vk::CommandBuffer commandBuffer,vk::PolygonMode polygonMode) const  { commandBuffer.setPolygonModeEXT(polygonMode,*this); }
+	inline void cmdSetRasterizationSamplesEXT(vk::CommandBuffer commandBuffer,vk::SampleCountFlagBits rasterizationSamples) const  { commandBuffer.setRasterizationSamplesEXT(rasterizationSamples,*this); }
+	inline void cmdSetSampleMaskEXT(vk::CommandBuffer commandBuffer,vk::SampleCountFlagBits samples,const vk::SampleMask* pSampleMask) const  { commandBuffer.setSampleMaskEXT(samples,pSampleMask,*this); }
+	inline void cmdSetAlphaToCoverageEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 alphaToCoverageEnable) const  { commandBuffer.setAlphaToCoverageEnableEXT(alphaToCoverageEnable,*this); }
+	inline void cmdSetAlphaToOneEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 alphaToOneEnable) const  { commandBuffer.setAlphaToOneEnableEXT(alphaToOneEnable,*this); }
+	inline void cmdSetLogicOpEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 logicOpEnable) const  { commandBuffer.setLogicOpEnableEXT(logicOpEnable,*this); }
+	inline void cmdSetDepthClampEnableEXT(vk::CommandBuffer commandBuffer,vk::Bool32 depthClampEnable) const  { commandBuffer.setDepthClampEnableEXT(depthClampEnable,*this); }
+	inline void cmdSetColorBlendEnableEXT(vk::CommandBuffer commandBuffer,uint32_t firstAttachment,uint32_t attachmentCount,const vk::Bool32* pColorBlendEnables) const  { commandBuffer.setColorBlendEnableEXT(firstAttachment,attachmentCount,pColorBlendEnables,*this); }
+	inline void cmdSetColorBlendEquationEXT(vk::CommandBuffer commandBuffer,uint32_t firstAttachment,uint32_t attachmentCount,const vk::ColorBlendEquationEXT* pColorBlendEquations) const  { commandBuffer.setColorBlendEquationEXT(firstAttachment,attachmentCount,pColorBlendEquations,*this); }
+	inline void cmdSetColorWriteMaskEXT(vk::CommandBuffer commandBuffer,uint32_t firstAttachment,uint32_t attachmentCount,const vk::ColorComponentFlags* pColorWriteMasks) const  { commandBuffer.setColorWriteMaskEXT(firstAttachment,attachmentCount,pColorWriteMasks,*this); }
 	inline vk::Result queueSubmit(vk::Queue queue,uint32_t submitCount,const vk::SubmitInfo* pSubmits,vk::Fence fence) const  { return queue.submit(submitCount,pSubmits,fence,*this); }
 	inline vk::Result waitForFences(uint32_t fenceCount,const vk::Fence* pFences,vk::Bool32 waitAll,uint64_t timeout) const  { return _device.waitForFences(fenceCount,pFences,waitAll,timeout,*this); }
 	inline vk::Result resetFences(uint32_t fenceCount,const vk::Fence* pFences) const  { return _device.resetFences(fenceCount,pFences,*this); }
@@ -353,6 +388,8 @@ public:
 # endif
 	inline void destroyPipeline(vk::Pipeline pipeline,vk::Optional<const vk::AllocationCallbacks> allocator=nullptr) const  { _device.destroyPipeline(pipeline,allocator,*this); }
 	inline void destroy(vk::Pipeline pipeline,vk::Optional<const vk::AllocationCallbacks> allocator=nullptr) const  { _device.destroy(pipeline,allocator,*this); }
+	inline void destroyShaderEXT(vk::ShaderEXT shader,vk::Optional<const vk::AllocationCallbacks> allocator=nullptr) const  { _device.destroyShaderEXT(shader,allocator,*this); }
+	inline void destroy(vk::ShaderEXT shader,vk::Optional<const vk::AllocationCallbacks> allocator=nullptr) const  { _device.destroy(shader,allocator,*this); }
 	inline vk::ResultValueType<vk::Semaphore>::type createSemaphore(const vk::SemaphoreCreateInfo& createInfo,vk::Optional<const vk::AllocationCallbacks> allocator=nullptr) const  { return _device.createSemaphore(createInfo,allocator,*this); }
 	inline void destroySemaphore(vk::Semaphore semaphore,vk::Optional<const vk::AllocationCallbacks> allocator=nullptr) const  { _device.destroySemaphore(semaphore,allocator,*this); }
 	inline void destroy(vk::Semaphore semaphore,vk::Optional<const vk::AllocationCallbacks> allocator=nullptr) const  { _device.destroy(semaphore,allocator,*this); }
@@ -561,6 +598,7 @@ public:
 	PFN_vkFreeDescriptorSets vkFreeDescriptorSets;
 	PFN_vkCreatePipelineCache vkCreatePipelineCache;
 	PFN_vkDestroyPipelineCache vkDestroyPipelineCache;
+	PFN_vkGetPipelineCacheData vkGetPipelineCacheData;
 	PFN_vkCreatePipelineLayout vkCreatePipelineLayout;
 	PFN_vkDestroyPipelineLayout vkDestroyPipelineLayout;
 	PFN_vkCreateGraphicsPipelines vkCreateGraphicsPipelines;
@@ -603,6 +641,33 @@ public:
 	PFN_vkCmdSetDepthBias vkCmdSetDepthBias;
 	PFN_vkCmdSetLineWidth vkCmdSetLineWidth;
 	PFN_vkCmdSetLineStippleEXT vkCmdSetLineStippleEXT;
+	PFN_vkCreateShadersEXT vkCreateShadersEXT;
+	PFN_vkDestroyShaderEXT vkDestroyShaderEXT;
+	PFN_vkCmdBindShadersEXT vkCmdBindShadersEXT;
+	PFN_vkCmdSetViewportWithCountEXT vkCmdSetViewportWithCountEXT;
+	PFN_vkCmdSetScissorWithCountEXT vkCmdSetScissorWithCountEXT;
+	PFN_vkCmdSetRasterizerDiscardEnableEXT vkCmdSetRasterizerDiscardEnableEXT;
+	PFN_vkCmdSetCullModeEXT vkCmdSetCullModeEXT;
+	PFN_vkCmdSetFrontFaceEXT vkCmdSetFrontFaceEXT;
+	PFN_vkCmdSetDepthBiasEnableEXT vkCmdSetDepthBiasEnableEXT;
+	PFN_vkCmdSetPrimitiveTopologyEXT vkCmdSetPrimitiveTopologyEXT;
+	PFN_vkCmdSetPrimitiveRestartEnableEXT vkCmdSetPrimitiveRestartEnableEXT;
+	PFN_vkCmdSetDepthTestEnableEXT vkCmdSetDepthTestEnableEXT;
+	PFN_vkCmdSetDepthWriteEnableEXT vkCmdSetDepthWriteEnableEXT;
+	PFN_vkCmdSetDepthCompareOpEXT vkCmdSetDepthCompareOpEXT;
+	PFN_vkCmdSetDepthBoundsTestEnableEXT vkCmdSetDepthBoundsTestEnableEXT;
+	PFN_vkCmdSetStencilTestEnableEXT vkCmdSetStencilTestEnableEXT;
+	PFN_vkCmdSetVertexInputEXT vkCmdSetVertexInputEXT;
+	PFN_vkCmdSetPolygonModeEXT vkCmdSetPolygonModeEXT;
+	PFN_vkCmdSetRasterizationSamplesEXT vkCmdSetRasterizationSamplesEXT;
+	PFN_vkCmdSetSampleMaskEXT vkCmdSetSampleMaskEXT;
+	PFN_vkCmdSetAlphaToCoverageEnableEXT vkCmdSetAlphaToCoverageEnableEXT;
+	PFN_vkCmdSetAlphaToOneEnableEXT vkCmdSetAlphaToOneEnableEXT;
+	PFN_vkCmdSetLogicOpEnableEXT vkCmdSetLogicOpEnableEXT;
+	PFN_vkCmdSetDepthClampEnableEXT vkCmdSetDepthClampEnableEXT;
+	PFN_vkCmdSetColorBlendEnableEXT vkCmdSetColorBlendEnableEXT;
+	PFN_vkCmdSetColorBlendEquationEXT vkCmdSetColorBlendEquationEXT;
+	PFN_vkCmdSetColorWriteMaskEXT vkCmdSetColorWriteMaskEXT;
 	PFN_vkQueueSubmit vkQueueSubmit;
 	PFN_vkWaitForFences vkWaitForFences;
 	PFN_vkResetFences vkResetFences;
@@ -646,6 +711,8 @@ inline bool VulkanDevice::operator!() const  { return _device.operator!(); }
 inline uint32_t VulkanDevice::version() const  { return _version; }
 inline bool VulkanDevice::supportsVersion(uint32_t version) const  { return _version>=version; }
 inline bool VulkanDevice::supportsVersion(uint32_t major,uint32_t minor,uint32_t patch) const  { return _version>=VK_MAKE_VERSION(major,minor,patch); }
+inline const std::vector<std::string>& VulkanDevice::enabledExtensions() const  { return _enabledExtensions; }
+inline bool VulkanDevice::isExtensionEnabled(const char* name) const  { for(const std::string& e : _enabledExtensions) if(strcmp(e.c_str(), name)==0) return true; return false; }
 inline VkDevice VulkanDevice::handle() const  { return _device; }
 inline vk::Device VulkanDevice::cppHandle() const  { return _device; }
 inline void VulkanDevice::set(nullptr_t)  { _device=nullptr; }
@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT-0
+
+#include <CadR/BcEncoder.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace CadR;
+
+
+// reference image set
+//
+// The images are generated procedurally to cover typical texture content:
+// smooth gradients, high frequency noise, hard edges, photo-like content,
+// normal map and color with alpha.
+struct ReferenceImage {
+	string name;
+	uint32_t width;
+	uint32_t height;
+	unsigned numComponents;
+	bool normalMap;
+	vector<uint8_t> pixels;
+};
+
+static uint32_t randomState = 12345;
+static uint8_t randomByte()
+{
+	randomState = randomState * 1664525 + 1013904223;
+	return uint8_t(randomState >> 24);
+}
+
+static vector<ReferenceImage> createReferenceImages(uint32_t size)
+{
+	vector<ReferenceImage> list;
+	auto add =
+		[&](const char* name, unsigned numComponents, bool normalMap, auto pixelFunc) {
+			ReferenceImage& img = list.emplace_back();
+			img.name = name;
+			img.width = size;
+			img.height = size;
+			img.numComponents = numComponents;
+			img.normalMap = normalMap;
+			img.pixels.resize(size_t(size) * size * numComponents);
+			uint8_t* p = img.pixels.data();
+			for(uint32_t y=0; y<size; y++)
+				for(uint32_t x=0; x<size; x++, p+=numComponents)
+					pixelFunc(float(x)/size, float(y)/size, p);
+		};
+	auto toByte = [](float v) { return uint8_t(max(0.f, min(255.f, v * 255.f + 0.5f))); };
+
+	add("gradient", 3, false,
+		[&](float x, float y, uint8_t* p) { p[0] = toByte(x); p[1] = toByte(y); p[2] = toByte(1.f-x*y); });
+	add("noise", 3, false,
+		[&](float, float, uint8_t* p) { p[0] = randomByte(); p[1] = randomByte(); p[2] = randomByte(); });
+	add("edges", 3, false,
+		[&](float x, float y, uint8_t* p) {
+			bool c = (int(x*37.f) + int(y*23.f)) & 1;
+			p[0] = c ? 230 : 20; p[1] = c ? 200 : 40; p[2] = c ? 30 : 180;
+		});
+	add("photo", 3, false,
+		[&](float x, float y, uint8_t* p) {
+			float v = 0.5f + 0.25f*sin(x*17.f+sin(y*5.f)*3.f) + 0.2f*cos(y*29.f-x*7.f);
+			p[0] = toByte(v); p[1] = toByte(v*0.8f + 0.1f*x); p[2] = toByte(v*0.6f + 0.3f*y);
+		});
+	add("normal", 3, true,
+		[&](float x, float y, uint8_t* p) {
+			float dx = 0.5f*cos(x*40.f)*sin(y*13.f);
+			float dy = 0.5f*sin(x*11.f)*cos(y*37.f);
+			float l = sqrt(dx*dx + dy*dy + 1.f);
+			p[0] = toByte(dx/l*0.5f+0.5f); p[1] = toByte(dy/l*0.5f+0.5f); p[2] = toByte(1.f/l*0.5f+0.5f);
+		});
+	add("alpha", 4, false,
+		[&](float x, float y, uint8_t* p) {
+			p[0] = toByte(x); p[1] = toByte(0.5f+0.5f*sin(y*20.f)); p[2] = toByte(y);
+			p[3] = toByte(0.5f+0.5f*cos(x*9.f+y*3.f));
+		});
+	add("grey", 1, false,
+		[&](float x, float y, uint8_t* p) { p[0] = toByte(0.5f+0.5f*sin(x*30.f)*cos(y*12.f)); });
+	return list;
+}
+
+
+/// Returns PSNR of the channels stored by the format.
+static double computePsnr(const ReferenceImage& img, BcEncoder::Format format, const vector<uint8_t>& encoded)
+{
+	unsigned numChannels;
+	switch(format) {
+	case BcEncoder::Format::BC4: numChannels = 1; break;
+	case BcEncoder::Format::BC5: numChannels = 2; break;
+	case BcEncoder::Format::BC1: numChannels = 3; break;
+	default: numChannels = 4;
+	}
+
+	uint32_t numBlocksX = (img.width + 3) / 4;
+	size_t blockSize = BcEncoder::blockSize(format);
+	double sum = 0.;
+	size_t n = 0;
+	for(uint32_t by=0; by<(img.height+3)/4; by++)
+		for(uint32_t bx=0; bx<numBlocksX; bx++) {
+			uint8_t decoded[16*4];
+			BcEncoder::decodeBlock(format, &encoded[(size_t(by)*numBlocksX + bx) * blockSize], decoded);
+			for(unsigned i=0; i<16; i++) {
+				uint32_t x = bx*4 + i%4;
+				uint32_t y = by*4 + i/4;
+				if(x >= img.width || y >= img.height)
+					continue;
+				const uint8_t* p = &img.pixels[(size_t(y)*img.width + x) * img.numComponents];
+				uint8_t ref[4];
+				switch(img.numComponents) {
+				case 1: ref[0] = p[0]; ref[1] = 0; ref[2] = 0; ref[3] = 255; break;
+				case 2: ref[0] = p[0]; ref[1] = p[1]; ref[2] = 0; ref[3] = 255; break;
+				case 3: ref[0] = p[0]; ref[1] = p[1]; ref[2] = p[2]; ref[3] = 255; break;
+				default: ref[0] = p[0]; ref[1] = p[1]; ref[2] = p[2]; ref[3] = p[3];
+				}
+				for(unsigned ch=0; ch<numChannels; ch++) {
+					double d = double(decoded[i*4+ch]) - ref[ch];
+					sum += d * d;
+					n++;
+				}
+			}
+		}
+	double mse = sum / double(n);
+	return (mse == 0.) ? INFINITY : 10. * log10(255. * 255. / mse);
+}
+
+
+int main(int argc, char** argv)
+{
+	uint32_t size = (argc > 1) ? uint32_t(stoul(argv[1])) : 1024;
+	vector<ReferenceImage> imageList = createReferenceImages(size);
+	BcEncoder encoder;
+	encoder.setMemoryCacheLimit(0);
+
+	cout << "BcEncoder benchmark, " << size << "x" << size << " images, "
+	     << encoder.numThreads() << " threads" << endl;
+	cout << left << setw(10) << "image" << setw(8) << "format" << right
+	     << setw(10) << "PSNR [dB]" << setw(16) << "1 thread MPix/s" << setw(16) << "pool MPix/s" << endl;
+
+	const BcEncoder::Format formatList[] = {
+		BcEncoder::Format::BC1, BcEncoder::Format::BC3, BcEncoder::Format::BC4,
+		BcEncoder::Format::BC5, BcEncoder::Format::BC7,
+	};
+	for(const ReferenceImage& img : imageList) {
+
+		// benchmark the format chosen for the image and all formats storing the same channels
+		bool alpha = BcEncoder::hasAlpha(img.pixels.data(), size_t(img.width)*img.height, img.numComponents);
+		BcEncoder::Format chosenFormat = BcEncoder::chooseFormat(img.numComponents, alpha, false, img.normalMap);
+		for(BcEncoder::Format format : formatList) {
+			if(format != chosenFormat) {
+				if(alpha && format != BcEncoder::Format::BC3 && format != BcEncoder::Format::BC7)
+					continue;
+				if(!img.normalMap && format == BcEncoder::Format::BC5)
+					continue;
+				if(img.numComponents != 1 && format == BcEncoder::Format::BC4)
+					continue;
+			}
+
+			vector<uint8_t> encoded(BcEncoder::encodedSize(format, img.width, img.height));
+			double numMPix = double(img.width) * img.height / 1e6;
+
+			// single thread
+			uint32_t numBlocksX = (img.width + 3) / 4;
+			auto t1 = chrono::steady_clock::now();
+			for(uint32_t by=0; by<(img.height+3)/4; by++)
+				for(uint32_t bx=0; bx<numBlocksX; bx++) {
+					uint8_t rgba[16*4];
+					for(unsigned i=0; i<16; i++) {
+						const uint8_t* p = &img.pixels[(size_t(by*4+i/4)*img.width + bx*4+i%4) * img.numComponents];
+						for(unsigned ch=0; ch<4; ch++)
+							rgba[i*4+ch] = (ch < img.numComponents) ? p[ch] : (ch == 3) ? 255 : 0;
+					}
+					BcEncoder::encodeBlock(format, rgba, &encoded[(size_t(by)*numBlocksX + bx) * BcEncoder::blockSize(format)]);
+				}
+			auto t2 = chrono::steady_clock::now();
+
+			// thread pool
+			encoder.encode(format, img.pixels.data(), img.width, img.height, img.numComponents, encoded.data());
+			auto t3 = chrono::steady_clock::now();
+
+			double psnr = computePsnr(img, format, encoded);
+			cout << left << setw(10) << img.name << setw(8)
+			     << (string(BcEncoder::formatName(format)) + (format == chosenFormat ? "*" : "")) << right
+			     << fixed << setprecision(2) << setw(10) << psnr
+			     << setw(16) << numMPix / chrono::duration<double>(t2 - t1).count()
+			     << setw(16) << numMPix / chrono::duration<double>(t3 - t2).count() << endl;
+		}
+	}
+	cout << "(* marks the format chosen by BcEncoder::chooseFormat())" << endl;
+
+	return 0;
+}
@@ -0,0 +1,203 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT-0
+
+#include <CadR/BoundingBox.h>
+#include <CadR/BoundingSphere.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace CadR;
+
+
+static uint32_t randomState = 12345;
+static float randomFloat()
+{
+	randomState = randomState * 1664525 + 1013904223;
+	return float(randomState >> 8) / float(1 << 24) * 2.f - 1.f;
+}
+
+/// Returns time of the fastest of several runs of func in seconds.
+template<typename Func>
+static double measure(Func func)
+{
+	double best = INFINITY;
+	for(unsigned i=0; i<5; i++) {
+		auto t1 = chrono::steady_clock::now();
+		func();
+		auto t2 = chrono::steady_clock::now();
+		best = min(best, chrono::duration<double>(t2 - t1).count());
+	}
+	return best;
+}
+
+/// Scalar reference implementation of Ritter's bounding sphere.
+template<typename PointFunc>
+static BoundingSphere ritterSphere(PointFunc point, size_t numPoints)
+{
+	size_t minIndex[3] = { 0, 0, 0 };
+	size_t maxIndex[3] = { 0, 0, 0 };
+	for(size_t i=1; i<numPoints; i++) {
+		glm::vec3 v = point(i);
+		for(unsigned a=0; a<3; a++) {
+			if(v[a] < point(minIndex[a])[a])
+				minIndex[a] = i;
+			if(v[a] > point(maxIndex[a])[a])
+				maxIndex[a] = i;
+		}
+	}
+	unsigned axis = 0;
+	float maxDist2 = -1.f;
+	for(unsigned a=0; a<3; a++) {
+		float d2 = glm::distance2(point(minIndex[a]), point(maxIndex[a]));
+		if(d2 > maxDist2) {
+			maxDist2 = d2;
+			axis = a;
+		}
+	}
+	BoundingSphere bs{ (point(minIndex[axis]) + point(maxIndex[axis])) * 0.5f, sqrt(maxDist2) * 0.5f };
+	for(size_t i=0; i<numPoints; i++) {
+		glm::vec3 v = point(i);
+		float d = glm::distance(v, bs.center);
+		if(d > bs.radius) {
+			float newRadius = (bs.radius + d) * 0.5f;
+			bs.center += (v - bs.center) * ((d - newRadius) / d);
+			bs.radius = newRadius;
+		}
+	}
+	return bs;
+}
+
+static bool failed = false;
+
+static void printResult(const string& name, double numItems, double scalarTime, double simdTime, bool valid)
+{
+	cout << left << setw(34) << name << right << fixed << setprecision(1)
+	     << setw(14) << numItems / scalarTime / 1e6
+	     << setw(14) << numItems / simdTime / 1e6
+	     << setw(10) << setprecision(2) << scalarTime / simdTime << "x"
+	     << (valid ? "" : "  VALIDATION FAILED") << endl;
+	if(!valid)
+		failed = true;
+}
+
+
+int main(int argc, char** argv)
+{
+	size_t numPoints = (argc > 1) ? size_t(stoul(argv[1])) : 1000000;
+	size_t numMatrices = numPoints / 10;
+
+	cout << "Bounding volume benchmark, " << numPoints << " points, " << numMatrices << " matrices" << endl;
+	cout << left << setw(34) << "kernel" << right
+	     << setw(14) << "scalar M/s" << setw(14) << "batched M/s" << setw(11) << "speedup" << endl;
+
+	// points with 12-byte stride (tightly packed positions)
+	// and 32-byte stride (position interleaved with normal and texture coordinates)
+	for(size_t stride : { size_t(12), size_t(32) }) {
+
+		vector<uint8_t> data(numPoints * stride);
+		for(size_t i=0; i<numPoints; i++) {
+			glm::vec3 v(randomFloat() * 100.f, randomFloat() * 50.f + 20.f, randomFloat() * 10.f);
+			memcpy(&data[i*stride], &v, sizeof(v));
+		}
+		auto point =
+			[&](size_t i) {
+				glm::vec3 v;
+				memcpy(&v, &data[i*stride], sizeof(v));
+				return v;
+			};
+		string suffix = " (stride " + to_string(stride) + ")";
+
+		// bounding box
+		BoundingBox scalarBB, simdBB;
+		double scalarTime = measure(
+			[&]() {
+				scalarBB = BoundingBox::empty();
+				for(size_t i=0; i<numPoints; i++) {
+					glm::vec3 v = point(i);
+					scalarBB.extendBy(BoundingBox{ v, v });
+				}
+			});
+		double simdTime = measure(
+			[&]() {
+				simdBB = BoundingBox::createByPoints(data.data(), numPoints, stride);
+			});
+		printResult("BoundingBox" + suffix, double(numPoints), scalarTime, simdTime,
+		            scalarBB.min == simdBB.min && scalarBB.max == simdBB.max);
+
+		// sphere with fixed center
+		BoundingSphere scalarBS, simdBS;
+		glm::vec3 center = scalarBB.getCenter();
+		scalarTime = measure(
+			[&]() {
+				scalarBS = { center, 0.f };
+				for(size_t i=0; i<numPoints; i++)
+					scalarBS.extendRadiusByPointUsingRadius2(point(i));
+				scalarBS.radius = sqrt(scalarBS.radius);
+			});
+		simdTime = measure(
+			[&]() {
+				simdBS = { center, 0.f };
+				simdBS.extendRadiusByPoints(data.data(), numPoints, stride);
+			});
+		printResult("extendRadiusByPoints" + suffix, double(numPoints), scalarTime, simdTime,
+		            fabs(scalarBS.radius - simdBS.radius) <= scalarBS.radius * 1e-5f);
+
+		// Ritter sphere
+		BoundingSphere scalarRitterBS, ritterBS;
+		scalarTime = measure(
+			[&]() {
+				scalarRitterBS = ritterSphere(point, numPoints);
+			});
+		simdTime = measure(
+			[&]() {
+				ritterBS = BoundingSphere::createByPoints(data.data(), numPoints, stride);
+			});
+		bool valid = true;
+		for(size_t i=0; i<numPoints; i++)
+			if(glm::distance(point(i), ritterBS.center) > ritterBS.radius * 1.0001f) {
+				valid = false;
+				break;
+			}
+		printResult("Ritter sphere" + suffix, double(numPoints), scalarTime, simdTime, valid);
+		cout << "   radius: Ritter " << setprecision(2) << ritterBS.radius
+		     << " (scalar " << scalarRitterBS.radius << "), centered in bounding box " << scalarBS.radius << endl;
+	}
+
+	// transformation of bounding sphere by matrices
+	vector<glm::mat4> matrixList(numMatrices);
+	for(glm::mat4& m : matrixList) {
+		for(unsigned c=0; c<3; c++)
+			m[c] = glm::vec4(randomFloat(), randomFloat(), randomFloat(), 0.f);
+		m[3] = glm::vec4(randomFloat() * 100.f, randomFloat() * 100.f, randomFloat() * 100.f, 1.f);
+	}
+	BoundingSphere bs{ glm::vec3(1.f, 2.f, 3.f), 5.f };
+	vector<BoundingSphere> scalarList(numMatrices), simdList(numMatrices);
+	double scalarTime = measure(
+		[&]() {
+			for(size_t i=0; i<numMatrices; i++)
+				scalarList[i] = matrixList[i] * bs;
+		});
+	double simdTime = measure(
+		[&]() {
+			bs.transform(matrixList.data(), numMatrices, simdList.data());
+		});
+	bool valid = true;
+	for(size_t i=0; i<numMatrices; i++)
+		if(glm::distance(scalarList[i].center, simdList[i].center) > 1e-3f ||
+		   fabs(scalarList[i].radius - simdList[i].radius) > 1e-4f)
+		{
+			valid = false;
+			break;
+		}
+	printResult("BoundingSphere transform", double(numMatrices), scalarTime, simdTime, valid);
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT-0
+
+#include <CadR/Drawable.h>
+#include <CadR/Geometry.h>
+#include <CadR/MatrixList.h>
+#include <CadR/Renderer.h>
+#include <CadR/StateSet.h>
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace CadR;
+
+
+static void verify(const vector<Drawable>& drawableList, const Geometry& g, const StateSet& ss)
+{
+	for(size_t i=0; i<drawableList.size(); i++) {
+		const Drawable& d = drawableList[i];
+		if(d.geometry() != &g)
+			throw runtime_error("Drawable::geometry() does not point to the Geometry.");
+		if(&ss.getDrawable(i) != &d)
+			throw runtime_error("StateSet does not point to the Drawable.");
+	}
+}
+
+
+int main(int,char**)
+{
+	Renderer r;
+	StateSet ss(r);
+	MatrixList matrixList(r);
+	deque<Geometry> geometryList;
+	geometryList.emplace_back(r);
+
+	// vector reallocation moves Drawables
+	vector<Drawable> drawableList;
+	for(size_t i=0; i<100; i++) {
+		drawableList.emplace_back(geometryList.front(), 0, matrixList, ss);
+		verify(drawableList, geometryList.front(), ss);
+	}
+
+	// moved Geometry updates all its Drawables
+	// (including Drawables moved before)
+	Geometry movedGeometry(std::move(geometryList.front()));
+	verify(drawableList, movedGeometry, ss);
+	geometryList.clear();
+	verify(drawableList, movedGeometry, ss);
+
+	// move assignment of Drawable
+	Drawable d;
+	d = std::move(drawableList.back());
+	if(d.geometry() != &movedGeometry || drawableList.back().geometry() != nullptr)
+		throw runtime_error("Drawable move assignment does not update geometry pointers.");
+	drawableList.pop_back();
+
+	// destruction of Geometry resets geometry pointers of Drawables
+	{
+		Geometry g(r);
+		d.create(g, 0, matrixList, ss);
+		if(d.geometry() != &g)
+			throw runtime_error("Drawable::create() does not set geometry pointer.");
+	}
+	if(d.geometry() != nullptr)
+		throw runtime_error("Geometry destructor does not reset geometry pointers.");
+
+	// move assignment of Geometry
+	Geometry g2(r);
+	g2 = std::move(movedGeometry);
+	verify(drawableList, g2, ss);
+
+	return 0;
+}
@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT-0
+
+#include <CadGltf/GltfJson.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace CadGltf;
+
+
+// heap usage tracking
+// (each allocation is prefixed by its size)
+static size_t currentHeapSize = 0;
+static size_t peakHeapSize = 0;
+
+void* operator new(size_t size)
+{
+	void* p = malloc(size + 16);
+	if(p == nullptr)
+		throw bad_alloc();
+	*static_cast<size_t*>(p) = size;
+	currentHeapSize += size;
+	if(currentHeapSize > peakHeapSize)
+		peakHeapSize = currentHeapSize;
+	return static_cast<uint8_t*>(p) + 16;
+}
+void* operator new[](size_t size)  { return operator new(size); }
+void operator delete(void* p) noexcept
+{
+	if(p == nullptr)
+		return;
+	void* base = static_cast<uint8_t*>(p) - 16;
+	currentHeapSize -= *static_cast<size_t*>(base);
+	free(base);
+}
+void operator delete[](void* p) noexcept  { operator delete(p); }
+void operator delete(void* p, size_t) noexcept  { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept  { operator delete(p); }
+
+
+static uint32_t randomState = 12345;
+static float randomFloat()
+{
+	randomState = randomState * 1664525 + 1013904223;
+	return float(randomState >> 8) / float(1 << 24) * 2.f - 1.f;
+}
+
+
+/// Generates glTF json resembling CAD export:
+/// assembly nodes with ten children each, leaf nodes referencing meshes,
+/// each mesh with a primitive of four accessors and bufferViews.
+static string generateGltf(size_t numNodes)
+{
+	size_t numMeshes = numNodes / 2;
+	string s;
+	s.reserve(numNodes * 400);
+	s += "{\"asset\":{\"version\":\"2.0\",\"generator\":\"GltfParseBenchmark\"},\"scene\":0,"
+	     "\"scenes\":[{\"nodes\":[0]}],\"nodes\":[";
+	for(size_t i=0; i<numNodes; i++) {
+		if(i != 0)
+			s += ',';
+		s += "{\"name\":\"Part " + to_string(i) + "\"";
+		if(i % 3 == 0) {
+			s += ",\"matrix\":[";
+			for(unsigned j=0; j<16; j++)
+				s += ((j == 0) ? "" : ",") + ((j % 5 == 0) ? string("1.0") : to_string(randomFloat()));
+			s += ']';
+		}
+		else {
+			s += ",\"translation\":[" + to_string(randomFloat() * 100.f) + ',' +
+			     to_string(randomFloat() * 100.f) + ',' + to_string(randomFloat() * 100.f) + ']';
+			if(i % 3 == 1)
+				s += ",\"rotation\":[0,0,0.7071068,0.7071068],\"scale\":[2,2,2]";
+		}
+		size_t firstChild = i * 10 + 1;
+		if(firstChild < numNodes) {
+			s += ",\"children\":[";
+			for(size_t j=firstChild, e=min(firstChild+10, numNodes); j<e; j++)
+				s += ((j == firstChild) ? "" : ",") + to_string(j);
+			s += ']';
+		}
+		else
+			s += ",\"mesh\":" + to_string(i % numMeshes);
+		s += '}';
+	}
+	s += "],\"meshes\":[";
+	for(size_t i=0; i<numMeshes; i++)
+		s += ((i == 0) ? "" : ",") + string("{\"primitives\":[{\"attributes\":{\"POSITION\":") + to_string(i*4) +
+		     ",\"NORMAL\":" + to_string(i*4+1) + ",\"TEXCOORD_0\":" + to_string(i*4+2) +
+		     "},\"indices\":" + to_string(i*4+3) + ",\"material\":" + to_string(i % 16) + "}]}";
+	s += "],\"accessors\":[";
+	for(size_t i=0; i<numMeshes; i++) {
+		string bv = to_string(i*4);
+		s += ((i == 0) ? "" : ",") +
+		     string("{\"bufferView\":") + bv + ",\"componentType\":5126,\"count\":24,\"type\":\"VEC3\","
+		     "\"min\":[-1.0,-1.0,-1.0],\"max\":[1.0,1.0,1.0]},"
+		     "{\"bufferView\":" + to_string(i*4+1) + ",\"componentType\":5126,\"count\":24,\"type\":\"VEC3\"},"
+		     "{\"bufferView\":" + to_string(i*4+2) + ",\"componentType\":5126,\"count\":24,\"type\":\"VEC2\"},"
+		     "{\"bufferView\":" + to_string(i*4+3) + ",\"byteOffset\":0,\"componentType\":5123,\"count\":36,\"type\":\"SCALAR\"}";
+	}
+	s += "],\"bufferViews\":[";
+	for(size_t i=0; i<numMeshes; i++) {
+		size_t offset = i * 904;
+		s += ((i == 0) ? "" : ",") +
+		     string("{\"buffer\":0,\"byteOffset\":") + to_string(offset) + ",\"byteLength\":288,\"target\":34962},"
+		     "{\"buffer\":0,\"byteOffset\":" + to_string(offset+288) + ",\"byteLength\":288,\"target\":34962},"
+		     "{\"buffer\":0,\"byteOffset\":" + to_string(offset+576) + ",\"byteLength\":192,\"byteStride\":8},"
+		     "{\"buffer\":0,\"byteOffset\":" + to_string(offset+768) + ",\"byteLength\":72,\"target\":34963}";
+	}
+	s += "],\"materials\":[";
+	for(unsigned i=0; i<16; i++)
+		s += ((i == 0) ? "" : ",") + string("{\"pbrMetallicRoughness\":{\"baseColorFactor\":[") +
+		     to_string((i&1)*0.5f+0.5f) + ",0.5,0.5,1.0],\"metallicFactor\":0.0},\"extensions\":{}}";
+	s += "],\"buffers\":[{\"byteLength\":" + to_string(numMeshes * 904) + ",\"uri\":\"parts.bin\"}]}";
+	return s;
+}
+
+
+/// Returns time of the fastest of several runs of func in seconds,
+/// peak heap size during the run and heap size retained after the run.
+/// Release is called before each run to free the result of the previous run.
+template<typename Func, typename ReleaseFunc>
+static void measure(Func func, ReleaseFunc release, double& time, size_t& peakSize, size_t& retainedSize)
+{
+	time = INFINITY;
+	for(unsigned i=0; i<3; i++) {
+		release();
+		size_t startHeapSize = currentHeapSize;
+		peakHeapSize = currentHeapSize;
+		auto t1 = chrono::steady_clock::now();
+		func();
+		auto t2 = chrono::steady_clock::now();
+		time = min(time, chrono::duration<double>(t2 - t1).count());
+		peakSize = peakHeapSize - startHeapSize;
+		retainedSize = currentHeapSize - startHeapSize;
+	}
+}
+
+
+static bool equal(const GltfJson& a, const GltfJson& b)
+{
+	if(a.root != b.root || a.nodeChildList != b.nodeChildList || a.nodeList.size() != b.nodeList.size() ||
+	   a.accessorList.size() != b.accessorList.size() || a.bufferViewList.size() != b.bufferViewList.size())
+		return false;
+	for(size_t i=0; i<a.nodeList.size(); i++) {
+		const GltfJson::Node& n1 = a.nodeList[i];
+		const GltfJson::Node& n2 = b.nodeList[i];
+		if(n1.matrix != n2.matrix || n1.meshIndex != n2.meshIndex ||
+		   n1.firstChild != n2.firstChild || n1.numChildren != n2.numChildren || n1.instancing != n2.instancing)
+			return false;
+	}
+	for(size_t i=0; i<a.accessorList.size(); i++) {
+		const GltfJson::Accessor& a1 = a.accessorList[i];
+		const GltfJson::Accessor& a2 = b.accessorList[i];
+		if(a1.byteOffset != a2.byteOffset || a1.count != a2.count || a1.bufferView != a2.bufferView ||
+		   a1.componentType != a2.componentType || a1.type != a2.type || a1.normalized != a2.normalized ||
+		   a1.sparse != a2.sparse || a1.minSize != a2.minSize || a1.maxSize != a2.maxSize ||
+		   memcmp(a1.min, a2.min, sizeof(float)*min(a1.minSize, uint8_t(3))) != 0 ||
+		   memcmp(a1.max, a2.max, sizeof(float)*min(a1.maxSize, uint8_t(3))) != 0)
+			return false;
+	}
+	for(size_t i=0; i<a.bufferViewList.size(); i++) {
+		const GltfJson::BufferView& b1 = a.bufferViewList[i];
+		const GltfJson::BufferView& b2 = b.bufferViewList[i];
+		if(b1.byteOffset != b2.byteOffset || b1.byteLength != b2.byteLength ||
+		   b1.buffer != b2.buffer || b1.byteStride != b2.byteStride)
+			return false;
+	}
+	return true;
+}
+
+
+int main(int argc, char** argv)
+{
+	size_t numNodes = (argc > 1) ? size_t(stoul(argv[1])) : 1000000;
+
+	// generate file content
+	// (optionally, it is written to the file given as the second argument)
+	string s = generateGltf(numNodes);
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(s.data());
+	if(argc > 2)
+		ofstream(argv[2], ios::binary).write(s.data(), s.size());
+	cout << "glTF parse benchmark, " << numNodes << " nodes, "
+	     << fixed << setprecision(1) << double(s.size()) / 1e6 << " MB of json" << endl;
+	cout << left << setw(24) << "parser" << right
+	     << setw(12) << "time [ms]" << setw(12) << "MB/s" << setw(14) << "peak [MB]" << setw(16) << "retained [MB]" << endl;
+
+	auto printResult =
+		[&](const string& name, double time, size_t peakSize, size_t retainedSize)
+		{
+			cout << left << setw(24) << name << right << fixed << setprecision(1)
+			     << setw(12) << time * 1e3
+			     << setw(12) << double(s.size()) / time / 1e6
+			     << setw(14) << double(peakSize) / 1e6
+			     << setw(16) << double(retainedSize) / 1e6 << endl;
+		};
+	double time;
+	size_t peakSize, retainedSize;
+
+	// full DOM
+	// (the json is kept as DOM, including nodes, accessors and bufferViews)
+	{
+		nlohmann::json j;
+		measure(
+			[&]() { j = nlohmann::json::parse(data, data + s.size()); },
+			[&]() { j = nullptr; },
+			time, peakSize, retainedSize);
+		printResult("DOM only", time, peakSize, retainedSize);
+	}
+
+	// DOM with conversion into typed lists
+	GltfJson domResult;
+	measure(
+		[&]() { domResult.parseDom(data, s.size()); },
+		[&]() { domResult = {}; },
+		time, peakSize, retainedSize);
+	printResult("DOM + typed lists", time, peakSize, retainedSize);
+
+	// streaming parser
+	GltfJson streamingResult;
+	measure(
+		[&]() { streamingResult.parseStreaming(data, s.size()); },
+		[&]() { streamingResult = {}; },
+		time, peakSize, retainedSize);
+	printResult("streaming", time, peakSize, retainedSize);
+
+	// validate
+	bool valid = equal(domResult, streamingResult) && streamingResult.nodeList.size() == numNodes;
+	if(!valid)
+		cout << "VALIDATION FAILED: streaming and DOM results differ." << endl;
+	return valid ? 0 : 1;
+}
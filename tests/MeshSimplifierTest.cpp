@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT-0
+
+#include <CadGltf/MeshSimplifier.h>
+#include <glm/vec3.hpp>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace CadGltf;
+
+
+int main(int,char**)
+{
+	// procedural mesh
+	// (wavy height field, so the simplification cannot be lossless)
+	constexpr uint32_t n = 64;
+	vector<glm::vec3> positions;
+	positions.reserve(n*n);
+	for(uint32_t y=0; y<n; y++)
+		for(uint32_t x=0; x<n; x++) {
+			float fx = float(x) / (n-1);
+			float fy = float(y) / (n-1);
+			positions.emplace_back(fx, fy, 0.05f * sin(fx * 12.f) * cos(fy * 9.f));
+		}
+	vector<uint32_t> indices;
+	for(uint32_t y=0; y<n-1; y++)
+		for(uint32_t x=0; x<n-1; x++) {
+			uint32_t i = y*n + x;
+			indices.insert(indices.end(), { i, i+1, i+n, i+1, i+n+1, i+n });
+		}
+
+	// simplify levels, each one from the previous one
+	// (errors are measured against the original mesh, so they must not decrease)
+	MeshSimplifier::State state;
+	vector<uint32_t> src = indices;
+	vector<uint32_t> dst(indices.size());
+	float prevError = 0.f;
+	for(unsigned level=1; level<=4; level++) {
+		float error;
+		size_t count = MeshSimplifier::simplify(dst.data(), src.data(), src.size(), positions.data(), positions.size(),
+		                                        src.size() / 6 * 3, error, &state);
+		cout << "Level " << level << ": " << count/3 << " triangles, error " << error << endl;
+		if(count == 0 || count >= src.size())
+			throw runtime_error("Level " + to_string(level) + " was not simplified.");
+		if(error < prevError)
+			throw runtime_error("Error of level " + to_string(level) + " is lower than the error of the previous level.");
+		if(error != state.error)
+			throw runtime_error("State does not hold the error of the last level.");
+		prevError = error;
+		src.assign(dst.begin(), dst.begin() + count);
+	}
+	if(prevError <= 0.f)
+		throw runtime_error("Simplification of wavy surface reports zero error.");
+
+	return 0;
+}
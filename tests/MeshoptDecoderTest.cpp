@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT-0
+
+#include <CadGltf/MeshoptDecoder.h>
+#include <CadR/Exceptions.h>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace CadGltf;
+
+
+// reference data
+// (vertex, index v0 and index sequence data were encoded by meshoptimizer,
+// index v1 data exercise edge fifo codes of the last index delta: 15, 13 and 14)
+static const uint8_t vertexData[] = {
+	0xa0, 0x01, 0x3f, 0x00, 0x00, 0x00, 0x58, 0x57, 0x58, 0x01, 0x26, 0x00, 0x00, 0x00, 0x01,
+	0x0c, 0x00, 0x00, 0x00, 0x58, 0x01, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x3f, 0x00, 0x00, 0x00, 0x17, 0x18, 0x17, 0x01, 0x26, 0x00, 0x00, 0x00, 0x01, 0x0c, 0x00,
+	0x00, 0x00, 0x17, 0x01, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+struct Vertex {
+	uint16_t px, py, pz;
+	uint8_t nu, nv;
+	uint16_t tx, ty;
+	bool operator==(const Vertex&) const = default;
+};
+static const Vertex vertexReference[] = {
+	{ 0, 0, 0, 0, 0, 0, 0 },
+	{ 300, 0, 0, 0, 0, 500, 0 },
+	{ 0, 300, 0, 0, 0, 0, 500 },
+	{ 300, 300, 0, 0, 0, 500, 500 },
+};
+
+static const uint8_t indexDataV0[] = {
+	0xe0, 0xf0, 0x10, 0xfe, 0xff, 0xf0, 0x0c, 0xff, 0x02, 0x02, 0x02, 0x00, 0x76, 0x87, 0x56, 0x67,
+	0x78, 0xa9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00,
+};
+static const uint32_t indexReferenceV0[] = { 0, 1, 2, 2, 1, 3, 4, 6, 5, 7, 8, 9 };
+
+static const uint8_t indexDataV1[] = {
+	0xe1, 0xf0, 0x10, 0x1f, 0x0d, 0x0e, 0xfe, 0x14, 0x00, 0x00, 0x76, 0x87, 0x56, 0x67, 0x78, 0xa9,
+	0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00,
+};
+static const uint32_t indexReferenceV1[] = { 0, 1, 2, 2, 1, 3, 3, 1, 10, 3, 10, 9, 3, 9, 10, 4, 5, 6 };
+
+static const uint8_t sequenceData[] = {
+	0xd1, 0x00, 0x04, 0x04, 0x04, 0x84, 0x03, 0x04, 0xc9, 0x01, 0x00, 0x00, 0x00, 0x00,
+};
+static const uint32_t sequenceReference[] = { 0, 1, 2, 3, 100, 101, 50 };
+
+
+template<typename T, size_t N>
+static void testIndices(const uint8_t* data, size_t size, const uint32_t (&reference)[N],
+                        void (*decodeFunc)(void*, size_t, size_t, const uint8_t*, size_t), const char* name)
+{
+	vector<T> indices(N);
+	decodeFunc(indices.data(), N, sizeof(T), data, size);
+	for(size_t i=0; i<N; i++)
+		if(indices[i] != reference[i])
+			throw runtime_error(string(name) + " does not match reference data.");
+}
+
+
+template<typename Func>
+static void expectError(Func func, const char* message)
+{
+	try {
+		func();
+	}
+	catch(CadR::LogicError&) {
+		return;
+	}
+	throw runtime_error(message);
+}
+
+
+int main(int,char**)
+{
+	// vertex codec
+	Vertex vertices[4];
+	MeshoptDecoder::decodeVertexBuffer(vertices, 4, sizeof(Vertex), vertexData, sizeof(vertexData));
+	for(size_t i=0; i<4; i++)
+		if(!(vertices[i] == vertexReference[i]))
+			throw runtime_error("Vertex codec does not match reference data.");
+
+	// index codec, both versions and both index sizes
+	testIndices<uint32_t>(indexDataV0, sizeof(indexDataV0), indexReferenceV0, MeshoptDecoder::decodeIndexBuffer, "Index codec v0");
+	testIndices<uint16_t>(indexDataV0, sizeof(indexDataV0), indexReferenceV0, MeshoptDecoder::decodeIndexBuffer, "Index codec v0");
+	testIndices<uint32_t>(indexDataV1, sizeof(indexDataV1), indexReferenceV1, MeshoptDecoder::decodeIndexBuffer, "Index codec v1");
+	testIndices<uint16_t>(indexDataV1, sizeof(indexDataV1), indexReferenceV1, MeshoptDecoder::decodeIndexBuffer, "Index codec v1");
+
+	// index sequence codec
+	testIndices<uint32_t>(sequenceData, sizeof(sequenceData), sequenceReference, MeshoptDecoder::decodeIndexSequence, "Index sequence codec");
+	testIndices<uint16_t>(sequenceData, sizeof(sequenceData), sequenceReference, MeshoptDecoder::decodeIndexSequence, "Index sequence codec");
+
+	// octahedral filter
+	int8_t oct[] = { 0, 0, 127, 42,  127, 0, 127, 0,  0, 0, -127, 0 };
+	const int8_t octReference[] = { 0, 0, 127, 42,  127, 0, 0, 0,  -73, -73, -73, 0 };
+	MeshoptDecoder::decodeOctahedralFilter(oct, 3, 4);
+	if(memcmp(oct, octReference, sizeof(oct)) != 0)
+		throw runtime_error("Octahedral filter does not match reference data.");
+
+	// quaternion filter
+	int16_t quat[] = { 0, 0, 0, 0x7fff,  0, 0, 0, 0x7ffc };
+	const int16_t quatReference[] = { 0, 0, 0, 32767,  32767, 0, 0, 0 };
+	MeshoptDecoder::decodeQuaternionFilter(quat, 2, 8);
+	if(memcmp(quat, quatReference, sizeof(quat)) != 0)
+		throw runtime_error("Quaternion filter does not match reference data.");
+
+	// exponential filter
+	uint32_t exp[] = { (uint32_t(-2) << 24) | 3, (uint32_t(1) << 24) | 0xffffff };
+	MeshoptDecoder::decodeExponentialFilter(exp, 2, 4);
+	float expResult[2];
+	memcpy(expResult, exp, sizeof(exp));
+	if(expResult[0] != 0.75f || expResult[1] != -2.f)
+		throw runtime_error("Exponential filter does not match reference data.");
+
+	// malformed data
+	vector<uint8_t> buffer(256);
+	for(size_t size=0; size<sizeof(vertexData); size++)
+		expectError([&]() { MeshoptDecoder::decodeVertexBuffer(buffer.data(), 4, 12, vertexData, size); },
+		            "Truncated vertex data were not detected.");
+	for(size_t size=0; size<sizeof(indexDataV1); size++)
+		expectError([&]() { MeshoptDecoder::decodeIndexBuffer(buffer.data(), 18, 4, indexDataV1, size); },
+		            "Truncated triangle data were not detected.");
+	for(size_t size=0; size<sizeof(sequenceData); size++)
+		expectError([&]() { MeshoptDecoder::decodeIndexSequence(buffer.data(), 7, 4, sequenceData, size); },
+		            "Truncated index data were not detected.");
+	expectError([&]() { MeshoptDecoder::decodeVertexBuffer(buffer.data(), 4, 10, vertexData, sizeof(vertexData)); },
+	            "Invalid vertex byteStride was not detected.");
+	expectError([&]() { MeshoptDecoder::decodeIndexBuffer(buffer.data(), 12, 1, indexDataV0, sizeof(indexDataV0)); },
+	            "Invalid index byteStride was not detected.");
+	expectError([&]() { MeshoptDecoder::decode(buffer.data(), 12, 4, MeshoptDecoder::Mode::Triangles,
+	                                           MeshoptDecoder::Filter::Octahedral, indexDataV0, sizeof(indexDataV0)); },
+	            "Filter on index data was not detected.");
+
+	return 0;
+}
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2026 PCJohn (Jan Pečiva, peciva@fit.vut.cz)
+//
+// SPDX-License-Identifier: MIT-0
+
+#include <CadPL/PipelineSceneGraph.h>
+#include <CadR/Renderer.h>
+#include <CadR/StateSet.h>
+#include <CadR/VulkanDevice.h>
+#include <CadR/VulkanInstance.h>
+#include <CadR/VulkanLibrary.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace CadR;
+
+
+// benchmark states
+//
+// Each ShaderState differs in attribSetup and materialSetup as when the scene contains many materials.
+// Every second state uses different cullMode, so PipelineState differs as well.
+static vector<pair<CadPL::ShaderState, CadPL::PipelineState>> createStates(size_t numStates)
+{
+	vector<pair<CadPL::ShaderState, CadPL::PipelineState>> list;
+	list.reserve(numStates);
+	for(size_t i=0; i<numStates; i++) {
+		auto& [shaderState, pipelineState] = list.emplace_back();
+		shaderState.idBuffer = false;
+		shaderState.transparency = false;
+		shaderState.primitiveTopology = vk::PrimitiveTopology::eTriangleList;
+		shaderState.projectionHandling = CadPL::ShaderState::ProjectionHandling::PerspectivePushAndSpecializationConstants;
+		shaderState.attribAccessInfo.fill(0);
+		shaderState.attribAccessInfo[0] = 0x2000;  // vertices: float3, offset 0
+		shaderState.attribAccessInfo[1] = 0x2010;  // normals: float3, offset 16
+		shaderState.attribSetup = 32 + uint32_t(i >> 15) * 16;
+		shaderState.materialSetup = 0x1 | 0x8000 | (uint32_t(i & 0x7fff) << 17);
+		shaderState.pointSize = 1.f;
+		shaderState.textureSetup.fill(0);
+		shaderState.lightSetup = { 2 };
+		shaderState.optimizeFlags = CadPL::ShaderState::OptimizeNone;
+		pipelineState.cullMode = (i & 1) ? vk::CullModeFlagBits::eNone : vk::CullModeFlagBits::eBack;
+		pipelineState.depthBiasConstantFactor = 0.f;
+		pipelineState.depthBiasClamp = 0.f;
+		pipelineState.depthBiasSlopeFactor = 0.f;
+		pipelineState.minSampleShading = 0.f;
+		pipelineState.numColorAttachments = 1;
+		pipelineState.colorAttachmentFormats = { vk::Format::eB8G8R8A8Unorm, vk::Format::eUndefined,
+			vk::Format::eUndefined, vk::Format::eUndefined, vk::Format::eUndefined };
+		pipelineState.depthAttachmentFormat = vk::Format::eD32Sfloat;
+		pipelineState.stencilAttachmentFormat = vk::Format::eUndefined;
+	}
+	return list;
+}
+
+
+int main(int argc, char** argv)
+{
+	size_t numStates = (argc > 1) ? stoul(argv[1]) : 1000;
+	size_t numLookups = (argc > 2) ? stoul(argv[2]) : 1000000;
+
+	// init Vulkan
+	VulkanLibrary lib;
+	lib.load();
+	VulkanInstance instance(lib, nullptr, 0, nullptr, 0, VK_API_VERSION_1_2);
+	vk::PhysicalDevice physicalDevice;
+	uint32_t graphicsQueueFamily;
+	tie(physicalDevice, graphicsQueueFamily, ignore) = instance.chooseDevice(vk::QueueFlagBits::eGraphics);
+	Renderer::RequiredFeaturesStructChain features;
+	Renderer::setRequiredFeatures(features);
+	features.get<vk::PhysicalDeviceFeatures2>().features.geometryShader = true;  // required by CadPL
+	features.get<vk::PhysicalDeviceVulkan12Features>().runtimeDescriptorArray = true;  // required by CadPL
+	features.get<vk::PhysicalDeviceVulkan12Features>().descriptorBindingSampledImageUpdateAfterBind = true;  // required by CadPL
+	features.get<vk::PhysicalDeviceVulkan12Features>().descriptorBindingUpdateUnusedWhilePending = true;  // required by CadPL
+	features.get<vk::PhysicalDeviceVulkan12Features>().descriptorBindingPartiallyBound = true;  // required by CadPL
+	features.get<vk::PhysicalDeviceVulkan12Features>().descriptorBindingVariableDescriptorCount = true;  // required by CadPL
+	features.unlink<vk::PhysicalDeviceVulkan13Features>();
+	features.unlink<vk::PhysicalDeviceVulkan14Features>();
+	VulkanDevice device(instance, physicalDevice, graphicsQueueFamily, graphicsQueueFamily,
+	                    nullptr, features.get<vk::PhysicalDeviceFeatures2>());
+	Renderer r(device, instance, physicalDevice, graphicsQueueFamily);
+
+	// scene graph
+	// (setProjectionViewportAndScissor() is never called,
+	// so no pipelines are compiled and only the StateSet management is measured)
+	StateSet root(r);
+	CadPL::PipelineSceneGraph pipelineSceneGraph(root);
+	vector<pair<CadPL::ShaderState, CadPL::PipelineState>> stateList = createStates(numStates);
+
+	// pseudo-random order of lookups
+	vector<uint32_t> lookupList(numLookups);
+	uint32_t randomState = 12345;
+	for(uint32_t& i : lookupList) {
+		randomState = randomState * 1664525 + 1013904223;
+		i = uint32_t((uint64_t(randomState) * numStates) >> 32);
+	}
+
+	cout << "PipelineSceneGraph benchmark, " << numStates << " states, " << numLookups << " lookups" << endl;
+
+	// creation of StateSets
+	auto t1 = chrono::steady_clock::now();
+	for(const auto& [shaderState, pipelineState] : stateList)
+		pipelineSceneGraph.getOrCreateStateSet(shaderState, pipelineState);
+	auto t2 = chrono::steady_clock::now();
+	if(pipelineSceneGraph.numStateSets() != numStates)
+		throw runtime_error("Wrong number of StateSets created.");
+
+	// lookups of existing StateSets
+	size_t sum = 0;
+	for(uint32_t i : lookupList) {
+		const auto& [shaderState, pipelineState] = stateList[i];
+		sum += size_t(&pipelineSceneGraph.getOrCreateStateSet(shaderState, pipelineState)) & 0xff;
+	}
+	auto t3 = chrono::steady_clock::now();
+	if(pipelineSceneGraph.numStateSets() != numStates)
+		throw runtime_error("Lookup created new StateSet.");
+
+	// reference: ordered map using operator<
+	map<pair<CadPL::ShaderState, CadPL::PipelineState>, size_t> referenceMap;
+	for(size_t i=0; i<numStates; i++)
+		referenceMap.emplace(stateList[i], i);
+	auto t4 = chrono::steady_clock::now();
+	for(uint32_t i : lookupList)
+		sum += referenceMap.find(stateList[i])->second & 0xff;
+	auto t5 = chrono::steady_clock::now();
+
+	// hashing only
+	uint64_t h = 0;
+	for(uint32_t i : lookupList) {
+		const auto& [shaderState, pipelineState] = stateList[i];
+		h ^= CadPL::hashCombine(shaderState.hash(), pipelineState.hash());
+	}
+	auto t6 = chrono::steady_clock::now();
+
+	auto rate = [](size_t n, auto t) { return double(n) / chrono::duration<double>(t).count() / 1e6; };
+	cout << fixed << setprecision(2)
+	     << "getOrCreateStateSet() creation: " << setw(10) << rate(numStates, t2-t1) << " M/s" << endl
+	     << "getOrCreateStateSet() lookup:   " << setw(10) << rate(numLookups, t3-t2) << " M/s" << endl
+	     << "std::map lookup (reference):    " << setw(10) << rate(numLookups, t5-t4) << " M/s" << endl
+	     << "state hashing only:             " << setw(10) << rate(numLookups, t6-t5) << " M/s" << endl
+	     << "(checksum " << ((sum ^ h) & 0xff) << ")" << endl;
+
+	pipelineSceneGraph.destroy();
+	return 0;
+}